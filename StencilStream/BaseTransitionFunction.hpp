@@ -35,11 +35,14 @@ namespace stencil {
  * sub-iterations.
  *
  * For the time-dependent value system, this class uses the `std::monostate` type. This type has
- * only one value, which is "computed" for every iteration.
+ * only one value, which is "computed" for every iteration. The same type is used for the static
+ * values and the reduction, which disables them.
  */
 class BaseTransitionFunction {
   public:
     using TimeDependentValue = std::monostate;
+    using StaticValue = std::monostate;
+    using Reduction = std::monostate;
 
     static constexpr uindex_t stencil_radius = 1;
     static constexpr uindex_t n_subiterations = 1;
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "BoundaryCondition.hpp"
+#include "Concepts.hpp"
+#include "GenericID.hpp"
+#include "Index.hpp"
+#include "Stencil.hpp"
+#include <array>
+#include <concepts>
+
+namespace stencil {
+
+/**
+ * \brief A transition function that updates a batch of independent grids as one wide grid.
+ *
+ * Streaming backends can process a batch of equally sized grids by streaming them back-to-back,
+ * which is equivalent to processing one grid that contains the grids of the batch side by side:
+ * The grid with the index `i` occupies the columns `i * grid_width` to `(i + 1) * grid_width - 1`
+ * of the wide grid. This adapter makes the wide grid behave like the individual grids: For every
+ * stencil, it finds the grid of the central cell, replaces the cells of neighbouring grids with the
+ * halo value, translates the cell position and the grid range to this grid and applies the grid's
+ * own transition function.
+ *
+ * The time-dependent value of the adapter contains the time-dependent values of all transition
+ * functions, so each grid receives its own.
+ *
+ * \tparam F The wrapped transition function. It may not use static values and it, as well as its
+ * time-dependent value, has to be default-constructible. Its boundary condition has to be \ref
+ * BoundaryCondition::Constant, since the cells of neighbouring grids are replaced with the halo
+ * value.
+ *
+ * \tparam max_batch_size The maximal number of grids in a batch.
+ */
+template <concepts::TransitionFunction F, uindex_t max_batch_size>
+    requires(!has_static_values<F> && boundary_condition_of<F> == BoundaryCondition::Constant &&
+             max_batch_size >= 1 && std::default_initializable<F> &&
+             std::default_initializable<typename F::TimeDependentValue>)
+class BatchTransitionFunction {
+  private:
+    using InnerStencil =
+        Stencil<typename F::Cell, F::stencil_radius, typename F::TimeDependentValue,
+                std::monostate, ConstantTableOf<F>>;
+
+  public:
+    using Cell = typename F::Cell;
+    using TimeDependentValue = std::array<typename F::TimeDependentValue, max_batch_size>;
+    using ConstantTable = ConstantTableOf<F>;
+
+    static constexpr uindex_t stencil_radius = F::stencil_radius;
+    static constexpr StencilShape stencil_shape = stencil_shape_of<F>;
+    static constexpr uindex_t n_subiterations = F::n_subiterations;
+
+    /**
+     * \brief Create a new batch transition function.
+     *
+     * \param transition_functions The transition functions of the individual grids. Unused entries
+     * are never applied, but their time-dependent values are still computed.
+     *
+     * \param grid_width The width of one individual grid.
+     *
+     * \param halo_value The value of cells outside of the individual grids.
+     */
+    BatchTransitionFunction(std::array<F, max_batch_size> transition_functions,
+                            uindex_t grid_width, Cell halo_value)
+        : transition_functions(transition_functions), grid_width(grid_width),
+          halo_value(halo_value) {}
+
+    Cell operator()(Stencil<Cell, stencil_radius, TimeDependentValue, std::monostate,
+                            ConstantTable> const &stencil) const {
+        // Find the grid of the central cell. This is done with comparisons instead of a division
+        // since the latter is expensive on FPGAs.
+        uindex_t i_grid = 0;
+#pragma unroll
+        for (uindex_t i = 1; i < max_batch_size; i++) {
+            if (stencil.id.c >= index_t(i * grid_width)) {
+                i_grid = i;
+            }
+        }
+        index_t c = stencil.id.c - index_t(i_grid * grid_width);
+
+        InnerStencil inner_stencil(ID(c, stencil.id.r), UID(grid_width, stencil.grid_range.r),
+                                   stencil.iteration, stencil.subiteration,
+                                   stencil.time_dependent_value[i_grid], std::monostate(),
+                                   stencil.get_constant_table_ptr());
+#pragma unroll
+        for (uindex_t stencil_c = 0; stencil_c < InnerStencil::diameter; stencil_c++) {
+            index_t cell_c = c + index_t(stencil_c) - index_t(stencil_radius);
+            bool within_grid = cell_c >= 0 && cell_c < index_t(grid_width);
+#pragma unroll
+            for (uindex_t stencil_r = 0; stencil_r < InnerStencil::diameter; stencil_r++) {
+                inner_stencil[UID(stencil_c, stencil_r)] =
+                    within_grid ? stencil[UID(stencil_c, stencil_r)] : halo_value;
+            }
+        }
+
+        return transition_functions[i_grid](inner_stencil);
+    }
+
+    TimeDependentValue get_time_dependent_value(uindex_t i_iteration) const {
+        TimeDependentValue values;
+#pragma unroll
+        for (uindex_t i = 0; i < max_batch_size; i++) {
+            values[i] = transition_functions[i].get_time_dependent_value(i_iteration);
+        }
+        return values;
+    }
+
+  private:
+    std::array<F, max_batch_size> transition_functions;
+    uindex_t grid_width;
+    Cell halo_value;
+};
+
+} // namespace stencil
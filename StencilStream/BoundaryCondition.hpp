@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+
+namespace stencil {
+
+/**
+ * \brief The values that the stencil updaters present for cells outside of the grid.
+ *
+ * Transition functions often have to treat the cells at the grid borders specially, for example by
+ * replacing the missing neighbours with the cell itself. Instead of branching on the cell position
+ * in the transition function, an application may select a boundary condition with the
+ * `boundary_condition` constant of its transition function. The updaters then fill the stencils of
+ * the border cells accordingly, so that the transition function never sees the difference.
+ */
+enum class BoundaryCondition {
+    /// \brief Cells outside of the grid have the halo value of the updater parameters.
+    Constant,
+
+    /// \brief Cells outside of the grid have the value of the nearest cell within the grid.
+    Clamp,
+
+    /// \brief The grid is mirrored at its borders, including the border cells themselves. For
+    /// example, the column `-1` has the value of column `0` and column `-2` the value of column
+    /// `1`.
+    Reflect,
+
+    /// \brief The grid wraps around at its borders. For example, the column `-1` has the value of
+    /// the last column.
+    Periodic,
+};
+
+/**
+ * \brief Map an index along one axis into the grid according to a boundary condition.
+ *
+ * Indices within `[0, size)` are returned as they are, just like all indices with the \ref
+ * BoundaryCondition::Constant "constant" boundary condition.
+ *
+ * \param boundary_condition The boundary condition to apply.
+ *
+ * \param i The index to map.
+ *
+ * \param size The number of cells along the axis. It has to be positive.
+ */
+inline constexpr index_t apply_boundary_condition(BoundaryCondition boundary_condition, index_t i,
+                                                  index_t size) {
+    if (i >= 0 && i < size) {
+        return i;
+    }
+    switch (boundary_condition) {
+    case BoundaryCondition::Clamp:
+        return (i < 0) ? 0 : size - 1;
+    case BoundaryCondition::Reflect: {
+        index_t period = 2 * size;
+        index_t folded = ((i % period) + period) % period;
+        return (folded < size) ? folded : period - 1 - folded;
+    }
+    case BoundaryCondition::Periodic:
+        return ((i % size) + size) % size;
+    default:
+        return i;
+    }
+}
+
+/**
+ * \brief Compute the offset within a stencil that holds the value of another stencil offset under a
+ * local boundary condition.
+ *
+ * For the \ref BoundaryCondition::Clamp "clamp" and \ref BoundaryCondition::Reflect "reflect"
+ * boundary conditions, the value of a cell outside of the grid is always the value of a cell that
+ * is at most as far away from the central cell. Therefore, the stencil updaters can fill the
+ * stencils of border cells by reading other cells of the same stencil, without additional memory
+ * accesses. For all other boundary conditions, or if the central cell itself lies outside of the
+ * grid, the offset is returned as it is.
+ *
+ * The boundary condition is a template parameter and the result is computed with comparisons and
+ * subtractions only, so that the FPGA kernels don't synthesize any logic for the other boundary
+ * conditions or a modulo. Reflected offsets are only correct if the absolute value of `offset`
+ * doesn't exceed `size`, which the updaters ensure by rejecting grids that are smaller than the
+ * stencil radius.
+ *
+ * \tparam boundary_condition The boundary condition to apply.
+ *
+ * \param center The index of the central cell of the stencil along the axis.
+ *
+ * \param offset The offset of the requested cell relative to the central cell.
+ *
+ * \param size The number of cells of the grid along the axis.
+ */
+template <BoundaryCondition boundary_condition>
+inline constexpr index_t remap_stencil_offset(index_t center, index_t offset, index_t size) {
+    if constexpr (boundary_condition == BoundaryCondition::Clamp ||
+                  boundary_condition == BoundaryCondition::Reflect) {
+        index_t i = center + offset;
+        if (center < 0 || center >= size || (i >= 0 && i < size)) {
+            return offset;
+        }
+        if constexpr (boundary_condition == BoundaryCondition::Clamp) {
+            return (i < 0) ? -center : size - 1 - center;
+        } else {
+            // The index `i` is mirrored to `-1 - i` at the lower border and to `2 * size - 1 - i`
+            // at the upper border.
+            return (i < 0) ? -1 - 2 * center - offset : 2 * (size - center) - 1 - offset;
+        }
+    } else {
+        return offset;
+    }
+}
+
+} // namespace stencil
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace stencil {
+
+/**
+ * \brief A view of cells that are stored in wrappers like \ref Padded or \ref Packed.
+ *
+ * Grids store their cells in arrays of wrapper objects, whose `value` member holds the actual
+ * cell. This view presents such an array as a sequence of the cells themselves, so that host code
+ * can walk the storage of a grid directly, with plain pointer increments. The view also is a
+ * random-access range. It can therefore be used in range-based for loops and with the standard
+ * algorithms, and it can be split among threads.
+ *
+ * \tparam Cell The cell type. If it's `const`, the cells can only be read.
+ *
+ * \tparam Stored The wrapper type, with the same constness as `Cell`.
+ */
+template <typename Cell, typename Stored> class CellView {
+  public:
+    /**
+     * \brief A random-access iterator over the cells of a \ref CellView.
+     */
+    class iterator {
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<Cell>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Cell *;
+        using reference = Cell &;
+
+        iterator() = default;
+
+        explicit iterator(Stored *stored) : stored(stored) {}
+
+        reference operator*() const { return stored->value; }
+
+        pointer operator->() const { return &stored->value; }
+
+        reference operator[](difference_type n) const { return stored[n].value; }
+
+        iterator &operator++() {
+            stored++;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            stored++;
+            return old;
+        }
+
+        iterator &operator--() {
+            stored--;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            iterator old = *this;
+            stored--;
+            return old;
+        }
+
+        iterator &operator+=(difference_type n) {
+            stored += n;
+            return *this;
+        }
+
+        iterator &operator-=(difference_type n) {
+            stored -= n;
+            return *this;
+        }
+
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+
+        friend difference_type operator-(iterator const &a, iterator const &b) {
+            return a.stored - b.stored;
+        }
+
+        auto operator<=>(iterator const &other) const = default;
+
+      private:
+        Stored *stored = nullptr;
+    };
+
+    /**
+     * \brief Create a view of `size` cells, starting with the one in `*data`.
+     */
+    CellView(Stored *data, std::size_t size) : data(data), n_cells(size) {}
+
+    /**
+     * \brief Return an iterator to the first cell.
+     */
+    iterator begin() const { return iterator(data); }
+
+    /**
+     * \brief Return an iterator past the last cell.
+     */
+    iterator end() const { return iterator(data + n_cells); }
+
+    /**
+     * \brief Return the number of cells in the view.
+     */
+    std::size_t size() const { return n_cells; }
+
+    /**
+     * \brief Access the `i`-th cell of the view.
+     */
+    Cell &operator[](std::size_t i) const { return data[i].value; }
+
+  private:
+    Stored *data;
+    std::size_t n_cells;
+};
+
+} // namespace stencil
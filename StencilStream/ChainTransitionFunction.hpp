@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "BoundaryCondition.hpp"
+#include "Concepts.hpp"
+#include "GenericID.hpp"
+#include "Index.hpp"
+#include "Stencil.hpp"
+#include "StencilShape.hpp"
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <tuple>
+#include <utility>
+
+namespace stencil {
+
+/**
+ * \brief A stage of a \ref ChainTransitionFunction.
+ *
+ * \tparam F The transition function of the stage.
+ *
+ * \tparam n_repetitions The number of iterations of `F` that are computed in every iteration of
+ * the chain.
+ */
+template <concepts::TransitionFunction F, uindex_t n_repetitions = 1>
+    requires(n_repetitions >= 1)
+struct ChainStage {
+    using TransitionFunction = F;
+    static constexpr uindex_t repetitions = n_repetitions;
+};
+
+/**
+ * \brief A transition function that applies a sequence of transition functions one after another.
+ *
+ * Applications like thermal convection alternate between different transition functions on the
+ * same cells. With one stencil updater per transition function, every switch between them is a
+ * round trip through global memory, and an FPGA design contains an independent pipeline for each
+ * of them. This adapter fuses the transition functions into one: Every iteration of the chain
+ * consists of `n_repetitions` iterations of the first stage's transition function, followed by the
+ * iterations of the second stage, and so on. The sub-iterations of the stages become sub-iterations
+ * of the chain, so a stencil updater streams the cells through all stages in one chain of
+ * processing elements without storing the intermediate results.
+ *
+ * The stages see their own iteration indices: In the iteration `i` of the chain, the repetition
+ * `j` of a stage with `n` repetitions is the iteration `i * n + j` of the stage's transition
+ * function. The time-dependent values of the chain contain the time-dependent values of all these
+ * iterations. The stencil radius and the stencil shape of the chain cover the stencils of all
+ * stages, and every stage receives a stencil with its own radius.
+ *
+ * For example, `ChainTransitionFunction<ChainStage<PseudoTransientKernel, 8>,
+ * ChainStage<ThermalSolverKernel>>` computes eight pseudo-transient iterations and one thermal
+ * solver iteration per iteration. With three and two sub-iterations, it has 26 sub-iterations.
+ *
+ * \tparam Stages The \ref ChainStage "stages" of the chain. Their transition functions have to use
+ * the same cell type, constant table and boundary condition, and they may not use static values or
+ * reductions.
+ */
+template <typename... Stages>
+    requires(sizeof...(Stages) >= 1) &&
+            (std::same_as<typename Stages::TransitionFunction::Cell,
+                          typename std::tuple_element_t<
+                              0, std::tuple<Stages...>>::TransitionFunction::Cell> &&
+             ...) &&
+            (std::same_as<ConstantTableOf<typename Stages::TransitionFunction>,
+                          ConstantTableOf<typename std::tuple_element_t<
+                              0, std::tuple<Stages...>>::TransitionFunction>> &&
+             ...) &&
+            ((boundary_condition_of<typename Stages::TransitionFunction> ==
+              boundary_condition_of<
+                  typename std::tuple_element_t<0, std::tuple<Stages...>>::TransitionFunction>) &&
+             ...) &&
+            (!has_static_values<typename Stages::TransitionFunction> && ...) &&
+            (!has_reduction<typename Stages::TransitionFunction> && ...)
+class ChainTransitionFunction {
+  private:
+    template <uindex_t i_stage> using Stage = std::tuple_element_t<i_stage, std::tuple<Stages...>>;
+
+    template <uindex_t i_stage>
+    using StageTransFunc = typename Stage<i_stage>::TransitionFunction;
+
+    static constexpr uindex_t n_stages = sizeof...(Stages);
+
+    /// \brief The sub-iterations of the chain with which the stages begin, and the total number.
+    static constexpr std::array<uindex_t, n_stages + 1> stage_begins = [] {
+        std::array<uindex_t, n_stages> n_stage_subiterations = {
+            (Stages::repetitions * Stages::TransitionFunction::n_subiterations)...};
+        std::array<uindex_t, n_stages + 1> begins = {0};
+        for (uindex_t i = 0; i < n_stages; i++) {
+            begins[i + 1] = begins[i] + n_stage_subiterations[i];
+        }
+        return begins;
+    }();
+
+  public:
+    using Cell = typename StageTransFunc<0>::Cell;
+    using TimeDependentValue =
+        std::tuple<std::array<typename Stages::TransitionFunction::TimeDependentValue,
+                              Stages::repetitions>...>;
+    using ConstantTable = ConstantTableOf<StageTransFunc<0>>;
+
+    static constexpr uindex_t stencil_radius =
+        std::max({Stages::TransitionFunction::stencil_radius...});
+    static constexpr StencilShape stencil_shape = [] {
+        StencilShape shape = stencil_shape_of<StageTransFunc<0>>;
+        ((shape = shape.unite(stencil_shape_of<typename Stages::TransitionFunction>)), ...);
+        return shape;
+    }();
+    static constexpr BoundaryCondition boundary_condition =
+        boundary_condition_of<StageTransFunc<0>>;
+    static constexpr uindex_t n_subiterations = stage_begins[n_stages];
+
+    /**
+     * \brief Create a new chain of transition functions.
+     *
+     * \param transition_functions The transition functions of the stages, in order.
+     */
+    ChainTransitionFunction(typename Stages::TransitionFunction... transition_functions)
+        : transition_functions(transition_functions...) {}
+
+    ChainTransitionFunction()
+        requires(std::default_initializable<typename Stages::TransitionFunction> && ...)
+    = default;
+
+    Cell operator()(Stencil<Cell, stencil_radius, TimeDependentValue, std::monostate,
+                            ConstantTable> const &stencil) const {
+        Cell new_cell = stencil[ID(0, 0)];
+        apply_stages(stencil, new_cell, std::make_index_sequence<n_stages>());
+        return new_cell;
+    }
+
+    TimeDependentValue get_time_dependent_value(uindex_t i_iteration) const {
+        TimeDependentValue values;
+        collect_time_dependent_values(i_iteration, values, std::make_index_sequence<n_stages>());
+        return values;
+    }
+
+  private:
+    template <std::size_t... i_stage>
+    void apply_stages(Stencil<Cell, stencil_radius, TimeDependentValue, std::monostate,
+                              ConstantTable> const &stencil,
+                      Cell &new_cell, std::index_sequence<i_stage...>) const {
+        (apply_stage<i_stage>(stencil, new_cell), ...);
+    }
+
+    /**
+     * \brief Apply the transition function of the given stage if the stencil's sub-iteration
+     * belongs to it.
+     */
+    template <uindex_t i_stage>
+    void apply_stage(Stencil<Cell, stencil_radius, TimeDependentValue, std::monostate,
+                             ConstantTable> const &stencil,
+                     Cell &new_cell) const {
+        using F = StageTransFunc<i_stage>;
+        using InnerStencil = Stencil<Cell, F::stencil_radius, typename F::TimeDependentValue,
+                                     std::monostate, ConstantTable>;
+        constexpr uindex_t n_repetitions = Stage<i_stage>::repetitions;
+        constexpr uindex_t offset = stencil_radius - F::stencil_radius;
+
+        if (stencil.subiteration < stage_begins[i_stage] ||
+            stencil.subiteration >= stage_begins[i_stage + 1]) {
+            return;
+        }
+        uindex_t stage_subiteration = stencil.subiteration - stage_begins[i_stage];
+        uindex_t i_repetition = stage_subiteration / F::n_subiterations;
+
+        InnerStencil inner_stencil(
+            stencil.id, stencil.grid_range, stencil.iteration * n_repetitions + i_repetition,
+            stage_subiteration % F::n_subiterations,
+            std::get<i_stage>(stencil.time_dependent_value)[i_repetition], std::monostate(),
+            stencil.get_constant_table_ptr());
+#pragma unroll
+        for (uindex_t c = 0; c < InnerStencil::diameter; c++) {
+#pragma unroll
+            for (uindex_t r = 0; r < InnerStencil::diameter; r++) {
+                inner_stencil[UID(c, r)] = stencil[UID(c + offset, r + offset)];
+            }
+        }
+
+        new_cell = std::get<i_stage>(transition_functions)(inner_stencil);
+    }
+
+    template <std::size_t... i_stage>
+    void collect_time_dependent_values(uindex_t i_iteration, TimeDependentValue &values,
+                                       std::index_sequence<i_stage...>) const {
+        (collect_stage_time_dependent_values<i_stage>(i_iteration, values), ...);
+    }
+
+    template <uindex_t i_stage>
+    void collect_stage_time_dependent_values(uindex_t i_iteration,
+                                             TimeDependentValue &values) const {
+        constexpr uindex_t n_repetitions = Stage<i_stage>::repetitions;
+        auto const &transition_function = std::get<i_stage>(transition_functions);
+#pragma unroll
+        for (uindex_t i = 0; i < n_repetitions; i++) {
+            std::get<i_stage>(values)[i] =
+                transition_function.get_time_dependent_value(i_iteration * n_repetitions + i);
+        }
+    }
+
+    std::tuple<typename Stages::TransitionFunction...> transition_functions;
+};
+
+} // namespace stencil
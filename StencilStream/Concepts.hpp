@@ -21,15 +21,313 @@
  * SOFTWARE.
  */
 #pragma once
+#include "BoundaryCondition.hpp"
 #include "Index.hpp"
 #include "Stencil.hpp"
+#include "Stencil3D.hpp"
+#include "StencilShape.hpp"
 
+#include <array>
 #include <concepts>
 #include <type_traits>
+#include <variant>
+#include <vector>
 
 namespace stencil {
+
+/**
+ * \brief The type of the static values of a transition function.
+ *
+ * This is `T::StaticValue` if the transition function defines it, and `std::monostate` otherwise.
+ * See \ref stencil::concepts::TransitionFunction "TransitionFunction" for the static value feature.
+ */
+template <typename T> struct StaticValueOfImpl {
+    using type = std::monostate;
+};
+
+template <typename T>
+    requires requires { typename T::StaticValue; }
+struct StaticValueOfImpl<T> {
+    using type = typename T::StaticValue;
+};
+
+/// \brief Shorthand for the static value type of a transition function.
+template <typename T> using StaticValueOf = typename StaticValueOfImpl<T>::type;
+
+/**
+ * \brief Check whether the transition function uses static values.
+ *
+ * This is the case if it defines a `StaticValue` type other than `std::monostate`.
+ */
+template <typename T>
+constexpr bool has_static_values = !std::same_as<StaticValueOf<T>, std::monostate>;
+
+/**
+ * \brief The type of the reduction of a transition function.
+ *
+ * This is `T::Reduction` if the transition function defines it, and `std::monostate` otherwise.
+ * See \ref stencil::concepts::Reduction "Reduction" for the reduction feature.
+ */
+template <typename T> struct ReductionOfImpl {
+    using type = std::monostate;
+};
+
+template <typename T>
+    requires requires { typename T::Reduction; }
+struct ReductionOfImpl<T> {
+    using type = typename T::Reduction;
+};
+
+/// \brief Shorthand for the reduction type of a transition function.
+template <typename T> using ReductionOf = typename ReductionOfImpl<T>::type;
+
+/**
+ * \brief Check whether the transition function supports fused reductions.
+ *
+ * This is the case if it defines a `Reduction` type other than `std::monostate`.
+ */
+template <typename T>
+constexpr bool has_reduction = !std::same_as<ReductionOf<T>, std::monostate>;
+
+/**
+ * \brief The type of the constant table of a transition function.
+ *
+ * This is `T::ConstantTable` if the transition function defines it, and `std::monostate`
+ * otherwise. See \ref stencil::ConstantTable for the constant table feature.
+ */
+template <typename T> struct ConstantTableOfImpl {
+    using type = std::monostate;
+};
+
+template <typename T>
+    requires requires { typename T::ConstantTable; }
+struct ConstantTableOfImpl<T> {
+    using type = typename T::ConstantTable;
+};
+
+/// \brief Shorthand for the constant table type of a transition function.
+template <typename T> using ConstantTableOf = typename ConstantTableOfImpl<T>::type;
+
+/**
+ * \brief Check whether the transition function uses a constant table.
+ *
+ * This is the case if it defines a `ConstantTable` type other than `std::monostate`.
+ */
+template <typename T>
+constexpr bool has_constant_table = !std::same_as<ConstantTableOf<T>, std::monostate>;
+
+/**
+ * \brief The type of the host stream of a transition function.
+ *
+ * This is `T::HostStream` if the transition function defines it, and `std::monostate` otherwise.
+ * See \ref stencil::concepts::HostStream "HostStream" for the host stream feature.
+ */
+template <typename T> struct HostStreamOfImpl {
+    using type = std::monostate;
+};
+
+template <typename T>
+    requires requires { typename T::HostStream; }
+struct HostStreamOfImpl<T> {
+    using type = typename T::HostStream;
+};
+
+/// \brief Shorthand for the host stream type of a transition function.
+template <typename T> using HostStreamOf = typename HostStreamOfImpl<T>::type;
+
+/**
+ * \brief Check whether the transition function supports streaming cells to the host.
+ *
+ * This is the case if it defines a `HostStream` type other than `std::monostate`.
+ */
+template <typename T>
+constexpr bool has_host_stream = !std::same_as<HostStreamOf<T>, std::monostate>;
+
+/**
+ * \brief The number of past time levels that a transition function reads.
+ *
+ * This is `T::history_length` if the transition function defines it, and zero otherwise. See
+ * \ref stencil::HistoryTransitionFunction for the history feature.
+ */
+template <typename T> struct HistoryLengthOfImpl : std::integral_constant<uindex_t, 0> {};
+
+template <typename T>
+    requires requires {
+        { T::history_length } -> std::convertible_to<uindex_t>;
+    }
+struct HistoryLengthOfImpl<T> : std::integral_constant<uindex_t, T::history_length> {};
+
+/// \brief Shorthand for the history length of a transition function.
+template <typename T> constexpr uindex_t history_length_of = HistoryLengthOfImpl<T>::value;
+
+/**
+ * \brief Check whether the transition function reads past time levels of the central cell.
+ *
+ * This is the case if it defines a `history_length` greater than zero.
+ */
+template <typename T> constexpr bool has_history = history_length_of<T> != 0;
+
+/**
+ * \brief The type of the values that are kept for past time levels of a cell.
+ *
+ * This is `T::HistoryValue` if the transition function defines it, and `T::Cell` otherwise.
+ */
+template <typename T> struct HistoryValueOfImpl {
+    using type = typename T::Cell;
+};
+
+template <typename T>
+    requires requires { typename T::HistoryValue; }
+struct HistoryValueOfImpl<T> {
+    using type = typename T::HistoryValue;
+};
+
+/// \brief Shorthand for the history value type of a transition function.
+template <typename T> using HistoryValueOf = typename HistoryValueOfImpl<T>::type;
+
+/**
+ * \brief The type of the past time levels in the stencils of a transition function.
+ *
+ * This is an array of \ref HistoryValueOf "history values" if the transition function \ref
+ * has_history "has a history", and `std::monostate` otherwise.
+ */
+template <typename T>
+using HistoryOf = std::conditional_t<has_history<T>,
+                                     std::array<HistoryValueOf<T>, history_length_of<T>>,
+                                     std::monostate>;
+
+/**
+ * \brief The shape of the stencil of a transition function.
+ *
+ * This is `T::stencil_shape` if the transition function defines it, and a box with the radius
+ * `T::stencil_radius` otherwise. See \ref stencil::StencilShape for the stencil shape feature.
+ */
+template <typename T> struct StencilShapeOfImpl {
+    static constexpr StencilShape value = StencilShape::box(T::stencil_radius);
+};
+
+template <typename T>
+    requires requires {
+        { T::stencil_shape } -> std::convertible_to<StencilShape>;
+    }
+struct StencilShapeOfImpl<T> {
+    static constexpr StencilShape value = T::stencil_shape;
+};
+
+/// \brief Shorthand for the stencil shape of a transition function.
+template <typename T> constexpr StencilShape stencil_shape_of = StencilShapeOfImpl<T>::value;
+
+/**
+ * \brief The boundary condition of a transition function.
+ *
+ * This is `T::boundary_condition` if the transition function defines it, and \ref
+ * BoundaryCondition::Constant otherwise. See \ref stencil::BoundaryCondition for the available
+ * boundary conditions.
+ */
+template <typename T> struct BoundaryConditionOfImpl {
+    static constexpr BoundaryCondition value = BoundaryCondition::Constant;
+};
+
+template <typename T>
+    requires requires {
+        { T::boundary_condition } -> std::convertible_to<BoundaryCondition>;
+    }
+struct BoundaryConditionOfImpl<T> {
+    static constexpr BoundaryCondition value = T::boundary_condition;
+};
+
+/// \brief Shorthand for the boundary condition of a transition function.
+template <typename T>
+constexpr BoundaryCondition boundary_condition_of = BoundaryConditionOfImpl<T>::value;
+
 namespace concepts {
 
+/**
+ * \brief A reduction of all cells of a grid to a single value.
+ *
+ * Stencil updates evaluate reductions while the cells of the last pass are written back, so that
+ * only the reduced value has to be transferred to the host. The required type definitions and
+ * methods are:
+ * * `Value`: The type of the reduced value. It must be semiregular.
+ * * `Value identity() const`: Return the identity element of the `combine` operation.
+ * * `Value map(Cell const &cell) const`: Compute the value of a single cell.
+ * * `Value combine(Value const &a, Value const &b) const`: Combine two values.
+ *
+ * The `combine` operation must be associative and commutative since the cells are combined in an
+ * unspecified order and in multiple partial results. All methods must be pure.
+ *
+ * \tparam R The reduction type.
+ *
+ * \tparam Cell The cell type of the reduced grids.
+ */
+template <typename R, typename Cell>
+concept Reduction =
+    std::copyable<R> && requires(R const &reduction, Cell const &cell) {
+        typename R::Value;
+        { reduction.identity() } -> std::same_as<typename R::Value>;
+        { reduction.map(cell) } -> std::same_as<typename R::Value>;
+        {
+            reduction.combine(reduction.identity(), reduction.identity())
+        } -> std::same_as<typename R::Value>;
+    } && std::semiregular<typename R::Value>;
+
+/**
+ * \brief A selection of cells that the stencil updates send to the host while they compute.
+ *
+ * Stencil updates that support host streams send the selected cells of every pass through a pipe
+ * to the host, in addition to writing them to the target grid. This way, the host can analyze
+ * intermediate results, for example the values at some detector cells, without waiting for the
+ * update to complete and without reading them from the grid. The required type definitions and
+ * methods are:
+ * * `pipe`: The pipe that the cells are written to, as \ref stencil::StreamedCell
+ * "StreamedCells". Usually, this is a host pipe that the host reads from while the update is
+ * running.
+ * * `bool selects(ID id, uindex_t i_iteration) const`: Check whether the cell at the given
+ * position is sent to the host after the given iteration. This method must be pure.
+ *
+ * \tparam S The host stream type.
+ */
+template <typename S>
+concept HostStream = std::copyable<S> && requires(S const &stream, ID id, uindex_t i_iteration) {
+    typename S::pipe;
+    { stream.selects(id, i_iteration) } -> std::convertible_to<bool>;
+};
+
+/**
+ * \brief Check that the transition function either has no host stream or a valid one.
+ */
+template <typename T>
+constexpr bool has_valid_host_stream = !has_host_stream<T> || HostStream<HostStreamOf<T>>;
+
+/**
+ * \brief Check that the transition function either has no reduction or a valid one.
+ *
+ * This is a variable instead of a disjunction in the \ref stencil::concepts::TransitionFunction
+ * "TransitionFunction" concept since some compilers fail to short-circuit such disjunctions
+ * when the reduction type is `std::monostate`.
+ */
+template <typename T>
+constexpr bool has_valid_reduction =
+    !has_reduction<T> || Reduction<ReductionOf<T>, typename T::Cell>;
+
+/**
+ * \brief Check that the transition function can extract its history values from its cells.
+ *
+ * This is always the case if it keeps whole cells. If it defines a `HistoryValue` type, it has to
+ * provide a static `history_value` method.
+ */
+template <typename T>
+constexpr bool has_valid_history =
+    !requires { typename T::HistoryValue; } || requires(typename T::Cell const &cell) {
+        { T::history_value(cell) } -> std::same_as<HistoryValueOf<T>>;
+    };
+
+/**
+ * \brief Check that the stencil shape of the transition function fits into its stencil.
+ */
+template <typename T>
+constexpr bool has_valid_stencil_shape = stencil_shape_of<T>.radius() <= T::stencil_radius;
+
 /**
  * \brief A technical definition of a stencil transition function.
  *
@@ -45,15 +343,55 @@ namespace concepts {
  * * `TimeDependentValue`: The type of the time-dependent value computed by the
  * `get_time_dependent_value` method. It must also be semiregular.
  *
+ * The optional type definitions are:
+ * * `StaticValue`: The type of read-only, per-cell values that are stored in a separate grid and
+ * never written back, for example the power dissipation of a chip or the material of a cell. The
+ * static value of the central cell is available as `stencil.static_value`. If this type isn't
+ * defined or is `std::monostate`, the feature is disabled. See \ref stencil::StaticValueOf.
+ * * `Reduction`: A \ref stencil::concepts::Reduction "reduction" of the cells that the stencil
+ * updates may compute on the device after the last iteration, for example the maximal change of a
+ * simulation. If this type isn't defined or is `std::monostate`, the feature is disabled. See \ref
+ * stencil::ReductionOf.
+ * * `ConstantTable`: A \ref stencil::ConstantTable "table of constants" that all processing
+ * elements share, for example material coefficients. Its contents are set in the `constant_table`
+ * field of the updater parameters and it's available as `stencil.constant_table()`. If this type
+ * isn't defined or is `std::monostate`, the feature is disabled. See \ref stencil::ConstantTableOf.
+ * * `HostStream`: A \ref stencil::concepts::HostStream "selection of cells" that the stencil
+ * updates may send to the host while they compute. Its instance is set in the `host_stream` field
+ * of the updater parameters. If this type isn't defined or is `std::monostate`, the feature is
+ * disabled. See \ref stencil::HostStreamOf.
+ * * `HistoryValue`: The type of the values that are kept for past time levels of the central cell,
+ * for example a single field of the cell. If it's defined, the transition function also has to
+ * provide a static `HistoryValue history_value(Cell const &cell)` method that extracts it from a
+ * cell. Otherwise, whole cells are kept. See \ref stencil::HistoryValueOf.
+ *
  * The required constants are:
  * * `uindex_t stencil_radius`: The radius of the stencil. It must be greater than or equal to 1.
  * * `uindex_t n_subiterations`: The number of sub-iterations of the transition function. It must be
  * greater than or equal to 1.
  *
+ * The optional constants are:
+ * * `StencilShape stencil_shape`: The \ref stencil::StencilShape "shape" of the cells the
+ * transition function reads from the stencil. It must fit into the stencil radius. If it isn't
+ * defined, the transition function may read all cells of the stencil. See \ref
+ * stencil::stencil_shape_of.
+ * * `BoundaryCondition boundary_condition`: The \ref stencil::BoundaryCondition "values" that the
+ * stencil updates present for cells outside of the grid. Since the boundary condition is a
+ * constant, the kernels of the FPGA backends only contain the logic for the selected condition.
+ * If it isn't defined, cells outside of the grid have the halo value of the updater parameters.
+ * See \ref stencil::boundary_condition_of.
+ * * `uindex_t history_length`: The number of past time levels of the central cell that are
+ * available as `stencil.previous(1)` to `stencil.previous(history_length)`, for example one for a
+ * leapfrog scheme. Transition functions with a history have to be wrapped in a \ref
+ * stencil::HistoryTransitionFunction before they are passed to a stencil update. If this constant
+ * isn't defined or is zero, the feature is disabled. See \ref stencil::history_length_of.
+ *
  * The required methods are:
- * * `Cell operator()(Stencil<Cell, stencil_radius> const&stencil) const`: Compute the next
- * iteration of the stencil's central cell. This method must be pure, i.e. it must not modify either
- * the stencil's or the transition function's state.
+ * * `Cell operator()(Stencil<Cell, stencil_radius, TimeDependentValue, StaticValue, ConstantTable,
+ * History> const&stencil) const`: Compute the next
+ * iteration of the stencil's central cell, where `History` is \ref stencil::HistoryOf
+ * "HistoryOf<T>". This method must be pure, i.e. it must not modify either the stencil's or the
+ * transition function's state.
  * * `TimeDependentValue get_time_dependent_value(uindex_t i_iteration) const`: Compute the
  * time-dependent value for the given iteration. This method must be pure, i.e. it must not modify
  * the transition function's state.
@@ -61,13 +399,16 @@ namespace concepts {
 template <typename T>
 concept TransitionFunction =
     std::semiregular<typename T::Cell> && std::copyable<typename T::TimeDependentValue> &&
+    std::semiregular<StaticValueOf<T>> &&
+    has_valid_reduction<T> && has_valid_host_stream<T> && has_valid_history<T> &&
 
     std::same_as<decltype(T::stencil_radius), const uindex_t> && (T::stencil_radius >= 1) &&
+    has_valid_stencil_shape<T> &&
     std::same_as<decltype(T::n_subiterations), const uindex_t> && (T::n_subiterations >= 1) &&
 
     requires(T const &trans_func,
-             Stencil<typename T::Cell, T::stencil_radius, typename T::TimeDependentValue> const
-                 &stencil) {
+             Stencil<typename T::Cell, T::stencil_radius, typename T::TimeDependentValue,
+                     StaticValueOf<T>, ConstantTableOf<T>, HistoryOf<T>> const &stencil) {
         { trans_func(stencil) } -> std::same_as<typename T::Cell>;
     } &&
     requires(T const &trans_func, uindex_t i_iteration) {
@@ -170,5 +511,121 @@ concept StencilUpdate =
     } && TransitionFunction<TF> && Grid<G, typename TF::Cell> &&
     (std::is_class<typename SU::Params>::value);
 
+/**
+ * \brief A transition function for three-dimensional stencil codes.
+ *
+ * This is the three-dimensional version of \ref stencil::concepts::TransitionFunction
+ * "TransitionFunction". It has the same required type definitions, constants and methods, except
+ * that the `operator()` receives a \ref stencil::Stencil3D "Stencil3D":
+ *
+ * * `Cell operator()(Stencil3D<Cell, stencil_radius, TimeDependentValue> const &stencil) const`
+ *
+ * The optional features of two-dimensional transition functions, like static values, are not
+ * supported for three-dimensional ones.
+ */
+template <typename T>
+concept TransitionFunction3D =
+    std::semiregular<typename T::Cell> && std::copyable<typename T::TimeDependentValue> &&
+
+    std::same_as<decltype(T::stencil_radius), const uindex_t> && (T::stencil_radius >= 1) &&
+    std::same_as<decltype(T::n_subiterations), const uindex_t> && (T::n_subiterations >= 1) &&
+
+    requires(T const &trans_func,
+             Stencil3D<typename T::Cell, T::stencil_radius, typename T::TimeDependentValue> const
+                 &stencil) {
+        { trans_func(stencil) } -> std::same_as<typename T::Cell>;
+    } &&
+    requires(T const &trans_func, uindex_t i_iteration) {
+        {
+            trans_func.get_time_dependent_value(i_iteration)
+        } -> std::same_as<typename T::TimeDependentValue>;
+    };
+
+/**
+ * \brief An accessor for a three-dimensional grid.
+ *
+ * It must provide access either via a `sycl::id<3>` object or via three consecutive accesses with
+ * `uindex_t`s.
+ */
+template <typename Accessor, typename Cell>
+concept GridAccessor3D = requires(Accessor ac, uindex_t c, uindex_t r, uindex_t l) {
+    { ac[sycl::id<3>(c, r, l)] } -> std::same_as<Cell &>;
+    { ac[c][r][l] } -> std::same_as<Cell &>;
+};
+
+/**
+ * \brief A regular, three-dimensional grid of cells.
+ *
+ * This is the three-dimensional version of \ref stencil::concepts::Grid "Grid". The constructors
+ * take an additional depth, or number of layers, and the buffers and ranges are
+ * three-dimensional. Additionally, a grid must implement `uindex_t get_grid_depth()` and its
+ * `GridAccessor` must fulfill the \ref stencil::concepts::GridAccessor3D "GridAccessor3D"
+ * concept.
+ */
+template <typename G, typename Cell>
+concept Grid3D = requires(G &grid, sycl::buffer<Cell, 3> buffer, uindex_t c, uindex_t r,
+                          uindex_t l, Cell cell) {
+    { G(c, r, l) } -> std::same_as<G>;
+    { G(sycl::range<3>(c, r, l)) } -> std::same_as<G>;
+    { G(buffer) } -> std::same_as<G>;
+    { grid.copy_from_buffer(buffer) } -> std::same_as<void>;
+    { grid.copy_to_buffer(buffer) } -> std::same_as<void>;
+    { grid.get_grid_width() } -> std::convertible_to<uindex_t>;
+    { grid.get_grid_height() } -> std::convertible_to<uindex_t>;
+    { grid.get_grid_depth() } -> std::convertible_to<uindex_t>;
+    { grid.make_similar() } -> std::same_as<G>;
+    {
+        typename G::template GridAccessor<sycl::access::mode::read_write>(grid)
+    } -> GridAccessor3D<Cell>;
+};
+
+/**
+ * \brief A grid updater for three-dimensional stencil codes.
+ *
+ * This is the three-dimensional version of \ref stencil::concepts::StencilUpdate "StencilUpdate"
+ * with the same requirements for the parameters and methods.
+ */
+template <typename SU, typename TF, typename G>
+concept StencilUpdate3D =
+    requires(SU stencil_update, G &grid, typename SU::Params params) {
+        { SU(params) } -> std::same_as<SU>;
+        { stencil_update.get_params() } -> std::same_as<typename SU::Params &>;
+        { stencil_update(grid) } -> std::same_as<G>;
+    } &&
+    requires(typename SU::Params params) {
+        { params.transition_function } -> std::same_as<TF &>;
+        { params.halo_value } -> std::same_as<typename TF::Cell &>;
+        { params.iteration_offset } -> std::same_as<uindex_t &>;
+        { params.n_iterations } -> std::same_as<uindex_t &>;
+        { params.device } -> std::same_as<sycl::device &>;
+    } && TransitionFunction3D<TF> && Grid3D<G, typename TF::Cell> &&
+    (std::is_class<typename SU::Params>::value);
+
+/**
+ * \brief A channel between the ranks of a distributed computation.
+ *
+ * The ranks are arranged in a line, and every rank only communicates with its direct neighbors, the
+ * ranks `rank - 1` to the left and `rank + 1` to the right. A communicator must provide the
+ * following methods:
+ * * `uindex_t get_rank()`: Return the index of this rank.
+ * * `uindex_t get_n_ranks()`: Return the total number of ranks.
+ * * `void exchange(std::vector<T> const &send_left, std::vector<T> const &send_right,
+ * std::vector<T> &receive_left, std::vector<T> &receive_right)`: Send `send_left` to the left
+ * neighbor and `send_right` to the right neighbor, and receive what the left neighbor has sent to
+ * the right into `receive_left` and vice versa. The receive vectors already have the size of the
+ * expected messages. Messages to and from missing neighbors are empty and must be skipped. The
+ * method returns once all messages have been received.
+ *
+ * \tparam C The communicator type.
+ * \tparam T The type of the exchanged values.
+ */
+template <typename C, typename T>
+concept Communicator =
+    requires(C &communicator, std::vector<T> const &send, std::vector<T> &receive) {
+        { communicator.get_rank() } -> std::convertible_to<uindex_t>;
+        { communicator.get_n_ranks() } -> std::convertible_to<uindex_t>;
+        communicator.exchange(send, send, receive, receive);
+    };
+
 } // namespace concepts
 } // namespace stencil
\ No newline at end of file
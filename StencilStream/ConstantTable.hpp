@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <array>
+#include <concepts>
+
+namespace stencil {
+
+/**
+ * \brief A read-only table of constants that is shared by all processing elements.
+ *
+ * Transition functions often need small lookup tables, for example the coefficients of the
+ * materials in a simulation. If such a table is a member of the transition function, every
+ * processing element of an FPGA execution kernel has its own copy of the transition function and
+ * therefore of the table, which replicates the table in registers or ROMs once per processing
+ * element. A transition function may instead declare its table as `using ConstantTable =
+ * stencil::ConstantTable<T, size>;`. The stencil updaters then receive the contents of the table
+ * via their `Params::constant_table` field, store it once in the on-chip memory of the execution
+ * kernel and give every processing element read access to it via `stencil.constant_table()`.
+ *
+ * \tparam T The type of the table entries. It must be semiregular.
+ *
+ * \tparam table_size The number of entries in the table.
+ */
+template <std::semiregular T, uindex_t table_size>
+    requires(table_size >= 1)
+struct ConstantTable {
+    /// \brief The type of the table entries.
+    using value_type = T;
+
+    /// \brief The number of entries in the table.
+    static constexpr uindex_t size = table_size;
+
+    /**
+     * \brief Access an entry of the table.
+     */
+    T const &operator[](uindex_t i) const { return values[i]; }
+
+    /**
+     * \brief Access an entry of the table.
+     */
+    T &operator[](uindex_t i) { return values[i]; }
+
+    /// \brief The entries of the table.
+    std::array<T, table_size> values;
+};
+
+} // namespace stencil
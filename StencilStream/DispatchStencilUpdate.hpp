@@ -0,0 +1,438 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Concepts.hpp"
+#include "GridPool.hpp"
+#include "Index.hpp"
+#include "cpu/Grid.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+namespace stencil {
+
+/**
+ * \brief A stencil updater that dispatches every call to one of several other updaters.
+ *
+ * The dispatcher holds one instance of every updater in `Updaters`, for example a monotile
+ * design, a tiling design and the CPU backend that are compiled into the same executable. For
+ * every call, it picks the updater with the lowest estimated runtime for the size of the grid
+ * and the number of iterations:
+ *
+ * * Updaters that can't process the grid, like monotile designs for grids bigger than their
+ * maximum grid size, are never picked.
+ * * All estimates are walltimes of a whole call, including the conversion of the grids. The
+ * dispatcher measures them for every blocking call and every call with a grid conversion. Other
+ * calls return before the computation is complete and aren't measured.
+ * * If an updater provides a `model_runtime` function and a clock frequency is set in its
+ * parameters, its runtime is estimated with the performance model. The model only predicts the
+ * runtime of the kernels, so it's scaled by the ratio between the measured walltime and the
+ * modeled runtime of the previous calls of this updater.
+ * * Otherwise, the runtime is extrapolated from the cell update rate that the updater has achieved
+ * in previous calls.
+ * * A model that hasn't been scaled yet is a lower bound of the walltime. The updater is picked if
+ * this bound is lower than the estimates of all other updaters, which then scales its model.
+ * * Updaters without an estimate are only picked if no other updater has one, in the order of
+ * `Updaters`.
+ *
+ * All grids are exchanged as \ref cpu::Grid. If the picked updater uses a different grid type, the
+ * cells are copied into a staging grid of that type before the update and copied back afterwards.
+ * The staging grids and the returned grids are reused by later calls with the same grid size.
+ *
+ * \tparam F The transition function of all updaters.
+ *
+ * \tparam Updaters The updaters to pick from, in order of preference. They all have to use the
+ * same transition function type `F`.
+ */
+template <concepts::TransitionFunction F, typename... Updaters>
+    requires(sizeof...(Updaters) >= 1)
+class DispatchStencilUpdate {
+  private:
+    using Cell = F::Cell;
+    static constexpr uindex_t n_updaters = sizeof...(Updaters);
+    template <uindex_t i> using UpdaterImpl = std::tuple_element_t<i, std::tuple<Updaters...>>;
+
+  public:
+    /// \brief Shorthand for the grid type that is exchanged with the dispatcher.
+    using GridImpl = cpu::Grid<Cell>;
+
+    /// \brief Shorthand for the grid type of the static values.
+    using StaticGridImpl = cpu::Grid<StaticValueOf<F>>;
+
+    /**
+     * \brief Parameters for the dispatcher.
+     *
+     * Before every call, the picked updater receives its parameters from \ref updater_params.
+     * The transition function, the halo value, the iterations and the blocking flag are then
+     * overwritten with the fields of this struct, so that all updaters compute the same thing.
+     */
+    struct Params {
+        /**
+         * \brief An instance of the transition function type.
+         */
+        F transition_function;
+
+        /**
+         * \brief The cell value to present for cells outside of the grid.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The device to use for computations.
+         *
+         * This is not used by the dispatcher. Every updater uses the device from its own
+         * parameters instead.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief Should the updaters block until completion, or return immediately after all
+         * kernels have been submitted.
+         *
+         * If the picked updater uses a different grid type, the dispatcher always waits for the
+         * result to copy it back.
+         */
+        bool blocking = false;
+
+        /**
+         * \brief The parameters of the updaters, for example their devices and clock frequencies.
+         */
+        std::tuple<typename Updaters::Params...> updater_params = {};
+    };
+
+    /**
+     * \brief Create a new dispatcher and all of its updaters.
+     */
+    DispatchStencilUpdate(Params params)
+        : params(params),
+          updaters(std::make_from_tuple<std::tuple<Updaters...>>(params.updater_params)),
+          static_grid(std::nullopt), last_choice(std::nullopt), call_stats(), staging_grids(),
+          grid_pool() {}
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return a reference to the updater with the given index.
+     */
+    template <uindex_t i> UpdaterImpl<i> &get_updater() { return std::get<i>(updaters); }
+
+    /**
+     * \brief Return the index of the updater that processed the last call, if there was one.
+     */
+    std::optional<uindex_t> get_last_choice() const { return last_choice; }
+
+    /**
+     * \brief Return the grid of static values, if one has been set.
+     */
+    std::optional<StaticGridImpl> get_static_grid() const { return static_grid; }
+
+    /**
+     * \brief Set the grid of static values of all updaters.
+     *
+     * The static values are copied into the static grid types of all updaters immediately, so that
+     * later calls don't have to convert them again.
+     */
+    void set_static_grid(StaticGridImpl static_grid)
+        requires(has_static_values<F>)
+    {
+        this->static_grid = static_grid;
+        std::apply(
+            [&](Updaters &...updater) {
+                (updater.set_static_grid(
+                     convert_grid<StaticValueOf<F>, typename Updaters::StaticGridImpl>(
+                         static_grid)),
+                 ...);
+            },
+            updaters);
+    }
+
+    /**
+     * \brief Return the index of the updater that would process a call with the given grid size
+     * and number of iterations.
+     *
+     * \throws std::range_error None of the updaters can process grids of the given size.
+     */
+    uindex_t choose(uindex_t grid_width, uindex_t grid_height, uindex_t n_iterations) const {
+        Ranking ranking;
+        rank_updaters(grid_width, grid_height, n_iterations, ranking);
+        if (ranking.best_lower_bound.has_value() &&
+            ranking.lowest_bound < ranking.best_runtime) {
+            return *ranking.best_lower_bound;
+        }
+        if (ranking.best.has_value()) {
+            return *ranking.best;
+        }
+        if (ranking.fallback.has_value()) {
+            return *ranking.fallback;
+        }
+        throw std::range_error("None of the updaters supports grids of this size.");
+    }
+
+    /**
+     * \brief Compute a new grid based on the source grid with the updater from \ref choose.
+     *
+     * \throws std::range_error None of the updaters can process the grid.
+     */
+    GridImpl operator()(GridImpl &source_grid) {
+        uindex_t i_updater = choose(source_grid.get_grid_width(), source_grid.get_grid_height(),
+                                    params.n_iterations);
+        GridImpl target_grid = run_updater(i_updater, source_grid);
+        last_choice = i_updater;
+        return target_grid;
+    }
+
+  private:
+    /**
+     * \brief The measurements of the calls that an updater has processed.
+     */
+    struct CallStats {
+        /// \brief The number of cell updates of all measured calls.
+        uint64_t n_cell_updates = 0;
+        /// \brief The total walltime of all measured calls, in seconds.
+        double walltime = 0.0;
+        /// \brief The total modeled runtime of the measured calls that had a model, in seconds.
+        double modeled_runtime = 0.0;
+        /// \brief The total walltime of the measured calls that had a model, in seconds.
+        double modeled_walltime = 0.0;
+    };
+
+    /**
+     * \brief Copy the values of a grid into a grid of another type.
+     *
+     * If both types are the same, the grid is returned as it is. A \ref cpu::Grid is read from its
+     * buffer directly.
+     */
+    template <typename Value, typename TargetGrid, typename SourceGrid>
+    static TargetGrid convert_grid(SourceGrid &source_grid) {
+        if constexpr (std::is_same_v<TargetGrid, SourceGrid>) {
+            return source_grid;
+        } else if constexpr (std::is_same_v<SourceGrid, cpu::Grid<Value>>) {
+            return TargetGrid(source_grid.get_buffer());
+        } else {
+            sycl::buffer<Value, 2> buffer(
+                sycl::range<2>(source_grid.get_grid_width(), source_grid.get_grid_height()));
+            source_grid.copy_to_buffer(buffer);
+            return TargetGrid(buffer);
+        }
+    }
+
+    /**
+     * \brief Check whether the updater with the given index can process grids of the given size.
+     */
+    template <uindex_t i> static bool supports(uindex_t grid_width, uindex_t grid_height) {
+        if constexpr (requires { UpdaterImpl<i>::supports_grid_range(grid_width, grid_height); }) {
+            return UpdaterImpl<i>::supports_grid_range(grid_width, grid_height);
+        } else {
+            return true;
+        }
+    }
+
+    /**
+     * \brief Return the modeled kernel runtime of the updater with the given index in seconds, if
+     * it has a performance model and a clock frequency.
+     */
+    template <uindex_t i>
+    std::optional<double> model_runtime(uindex_t grid_width, uindex_t grid_height,
+                                        uindex_t n_iterations) const {
+        using U = UpdaterImpl<i>;
+        auto const &updater_params = std::get<i>(params.updater_params);
+        if constexpr (requires {
+                          U::model_runtime(grid_width, grid_height, n_iterations, 1.0,
+                                           updater_params.loop_latency);
+                          updater_params.clock_frequency.has_value();
+                      }) {
+            if (updater_params.clock_frequency.has_value()) {
+                return U::model_runtime(grid_width, grid_height, n_iterations,
+                                        *updater_params.clock_frequency,
+                                        updater_params.loop_latency);
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * \brief An estimated runtime of an updater.
+     */
+    struct Estimate {
+        /// \brief The estimated runtime in seconds.
+        double runtime;
+        /// \brief True iff the estimate is an unscaled model, which is only a lower bound.
+        bool lower_bound;
+    };
+
+    /**
+     * \brief Estimate the walltime of the updater with the given index in seconds, if possible.
+     */
+    template <uindex_t i>
+    std::optional<Estimate> estimate_runtime(uindex_t grid_width, uindex_t grid_height,
+                                             uindex_t n_iterations) const {
+        CallStats const &stats = call_stats[i];
+        std::optional<double> modeled = model_runtime<i>(grid_width, grid_height, n_iterations);
+        if (modeled.has_value()) {
+            if (stats.modeled_runtime > 0.0 && stats.modeled_walltime > 0.0) {
+                return Estimate{*modeled * stats.modeled_walltime / stats.modeled_runtime, false};
+            }
+            return Estimate{*modeled, true};
+        }
+
+        if (stats.n_cell_updates > 0 && stats.walltime > 0.0) {
+            double seconds_per_cell = stats.walltime / stats.n_cell_updates;
+            return Estimate{
+                seconds_per_cell * uint64_t(grid_width) * uint64_t(grid_height) * n_iterations,
+                false};
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * \brief The intermediate result of \ref rank_updaters.
+     */
+    struct Ranking {
+        /// \brief The updater with the lowest estimated runtime so far.
+        std::optional<uindex_t> best = std::nullopt;
+        /// \brief The estimated runtime of the best updater.
+        double best_runtime = std::numeric_limits<double>::infinity();
+        /// \brief The updater with the lowest unscaled model so far.
+        std::optional<uindex_t> best_lower_bound = std::nullopt;
+        /// \brief The unscaled model of the updater with the lowest bound.
+        double lowest_bound = std::numeric_limits<double>::infinity();
+        /// \brief The first supporting updater without an estimate.
+        std::optional<uindex_t> fallback = std::nullopt;
+    };
+
+    /**
+     * \brief Rank the updaters with the index `i` and above.
+     */
+    template <uindex_t i = 0>
+    void rank_updaters(uindex_t grid_width, uindex_t grid_height, uindex_t n_iterations,
+                       Ranking &ranking) const {
+        if constexpr (i < n_updaters) {
+            if (supports<i>(grid_width, grid_height)) {
+                std::optional<Estimate> estimate =
+                    estimate_runtime<i>(grid_width, grid_height, n_iterations);
+                if (!estimate.has_value()) {
+                    if (!ranking.fallback.has_value()) {
+                        ranking.fallback = i;
+                    }
+                } else if (estimate->lower_bound) {
+                    if (estimate->runtime < ranking.lowest_bound) {
+                        ranking.best_lower_bound = i;
+                        ranking.lowest_bound = estimate->runtime;
+                    }
+                } else if (estimate->runtime < ranking.best_runtime) {
+                    ranking.best = i;
+                    ranking.best_runtime = estimate->runtime;
+                }
+            }
+            rank_updaters<i + 1>(grid_width, grid_height, n_iterations, ranking);
+        }
+    }
+
+    /**
+     * \brief Run the updater with the index `i_updater`, which has to be `i` or above.
+     */
+    template <uindex_t i = 0> GridImpl run_updater(uindex_t i_updater, GridImpl &source_grid) {
+        if constexpr (i < n_updaters) {
+            if (i != i_updater) {
+                return run_updater<i + 1>(i_updater, source_grid);
+            }
+
+            using U = UpdaterImpl<i>;
+            U &updater = std::get<i>(updaters);
+            typename U::Params &updater_params = updater.get_params();
+            updater_params = std::get<i>(params.updater_params);
+            updater_params.transition_function = params.transition_function;
+            updater_params.halo_value = params.halo_value;
+            updater_params.iteration_offset = params.iteration_offset;
+            updater_params.n_iterations = params.n_iterations;
+            updater_params.blocking = params.blocking;
+
+            uindex_t grid_width = source_grid.get_grid_width();
+            uindex_t grid_height = source_grid.get_grid_height();
+            std::optional<double> modeled =
+                model_runtime<i>(grid_width, grid_height, params.n_iterations);
+            auto start = std::chrono::high_resolution_clock::now();
+
+            GridImpl target_grid = source_grid;
+            if constexpr (std::is_same_v<typename U::GridImpl, GridImpl>) {
+                target_grid = updater(source_grid);
+                if (!params.blocking) {
+                    return target_grid;
+                }
+            } else {
+                // The staging grid is only read by the updater, and the computation is complete
+                // once its output has been copied back, so it can be reused by the next call.
+                std::optional<typename U::GridImpl> &staging_grid = std::get<i>(staging_grids);
+                if (!staging_grid.has_value() || staging_grid->get_grid_width() != grid_width ||
+                    staging_grid->get_grid_height() != grid_height) {
+                    staging_grid = typename U::GridImpl(grid_width, grid_height);
+                }
+                staging_grid->copy_from_buffer(source_grid.get_buffer());
+                typename U::GridImpl updater_target = updater(*staging_grid);
+                target_grid = grid_pool.acquire(source_grid);
+                updater_target.copy_to_buffer(target_grid.get_buffer());
+            }
+
+            std::chrono::duration<double> walltime =
+                std::chrono::high_resolution_clock::now() - start;
+            CallStats &stats = call_stats[i];
+            stats.n_cell_updates +=
+                uint64_t(grid_width) * uint64_t(grid_height) * params.n_iterations;
+            stats.walltime += walltime.count();
+            if (modeled.has_value()) {
+                stats.modeled_runtime += *modeled;
+                stats.modeled_walltime += walltime.count();
+            }
+            return target_grid;
+        } else {
+            throw std::out_of_range("The updater doesn't exist.");
+        }
+    }
+
+    Params params;
+    std::tuple<Updaters...> updaters;
+    std::optional<StaticGridImpl> static_grid;
+    std::optional<uindex_t> last_choice;
+    std::array<CallStats, n_updaters> call_stats;
+    std::tuple<std::optional<typename Updaters::GridImpl>...> staging_grids;
+    GridPool<GridImpl> grid_pool;
+};
+
+} // namespace stencil
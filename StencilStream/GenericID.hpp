@@ -79,4 +79,68 @@ typedef GenericID<index_t> ID;
  */
 typedef GenericID<uindex_t> UID;
 
+/**
+ * \brief A generic, three-dimensional index.
+ *
+ * The column and row axes are the same as in \ref GenericID. The third, layer axis runs along the
+ * depth of a grid.
+ *
+ * \tparam The index type. It can be anything as long as it can be constructed from a dimension of
+ * `sycl::id` and tested for equality.
+ */
+template <typename T> class GenericID3D {
+  public:
+    /**
+     * \brief Create a new index with undefined contents.
+     */
+    GenericID3D() : c(), r(), l() {}
+
+    /**
+     * \brief Create a new index with the given column, row and layer indices.
+     */
+    GenericID3D(T column, T row, T layer) : c(column), r(row), l(layer) {}
+
+    /**
+     * \brief Convert the SYCL ID.
+     */
+    GenericID3D(sycl::id<3> sycl_id) : c(sycl_id[0]), r(sycl_id[1]), l(sycl_id[2]) {}
+
+    /**
+     * \brief Convert the SYCl range.
+     */
+    GenericID3D(sycl::range<3> sycl_range) : c(sycl_range[0]), r(sycl_range[1]), l(sycl_range[2]) {}
+
+    /**
+     * \brief Test if the other generic ID has equivalent coordinates to this ID.
+     */
+    bool operator==(GenericID3D const &other) const {
+        return this->c == other.c && this->r == other.r && this->l == other.l;
+    }
+
+    /**
+     * \brief The column index.
+     */
+    T c;
+
+    /**
+     * \brief The row index.
+     */
+    T r;
+
+    /**
+     * \brief The layer index.
+     */
+    T l;
+};
+
+/**
+ * \brief A signed, three-dimensional index.
+ */
+typedef GenericID3D<index_t> ID3D;
+
+/**
+ * \brief An unsigned, three-dimensional index.
+ */
+typedef GenericID3D<uindex_t> UID3D;
+
 } // namespace stencil
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <CL/sycl.hpp>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace stencil {
+
+/**
+ * \brief A three-dimensional grid of cells.
+ *
+ * This grid, which fullfils the \ref stencil::concepts::Grid3D "Grid3D" concept, contains a
+ * three-dimensional buffer of cells. It is used by the three-dimensional stencil updaters of all
+ * backends, like \ref cpu::StencilUpdate3D, \ref monotile::StencilUpdate3D and \ref
+ * tiling::StencilUpdate3D.
+ *
+ * The grid has a width (number of columns), a height (number of rows) and a depth (number of
+ * layers). The contents of the grid can be accessed by a host-side program using the \ref
+ * GridAccessor class template. For example, one can write the contents of a `grid` object as
+ * follows:
+ *
+ * ```
+ * Grid3D::GridAccessor<sycl::access::mode::read_write> accessor(grid);
+ * for (uindex_t c = 0; c < grid.get_grid_width(); c++) {
+ *     for (uindex_t r = 0; r < grid.get_grid_height(); r++) {
+ *         for (uindex_t l = 0; l < grid.get_grid_depth(); l++) {
+ *             accessor[c][r][l] = foo(c, r, l);
+ *         }
+ *     }
+ * }
+ * ```
+ *
+ * Alternatively, one may write their data into a SYCL buffer and copy it into the grid using the
+ * method \ref copy_from_buffer. The method \ref copy_to_buffer does the reverse: It writes the
+ * contents of the grid into a SYCL buffer.
+ *
+ * \tparam Cell The cell type to store.
+ */
+template <typename Cell> class Grid3D {
+  public:
+    /**
+     * \brief The number of dimensions of the grid.
+     */
+    static constexpr uindex_t dimensions = 3;
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param c The width, or number of columns, of the new grid.
+     *
+     * \param r The height, or number of rows, of the new grid.
+     *
+     * \param l The depth, or number of layers, of the new grid.
+     */
+    Grid3D(uindex_t c, uindex_t r, uindex_t l) : buffer(sycl::range<3>(c, r, l)) {}
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param range The range of the new grid. The indices are the width, height and depth of the
+     * grid.
+     */
+    Grid3D(sycl::range<3> range) : buffer(range) {}
+
+    /**
+     * \brief Create a new grid with the same size and contents as the given SYCL buffer.
+     *
+     * The contents of the buffer will be copied to the grid by the host. The SYCL buffer can later
+     * be used elsewhere.
+     *
+     * \param other_buffer The buffer with the contents of the new grid.
+     */
+    Grid3D(sycl::buffer<Cell, 3> other_buffer) : buffer(other_buffer.get_range()) {
+        copy_from_buffer(other_buffer);
+    }
+
+    /**
+     * \brief Create a new reference to the given grid.
+     *
+     * The newly created grid object will point to the same underlying data as the referenced grid.
+     *
+     * \param other_grid The other grid the new grid should reference.
+     */
+    Grid3D(Grid3D const &other_grid)
+        : buffer(other_grid.buffer), references(other_grid.references) {}
+
+    /**
+     * \brief Copy the contents of the SYCL buffer into the grid.
+     *
+     * \param other_buffer The buffer to copy the data from.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_from_buffer(sycl::buffer<Cell, 3> other_buffer) {
+        if (buffer.get_range() != other_buffer.get_range()) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+        sycl::host_accessor buffer_ac(buffer, sycl::write_only);
+        sycl::host_accessor other_ac(other_buffer, sycl::read_only);
+        std::memcpy(buffer_ac.get_pointer(), other_ac.get_pointer(), buffer_ac.byte_size());
+    }
+
+    /**
+     * \brief Copy the contents of the grid into the SYCL buffer.
+     *
+     * \param other_buffer The buffer to copy the data to.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_to_buffer(sycl::buffer<Cell, 3> other_buffer) {
+        if (buffer.get_range() != other_buffer.get_range()) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+        sycl::host_accessor buffer_ac(buffer, sycl::read_only);
+        sycl::host_accessor other_ac(other_buffer, sycl::write_only);
+        std::memcpy(other_ac.get_pointer(), buffer_ac.get_pointer(), buffer_ac.byte_size());
+    }
+
+    /**
+     * \brief Submit a copy of the contents of another grid into this grid.
+     *
+     * The stencil updaters use this to return a distinct grid if no iterations are computed.
+     *
+     * \param queue The queue to submit the copy to.
+     * \param other_grid The grid to copy the data from.
+     * \throws std::range_error The other grid doesn't have the same size as this grid.
+     */
+    sycl::event submit_copy_from(sycl::queue &queue, Grid3D &other_grid) {
+        if (buffer.get_range() != other_grid.buffer.get_range()) {
+            throw std::range_error("The other grid has not the same size as the grid");
+        }
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor other_ac(other_grid.buffer, cgh, sycl::read_only);
+            sycl::accessor buffer_ac(buffer, cgh, sycl::write_only, sycl::no_init);
+            cgh.copy(other_ac, buffer_ac);
+        });
+    }
+
+    /**
+     * \brief An accessor for the grid.
+     *
+     * Instances of this class provide access to a grid, so that host code can read and write the
+     * contents of a grid. As such, it fullfils the \ref stencil::concepts::GridAccessor3D
+     * "GridAccessor3D" concept.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode = sycl::access::mode::read_write>
+    class GridAccessor : public sycl::host_accessor<Cell, Grid3D::dimensions, access_mode> {
+      public:
+        /**
+         * \brief Create a new accessor to the given grid.
+         */
+        GridAccessor(Grid3D &grid)
+            : sycl::host_accessor<Cell, Grid3D::dimensions, access_mode>(grid.buffer) {}
+    };
+
+    /**
+     * \brief Return the width, or number of columns, of the grid.
+     */
+    uindex_t get_grid_width() const { return buffer.get_range()[0]; }
+
+    /**
+     * \brief Return the height, or number of rows, of the grid.
+     */
+    uindex_t get_grid_height() const { return buffer.get_range()[1]; }
+
+    /**
+     * \brief Return the depth, or number of layers, of the grid.
+     */
+    uindex_t get_grid_depth() const { return buffer.get_range()[2]; }
+
+    /**
+     * \brief Create an new, uninitialized grid with the same size as the current one.
+     */
+    Grid3D make_similar() const {
+        return Grid3D(get_grid_width(), get_grid_height(), get_grid_depth());
+    }
+
+    sycl::buffer<Cell, 3> &get_buffer() { return buffer; }
+
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     */
+    long get_n_references() const { return references.use_count(); }
+
+  private:
+    sycl::buffer<Cell, 3> buffer;
+    // Only used to count the references to the grid data, see get_n_references().
+    std::shared_ptr<char> references = std::make_shared<char>();
+};
+} // namespace stencil
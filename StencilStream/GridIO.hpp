@@ -0,0 +1,364 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Concepts.hpp"
+#include "Index.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace stencil {
+
+/**
+ * \brief Binary grid files for snapshots and checkpoints.
+ *
+ * A grid file contains a \ref FileHeader, followed by the values of a grid in column-major order,
+ * meaning that the row index changes the quickest. The values are stored as raw bytes, so files
+ * are only portable between hosts with the same byte order and cell layout. In exchange, writing
+ * and reading a file doesn't require any formatting or parsing, and the values can be accessed
+ * directly in a memory-mapped file with \ref MappedGridFile.
+ *
+ * A file may either contain whole cells, written with \ref write_grid, or a single field of every
+ * cell, written with \ref write_field. Files with whole cells can be read back into a grid with
+ * \ref read_grid. Since the header records the iteration index of the cells, a simulation can be
+ * resumed from a checkpoint by setting the `iteration_offset` parameter of the stencil updater to
+ * \ref MappedGridFile::get_iteration_offset.
+ */
+namespace io {
+
+/**
+ * \brief The header at the start of every grid file.
+ *
+ * The header is padded to 64 bytes, so that the values after it are aligned for all common types.
+ */
+struct FileHeader {
+    /// \brief The magic number that identifies grid files, the string "STSTGRID".
+    static constexpr char file_magic[8] = {'S', 'T', 'S', 'T', 'G', 'R', 'I', 'D'};
+
+    /// \brief The version of the file format that is written by this header.
+    static constexpr std::uint32_t current_version = 1;
+
+    /// \brief The magic number of the file.
+    char magic[8];
+
+    /// \brief The version of the file format.
+    std::uint32_t version;
+
+    /// \brief The size of one value, in bytes.
+    std::uint32_t value_size;
+
+    /// \brief The alignment of one value, in bytes.
+    std::uint32_t value_alignment;
+
+    /// \brief True iff the values are whole cells and not just one field of every cell.
+    std::uint32_t contains_cells;
+
+    /// \brief The number of columns of the grid.
+    std::uint64_t grid_width;
+
+    /// \brief The number of rows of the grid.
+    std::uint64_t grid_height;
+
+    /// \brief The iteration index of the cells.
+    std::uint64_t iteration_offset;
+
+    /// \brief Unused bytes that pad the header to 64 bytes.
+    std::uint8_t padding[16];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+/**
+ * \brief Write the values of a grid to a file, one column at a time.
+ *
+ * \tparam Value The type of values to write. It has to be trivially copyable.
+ *
+ * \param get_value A callable object that is invoked as `get_value(c, r)` and returns the value of
+ * the cell in column `c` and row `r`.
+ */
+template <typename Value, typename GetValue>
+    requires std::is_trivially_copyable_v<Value>
+void write_values(std::string const &path, uindex_t grid_width, uindex_t grid_height,
+                  uindex_t iteration_offset, bool contains_cells, GetValue get_value) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Could not open the grid file " + path + " for writing.");
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, FileHeader::file_magic, sizeof(header.magic));
+    header.version = FileHeader::current_version;
+    header.value_size = sizeof(Value);
+    header.value_alignment = alignof(Value);
+    header.contains_cells = contains_cells;
+    header.grid_width = grid_width;
+    header.grid_height = grid_height;
+    header.iteration_offset = iteration_offset;
+    out.write(reinterpret_cast<char const *>(&header), sizeof(FileHeader));
+
+    // The values are buffered column by column, so that the grid is never copied as a whole.
+    std::vector<Value> column(grid_height);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            column[r] = get_value(c, r);
+        }
+        out.write(reinterpret_cast<char const *>(column.data()), grid_height * sizeof(Value));
+    }
+
+    if (!out) {
+        throw std::runtime_error("Could not write the grid file " + path + ".");
+    }
+}
+
+/**
+ * \brief Write the cells of a grid to a binary grid file.
+ *
+ * \tparam Cell The cell type of the grid. It has to be trivially copyable.
+ *
+ * \tparam G The grid type.
+ *
+ * \param path The path of the file. An existing file is overwritten.
+ *
+ * \param grid The grid to write.
+ *
+ * \param iteration_offset The iteration index of the grid's cells, which is stored in the header.
+ *
+ * \throws std::runtime_error The file could not be written.
+ */
+template <typename Cell, concepts::Grid<Cell> G>
+    requires std::is_trivially_copyable_v<Cell>
+void write_grid(std::string const &path, G &grid, uindex_t iteration_offset = 0) {
+    typename G::template GridAccessor<sycl::access::mode::read> ac(grid);
+    write_values<Cell>(path, grid.get_grid_width(), grid.get_grid_height(), iteration_offset, true,
+                       [&](uindex_t c, uindex_t r) -> Cell { return ac[c][r]; });
+}
+
+/**
+ * \brief Write one field of every cell of a grid to a binary grid file.
+ *
+ * For snapshots, often only one field of the cells is of interest. Writing only this field keeps
+ * the files small. Such files can't be read back into a grid, but their values can be accessed
+ * with \ref MappedGridFile::get_values.
+ *
+ * \tparam Cell The cell type of the grid.
+ *
+ * \tparam G The grid type.
+ *
+ * \tparam Projection A callable object that is invoked as `projection(cell)` and returns the field
+ * to write. The field type has to be trivially copyable.
+ *
+ * \param path The path of the file. An existing file is overwritten.
+ *
+ * \param grid The grid to write.
+ *
+ * \param iteration_offset The iteration index of the grid's cells, which is stored in the header.
+ *
+ * \param projection The selection of the field to write, for example
+ * `[](Cell const &cell) { return cell.hz; }`.
+ *
+ * \throws std::runtime_error The file could not be written.
+ */
+template <typename Cell, concepts::Grid<Cell> G, typename Projection>
+    requires std::is_trivially_copyable_v<std::invoke_result_t<Projection, Cell const &>>
+void write_field(std::string const &path, G &grid, uindex_t iteration_offset,
+                 Projection projection) {
+    using Value = std::remove_cvref_t<std::invoke_result_t<Projection, Cell const &>>;
+    typename G::template GridAccessor<sycl::access::mode::read> ac(grid);
+    write_values<Value>(path, grid.get_grid_width(), grid.get_grid_height(), iteration_offset,
+                        false, [&](uindex_t c, uindex_t r) -> Value {
+                            Cell cell = ac[c][r];
+                            return projection(cell);
+                        });
+}
+
+/**
+ * \brief A read-only, memory-mapped grid file.
+ *
+ * The file is mapped into memory when the object is created and unmapped when it's destroyed. The
+ * values are therefore only loaded from the disk when they are accessed, and the operating system
+ * may drop them from memory again.
+ */
+class MappedGridFile {
+  public:
+    /**
+     * \brief Map the grid file at the given path.
+     *
+     * \throws std::runtime_error The file could not be opened or mapped.
+     *
+     * \throws std::invalid_argument The file isn't a grid file, has an unsupported version or is
+     * truncated.
+     */
+    MappedGridFile(std::string const &path) : data(nullptr), size(0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open the grid file " + path + ".");
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0) {
+            close(fd);
+            throw std::runtime_error("Could not determine the size of the grid file " + path + ".");
+        }
+        size = file_stat.st_size;
+        if (size < sizeof(FileHeader)) {
+            close(fd);
+            throw std::invalid_argument("The file " + path + " is too small for a grid file.");
+        }
+
+        void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Could not map the grid file " + path + ".");
+        }
+        data = static_cast<std::uint8_t const *>(mapping);
+
+        FileHeader const &header = get_header();
+        std::string error;
+        if (std::memcmp(header.magic, FileHeader::file_magic, sizeof(header.magic)) != 0) {
+            error = "The file " + path + " isn't a grid file.";
+        } else if (header.version != FileHeader::current_version) {
+            error = "The grid file " + path + " has an unsupported version.";
+        } else if (header.grid_width == 0 || header.grid_height == 0 || header.value_size == 0) {
+            error = "The grid file " + path + " has an empty grid or value.";
+        } else if (header.grid_width >
+                   (size - sizeof(FileHeader)) / header.value_size / header.grid_height) {
+            // Checked with divisions since the product of the header fields may overflow.
+            error = "The grid file " + path + " is truncated.";
+        }
+        if (!error.empty()) {
+            unmap();
+            throw std::invalid_argument(error);
+        }
+    }
+
+    MappedGridFile(MappedGridFile const &other) = delete;
+    MappedGridFile &operator=(MappedGridFile const &other) = delete;
+
+    MappedGridFile(MappedGridFile &&other)
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)) {}
+
+    MappedGridFile &operator=(MappedGridFile &&other) {
+        unmap();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        return *this;
+    }
+
+    ~MappedGridFile() { unmap(); }
+
+    /**
+     * \brief Return the header of the file.
+     */
+    FileHeader const &get_header() const { return *reinterpret_cast<FileHeader const *>(data); }
+
+    /**
+     * \brief Return the number of columns of the stored grid.
+     */
+    uindex_t get_grid_width() const { return get_header().grid_width; }
+
+    /**
+     * \brief Return the number of rows of the stored grid.
+     */
+    uindex_t get_grid_height() const { return get_header().grid_height; }
+
+    /**
+     * \brief Return the iteration index of the stored cells.
+     */
+    uindex_t get_iteration_offset() const { return get_header().iteration_offset; }
+
+    /**
+     * \brief Return true iff the file contains whole cells instead of a single field.
+     */
+    bool contains_cells() const { return get_header().contains_cells != 0; }
+
+    /**
+     * \brief Return the stored values in column-major order.
+     *
+     * The value in column `c` and row `r` has the index `c * get_grid_height() + r`. The returned
+     * span points into the mapped file and is valid as long as this object exists.
+     *
+     * \tparam Value The type of the stored values.
+     *
+     * \throws std::invalid_argument The size or alignment of the value type doesn't match the
+     * file.
+     */
+    template <typename Value>
+        requires std::is_trivially_copyable_v<Value>
+    std::span<Value const> get_values() const {
+        FileHeader const &header = get_header();
+        if (header.value_size != sizeof(Value) || header.value_alignment != alignof(Value)) {
+            throw std::invalid_argument("The value type doesn't match the layout of the file.");
+        }
+        return std::span<Value const>(reinterpret_cast<Value const *>(data + sizeof(FileHeader)),
+                                      header.grid_width * header.grid_height);
+    }
+
+  private:
+    void unmap() {
+        if (data != nullptr) {
+            munmap(const_cast<std::uint8_t *>(data), size);
+            data = nullptr;
+        }
+    }
+
+    std::uint8_t const *data;
+    std::size_t size;
+};
+
+/**
+ * \brief Create a new grid with the cells of a grid file.
+ *
+ * \tparam Cell The cell type of the grid.
+ *
+ * \tparam G The grid type to create.
+ *
+ * \throws std::invalid_argument The file only contains a single field, or the layout of the cell
+ * type doesn't match the file.
+ */
+template <typename Cell, concepts::Grid<Cell> G>
+    requires std::is_trivially_copyable_v<Cell>
+G read_grid(MappedGridFile const &file) {
+    if (!file.contains_cells()) {
+        throw std::invalid_argument("The grid file only contains a single field of the cells.");
+    }
+    std::span<Cell const> cells = file.get_values<Cell>();
+
+    uindex_t grid_width = file.get_grid_width();
+    uindex_t grid_height = file.get_grid_height();
+    G grid(grid_width, grid_height);
+    typename G::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            ac[c][r] = cells[c * grid_height + r];
+        }
+    }
+    return grid;
+}
+
+} // namespace io
+} // namespace stencil
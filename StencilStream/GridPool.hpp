@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace stencil {
+
+/**
+ * \brief A pool of reusable grids.
+ *
+ * Stencil updaters need additional grids of the same size as the source grid for their double
+ * buffering scheme. Instead of allocating new grids in every call, they request them from a grid
+ * pool. The pool keeps a reference to every grid it has handed out and considers a grid free again
+ * once it's no longer referenced anywhere else. This way, applications that call an updater in a
+ * loop, like `grid = update(grid)`, only allocate grids in the first few calls.
+ *
+ * A pool may be shared by multiple updaters that use the same grid type. It is however not
+ * thread-safe.
+ *
+ * \tparam G The grid type to manage. It has to provide the method `get_n_references()`, which
+ * returns the number of grid objects that reference the same data. Three-dimensional grids like
+ * \ref Grid3D are also compared by their depth.
+ */
+template <typename G> class GridPool {
+  public:
+    /**
+     * \brief Create a new, empty grid pool.
+     */
+    GridPool() : grids() {}
+
+    /**
+     * \brief Return an unused grid with the same size as the given grid.
+     *
+     * If the pool contains a free grid with the same size, it is returned. Otherwise, all free
+     * grids with other sizes are released and a new grid is allocated. The contents of the
+     * returned grid are undefined.
+     *
+     * \param similar_grid A grid with the requested size.
+     */
+    G acquire(G const &similar_grid) {
+        auto is_free = [](G const &grid) { return grid.get_n_references() == 1; };
+        auto has_same_size = [&](G const &grid) {
+            bool same_size = grid.get_grid_width() == similar_grid.get_grid_width() &&
+                             grid.get_grid_height() == similar_grid.get_grid_height();
+            if constexpr (requires { similar_grid.get_grid_depth(); }) {
+                same_size &= grid.get_grid_depth() == similar_grid.get_grid_depth();
+            }
+            return same_size;
+        };
+
+        for (G &grid : grids) {
+            if (is_free(grid) && has_same_size(grid)) {
+                return grid;
+            }
+        }
+
+        std::erase_if(grids, [&](G const &grid) { return is_free(grid) && !has_same_size(grid); });
+        grids.push_back(similar_grid.make_similar());
+        return grids.back();
+    }
+
+    /**
+     * \brief Release all grids that aren't used anywhere else.
+     */
+    void shrink() {
+        std::erase_if(grids, [](G const &grid) { return grid.get_n_references() == 1; });
+    }
+
+    /**
+     * \brief Return the number of grids in the pool, including the ones that are currently in use.
+     */
+    uindex_t get_n_grids() const { return grids.size(); }
+
+  private:
+    std::vector<G> grids;
+};
+
+} // namespace stencil
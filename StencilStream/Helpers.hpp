@@ -19,7 +19,13 @@
  */
 #pragma once
 #include "Index.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace stencil {
 
@@ -35,6 +41,78 @@ inline constexpr uindex_t n_cells_to_n_words(uindex_t n_cells, uindex_t word_len
     return n_cells / word_length + (n_cells % word_length == 0 ? 0 : 1);
 }
 
+/**
+ * \brief Process a range of indices in chunks, using multiple host threads.
+ *
+ * The range `[0, n)` is split into one contiguous chunk per hardware thread and the function is
+ * called as `f(begin, end)` for every chunk, each from its own thread. The chunk boundaries are
+ * multiples of `granularity`, so that chunks never share a memory word whose cells are written
+ * together. Ranges with less than `min_chunk_size` indices per thread are processed by the calling
+ * thread alone. The grids use this to convert their contents to and from other layouts on the
+ * host.
+ *
+ * \param n The number of indices to process.
+ *
+ * \param granularity The number that all chunk boundaries are a multiple of.
+ *
+ * \param f The function to call for every chunk. It must not throw.
+ *
+ * \param min_chunk_size The minimal number of indices that a thread processes.
+ */
+template <typename F>
+void host_parallel_for(uindex_t n, uindex_t granularity, F f, uindex_t min_chunk_size = 1 << 16) {
+    uindex_t n_threads = std::max<uindex_t>(std::thread::hardware_concurrency(), 1);
+    n_threads = std::min<uindex_t>(n_threads, n / std::max<uindex_t>(min_chunk_size, 1));
+    if (n_threads <= 1) {
+        f(uindex_t(0), n);
+        return;
+    }
+
+    uindex_t chunk_size = n_cells_to_n_words(n_cells_to_n_words(n, n_threads), granularity);
+    chunk_size *= granularity;
+    std::vector<std::thread> threads;
+    for (uindex_t begin = 0; begin < n; begin += chunk_size) {
+        threads.emplace_back(f, begin, std::min<uindex_t>(begin + chunk_size, n));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * \brief Save a copy of a value and write it back when the guard goes out of scope.
+ *
+ * The updaters and helpers like \ref run_until use this to temporarily modify the parameters of a
+ * stencil updater. Since the copy is restored by the destructor, the parameters are also restored
+ * if one of the submitted passes throws.
+ *
+ * \tparam T The type of the guarded value. It must be copy-assignable.
+ */
+template <typename T> class RestoreGuard {
+  public:
+    /**
+     * \brief Save a copy of `value`.
+     */
+    explicit RestoreGuard(T &value) : value(value), saved(value) {}
+
+    RestoreGuard(RestoreGuard const &) = delete;
+    RestoreGuard &operator=(RestoreGuard const &) = delete;
+
+    /**
+     * \brief Write the saved copy back.
+     */
+    ~RestoreGuard() { value = saved; }
+
+    /**
+     * \brief Return the saved copy of the value.
+     */
+    T const &get_saved() const { return saved; }
+
+  private:
+    T &value;
+    T saved;
+};
+
 /**
  * \brief A container with padding to the next power of two.
  *
@@ -46,4 +124,122 @@ template <typename T> struct Padded {
     T value;
 } __attribute__((aligned(std::bit_ceil(sizeof(T)))));
 
+/**
+ * \brief A container without additional padding.
+ *
+ * This is the counterpart to \ref Padded: The size of the resulting type is the size of the
+ * contained type, so arrays of it are densely packed. This saves memory and bandwidth for cells
+ * whose size isn't a power of two, for example an 88-byte cell that \ref Padded would expand to 128
+ * bytes. However, the memory systems may need wider or unaligned ports.
+ *
+ * \tparam T The contained type.
+ */
+template <typename T> struct Packed {
+    T value;
+};
+
+/**
+ * \brief The storage type of cells in I/O words and on-chip caches.
+ *
+ * \tparam T The cell type.
+ *
+ * \tparam dense_storage If true, cells are stored densely with \ref Packed. Otherwise, they are
+ * padded to the next power of two with \ref Padded.
+ */
+template <typename T, bool dense_storage>
+using CellStorage = std::conditional_t<dense_storage, Packed<T>, Padded<T>>;
+
+/**
+ * \brief The number of bits that are used by the values of a cell type.
+ *
+ * Grids may use this to pack multiple cells of a sub-byte type into one byte. By default, this is
+ * the full size of the type, except for `bool`, which only uses one bit. Applications may
+ * specialize this template for their own integral or enumeration types whose values fit into fewer
+ * bits, for example an enumeration of four cell states that fits into two bits.
+ *
+ * \tparam T The cell type.
+ */
+template <typename T> struct CellBits : std::integral_constant<uindex_t, 8 * sizeof(T)> {};
+
+template <> struct CellBits<bool> : std::integral_constant<uindex_t, 1> {};
+
+/**
+ * \brief Check whether cells of the given type can be packed bit by bit.
+ *
+ * This is the case for integral and enumeration types with less than eight \ref CellBits, as long
+ * as the number of bits divides eight. Values of these types are converted to and from bytes with
+ * `static_cast` and only the lowest \ref CellBits are stored.
+ */
+template <typename T>
+constexpr bool is_bit_packable = (std::is_integral_v<T> || std::is_enum_v<T>) &&
+                                 CellBits<T>::value < 8 && 8 % CellBits<T>::value == 0;
+
+/**
+ * \brief The format in which the FPGA grids store cells of a type in global memory.
+ *
+ * By default, cells are stored as they are. Applications may specialize this template for their
+ * own cell types to store them in a smaller format, for example with reduced-precision fields.
+ * A specialization has to provide the following members:
+ *
+ * ```
+ * using Storage = ...;                          // The stored type.
+ * static Storage encode(T const &cell);         // Compress a cell before it's written.
+ * static T decode(Storage const &stored_cell);  // Decompress a cell after it's read.
+ * ```
+ *
+ * The grids decode the cells before they are sent into a pipe and encode them after they are
+ * received from a pipe, so that transition functions still compute with full-precision cells and
+ * only the memory traffic shrinks. The encoding may be lossy: Every time a grid is written, the
+ * cells are rounded to the stored format.
+ *
+ * \tparam T The cell type.
+ */
+template <typename T> struct CellCodec {
+    using Storage = T;
+
+    static Storage encode(T const &cell) { return cell; }
+
+    static T decode(Storage const &stored_cell) { return stored_cell; }
+};
+
+/**
+ * \brief A cell codec that converts cells to and from the storage type.
+ *
+ * Specializations of \ref CellCodec may inherit from this template if the cell type and the
+ * storage type can be converted into each other with `static_cast`, for example
+ * `template <> struct CellCodec<double> : ConversionCodec<double, float> {};`.
+ *
+ * \tparam T The cell type.
+ *
+ * \tparam S The storage type.
+ */
+template <typename T, typename S> struct ConversionCodec {
+    using Storage = S;
+
+    static Storage encode(T const &cell) { return static_cast<Storage>(cell); }
+
+    static T decode(Storage const &stored_cell) { return static_cast<T>(stored_cell); }
+};
+
+/**
+ * \brief Check whether cells of the given type are stored in a different format, see \ref
+ * CellCodec.
+ */
+template <typename T>
+constexpr bool has_cell_codec = !std::is_same_v<typename CellCodec<T>::Storage, T>;
+
+/**
+ * \brief The type of the values that are sent through pipes if multiple cells are transferred per
+ * clock cycle.
+ *
+ * With a vector width of one, this is the cell type itself, so that existing pipe users are not
+ * affected. Otherwise, it's an array of `vector_width` cells.
+ *
+ * \tparam T The cell type.
+ *
+ * \tparam vector_width The number of cells sent per pipe operation.
+ */
+template <typename T, uindex_t vector_width>
+using CellVector = std::conditional_t<vector_width == 1, T, std::array<T, vector_width>>;
+
 } // namespace stencil
\ No newline at end of file
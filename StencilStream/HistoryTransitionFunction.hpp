@@ -0,0 +1,304 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "BoundaryCondition.hpp"
+#include "Concepts.hpp"
+#include "GenericID.hpp"
+#include "Index.hpp"
+#include "Stencil.hpp"
+#include <array>
+#include <type_traits>
+#include <variant>
+
+namespace stencil {
+
+/**
+ * \brief A cell bundled with the past time levels of its history value.
+ *
+ * \tparam Cell The cell type.
+ *
+ * \tparam HistoryValue The type of the kept values, either the cell type or a part of it.
+ *
+ * \tparam n_levels The number of kept time levels.
+ */
+template <typename Cell, typename HistoryValue, uindex_t n_levels> struct CellWithHistory {
+    /// \brief The present value of the cell.
+    Cell cell;
+
+    /// \brief The past time levels of the cell, starting with the most recent one.
+    std::array<HistoryValue, n_levels> history;
+};
+
+/**
+ * \brief A transition function that keeps past time levels of the central cell.
+ *
+ * Multistep schemes like the leapfrog method compute the next time level of a cell from the
+ * present and some past levels. Instead of widening the cell type by hand, such a transition
+ * function may define a `history_length` and, optionally, a `HistoryValue` type with a static
+ * `history_value` method that selects the parts of a cell to keep. The past levels are then
+ * available as `stencil.previous(1)` to `stencil.previous(history_length)`, see \ref
+ * stencil::concepts::TransitionFunction "TransitionFunction".
+ *
+ * This adapter wraps such a transition function into one without a history, whose cells are \ref
+ * CellWithHistory bundles. The grids of the stencil updates contain these bundles, since the past
+ * levels have to be stored between two passes, and \ref with_history creates a bundle whose past
+ * levels all equal the initial value of the cell. Only the selected history values are stored.
+ *
+ * The CPU backend updates the bundles like any other cell. The FPGA backends unpack them with
+ * \ref KernelHistory instead: Their stencil buffers and caches only hold the wrapped cells, while
+ * the past levels of every cell follow it through the processing elements in delay lines, so that
+ * only the central cell's levels are buffered.
+ *
+ * The history advances once per iteration: If an iteration computes the time level u^{n+1} from
+ * u^n, `stencil.previous(1)` is u^{n-1} in every sub-iteration of it, `stencil.previous(2)` is
+ * u^{n-2} and so on. If the transition function has more than one sub-iteration, one additional
+ * time level is stored, since the central cell already contains intermediate values in the later
+ * sub-iterations.
+ *
+ * \tparam F The wrapped transition function. It may not define a reduction or a host stream,
+ * since they would have to operate on the bundles.
+ */
+template <concepts::TransitionFunction F>
+    requires(has_history<F> && !has_reduction<F> && !has_host_stream<F>)
+class HistoryTransitionFunction {
+  public:
+    /// \brief The wrapped transition function.
+    using InnerTransitionFunction = F;
+
+    /// \brief The cells of the wrapped transition function.
+    using InnerCell = typename F::Cell;
+
+    /**
+     * \brief The number of time levels that are stored with every cell.
+     *
+     * This is the history length of the wrapped transition function, plus one if it has more
+     * than one sub-iteration.
+     */
+    static constexpr uindex_t n_stored_levels =
+        history_length_of<F> + (F::n_subiterations > 1 ? 1 : 0);
+
+    /// \brief The stored time levels of a cell, starting with the most recent one.
+    using StoredLevels = std::array<HistoryValueOf<F>, n_stored_levels>;
+
+    using Cell = CellWithHistory<InnerCell, HistoryValueOf<F>, n_stored_levels>;
+    using TimeDependentValue = typename F::TimeDependentValue;
+    using StaticValue = StaticValueOf<F>;
+    using ConstantTable = ConstantTableOf<F>;
+
+    static constexpr uindex_t stencil_radius = F::stencil_radius;
+    static constexpr StencilShape stencil_shape = stencil_shape_of<F>;
+    static constexpr BoundaryCondition boundary_condition = boundary_condition_of<F>;
+    static constexpr uindex_t n_subiterations = F::n_subiterations;
+
+    /// \brief The stencil type of the wrapped transition function.
+    using InnerStencil = Stencil<InnerCell, stencil_radius, TimeDependentValue, StaticValue,
+                                 ConstantTable, HistoryOf<F>>;
+
+    /**
+     * \brief Wrap the given transition function.
+     */
+    HistoryTransitionFunction(F transition_function) : transition_function(transition_function) {}
+
+    /**
+     * \brief Return the wrapped transition function.
+     */
+    F const &get_inner_transition_function() const { return transition_function; }
+
+    /**
+     * \brief Bundle a cell with a history in which all past levels equal the cell itself.
+     *
+     * This is the usual way to start a multistep scheme from a single initial state.
+     */
+    static Cell with_history(InnerCell const &cell) {
+        Cell bundle;
+        bundle.cell = cell;
+        bundle.history.fill(history_value(cell));
+        return bundle;
+    }
+
+    /**
+     * \brief Select the past levels that the wrapped transition function sees.
+     *
+     * In the first sub-iteration of an iteration, the stored levels are the past ones. In the
+     * later sub-iterations, the first stored level is the value of the central cell when the
+     * iteration started, which is skipped.
+     *
+     * \param levels The stored levels of the central cell.
+     *
+     * \param subiteration The index of the computed sub-iteration.
+     */
+    static HistoryOf<F> select_history(StoredLevels const &levels, uindex_t subiteration) {
+        uindex_t offset = subiteration == 0 ? 0 : 1;
+        HistoryOf<F> history;
+#pragma unroll
+        for (uindex_t i = 0; i < history_length_of<F>; i++) {
+            history[i] = levels[i + offset];
+        }
+        return history;
+    }
+
+    /**
+     * \brief Compute the stored levels of a cell after a sub-iteration.
+     *
+     * The first sub-iteration of an iteration pushes the present value of the central cell into
+     * the stored levels and drops the oldest one. The other sub-iterations keep them.
+     *
+     * \param center The value of the central cell before the sub-iteration.
+     *
+     * \param levels The stored levels of the central cell before the sub-iteration.
+     *
+     * \param subiteration The index of the computed sub-iteration.
+     */
+    static StoredLevels advance_history(InnerCell const &center, StoredLevels const &levels,
+                                        uindex_t subiteration) {
+        if (subiteration != 0) {
+            return levels;
+        }
+        StoredLevels new_levels;
+        new_levels[0] = history_value(center);
+#pragma unroll
+        for (uindex_t i = 1; i < n_stored_levels; i++) {
+            new_levels[i] = levels[i - 1];
+        }
+        return new_levels;
+    }
+
+    Cell operator()(Stencil<Cell, stencil_radius, TimeDependentValue, StaticValue,
+                            ConstantTable> const &stencil) const {
+        Cell const &center = stencil[ID(0, 0)];
+
+        InnerStencil inner_stencil(stencil.id, stencil.grid_range, stencil.iteration,
+                                   stencil.subiteration, stencil.time_dependent_value,
+                                   stencil.static_value, stencil.get_constant_table_ptr(),
+                                   select_history(center.history, stencil.subiteration));
+#pragma unroll
+        for (uindex_t c = 0; c < InnerStencil::diameter; c++) {
+#pragma unroll
+            for (uindex_t r = 0; r < InnerStencil::diameter; r++) {
+                inner_stencil[UID(c, r)] = stencil[UID(c, r)].cell;
+            }
+        }
+
+        Cell new_cell;
+        new_cell.cell = transition_function(inner_stencil);
+        new_cell.history = advance_history(center.cell, center.history, stencil.subiteration);
+        return new_cell;
+    }
+
+    TimeDependentValue get_time_dependent_value(uindex_t i_iteration) const {
+        return transition_function.get_time_dependent_value(i_iteration);
+    }
+
+  private:
+    static HistoryValueOf<F> history_value(InnerCell const &cell) {
+        if constexpr (requires { typename F::HistoryValue; }) {
+            return F::history_value(cell);
+        } else {
+            return cell;
+        }
+    }
+
+    F transition_function;
+};
+
+/**
+ * \brief The history of a wrapped transition function is consumed by the wrapper.
+ *
+ * The wrapper therefore has no history itself, independent of the members it declares, and the
+ * stencil updaters accept it.
+ */
+template <typename F>
+struct HistoryLengthOfImpl<HistoryTransitionFunction<F>> : std::integral_constant<uindex_t, 0> {};
+
+/**
+ * \brief Split the cells of a transition function into the cells of the stencil buffers and the
+ * past levels that the FPGA kernels keep in delay lines.
+ *
+ * For all transition functions except \ref HistoryTransitionFunction, the cells are kept as they
+ * are and there are no levels. The kernels don't instantiate any delay lines for them.
+ *
+ * \tparam TransFunc The transition function of the kernel.
+ */
+template <typename TransFunc> struct KernelHistory {
+    /// \brief Whether the kernel has to keep past levels.
+    static constexpr bool enabled = false;
+
+    /// \brief The cells of the stencil buffers.
+    using Cell = typename TransFunc::Cell;
+
+    /// \brief The levels that follow a cell through the processing elements.
+    using Levels = std::monostate;
+
+    /// \brief The history type of the kernel's stencils.
+    using History = std::monostate;
+
+    /// \brief Return the transition function that is applied to the kernel's stencils.
+    static TransFunc const &get_transition_function(TransFunc const &trans_func) {
+        return trans_func;
+    }
+
+    static Cell get_cell(typename TransFunc::Cell const &cell) { return cell; }
+
+    static Levels get_levels(typename TransFunc::Cell const &cell) { return Levels(); }
+
+    static typename TransFunc::Cell bundle(Cell const &cell, Levels const &levels) { return cell; }
+
+    static History select_history(Levels const &levels, uindex_t subiteration) {
+        return History();
+    }
+
+    static Levels advance_history(Cell const &center, Levels const &levels, uindex_t subiteration) {
+        return levels;
+    }
+};
+
+template <typename F> struct KernelHistory<HistoryTransitionFunction<F>> {
+    using Wrapper = HistoryTransitionFunction<F>;
+
+    static constexpr bool enabled = true;
+
+    using Cell = typename Wrapper::InnerCell;
+
+    using Levels = typename Wrapper::StoredLevels;
+
+    using History = HistoryOf<F>;
+
+    static F const &get_transition_function(Wrapper const &trans_func) {
+        return trans_func.get_inner_transition_function();
+    }
+
+    static Cell get_cell(typename Wrapper::Cell const &cell) { return cell.cell; }
+
+    static Levels get_levels(typename Wrapper::Cell const &cell) { return cell.history; }
+
+    static typename Wrapper::Cell bundle(Cell const &cell, Levels const &levels) {
+        return typename Wrapper::Cell{cell, levels};
+    }
+
+    static History select_history(Levels const &levels, uindex_t subiteration) {
+        return Wrapper::select_history(levels, subiteration);
+    }
+
+    static Levels advance_history(Cell const &center, Levels const &levels, uindex_t subiteration) {
+        return Wrapper::advance_history(center, levels, subiteration);
+    }
+};
+
+} // namespace stencil
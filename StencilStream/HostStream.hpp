@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Concepts.hpp"
+#include "GenericID.hpp"
+#include "Helpers.hpp"
+#include "Index.hpp"
+
+namespace stencil {
+
+/**
+ * \brief A cell that a stencil update sends to the host through a \ref
+ * stencil::concepts::HostStream "host stream".
+ *
+ * \tparam Cell The cell type.
+ */
+template <typename Cell> struct StreamedCell {
+    /// \brief The position of the cell in the grid.
+    ID id;
+
+    /// \brief The iteration index of the cell, i.e. the number of iterations that have been
+    /// applied to it, including the iteration offset.
+    uindex_t i_iteration;
+
+    /// \brief The value of the cell.
+    Cell cell;
+};
+
+/**
+ * \brief Submit a kernel that forwards cells from one pipe to another and sends the selected cells
+ * to the host on the way.
+ *
+ * The FPGA backends insert this kernel between the execution kernel and the output kernel of every
+ * pass, so that the host receives its cells while the update is still running. The kernel expects
+ * the cells of a `n_columns` by `n_rows` grid section in column-major order. If the vector width
+ * is greater than one, the pipes transfer \ref CellVector "CellVectors" and every column is padded
+ * to a multiple of the vector width. The padding cells are forwarded, but never sent to the host.
+ *
+ * The kernel blocks as long as the pipe of the host stream is full. Therefore, the host has to
+ * read the streamed cells concurrently to the update, or the pipe has to be deep enough to hold all
+ * selected cells of a pass.
+ *
+ * \tparam Cell The cell type.
+ *
+ * \tparam in_pipe The pipe to read the cells from.
+ *
+ * \tparam out_pipe The pipe to forward the cells to.
+ *
+ * \tparam vector_width The number of cells per pipe operation.
+ *
+ * \param queue The queue to submit the kernel to.
+ *
+ * \param stream The host stream that selects the cells.
+ *
+ * \param i_iteration The iteration index of the forwarded cells.
+ *
+ * \param column_begin The index of the first forwarded column in the grid.
+ *
+ * \param n_columns The number of columns to forward.
+ *
+ * \param n_rows The number of rows to forward.
+ *
+ * \returns The event object of the submitted kernel.
+ */
+template <typename Cell, typename in_pipe, typename out_pipe, uindex_t vector_width = 1,
+          concepts::HostStream S>
+sycl::event submit_host_stream_kernel(sycl::queue queue, S stream, uindex_t i_iteration,
+                                      uindex_t column_begin, uindex_t n_columns,
+                                      uindex_t n_rows) {
+    return queue.submit([&](sycl::handler &cgh) {
+        uindex_t vector_height = n_cells_to_n_words(n_rows, vector_width);
+
+        cgh.single_task([=]() {
+            [[intel::loop_coalesce(2)]] for (uindex_t c = 0; c < n_columns; c++) {
+                for (uindex_t r = 0; r < vector_height; r++) {
+                    CellVector<Cell, vector_width> vector = in_pipe::read();
+                    out_pipe::write(vector);
+
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        uindex_t cell_r = r * vector_width + i_cell;
+                        ID id(column_begin + c, cell_r);
+                        if (cell_r < n_rows && stream.selects(id, i_iteration)) {
+                            if constexpr (vector_width == 1) {
+                                S::pipe::write(StreamedCell<Cell>{id, i_iteration, vector});
+                            } else {
+                                S::pipe::write(
+                                    StreamedCell<Cell>{id, i_iteration, vector[i_cell]});
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    });
+}
+
+} // namespace stencil
@@ -0,0 +1,220 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <CL/sycl.hpp>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+namespace stencil {
+
+/**
+ * \brief Activity counters of a kernel that exchanges cells through pipes.
+ *
+ * Instrumented kernels count how often they have to wait for their pipes. On hardware, every
+ * attempt to read from an empty pipe or to write to a full pipe is a stalled clock cycle. If the
+ * execution kernel stalls on its input, it's starved by the memory; If it stalls on its output,
+ * it's bound by the write-back to memory.
+ */
+struct KernelCounters {
+    /// \brief The number of loop iterations in which the kernel made progress.
+    uint64_t n_active_cycles = 0;
+
+    /// \brief The number of failed attempts to read from an empty pipe.
+    uint64_t n_empty_stalls = 0;
+
+    /// \brief The number of failed attempts to write to a full pipe.
+    uint64_t n_full_stalls = 0;
+
+    /// \brief The number of cells that the kernel has moved through the pipes or from and to the
+    /// global memory.
+    uint64_t n_cells = 0;
+
+    KernelCounters &operator+=(KernelCounters const &other) {
+        n_active_cycles += other.n_active_cycles;
+        n_empty_stalls += other.n_empty_stalls;
+        n_full_stalls += other.n_full_stalls;
+        n_cells += other.n_cells;
+        return *this;
+    }
+};
+
+/**
+ * \brief The counters of the input, execution and output kernels of a stencil updater.
+ */
+struct StencilUpdateCounters {
+    /// \brief The counters of the kernel(s) that read the grid and send it to the execution kernel.
+    KernelCounters read;
+
+    /// \brief The counters of the execution kernel.
+    KernelCounters compute;
+
+    /// \brief The counters of the kernel(s) that receive the results and write them to the grid.
+    KernelCounters write;
+};
+
+/**
+ * \brief The device buffer that instrumented kernels add their counters to.
+ *
+ * It contains a single element and kernels that share a buffer have to run one after another, for
+ * example in the same in-order queue.
+ */
+using KernelCountersBuffer = sycl::buffer<KernelCounters, 1>;
+
+/**
+ * \brief Create a new counters buffer with zeroed counters.
+ */
+inline KernelCountersBuffer make_kernel_counters_buffer() {
+    KernelCountersBuffer buffer = KernelCountersBuffer(sycl::range<1>(1));
+    sycl::host_accessor ac(buffer, sycl::write_only);
+    ac[0] = KernelCounters();
+    return buffer;
+}
+
+/**
+ * \brief Read the counters from a counters buffer. This blocks until all kernels that use the
+ * buffer have completed.
+ */
+inline KernelCounters read_kernel_counters(KernelCountersBuffer buffer) {
+    sycl::host_accessor ac(buffer, sycl::read_only);
+    return ac[0];
+}
+
+/**
+ * \brief The counters buffers of the input, execution and output kernels of a stencil updater.
+ *
+ * Every kernel role has a buffer of its own, since the kernels of the roles run concurrently.
+ */
+struct StencilUpdateCountersBuffers {
+    KernelCountersBuffer read = make_kernel_counters_buffer();
+    KernelCountersBuffer compute = make_kernel_counters_buffer();
+    KernelCountersBuffer write = make_kernel_counters_buffer();
+
+    /**
+     * \brief Read the counters. This blocks until all kernels that use the buffers have completed.
+     */
+    StencilUpdateCounters get() const {
+        return {.read = read_kernel_counters(read),
+                .compute = read_kernel_counters(compute),
+                .write = read_kernel_counters(write)};
+    }
+};
+
+/**
+ * \brief The argument that instrumented kernels receive to store their counters.
+ *
+ * This is an accessor to a \ref KernelCountersBuffer if the kernel is instrumented and an empty
+ * placeholder otherwise.
+ */
+template <bool instrumented>
+using KernelCountersArgument =
+    std::conditional_t<instrumented,
+                       sycl::accessor<KernelCounters, 1, sycl::access::mode::read_write>,
+                       std::monostate>;
+
+/**
+ * \brief Create the counters argument of a kernel in a command group.
+ *
+ * \throws std::invalid_argument The kernel is instrumented, but no buffer is given.
+ */
+template <bool instrumented>
+KernelCountersArgument<instrumented>
+make_kernel_counters_argument(std::optional<KernelCountersBuffer> buffer, sycl::handler &cgh) {
+    if constexpr (instrumented) {
+        if (!buffer.has_value()) {
+            throw std::invalid_argument("Instrumented kernels require a counters buffer.");
+        }
+        return KernelCountersArgument<true>(*buffer, cgh, sycl::read_write);
+    } else {
+        return std::monostate();
+    }
+}
+
+/**
+ * \brief The kernel-side recorder of the \ref KernelCounters.
+ *
+ * Kernels access their pipes via \ref read and \ref write. If the kernel is instrumented, these
+ * methods use non-blocking pipe operations and retry them until they succeed, counting every failed
+ * attempt as a stall. Otherwise, they are plain blocking pipe operations and no counters are
+ * synthesized at all.
+ *
+ * \tparam instrumented Whether the counters are recorded.
+ */
+template <bool instrumented> class KernelCounterRecorder {
+  public:
+    /**
+     * \brief Read a value from the pipe and count the stalls while the pipe is empty.
+     */
+    template <typename pipe> auto read() {
+        if constexpr (instrumented) {
+            bool success = false;
+            auto value = pipe::read(success);
+            while (!success) {
+                counters.n_empty_stalls++;
+                value = pipe::read(success);
+            }
+            return value;
+        } else {
+            return pipe::read();
+        }
+    }
+
+    /**
+     * \brief Write a value to the pipe and count the stalls while the pipe is full.
+     */
+    template <typename pipe, typename T> void write(T const &value) {
+        if constexpr (instrumented) {
+            bool success = false;
+            pipe::write(value, success);
+            while (!success) {
+                counters.n_full_stalls++;
+                pipe::write(value, success);
+            }
+        } else {
+            pipe::write(value);
+        }
+    }
+
+    /**
+     * \brief Add the recorded counters to the counters buffer.
+     *
+     * \param argument The counters argument of the kernel.
+     *
+     * \param n_active_cycles The number of loop iterations of the kernel.
+     *
+     * \param n_cells The number of cells the kernel has moved.
+     */
+    void store(KernelCountersArgument<instrumented> argument, uint64_t n_active_cycles,
+               uint64_t n_cells) {
+        if constexpr (instrumented) {
+            counters.n_active_cycles = n_active_cycles;
+            counters.n_cells = n_cells;
+            argument[0] += counters;
+        }
+    }
+
+  private:
+    KernelCounters counters;
+};
+
+} // namespace stencil
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <array>
+#include <climits>
+#include <mpi.h>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace stencil {
+
+/**
+ * \brief A communicator that exchanges values between MPI ranks.
+ *
+ * This class fulfills the \ref stencil::concepts::Communicator "Communicator" concept for the
+ * ranks of an MPI communicator. The ranks are arranged in the order of their MPI ranks. Since this
+ * header depends on MPI, it isn't included by any other header of StencilStream; Applications that
+ * use it have to find and link MPI themselves. `MPI_Init` has to be called before a communicator
+ * is created.
+ */
+class MPICommunicator {
+  public:
+    /**
+     * \brief Create a communicator for the ranks of the given MPI communicator.
+     */
+    MPICommunicator(MPI_Comm comm = MPI_COMM_WORLD) : comm(comm) {
+        int rank, n_ranks;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &n_ranks);
+        this->rank = rank;
+        this->n_ranks = n_ranks;
+    }
+
+    /**
+     * \brief Return the index of this rank.
+     */
+    uindex_t get_rank() const { return rank; }
+
+    /**
+     * \brief Return the total number of ranks.
+     */
+    uindex_t get_n_ranks() const { return n_ranks; }
+
+    /**
+     * \brief Exchange values with the neighboring ranks.
+     *
+     * All four transfers are started at once with non-blocking operations, and the method returns
+     * when all of them are complete. The values are transferred as raw bytes, so `T` has to be
+     * trivially copyable.
+     *
+     * \throws std::range_error One of the vectors has more bytes than an MPI count can hold.
+     *
+     * \throws std::runtime_error An MPI operation failed.
+     */
+    template <typename T>
+    void exchange(std::vector<T> const &send_left, std::vector<T> const &send_right,
+                  std::vector<T> &receive_left, std::vector<T> &receive_right) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        constexpr int to_the_left = 0;
+        constexpr int to_the_right = 1;
+
+        // All counts are checked before the first transfer is started.
+        int send_left_count = byte_count(send_left);
+        int send_right_count = byte_count(send_right);
+        int receive_left_count = byte_count(receive_left);
+        int receive_right_count = byte_count(receive_right);
+
+        std::array<MPI_Request, 4> requests;
+        int n_requests = 0;
+        if (rank > 0) {
+            int left = rank - 1;
+            check(MPI_Irecv(receive_left.data(), receive_left_count, MPI_BYTE, left, to_the_right,
+                            comm, &requests[n_requests++]));
+            check(MPI_Isend(send_left.data(), send_left_count, MPI_BYTE, left, to_the_left, comm,
+                            &requests[n_requests++]));
+        }
+        if (rank + 1 < n_ranks) {
+            int right = rank + 1;
+            check(MPI_Irecv(receive_right.data(), receive_right_count, MPI_BYTE, right,
+                            to_the_left, comm, &requests[n_requests++]));
+            check(MPI_Isend(send_right.data(), send_right_count, MPI_BYTE, right, to_the_right,
+                            comm, &requests[n_requests++]));
+        }
+        check(MPI_Waitall(n_requests, requests.data(), MPI_STATUSES_IGNORE));
+    }
+
+  private:
+    /**
+     * \brief Return the number of bytes in a vector as an MPI count.
+     *
+     * \throws std::range_error The number of bytes exceeds `INT_MAX`.
+     */
+    template <typename T> static int byte_count(std::vector<T> const &values) {
+        if (values.size() > std::size_t(INT_MAX) / sizeof(T)) {
+            throw std::range_error("The exchanged values exceed the maximal MPI count.");
+        }
+        return int(values.size() * sizeof(T));
+    }
+
+    /**
+     * \brief Throw an exception if an MPI operation didn't succeed.
+     *
+     * MPI error codes are distinct values, not flags, so every result is checked on its own.
+     *
+     * \throws std::runtime_error The result isn't `MPI_SUCCESS`.
+     */
+    static void check(int result) {
+        if (result != MPI_SUCCESS) {
+            throw std::runtime_error("The exchange with the neighboring ranks failed.");
+        }
+    }
+
+    MPI_Comm comm;
+    uindex_t rank, n_ranks;
+};
+
+} // namespace stencil
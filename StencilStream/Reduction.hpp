@@ -0,0 +1,326 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Concepts.hpp"
+#include "Helpers.hpp"
+#include "Index.hpp"
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace stencil {
+
+/**
+ * \brief An accumulator for reductions that are evaluated in pipelined loops.
+ *
+ * If a loop combines every new value directly with one accumulator, the next loop iteration has
+ * to wait until the combination is complete. This accumulator therefore rotates through
+ * `n_lanes` independent partial results, which gives every combination `n_lanes` loop iterations
+ * of time. The partial results are only combined when the final value is requested.
+ *
+ * \tparam Cell The cell type of the reduced grid.
+ *
+ * \tparam R The reduction to evaluate.
+ *
+ * \tparam n_lanes The number of independent partial results.
+ */
+template <typename Cell, concepts::Reduction<Cell> R, uindex_t n_lanes = 8>
+    requires(n_lanes >= 1)
+class ReductionAccumulator {
+  public:
+    /// \brief The type of the reduced value.
+    using Value = typename R::Value;
+
+    /**
+     * \brief Create a new accumulator whose partial results are the identity of the reduction.
+     */
+    ReductionAccumulator(R reduction) : reduction(reduction), lanes() {
+#pragma unroll
+        for (uindex_t i = 0; i < n_lanes; i++) {
+            lanes[i] = reduction.identity();
+        }
+    }
+
+    /**
+     * \brief Combine the value with the oldest partial result.
+     */
+    void add(Value const &value) {
+        Value new_value = reduction.combine(lanes[n_lanes - 1], value);
+#pragma unroll
+        for (uindex_t i = n_lanes - 1; i > 0; i--) {
+            lanes[i] = lanes[i - 1];
+        }
+        lanes[0] = new_value;
+    }
+
+    /**
+     * \brief Return the combination of all added values.
+     */
+    Value get() const {
+        Value value = reduction.identity();
+#pragma unroll
+        for (uindex_t i = 0; i < n_lanes; i++) {
+            value = reduction.combine(value, lanes[i]);
+        }
+        return value;
+    }
+
+  private:
+    R reduction;
+    std::array<Value, n_lanes> lanes;
+};
+
+/**
+ * \brief Submit a kernel that forwards cells from one pipe to another and reduces them on the way.
+ *
+ * The FPGA backends insert this kernel between the execution kernel and the output kernel of their
+ * last pass, so that the reduction is evaluated while the cells are written back. The kernel
+ * expects the cells of a `n_columns` by `n_rows` grid section in column-major order. If the vector
+ * width is greater than one, the pipes transfer \ref CellVector "CellVectors" and every column is
+ * padded to a multiple of the vector width. The padding cells are forwarded, but not reduced.
+ *
+ * \tparam Cell The cell type.
+ *
+ * \tparam in_pipe The pipe to read the cells from.
+ *
+ * \tparam out_pipe The pipe to forward the cells to.
+ *
+ * \tparam vector_width The number of cells per pipe operation.
+ *
+ * \param queue The queue to submit the kernel to.
+ *
+ * \param reduction The reduction to evaluate.
+ *
+ * \param n_columns The number of columns to forward.
+ *
+ * \param n_rows The number of rows to forward.
+ *
+ * \param result_buffer The buffer to write the reduced value to. It must contain at least one
+ * element.
+ *
+ * \returns The event object of the submitted kernel.
+ */
+template <typename Cell, typename in_pipe, typename out_pipe, uindex_t vector_width = 1,
+          concepts::Reduction<Cell> R>
+sycl::event submit_reduction_kernel(sycl::queue queue, R reduction, uindex_t n_columns,
+                                    uindex_t n_rows,
+                                    sycl::buffer<typename R::Value, 1> result_buffer) {
+    return queue.submit([&](sycl::handler &cgh) {
+        sycl::accessor result_ac(result_buffer, cgh, sycl::write_only);
+        uindex_t vector_height = n_cells_to_n_words(n_rows, vector_width);
+
+        cgh.single_task([=]() {
+            ReductionAccumulator<Cell, R> accumulator(reduction);
+            [[intel::loop_coalesce(2)]] for (uindex_t c = 0; c < n_columns; c++) {
+                for (uindex_t r = 0; r < vector_height; r++) {
+                    CellVector<Cell, vector_width> vector = in_pipe::read();
+                    out_pipe::write(vector);
+
+                    if constexpr (vector_width == 1) {
+                        accumulator.add(reduction.map(vector));
+                    } else {
+                        typename R::Value value = reduction.identity();
+#pragma unroll
+                        for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                            if (r * vector_width + i_cell < n_rows) {
+                                value = reduction.combine(value, reduction.map(vector[i_cell]));
+                            }
+                        }
+                        accumulator.add(value);
+                    }
+                }
+            }
+            result_ac[0] = accumulator.get();
+        });
+    });
+}
+
+/**
+ * \brief The pending result of a reduction that has been evaluated by multiple kernels.
+ *
+ * Every kernel that evaluates a part of the reduction writes its partial results to a buffer
+ * requested with \ref add_partial_results. The partial results are combined on the host when the
+ * result is requested.
+ *
+ * \tparam Cell The cell type of the reduced grid.
+ *
+ * \tparam R The reduction type. It must satisfy the \ref stencil::concepts::Reduction "Reduction"
+ * concept, unless it's `std::monostate`, which yields an empty placeholder class.
+ */
+template <typename Cell, typename R> class ReductionResult {
+    static_assert(concepts::Reduction<R, Cell>);
+
+  public:
+    /// \brief The type of the reduced value.
+    using Value = typename R::Value;
+
+    /**
+     * \brief Create a new result without any partial results.
+     */
+    ReductionResult(R reduction) : reduction(reduction), partial_results() {}
+
+    /**
+     * \brief Return a new buffer for `n_partial_results` partial results.
+     *
+     * All elements of the buffer have to be written by a kernel.
+     */
+    sycl::buffer<Value, 1> add_partial_results(uindex_t n_partial_results) {
+        partial_results.push_back(sycl::buffer<Value, 1>(sycl::range<1>(n_partial_results)));
+        return partial_results.back();
+    }
+
+    /**
+     * \brief Combine all partial results.
+     *
+     * This method blocks until all kernels that write partial results are complete.
+     */
+    Value get() {
+        Value value = reduction.identity();
+        for (sycl::buffer<Value, 1> &buffer : partial_results) {
+            sycl::host_accessor ac(buffer, sycl::read_only);
+            for (uindex_t i = 0; i < buffer.get_range()[0]; i++) {
+                value = reduction.combine(value, ac[i]);
+            }
+        }
+        return value;
+    }
+
+  private:
+    R reduction;
+    std::vector<sycl::buffer<Value, 1>> partial_results;
+};
+
+template <typename Cell> class ReductionResult<Cell, std::monostate> {};
+
+/**
+ * \brief The outcome of a `run_until` call of a stencil update.
+ *
+ * \tparam Grid The grid type of the stencil update.
+ *
+ * \tparam Value The value type of the reduction.
+ */
+template <typename Grid, typename Value> struct RunUntilResult {
+    /// \brief The last grid whose reduction was checked.
+    Grid grid;
+
+    /// \brief The number of iterations that were applied to the source grid to compute `grid`.
+    uindex_t n_iterations;
+
+    /// \brief The reduced value of `grid`.
+    Value reduction_value;
+
+    /// \brief True iff the predicate holds for `reduction_value`.
+    bool converged;
+};
+
+/**
+ * \brief Repeatedly update a grid until its reduction fulfills a predicate.
+ *
+ * The grid is updated in intervals of `check_interval` iterations. After every interval, the
+ * reduction configured in the parameters of the updater is evaluated on the device and only the
+ * reduced value is transferred to the host, where it's passed to the predicate. While the host
+ * waits for the reduced value of one interval, the next interval is already submitted, so that the
+ * device is kept busy. If the predicate holds, the result of this speculative interval is dropped,
+ * but it's still counted in the statistics of the updater, and the updater reports the reduction of
+ * the returned grid again.
+ *
+ * The iteration offset is taken from the parameters of the updater and the source grid is never
+ * overwritten. The parameters are restored before the function returns or throws.
+ *
+ * \tparam SU The type of the stencil updater. Next to the usual `get_params` and `operator()`, it
+ * needs to provide `get_pending_reduction_result` and `set_pending_reduction_result`, and its
+ * parameters need to contain the fields `iteration_offset`, `n_iterations`, `blocking`,
+ * `overwrite_source` and `reduction`.
+ *
+ * \tparam G The grid type of the updater.
+ *
+ * \tparam Predicate A callable object that receives the reduced value and returns true if the
+ * computation should stop.
+ *
+ * \param update The stencil updater to use.
+ *
+ * \param source_grid The grid to start with. It isn't altered.
+ *
+ * \param predicate The predicate to check after every interval.
+ *
+ * \param check_interval The number of iterations between two checks of the predicate.
+ *
+ * \param max_iterations The maximal number of iterations to compute. If the predicate never holds,
+ * the grid after this number of iterations is returned.
+ *
+ * \throws std::invalid_argument No reduction is set in the parameters, or the check interval or the
+ * maximal number of iterations is zero.
+ *
+ * \returns The last checked grid, the number of iterations it has been updated by, its reduced
+ * value and whether the predicate holds for it.
+ */
+template <typename SU, typename G, typename Predicate>
+    requires requires(SU &update) { update.get_pending_reduction_result(); }
+auto run_until(SU &update, G &source_grid, Predicate predicate, uindex_t check_interval,
+               uindex_t max_iterations) {
+    using PendingResult = typename decltype(update.get_pending_reduction_result())::value_type;
+    using Value = typename PendingResult::Value;
+    using PendingInterval = std::pair<G, PendingResult>;
+
+    auto &params = update.get_params();
+    if (!params.reduction.has_value()) {
+        throw std::invalid_argument("run_until requires a reduction in the parameters.");
+    }
+    if (check_interval == 0 || max_iterations == 0) {
+        throw std::invalid_argument(
+            "The check interval and the maximal number of iterations must be positive.");
+    }
+
+    RestoreGuard params_guard(params);
+    params.blocking = false;
+    params.overwrite_source = false;
+
+    auto submit_interval = [&](G &grid, uindex_t n_done) {
+        params.iteration_offset = params_guard.get_saved().iteration_offset + n_done;
+        params.n_iterations = std::min(check_interval, max_iterations - n_done);
+        G target_grid = update(grid);
+        return PendingInterval(target_grid, *update.get_pending_reduction_result());
+    };
+
+    uindex_t n_done = std::min(check_interval, max_iterations);
+    PendingInterval current = submit_interval(source_grid, 0);
+    while (true) {
+        std::optional<PendingInterval> next = std::nullopt;
+        if (n_done < max_iterations) {
+            next = submit_interval(current.first, n_done);
+        }
+
+        Value value = current.second.get();
+        bool converged = predicate(value);
+        if (converged || !next.has_value()) {
+            update.set_pending_reduction_result(current.second);
+            return RunUntilResult<G, Value>{current.first, n_done, value, converged};
+        }
+
+        current = *next;
+        n_done += std::min(check_interval, max_iterations - n_done);
+    }
+}
+
+} // namespace stencil
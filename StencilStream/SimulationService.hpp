@@ -0,0 +1,248 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace stencil {
+
+/**
+ * \brief A thread-safe service that runs independent simulations on multiple devices.
+ *
+ * A stencil updater object may only be used by one thread at a time, since its statistics, its
+ * queues and its grid pool aren't synchronized. The service therefore owns a pool of worker
+ * threads, each with an updater of its own that computes on one of the given devices. Any number
+ * of threads may submit jobs, consisting of a source grid and the parameters of the update, and
+ * the jobs are handed out to the workers in submission order as soon as a worker becomes idle.
+ * This way, a single process can run a parameter sweep of many simulations on all devices of a
+ * node.
+ *
+ * Every job is computed with its own parameters, except for the device, which is set to the
+ * device of the worker, and the blocking flag, which is always set. The result is delivered
+ * via the future returned by \ref submit. The statistic counters of the service are atomic and
+ * may be polled without blocking the workers. The grids of the results are taken from the grid
+ * pools of the workers' updaters and are reused once they are no longer referenced.
+ *
+ * FPGA designs contain only one instance of every kernel, so the monotile and tiling updaters
+ * should be used with one worker per device: Otherwise, the kernels of concurrent jobs would
+ * share the pipes between them. Static grids aren't part of the parameters and therefore can't
+ * be set for the updaters of a service.
+ *
+ * \tparam SU The stencil updater to use. It has to provide a `Params` struct with a `device` and
+ * a `blocking` field, a constructor that accepts it, as well as the methods `get_params()` and
+ * `get_n_processed_cells()`.
+ */
+template <typename SU> class SimulationService {
+  public:
+    /// \brief Shorthand for the grid type of the updater.
+    using GridImpl = typename SU::GridImpl;
+
+    /// \brief Shorthand for the parameters of the updater.
+    using Params = typename SU::Params;
+
+    /**
+     * \brief Create the service and start its worker threads.
+     *
+     * \param devices The devices to compute on.
+     *
+     * \param n_workers_per_device The number of worker threads for every device. With more than
+     * one worker, the allocation and the submission of one job on the host may overlap with the
+     * computation of another.
+     *
+     * \throws std::invalid_argument No device is given or the number of workers per device is
+     * zero.
+     */
+    SimulationService(std::vector<sycl::device> devices, uindex_t n_workers_per_device = 1)
+        : mutex(), job_available(), job_completed(), jobs(), stopping(false), workers(),
+          n_submitted_jobs(0), n_completed_jobs(0), n_processed_cells(0) {
+        if (devices.empty() || n_workers_per_device == 0) {
+            throw std::invalid_argument("A simulation service needs at least one worker.");
+        }
+        try {
+            for (sycl::device const &device : devices) {
+                for (uindex_t i_worker = 0; i_worker < n_workers_per_device; i_worker++) {
+                    workers.emplace_back([this, device]() { run_worker(device); });
+                }
+            }
+        } catch (...) {
+            // Joinable threads must not be destroyed, so the started workers are stopped first.
+            stop_workers();
+            throw;
+        }
+    }
+
+    SimulationService(SimulationService const &) = delete;
+    SimulationService &operator=(SimulationService const &) = delete;
+
+    /**
+     * \brief Complete all submitted jobs and stop the worker threads.
+     */
+    ~SimulationService() { stop_workers(); }
+
+    /**
+     * \brief Submit a job to the service.
+     *
+     * This method may be called from any thread. The source grid is not altered, as long as \ref
+     * Params::overwrite_source isn't set in the parameters, but it must not be modified until the
+     * job is completed.
+     *
+     * \param source_grid The grid to start the simulation with.
+     *
+     * \param params The parameters of the update.
+     *
+     * \returns A future of the updated grid. If the updater throws an exception, it is rethrown
+     * by the future instead.
+     */
+    std::future<GridImpl> submit(GridImpl source_grid, Params params) {
+        std::promise<GridImpl> result;
+        std::future<GridImpl> future = result.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(Job{source_grid, params, std::move(result)});
+            n_submitted_jobs++;
+        }
+        job_available.notify_one();
+        return future;
+    }
+
+    /**
+     * \brief Block until all jobs that were submitted before are completed.
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        uindex_t n_jobs = n_submitted_jobs;
+        job_completed.wait(lock, [&]() { return n_completed_jobs >= n_jobs; });
+    }
+
+    /**
+     * \brief Return the number of worker threads.
+     */
+    uindex_t get_n_workers() const { return workers.size(); }
+
+    /**
+     * \brief Return the number of jobs that have been submitted so far.
+     */
+    uindex_t get_n_submitted_jobs() const { return n_submitted_jobs; }
+
+    /**
+     * \brief Return the number of jobs that have been completed so far, including failed jobs.
+     */
+    uindex_t get_n_completed_jobs() const { return n_completed_jobs; }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by all workers.
+     *
+     * For every completed job, this is the width times the height of the grid, times the number
+     * of computed iterations.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+  private:
+    /**
+     * \brief A submitted job that hasn't been picked up by a worker yet.
+     */
+    struct Job {
+        GridImpl source_grid;
+        Params params;
+        std::promise<GridImpl> result;
+    };
+
+    /**
+     * \brief Let the workers complete the remaining jobs and join them.
+     */
+    void stop_workers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        job_available.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * \brief The loop of a worker thread.
+     *
+     * The updater of the worker is created with the parameters of the first job and reused for
+     * all later jobs, so that its queues and grids are kept. The loop ends once the service is
+     * stopping and no jobs are left.
+     */
+    void run_worker(sycl::device device) {
+        std::optional<SU> updater;
+        while (true) {
+            std::optional<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_available.wait(lock, [&]() { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job.emplace(std::move(jobs.front()));
+                jobs.pop_front();
+            }
+
+            try {
+                job->params.device = device;
+                job->params.blocking = true;
+                if (updater.has_value()) {
+                    updater->get_params() = job->params;
+                } else {
+                    updater.emplace(job->params);
+                }
+                uindex_t n_previous_cells = updater->get_n_processed_cells();
+                GridImpl target_grid = (*updater)(job->source_grid);
+                n_processed_cells += updater->get_n_processed_cells() - n_previous_cells;
+                job->result.set_value(target_grid);
+            } catch (...) {
+                job->result.set_exception(std::current_exception());
+            }
+
+            {
+                // The counter is increased under the lock so that waiting threads can't miss
+                // the notification.
+                std::lock_guard<std::mutex> lock(mutex);
+                n_completed_jobs++;
+            }
+            job_completed.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable job_completed;
+    std::deque<Job> jobs;
+    bool stopping;
+    std::vector<std::thread> workers;
+    std::atomic<uindex_t> n_submitted_jobs;
+    std::atomic<uindex_t> n_completed_jobs;
+    std::atomic<uindex_t> n_processed_cells;
+};
+
+} // namespace stencil
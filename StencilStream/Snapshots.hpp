@@ -0,0 +1,186 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <algorithm>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace stencil {
+
+/**
+ * \brief Update a grid and pass intermediate snapshots to a callback, without stalling the device.
+ *
+ * The grid is updated in intervals of `snapshot_interval` iterations. After every interval, the
+ * updated grid is handed to a host worker thread that calls the callback with it, while the next
+ * interval is already submitted. Therefore, the device keeps computing while the host evaluates or
+ * writes the snapshots, for example to disk.
+ *
+ * The snapshot grids are the output grids of the updater. Since the worker holds a reference to
+ * them until the callback has returned, the grid pool of the updater doesn't reuse them for later
+ * intervals and allocates additional grids instead. At most `max_pending_snapshots` snapshots wait
+ * for or are processed by the callback at any time, which limits the number of these additional
+ * grids. If the callback is slower than the device, the submission of the next interval waits
+ * until a snapshot has been processed.
+ *
+ * The iteration offset is taken from the parameters of the updater, and the parameters are restored
+ * before the function returns. The updater never overwrites its source grid in between. If the
+ * updater is blocking, the host waits for every interval before it submits the next one, but the
+ * callback still runs concurrently to the computation of the next interval.
+ *
+ * \tparam SU The type of the stencil updater. Its parameters need to contain the fields
+ * `iteration_offset`, `n_iterations` and `overwrite_source`.
+ *
+ * \tparam G The grid type of the updater.
+ *
+ * \tparam Callback A callable object that is invoked as `callback(grid, i_iteration)` with a
+ * snapshot grid and the iteration index of its cells. It is called from the worker thread, one
+ * snapshot after another and in the order of the iterations. It must not modify the grid.
+ *
+ * \param update The stencil updater to use.
+ *
+ * \param source_grid The grid to start with. It isn't altered.
+ *
+ * \param n_iterations The total number of iterations to compute.
+ *
+ * \param snapshot_interval The number of iterations between two snapshots. If `n_iterations` isn't
+ * a multiple of it, the last interval is shorter. The final grid is always passed to the callback
+ * too.
+ *
+ * \param callback The callback to invoke for every snapshot.
+ *
+ * \param max_pending_snapshots The maximal number of snapshots that have been computed but not yet
+ * processed by the callback. Two snapshots give double buffering, three triple buffering.
+ *
+ * \returns The grid after `n_iterations` iterations.
+ *
+ * \throws std::invalid_argument The snapshot interval or the maximal number of pending snapshots is
+ * zero.
+ *
+ * \throws Any exception thrown by the callback. In this case, no further intervals are submitted
+ * and the exception is rethrown once the worker thread has finished.
+ */
+template <typename SU, typename G, typename Callback>
+    requires std::invocable<Callback &, G &, uindex_t>
+G run_with_snapshots(SU &update, G &source_grid, uindex_t n_iterations, uindex_t snapshot_interval,
+                     Callback callback, uindex_t max_pending_snapshots = 2) {
+    if (snapshot_interval == 0 || max_pending_snapshots == 0) {
+        throw std::invalid_argument(
+            "The snapshot interval and the number of pending snapshots must be positive.");
+    }
+
+    std::mutex mutex;
+    std::condition_variable state_changed;
+    std::deque<std::pair<G, uindex_t>> pending_snapshots;
+    // The number of snapshots that are queued or currently processed by the callback.
+    uindex_t n_unprocessed_snapshots = 0;
+    bool done = false;
+    std::exception_ptr callback_exception = nullptr;
+
+    // The fallible setup happens before the worker is started, since an exception would otherwise
+    // destroy the joinable worker thread.
+    auto &params = update.get_params();
+    auto original_params = params;
+    G grid = source_grid;
+
+    std::thread worker([&]() {
+        while (true) {
+            std::unique_lock lock(mutex);
+            state_changed.wait(lock, [&]() { return done || !pending_snapshots.empty(); });
+            if (pending_snapshots.empty()) {
+                return;
+            }
+            std::pair<G, uindex_t> snapshot = pending_snapshots.front();
+            pending_snapshots.pop_front();
+            lock.unlock();
+
+            try {
+                callback(snapshot.first, snapshot.second);
+            } catch (...) {
+                lock.lock();
+                callback_exception = std::current_exception();
+                pending_snapshots.clear();
+                n_unprocessed_snapshots = 0;
+                state_changed.notify_all();
+                return;
+            }
+
+            lock.lock();
+            n_unprocessed_snapshots--;
+            state_changed.notify_all();
+        }
+    });
+
+    params.overwrite_source = false;
+    uindex_t n_done = 0;
+    std::exception_ptr update_exception = nullptr;
+    try {
+        while (n_done < n_iterations) {
+            {
+                std::unique_lock lock(mutex);
+                state_changed.wait(lock, [&]() {
+                    return callback_exception != nullptr ||
+                           n_unprocessed_snapshots < max_pending_snapshots;
+                });
+                if (callback_exception != nullptr) {
+                    break;
+                }
+            }
+
+            params.iteration_offset = original_params.iteration_offset + n_done;
+            params.n_iterations = std::min(snapshot_interval, n_iterations - n_done);
+            grid = update(grid);
+            n_done += params.n_iterations;
+
+            {
+                std::lock_guard lock(mutex);
+                pending_snapshots.emplace_back(grid, original_params.iteration_offset + n_done);
+                n_unprocessed_snapshots++;
+            }
+            state_changed.notify_all();
+        }
+    } catch (...) {
+        update_exception = std::current_exception();
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    state_changed.notify_all();
+    worker.join();
+    params = original_params;
+
+    if (update_exception != nullptr) {
+        std::rethrow_exception(update_exception);
+    }
+    if (callback_exception != nullptr) {
+        std::rethrow_exception(callback_exception);
+    }
+    return grid;
+}
+
+} // namespace stencil
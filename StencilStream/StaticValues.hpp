@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Concepts.hpp"
+#include "GenericID.hpp"
+#include "Helpers.hpp"
+#include "Index.hpp"
+#include "Stencil.hpp"
+#include <array>
+
+namespace stencil {
+
+/**
+ * \brief A cell bundled with its static value.
+ *
+ * The FPGA backends stream these bundles through their execution kernels, so that every
+ * processing element has the static value of the cell it's processing at hand. Only the cell is
+ * written back to global memory.
+ *
+ * \tparam Cell The cell type.
+ *
+ * \tparam StaticValue The static value type.
+ */
+template <typename Cell, typename StaticValue> struct CellWithStaticValue {
+    /// \brief The mutable cell.
+    Cell cell;
+
+    /// \brief The read-only static value of the cell.
+    StaticValue static_value;
+};
+
+/**
+ * \brief A transition function that operates on cells bundled with their static values.
+ *
+ * This adapter wraps a transition function with static values into a transition function without
+ * them, whose cells are \ref CellWithStaticValue bundles. For every stencil, it unpacks the cells,
+ * passes the static value of the central cell to the wrapped transition function and bundles the
+ * result with the unchanged static value again. This way, the execution kernels of the backends
+ * don't need to know about static values at all.
+ *
+ * \tparam F The wrapped transition function.
+ */
+template <concepts::TransitionFunction F> class StaticValueTransitionFunction {
+  private:
+    using InnerCell = typename F::Cell;
+    using InnerStencil = Stencil<InnerCell, F::stencil_radius, typename F::TimeDependentValue,
+                                 StaticValueOf<F>, ConstantTableOf<F>>;
+
+  public:
+    using Cell = CellWithStaticValue<InnerCell, StaticValueOf<F>>;
+    using TimeDependentValue = typename F::TimeDependentValue;
+    using ConstantTable = ConstantTableOf<F>;
+
+    static constexpr uindex_t stencil_radius = F::stencil_radius;
+    static constexpr StencilShape stencil_shape = stencil_shape_of<F>;
+    static constexpr uindex_t n_subiterations = F::n_subiterations;
+
+    /**
+     * \brief Wrap the given transition function.
+     */
+    StaticValueTransitionFunction(F transition_function)
+        : transition_function(transition_function) {}
+
+    Cell operator()(Stencil<Cell, stencil_radius, TimeDependentValue, std::monostate,
+                            ConstantTable> const &stencil) const {
+        StaticValueOf<F> static_value = stencil[ID(0, 0)].static_value;
+        InnerStencil inner_stencil(stencil.id, stencil.grid_range, stencil.iteration,
+                                   stencil.subiteration, stencil.time_dependent_value,
+                                   static_value, stencil.get_constant_table_ptr());
+#pragma unroll
+        for (uindex_t c = 0; c < InnerStencil::diameter; c++) {
+#pragma unroll
+            for (uindex_t r = 0; r < InnerStencil::diameter; r++) {
+                inner_stencil[UID(c, r)] = stencil[UID(c, r)].cell;
+            }
+        }
+        return Cell{transition_function(inner_stencil), static_value};
+    }
+
+    TimeDependentValue get_time_dependent_value(uindex_t i_iteration) const {
+        return transition_function.get_time_dependent_value(i_iteration);
+    }
+
+  private:
+    F transition_function;
+};
+
+/**
+ * \brief A pipe-like type that bundles the values of a cell pipe and a static value pipe.
+ *
+ * Every read operation reads one cell and one static value and returns them as a \ref
+ * CellWithStaticValue. It can be used as the input pipe of an execution kernel. The non-blocking
+ * read only waits for the cells: If a cell is available, the matching static value is read with a
+ * blocking read, since both are sent concurrently.
+ *
+ * \tparam Cell The cell type.
+ *
+ * \tparam StaticValue The static value type.
+ *
+ * \tparam cell_pipe The pipe to read the cells from.
+ *
+ * \tparam static_value_pipe The pipe to read the static values from.
+ *
+ * \tparam vector_width The number of cells and static values per pipe operation. If it's greater
+ * than one, the pipes transfer \ref CellVector "CellVectors" and so does this type.
+ */
+template <typename Cell, typename StaticValue, typename cell_pipe, typename static_value_pipe,
+          uindex_t vector_width = 1>
+struct StaticValueInputPipe {
+    using Bundle = CellVector<CellWithStaticValue<Cell, StaticValue>, vector_width>;
+
+    static Bundle read() {
+        CellVector<Cell, vector_width> cells = cell_pipe::read();
+        return bundle(cells, static_value_pipe::read());
+    }
+
+    static Bundle read(bool &success) {
+        CellVector<Cell, vector_width> cells = cell_pipe::read(success);
+        if (!success) {
+            return Bundle();
+        }
+        return bundle(cells, static_value_pipe::read());
+    }
+
+  private:
+    static Bundle bundle(CellVector<Cell, vector_width> const &cells,
+                         CellVector<StaticValue, vector_width> const &static_values) {
+        if constexpr (vector_width == 1) {
+            return CellWithStaticValue<Cell, StaticValue>{cells, static_values};
+        } else {
+            std::array<CellWithStaticValue<Cell, StaticValue>, vector_width> bundles;
+#pragma unroll
+            for (uindex_t i = 0; i < vector_width; i++) {
+                bundles[i] = CellWithStaticValue<Cell, StaticValue>{cells[i], static_values[i]};
+            }
+            return bundles;
+        }
+    }
+};
+
+/**
+ * \brief A pipe-like type that strips the static values from cell bundles.
+ *
+ * Every write operation writes the cell of a \ref CellWithStaticValue to the cell pipe and drops
+ * the static value. Arrays of bundles are written as arrays of cells. It can be used as the output
+ * pipe of an execution kernel. Like SYCL pipes, it also offers non-blocking writes.
+ *
+ * \tparam cell_pipe The pipe to write the cells to.
+ */
+template <typename cell_pipe> struct StaticValueOutputPipe {
+    template <typename Cell, typename StaticValue>
+    static void write(CellWithStaticValue<Cell, StaticValue> const &bundle) {
+        cell_pipe::write(bundle.cell);
+    }
+
+    template <typename Cell, typename StaticValue>
+    static void write(CellWithStaticValue<Cell, StaticValue> const &bundle, bool &success) {
+        cell_pipe::write(bundle.cell, success);
+    }
+
+    template <typename Cell, typename StaticValue, std::size_t vector_width>
+    static void
+    write(std::array<CellWithStaticValue<Cell, StaticValue>, vector_width> const &bundles) {
+        cell_pipe::write(strip(bundles));
+    }
+
+    template <typename Cell, typename StaticValue, std::size_t vector_width>
+    static void
+    write(std::array<CellWithStaticValue<Cell, StaticValue>, vector_width> const &bundles,
+          bool &success) {
+        cell_pipe::write(strip(bundles), success);
+    }
+
+  private:
+    template <typename Cell, typename StaticValue, std::size_t vector_width>
+    static std::array<Cell, vector_width>
+    strip(std::array<CellWithStaticValue<Cell, StaticValue>, vector_width> const &bundles) {
+        std::array<Cell, vector_width> cells;
+#pragma unroll
+        for (std::size_t i = 0; i < vector_width; i++) {
+            cells[i] = bundles[i].cell;
+        }
+        return cells;
+    }
+};
+
+} // namespace stencil
@@ -22,6 +22,7 @@
 #include "Helpers.hpp"
 #include "Index.hpp"
 #include <bit>
+#include <concepts>
 #include <sycl/ext/intel/ac_types/ac_int.hpp>
 #include <variant>
 
@@ -41,9 +42,14 @@ namespace stencil {
  * \tparam Cell The type of cells in the stencil
  * \tparam stencil_radius The radius of the stencil, i.e. the extent of the stencil in each
  * direction from the central cell. \tparam TimeDependentValue The type of values provided by the
- * TDV system.
+ * TDV system. \tparam StaticValue The type of the read-only static value of the central cell.
+ * \tparam ConstantTable The type of the shared constant table, see \ref stencil::ConstantTable.
+ * \tparam History The type of the past time levels of the central cell, usually an array. See
+ * \ref stencil::HistoryTransitionFunction.
  */
-template <typename Cell, uindex_t stencil_radius, typename TimeDependentValue = std::monostate>
+template <typename Cell, uindex_t stencil_radius, typename TimeDependentValue = std::monostate,
+          typename StaticValue = std::monostate, typename ConstantTable = std::monostate,
+          typename History = std::monostate>
     requires std::semiregular<Cell> && (stencil_radius >= 1)
 class Stencil {
   public:
@@ -73,11 +79,16 @@ class Stencil {
      * \param iteration The present iteration index of the cells in the stencil.
      * \param subiteration The present sub-iteration index of the cells in the stencil.
      * \param tdv The time-dependent value for this iteration.
+     * \param static_value The static value of the central cell.
+     * \param constant_table The shared constant table. It must outlive the stencil.
+     * \param history The past time levels of the central cell, starting with the most recent one.
      */
     Stencil(ID id, UID grid_range, uindex_t iteration, uindex_t subiteration,
-            TimeDependentValue tdv)
+            TimeDependentValue tdv, StaticValue static_value = StaticValue(),
+            ConstantTable const *constant_table = nullptr, History history = History())
         : id(id), iteration(iteration), subiteration(subiteration), grid_range(grid_range),
-          time_dependent_value(tdv), internal() {}
+          time_dependent_value(tdv), static_value(static_value), history(history),
+          constant_table_ptr(constant_table), internal() {}
 
     /**
      * \brief Create a new stencil with the given contents.
@@ -88,11 +99,17 @@ class Stencil {
      * \param subiteration The present sub-iteration index of the cells in the stencil.
      * \param tdv The time-dependent value for this iteration.
      * \param raw An array of cells, which is copied into the stencil object.
+     * \param static_value The static value of the central cell.
+     * \param constant_table The shared constant table. It must outlive the stencil.
+     * \param history The past time levels of the central cell, starting with the most recent one.
      */
     Stencil(ID id, UID grid_range, uindex_t iteration, uindex_t subiteration,
-            TimeDependentValue tdv, Cell raw[diameter][diameter])
+            TimeDependentValue tdv, Cell raw[diameter][diameter],
+            StaticValue static_value = StaticValue(),
+            ConstantTable const *constant_table = nullptr, History history = History())
         : id(id), iteration(iteration), subiteration(subiteration), grid_range(grid_range),
-          time_dependent_value(tdv), internal() {
+          time_dependent_value(tdv), static_value(static_value), history(history),
+          constant_table_ptr(constant_table), internal() {
 #pragma unroll
         for (uindex_t c = 0; c < diameter; c++) {
 #pragma unroll
@@ -170,6 +187,36 @@ class Stencil {
      */
     Cell &operator[](StencilUID id) { return internal[id.c][id.r]; }
 
+    /**
+     * \brief Access the constant table that is shared by all processing elements.
+     */
+    ConstantTable const &constant_table() const
+        requires(!std::same_as<ConstantTable, std::monostate>)
+    {
+        return *constant_table_ptr;
+    }
+
+    /**
+     * \brief Return the pointer to the shared constant table.
+     *
+     * This is used by transition function adapters to pass the table on to the stencils of the
+     * wrapped transition functions.
+     */
+    ConstantTable const *get_constant_table_ptr() const { return constant_table_ptr; }
+
+    /**
+     * \brief Access a past time level of the central cell.
+     *
+     * \param n_levels_back How many iterations to go back, starting with one for the value of the
+     * central cell in the previous iteration. It must not be greater than the number of kept time
+     * levels.
+     */
+    auto const &previous(uindex_t n_levels_back) const
+        requires(!std::same_as<History, std::monostate>)
+    {
+        return history[n_levels_back - 1];
+    }
+
     /// \brief The position of the central cell in the global grid.
     const ID id;
 
@@ -185,7 +232,14 @@ class Stencil {
     /// \brief The time-dependent value for this iteration.
     const TimeDependentValue time_dependent_value;
 
+    /// \brief The static value of the central cell.
+    const StaticValue static_value;
+
+    /// \brief The past time levels of the central cell, starting with the most recent one.
+    const History history;
+
   private:
+    ConstantTable const *constant_table_ptr;
     Cell internal[diameter][diameter];
 };
 } // namespace stencil
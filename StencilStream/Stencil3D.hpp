@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "GenericID.hpp"
+#include "Index.hpp"
+#include <concepts>
+#include <variant>
+
+namespace stencil {
+
+/**
+ * \brief The stencil buffer of a three-dimensional stencil code.
+ *
+ * This is the three-dimensional sibling of \ref Stencil. It contains the cube of cells within the
+ * stencil radius around a central cell and is used by a \ref concepts::TransitionFunction3D
+ * "three-dimensional transition function" to calculate the next iteration of the central cell.
+ *
+ * The stencil can be indexed with an `ID3D` and a `UID3D`. Since `ID3D` is signed, the axes are
+ * within the range of [-radius : radius] and (0,0,0) points to the central cell. `UID3D` is
+ * unsigned and the axes are within the range of [0 : 2*radius + 1). Therefore, (0,0,0) points to
+ * the north-western corner of the first layer of the stencil.
+ *
+ * \tparam Cell The type of cells in the stencil.
+ *
+ * \tparam stencil_radius The radius of the stencil, i.e. the extent of the stencil in each
+ * direction from the central cell.
+ *
+ * \tparam TimeDependentValue The type of values provided by the TDV system.
+ */
+template <typename Cell, uindex_t stencil_radius, typename TimeDependentValue = std::monostate>
+    requires std::semiregular<Cell> && (stencil_radius >= 1)
+class Stencil3D {
+  public:
+    /// \brief The diameter (aka width, height and depth) of the stencil buffer.
+    static constexpr uindex_t diameter = 2 * stencil_radius + 1;
+
+    /**
+     * \brief Create a new stencil with an uninitialized buffer.
+     *
+     * \param id The position of the central cell in the global grid.
+     * \param grid_range The range of the underlying grid.
+     * \param iteration The present iteration index of the cells in the stencil.
+     * \param subiteration The present sub-iteration index of the cells in the stencil.
+     * \param tdv The time-dependent value for this iteration.
+     */
+    Stencil3D(ID3D id, UID3D grid_range, uindex_t iteration, uindex_t subiteration,
+              TimeDependentValue tdv)
+        : id(id), iteration(iteration), subiteration(subiteration), grid_range(grid_range),
+          time_dependent_value(tdv), internal() {}
+
+    /**
+     * \brief Access a cell in the stencil.
+     *
+     * Since the indices in `id` are signed, the origin of this index operator is the central cell.
+     */
+    Cell const &operator[](ID3D id) const {
+        return internal[id.c + stencil_radius][id.r + stencil_radius][id.l + stencil_radius];
+    }
+
+    /**
+     * \brief Access a cell in the stencil.
+     *
+     * Since the indices in `id` are signed, the origin of this index operator is the central cell.
+     */
+    Cell &operator[](ID3D id) {
+        return internal[id.c + stencil_radius][id.r + stencil_radius][id.l + stencil_radius];
+    }
+
+    /**
+     * \brief Access a cell in the stencil.
+     *
+     * Since the indices in `id` are unsigned, the origin of this index operator is the
+     * north-western corner of the first layer.
+     */
+    Cell const &operator[](UID3D id) const { return internal[id.c][id.r][id.l]; }
+
+    /**
+     * \brief Access a cell in the stencil.
+     *
+     * Since the indices in `id` are unsigned, the origin of this index operator is the
+     * north-western corner of the first layer.
+     */
+    Cell &operator[](UID3D id) { return internal[id.c][id.r][id.l]; }
+
+    /// \brief The position of the central cell in the global grid.
+    const ID3D id;
+
+    /// \brief The present iteration index of the cells in the stencil.
+    const uindex_t iteration;
+
+    /// \brief The present sub-iteration index of the cells in the stencil.
+    const uindex_t subiteration;
+
+    /// \brief The range of the underlying grid.
+    const UID3D grid_range;
+
+    /// \brief The time-dependent value for this iteration.
+    const TimeDependentValue time_dependent_value;
+
+  private:
+    Cell internal[diameter][diameter][diameter];
+};
+} // namespace stencil
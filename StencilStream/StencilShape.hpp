@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "Index.hpp"
+#include <algorithm>
+
+namespace stencil {
+
+/**
+ * \brief The set of neighbours that a transition function reads from its stencil.
+ *
+ * By default, the stencil updaters assume that a transition function may read every cell of its
+ * `(2 * stencil_radius + 1) x (2 * stencil_radius + 1)` stencil. If it only reads some of
+ * them, for example the five cells of a star, it may declare this with a static member `static
+ * constexpr StencilShape stencil_shape = StencilShape::star(1);`. The execution kernels then
+ * don't load the other cells into the stencil, so that the registers and caches for them can be
+ * removed from the design. Reading a cell outside of the declared shape returns an unspecified
+ * value.
+ *
+ * A shape is either a box or a star, with an individual extent in every direction. The west and
+ * east extents are along the column axis (negative and positive column offsets) and the north and
+ * south extents are along the row axis (negative and positive row offsets). A star consists of the
+ * cells on these axes, a box of all cells in the rectangle spanned by them.
+ */
+struct StencilShape {
+    /// \brief The maximal negative column offset of the shape.
+    uindex_t west;
+
+    /// \brief The maximal positive column offset of the shape.
+    uindex_t east;
+
+    /// \brief The maximal negative row offset of the shape.
+    uindex_t north;
+
+    /// \brief The maximal positive row offset of the shape.
+    uindex_t south;
+
+    /// \brief Whether the shape only contains the cells on the column and row axes.
+    bool star_shaped;
+
+    /**
+     * \brief A shape that contains all cells within the given radius.
+     */
+    static constexpr StencilShape box(uindex_t radius) {
+        return StencilShape{radius, radius, radius, radius, false};
+    }
+
+    /**
+     * \brief A shape that contains the cells on the axes within the given radius.
+     */
+    static constexpr StencilShape star(uindex_t radius) {
+        return StencilShape{radius, radius, radius, radius, true};
+    }
+
+    /**
+     * \brief A box with an individual extent in every direction.
+     */
+    static constexpr StencilShape asymmetric_box(uindex_t west, uindex_t east, uindex_t north,
+                                                 uindex_t south) {
+        return StencilShape{west, east, north, south, false};
+    }
+
+    /**
+     * \brief A star with an individual extent in every direction.
+     */
+    static constexpr StencilShape asymmetric_star(uindex_t west, uindex_t east, uindex_t north,
+                                                  uindex_t south) {
+        return StencilShape{west, east, north, south, true};
+    }
+
+    /**
+     * \brief Check whether the cell with the given offset from the central cell is in the shape.
+     */
+    constexpr bool contains(index_t c, index_t r) const {
+        bool within_columns = c >= -index_t(west) && c <= index_t(east);
+        bool within_rows = r >= -index_t(north) && r <= index_t(south);
+        bool on_axes = c == 0 || r == 0;
+        return within_columns && within_rows && (!star_shaped || on_axes);
+    }
+
+    /**
+     * \brief The radius of the smallest symmetric stencil that contains the shape.
+     */
+    constexpr uindex_t radius() const { return std::max({west, east, north, south}); }
+
+    /**
+     * \brief A shape that contains the cells of both shapes.
+     *
+     * This is a star if both shapes are stars, and a box otherwise. In both cases, the extent in
+     * every direction is the greater extent of the two shapes.
+     */
+    constexpr StencilShape unite(StencilShape const &other) const {
+        return StencilShape{std::max(west, other.west), std::max(east, other.east),
+                            std::max(north, other.north), std::max(south, other.south),
+                            star_shaped && other.star_shaped};
+    }
+
+    constexpr bool operator==(StencilShape const &other) const = default;
+};
+
+} // namespace stencil
@@ -0,0 +1,269 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "GenericID.hpp"
+#include "Index.hpp"
+#include <CL/sycl.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace stencil {
+
+/**
+ * \brief An interval of a stencil update, either a kernel execution or a phase on the host.
+ *
+ * The tags of an event tell which part of the update it belongs to. Tags that don't apply to an
+ * event are zero, for example the compute unit of an updater without multiple compute units.
+ */
+struct TimelineEvent {
+    /// \brief What happened in the interval, for example "read", "compute", "write" or "submit".
+    std::string name;
+
+    /// \brief True iff the interval is a kernel execution, and false if it's a host-side phase.
+    bool on_device = true;
+
+    /// \brief The index of the pass of the update, counted from the start of the update.
+    uindex_t pass = 0;
+
+    /// \brief The index of the compute unit that ran the kernel.
+    uindex_t unit = 0;
+
+    /// \brief The tile that was processed, if the kernel only processed one tile.
+    std::optional<UID> tile = std::nullopt;
+
+    /// \brief The index of the first iteration that was computed in the pass.
+    uindex_t iteration_begin = 0;
+
+    /// \brief The index after the last iteration that was computed in the pass.
+    uindex_t iteration_end = 0;
+
+    /// \brief The start of the interval, in seconds since the creation of the timeline.
+    double start = 0.0;
+
+    /// \brief The end of the interval, in seconds since the creation of the timeline.
+    double end = 0.0;
+};
+
+/**
+ * \brief A recording of the kernel executions and host-side phases of stencil updates.
+ *
+ * Stencil updaters fill a timeline if profiling is enabled: For every pass, they record the
+ * execution of every input, execution and output kernel, as well as the time the host needed to
+ * allocate the grids and to submit the kernels. This shows which kernel limits the update rate, or
+ * whether the device waits for the host.
+ *
+ * Kernel events are recorded together with the host time of their submission. The device
+ * timestamps of a kernel are translated to the host clock via the device timestamp of its
+ * submission, so that host-side phases and kernel executions can be compared.
+ *
+ * The timeline can be exported in the Chrome trace event format with \ref write_chrome_trace. The
+ * resulting file can be inspected with `chrome://tracing` or Perfetto.
+ *
+ * Every recorded kernel keeps its SYCL event until the timeline is cleared, so the timeline grows
+ * with every pass. For long runs, the events should be exported and \ref clear "cleared" from
+ * time to time.
+ */
+class Timeline {
+  public:
+    /**
+     * \brief Create a new, empty timeline whose time origin is the current point in time.
+     */
+    Timeline() : origin(std::chrono::steady_clock::now()), pending_kernels(), host_events() {}
+
+    /**
+     * \brief Return the current host time, in seconds since the creation of the timeline.
+     */
+    double now() const {
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - origin;
+        return time.count();
+    }
+
+    /**
+     * \brief Record a kernel execution that has just been submitted.
+     *
+     * The start and end of the tags are ignored. Instead, they are taken from the profiling
+     * information of the event, which therefore has to be submitted to a queue with profiling
+     * enabled. The event is kept until \ref clear is called.
+     */
+    void record_kernel(TimelineEvent tags, sycl::event event) {
+        tags.on_device = true;
+        pending_kernels.push_back({tags, event, now()});
+    }
+
+    /**
+     * \brief Record a host-side phase that started at the given time and ends now.
+     *
+     * \param tags The tags of the phase. The start and end are ignored.
+     *
+     * \param start The start of the phase, as returned by \ref now.
+     */
+    void record_host(TimelineEvent tags, double start) {
+        tags.on_device = false;
+        tags.start = start;
+        tags.end = now();
+        host_events.push_back(tags);
+    }
+
+    /**
+     * \brief Return all recorded events, ordered by their start.
+     *
+     * This method blocks until all recorded kernels have completed.
+     */
+    std::vector<TimelineEvent> get_events() const {
+        const double nanoseconds_per_second = 1000000000.0;
+        std::vector<TimelineEvent> events = host_events;
+        for (PendingKernel kernel : pending_kernels) {
+            kernel.event.wait();
+            double submit = double(kernel.event.template get_profiling_info<
+                                   sycl::info::event_profiling::command_submit>());
+            double start = double(kernel.event.template get_profiling_info<
+                                  sycl::info::event_profiling::command_start>());
+            double end = double(kernel.event.template get_profiling_info<
+                                sycl::info::event_profiling::command_end>());
+            TimelineEvent event = kernel.tags;
+            event.start = kernel.host_submit + (start - submit) / nanoseconds_per_second;
+            event.end = kernel.host_submit + (end - submit) / nanoseconds_per_second;
+            events.push_back(event);
+        }
+        std::stable_sort(events.begin(), events.end(),
+                         [](TimelineEvent const &a, TimelineEvent const &b) {
+                             return a.start < b.start;
+                         });
+        return events;
+    }
+
+    /**
+     * \brief Return the number of recorded events.
+     */
+    std::size_t size() const { return pending_kernels.size() + host_events.size(); }
+
+    /**
+     * \brief Remove all recorded events.
+     */
+    void clear() {
+        pending_kernels.clear();
+        host_events.clear();
+    }
+
+    /**
+     * \brief Write the recorded events in the Chrome trace event format.
+     *
+     * Every event becomes a complete ("X") event with microsecond timestamps and its tags as
+     * arguments. Host-side phases belong to the process "host" and kernel executions to the
+     * process "device". Within them, every combination of name and compute unit has a thread of
+     * its own, so that for example the input and the execution kernel of a unit are displayed as
+     * parallel tracks.
+     *
+     * This method blocks until all recorded kernels have completed.
+     */
+    void write_chrome_trace(std::ostream &trace_out) const {
+        std::map<std::tuple<bool, std::string, uindex_t>, uindex_t> thread_ids;
+        std::vector<TimelineEvent> events = get_events();
+
+        // The events are formatted in a separate stream to leave the flags of the output alone.
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        auto begin_entry = [&]() {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+        for (TimelineEvent const &event : events) {
+            auto key = std::make_tuple(event.on_device, event.name, event.unit);
+            if (!thread_ids.contains(key)) {
+                uindex_t thread_id = thread_ids.size();
+                thread_ids[key] = thread_id;
+                begin_entry();
+                out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << process_id(event)
+                    << ",\"tid\":" << thread_id << ",\"args\":{\"name\":\""
+                    << escape(event.name) << " " << event.unit << "\"}}";
+            }
+
+            begin_entry();
+            out << "{\"name\":\"" << escape(event.name) << "\",\"cat\":\""
+                << (event.on_device ? "device" : "host") << "\",\"ph\":\"X\",\"ts\":"
+                << event.start * 1e6 << ",\"dur\":" << (event.end - event.start) * 1e6
+                << ",\"pid\":" << process_id(event) << ",\"tid\":" << thread_ids[key]
+                << ",\"args\":{\"pass\":" << event.pass << ",\"unit\":" << event.unit;
+            if (event.tile.has_value()) {
+                out << ",\"tile_c\":" << event.tile->c << ",\"tile_r\":" << event.tile->r;
+            }
+            out << ",\"iteration_begin\":" << event.iteration_begin
+                << ",\"iteration_end\":" << event.iteration_end << "}}";
+        }
+        for (uindex_t pid = 0; pid < 2; pid++) {
+            begin_entry();
+            out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"args\":{\"name\":\"" << (pid == 0 ? "host" : "device") << "\"}}";
+        }
+        out << "\n]}\n";
+        trace_out << out.str();
+    }
+
+    /**
+     * \brief Write the recorded events to a file in the Chrome trace event format.
+     *
+     * \throws std::runtime_error The file can't be opened.
+     */
+    void write_chrome_trace(std::string const &path) const {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Could not open the trace file " + path + ".");
+        }
+        write_chrome_trace(out);
+    }
+
+  private:
+    struct PendingKernel {
+        TimelineEvent tags;
+        sycl::event event;
+        double host_submit;
+    };
+
+    static uindex_t process_id(TimelineEvent const &event) { return event.on_device ? 1 : 0; }
+
+    static std::string escape(std::string const &text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    std::chrono::steady_clock::time_point origin;
+    std::vector<PendingKernel> pending_kernels;
+    std::vector<TimelineEvent> host_events;
+};
+
+} // namespace stencil
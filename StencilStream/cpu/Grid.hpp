@@ -19,7 +19,11 @@
  */
 #pragma once
 #include "../Index.hpp"
+#include <concepts>
+#include <functional>
 #include <memory>
+#include <span>
+#include <type_traits>
 
 namespace stencil {
 namespace cpu {
@@ -86,6 +90,35 @@ template <typename Cell> class Grid {
         copy_from_buffer(other_buffer);
     }
 
+    /**
+     * \brief Create a grid that stores its cells in the given SYCL buffer, without copying them.
+     *
+     * The grid and the buffer share the same memory afterwards: Changes made via the grid are
+     * visible in the buffer, and vice-versa.
+     *
+     * \param other_buffer The buffer to use as the storage of the new grid.
+     */
+    static Grid adopt(sycl::buffer<Cell, 2> other_buffer) {
+        Grid grid(1, 1);
+        grid.buffer = other_buffer;
+        return grid;
+    }
+
+    /**
+     * \brief Create a grid that stores its cells in the given host memory, without copying them.
+     *
+     * The memory has to contain the cells column by column, like a SYCL buffer with the given
+     * range, and it has to stay valid as long as the grid or one of its copies exists.
+     *
+     * \param data The memory to use as the storage of the new grid.
+     *
+     * \param range The range of the new grid. The first index will be the width and the second
+     * index will be the height of the grid.
+     */
+    static Grid adopt(Cell *data, sycl::range<2> range) {
+        return adopt(sycl::buffer<Cell, 2>(data, range));
+    }
+
     /**
      * \brief Create a new reference to the given grid.
      *
@@ -95,7 +128,8 @@ template <typename Cell> class Grid {
      *
      * \param other_grid The other grid the new grid should reference.
      */
-    Grid(Grid const &other_grid) : buffer(other_grid.buffer) {}
+    Grid(Grid const &other_grid)
+        : buffer(other_grid.buffer), references(other_grid.references) {}
 
     /**
      * \brief Copy the contents of the SYCL buffer into the grid.
@@ -134,6 +168,74 @@ template <typename Cell> class Grid {
         std::memcpy(other_ac.get_pointer(), buffer_ac.get_pointer(), buffer_ac.byte_size());
     }
 
+    /**
+     * \brief Submit a kernel that extracts one value of every cell into a compact buffer.
+     *
+     * This provides the same interface as the `project` methods of the FPGA grids, so that host
+     * code that only needs one field of the cells can be written for all backends.
+     *
+     * \tparam Projection A callable object that is invoked as `projection(cell)` on the device.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param projection The projection to apply to every cell.
+     *
+     * \returns A buffer with the projected values, with the same range as the grid.
+     */
+    template <typename Projection>
+        requires std::invocable<Projection const &, Cell const &>
+    auto project(sycl::queue queue, Projection projection) {
+        using Value = std::remove_cvref_t<std::invoke_result_t<Projection const &, Cell const &>>;
+        sycl::buffer<Value, 2> output_buffer(buffer.get_range());
+        queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(buffer, cgh, sycl::read_only);
+            sycl::accessor out_ac(output_buffer, cgh, sycl::write_only);
+            cgh.parallel_for(buffer.get_range(),
+                             [=](sycl::id<2> id) { out_ac[id] = projection(ac[id]); });
+        });
+        return output_buffer;
+    }
+
+    /**
+     * \brief Submit a kernel that extracts one field of every cell into a compact buffer.
+     *
+     * This is a shorthand for \ref project(sycl::queue, Projection) with a projection that reads
+     * the given member, for example `grid.project<&Cell::hz>(queue)`.
+     *
+     * \tparam field A pointer to the member of the cell type to extract.
+     */
+    template <auto field> auto project(sycl::queue queue) {
+        return project(queue, [](Cell const &cell) { return std::invoke(field, cell); });
+    }
+
+    /**
+     * \brief Submit a kernel that overwrites every cell of the grid with the results of a
+     * generator.
+     *
+     * This is the counterpart to \ref project: The generator is called for every cell on the
+     * device, so large grids don't have to be initialized by a single host thread and transferred
+     * to the device afterwards.
+     *
+     * \tparam Generator A callable object that is invoked as `generator(c, r)` on the device with
+     * the column and row index of a cell. It returns the new value of the cell.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param generator The generator to call for every cell.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename Generator>
+        requires std::convertible_to<std::invoke_result_t<Generator const &, uindex_t, uindex_t>,
+                                     Cell>
+    sycl::event generate(sycl::queue queue, Generator generator) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(buffer, cgh, sycl::write_only, sycl::no_init);
+            cgh.parallel_for(buffer.get_range(),
+                             [=](sycl::id<2> id) { ac[id] = generator(id[0], id[1]); });
+        });
+    }
+
     /**
      * \brief An accessor for the grid.
      *
@@ -151,6 +253,54 @@ template <typename Cell> class Grid {
          */
         GridAccessor(Grid &grid)
             : sycl::host_accessor<Cell, Grid::dimensions, access_mode>(grid.buffer) {}
+
+        /**
+         * \brief Return a view of all cells of the grid, column by column.
+         */
+        auto get_cells() { return std::span(this->get_pointer(), this->size()); }
+
+        /**
+         * \brief Return a view of the cells of a column, from the first row to the last one.
+         *
+         * \param c The index of the column.
+         */
+        auto get_column(uindex_t c) {
+            uindex_t grid_height = this->get_range()[1];
+            return get_cells().subspan(c * grid_height, grid_height);
+        }
+    };
+
+    /**
+     * \brief A device accessor for the grid, to be used in kernels.
+     *
+     * This is a thin wrapper around a SYCL accessor that provides the same interface as the device
+     * accessors of other CPU grids, like \ref SoAGrid::DeviceAccessor.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode> class DeviceAccessor {
+      public:
+        /**
+         * \brief Create a new device accessor to the given grid.
+         *
+         * \param grid The grid to access.
+         *
+         * \param cgh The command group handler of the kernel that uses the accessor.
+         */
+        DeviceAccessor(Grid &grid, sycl::handler &cgh) : ac(grid.buffer, cgh) {}
+
+        /**
+         * \brief Load the cell at the given position.
+         */
+        Cell load(sycl::id<2> id) const { return ac[id]; }
+
+        /**
+         * \brief Store the cell at the given position.
+         */
+        void store(sycl::id<2> id, Cell const &cell) const { ac[id] = cell; }
+
+      private:
+        sycl::accessor<Cell, 2, access_mode> ac;
     };
 
     /**
@@ -170,8 +320,19 @@ template <typename Cell> class Grid {
 
     sycl::buffer<Cell, 2> &get_buffer() { return buffer; }
 
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     *
+     * Copies of a grid share the same underlying data. This method is used by the \ref
+     * stencil::GridPool to find grids that aren't referenced anywhere else and can therefore be
+     * reused.
+     */
+    long get_n_references() const { return references.use_count(); }
+
   private:
     sycl::buffer<Cell, 2> buffer;
+    // Only used to count the references to the grid data, see get_n_references().
+    std::shared_ptr<char> references = std::make_shared<char>();
 };
 } // namespace cpu
 } // namespace stencil
\ No newline at end of file
@@ -0,0 +1,444 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../AccessorSubscript.hpp"
+#include "../Index.hpp"
+#include <array>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stencil {
+namespace cpu {
+
+/**
+ * \brief A grid class for the CPU backend that stores cells as a structure of arrays.
+ *
+ * This grid fullfils the \ref stencil::concepts::Grid "Grid" concept just like \ref Grid, but
+ * instead of storing whole cells in one buffer, it stores every field of the cell in its own,
+ * contiguous buffer. Host code that only needs some of the fields, like an analysis that only
+ * reads one value of every cell, can access them with a \ref FieldAccessor without pulling the
+ * other fields through the cache. The `FieldAccessor` also provides the field as a `std::span`.
+ * Kernels load and store individual fields too, which allows the compiler to vectorize across
+ * cells.
+ *
+ * The stored fields are given as pointers to data members of the cell type:
+ *
+ * ```
+ * struct Cell {
+ *     float value;
+ *     int material;
+ * };
+ * using GridImpl = SoAGrid<Cell, &Cell::value, &Cell::material>;
+ * ```
+ *
+ * All fields of the cell that the transition function or the application relies on have to be
+ * listed. Fields that are not listed are not stored; They are default-initialized when a cell is
+ * loaded from the grid.
+ *
+ * The contents of the grid can also be accessed cell-by-cell with the \ref GridAccessor class
+ * template. Because the cells are not stored as such, the accessor assembles all cells of the grid
+ * on the host when it's created and, if it's not read-only, writes them back when it's destroyed.
+ *
+ * \tparam Cell The cell type to store. It must be default-constructible.
+ *
+ * \tparam fields Pointers to the data members of `Cell` that are stored.
+ */
+template <typename Cell, auto... fields>
+    requires(sizeof...(fields) >= 1 && (std::is_member_object_pointer_v<decltype(fields)> && ...))
+class SoAGrid {
+  private:
+    template <typename M> struct member_type;
+    template <typename T> struct member_type<T Cell::*> {
+        using type = T;
+    };
+
+    static constexpr auto field_pointers = std::make_tuple(fields...);
+    static constexpr std::size_t n_fields = sizeof...(fields);
+    using FieldIndices = std::make_index_sequence<n_fields>;
+
+  public:
+    /**
+     * \brief The number of dimensions of the grid.
+     *
+     * May be changed in the future when other dimensions are supported.
+     */
+    static constexpr uindex_t dimensions = 2;
+
+    /**
+     * \brief The type of a stored field.
+     *
+     * \tparam field The pointer to the data member of the cell.
+     */
+    template <auto field> using FieldType = typename member_type<decltype(field)>::type;
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param c The width, or number of columns, of the new grid.
+     *
+     * \param r The height, or number of rows, of the new grid.
+     */
+    SoAGrid(uindex_t c, uindex_t r) : SoAGrid(sycl::range<2>(c, r)) {}
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param range The range of the new grid. The first index will be the width and the second
+     * index will be the height of the grid.
+     */
+    SoAGrid(sycl::range<2> range) : buffers(sycl::buffer<FieldType<fields>, 2>(range)...) {}
+
+    /**
+     * \brief Create a new grid with the same size and contents as the given SYCL buffer.
+     *
+     * The contents of the buffer will be copied to the grid by the host. The SYCL buffer can later
+     * be used elsewhere.
+     *
+     * \param other_buffer The buffer with the contents of the new grid.
+     */
+    SoAGrid(sycl::buffer<Cell, 2> other_buffer) : SoAGrid(other_buffer.get_range()) {
+        copy_from_buffer(other_buffer);
+    }
+
+    /**
+     * \brief Create a new reference to the given grid.
+     *
+     * The newly created grid object will point to the same underlying data as the referenced grid.
+     * Changes made via the newly created grid object will also be visible to the old grid object,
+     * and vice-versa.
+     *
+     * \param other_grid The other grid the new grid should reference.
+     */
+    SoAGrid(SoAGrid const &other_grid)
+        : buffers(other_grid.buffers), references(other_grid.references) {}
+
+    /**
+     * \brief Copy the contents of the SYCL buffer into the grid.
+     *
+     * The SYCL buffer will be accessed read-only one the host; It may be used elsewhere too. The
+     * buffer however has to have the same size as the grid, otherwise a \ref std::range_error is
+     * thrown.
+     *
+     * \param other_buffer The buffer to copy the data from.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_from_buffer(sycl::buffer<Cell, 2> other_buffer) {
+        if (other_buffer.get_range() != get_range()) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+        sycl::host_accessor other_ac(other_buffer, sycl::read_only);
+        GridAccessor<sycl::access::mode::discard_write> grid_ac(*this);
+        for (uindex_t c = 0; c < get_grid_width(); c++) {
+            for (uindex_t r = 0; r < get_grid_height(); r++) {
+                grid_ac[c][r] = other_ac[c][r];
+            }
+        }
+    }
+
+    /**
+     * \brief Copy the contents of the grid into the SYCL buffer.
+     *
+     * The contents of the SYCL buffer will be overwritten on the host. The buffer also has to have
+     * the same size as the grid, otherwise a \ref std::range_error is thrown.
+     *
+     * \param other_buffer The buffer to copy the data to.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_to_buffer(sycl::buffer<Cell, 2> other_buffer) {
+        if (other_buffer.get_range() != get_range()) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+        GridAccessor<sycl::access::mode::read> grid_ac(*this);
+        sycl::host_accessor other_ac(other_buffer, sycl::write_only);
+        for (uindex_t c = 0; c < get_grid_width(); c++) {
+            for (uindex_t r = 0; r < get_grid_height(); r++) {
+                other_ac[c][r] = grid_ac[c][r];
+            }
+        }
+    }
+
+    /**
+     * \brief An accessor for the whole cells of the grid.
+     *
+     * Instances of this class provide access to a grid, so that host code can read and write the
+     * contents of a grid. As such, it fullfils the \ref stencil::concepts::GridAccessor
+     * "GridAccessor" concept. Since the grid doesn't store whole cells, the accessor assembles them
+     * from the individual fields when it's created, unless it's a discarding accessor. If it's not
+     * a read-only accessor, the cells are split up and written back when it's destroyed. Use a \ref
+     * FieldAccessor if only some fields are needed.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode = sycl::access::mode::read_write> class GridAccessor {
+      public:
+        /**
+         * \brief The number of dimensions of the underlying grid.
+         */
+        static constexpr uindex_t dimensions = SoAGrid::dimensions;
+
+        /**
+         * \brief Create a new accessor to the given grid.
+         */
+        GridAccessor(SoAGrid &grid)
+            : grid(grid), cells(grid.get_grid_width() * grid.get_grid_height()) {
+            if constexpr (access_mode != sycl::access::mode::discard_write &&
+                          access_mode != sycl::access::mode::discard_read_write) {
+                grid.gather(cells, FieldIndices());
+            }
+        }
+
+        GridAccessor(GridAccessor const &) = delete;
+        GridAccessor &operator=(GridAccessor const &) = delete;
+
+        /**
+         * \brief Write the cells back to the grid, if the accessor isn't read-only.
+         */
+        ~GridAccessor() {
+            if constexpr (access_mode != sycl::access::mode::read) {
+                grid.scatter(cells, FieldIndices());
+            }
+        }
+
+        /**
+         * \brief Shorthand for the used subscript type.
+         */
+        using BaseSubscript = AccessorSubscript<Cell, GridAccessor, access_mode>;
+
+        /**
+         * \brief Access/Dereference the first dimension.
+         *
+         * This subscript operator is the first subscript in an expression like
+         * `accessor[i_column][i_row]`. It will return a \ref BaseSubscript object that handles
+         * subsequent dimensions.
+         */
+        BaseSubscript operator[](uindex_t i) { return BaseSubscript(*this, i); }
+
+        /**
+         * \brief Access a cell of the grid.
+         *
+         * \param id The index of the accessed cell. The first index is the column index, the second
+         * one is the row index. \returns A constant reference to the indexed cell.
+         */
+        Cell const &operator[](sycl::id<2> id)
+            requires(access_mode == sycl::access::mode::read)
+        {
+            return cells[id[0] * grid.get_grid_height() + id[1]];
+        }
+
+        /**
+         * \brief Access a cell of the grid.
+         *
+         * \param id The index of the accessed cell. The first index is the column index, the second
+         * one is the row index. \returns A reference to the indexed cell.
+         */
+        Cell &operator[](sycl::id<2> id)
+            requires(access_mode != sycl::access::mode::read)
+        {
+            return cells[id[0] * grid.get_grid_height() + id[1]];
+        }
+
+      private:
+        SoAGrid &grid;
+        std::vector<Cell> cells;
+    };
+
+    /**
+     * \brief A host accessor for a single field of the grid.
+     *
+     * This accessor provides direct access to the buffer of one field, either with the usual
+     * `accessor[i_column][i_row]` expressions or as a contiguous span via \ref get_span. In the
+     * span, the values are ordered by column first and row second, i.e. the value of the cell at
+     * column `c` and row `r` has the index `c * grid_height + r`.
+     *
+     * \tparam field The pointer to the data member of the field.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <auto field, sycl::access::mode access_mode = sycl::access::mode::read_write>
+    class FieldAccessor : public sycl::host_accessor<FieldType<field>, 2, access_mode> {
+      public:
+        /**
+         * \brief Create a new accessor to the given field of the grid.
+         */
+        FieldAccessor(SoAGrid &grid)
+            : sycl::host_accessor<FieldType<field>, 2, access_mode>(
+                  grid.template get_field_buffer<field>()) {}
+
+        /**
+         * \brief Return the field values of all cells as a contiguous span.
+         */
+        auto get_span() const {
+            using Value = std::conditional_t<access_mode == sycl::access::mode::read,
+                                             FieldType<field> const, FieldType<field>>;
+            return std::span<Value>(this->get_pointer(), this->get_range().size());
+        }
+    };
+
+    /**
+     * \brief A device accessor for the grid, to be used in kernels.
+     *
+     * Loading a cell gathers the individual fields from their buffers and storing a cell scatters
+     * them back.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode> class DeviceAccessor {
+      public:
+        /**
+         * \brief Create a new device accessor to the given grid.
+         *
+         * \param grid The grid to access.
+         *
+         * \param cgh The command group handler of the kernel that uses the accessor.
+         */
+        DeviceAccessor(SoAGrid &grid, sycl::handler &cgh)
+            : accessors(make_accessors(grid, cgh, FieldIndices())) {}
+
+        /**
+         * \brief Load the cell at the given position.
+         */
+        Cell load(sycl::id<2> id) const {
+            Cell cell;
+            load_fields(cell, id, FieldIndices());
+            return cell;
+        }
+
+        /**
+         * \brief Store the cell at the given position.
+         */
+        void store(sycl::id<2> id, Cell const &cell) const {
+            store_fields(cell, id, FieldIndices());
+        }
+
+      private:
+        template <std::size_t... I>
+        static auto make_accessors(SoAGrid &grid, sycl::handler &cgh, std::index_sequence<I...>) {
+            return std::make_tuple(sycl::accessor<FieldType<std::get<I>(field_pointers)>, 2,
+                                                  access_mode>(std::get<I>(grid.buffers), cgh)...);
+        }
+
+        template <std::size_t... I>
+        void load_fields(Cell &cell, sycl::id<2> id, std::index_sequence<I...>) const {
+            ((cell.*std::get<I>(field_pointers) = std::get<I>(accessors)[id]), ...);
+        }
+
+        template <std::size_t... I>
+        void store_fields(Cell const &cell, sycl::id<2> id, std::index_sequence<I...>) const {
+            ((std::get<I>(accessors)[id] = cell.*std::get<I>(field_pointers)), ...);
+        }
+
+        std::tuple<sycl::accessor<FieldType<fields>, 2, access_mode>...> accessors;
+    };
+
+    /**
+     * \brief Return the width, or number of columns, of the grid.
+     */
+    uindex_t get_grid_width() const { return get_range()[0]; }
+
+    /**
+     * \brief Return the height, or number of rows, of the grid.
+     */
+    uindex_t get_grid_height() const { return get_range()[1]; }
+
+    /**
+     * \brief Create an new, uninitialized grid with the same size as the current one.
+     */
+    SoAGrid make_similar() const { return SoAGrid(get_range()); }
+
+    /**
+     * \brief Return the buffer that stores the given field.
+     *
+     * \tparam field The pointer to the data member of the field.
+     */
+    template <auto field> sycl::buffer<FieldType<field>, 2> &get_field_buffer() {
+        constexpr std::size_t index = field_index<field>();
+        static_assert(index < n_fields, "The field is not stored in the grid.");
+        return std::get<index>(buffers);
+    }
+
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     *
+     * Copies of a grid share the same underlying data. This method is used by the \ref
+     * stencil::GridPool to find grids that aren't referenced anywhere else and can therefore be
+     * reused.
+     */
+    long get_n_references() const { return references.use_count(); }
+
+  private:
+    sycl::range<2> get_range() const { return std::get<0>(buffers).get_range(); }
+
+    template <auto field> static constexpr std::size_t field_index() {
+        constexpr std::array<bool, n_fields> matches = {is_same_field<field, fields>()...};
+        for (std::size_t i = 0; i < n_fields; i++) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+        return n_fields;
+    }
+
+    template <auto a, auto b> static constexpr bool is_same_field() {
+        if constexpr (std::is_same_v<decltype(a), decltype(b)>) {
+            return a == b;
+        } else {
+            return false;
+        }
+    }
+
+    template <std::size_t... I>
+    void gather(std::vector<Cell> &cells, std::index_sequence<I...>) {
+        (gather_field<I>(cells), ...);
+    }
+
+    template <std::size_t I> void gather_field(std::vector<Cell> &cells) {
+        sycl::host_accessor ac(std::get<I>(buffers), sycl::read_only);
+        FieldType<std::get<I>(field_pointers)> const *values = ac.get_pointer();
+        for (std::size_t i = 0; i < cells.size(); i++) {
+            cells[i].*std::get<I>(field_pointers) = values[i];
+        }
+    }
+
+    template <std::size_t... I>
+    void scatter(std::vector<Cell> const &cells, std::index_sequence<I...>) {
+        (scatter_field<I>(cells), ...);
+    }
+
+    template <std::size_t I> void scatter_field(std::vector<Cell> const &cells) {
+        sycl::host_accessor ac(std::get<I>(buffers), sycl::write_only);
+        FieldType<std::get<I>(field_pointers)> *values = ac.get_pointer();
+        for (std::size_t i = 0; i < cells.size(); i++) {
+            values[i] = cells[i].*std::get<I>(field_pointers);
+        }
+    }
+
+    std::tuple<sycl::buffer<FieldType<fields>, 2>...> buffers;
+
+    // Only used to count the references to the grid data, see get_n_references().
+    std::shared_ptr<char> references = std::make_shared<char>();
+};
+
+} // namespace cpu
+} // namespace stencil
@@ -21,10 +21,31 @@
  * SOFTWARE.
  */
 #pragma once
+#include "../BoundaryCondition.hpp"
 #include "../Concepts.hpp"
+#include "../GridPool.hpp"
+#include "../Helpers.hpp"
+#include "../Reduction.hpp"
+#include "../StaticValues.hpp"
 #include "../Stencil.hpp"
 #include "Grid.hpp"
+#include "SoAGrid.hpp"
+#include "USMGrid.hpp"
+#include <algorithm>
+#include <cctype>
 #include <chrono>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace stencil {
 namespace cpu {
@@ -35,15 +56,88 @@ namespace cpu {
  * This updater applies an iterative stencil code, defined by the template parameter `F`, to the
  * grid; As often as requested.
  *
- * \tparam F The transition function to apply to input grids.
+ * The grid is partitioned into tiles with the size of \ref Params::tile_range, and every tile is
+ * processed by one work-group. Each work-group first loads its tile together with the surrounding
+ * halo into local memory and then serves the stencils of its work-items from there. This way,
+ * every cell is only read once from global memory per work-group and the halo checks are only
+ * evaluated while loading.
+ *
+ * The updater also supports temporal blocking: With \ref Params::temporal_block set to `n`, every
+ * work-group loads a halo that is wide enough to compute `n` iterations (including all
+ * sub-iterations) of its tile without going back to global memory. The halo is then recomputed
+ * redundantly by neighbouring work-groups, which is similar to the halo of the tiling FPGA
+ * backend.
+ *
+ * Work-groups whose tiles and halos lie completely within the grid are launched as a separate
+ * kernel that is compiled without any bounds checks, which allows the compiler to vectorize it.
+ * Only the thin strips of work-groups along the grid borders evaluate the halo conditions.
+ *
+ * If the transition function uses static values, the static grid has to be set with \ref
+ * set_static_grid before the first update. The static values are loaded into local memory together
+ * with the cells, but they are never written back.
+ *
+ * If the transition function defines a reduction and \ref Params::reduction is set, the updated
+ * grid is reduced by an additional kernel after the last iteration. Every work-item of this kernel
+ * reduces one column, and the partial results of the columns are combined on the host when \ref
+ * get_reduction_result is called.
+ *
+ * The best tile shape and temporal block depend on the cell size, the stencil radius and the
+ * cache hierarchy of the device. With \ref Params::auto_tune set, the updater benchmarks a small
+ * set of candidate configurations on the first call for every grid shape and then uses the
+ * fastest one. The results may be stored in a file, see \ref Params::tuning_cache_path, so that
+ * later runs of the application can skip the benchmark.
+ *
+ * On GPUs, the neighbouring cells within a column can be exchanged with sub-group shuffles
+ * instead of local memory loads by setting `sub_group_size`. Every work-item then loads only the
+ * cell in its own row from local memory and receives the other rows of its stencil from the
+ * work-items of its sub-group. Only the work-items at the edges of a sub-group load the remaining
+ * cells from local memory. The \ref gpu::StencilUpdate uses this by default.
+ *
+ * \tparam F The transition function to apply to input grids. Transition functions with a history
+ * have to be wrapped in a \ref stencil::HistoryTransitionFunction.
+ *
+ * \tparam tile_width (Optimization parameter) The default width of a tile that is processed by
+ * one work-group, see \ref Params::tile_range. The product of `tile_width` and `tile_height` is the
+ * size of a work-group and must therefore not exceed the maximal work-group size of the used
+ * device.
+ *
+ * \tparam tile_height (Optimization parameter) The default height of a tile that is processed by
+ * one work-group.
+ *
+ * \tparam G The grid type to operate on. It must provide a `DeviceAccessor` class template like
+ * \ref Grid and \ref SoAGrid do. Use \ref SoAGrid to store every field of the cells in its own
+ * buffer, or \ref USMGrid to control the transfers between the host and the device explicitly.
+ *
+ * \tparam sub_group_size (Optimization parameter) The required sub-group size of the kernels, or
+ * zero to disable sub-group shuffles. If it's not zero, the height of all tiles has to be a
+ * multiple of it, so that every sub-group lies within one column of a tile.
  */
-template <concepts::TransitionFunction F> class StencilUpdate {
+template <concepts::TransitionFunction F, uindex_t tile_width = 16, uindex_t tile_height = 16,
+          concepts::Grid<typename F::Cell> G = Grid<typename F::Cell>, uindex_t sub_group_size = 0>
+    requires(tile_width >= 1 && tile_height >= 1 &&
+             (sub_group_size == 0 || tile_height % sub_group_size == 0) && !has_history<F>)
+class StencilUpdate {
   private:
     using Cell = F::Cell;
+    using KernelFunction =
+        std::conditional_t<has_static_values<F>, StaticValueTransitionFunction<F>, F>;
+    using KernelCell = typename KernelFunction::Cell;
+
+    /**
+     * \brief The boundary condition of the transition function.
+     *
+     * All boundary conditions are only evaluated by the kernels along the grid borders. With \ref
+     * BoundaryCondition::Periodic "periodic" boundaries, the cells in the halos of the border tiles
+     * are read from the opposite side of the grid and updated along with the grid.
+     */
+    static constexpr BoundaryCondition boundary_condition = boundary_condition_of<F>;
 
   public:
     /// \brief Shorthand for the used and supported grid type.
-    using GridImpl = Grid<Cell>;
+    using GridImpl = G;
+
+    /// \brief Shorthand for the grid type of the static values.
+    using StaticGridImpl = Grid<StaticValueOf<F>>;
 
     /**
      * \brief Parameters for the stencil updater.
@@ -58,6 +152,9 @@ template <concepts::TransitionFunction F> class StencilUpdate {
 
         /**
          *  \brief The cell value to present for cells outside of the grid.
+         *
+         * This is only used with the \ref BoundaryCondition::Constant "constant" boundary
+         * condition.
          */
         Cell halo_value = Cell();
 
@@ -89,42 +186,178 @@ template <concepts::TransitionFunction F> class StencilUpdate {
          * it can actually provide you access to the data.
          */
         bool blocking = false;
+
+        /**
+         * \brief The number of iterations to compute in one kernel launch.
+         *
+         * Every work-group will compute this many iterations, including all sub-iterations, while
+         * the tile stays in local memory. Increasing this value reduces the number of kernel
+         * launches and sweeps through global memory, but it also increases the redundant work in
+         * the tile halos as well as the required local memory. It must be at least 1.
+         */
+        uindex_t temporal_block = 1;
+
+        /**
+         * \brief Allow the updater to overwrite the source grid.
+         *
+         * By default, the updater leaves the source grid untouched and uses two additional grids
+         * for its double buffering scheme. If this option is set to true, the source grid is used
+         * as one of these two buffers instead, which reduces the required memory from three to two
+         * times the grid size. The contents of the source grid are undefined afterwards, unless it
+         * is returned as the result.
+         */
+        bool overwrite_source = false;
+
+        /**
+         * \brief The reduction to evaluate on the updated grid.
+         *
+         * If the transition function defines a reduction and this field is set, the cells of the
+         * returned grid are reduced on the device after the last iteration. The result is
+         * available via \ref StencilUpdate::get_reduction_result. No reduction is evaluated if no
+         * iterations are computed.
+         */
+        std::optional<ReductionOf<F>> reduction = std::nullopt;
+
+        /**
+         * \brief The contents of the constant table of the transition function.
+         *
+         * This is only used if the transition function defines a \ref stencil::ConstantTable
+         * "constant table". The table is passed to the kernels once and shared by all work-items.
+         */
+        ConstantTableOf<F> constant_table = ConstantTableOf<F>();
+
+        /**
+         * \brief The width and height of the tiles that are processed by one work-group.
+         *
+         * The product of both is the size of a work-group and must not exceed the maximal
+         * work-group size of the used device. If sub-group shuffles are enabled, the height has
+         * to be a multiple of the sub-group size.
+         */
+        sycl::range<2> tile_range = sycl::range<2>(tile_width, tile_height);
+
+        /**
+         * \brief Choose the tile range and the temporal block automatically.
+         *
+         * If this is set, the first call for every grid shape benchmarks the candidates of \ref
+         * get_tuning_candidates on a copy of the source grid and overwrites \ref tile_range and
+         * \ref temporal_block with the fastest configuration. The time spent on the benchmark is
+         * not included in the statistics of the updater.
+         */
+        bool auto_tune = false;
+
+        /**
+         * \brief The path of a file that stores the results of the auto-tuner.
+         *
+         * If this is set together with \ref auto_tune, the fastest configurations are looked up
+         * in and added to this file, keyed by the cell type, the stencil radius, the number of
+         * sub-iterations and the grid shape. A missing file is treated as empty.
+         */
+        std::optional<std::string> tuning_cache_path = std::nullopt;
+    };
+
+    /**
+     * \brief A configuration of the kernels that is chosen by the auto-tuner.
+     */
+    struct TuningConfiguration {
+        /// \brief The width and height of a tile, see \ref Params::tile_range.
+        sycl::range<2> tile_range;
+
+        /// \brief The number of iterations per kernel launch, see \ref Params::temporal_block.
+        uindex_t temporal_block;
     };
 
     /**
      * \brief Create a new stencil updater object.
      */
-    StencilUpdate(Params params) : params(params), n_processed_cells(0), walltime(0.0) {}
+    StencilUpdate(Params params)
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          static_grid(std::nullopt), kernel_queue(std::nullopt), n_processed_cells(0),
+          walltime(0.0), reduction_result(std::nullopt), tuned_configurations() {}
 
     /**
      * \brief Compute a new grid based on the source grid, using the configured transition function.
      *
-     * The computation does not work in-place. Instead, it will allocate two additional grids with
-     * the same size as the source grid and use them for a double buffering scheme. Therefore, you
-     * are free to reuse the source grid as it will not be altered.
+     * The computation does not work in-place. Instead, it will request two additional grids with
+     * the same size as the source grid from the grid pool and use them for a double buffering
+     * scheme. Therefore, you are free to reuse the source grid as it will not be altered. If \ref
+     * Params::overwrite_source is true, the source grid is used as one of the buffers instead and
+     * only one additional grid is requested.
      *
      * If \ref Params::blocking is set to true, this method will block until the computation is
      * complete. Otherwise, it will return as soon as all kernels are submitted.
+     *
+     * \throws std::invalid_argument The transition function uses static values, but no static
+     * grid has been set.
+     *
+     * \throws std::invalid_argument The temporal block or the tile range is empty, or the tile
+     * height is not a multiple of the sub-group size.
+     *
+     * \throws std::invalid_argument The transition function reflects the grid at its borders, but
+     * the grid is narrower or lower than the stencil radius.
+     *
+     * \throws std::range_error The static grid doesn't have the same size as the source grid.
+     *
+     * \throws std::runtime_error The tuning cache file could not be written.
      */
     GridImpl operator()(GridImpl &source_grid) {
-        GridImpl swap_grid_a = source_grid.make_similar();
-        GridImpl swap_grid_b = source_grid.make_similar();
+        if (params.temporal_block == 0) {
+            throw std::invalid_argument("The temporal block must contain at least one iteration.");
+        }
+        if (params.tile_range[0] == 0 || params.tile_range[1] == 0) {
+            throw std::invalid_argument("The tiles must contain at least one cell.");
+        }
+        if (sub_group_size != 0 && params.tile_range[1] % sub_group_size != 0) {
+            throw std::invalid_argument(
+                "The height of the tiles must be a multiple of the sub-group size.");
+        }
+        if (boundary_condition == BoundaryCondition::Reflect &&
+            std::min(source_grid.get_grid_width(), source_grid.get_grid_height()) <
+                F::stencil_radius) {
+            throw std::invalid_argument(
+                "Reflected grids must be at least as wide and high as the stencil radius.");
+        }
+        if constexpr (has_static_values<F>) {
+            if (!static_grid.has_value()) {
+                throw std::invalid_argument("The transition function uses static values, but no "
+                                            "static grid has been set.");
+            }
+            if (static_grid->get_grid_width() != source_grid.get_grid_width() ||
+                static_grid->get_grid_height() != source_grid.get_grid_height()) {
+                throw std::range_error("The static grid and the source grid differ in size.");
+            }
+        }
+
+        if (params.auto_tune) {
+            TuningConfiguration configuration = get_tuned_configuration(source_grid);
+            params.tile_range = configuration.tile_range;
+            params.temporal_block = configuration.temporal_block;
+        }
+
+        GridImpl swap_grid_a =
+            params.overwrite_source ? source_grid : grid_pool->acquire(source_grid);
+        GridImpl swap_grid_b = grid_pool->acquire(source_grid);
         GridImpl *pass_source = &source_grid;
         GridImpl *pass_target = &swap_grid_b;
 
-        sycl::queue queue(params.device);
+        sycl::queue queue = get_queue();
         auto walltime_start = std::chrono::high_resolution_clock::now();
 
-        for (uindex_t i_iter = 0; i_iter < params.n_iterations; i_iter++) {
-            for (uindex_t i_subiter = 0; i_subiter < F::n_subiterations; i_subiter++) {
-                run_iter(queue, pass_source, pass_target, params.iteration_offset + i_iter,
-                         i_subiter);
-                if (i_iter == 0 && i_subiter == 0) {
-                    pass_source = &swap_grid_b;
-                    pass_target = &swap_grid_a;
-                } else {
-                    std::swap(pass_source, pass_target);
-                }
+        for (uindex_t i_iter = 0; i_iter < params.n_iterations; i_iter += params.temporal_block) {
+            uindex_t n_block_iters = std::min(params.temporal_block, params.n_iterations - i_iter);
+            run_block(queue, pass_source, pass_target, get_static_grid_ptr(),
+                      params.iteration_offset + i_iter, n_block_iters);
+            if (i_iter == 0) {
+                pass_source = &swap_grid_b;
+                pass_target = &swap_grid_a;
+            } else {
+                std::swap(pass_source, pass_target);
+            }
+        }
+
+        reduction_result = std::nullopt;
+        if constexpr (has_reduction<F>) {
+            if (params.reduction.has_value() && params.n_iterations > 0) {
+                submit_reduction(queue, *pass_source);
             }
         }
 
@@ -148,6 +381,84 @@ template <concepts::TransitionFunction F> class StencilUpdate {
      */
     Params &get_params() { return params; }
 
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the grid of static values, if one has been set.
+     */
+    std::optional<StaticGridImpl> get_static_grid() const { return static_grid; }
+
+    /**
+     * \brief Set the grid of static values.
+     *
+     * Every cell of the source grid receives the static value at the same position of this grid
+     * as `stencil.static_value`. The static grid is only read and therefore may be used for
+     * multiple updates and updaters. It must have the same size as the grids it's used with.
+     */
+    void set_static_grid(StaticGridImpl static_grid)
+        requires(has_static_values<F>)
+    {
+        this->static_grid = static_grid;
+    }
+
+    /**
+     * \brief Prepare the updater for timed computations.
+     *
+     * This method creates the queue of the updater and computes one iteration of a small grid
+     * that contains interior as well as border tiles. This forces the just-in-time compilation of
+     * all kernels, so that it doesn't distort the measurements of later calls to \ref
+     * operator()(). The accumulated statistics of the updater are not affected and this method
+     * blocks until the computation is complete.
+     */
+    void warm_up() {
+        uindex_t halo_radius = F::n_subiterations * F::stencil_radius;
+        uindex_t tile_c = params.tile_range[0];
+        uindex_t tile_r = params.tile_range[1];
+        uindex_t grid_width = (n_cells_to_n_words(halo_radius, tile_c) + 1) * tile_c + halo_radius;
+        uindex_t grid_height = (n_cells_to_n_words(halo_radius, tile_r) + 1) * tile_r + halo_radius;
+        GridImpl grid(grid_width, grid_height);
+        {
+            typename GridImpl::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+            for (uindex_t c = 0; c < grid_width; c++) {
+                for (uindex_t r = 0; r < grid_height; r++) {
+                    ac[c][r] = params.halo_value;
+                }
+            }
+        }
+
+        // The target grid is kept in the pool, so that repeated warm-ups don't allocate it again.
+        GridImpl target_grid = grid_pool->acquire(grid);
+        std::optional<StaticGridImpl> warm_up_static_grid = std::nullopt;
+        if constexpr (has_static_values<F>) {
+            warm_up_static_grid = StaticGridImpl(grid_width, grid_height);
+            typename StaticGridImpl::template GridAccessor<sycl::access::mode::read_write> ac(
+                *warm_up_static_grid);
+            for (uindex_t c = 0; c < grid_width; c++) {
+                for (uindex_t r = 0; r < grid_height; r++) {
+                    ac[c][r] = StaticValueOf<F>();
+                }
+            }
+        }
+        StaticGridImpl *static_grid_ptr =
+            warm_up_static_grid.has_value() ? &warm_up_static_grid.value() : nullptr;
+
+        sycl::queue queue = get_queue();
+        run_block(queue, &grid, &target_grid, static_grid_ptr, params.iteration_offset, 1);
+        queue.wait();
+    }
+
     /**
      * \brief Return the accumulated total number of cells processed by this updater.
      *
@@ -165,12 +476,405 @@ template <concepts::TransitionFunction F> class StencilUpdate {
      */
     double get_walltime() const { return walltime; }
 
+    /**
+     * \brief Return the result of the reduction of the grid returned by the last call to \ref
+     * operator()().
+     *
+     * This method blocks until the reduction is complete. If the last call didn't evaluate a
+     * reduction, since \ref Params::reduction wasn't set or no iterations were computed, nothing is
+     * returned.
+     */
+    auto get_reduction_result()
+        requires(has_reduction<F>)
+    {
+        using Value = typename ReductionOf<F>::Value;
+        return reduction_result.has_value() ? std::optional<Value>(reduction_result->get())
+                                            : std::optional<Value>();
+    }
+
+    /**
+     * \brief Return the pending reduction of the grid returned by the last call to \ref
+     * operator()(), without waiting for it.
+     *
+     * \ref stencil::run_until uses this to check the reduction of one interval while the next
+     * interval is computed. Nothing is returned if the last call didn't evaluate a reduction.
+     */
+    std::optional<ReductionResult<Cell, ReductionOf<F>>> get_pending_reduction_result() const
+        requires(has_reduction<F>)
+    {
+        return reduction_result;
+    }
+
+    /**
+     * \brief Replace the pending reduction that \ref get_reduction_result returns.
+     *
+     * \ref stencil::run_until uses this to drop the reduction of its speculative interval.
+     */
+    void set_pending_reduction_result(std::optional<ReductionResult<Cell, ReductionOf<F>>> result)
+        requires(has_reduction<F>)
+    {
+        reduction_result = result;
+    }
+
+    /**
+     * \brief Return the configurations that the auto-tuner benchmarks on the current device.
+     *
+     * The tile ranges are the default range of the template parameters and a few square and
+     * rectangular ranges between 8 and 32 cells wide, limited by the maximal work-group size. If
+     * sub-group shuffles are enabled, only tile ranges whose height is a multiple of the sub-group
+     * size are used.
+     * Every tile range is combined with temporal blocks of 1, 2, 4 and 8 iterations, as long as
+     * the tile and its halo fit into local memory.
+     */
+    std::vector<TuningConfiguration> get_tuning_candidates() {
+        sycl::device device = get_queue().get_device();
+        std::size_t max_work_group_size =
+            device.get_info<sycl::info::device::max_work_group_size>();
+        std::size_t local_mem_size = device.get_info<sycl::info::device::local_mem_size>();
+
+        std::vector<sycl::range<2>> tile_ranges{{tile_width, tile_height}, {8, 8},  {16, 16},
+                                                {32, 8},                  {8, 32}, {32, 32}};
+        std::vector<TuningConfiguration> candidates;
+        for (uindex_t i_range = 0; i_range < tile_ranges.size(); i_range++) {
+            sycl::range<2> tile_range = tile_ranges[i_range];
+            bool is_duplicate =
+                std::find(tile_ranges.begin(), tile_ranges.begin() + i_range, tile_range) !=
+                tile_ranges.begin() + i_range;
+            bool fits_sub_groups = sub_group_size == 0 || tile_range[1] % sub_group_size == 0;
+            if (is_duplicate || !fits_sub_groups || tile_range.size() > max_work_group_size) {
+                continue;
+            }
+            for (uindex_t temporal_block : {1, 2, 4, 8}) {
+                if (calc_local_mem_usage(tile_range, temporal_block) <= local_mem_size) {
+                    candidates.push_back(TuningConfiguration{tile_range, temporal_block});
+                }
+            }
+        }
+        return candidates;
+    }
+
+    /**
+     * \brief Return the configurations that the auto-tuner has chosen so far, keyed by the
+     * tuning key of the grid shape.
+     */
+    std::map<std::string, TuningConfiguration> const &get_tuned_configurations() const {
+        return tuned_configurations;
+    }
+
+    /**
+     * \brief Return the key under which the tuned configuration for a grid shape is stored.
+     *
+     * The key contains the name of the device, the name and the size of the cell type, the
+     * stencil radius, the number of sub-iterations and the grid shape. Since the fastest
+     * configuration depends on the device, results of one device are never used for another. The
+     * key doesn't contain any whitespace; whitespace in the device name is replaced with
+     * underscores.
+     */
+    static std::string get_tuning_key(sycl::device const &device, uindex_t grid_width,
+                                      uindex_t grid_height) {
+        std::string device_name = device.get_info<sycl::info::device::name>();
+        for (char &c : device_name) {
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                c = '_';
+            }
+        }
+
+        std::stringstream key;
+        key << device_name << "/" << typeid(Cell).name() << "/" << sizeof(Cell) << "/r"
+            << F::stencil_radius << "/s" << F::n_subiterations << "/" << grid_width << "x"
+            << grid_height;
+        return key.str();
+    }
+
   private:
+    /// \brief The number of iterations the auto-tuner computes for every candidate.
+    static constexpr uindex_t n_tuning_iterations = 8;
+
     /**
-     * \brief Update the source grid by one iteration.
+     * \brief Return the number of bytes of local memory the kernels require for a configuration.
+     */
+    static std::size_t calc_local_mem_usage(sycl::range<2> tile_range, uindex_t temporal_block) {
+        uindex_t halo_radius = temporal_block * F::n_subiterations * F::stencil_radius;
+        std::size_t cache_width = tile_range[0] + 2 * halo_radius;
+        std::size_t cache_height = tile_range[1] + 2 * halo_radius;
+        return 2 * cache_width * cache_height * sizeof(KernelCell);
+    }
+
+    /**
+     * \brief Return the tuned configuration for the shape of the grid.
      *
-     * This method will read the current state of the grid from the pass source and write the update
-     * the pass target.
+     * The configuration is taken from the configurations of previous calls, from the tuning cache
+     * file or, if neither knows the grid shape, from a new benchmark of all candidates. New
+     * results are added to the tuning cache file.
+     */
+    TuningConfiguration get_tuned_configuration(GridImpl &source_grid) {
+        std::string key = get_tuning_key(params.device, source_grid.get_grid_width(),
+                                         source_grid.get_grid_height());
+        if (auto it = tuned_configurations.find(key); it != tuned_configurations.end()) {
+            return it->second;
+        }
+
+        std::optional<TuningConfiguration> configuration = std::nullopt;
+        if (params.tuning_cache_path.has_value()) {
+            configuration = load_tuned_configuration(*params.tuning_cache_path, key);
+        }
+        if (!configuration.has_value()) {
+            configuration = tune(source_grid);
+            if (params.tuning_cache_path.has_value()) {
+                store_tuned_configuration(*params.tuning_cache_path, key, *configuration);
+            }
+        }
+        tuned_configurations[key] = *configuration;
+        return *configuration;
+    }
+
+    /**
+     * \brief Benchmark all tuning candidates on a copy of the source grid and return the fastest.
+     *
+     * Every candidate computes \ref n_tuning_iterations iterations and is timed from the first
+     * submission until its completion. Before that, one iteration is computed untimed to exclude
+     * the just-in-time compilation of the kernels. The source grid is not altered.
+     */
+    TuningConfiguration tune(GridImpl &source_grid) {
+        std::vector<TuningConfiguration> candidates = get_tuning_candidates();
+        if (candidates.empty()) {
+            return TuningConfiguration{params.tile_range, params.temporal_block};
+        }
+
+        // Only the tile range is modified, but it has to be restored even if a candidate fails.
+        RestoreGuard params_guard(params);
+        GridImpl grid_a = grid_pool->acquire(source_grid);
+        GridImpl grid_b = grid_pool->acquire(source_grid);
+        sycl::queue queue = get_queue();
+        auto run_candidate = [&](TuningConfiguration const &candidate, uindex_t n_iterations) {
+            params.tile_range = candidate.tile_range;
+            GridImpl *pass_source = &source_grid;
+            GridImpl *pass_target = &grid_a;
+            for (uindex_t i_iter = 0; i_iter < n_iterations; i_iter += candidate.temporal_block) {
+                uindex_t n_block_iters = std::min(candidate.temporal_block, n_iterations - i_iter);
+                run_block(queue, pass_source, pass_target, get_static_grid_ptr(),
+                          params.iteration_offset + i_iter, n_block_iters);
+                pass_source = pass_target;
+                pass_target = (pass_target == &grid_a) ? &grid_b : &grid_a;
+            }
+            queue.wait();
+        };
+
+        run_candidate(candidates[0], 1);
+
+        TuningConfiguration best_candidate = candidates[0];
+        double best_runtime = std::numeric_limits<double>::infinity();
+        for (TuningConfiguration const &candidate : candidates) {
+            auto start = std::chrono::high_resolution_clock::now();
+            run_candidate(candidate, n_tuning_iterations);
+            std::chrono::duration<double> runtime =
+                std::chrono::high_resolution_clock::now() - start;
+            if (runtime.count() < best_runtime) {
+                best_candidate = candidate;
+                best_runtime = runtime.count();
+            }
+        }
+
+        return best_candidate;
+    }
+
+    /**
+     * \brief Look up the configuration with the given key in the tuning cache file.
+     *
+     * Every line of the file contains a key, the tile width and height and the temporal block,
+     * separated by spaces. Lines that can't be parsed are ignored.
+     */
+    static std::optional<TuningConfiguration> load_tuned_configuration(std::string const &path,
+                                                                       std::string const &key) {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::stringstream line_stream(line);
+            std::string line_key;
+            uindex_t tile_c, tile_r, temporal_block;
+            if ((line_stream >> line_key >> tile_c >> tile_r >> temporal_block) &&
+                line_key == key && tile_c > 0 && tile_r > 0 && temporal_block > 0) {
+                return TuningConfiguration{sycl::range<2>(tile_c, tile_r), temporal_block};
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * \brief Add the configuration with the given key to the tuning cache file.
+     *
+     * Entries with the same key are replaced, all other lines are kept.
+     *
+     * \throws std::runtime_error The file could not be written.
+     */
+    static void store_tuned_configuration(std::string const &path, std::string const &key,
+                                          TuningConfiguration const &configuration) {
+        std::vector<std::string> lines;
+        {
+            std::ifstream in(path);
+            std::string line;
+            while (std::getline(in, line)) {
+                std::stringstream line_stream(line);
+                std::string line_key;
+                if (!(line_stream >> line_key) || line_key != key) {
+                    lines.push_back(line);
+                }
+            }
+        }
+
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open the tuning cache " + path + " for writing.");
+        }
+        for (std::string const &line : lines) {
+            out << line << "\n";
+        }
+        out << key << " " << configuration.tile_range[0] << " " << configuration.tile_range[1]
+            << " " << configuration.temporal_block << "\n";
+        if (!out.good()) {
+            throw std::runtime_error("Could not write the tuning cache " + path + ".");
+        }
+    }
+
+    /**
+     * \brief Return the queue of the updater.
+     *
+     * The queue is kept for the whole lifetime of the updater and is only rebuilt if \ref
+     * Params::device has changed since the last call.
+     */
+    sycl::queue get_queue() {
+        if (!kernel_queue.has_value() || kernel_queue->get_device() != params.device) {
+            kernel_queue = sycl::queue(params.device);
+        }
+        return *kernel_queue;
+    }
+
+    /**
+     * \brief Submit a kernel that reduces the grid with the requested reduction.
+     *
+     * Every work-item reduces one column of the grid and writes its value to a new partial result
+     * of \ref reduction_result.
+     */
+    void submit_reduction(sycl::queue queue, GridImpl &grid)
+        requires(has_reduction<F>)
+    {
+        using Value = typename ReductionOf<F>::Value;
+
+        reduction_result = ReductionResult<Cell, ReductionOf<F>>(*params.reduction);
+        sycl::buffer<Value, 1> partial_results =
+            reduction_result->add_partial_results(grid.get_grid_width());
+
+        sycl::event event = queue.submit([&](sycl::handler &cgh) {
+            typename GridImpl::template DeviceAccessor<sycl::access::mode::read> grid_ac(grid,
+                                                                                        cgh);
+            sycl::accessor partial_results_ac(partial_results, cgh, sycl::write_only);
+            ReductionOf<F> reduction = *params.reduction;
+            uindex_t grid_height = grid.get_grid_height();
+
+            cgh.parallel_for(sycl::range<1>(grid.get_grid_width()), [=](sycl::id<1> id) {
+                Value value = reduction.identity();
+                for (uindex_t r = 0; r < grid_height; r++) {
+                    Cell cell = grid_ac.load(sycl::id<2>(id[0], r));
+                    value = reduction.combine(value, reduction.map(cell));
+                }
+                partial_results_ac[id] = value;
+            });
+        });
+        record_event(grid, event);
+    }
+
+    /**
+     * \brief Report a kernel to a grid that tracks its own dependencies, like \ref USMGrid.
+     *
+     * Grids that are based on SYCL buffers don't need this, so nothing happens for them.
+     */
+    template <typename OtherGrid> static void record_event(OtherGrid &grid, sycl::event event) {
+        if constexpr (requires { grid.record_event(event); }) {
+            grid.record_event(event);
+        }
+    }
+
+    /**
+     * \brief Return a pointer to the static grid, or a null pointer if the feature is disabled.
+     */
+    StaticGridImpl *get_static_grid_ptr() {
+        return static_grid.has_value() ? &static_grid.value() : nullptr;
+    }
+
+    /**
+     * \brief Update the source grid by a block of iterations.
+     *
+     * This method will read the current state of the grid from the pass source, compute the
+     * requested number of iterations (including all sub-iterations) and write the result to the
+     * pass target.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param pass_source A pointer to a grid. The old state of the grid will be read from here.
+     *
+     * \param pass_target A pointer to a grid. The new state will be written to this grid.
+     *
+     * \param static_grid A pointer to the grid of static values. It's only used if the transition
+     * function uses static values.
+     *
+     * \param i_iter The index of the first iteration to compute.
+     *
+     * \param n_iters The number of iterations to compute.
+     *
+     * \throws std::range_error The tile and its halo don't fit into the local memory of the
+     * device.
+     */
+    void run_block(sycl::queue queue, GridImpl *pass_source, GridImpl *pass_target,
+                   StaticGridImpl *static_grid, uindex_t i_iter, uindex_t n_iters) {
+        uindex_t halo_radius = n_iters * F::n_subiterations * F::stencil_radius;
+        uindex_t tile_c = params.tile_range[0];
+        uindex_t tile_r = params.tile_range[1];
+
+        std::size_t local_mem_size =
+            queue.get_device().get_info<sycl::info::device::local_mem_size>();
+        if (calc_local_mem_usage(params.tile_range, n_iters) > local_mem_size) {
+            throw std::range_error(
+                "The tile and its halo do not fit into local memory. Try to reduce the temporal "
+                "block or the tile size.");
+        }
+
+        // Find the range of interior work-groups, whose tiles and halos lie completely within the
+        // grid. They are processed by a kernel without any bounds checks, and the remaining
+        // work-groups form the border strips around them.
+        uindex_t grid_width = pass_source->get_grid_width();
+        uindex_t grid_height = pass_source->get_grid_height();
+        uindex_t n_groups_c = n_cells_to_n_words(grid_width, tile_c);
+        uindex_t n_groups_r = n_cells_to_n_words(grid_height, tile_r);
+        auto interior_groups = [halo_radius](uindex_t grid_size, uindex_t tile_size,
+                                             uindex_t n_groups) {
+            uindex_t first = std::min(n_cells_to_n_words(halo_radius, tile_size), n_groups);
+            uindex_t last = (grid_size >= halo_radius) ? (grid_size - halo_radius) / tile_size : 0;
+            return std::pair<uindex_t, uindex_t>(first, std::max(first, last));
+        };
+        auto [interior_c_begin, interior_c_end] = interior_groups(grid_width, tile_c, n_groups_c);
+        auto [interior_r_begin, interior_r_end] = interior_groups(grid_height, tile_r, n_groups_r);
+
+        submit_tiles<false>(queue, pass_source, pass_target, static_grid, i_iter, n_iters,
+                            {interior_c_begin, interior_r_begin},
+                            {interior_c_end - interior_c_begin, interior_r_end - interior_r_begin});
+        submit_tiles<true>(queue, pass_source, pass_target, static_grid, i_iter, n_iters, {0, 0},
+                           {interior_c_begin, n_groups_r});
+        submit_tiles<true>(queue, pass_source, pass_target, static_grid, i_iter, n_iters,
+                           {interior_c_end, 0}, {n_groups_c - interior_c_end, n_groups_r});
+        submit_tiles<true>(queue, pass_source, pass_target, static_grid, i_iter, n_iters,
+                           {interior_c_begin, 0},
+                           {interior_c_end - interior_c_begin, interior_r_begin});
+        submit_tiles<true>(queue, pass_source, pass_target, static_grid, i_iter, n_iters,
+                           {interior_c_begin, interior_r_end},
+                           {interior_c_end - interior_c_begin, n_groups_r - interior_r_end});
+    }
+
+    /**
+     * \brief Submit a kernel that updates a rectangle of tiles by a block of iterations.
+     *
+     * \tparam check_bounds Whether the tiles or their halos may reach beyond the grid. If false,
+     * the kernel is compiled without any bounds checks or halo substitution, which allows the
+     * compiler to vectorize it.
      *
      * \param queue The queue to submit the kernel to.
      *
@@ -178,48 +882,250 @@ template <concepts::TransitionFunction F> class StencilUpdate {
      *
      * \param pass_target A pointer to a grid. The new state will be written to this grid.
      *
-     * \param i_iter The index of the iteration to compute.
+     * \param static_grid A pointer to the grid of static values. It's only used if the transition
+     * function uses static values.
      *
-     * \param i_subiter The index of the sub-iteration to compute.
+     * \param i_iter The index of the first iteration to compute.
+     *
+     * \param n_iters The number of iterations to compute.
+     *
+     * \param first_group The index of the first tile (or work-group) in the rectangle.
+     *
+     * \param n_groups The number of tiles in the rectangle. If it's empty, no kernel is submitted.
      */
-    void run_iter(sycl::queue queue, GridImpl *pass_source, GridImpl *pass_target, uindex_t i_iter,
-                  uindex_t i_subiter) {
+    template <bool check_bounds>
+    void submit_tiles(sycl::queue queue, GridImpl *pass_source, GridImpl *pass_target,
+                      StaticGridImpl *static_grid, uindex_t i_iter, uindex_t n_iters,
+                      sycl::id<2> first_group, sycl::range<2> n_groups) {
         using TDV = typename F::TimeDependentValue;
-        using StencilImpl = Stencil<Cell, F::stencil_radius, TDV>;
+        using ConstantTable = ConstantTableOf<F>;
+        using StencilImpl =
+            Stencil<KernelCell, F::stencil_radius, TDV, std::monostate, ConstantTable>;
+
+        if (n_groups.size() == 0) {
+            return;
+        }
+
+        uindex_t n_steps = n_iters * F::n_subiterations;
+        uindex_t halo_radius = n_steps * F::stencil_radius;
+        uindex_t tile_c = params.tile_range[0];
+        uindex_t tile_r = params.tile_range[1];
+        uindex_t cache_width = tile_c + 2 * halo_radius;
+        uindex_t cache_height = tile_r + 2 * halo_radius;
 
-        queue.submit([&](sycl::handler &cgh) {
-            sycl::accessor source_ac(pass_source->get_buffer(), cgh, sycl::read_only);
-            sycl::accessor target_ac(pass_target->get_buffer(), cgh, sycl::write_only);
-            index_t grid_width = source_ac.get_range()[0];
-            index_t grid_height = source_ac.get_range()[1];
+        sycl::event event = queue.submit([&](sycl::handler &cgh) {
+            typename GridImpl::template DeviceAccessor<sycl::access::mode::read> source_ac(
+                *pass_source, cgh);
+            typename GridImpl::template DeviceAccessor<sycl::access::mode::write> target_ac(
+                *pass_target, cgh);
+            auto static_ac = [&]() {
+                if constexpr (has_static_values<F>) {
+                    return typename StaticGridImpl::template DeviceAccessor<
+                        sycl::access::mode::read>(*static_grid, cgh);
+                } else {
+                    return std::monostate();
+                }
+            }();
+            index_t grid_width = pass_source->get_grid_width();
+            index_t grid_height = pass_source->get_grid_height();
             index_t stencil_radius = index_t(F::stencil_radius);
-            Cell halo_value = params.halo_value;
-            F transition_function = params.transition_function;
-            TDV tdv = transition_function.get_time_dependent_value(i_iter);
-
-            auto kernel = [=](sycl::id<2> id) {
-                StencilImpl stencil(ID(id[0], id[1]), UID(grid_width, grid_height), i_iter,
-                                    i_subiter, tdv);
-
-                for (index_t rel_c = -stencil_radius; rel_c <= stencil_radius; rel_c++) {
-                    for (index_t rel_r = -stencil_radius; rel_r <= stencil_radius; rel_r++) {
-                        index_t c = rel_c + id[0];
-                        index_t r = rel_r + id[1];
-                        bool within_grid = c >= 0 && r >= 0 && c < grid_width && r < grid_height;
-                        stencil[ID(rel_c, rel_r)] = (within_grid) ? source_ac[c][r] : halo_value;
+            KernelCell halo_value;
+            if constexpr (has_static_values<F>) {
+                halo_value = KernelCell{params.halo_value, StaticValueOf<F>()};
+            } else {
+                halo_value = params.halo_value;
+            }
+            KernelFunction transition_function(params.transition_function);
+            ConstantTable constant_table = params.constant_table;
+
+            // Two copies of the tile and its halo, used in a double buffering scheme.
+            sycl::local_accessor<KernelCell, 3> cache(sycl::range<3>(2, cache_width, cache_height),
+                                                      cgh);
+
+            sycl::range<2> local_range(tile_c, tile_r);
+            sycl::range<2> global_range(n_groups[0] * tile_c, n_groups[1] * tile_r);
+
+            auto load = [=](sycl::id<2> id) {
+                if constexpr (has_static_values<F>) {
+                    return KernelCell{source_ac.load(id), static_ac.load(id)};
+                } else {
+                    return source_ac.load(id);
+                }
+            };
+
+            auto kernel = [=](sycl::nd_item<2> item) {
+                index_t group_c = first_group[0] + item.get_group(0);
+                index_t group_r = first_group[1] + item.get_group(1);
+                index_t cache_c_offset = group_c * tile_c - index_t(halo_radius);
+                index_t cache_r_offset = group_r * tile_r - index_t(halo_radius);
+                sycl::sub_group sub_group = item.get_sub_group();
+                uindex_t lane = (sub_group_size != 0) ? sub_group.get_local_linear_id() : 0;
+                uindex_t n_lanes = sub_group.get_local_range()[0];
+
+                // Load the tile and its halo into local memory. Since the halo is wider than the
+                // work-group, some work-items have to load more than one cell.
+                for (uindex_t cache_c = item.get_local_id(0); cache_c < cache_width;
+                     cache_c += tile_c) {
+                    for (uindex_t cache_r = item.get_local_id(1); cache_r < cache_height;
+                         cache_r += tile_r) {
+                        index_t c = cache_c_offset + index_t(cache_c);
+                        index_t r = cache_r_offset + index_t(cache_r);
+                        if constexpr (check_bounds) {
+                            bool within_grid =
+                                c >= 0 && r >= 0 && c < grid_width && r < grid_height;
+                            if (within_grid || boundary_condition != BoundaryCondition::Constant) {
+                                cache[0][cache_c][cache_r] = load(sycl::id<2>(
+                                    apply_boundary_condition(boundary_condition, c, grid_width),
+                                    apply_boundary_condition(boundary_condition, r, grid_height)));
+                            } else {
+                                cache[0][cache_c][cache_r] = halo_value;
+                            }
+                        } else {
+                            cache[0][cache_c][cache_r] = load(sycl::id<2>(c, r));
+                        }
+                    }
+                }
+
+                sycl::group_barrier(item.get_group());
+
+                // With every step, the region of valid cells in the cache shrinks by the stencil
+                // radius. Cells outside the valid region are neither written nor read again.
+                for (uindex_t i_step = 0; i_step < n_steps; i_step++) {
+                    uindex_t iteration = i_iter + i_step / F::n_subiterations;
+                    uindex_t subiteration = i_step % F::n_subiterations;
+                    TDV tdv = transition_function.get_time_dependent_value(iteration);
+                    uindex_t step_source = i_step % 2;
+                    uindex_t step_target = (i_step + 1) % 2;
+                    uindex_t margin = (i_step + 1) * F::stencil_radius;
+
+                    for (uindex_t cache_c = margin + item.get_local_id(0);
+                         cache_c < cache_width - margin; cache_c += tile_c) {
+                        // With sub-group shuffles, all work-items of a sub-group have to take part
+                        // in every iteration. Therefore, the loop runs over the first rows of the
+                        // sub-groups and masks the work-items beyond the valid region.
+                        for (uindex_t first_r = margin + item.get_local_id(1) - lane;
+                             first_r < cache_height - margin; first_r += tile_r) {
+                            uindex_t cache_r = first_r + lane;
+                            bool active = cache_r < cache_height - margin;
+                            index_t c = cache_c_offset + index_t(cache_c);
+                            index_t r = cache_r_offset + index_t(cache_r);
+                            bool within_grid = !check_bounds || (c >= 0 && r >= 0 &&
+                                                                 c < grid_width && r < grid_height);
+                            // With periodic boundaries, the cells outside of the grid are copies
+                            // of cells within the grid and are therefore updated too.
+                            bool is_computed = within_grid ||
+                                               boundary_condition == BoundaryCondition::Periodic;
+                            if constexpr (sub_group_size == 0) {
+                                if (!is_computed) {
+                                    cache[step_target][cache_c][cache_r] = halo_value;
+                                    continue;
+                                }
+                            }
+                            if constexpr (check_bounds) {
+                                c = apply_boundary_condition(boundary_condition, c, grid_width);
+                                r = apply_boundary_condition(boundary_condition, r, grid_height);
+                            }
+
+                            StencilImpl stencil(ID(c, r), UID(grid_width, grid_height), iteration,
+                                                subiteration, tdv, std::monostate(),
+                                                &constant_table);
+                            for (uindex_t stencil_c = 0; stencil_c < StencilImpl::diameter;
+                                 stencil_c++) {
+                                // Clamped and reflected cells are read from other positions of the
+                                // same stencil.
+                                index_t offset_c = index_t(stencil_c) - stencil_radius;
+                                if constexpr (check_bounds) {
+                                    offset_c = remap_stencil_offset<boundary_condition>(
+                                        c, offset_c, grid_width);
+                                }
+                                uindex_t source_c = cache_c + offset_c;
+                                // Every work-item loads the cell in its own row once. The other
+                                // rows are exchanged within the sub-group, and only the
+                                // work-items at its edges load them from local memory.
+                                KernelCell own_cell;
+                                if constexpr (sub_group_size != 0) {
+                                    own_cell = cache[step_source][source_c]
+                                                    [std::min(cache_r, cache_height - 1)];
+                                }
+                                for (uindex_t stencil_r = 0; stencil_r < StencilImpl::diameter;
+                                     stencil_r++) {
+                                    // Cells outside of the stencil shape are never read, so they
+                                    // aren't loaded from local memory.
+                                    if (!stencil_shape_of<F>.contains(
+                                            index_t(stencil_c) - stencil_radius,
+                                            index_t(stencil_r) - stencil_radius)) {
+                                        stencil[UID(stencil_c, stencil_r)] = halo_value;
+                                        continue;
+                                    }
+                                    index_t offset_r = index_t(stencil_r) - stencil_radius;
+                                    if constexpr (check_bounds) {
+                                        offset_r = remap_stencil_offset<boundary_condition>(
+                                            r, offset_r, grid_height);
+                                    }
+                                    uindex_t source_r = cache_r + offset_r;
+                                    if constexpr (sub_group_size != 0) {
+                                        index_t source_lane = index_t(lane) + offset_r;
+                                        bool in_sub_group =
+                                            source_lane >= 0 && source_lane < index_t(n_lanes);
+                                        KernelCell cell = sycl::select_from_group(
+                                            sub_group, own_cell,
+                                            sycl::id<1>(std::clamp<index_t>(
+                                                source_lane, 0, index_t(n_lanes) - 1)));
+                                        if (!in_sub_group && active) {
+                                            cell = cache[step_source][source_c][source_r];
+                                        }
+                                        stencil[UID(stencil_c, stencil_r)] = cell;
+                                    } else {
+                                        stencil[UID(stencil_c, stencil_r)] =
+                                            cache[step_source][source_c][source_r];
+                                    }
+                                }
+                            }
+
+                            if (!active) {
+                                continue;
+                            }
+                            cache[step_target][cache_c][cache_r] =
+                                is_computed ? transition_function(stencil) : halo_value;
+                        }
                     }
+
+                    sycl::group_barrier(item.get_group());
                 }
 
-                target_ac[id] = transition_function(stencil);
+                index_t c = group_c * tile_c + item.get_local_id(0);
+                index_t r = group_r * tile_r + item.get_local_id(1);
+                if (!check_bounds || (c < grid_width && r < grid_height)) {
+                    KernelCell result = cache[n_steps % 2][item.get_local_id(0) + halo_radius]
+                                             [item.get_local_id(1) + halo_radius];
+                    if constexpr (has_static_values<F>) {
+                        target_ac.store(sycl::id<2>(c, r), result.cell);
+                    } else {
+                        target_ac.store(sycl::id<2>(c, r), result);
+                    }
+                }
             };
 
-            cgh.parallel_for(source_ac.get_range(), kernel);
+            if constexpr (sub_group_size != 0) {
+                auto sub_group_kernel = [=](sycl::nd_item<2> item)
+                    [[sycl::reqd_sub_group_size(sub_group_size)]] { kernel(item); };
+                cgh.parallel_for(sycl::nd_range<2>(global_range, local_range), sub_group_kernel);
+            } else {
+                cgh.parallel_for(sycl::nd_range<2>(global_range, local_range), kernel);
+            }
         });
+        record_event(*pass_source, event);
+        record_event(*pass_target, event);
     }
 
     Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<StaticGridImpl> static_grid;
+    std::optional<sycl::queue> kernel_queue;
     uindex_t n_processed_cells;
     double walltime;
+    std::optional<ReductionResult<Cell, ReductionOf<F>>> reduction_result;
+    std::map<std::string, TuningConfiguration> tuned_configurations;
 };
 } // namespace cpu
 } // namespace stencil
\ No newline at end of file
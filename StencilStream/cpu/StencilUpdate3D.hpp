@@ -0,0 +1,246 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../Concepts.hpp"
+#include "../Grid3D.hpp"
+#include "../GridPool.hpp"
+#include "../Stencil3D.hpp"
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace stencil {
+namespace cpu {
+
+/**
+ * \brief A grid updater that applies an iterative, three-dimensional stencil code to a grid.
+ *
+ * This is the three-dimensional sibling of \ref StencilUpdate. Every sub-iteration is computed by
+ * one kernel with one work-item per cell, which reads the stencil of its cell directly from the
+ * source grid. Cells outside of the grid are presented as the halo value.
+ *
+ * \tparam F The transition function to apply to input grids.
+ */
+template <concepts::TransitionFunction3D F> class StencilUpdate3D {
+  private:
+    using Cell = F::Cell;
+    using TDV = typename F::TimeDependentValue;
+    using StencilImpl = Stencil3D<Cell, F::stencil_radius, TDV>;
+
+  public:
+    /// \brief Shorthand for the used and supported grid type.
+    using GridImpl = Grid3D<Cell>;
+
+    /**
+     * \brief Parameters for the stencil updater.
+     */
+    struct Params {
+        /**
+         * \brief An instance of the transition function type.
+         *
+         * User applications may store runtime parameters here.
+         */
+        F transition_function;
+
+        /**
+         *  \brief The cell value to present for cells outside of the grid.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         *
+         * This offset will be added to the "actual" iteration index. This way, simulations can
+         * "resume" with the next timestep if the intermediate grid has been evaluated by the host.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The device to use for computations.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief Should the stencil updater block until completion, or return immediately after all
+         * kernels have been submitted.
+         */
+        bool blocking = false;
+    };
+
+    /**
+     * \brief Create a new stencil updater object.
+     */
+    StencilUpdate3D(Params params)
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          kernel_queue(std::nullopt), n_processed_cells(0), walltime(0.0) {}
+
+    /**
+     * \brief Compute a new grid based on the source grid, using the configured transition function.
+     *
+     * The computation does not work in-place. Instead, it requests two additional grids with the
+     * same size as the source grid from the grid pool and uses them for a double buffering scheme,
+     * so the source grid isn't altered. If no iterations are computed, the returned grid is a copy
+     * of the source grid.
+     *
+     * If \ref Params::blocking is set to true, this method will block until the computation is
+     * complete. Otherwise, it will return as soon as all kernels are submitted.
+     */
+    GridImpl operator()(GridImpl &source_grid) {
+        sycl::queue queue = get_queue();
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        GridImpl swap_grid_a = grid_pool->acquire(source_grid);
+        GridImpl swap_grid_b = grid_pool->acquire(source_grid);
+        GridImpl *pass_source = &source_grid;
+        GridImpl *pass_target = &swap_grid_b;
+        if (params.n_iterations == 0) {
+            swap_grid_b.submit_copy_from(queue, source_grid);
+            pass_source = &swap_grid_b;
+        }
+
+        uindex_t n_steps = params.n_iterations * F::n_subiterations;
+        for (uindex_t i_step = 0; i_step < n_steps; i_step++) {
+            submit_step(queue, pass_source, pass_target,
+                        params.iteration_offset + i_step / F::n_subiterations,
+                        i_step % F::n_subiterations);
+            if (i_step == 0) {
+                pass_source = &swap_grid_b;
+                pass_target = &swap_grid_a;
+            } else {
+                std::swap(pass_source, pass_target);
+            }
+        }
+
+        if (params.blocking) {
+            queue.wait();
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+        n_processed_cells += params.n_iterations * source_grid.get_grid_width() *
+                             source_grid.get_grid_height() * source_grid.get_grid_depth();
+
+        return *pass_source;
+    }
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the number of cells in the grid times the
+     * number of computed iterations.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     */
+    double get_walltime() const { return walltime; }
+
+  private:
+    /**
+     * \brief Return the queue of the updater.
+     *
+     * The queue is kept for the whole lifetime of the updater and is only rebuilt if \ref
+     * Params::device has changed since the last call.
+     */
+    sycl::queue get_queue() {
+        if (!kernel_queue.has_value() || kernel_queue->get_device() != params.device) {
+            kernel_queue = sycl::queue(params.device);
+        }
+        return *kernel_queue;
+    }
+
+    /**
+     * \brief Submit the kernel that computes one sub-iteration of the whole grid.
+     */
+    void submit_step(sycl::queue queue, GridImpl *pass_source, GridImpl *pass_target,
+                     uindex_t iteration, uindex_t subiteration) {
+        queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor source_ac(pass_source->get_buffer(), cgh, sycl::read_only);
+            sycl::accessor target_ac(pass_target->get_buffer(), cgh, sycl::write_only);
+            UID3D grid_range(pass_source->get_grid_width(), pass_source->get_grid_height(),
+                             pass_source->get_grid_depth());
+            index_t stencil_radius = index_t(F::stencil_radius);
+            Cell halo_value = params.halo_value;
+            F transition_function = params.transition_function;
+
+            cgh.parallel_for(source_ac.get_range(), [=](sycl::id<3> id) {
+                TDV tdv = transition_function.get_time_dependent_value(iteration);
+                ID3D cell_id(id[0], id[1], id[2]);
+                StencilImpl stencil(cell_id, grid_range, iteration, subiteration, tdv);
+
+                for (uindex_t stencil_c = 0; stencil_c < StencilImpl::diameter; stencil_c++) {
+                    for (uindex_t stencil_r = 0; stencil_r < StencilImpl::diameter; stencil_r++) {
+                        for (uindex_t stencil_l = 0; stencil_l < StencilImpl::diameter;
+                             stencil_l++) {
+                            index_t c = cell_id.c + index_t(stencil_c) - stencil_radius;
+                            index_t r = cell_id.r + index_t(stencil_r) - stencil_radius;
+                            index_t l = cell_id.l + index_t(stencil_l) - stencil_radius;
+                            bool within_grid = c >= 0 && r >= 0 && l >= 0 &&
+                                               c < index_t(grid_range.c) &&
+                                               r < index_t(grid_range.r) &&
+                                               l < index_t(grid_range.l);
+                            stencil[UID3D(stencil_c, stencil_r, stencil_l)] =
+                                within_grid ? source_ac[sycl::id<3>(c, r, l)] : halo_value;
+                        }
+                    }
+                }
+
+                target_ac[id] = transition_function(stencil);
+            });
+        });
+    }
+
+    Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<sycl::queue> kernel_queue;
+    uindex_t n_processed_cells;
+    double walltime;
+};
+} // namespace cpu
+} // namespace stencil
@@ -0,0 +1,485 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../AccessorSubscript.hpp"
+#include "../Index.hpp"
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+namespace stencil {
+namespace cpu {
+
+/**
+ * \brief A grid class for the CPU backend that stores cells in USM allocations.
+ *
+ * This grid fullfils the \ref stencil::concepts::Grid "Grid" concept just like \ref Grid, but
+ * instead of a SYCL buffer, it contains a device allocation with the cells and a pinned host
+ * allocation of the same size, the host staging area. Data is only moved between them by
+ * explicit transfers: \ref upload_async copies the staging area to the device and \ref
+ * download_async copies the device allocation to the staging area. Both return the event of the
+ * transfer, so that applications can overlap the initialization and the readback of some grids
+ * with computations on others, for example:
+ *
+ * ```
+ * std::span<Cell> cells = grid.get_host_span();
+ * // Fill the staging area ...
+ * grid.upload_async();
+ * Grid result = update(grid);
+ * sycl::event readback = result.download_async();
+ * // Prepare the next grid ...
+ * readback.wait();
+ * // Evaluate result.get_host_span() ...
+ * ```
+ *
+ * Since the SYCL runtime doesn't track the dependencies of USM allocations, the grid does it
+ * itself: Every transfer and every kernel that uses the grid waits for the previous one to
+ * complete. Kernels that use a \ref DeviceAccessor have to report their events with \ref
+ * record_event, like \ref StencilUpdate does.
+ *
+ * The \ref GridAccessor also works with the staging area: It downloads the cells when it's created
+ * and, if it's not read-only, uploads them again when it's destroyed. It is therefore slower than
+ * the explicit transfers, but convenient for tests and initialization code.
+ *
+ * \tparam Cell The cell type to store.
+ */
+template <typename Cell> class USMGrid {
+  public:
+    /**
+     * \brief The number of dimensions of the grid.
+     *
+     * May be changed in the future when other dimensions are supported.
+     */
+    static constexpr uindex_t dimensions = 2;
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param c The width, or number of columns, of the new grid.
+     *
+     * \param r The height, or number of rows, of the new grid.
+     *
+     * \param queue The queue to allocate the memory for and to submit the transfers to.
+     */
+    USMGrid(uindex_t c, uindex_t r, sycl::queue queue = sycl::queue())
+        : USMGrid(sycl::range<2>(c, r), queue) {}
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param range The range of the new grid. The first index will be the width and the second
+     * index will be the height of the grid.
+     *
+     * \param queue The queue to allocate the memory for and to submit the transfers to.
+     */
+    USMGrid(sycl::range<2> range, sycl::queue queue = sycl::queue())
+        : storage(std::make_shared<Storage>(range, queue)) {}
+
+    /**
+     * \brief Create a new grid with the same size and contents as the given SYCL buffer.
+     *
+     * The contents of the buffer will be copied to the grid by the host. The SYCL buffer can later
+     * be used elsewhere.
+     *
+     * \param other_buffer The buffer with the contents of the new grid.
+     */
+    USMGrid(sycl::buffer<Cell, 2> other_buffer) : USMGrid(other_buffer.get_range()) {
+        copy_from_buffer(other_buffer);
+    }
+
+    /**
+     * \brief Create a grid that uses the given USM allocations, without copying them.
+     *
+     * This allows applications to hand their own memory to a stencil update without a round trip
+     * through a SYCL buffer. The device allocation has to contain the cells column by column, like
+     * a SYCL buffer with the given range, and has to be accessible by the devices of the queue.
+     * The host allocation is used as the staging area and should be a pinned host allocation of
+     * the same size. The grid doesn't free the allocations, so they have to stay valid as long as
+     * the grid or one of its copies exists.
+     *
+     * \param device_data The device allocation with the cells of the new grid.
+     *
+     * \param host_data The host allocation to use as the staging area of the new grid.
+     *
+     * \param range The range of the new grid. The first index will be the width and the second
+     * index will be the height of the grid.
+     *
+     * \param queue The queue to submit the transfers to.
+     *
+     * \throws std::invalid_argument One of the allocations is a null pointer.
+     */
+    static USMGrid adopt(Cell *device_data, Cell *host_data, sycl::range<2> range,
+                         sycl::queue queue = sycl::queue()) {
+        if (device_data == nullptr || host_data == nullptr) {
+            throw std::invalid_argument("The adopted memory of a grid must not be null.");
+        }
+        return USMGrid(std::make_shared<Storage>(range, queue, device_data, host_data));
+    }
+
+    /**
+     * \brief Create a new reference to the given grid.
+     *
+     * The newly created grid object will point to the same underlying data as the referenced grid.
+     * Changes made via the newly created grid object will also be visible to the old grid object,
+     * and vice-versa.
+     *
+     * \param other_grid The other grid the new grid should reference.
+     */
+    USMGrid(USMGrid const &other_grid) : storage(other_grid.storage) {}
+
+    /**
+     * \brief Copy the contents of the SYCL buffer into the grid.
+     *
+     * The contents are copied to the staging area and uploaded to the device. This method blocks
+     * until the upload is complete. The buffer has to have the same size as the grid, otherwise a
+     * \ref std::range_error is thrown.
+     *
+     * \param other_buffer The buffer to copy the data from.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_from_buffer(sycl::buffer<Cell, 2> other_buffer) {
+        if (storage->range != other_buffer.get_range()) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+        wait();
+        sycl::host_accessor other_ac(other_buffer, sycl::read_only);
+        std::memcpy(storage->host_data, other_ac.get_pointer(), get_byte_size());
+        upload_async().wait();
+    }
+
+    /**
+     * \brief Copy the contents of the grid into the SYCL buffer.
+     *
+     * The contents are downloaded to the staging area first. This method blocks until the download
+     * is complete. The buffer has to have the same size as the grid, otherwise a \ref
+     * std::range_error is thrown.
+     *
+     * \param other_buffer The buffer to copy the data to.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_to_buffer(sycl::buffer<Cell, 2> other_buffer) {
+        if (storage->range != other_buffer.get_range()) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+        download_async().wait();
+        sycl::host_accessor other_ac(other_buffer, sycl::write_only);
+        std::memcpy(other_ac.get_pointer(), storage->host_data, get_byte_size());
+    }
+
+    /**
+     * \brief Submit a copy of the staging area to the device allocation.
+     *
+     * The copy starts after all previous transfers and kernels of the grid are complete. The
+     * staging area must not be modified until the returned event is complete.
+     *
+     * \returns The event of the transfer.
+     */
+    sycl::event upload_async() {
+        return submit_copy(storage->device_data, storage->host_data);
+    }
+
+    /**
+     * \brief Submit a copy of the device allocation to the staging area.
+     *
+     * The copy starts after all previous transfers and kernels of the grid are complete. The
+     * staging area contains the cells of the grid once the returned event is complete.
+     *
+     * \returns The event of the transfer.
+     */
+    sycl::event download_async() {
+        return submit_copy(storage->host_data, storage->device_data);
+    }
+
+    /**
+     * \brief Block until all transfers and kernels of the grid are complete.
+     */
+    void wait() {
+        if (storage->last_event.has_value()) {
+            storage->last_event->wait();
+        }
+    }
+
+    /**
+     * \brief Report a kernel that uses the grid.
+     *
+     * Later transfers and kernels of the grid will wait for this kernel to complete. The kernel
+     * itself has to wait for the previous ones, which the \ref DeviceAccessor ensures.
+     *
+     * \param event The event of the kernel.
+     */
+    void record_event(sycl::event event) { storage->last_event = event; }
+
+    /**
+     * \brief Return the pinned host staging area of the grid.
+     *
+     * The cells are stored in column-major order, i.e. the cell in column `c` and row `r` has the
+     * index `c * get_grid_height() + r`.
+     */
+    std::span<Cell> get_host_span() {
+        return std::span<Cell>(storage->host_data, storage->range.size());
+    }
+
+    /**
+     * \brief Return the device allocation of the grid, with the same layout as \ref
+     * get_host_span.
+     */
+    Cell *get_device_data() { return storage->device_data; }
+
+    /**
+     * \brief Return the queue that the grid submits its transfers to.
+     */
+    sycl::queue get_queue() const { return storage->queue; }
+
+    /**
+     * \brief An accessor for the grid.
+     *
+     * Instances of this class provide access to a grid, so that host code can read and write the
+     * contents of a grid. As such, it fullfils the \ref stencil::concepts::GridAccessor
+     * "GridAccessor" concept. The accessor works with the staging area of the grid, which it
+     * downloads when it's created and uploads again when it's destroyed, unless it's read-only.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode = sycl::access::mode::read_write> class GridAccessor {
+      public:
+        /**
+         * \brief The number of dimensions of the underlying grid.
+         */
+        static constexpr uindex_t dimensions = USMGrid::dimensions;
+
+        /**
+         * \brief Create a new accessor to the given grid.
+         */
+        GridAccessor(USMGrid &grid) : grid(grid) {
+            if constexpr (access_mode != sycl::access::mode::discard_write &&
+                          access_mode != sycl::access::mode::discard_read_write) {
+                grid.download_async().wait();
+            } else {
+                grid.wait();
+            }
+        }
+
+        GridAccessor(GridAccessor const &) = delete;
+        GridAccessor &operator=(GridAccessor const &) = delete;
+
+        /**
+         * \brief Upload the cells again, if the accessor isn't read-only.
+         */
+        ~GridAccessor() {
+            if constexpr (access_mode != sycl::access::mode::read) {
+                grid.upload_async().wait();
+            }
+        }
+
+        /**
+         * \brief Shorthand for the used subscript type.
+         */
+        using BaseSubscript = AccessorSubscript<Cell, GridAccessor, access_mode>;
+
+        /**
+         * \brief Access/Dereference the first dimension.
+         *
+         * This subscript operator is the first subscript in an expression like
+         * `accessor[i_column][i_row]`. It will return a \ref BaseSubscript object that handles
+         * subsequent dimensions.
+         */
+        BaseSubscript operator[](uindex_t i) { return BaseSubscript(*this, i); }
+
+        /**
+         * \brief Access a cell of the grid.
+         *
+         * \param id The index of the accessed cell. The first index is the column index, the second
+         * one is the row index. \returns A constant reference to the indexed cell.
+         */
+        Cell const &operator[](sycl::id<2> id)
+            requires(access_mode == sycl::access::mode::read)
+        {
+            return grid.get_host_span()[id[0] * grid.get_grid_height() + id[1]];
+        }
+
+        /**
+         * \brief Access a cell of the grid.
+         *
+         * \param id The index of the accessed cell. The first index is the column index, the second
+         * one is the row index. \returns A reference to the indexed cell.
+         */
+        Cell &operator[](sycl::id<2> id)
+            requires(access_mode != sycl::access::mode::read)
+        {
+            return grid.get_host_span()[id[0] * grid.get_grid_height() + id[1]];
+        }
+
+        /**
+         * \brief Return a view of all cells in the staging area, column by column.
+         */
+        auto get_cells() {
+            using CellRef =
+                std::conditional_t<access_mode == sycl::access::mode::read, Cell const, Cell>;
+            return std::span<CellRef>(grid.get_host_span());
+        }
+
+        /**
+         * \brief Return a view of the cells of a column in the staging area, from the first row to
+         * the last one.
+         *
+         * \param c The index of the column.
+         */
+        auto get_column(uindex_t c) {
+            uindex_t grid_height = grid.get_grid_height();
+            return get_cells().subspan(c * grid_height, grid_height);
+        }
+
+      private:
+        USMGrid &grid;
+    };
+
+    /**
+     * \brief A device accessor for the grid, to be used in kernels.
+     *
+     * This provides the same interface as the device accessor of \ref Grid. Since it wraps a
+     * plain pointer, creating it doesn't register any dependencies with the SYCL runtime. Instead,
+     * it lets the kernel wait for the previous transfers and kernels of the grid.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode> class DeviceAccessor {
+      public:
+        /**
+         * \brief Create a new device accessor to the given grid.
+         *
+         * \param grid The grid to access.
+         *
+         * \param cgh The command group handler of the kernel that uses the accessor.
+         */
+        DeviceAccessor(USMGrid &grid, sycl::handler &cgh)
+            : data(grid.get_device_data()), grid_height(grid.get_grid_height()) {
+            if (grid.storage->last_event.has_value()) {
+                cgh.depends_on(*grid.storage->last_event);
+            }
+        }
+
+        /**
+         * \brief Load the cell at the given position.
+         */
+        Cell load(sycl::id<2> id) const { return data[id[0] * grid_height + id[1]]; }
+
+        /**
+         * \brief Store the cell at the given position.
+         */
+        void store(sycl::id<2> id, Cell const &cell) const
+            requires(access_mode != sycl::access::mode::read)
+        {
+            data[id[0] * grid_height + id[1]] = cell;
+        }
+
+      private:
+        Cell *data;
+        uindex_t grid_height;
+    };
+
+    /**
+     * \brief Return the width, or number of columns, of the grid.
+     */
+    uindex_t get_grid_width() const { return storage->range[0]; }
+
+    /**
+     * \brief Return the height, or number of rows, of the grid.
+     */
+    uindex_t get_grid_height() const { return storage->range[1]; }
+
+    /**
+     * \brief Create an new, uninitialized grid with the same size and queue as the current one.
+     */
+    USMGrid make_similar() const { return USMGrid(storage->range, storage->queue); }
+
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     *
+     * Copies of a grid share the same underlying data. This method is used by the \ref
+     * stencil::GridPool to find grids that aren't referenced anywhere else and can therefore be
+     * reused.
+     */
+    long get_n_references() const { return storage.use_count(); }
+
+  private:
+    /**
+     * \brief The allocations of a grid, which are shared by all references to it.
+     */
+    struct Storage {
+        Storage(sycl::range<2> range, sycl::queue queue)
+            : range(range), queue(queue),
+              device_data(sycl::malloc_device<Cell>(range.size(), queue)),
+              host_data(sycl::malloc_host<Cell>(range.size(), queue)), last_event(std::nullopt) {
+            if (device_data == nullptr || host_data == nullptr) {
+                sycl::free(device_data, queue);
+                sycl::free(host_data, queue);
+                throw std::runtime_error("The memory of the grid could not be allocated.");
+            }
+        }
+
+        Storage(sycl::range<2> range, sycl::queue queue, Cell *device_data, Cell *host_data)
+            : range(range), queue(queue), device_data(device_data), host_data(host_data),
+              last_event(std::nullopt), owns_data(false) {}
+
+        Storage(Storage const &) = delete;
+        Storage &operator=(Storage const &) = delete;
+
+        ~Storage() {
+            if (last_event.has_value()) {
+                last_event->wait();
+            }
+            if (owns_data) {
+                sycl::free(device_data, queue);
+                sycl::free(host_data, queue);
+            }
+        }
+
+        sycl::range<2> range;
+        sycl::queue queue;
+        Cell *device_data;
+        Cell *host_data;
+        std::optional<sycl::event> last_event;
+        // False if the allocations were adopted from the application, see adopt().
+        bool owns_data = true;
+    };
+
+    USMGrid(std::shared_ptr<Storage> storage) : storage(storage) {}
+
+    std::size_t get_byte_size() const { return storage->range.size() * sizeof(Cell); }
+
+    sycl::event submit_copy(Cell *destination, Cell const *source) {
+        std::size_t byte_size = get_byte_size();
+        sycl::event event = storage->queue.submit([&](sycl::handler &cgh) {
+            if (storage->last_event.has_value()) {
+                cgh.depends_on(*storage->last_event);
+            }
+            cgh.memcpy(destination, source, byte_size);
+        });
+        record_event(event);
+        return event;
+    }
+
+    std::shared_ptr<Storage> storage;
+};
+} // namespace cpu
+} // namespace stencil
@@ -0,0 +1,64 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../cpu/Grid.hpp"
+#include "../cpu/SoAGrid.hpp"
+
+namespace stencil {
+namespace gpu {
+
+/**
+ * \brief Select the storage of a \ref Grid.
+ *
+ * Without any fields, the cells are stored as a whole, like in \ref cpu::Grid. Otherwise, every
+ * listed field is stored in its own buffer, like in \ref cpu::SoAGrid.
+ */
+template <typename Cell, auto... fields> struct GridStorage {
+    using type = cpu::SoAGrid<Cell, fields...>;
+};
+
+template <typename Cell> struct GridStorage<Cell> {
+    using type = cpu::Grid<Cell>;
+};
+
+/**
+ * \brief The grid type of the GPU backend.
+ *
+ * GPUs load and store memory most efficiently if neighbouring work-items access neighbouring
+ * addresses. Since the work-items of a sub-group process neighbouring cells of the same column,
+ * storing the fields of the cells in separate buffers lets every load and store of a sub-group hit
+ * contiguous memory. Therefore, the fields of the cell that should be stored as a structure of
+ * arrays are given as pointers to data members, just like for \ref cpu::SoAGrid:
+ *
+ * ```
+ * using GridImpl = gpu::Grid<Cell, &Cell::value, &Cell::material>;
+ * ```
+ *
+ * If no fields are given, whole cells are stored in one buffer, which works with every cell type.
+ * Both variants fulfill the \ref stencil::concepts::Grid "Grid" concept.
+ *
+ * \tparam Cell The cell type to store.
+ *
+ * \tparam fields Pointers to the data members of `Cell` that are stored.
+ */
+template <typename Cell, auto... fields> using Grid = typename GridStorage<Cell, fields...>::type;
+
+} // namespace gpu
+} // namespace stencil
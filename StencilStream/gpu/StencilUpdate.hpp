@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../Concepts.hpp"
+#include "../cpu/StencilUpdate.hpp"
+#include "Grid.hpp"
+
+namespace stencil {
+namespace gpu {
+
+/**
+ * \brief A grid updater that applies an iterative stencil code to a grid on a GPU.
+ *
+ * This updater uses the same kernels as \ref cpu::StencilUpdate, with a configuration for GPUs:
+ *
+ * * Every work-group loads its tile and the surrounding halo into shared local memory once and
+ * computes \ref cpu::StencilUpdate::Params::temporal_block "multiple iterations" per launch from
+ * there.
+ * * The work-items of a sub-group process neighbouring cells of the same column and exchange their
+ * cells with sub-group shuffles. Therefore, every work-item loads only one cell per stencil column
+ * from local memory.
+ * * Interior work-groups are launched without any bounds checks, so only the work-groups along the
+ * grid borders diverge.
+ *
+ * Use a \ref Grid with a list of fields to store the cells as a structure of arrays.
+ *
+ * \tparam F The transition function to apply to input grids.
+ *
+ * \tparam tile_width (Optimization parameter) The default width of a tile that is processed by
+ * one work-group.
+ *
+ * \tparam tile_height (Optimization parameter) The default height of a tile that is processed by
+ * one work-group. It has to be a multiple of `sub_group_size`.
+ *
+ * \tparam G The grid type to operate on, see \ref Grid.
+ *
+ * \tparam sub_group_size (Optimization parameter) The sub-group size of the kernels. It has to be
+ * supported by the device, for example 32 for NVIDIA GPUs or 16 or 32 for Intel GPUs.
+ */
+template <concepts::TransitionFunction F, uindex_t tile_width = 8, uindex_t tile_height = 32,
+          concepts::Grid<typename F::Cell> G = Grid<typename F::Cell>, uindex_t sub_group_size = 32>
+using StencilUpdate = cpu::StencilUpdate<F, tile_width, tile_height, G, sub_group_size>;
+
+} // namespace gpu
+} // namespace stencil
@@ -0,0 +1,374 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../BatchTransitionFunction.hpp"
+#include "../Concepts.hpp"
+#include "../GridPool.hpp"
+#include "../Index.hpp"
+#include "../tdv/SinglePassStrategies.hpp"
+#include "Grid.hpp"
+#include "StencilUpdate.hpp"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace stencil {
+namespace monotile {
+
+/**
+ * \brief A grid updater that applies an iterative stencil code to a batch of independent grids.
+ *
+ * Many applications, like parameter sweeps or ensemble simulations, update lots of small grids
+ * with the same stencil code. Updating them one by one with a \ref StencilUpdate pays the latency
+ * of the processing element pipeline for every grid and every pass. This updater instead streams
+ * all grids of a batch back-to-back through one invocation of the execution kernel per pass, so
+ * that the pipeline latency is only paid once per batch. Every grid of the batch may have its own
+ * transition function instance, for example to model different runtime parameters.
+ *
+ * All grids of a batch need to have the same size. Internally, the batch is processed like one
+ * grid that contains the grids side by side, with a \ref BatchTransitionFunction that separates
+ * them again. Therefore, the number of grids in a batch times the width of every grid may not
+ * exceed `max_grid_width`. Since the maximal grid width only affects the width of some counters,
+ * this limit can be set generously.
+ *
+ * \tparam F The transition function to apply to input grids. It has to fulfill the requirements of
+ * \ref BatchTransitionFunction and may only use the constant boundary condition.
+ *
+ * \tparam max_batch_size The maximal number of grids in a batch. Every processing element holds
+ * one instance of the transition function and one time-dependent value per grid of a batch, so
+ * this should be kept small.
+ *
+ * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs) to
+ * implement. See \ref StencilUpdate.
+ *
+ * \tparam max_grid_width (Optimization parameter) The maximally supported total width of a batch.
+ *
+ * \tparam max_grid_height (Optimization parameter) The maximally supported grid height. See \ref
+ * StencilUpdate.
+ *
+ * \tparam TDVStrategy (Optimization parameter) The precomputation strategy for the time-dependent
+ * value system.
+ *
+ * \tparam word_size (Optimization parameter) The width of the global memory channel, in bytes.
+ *
+ * \tparam dense_storage (Optimization parameter) Store cells densely packed in global memory and
+ * on-chip caches. See \ref StencilUpdate.
+ */
+template <concepts::TransitionFunction F, uindex_t max_batch_size,
+          uindex_t n_processing_elements = 1, uindex_t max_grid_width = 1024,
+          uindex_t max_grid_height = 1024,
+          tdv::single_pass::Strategy<BatchTransitionFunction<F, max_batch_size>,
+                                     n_processing_elements>
+              TDVStrategy = tdv::single_pass::InlineStrategy,
+          uindex_t word_size = 64, bool dense_storage = false>
+    requires(boundary_condition_of<F> == BoundaryCondition::Constant)
+class BatchStencilUpdate {
+  private:
+    using Cell = F::Cell;
+    using KernelFunction = BatchTransitionFunction<F, max_batch_size>;
+
+  public:
+    /// \brief Shorthand for the used and supported grid type.
+    using GridImpl = Grid<Cell, word_size, dense_storage>;
+
+    /**
+     * \brief Parameters for the batch stencil updater.
+     */
+    struct Params {
+        /**
+         * \brief The transition function instances.
+         *
+         * The grid with the index `i` is updated with the transition function with the index `i`.
+         * If only one transition function is given, it is used for all grids.
+         */
+        std::vector<F> transition_functions;
+
+        /**
+         *  \brief The cell value to present for cells outside of the grids.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The device to use for computations.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief Should the stencil updater block until completion, or return immediately after all
+         * kernels have been submitted.
+         */
+        bool blocking = false;
+
+        /**
+         * \brief Enable profiling.
+         *
+         * Setting this option to true will enable the recording of computation start and end
+         * timestamps. The recorded kernel runtime can be fetched using the \ref
+         * BatchStencilUpdate::get_kernel_runtime method.
+         */
+        bool profiling = false;
+
+        /**
+         * \brief The contents of the constant table of the transition function.
+         *
+         * This is only used if the transition function defines a \ref stencil::ConstantTable
+         * "constant table". The table is copied to the device once per kernel and shared by all
+         * processing elements.
+         */
+        ConstantTableOf<F> constant_table = ConstantTableOf<F>();
+    };
+
+    /**
+     * \brief Create a new batch stencil updater object.
+     */
+    BatchStencilUpdate(Params params)
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          queues_profiling(false), n_processed_cells(0), work_events(), walltime(0.0) {}
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Compute new grids based on the source grids, using the configured transition
+     * functions.
+     *
+     * Like \ref StencilUpdate::operator()(), the computation does not work in-place and the source
+     * grids are not altered. Two additional grids per source grid are requested from the grid pool.
+     *
+     * \returns The updated grids, in the same order as the source grids.
+     *
+     * \throws std::invalid_argument The number of grids exceeds `max_batch_size` or doesn't match
+     * the number of transition functions.
+     *
+     * \throws std::range_error The grids differ in size or the batch is too big for the execution
+     * kernel.
+     */
+    std::vector<GridImpl> operator()(std::vector<GridImpl> &source_grids) {
+        uindex_t batch_size = source_grids.size();
+        if (batch_size == 0) {
+            return {};
+        }
+        if (batch_size > max_batch_size) {
+            throw std::invalid_argument("The batch contains more grids than supported.");
+        }
+        if (params.transition_functions.size() != 1 &&
+            params.transition_functions.size() != batch_size) {
+            throw std::invalid_argument(
+                "The number of transition functions doesn't match the number of grids.");
+        }
+
+        uindex_t grid_width = source_grids[0].get_grid_width();
+        uindex_t grid_height = source_grids[0].get_grid_height();
+        for (GridImpl const &grid : source_grids) {
+            if (grid.get_grid_width() != grid_width || grid.get_grid_height() != grid_height) {
+                throw std::range_error("The grids of the batch differ in size.");
+            }
+        }
+        if (grid_height > max_grid_height) {
+            throw std::range_error("The grids are too tall for the stencil update kernel.");
+        }
+        if (batch_size * grid_width > max_grid_width) {
+            throw std::range_error("The batch is too wide for the stencil update kernel.");
+        }
+
+        using in_pipe = sycl::pipe<class monotile_batch_in_pipe, Cell>;
+        using out_pipe = sycl::pipe<class monotile_batch_out_pipe, Cell>;
+
+        constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+
+        using TDVGlobalState = TDVStrategy::template GlobalState<KernelFunction, iters_per_pass>;
+        using TDVKernelArgument = typename TDVGlobalState::KernelArgument;
+        using ExecutionKernelImpl =
+            StencilUpdateKernel<KernelFunction, TDVKernelArgument, n_processing_elements,
+                                max_grid_width, max_grid_height, in_pipe, out_pipe, dense_storage>;
+
+        prepare_queues();
+
+        // Unused slots are filled with the first transition function, so that they are valid
+        // instances for the computation of time-dependent values.
+        bool shared_transition_function = params.transition_functions.size() == 1;
+        std::array<F, max_batch_size> transition_functions;
+        for (uindex_t i = 0; i < max_batch_size; i++) {
+            bool own_transition_function = i < batch_size && !shared_transition_function;
+            transition_functions[i] = params.transition_functions[own_transition_function ? i : 0];
+        }
+        KernelFunction trans_func(transition_functions, grid_width, params.halo_value);
+        TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
+
+        std::vector<GridImpl> swap_grids_a, swap_grids_b;
+        for (GridImpl &grid : source_grids) {
+            swap_grids_a.push_back(grid_pool->acquire(grid));
+            swap_grids_b.push_back(grid_pool->acquire(grid));
+        }
+
+        std::vector<GridImpl> *pass_source = &source_grids;
+        std::vector<GridImpl> *pass_target = &swap_grids_b;
+
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i = params.iteration_offset; i < target_n_iterations; i += iters_per_pass) {
+            // The input and output queues are in-order, so the grids are streamed back-to-back.
+            for (GridImpl &grid : *pass_source) {
+                grid.template submit_read<in_pipe>(*input_kernel_queue);
+            }
+            uindex_t iters_in_this_pass = std::min(iters_per_pass, target_n_iterations - i);
+
+            sycl::event work_event = update_kernel_queue->submit([&](sycl::handler &cgh) {
+                TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i, iters_in_this_pass);
+                ExecutionKernelImpl exec_kernel(trans_func, i, target_n_iterations,
+                                                batch_size * grid_width, grid_height,
+                                                params.halo_value, tdv_kernel_argument);
+                exec_kernel.set_constant_table(params.constant_table);
+                cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+            });
+            if (params.profiling) {
+                work_events.push_back(work_event);
+            }
+
+            for (GridImpl &grid : *pass_target) {
+                grid.template submit_write<out_pipe>(*output_kernel_queue);
+            }
+
+            if (i == params.iteration_offset) {
+                pass_source = &swap_grids_b;
+                pass_target = &swap_grids_a;
+            } else {
+                std::swap(pass_source, pass_target);
+            }
+        }
+
+        if (params.blocking) {
+            output_kernel_queue->wait();
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+
+        n_processed_cells += params.n_iterations * batch_size * grid_width * grid_height;
+
+        return *pass_source;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the number of grids times the width and
+     * height of the grids, times the number of computed iterations.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated total runtime of the execution kernel.
+     *
+     * This runtime is accumulated across multiple calls to \ref operator()(). However, this is only
+     * possible if \ref Params::profiling is set to true.
+     */
+    double get_kernel_runtime() const {
+        double kernel_runtime = 0.0;
+        for (sycl::event work_event : work_events) {
+            const double timesteps_per_second = 1000000000.0;
+            double start =
+                double(work_event
+                           .get_profiling_info<cl::sycl::info::event_profiling::command_start>()) /
+                timesteps_per_second;
+            double end =
+                double(
+                    work_event.get_profiling_info<cl::sycl::info::event_profiling::command_end>()) /
+                timesteps_per_second;
+            kernel_runtime += end - start;
+        }
+        return kernel_runtime;
+    }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     */
+    double get_walltime() const { return walltime; }
+
+  private:
+    /**
+     * \brief Create the queues of the updater if necessary.
+     *
+     * The queues are rebuilt if \ref Params::device or \ref Params::profiling has changed since the
+     * last call. Only the queue of the update kernel is profiled, and only if profiling is enabled.
+     */
+    void prepare_queues() {
+        if (update_kernel_queue.has_value() && update_kernel_queue->get_device() == params.device &&
+            queues_profiling == params.profiling) {
+            return;
+        }
+        queues_profiling = params.profiling;
+        input_kernel_queue = sycl::queue(params.device, {sycl::property::queue::in_order{}});
+        output_kernel_queue = sycl::queue(params.device, {sycl::property::queue::in_order{}});
+        if (params.profiling) {
+            update_kernel_queue =
+                sycl::queue(params.device, {sycl::property::queue::enable_profiling{},
+                                            sycl::property::queue::in_order{}});
+        } else {
+            update_kernel_queue = sycl::queue(params.device, {sycl::property::queue::in_order{}});
+        }
+    }
+
+    Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<sycl::queue> input_kernel_queue;
+    std::optional<sycl::queue> output_kernel_queue;
+    std::optional<sycl::queue> update_kernel_queue;
+    bool queues_profiling;
+    uindex_t n_processed_cells;
+    double walltime;
+    std::vector<sycl::event> work_events;
+};
+
+} // namespace monotile
+} // namespace stencil
@@ -19,7 +19,20 @@
  */
 #pragma once
 #include "../AccessorSubscript.hpp"
+#include "../CellView.hpp"
 #include "../Concepts.hpp"
+#include "../Helpers.hpp"
+#include "../KernelCounters.hpp"
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 
 namespace stencil {
 namespace monotile {
@@ -54,12 +67,28 @@ namespace monotile {
  *
  * \tparam word_size The word size of the memory system, in bytes. This is used to optimize the
  * kernels submitted by \ref submit_read and \ref submit_write.
+ *
+ * \tparam dense_storage If true, cells are densely packed in global memory instead of being padded
+ * to the next power of two. See \ref CellStorage.
+ *
+ * Cells of sub-byte types like `bool` are packed bit by bit instead, see \ref is_bit_packable.
+ * Otherwise, cells are stored in the format of their \ref CellCodec.
  */
-template <class Cell, uindex_t word_size = 64> class Grid {
+template <class Cell, uindex_t word_size = 64, bool dense_storage = false> class Grid {
   private:
+    using Codec = CellCodec<Cell>;
+    using StoredCell = CellStorage<typename Codec::Storage, dense_storage>;
     static constexpr uindex_t word_length =
-        std::lcm(sizeof(Padded<Cell>), word_size) / sizeof(Padded<Cell>);
-    using IOWord = std::array<Padded<Cell>, word_length>;
+        std::lcm(sizeof(StoredCell), word_size) / sizeof(StoredCell);
+    using IOWord = std::array<StoredCell, word_length>;
+    // Whether the cells are stored as they are, without encoding or padding, and can therefore be
+    // copied bytewise.
+    static constexpr bool stores_plain_cells = !has_cell_codec<Cell> &&
+                                               sizeof(StoredCell) == sizeof(Cell) &&
+                                               std::is_trivially_copyable_v<Cell>;
+
+    Grid(sycl::buffer<IOWord, 1> tile_buffer, uindex_t grid_width, uindex_t grid_height)
+        : tile_buffer(tile_buffer), grid_width(grid_width), grid_height(grid_height) {}
 
   public:
     /**
@@ -104,6 +133,51 @@ template <class Cell, uindex_t word_size = 64> class Grid {
         copy_from_buffer(buffer);
     }
 
+    /**
+     * \brief Create a grid that stores its cells in the given SYCL buffer, without copying them.
+     *
+     * The cells of the buffer are already stored in the layout of the grid, column by column, so
+     * the grid reinterprets the buffer as a buffer of memory words. Changes made via the grid are
+     * therefore visible in the buffer, and vice-versa. This is only possible if the cells are
+     * stored as they are, which means that there is no \ref CellCodec for the cell type and that
+     * the cells need no padding.
+     *
+     * \param buffer The buffer to use as the storage of the new grid.
+     * \throws std::invalid_argument The number of cells in the buffer is not a multiple of the
+     * number of cells in a memory word.
+     */
+    static Grid adopt(sycl::buffer<Cell, 2> buffer)
+        requires(stores_plain_cells)
+    {
+        uindex_t width = buffer.get_range()[0];
+        uindex_t height = buffer.get_range()[1];
+        if ((width * height) % word_length != 0) {
+            throw std::invalid_argument(
+                "The number of cells is not a multiple of the number of cells in a memory word");
+        }
+        sycl::range<1> word_range(width * height / word_length);
+        return Grid(buffer.template reinterpret<IOWord, 1>(word_range), width, height);
+    }
+
+    /**
+     * \brief Create a grid that stores its cells in the given host memory, without copying them.
+     *
+     * The memory has to contain the cells column by column, like a SYCL buffer with the given
+     * range, and it has to stay valid as long as the grid or one of its copies exists. Otherwise,
+     * the same requirements as for \ref adopt(sycl::buffer<Cell, 2>) apply.
+     *
+     * \param data The memory to use as the storage of the new grid.
+     * \param range The range of the new grid. The first index will be the width and the second
+     * index will be the height of the grid.
+     * \throws std::invalid_argument The number of cells is not a multiple of the number of cells in
+     * a memory word.
+     */
+    static Grid adopt(Cell *data, sycl::range<2> range)
+        requires(stores_plain_cells)
+    {
+        return adopt(sycl::buffer<Cell, 2>(data, range));
+    }
+
     /**
      * \brief Create a new reference to the given grid.
      *
@@ -115,13 +189,37 @@ template <class Cell, uindex_t word_size = 64> class Grid {
      */
     Grid(Grid const &other_grid)
         : tile_buffer(other_grid.tile_buffer), grid_width(other_grid.grid_width),
-          grid_height(other_grid.grid_height) {}
+          grid_height(other_grid.grid_height), references(other_grid.references) {}
 
     /**
      * \brief Create an new, uninitialized grid with the same size as the current one.
      */
     Grid make_similar() const { return Grid(grid_width, grid_height); }
 
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     *
+     * Copies of a grid share the same underlying data. This method is used by the \ref
+     * stencil::GridPool to find grids that aren't referenced anywhere else and can therefore be
+     * reused.
+     */
+    long get_n_references() const { return references.use_count(); }
+
+    /**
+     * \brief Return the alignment of column ranges that may be written with \ref submit_write.
+     *
+     * This is the smallest number of columns that fills a whole number of memory words.
+     */
+    uindex_t get_column_alignment() const { return calc_column_alignment(grid_height); }
+
+    /**
+     * \brief Return the column alignment of grids with the given height, see \ref
+     * get_column_alignment.
+     */
+    static constexpr uindex_t calc_column_alignment(uindex_t grid_height) {
+        return word_length / std::gcd(grid_height, word_length);
+    }
+
     /**
      * \brief Return the width, or number of columns, of the grid.
      */
@@ -137,7 +235,8 @@ template <class Cell, uindex_t word_size = 64> class Grid {
      *
      * Instances of this class provide access to a grid, so that host code can read and write the
      * contents of a grid. As such, it fullfils the \ref stencil::concepts::GridAccessor
-     * "GridAccessor" concept.
+     * "GridAccessor" concept. If the cells are stored in the format of a \ref CellCodec, they are
+     * decoded when the accessor is created and encoded again when it's destroyed.
      *
      * \tparam access_mode The access mode for the accessor.
      */
@@ -156,7 +255,32 @@ template <class Cell, uindex_t word_size = 64> class Grid {
          */
         GridAccessor(Grid &grid)
             : ac(grid.tile_buffer), grid_width(grid.get_grid_width()),
-              grid_height(grid.get_grid_height()) {}
+              grid_height(grid.get_grid_height()) {
+            if constexpr (has_cell_codec<Cell>) {
+                cells = std::make_unique<Cell[]>(grid_width * grid_height);
+                if constexpr (access_mode != sycl::access::mode::discard_write &&
+                              access_mode != sycl::access::mode::discard_read_write) {
+                    for (uindex_t i = 0; i < grid_width * grid_height; i++) {
+                        cells[i] = Codec::decode(ac[i / word_length][i % word_length].value);
+                    }
+                }
+            }
+        }
+
+        GridAccessor(GridAccessor const &) = delete;
+        GridAccessor &operator=(GridAccessor const &) = delete;
+
+        /**
+         * \brief Encode the cells back into the grid, if they are decoded and the accessor isn't
+         * read-only.
+         */
+        ~GridAccessor() {
+            if constexpr (has_cell_codec<Cell> && access_mode != sycl::access::mode::read) {
+                for (uindex_t i = 0; i < grid_width * grid_height; i++) {
+                    ac[i / word_length][i % word_length].value = Codec::encode(cells[i]);
+                }
+            }
+        }
 
         /**
          * \brief Shorthand for the used subscript type.
@@ -181,9 +305,12 @@ template <class Cell, uindex_t word_size = 64> class Grid {
         Cell const &operator[](sycl::id<2> id)
             requires(access_mode == sycl::access::mode::read)
         {
-            uindex_t word_i = (id[0] * grid_height + id[1]) / word_length;
-            uindex_t cell_i = (id[0] * grid_height + id[1]) % word_length;
-            return ac[word_i][cell_i].value;
+            uindex_t i = id[0] * grid_height + id[1];
+            if constexpr (has_cell_codec<Cell>) {
+                return cells[i];
+            } else {
+                return ac[i / word_length][i % word_length].value;
+            }
         }
 
         /**
@@ -195,14 +322,49 @@ template <class Cell, uindex_t word_size = 64> class Grid {
         Cell &operator[](sycl::id<2> id)
             requires(access_mode != sycl::access::mode::read)
         {
-            uindex_t word_i = (id[0] * grid_height + id[1]) / word_length;
-            uindex_t cell_i = (id[0] * grid_height + id[1]) % word_length;
-            return ac[word_i][cell_i].value;
+            uindex_t i = id[0] * grid_height + id[1];
+            if constexpr (has_cell_codec<Cell>) {
+                return cells[i];
+            } else {
+                return ac[i / word_length][i % word_length].value;
+            }
         }
 
+        /**
+         * \brief Return a view of all cells of the grid, column by column.
+         *
+         * The memory words of the grid are stored next to each other, so the view walks the stored
+         * cells sequentially instead of computing the word and cell index of every access like the
+         * subscript operators. It is a sized random-access range, and host code may split it among
+         * threads.
+         */
+        auto get_cells() { return cell_range(0, grid_width * grid_height); }
+
+        /**
+         * \brief Return a view of the cells of a column, from the first row to the last one.
+         *
+         * \param c The index of the column.
+         */
+        auto get_column(uindex_t c) { return cell_range(c * grid_height, grid_height); }
+
       private:
+        using CellRef =
+            std::conditional_t<access_mode == sycl::access::mode::read, Cell const, Cell>;
+        using StoredCellRef = std::conditional_t<access_mode == sycl::access::mode::read,
+                                                 StoredCell const, StoredCell>;
+
+        auto cell_range(uindex_t begin, uindex_t n_cells) {
+            if constexpr (has_cell_codec<Cell>) {
+                return std::span<CellRef>(cells.get() + begin, n_cells);
+            } else {
+                return CellView<CellRef, StoredCellRef>(ac[0].data() + begin, n_cells);
+            }
+        }
+
         accessor_t ac;
         uindex_t grid_width, grid_height;
+        // Only used if the cells are stored in a different format.
+        std::unique_ptr<Cell[]> cells;
     };
 
     /**
@@ -212,6 +374,9 @@ template <class Cell, uindex_t word_size = 64> class Grid {
      * buffer however has to have the same size as the grid, otherwise a \ref std::range_error is
      * thrown.
      *
+     * The cells are converted to the storage format of the grid by multiple host threads. If the
+     * cells are stored as they are, they are copied bytewise instead.
+     *
      * \param input_buffer The buffer to copy the data from.
      * \throws std::range_error The size of the buffer does not match the grid.
      */
@@ -224,12 +389,18 @@ template <class Cell, uindex_t word_size = 64> class Grid {
         }
 
         sycl::host_accessor in_ac(input_buffer, sycl::read_only);
-        GridAccessor<sycl::access::mode::read_write> tile_ac(*this);
-        for (uindex_t c = 0; c < width; c++) {
-            for (uindex_t r = 0; r < height; r++) {
-                tile_ac[c][r] = in_ac[c][r];
+        sycl::host_accessor tile_ac(tile_buffer, sycl::write_only, sycl::no_init);
+        Cell const *cells = in_ac.get_pointer();
+        host_parallel_for(width * height, word_length, [&](uindex_t begin, uindex_t end) {
+            if constexpr (stores_plain_cells) {
+                std::memcpy(tile_ac[begin / word_length].data(), cells + begin,
+                            (end - begin) * sizeof(Cell));
+            } else {
+                for (uindex_t i = begin; i < end; i++) {
+                    tile_ac[i / word_length][i % word_length].value = Codec::encode(cells[i]);
+                }
             }
-        }
+        });
     }
 
     /**
@@ -238,6 +409,9 @@ template <class Cell, uindex_t word_size = 64> class Grid {
      * The contents of the SYCL buffer will be overwritten on the host. The buffer also has to have
      * the same size as the grid, otherwise a \ref std::range_error is thrown.
      *
+     * Like \ref copy_from_buffer, the cells are converted by multiple host threads or copied
+     * bytewise.
+     *
      * \param output_buffer The buffer to copy the data to.
      * \throws std::range_error The size of the buffer does not match the grid.
      */
@@ -249,13 +423,130 @@ template <class Cell, uindex_t word_size = 64> class Grid {
             throw std::range_error("The target buffer has not the same size as the grid");
         }
 
-        GridAccessor<sycl::access::mode::read> in_ac(*this);
-        sycl::host_accessor out_ac(output_buffer, sycl::write_only);
-        for (uindex_t c = 0; c < width; c++) {
-            for (uindex_t r = 0; r < height; r++) {
-                out_ac[c][r] = in_ac[c][r];
+        sycl::host_accessor tile_ac(tile_buffer, sycl::read_only);
+        sycl::host_accessor out_ac(output_buffer, sycl::write_only, sycl::no_init);
+        Cell *cells = out_ac.get_pointer();
+        host_parallel_for(width * height, word_length, [&](uindex_t begin, uindex_t end) {
+            if constexpr (stores_plain_cells) {
+                std::memcpy(cells + begin, tile_ac[begin / word_length].data(),
+                            (end - begin) * sizeof(Cell));
+            } else {
+                for (uindex_t i = begin; i < end; i++) {
+                    cells[i] = Codec::decode(tile_ac[i / word_length][i % word_length].value);
+                }
             }
-        }
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that extracts one value of every cell into a compact buffer.
+     *
+     * Host code that only needs one field of the cells, for example for a snapshot, would
+     * otherwise map the whole grid and transfer all fields and the padding of every cell from the
+     * device. Instead, this kernel applies the projection to every cell on the device and only
+     * writes the results to the returned buffer, so that only these values are transferred when
+     * the buffer is accessed on the host.
+     *
+     * \tparam Projection A callable object that is invoked as `projection(cell)` on the device.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param projection The projection to apply to every cell.
+     *
+     * \returns A buffer with the projected values, with the same range as the grid.
+     */
+    template <typename Projection>
+        requires std::invocable<Projection const &, Cell const &>
+    auto project(sycl::queue queue, Projection projection) {
+        using Value = std::remove_cvref_t<std::invoke_result_t<Projection const &, Cell const &>>;
+        sycl::buffer<Value, 2> output_buffer(sycl::range<2>(grid_width, grid_height));
+
+        queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(tile_buffer, cgh, sycl::read_only);
+            sycl::accessor out_ac(output_buffer, cgh, sycl::write_only);
+            uindex_t grid_width = this->grid_width;
+            uindex_t grid_height = this->grid_height;
+
+            cgh.single_task([=]() {
+                uindex_t c = 0;
+                uindex_t r = 0;
+                for (uindex_t word_i = 0; word_i < ac.size(); word_i++) {
+                    IOWord word = ac[word_i];
+                    for (uindex_t cell_i = 0; cell_i < word_length; cell_i++) {
+                        if (c < grid_width) {
+                            out_ac[c][r] = projection(Codec::decode(word[cell_i].value));
+                        }
+                        r++;
+                        if (r == grid_height) {
+                            r = 0;
+                            c++;
+                        }
+                    }
+                }
+            });
+        });
+
+        return output_buffer;
+    }
+
+    /**
+     * \brief Submit a kernel that extracts one field of every cell into a compact buffer.
+     *
+     * This is a shorthand for \ref project(sycl::queue, Projection) with a projection that reads
+     * the given member, for example `grid.project<&Cell::hz>(queue)`.
+     *
+     * \tparam field A pointer to the member of the cell type to extract.
+     */
+    template <auto field> auto project(sycl::queue queue) {
+        return project(queue, [](Cell const &cell) { return std::invoke(field, cell); });
+    }
+
+    /**
+     * \brief Submit a kernel that overwrites every cell of the grid with the results of a
+     * generator.
+     *
+     * Initializing a large grid on the host is limited by a single host thread and by the transfer
+     * of the grid to the device afterwards. Instead, this kernel calls the generator for every cell
+     * on the device and writes the encoded cells directly into the memory words of the grid, one
+     * whole word at a time.
+     *
+     * \tparam Generator A callable object that is invoked as `generator(c, r)` on the device with
+     * the column and row index of a cell. It returns the new value of the cell.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param generator The generator to call for every cell.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename Generator>
+        requires std::convertible_to<std::invoke_result_t<Generator const &, uindex_t, uindex_t>,
+                                     Cell>
+    sycl::event generate(sycl::queue queue, Generator generator) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(tile_buffer, cgh, sycl::write_only, sycl::no_init);
+            uindex_t grid_width = this->grid_width;
+            uindex_t grid_height = this->grid_height;
+
+            cgh.single_task([=]() {
+                uindex_t c = 0;
+                uindex_t r = 0;
+                for (uindex_t word_i = 0; word_i < ac.size(); word_i++) {
+                    IOWord word;
+                    for (uindex_t cell_i = 0; cell_i < word_length; cell_i++) {
+                        if (c < grid_width) {
+                            word[cell_i].value = Codec::encode(generator(c, r));
+                        }
+                        r++;
+                        if (r == grid_height) {
+                            r = 0;
+                            c++;
+                        }
+                    }
+                    ac[word_i] = word;
+                }
+            });
+        });
     }
 
     /**
@@ -270,31 +561,47 @@ template <class Cell, uindex_t word_size = 64> class Grid {
      *
      * \tparam in_pipe The pipe the data is sent into.
      *
+     * \tparam vector_width The number of cells to send per pipe operation. If it's greater than
+     * one, the pipe receives \ref CellVector "CellVectors" with vertically adjacent cells of one
+     * column. If the grid height isn't a multiple of the vector width, the last vector of every
+     * column is padded with default-constructed cells.
+     *
      * \param queue The queue to submit the kernel to.
      *
      * \returns The event object of the submitted kernel.
      */
-    template <typename in_pipe> sycl::event submit_read(sycl::queue queue) {
-        return queue.submit([&](sycl::handler &cgh) {
-            sycl::accessor ac(tile_buffer, cgh, sycl::read_only);
-            uindex_t n_cells = grid_width * grid_height;
+    template <typename in_pipe, uindex_t vector_width = 1>
+    sycl::event submit_read(sycl::queue queue) {
+        return submit_read<in_pipe, vector_width>(queue, 0, grid_width);
+    }
 
-            cgh.single_task([=]() {
-                IOWord cache;
+    /**
+     * \brief Submit a kernel that sends the columns of the given range into a pipe.
+     *
+     * This works like \ref submit_read(sycl::queue), but only the cells of the columns
+     * `column_begin` to `column_end - 1` are sent.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     */
+    template <typename in_pipe, uindex_t vector_width = 1>
+    sycl::event submit_read(sycl::queue queue, uindex_t column_begin, uindex_t column_end) {
+        return submit_read_kernel<in_pipe, vector_width, false>(queue, column_begin, column_end,
+                                                                std::nullopt);
+    }
 
-                uindex_t word_i = 0;
-                uindex_t cell_i = word_length;
-                for (uindex_t i = 0; i < n_cells; i++) {
-                    if (cell_i == word_length) {
-                        cache = ac[word_i];
-                        word_i++;
-                        cell_i = 0;
-                    }
-                    in_pipe::write(cache[cell_i].value);
-                    cell_i++;
-                }
-            });
-        });
+    /**
+     * \brief Submit an instrumented kernel that sends the columns of the given range into a pipe.
+     *
+     * This works like \ref submit_read(sycl::queue, uindex_t, uindex_t), but the kernel records
+     * its \ref KernelCounters and adds them to the given buffer.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     */
+    template <typename in_pipe, uindex_t vector_width = 1>
+    sycl::event submit_read(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                            KernelCountersBuffer counters) {
+        return submit_read_kernel<in_pipe, vector_width, true>(queue, column_begin, column_end,
+                                                               counters);
     }
 
     /**
@@ -310,36 +617,884 @@ template <class Cell, uindex_t word_size = 64> class Grid {
      *
      * \tparam out_pipe The pipe the data is received from.
      *
+     * \tparam vector_width The number of cells to receive per pipe operation. If it's greater than
+     * one, the pipe has to provide vectors as they are sent by \ref submit_read, and the padding
+     * cells are discarded.
+     *
      * \param queue The queue to submit the kernel to.
      *
      * \returns The event object of the submitted kernel.
      */
-    template <typename out_pipe> sycl::event submit_write(sycl::queue queue) {
+    template <typename out_pipe, uindex_t vector_width = 1>
+    sycl::event submit_write(sycl::queue queue) {
+        return submit_write<out_pipe, vector_width>(queue, 0, grid_width);
+    }
+
+    /**
+     * \brief Submit a kernel that receives the cells of the given column range from the pipe and
+     * writes them to the grid.
+     *
+     * This works like \ref submit_write(sycl::queue), but only the columns `column_begin` to
+     * `column_end - 1` are overwritten. Since the kernel writes whole memory words, both bounds
+     * have to be multiples of \ref get_column_alignment, except for an upper bound that equals the
+     * grid width. This way, kernels that write disjoint column ranges never write to the same
+     * word.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     *
+     * \throws std::invalid_argument The column range isn't aligned.
+     */
+    template <typename out_pipe, uindex_t vector_width = 1>
+    sycl::event submit_write(sycl::queue queue, uindex_t column_begin, uindex_t column_end) {
+        return submit_write_kernel<out_pipe, vector_width, false>(queue, column_begin,
+                                                                  column_end, std::nullopt);
+    }
+
+    /**
+     * \brief Submit an instrumented kernel that receives the cells of the given column range from
+     * the pipe and writes them to the grid.
+     *
+     * This works like \ref submit_write(sycl::queue, uindex_t, uindex_t), but the kernel records
+     * its \ref KernelCounters and adds them to the given buffer.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     *
+     * \throws std::invalid_argument The column range isn't aligned.
+     */
+    template <typename out_pipe, uindex_t vector_width = 1>
+    sycl::event submit_write(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                             KernelCountersBuffer counters) {
+        return submit_write_kernel<out_pipe, vector_width, true>(queue, column_begin, column_end,
+                                                                 counters);
+    }
+
+  private:
+    /**
+     * \brief Submit the kernel of \ref submit_read, with or without counters.
+     */
+    template <typename in_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_read_kernel(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                   std::optional<KernelCountersBuffer> counters) {
+        if (column_begin > column_end || column_end > grid_width) {
+            throw std::range_error("The column range exceeds the grid.");
+        }
+        if constexpr (vector_width > 1) {
+            return submit_vector_read<in_pipe, vector_width, instrumented>(queue, column_begin,
+                                                                           column_end, counters);
+        } else {
+            return queue.submit([&](sycl::handler &cgh) {
+                sycl::accessor ac(tile_buffer, cgh, sycl::read_only);
+                auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+                uindex_t first_cell = column_begin * grid_height;
+                uindex_t n_cells = (column_end - column_begin) * grid_height;
+
+                cgh.single_task([=]() {
+                    KernelCounterRecorder<instrumented> recorder;
+                    IOWord cache;
+
+                    uindex_t word_i = first_cell / word_length;
+                    uindex_t cell_i = first_cell % word_length;
+                    if (n_cells != 0) {
+                        cache = ac[word_i];
+                    }
+                    for (uindex_t i = 0; i < n_cells; i++) {
+                        if (cell_i == word_length) {
+                            word_i++;
+                            cache = ac[word_i];
+                            cell_i = 0;
+                        }
+                        recorder.template write<in_pipe>(Codec::decode(cache[cell_i].value));
+                        cell_i++;
+                    }
+                    recorder.store(counters_ac, n_cells, n_cells);
+                });
+            });
+        }
+    }
+
+    /**
+     * \brief Submit the kernel of \ref submit_write, with or without counters.
+     */
+    template <typename out_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_write_kernel(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                    std::optional<KernelCountersBuffer> counters) {
+        if (column_begin > column_end || column_end > grid_width) {
+            throw std::range_error("The column range exceeds the grid.");
+        }
+        uindex_t alignment = get_column_alignment();
+        if (column_begin % alignment != 0 ||
+            (column_end != grid_width && column_end % alignment != 0)) {
+            throw std::invalid_argument("The column range isn't aligned to memory words.");
+        }
+        if constexpr (vector_width > 1) {
+            return submit_vector_write<out_pipe, vector_width, instrumented>(queue, column_begin,
+                                                                             column_end, counters);
+        } else {
+            return queue.submit([&](sycl::handler &cgh) {
+                sycl::accessor ac(tile_buffer, cgh, sycl::write_only);
+                auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+                uindex_t first_cell = column_begin * grid_height;
+                uindex_t n_cells = (column_end - column_begin) * grid_height;
+
+                cgh.single_task([=]() {
+                    KernelCounterRecorder<instrumented> recorder;
+                    IOWord cache;
+
+                    uindex_t word_i = first_cell / word_length;
+                    uindex_t cell_i = 0;
+                    for (uindex_t i = 0; i < n_cells; i++) {
+                        cache[cell_i].value = Codec::encode(recorder.template read<out_pipe>());
+                        cell_i++;
+                        if (cell_i == word_length || i == n_cells - 1) {
+                            ac[word_i] = cache;
+                            cell_i = 0;
+                            word_i++;
+                        }
+                    }
+                    recorder.store(counters_ac, n_cells, n_cells);
+                });
+            });
+        }
+    }
+
+    /**
+     * \brief Submit a kernel that sends the cells of a column range into a pipe, `vector_width`
+     * cells at a time. See \ref submit_read.
+     */
+    template <typename in_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_vector_read(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                   std::optional<KernelCountersBuffer> counters) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(tile_buffer, cgh, sycl::read_only);
+            auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+            uindex_t grid_height = this->grid_height;
+            uindex_t n_vectors =
+                (column_end - column_begin) * n_cells_to_n_words(grid_height, vector_width);
+
+            cgh.single_task([=]() {
+                KernelCounterRecorder<instrumented> recorder;
+                uindex_t c = column_begin;
+                uindex_t r = 0;
+                for (uindex_t i = 0; i < n_vectors; i++) {
+                    std::array<Cell, vector_width> vector;
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        uindex_t cell_i = c * grid_height + r + i_cell;
+                        if (r + i_cell < grid_height) {
+                            vector[i_cell] =
+                                Codec::decode(ac[cell_i / word_length][cell_i % word_length].value);
+                        } else {
+                            vector[i_cell] = Cell();
+                        }
+                    }
+                    recorder.template write<in_pipe>(vector);
+
+                    r += vector_width;
+                    if (r >= grid_height) {
+                        r = 0;
+                        c++;
+                    }
+                }
+                recorder.store(counters_ac, n_vectors, (column_end - column_begin) * grid_height);
+            });
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that receives the cells of a column range from the pipe,
+     * `vector_width` cells at a time, and writes them to the grid. See \ref submit_write.
+     */
+    template <typename out_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_vector_write(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                    std::optional<KernelCountersBuffer> counters) {
         return queue.submit([&](sycl::handler &cgh) {
             sycl::accessor ac(tile_buffer, cgh, sycl::write_only);
-            uindex_t n_cells = grid_width * grid_height;
+            auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+            uindex_t grid_height = this->grid_height;
+            uindex_t n_vectors =
+                (column_end - column_begin) * n_cells_to_n_words(grid_height, vector_width);
 
             cgh.single_task([=]() {
-                IOWord cache;
-
-                uindex_t word_i = 0;
-                uindex_t cell_i = 0;
-                for (uindex_t i = 0; i < n_cells; i++) {
-                    cache[cell_i].value = out_pipe::read();
-                    cell_i++;
-                    if (cell_i == word_length || i == n_cells - 1) {
-                        ac[word_i] = cache;
-                        cell_i = 0;
-                        word_i++;
+                KernelCounterRecorder<instrumented> recorder;
+                uindex_t c = column_begin;
+                uindex_t r = 0;
+                for (uindex_t i = 0; i < n_vectors; i++) {
+                    std::array<Cell, vector_width> vector =
+                        recorder.template read<out_pipe>();
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        uindex_t cell_i = c * grid_height + r + i_cell;
+                        if (r + i_cell < grid_height) {
+                            ac[cell_i / word_length][cell_i % word_length].value =
+                                Codec::encode(vector[i_cell]);
+                        }
+                    }
+
+                    r += vector_width;
+                    if (r >= grid_height) {
+                        r = 0;
+                        c++;
                     }
                 }
+                recorder.store(counters_ac, n_vectors, (column_end - column_begin) * grid_height);
             });
         });
     }
 
+    sycl::buffer<IOWord, 1> tile_buffer;
+    uindex_t grid_width, grid_height;
+    // Only used to count the references to the grid data, see get_n_references().
+    std::shared_ptr<char> references = std::make_shared<char>();
+};
+
+/**
+ * \brief A bit-packed grid class for the monotile architecture
+ *
+ * This specialization of the monotile grid is used for cell types whose values only use a few bits,
+ * like `bool`. Instead of storing every cell in at least one byte, it packs `8 / CellBits<Cell>`
+ * cells into every byte of global memory. For boolean cells and 64-byte words, this means that one
+ * word contains 512 cells, which reduces the required memory and the transferred data by a factor
+ * of eight. The cells are unpacked and packed again by the kernels of \ref submit_read and \ref
+ * submit_write, so the pipes and the execution kernel still operate on whole cells.
+ *
+ * Since single cells can't be referenced in packed memory, the \ref GridAccessor unpacks the
+ * whole grid when it's created, unless it's a discarding accessor, and packs it again when it's
+ * destroyed, unless it's a read-only accessor.
+ *
+ * \tparam Cell The cell type to store. It must fulfill \ref is_bit_packable.
+ *
+ * \tparam word_size The word size of the memory system, in bytes.
+ *
+ * \tparam dense_storage Ignored, since the cells are always densely packed.
+ */
+template <class Cell, uindex_t word_size, bool dense_storage>
+    requires(is_bit_packable<Cell>)
+class Grid<Cell, word_size, dense_storage> {
   private:
+    static constexpr uindex_t cell_bits = CellBits<Cell>::value;
+    static constexpr uindex_t cells_per_byte = 8 / cell_bits;
+    static constexpr uint8_t cell_mask = (1 << cell_bits) - 1;
+    static constexpr uindex_t word_length = word_size * cells_per_byte;
+    using IOWord = std::array<uint8_t, word_size>;
+
+    static Cell unpack_cell(IOWord const &word, uindex_t cell_i) {
+        uint8_t shift = (cell_i % cells_per_byte) * cell_bits;
+        return static_cast<Cell>((word[cell_i / cells_per_byte] >> shift) & cell_mask);
+    }
+
+    static void pack_cell(IOWord &word, uindex_t cell_i, Cell cell) {
+        uint8_t shift = (cell_i % cells_per_byte) * cell_bits;
+        uint8_t &byte = word[cell_i / cells_per_byte];
+        byte = (byte & ~(cell_mask << shift)) | ((static_cast<uint8_t>(cell) & cell_mask) << shift);
+    }
+
+  public:
+    /**
+     * \brief The number of dimensions of the grid.
+     *
+     * May be changed in the future when other dimensions are supported.
+     */
+    static constexpr uindex_t dimensions = 2;
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param grid_width The width, or number of columns, of the new grid.
+     *
+     * \param grid_height The height, or number of rows, of the new grid.
+     */
+    Grid(uindex_t grid_width, uindex_t grid_height)
+        : tile_buffer(sycl::range<1>(n_cells_to_n_words(grid_width * grid_height, word_length))),
+          grid_width(grid_width), grid_height(grid_height) {}
+
+    /**
+     * \brief Create a new, uninitialized grid with the given dimensions.
+     *
+     * \param range The range of the new grid. The first index will be the width and the second
+     * index will be the height of the grid.
+     */
+    Grid(sycl::range<2> range)
+        : tile_buffer(sycl::range<1>(n_cells_to_n_words(range[0] * range[1], word_length))),
+          grid_width(range[0]), grid_height(range[1]) {}
+
+    /**
+     * \brief Create a new grid with the same size and contents as the given SYCL buffer.
+     *
+     * The contents of the buffer will be copied to the grid by the host. The SYCL buffer can later
+     * be used elsewhere.
+     *
+     * \param buffer The buffer with the contents of the new grid.
+     */
+    Grid(sycl::buffer<Cell, 2> buffer)
+        : tile_buffer(1), grid_width(buffer.get_range()[0]), grid_height(buffer.get_range()[1]) {
+        tile_buffer = sycl::range<1>(n_cells_to_n_words(grid_width * grid_height, word_length));
+        copy_from_buffer(buffer);
+    }
+
+    /**
+     * \brief Create a new reference to the given grid.
+     *
+     * The newly created grid object will point to the same underlying data as the referenced grid.
+     * Changes made via the newly created grid object will also be visible to the old grid object,
+     * and vice-versa.
+     *
+     * \param other_grid The other grid the new grid should reference.
+     */
+    Grid(Grid const &other_grid)
+        : tile_buffer(other_grid.tile_buffer), grid_width(other_grid.grid_width),
+          grid_height(other_grid.grid_height), references(other_grid.references) {}
+
+    /**
+     * \brief Create an new, uninitialized grid with the same size as the current one.
+     */
+    Grid make_similar() const { return Grid(grid_width, grid_height); }
+
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     *
+     * Copies of a grid share the same underlying data. This method is used by the \ref
+     * stencil::GridPool to find grids that aren't referenced anywhere else and can therefore be
+     * reused.
+     */
+    long get_n_references() const { return references.use_count(); }
+
+    /**
+     * \brief Return the alignment of column ranges that may be written with \ref submit_write.
+     *
+     * This is the smallest number of columns that fills a whole number of memory words.
+     */
+    uindex_t get_column_alignment() const { return calc_column_alignment(grid_height); }
+
+    /**
+     * \brief Return the column alignment of grids with the given height, see \ref
+     * get_column_alignment.
+     */
+    static constexpr uindex_t calc_column_alignment(uindex_t grid_height) {
+        return word_length / std::gcd(grid_height, word_length);
+    }
+
+    /**
+     * \brief Return the width, or number of columns, of the grid.
+     */
+    uindex_t get_grid_width() const { return grid_width; }
+
+    /**
+     * \brief Return the height, or number of rows, of the grid.
+     */
+    uindex_t get_grid_height() const { return grid_height; }
+
+    /**
+     * \brief An accessor for the bit-packed monotile grid.
+     *
+     * Instances of this class provide access to a grid, so that host code can read and write the
+     * contents of a grid. As such, it fullfils the \ref stencil::concepts::GridAccessor
+     * "GridAccessor" concept. The cells are unpacked when the accessor is created and packed again
+     * when it's destroyed.
+     *
+     * \tparam access_mode The access mode for the accessor.
+     */
+    template <sycl::access::mode access_mode = sycl::access::mode::read_write> class GridAccessor {
+      private:
+        using accessor_t = sycl::host_accessor<IOWord, 1, access_mode>;
+
+      public:
+        /**
+         * \brief The number of dimensions of the underlying grid.
+         */
+        static constexpr uindex_t dimensions = Grid::dimensions;
+
+        /**
+         * \brief Create a new accessor to the given grid.
+         */
+        GridAccessor(Grid &grid)
+            : ac(grid.tile_buffer), grid_width(grid.get_grid_width()),
+              grid_height(grid.get_grid_height()),
+              cells(std::make_unique<Cell[]>(grid_width * grid_height)) {
+            if constexpr (access_mode != sycl::access::mode::discard_write &&
+                          access_mode != sycl::access::mode::discard_read_write) {
+                for (uindex_t i = 0; i < grid_width * grid_height; i++) {
+                    cells[i] = unpack_cell(ac[i / word_length], i % word_length);
+                }
+            }
+        }
+
+        GridAccessor(GridAccessor const &) = delete;
+        GridAccessor &operator=(GridAccessor const &) = delete;
+
+        /**
+         * \brief Pack the cells back into the grid, if the accessor isn't read-only.
+         */
+        ~GridAccessor() {
+            if constexpr (access_mode != sycl::access::mode::read) {
+                for (uindex_t i = 0; i < grid_width * grid_height; i++) {
+                    pack_cell(ac[i / word_length], i % word_length, cells[i]);
+                }
+            }
+        }
+
+        /**
+         * \brief Shorthand for the used subscript type.
+         */
+        using BaseSubscript = AccessorSubscript<Cell, GridAccessor, access_mode>;
+
+        /**
+         * \brief Access/Dereference the first dimension.
+         *
+         * This subscript operator is the first subscript in an expression like
+         * `accessor[i_column][i_row]`. It will return a \ref BaseSubscript object that handles
+         * subsequent dimensions.
+         */
+        BaseSubscript operator[](uindex_t i) { return BaseSubscript(*this, i); }
+
+        /**
+         * \brief Access a cell of the grid.
+         *
+         * \param id The index of the accessed cell. The first index is the column index, the second
+         * one is the row index. \returns A constant reference to the indexed cell.
+         */
+        Cell const &operator[](sycl::id<2> id)
+            requires(access_mode == sycl::access::mode::read)
+        {
+            return cells[id[0] * grid_height + id[1]];
+        }
+
+        /**
+         * \brief Access a cell of the grid.
+         *
+         * \param id The index of the accessed cell. The first index is the column index, the second
+         * one is the row index. \returns A reference to the indexed cell.
+         */
+        Cell &operator[](sycl::id<2> id)
+            requires(access_mode != sycl::access::mode::read)
+        {
+            return cells[id[0] * grid_height + id[1]];
+        }
+
+        /**
+         * \brief Return a view of all unpacked cells of the grid, column by column.
+         */
+        auto get_cells() { return std::span<CellRef>(cells.get(), grid_width * grid_height); }
+
+        /**
+         * \brief Return a view of the unpacked cells of a column, from the first row to the last
+         * one.
+         *
+         * \param c The index of the column.
+         */
+        auto get_column(uindex_t c) { return get_cells().subspan(c * grid_height, grid_height); }
+
+      private:
+        using CellRef =
+            std::conditional_t<access_mode == sycl::access::mode::read, Cell const, Cell>;
+
+        accessor_t ac;
+        uindex_t grid_width, grid_height;
+        std::unique_ptr<Cell[]> cells;
+    };
+
+    /**
+     * \brief Submit a kernel that overwrites every cell of the grid with the results of a
+     * generator.
+     *
+     * Like in the generic grid, the generator is called on the device. The cells are packed into
+     * the memory words of the grid right away, one whole word at a time.
+     *
+     * \tparam Generator A callable object that is invoked as `generator(c, r)` on the device with
+     * the column and row index of a cell. It returns the new value of the cell.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param generator The generator to call for every cell.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename Generator>
+        requires std::convertible_to<std::invoke_result_t<Generator const &, uindex_t, uindex_t>,
+                                     Cell>
+    sycl::event generate(sycl::queue queue, Generator generator) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(tile_buffer, cgh, sycl::write_only, sycl::no_init);
+            uindex_t grid_height = this->grid_height;
+            uindex_t n_cells = grid_width * grid_height;
+
+            cgh.single_task([=]() {
+                uindex_t c = 0;
+                uindex_t r = 0;
+                for (uindex_t word_i = 0; word_i < ac.size(); word_i++) {
+                    IOWord word{};
+                    for (uindex_t cell_i = 0; cell_i < word_length; cell_i++) {
+                        if (word_i * word_length + cell_i < n_cells) {
+                            pack_cell(word, cell_i, generator(c, r));
+                        }
+                        r++;
+                        if (r == grid_height) {
+                            r = 0;
+                            c++;
+                        }
+                    }
+                    ac[word_i] = word;
+                }
+            });
+        });
+    }
+
+    /**
+     * \brief Copy the contents of the SYCL buffer into the grid.
+     *
+     * The SYCL buffer will be accessed read-only one the host; It may be used elsewhere too. The
+     * buffer however has to have the same size as the grid, otherwise a \ref std::range_error is
+     * thrown.
+     *
+     * The cells are packed into the grid by multiple host threads.
+     *
+     * \param input_buffer The buffer to copy the data from.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_from_buffer(sycl::buffer<Cell, 2> input_buffer) {
+        uindex_t width = this->get_grid_width();
+        uindex_t height = this->get_grid_height();
+
+        if (input_buffer.get_range() != sycl::range<2>(width, height)) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+
+        sycl::host_accessor in_ac(input_buffer, sycl::read_only);
+        sycl::host_accessor tile_ac(tile_buffer, sycl::write_only, sycl::no_init);
+        Cell const *cells = in_ac.get_pointer();
+        host_parallel_for(width * height, word_length, [&](uindex_t begin, uindex_t end) {
+            for (uindex_t i = begin; i < end; i++) {
+                pack_cell(tile_ac[i / word_length], i % word_length, cells[i]);
+            }
+        });
+    }
+
+    /**
+     * \brief Copy the contents of the grid into the SYCL buffer.
+     *
+     * The contents of the SYCL buffer will be overwritten on the host. The buffer also has to have
+     * the same size as the grid, otherwise a \ref std::range_error is thrown.
+     *
+     * Like \ref copy_from_buffer, the cells are unpacked by multiple host threads.
+     *
+     * \param output_buffer The buffer to copy the data to.
+     * \throws std::range_error The size of the buffer does not match the grid.
+     */
+    void copy_to_buffer(sycl::buffer<Cell, 2> output_buffer) {
+        uindex_t width = this->get_grid_width();
+        uindex_t height = this->get_grid_height();
+
+        if (output_buffer.get_range() != sycl::range<2>(width, height)) {
+            throw std::range_error("The target buffer has not the same size as the grid");
+        }
+
+        sycl::host_accessor tile_ac(tile_buffer, sycl::read_only);
+        sycl::host_accessor out_ac(output_buffer, sycl::write_only, sycl::no_init);
+        Cell *cells = out_ac.get_pointer();
+        host_parallel_for(width * height, word_length, [&](uindex_t begin, uindex_t end) {
+            for (uindex_t i = begin; i < end; i++) {
+                cells[i] = unpack_cell(tile_ac[i / word_length], i % word_length);
+            }
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that sends the contents of the grid into a pipe.
+     *
+     * The entirety of the grid will be unpacked and send into the pipe in column-major order,
+     * meaning that the last index (which denotes the row) will change the quickest. The method
+     * returns the event of the launched kernel immediately.
+     *
+     * This method is explicitly part of the user-facing API: You are allowed and encouraged to use
+     * this method to feed custom kernels.
+     *
+     * \tparam in_pipe The pipe the data is sent into.
+     *
+     * \tparam vector_width The number of cells to send per pipe operation. If it's greater than
+     * one, the pipe receives \ref CellVector "CellVectors" with vertically adjacent cells of one
+     * column. If the grid height isn't a multiple of the vector width, the last vector of every
+     * column is padded with default-constructed cells.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename in_pipe, uindex_t vector_width = 1>
+    sycl::event submit_read(sycl::queue queue) {
+        return submit_read<in_pipe, vector_width>(queue, 0, grid_width);
+    }
+
+    /**
+     * \brief Submit a kernel that sends the columns of the given range into a pipe.
+     *
+     * This works like \ref submit_read(sycl::queue), but only the cells of the columns
+     * `column_begin` to `column_end - 1` are sent.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     */
+    template <typename in_pipe, uindex_t vector_width = 1>
+    sycl::event submit_read(sycl::queue queue, uindex_t column_begin, uindex_t column_end) {
+        return submit_read_kernel<in_pipe, vector_width, false>(queue, column_begin, column_end,
+                                                                std::nullopt);
+    }
+
+    /**
+     * \brief Submit an instrumented kernel that sends the columns of the given range into a pipe.
+     *
+     * This works like \ref submit_read(sycl::queue, uindex_t, uindex_t), but the kernel records
+     * its \ref KernelCounters and adds them to the given buffer.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     */
+    template <typename in_pipe, uindex_t vector_width = 1>
+    sycl::event submit_read(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                            KernelCountersBuffer counters) {
+        return submit_read_kernel<in_pipe, vector_width, true>(queue, column_begin, column_end,
+                                                               counters);
+    }
+
+    /**
+     * \brief Submit a kernel that receives cells from the pipe and writes them to the grid.
+     *
+     * The kernel expects that the entirety of the grid can be overwritten with the cells read from
+     * the pipe. Also, it expects that the cells are sent in column-major order, meaning that the
+     * last index (which denotes the row) will change the quickest. The cells are packed before they
+     * are written to global memory. The method returns the event of the launched kernel
+     * immediately.
+     *
+     * This method is explicitly part of the user-facing API: You are allowed and encouraged to use
+     * this method to feed custom kernels.
+     *
+     * \tparam out_pipe The pipe the data is received from.
+     *
+     * \tparam vector_width The number of cells to receive per pipe operation. If it's greater than
+     * one, the pipe has to provide vectors as they are sent by \ref submit_read, and the padding
+     * cells are discarded.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename out_pipe, uindex_t vector_width = 1>
+    sycl::event submit_write(sycl::queue queue) {
+        return submit_write<out_pipe, vector_width>(queue, 0, grid_width);
+    }
+
+    /**
+     * \brief Submit a kernel that receives the cells of the given column range from the pipe and
+     * writes them to the grid.
+     *
+     * This works like \ref submit_write(sycl::queue), but only the columns `column_begin` to
+     * `column_end - 1` are overwritten. Since the kernel writes whole memory words, both bounds
+     * have to be multiples of \ref get_column_alignment, except for an upper bound that equals the
+     * grid width. This way, kernels that write disjoint column ranges never write to the same
+     * word.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     *
+     * \throws std::invalid_argument The column range isn't aligned.
+     */
+    template <typename out_pipe, uindex_t vector_width = 1>
+    sycl::event submit_write(sycl::queue queue, uindex_t column_begin, uindex_t column_end) {
+        return submit_write_kernel<out_pipe, vector_width, false>(queue, column_begin,
+                                                                  column_end, std::nullopt);
+    }
+
+    /**
+     * \brief Submit an instrumented kernel that receives the cells of the given column range from
+     * the pipe and writes them to the grid.
+     *
+     * This works like \ref submit_write(sycl::queue, uindex_t, uindex_t), but the kernel records
+     * its \ref KernelCounters and adds them to the given buffer.
+     *
+     * \throws std::range_error The column range exceeds the grid.
+     *
+     * \throws std::invalid_argument The column range isn't aligned.
+     */
+    template <typename out_pipe, uindex_t vector_width = 1>
+    sycl::event submit_write(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                             KernelCountersBuffer counters) {
+        return submit_write_kernel<out_pipe, vector_width, true>(queue, column_begin, column_end,
+                                                                 counters);
+    }
+
+  private:
+    /**
+     * \brief Submit the kernel of \ref submit_read, with or without counters.
+     */
+    template <typename in_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_read_kernel(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                   std::optional<KernelCountersBuffer> counters) {
+        if (column_begin > column_end || column_end > grid_width) {
+            throw std::range_error("The column range exceeds the grid.");
+        }
+        if constexpr (vector_width > 1) {
+            return submit_vector_read<in_pipe, vector_width, instrumented>(queue, column_begin,
+                                                                           column_end, counters);
+        } else {
+            return queue.submit([&](sycl::handler &cgh) {
+                sycl::accessor ac(tile_buffer, cgh, sycl::read_only);
+                auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+                uindex_t first_cell = column_begin * grid_height;
+                uindex_t n_cells = (column_end - column_begin) * grid_height;
+
+                cgh.single_task([=]() {
+                    KernelCounterRecorder<instrumented> recorder;
+                    IOWord cache;
+
+                    uindex_t word_i = first_cell / word_length;
+                    uindex_t cell_i = first_cell % word_length;
+                    if (n_cells != 0) {
+                        cache = ac[word_i];
+                    }
+                    for (uindex_t i = 0; i < n_cells; i++) {
+                        if (cell_i == word_length) {
+                            word_i++;
+                            cache = ac[word_i];
+                            cell_i = 0;
+                        }
+                        recorder.template write<in_pipe>(unpack_cell(cache, cell_i));
+                        cell_i++;
+                    }
+                    recorder.store(counters_ac, n_cells, n_cells);
+                });
+            });
+        }
+    }
+
+    /**
+     * \brief Submit the kernel of \ref submit_write, with or without counters.
+     */
+    template <typename out_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_write_kernel(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                    std::optional<KernelCountersBuffer> counters) {
+        if (column_begin > column_end || column_end > grid_width) {
+            throw std::range_error("The column range exceeds the grid.");
+        }
+        uindex_t alignment = get_column_alignment();
+        if (column_begin % alignment != 0 ||
+            (column_end != grid_width && column_end % alignment != 0)) {
+            throw std::invalid_argument("The column range isn't aligned to memory words.");
+        }
+        if constexpr (vector_width > 1) {
+            return submit_vector_write<out_pipe, vector_width, instrumented>(queue, column_begin,
+                                                                             column_end, counters);
+        } else {
+            return queue.submit([&](sycl::handler &cgh) {
+                sycl::accessor ac(tile_buffer, cgh, sycl::write_only);
+                auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+                uindex_t first_cell = column_begin * grid_height;
+                uindex_t n_cells = (column_end - column_begin) * grid_height;
+
+                cgh.single_task([=]() {
+                    KernelCounterRecorder<instrumented> recorder;
+                    IOWord cache = {};
+
+                    uindex_t word_i = first_cell / word_length;
+                    uindex_t cell_i = 0;
+                    for (uindex_t i = 0; i < n_cells; i++) {
+                        pack_cell(cache, cell_i, recorder.template read<out_pipe>());
+                        cell_i++;
+                        if (cell_i == word_length || i == n_cells - 1) {
+                            ac[word_i] = cache;
+                            cell_i = 0;
+                            word_i++;
+                        }
+                    }
+                    recorder.store(counters_ac, n_cells, n_cells);
+                });
+            });
+        }
+    }
+
+    /**
+     * \brief Submit a kernel that sends the cells of a column range into a pipe, `vector_width`
+     * cells at a time. See \ref submit_read.
+     */
+    template <typename in_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_vector_read(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                   std::optional<KernelCountersBuffer> counters) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac(tile_buffer, cgh, sycl::read_only);
+            auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+            uindex_t grid_height = this->grid_height;
+            uindex_t n_vectors =
+                (column_end - column_begin) * n_cells_to_n_words(grid_height, vector_width);
+
+            cgh.single_task([=]() {
+                KernelCounterRecorder<instrumented> recorder;
+                uindex_t c = column_begin;
+                uindex_t r = 0;
+                for (uindex_t i = 0; i < n_vectors; i++) {
+                    std::array<Cell, vector_width> vector;
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        uindex_t cell_i = c * grid_height + r + i_cell;
+                        if (r + i_cell < grid_height) {
+                            vector[i_cell] =
+                                unpack_cell(ac[cell_i / word_length], cell_i % word_length);
+                        } else {
+                            vector[i_cell] = Cell();
+                        }
+                    }
+                    recorder.template write<in_pipe>(vector);
+
+                    r += vector_width;
+                    if (r >= grid_height) {
+                        r = 0;
+                        c++;
+                    }
+                }
+                recorder.store(counters_ac, n_vectors, (column_end - column_begin) * grid_height);
+            });
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that receives the cells of a column range from the pipe,
+     * `vector_width` cells at a time, and writes them to the grid. See \ref submit_write.
+     */
+    template <typename out_pipe, uindex_t vector_width, bool instrumented>
+    sycl::event submit_vector_write(sycl::queue queue, uindex_t column_begin, uindex_t column_end,
+                                    std::optional<KernelCountersBuffer> counters) {
+        return queue.submit([&](sycl::handler &cgh) {
+            // Vectors don't necessarily end at byte boundaries, so the bytes are updated in place.
+            sycl::accessor ac(tile_buffer, cgh, sycl::read_write);
+            auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+            uindex_t grid_height = this->grid_height;
+            uindex_t n_vectors =
+                (column_end - column_begin) * n_cells_to_n_words(grid_height, vector_width);
+
+            cgh.single_task([=]() {
+                KernelCounterRecorder<instrumented> recorder;
+                uindex_t c = column_begin;
+                uindex_t r = 0;
+                for (uindex_t i = 0; i < n_vectors; i++) {
+                    std::array<Cell, vector_width> vector =
+                        recorder.template read<out_pipe>();
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        uindex_t cell_i = c * grid_height + r + i_cell;
+                        if (r + i_cell < grid_height) {
+                            pack_cell(ac[cell_i / word_length], cell_i % word_length,
+                                      vector[i_cell]);
+                        }
+                    }
+
+                    r += vector_width;
+                    if (r >= grid_height) {
+                        r = 0;
+                        c++;
+                    }
+                }
+                recorder.store(counters_ac, n_vectors, (column_end - column_begin) * grid_height);
+            });
+        });
+    }
+
     sycl::buffer<IOWord, 1> tile_buffer;
     uindex_t grid_width, grid_height;
+    // Only used to count the references to the grid data, see get_n_references().
+    std::shared_ptr<char> references = std::make_shared<char>();
 };
 } // namespace monotile
 } // namespace stencil
\ No newline at end of file
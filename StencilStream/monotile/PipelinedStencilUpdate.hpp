@@ -0,0 +1,431 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../Concepts.hpp"
+#include "../GridPool.hpp"
+#include "../Index.hpp"
+#include "../tdv/SinglePassStrategies.hpp"
+#include "Grid.hpp"
+#include "StencilUpdate.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace stencil {
+namespace monotile {
+
+/**
+ * \brief A grid updater that chains the processing elements of multiple devices.
+ *
+ * One device only fits a limited number of processing elements. If multiple devices with the same
+ * bitstream are available, this updater arranges them in a pipeline: In every pass, the first
+ * device computes the first `n_processing_elements` subiterations, the second device computes the
+ * next `n_processing_elements` subiterations of the result of the first device, and so on.
+ * Therefore, the effective number of processing elements is the number of devices times
+ * `n_processing_elements`, without synthesizing a bigger design.
+ *
+ * The devices exchange the grid in chunks of \ref Params::chunk_width columns, which are staged in
+ * SYCL buffers. This way, a device may start with the first chunk as soon as its predecessor has
+ * finished all chunks that this chunk depends on, and the devices work on different chunks at the
+ * same time. Like the compute units of \ref StencilUpdate, every chunk is computed with the
+ * neighbouring `n_processing_elements * stencil_radius` columns on every side, so small chunks
+ * increase the amount of redundant work.
+ *
+ * Devices may appear multiple times in the pipeline. In this case, the stages on this device share
+ * one set of queues and are executed one after another.
+ *
+ * Static values, reductions and boundary conditions other than the constant one are not
+ * supported.
+ *
+ * \tparam F The transition function to apply.
+ *
+ * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs) to
+ * implement on every device. See \ref StencilUpdate.
+ *
+ * \tparam max_grid_width (Optimization parameter) The maximally supported grid width. See \ref
+ * StencilUpdate.
+ *
+ * \tparam max_grid_height (Optimization parameter) The maximally supported grid height. See \ref
+ * StencilUpdate.
+ *
+ * \tparam TDVStrategy (Optimization parameter) The precomputation strategy for the time-dependent
+ * value system.
+ *
+ * \tparam word_size (Optimization parameter) The width of the global memory channel, in bytes.
+ *
+ * \tparam dense_storage (Optimization parameter) Store cells densely packed in global memory and
+ * on-chip caches. See \ref StencilUpdate.
+ */
+template <concepts::TransitionFunction F, uindex_t n_processing_elements = 1,
+          uindex_t max_grid_width = 1024, uindex_t max_grid_height = 1024,
+          tdv::single_pass::Strategy<F, n_processing_elements> TDVStrategy =
+              tdv::single_pass::InlineStrategy,
+          uindex_t word_size = 64, bool dense_storage = false>
+    requires(!has_static_values<F> && !has_history<F> &&
+             boundary_condition_of<F> == BoundaryCondition::Constant)
+class PipelinedStencilUpdate {
+  private:
+    using Cell = F::Cell;
+
+    static constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+    static constexpr uindex_t halo_width = F::stencil_radius * n_processing_elements;
+
+    using TDVGlobalState = TDVStrategy::template GlobalState<F, iters_per_pass>;
+    using TDVKernelArgument = typename TDVGlobalState::KernelArgument;
+
+  public:
+    /// \brief Shorthand for the used and supported grid type.
+    using GridImpl = Grid<Cell, word_size, dense_storage>;
+
+    /**
+     * \brief Parameters for the pipelined stencil updater.
+     */
+    struct Params {
+        /**
+         * \brief An instance of the transition function type.
+         */
+        F transition_function;
+
+        /**
+         *  \brief The cell value to present for cells outside of the grid.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The first device of the pipeline.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief The following devices of the pipeline, in the order of the stages.
+         *
+         * If this is empty, the updater works like a \ref StencilUpdate on one device.
+         */
+        std::vector<sycl::device> downstream_devices = {};
+
+        /**
+         * \brief The number of columns in a chunk that is exchanged between the devices.
+         *
+         * This is rounded up to a multiple of the column alignment of the grid. Smaller chunks let
+         * the devices start earlier, while bigger chunks reduce the redundant work at the chunk
+         * edges.
+         */
+        uindex_t chunk_width = 256;
+
+        /**
+         * \brief Should the stencil updater block until completion, or return immediately after all
+         * kernels have been submitted.
+         */
+        bool blocking = false;
+
+        /**
+         * \brief The contents of the constant table of the transition function.
+         *
+         * This is only used if the transition function defines a \ref stencil::ConstantTable
+         * "constant table". The table is copied to the device once per kernel and shared by all
+         * processing elements.
+         */
+        ConstantTableOf<F> constant_table = ConstantTableOf<F>();
+    };
+
+    /**
+     * \brief Create a new pipelined stencil updater object.
+     */
+    PipelinedStencilUpdate(Params params)
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()), n_processed_cells(0),
+          walltime(0.0) {}
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return the pool from which the updater requests its target grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the number of devices in the pipeline.
+     */
+    uindex_t get_n_devices() const { return 1 + params.downstream_devices.size(); }
+
+    /**
+     * \brief Compute a new grid based on the source grid, using the configured transition function.
+     *
+     * The source grid is not altered. The target grid is requested from the grid pool, while the
+     * chunks between the stages are stored in grids of the updater that are reused by later
+     * calls.
+     *
+     * \throws std::invalid_argument The chunk width is zero.
+     *
+     * \throws std::range_error The grid is too big for the execution kernel.
+     */
+    GridImpl operator()(GridImpl &source_grid) {
+        uindex_t grid_width = source_grid.get_grid_width();
+        uindex_t grid_height = source_grid.get_grid_height();
+        if (grid_height > max_grid_height) {
+            throw std::range_error("The grid is too tall for the stencil update kernel.");
+        }
+        if (grid_width > max_grid_width) {
+            throw std::range_error("The grid is too wide for the stencil update kernel.");
+        }
+        if (params.chunk_width == 0) {
+            throw std::invalid_argument("The chunk width must be positive.");
+        }
+        if (params.n_iterations == 0) {
+            return GridImpl(source_grid);
+        }
+
+        using in_pipe = sycl::pipe<class monotile_pipelined_in_pipe, Cell>;
+        using out_pipe = sycl::pipe<class monotile_pipelined_out_pipe, Cell>;
+        using ExecutionKernelImpl =
+            StencilUpdateKernel<F, TDVKernelArgument, n_processing_elements, max_grid_width,
+                                max_grid_height, in_pipe, out_pipe, dense_storage>;
+
+        prepare_queues();
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        std::vector<Chunk> chunks = partition_columns(source_grid);
+        prepare_chunk_grids(chunks, grid_height);
+        GridImpl target_grid = grid_pool->acquire(source_grid);
+
+        F trans_func(params.transition_function);
+        TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
+
+        // Every stage is one pass of one device. Between the stages, the chunks are alternately
+        // stored in the two sets of chunk grids.
+        uindex_t n_stages = n_cells_to_n_words(params.n_iterations, iters_per_pass);
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i_stage = 0; i_stage < n_stages; i_stage++) {
+            uindex_t i = params.iteration_offset + i_stage * iters_per_pass;
+            uindex_t iters_in_this_stage = std::min(iters_per_pass, target_n_iterations - i);
+            DeviceQueues &queues = device_queues[stage_queues[i_stage % stage_queues.size()]];
+            std::vector<GridImpl> &stage_sources = chunk_grids[i_stage % 2];
+            std::vector<GridImpl> &stage_targets = chunk_grids[(i_stage + 1) % 2];
+
+            for (uindex_t i_chunk = 0; i_chunk < chunks.size(); i_chunk++) {
+                Chunk chunk = chunks[i_chunk];
+                if (i_stage == 0) {
+                    source_grid.template submit_read<in_pipe>(*queues.input_kernel_queue,
+                                                              chunk.begin, chunk.end);
+                } else {
+                    // Collect the columns of the chunk and its neighbourhood from the chunks of
+                    // the previous stage.
+                    for (uindex_t i_other = 0; i_other < chunks.size(); i_other++) {
+                        uindex_t begin = std::max(chunk.begin, chunks[i_other].core_begin);
+                        uindex_t end = std::min(chunk.end, chunks[i_other].core_end);
+                        if (begin < end) {
+                            stage_sources[i_other].template submit_read<in_pipe>(
+                                *queues.input_kernel_queue, begin - chunks[i_other].core_begin,
+                                end - chunks[i_other].core_begin);
+                        }
+                    }
+                }
+
+                queues.update_kernel_queue->submit([&](sycl::handler &cgh) {
+                    TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i,
+                                                          iters_in_this_stage);
+                    ExecutionKernelImpl exec_kernel(trans_func, i, target_n_iterations, grid_width,
+                                                    grid_height, params.halo_value,
+                                                    tdv_kernel_argument, chunk.begin, chunk.end,
+                                                    chunk.core_begin, chunk.core_end);
+                    exec_kernel.set_constant_table(params.constant_table);
+                    cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+                });
+
+                if (i_stage == n_stages - 1) {
+                    target_grid.template submit_write<out_pipe>(
+                        *queues.output_kernel_queue, chunk.core_begin, chunk.core_end);
+                } else {
+                    stage_targets[i_chunk].template submit_write<out_pipe>(
+                        *queues.output_kernel_queue);
+                }
+            }
+        }
+
+        if (params.blocking) {
+            for (DeviceQueues &queues : device_queues) {
+                queues.output_kernel_queue->wait();
+            }
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+
+        n_processed_cells += params.n_iterations * grid_width * grid_height;
+
+        return target_grid;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the width times the height of the grid, times
+     * the number of computed iterations. The redundant work at the chunk edges isn't counted.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     */
+    double get_walltime() const { return walltime; }
+
+  private:
+    /**
+     * \brief The columns that are read and written for a chunk.
+     */
+    struct Chunk {
+        /// \brief The first column of the chunk.
+        uindex_t core_begin;
+        /// \brief One past the last column of the chunk.
+        uindex_t core_end;
+        /// \brief The first column that is read to compute the chunk.
+        uindex_t begin;
+        /// \brief One past the last column that is read to compute the chunk.
+        uindex_t end;
+    };
+
+    /**
+     * \brief The queues of one device.
+     */
+    struct DeviceQueues {
+        std::optional<sycl::queue> input_kernel_queue;
+        std::optional<sycl::queue> update_kernel_queue;
+        std::optional<sycl::queue> output_kernel_queue;
+    };
+
+    /**
+     * \brief Split the columns of the grid into chunks.
+     *
+     * The chunk width is rounded up to the column alignment of the grid, so that the last stage
+     * may write the chunks directly into the target grid.
+     */
+    std::vector<Chunk> partition_columns(GridImpl const &grid) const {
+        uindex_t grid_width = grid.get_grid_width();
+        uindex_t alignment = grid.get_column_alignment();
+        uindex_t chunk_width = n_cells_to_n_words(params.chunk_width, alignment) * alignment;
+
+        std::vector<Chunk> chunks;
+        for (uindex_t core_begin = 0; core_begin < grid_width; core_begin += chunk_width) {
+            uindex_t core_end = std::min(grid_width, core_begin + chunk_width);
+            chunks.push_back({
+                .core_begin = core_begin,
+                .core_end = core_end,
+                .begin = core_begin - std::min(core_begin, halo_width),
+                .end = std::min(grid_width, core_end + halo_width),
+            });
+        }
+        return chunks;
+    }
+
+    /**
+     * \brief Allocate the grids for the chunks between the stages, or reuse the ones of the
+     * previous call if they fit.
+     */
+    void prepare_chunk_grids(std::vector<Chunk> const &chunks, uindex_t grid_height) {
+        bool chunk_grids_fit = chunk_grids[0].size() == chunks.size();
+        for (uindex_t i_chunk = 0; chunk_grids_fit && i_chunk < chunks.size(); i_chunk++) {
+            for (std::vector<GridImpl> &grids : chunk_grids) {
+                chunk_grids_fit &= grids[i_chunk].get_grid_width() ==
+                                       chunks[i_chunk].core_end - chunks[i_chunk].core_begin &&
+                                   grids[i_chunk].get_grid_height() == grid_height;
+            }
+        }
+        if (chunk_grids_fit) {
+            return;
+        }
+        for (std::vector<GridImpl> &grids : chunk_grids) {
+            grids.clear();
+            for (Chunk const &chunk : chunks) {
+                grids.push_back(GridImpl(chunk.core_end - chunk.core_begin, grid_height));
+            }
+        }
+    }
+
+    /**
+     * \brief Create the queues of the updater if necessary.
+     *
+     * Every distinct device of the pipeline receives one set of queues. The queues are only
+     * rebuilt if the devices have changed since the last call.
+     */
+    void prepare_queues() {
+        std::vector<sycl::device> devices = {params.device};
+        devices.insert(devices.end(), params.downstream_devices.begin(),
+                       params.downstream_devices.end());
+        if (devices == pipeline_devices) {
+            return;
+        }
+        pipeline_devices = devices;
+
+        std::vector<sycl::device> queue_devices;
+        device_queues.clear();
+        stage_queues.clear();
+        for (sycl::device const &device : devices) {
+            auto found = std::find(queue_devices.begin(), queue_devices.end(), device);
+            stage_queues.push_back(found - queue_devices.begin());
+            if (found != queue_devices.end()) {
+                continue;
+            }
+            queue_devices.push_back(device);
+            device_queues.push_back({
+                .input_kernel_queue = sycl::queue(device, {sycl::property::queue::in_order{}}),
+                .update_kernel_queue = sycl::queue(device, {sycl::property::queue::in_order{}}),
+                .output_kernel_queue = sycl::queue(device, {sycl::property::queue::in_order{}}),
+            });
+        }
+    }
+
+    Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::array<std::vector<GridImpl>, 2> chunk_grids;
+    std::vector<sycl::device> pipeline_devices;
+    std::vector<DeviceQueues> device_queues;
+    std::vector<uindex_t> stage_queues;
+    uindex_t n_processed_cells;
+    double walltime;
+};
+
+} // namespace monotile
+} // namespace stencil
@@ -18,14 +18,28 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #pragma once
+#include "../BoundaryCondition.hpp"
 #include "../Concepts.hpp"
 #include "../GenericID.hpp"
+#include "../GridPool.hpp"
 #include "../Helpers.hpp"
+#include "../HistoryTransitionFunction.hpp"
+#include "../HostStream.hpp"
 #include "../Index.hpp"
+#include "../KernelCounters.hpp"
+#include "../Reduction.hpp"
+#include "../StaticValues.hpp"
+#include "../Timeline.hpp"
 #include "../tdv/SinglePassStrategies.hpp"
 #include "Grid.hpp"
+#include <array>
 #include <chrono>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace stencil {
 namespace monotile {
@@ -57,41 +71,169 @@ namespace monotile {
  * \tparam in_pipe The pipe to read from.
  *
  * \tparam out_pipe The pipe to write to.
+ *
+ * \tparam dense_storage If true, the cells in the cache are densely packed instead of being padded
+ * to the next power of two. See \ref CellStorage.
+ *
+ * \tparam on_chip_loopback If true, the kernel computes all iterations up to the target iteration
+ * in one invocation. The grid is only read from the `in_pipe` in the first pass and only written
+ * to the `out_pipe` in the last pass. In between, the kernel keeps the grid in an on-chip buffer of
+ * `max_grid_width * max_grid_height` cells. This requires a TDV kernel argument that fulfills \ref
+ * tdv::single_pass::MultiPassKernelArgument and that has been constructed for all iterations.
+ *
+ * \tparam vector_width The number of vertically adjacent cells that every processing element
+ * updates per clock cycle. The pipes transfer \ref CellVector "CellVectors" of this width, which
+ * contain the cells of one column in column-major order. If the grid height isn't a multiple of the
+ * vector width, the last vector of every column is padded with arbitrary cells, which are treated
+ * like halo cells and whose results should be discarded.
+ *
+ * \tparam instrumented If true, the kernel records its \ref KernelCounters and adds them to the
+ * buffer that is set with \ref set_counters. The active cycles are the loop iterations of all
+ * passes and the moved cells are the output cells.
+ *
+ * \tparam fixed_grid_range If true, the grid always has exactly `max_grid_width` columns and
+ * `max_grid_height` rows and the kernel always processes the whole grid. The grid size and the
+ * trip count of the main loop are compile-time constants then, so that the halo checks compare the
+ * counters with constants and no logic for other grid sizes is synthesized. The runtime grid size
+ * of the constructors has to match.
+ *
+ * \tparam boundary_condition The values of the cells outside of the grid. Only the constant, clamp
+ * and reflect boundary conditions are supported. The latter two are evaluated while the stencils
+ * are filled from the stencil buffer, by reading the clamped or reflected cells from other
+ * positions of the same buffer. With the constant boundary condition, the stencils are filled
+ * without any index remapping.
+ *
+ * If the transition function is a \ref HistoryTransitionFunction, the pipes transfer its bundles,
+ * but the stencil buffers and the cache only hold the wrapped cells. The past levels of the input
+ * vector of a processing element are delayed until the vector is in the center of the stencil
+ * buffer, where they are passed to the wrapped transition function and advanced.
  */
 template <concepts::TransitionFunction TransFunc,
           tdv::single_pass::KernelArgument<TransFunc> TDVKernelArgument,
           uindex_t n_processing_elements, uindex_t max_grid_width, uindex_t max_grid_height,
-          typename in_pipe, typename out_pipe>
-    requires(n_processing_elements % TransFunc::n_subiterations == 0)
+          typename in_pipe, typename out_pipe, bool dense_storage = false,
+          bool on_chip_loopback = false, uindex_t vector_width = 1, bool instrumented = false,
+          bool fixed_grid_range = false,
+          BoundaryCondition boundary_condition = BoundaryCondition::Constant>
+    requires(n_processing_elements % TransFunc::n_subiterations == 0) &&
+            (!on_chip_loopback ||
+             tdv::single_pass::MultiPassKernelArgument<TDVKernelArgument, TransFunc>) &&
+            (vector_width >= 1) && (boundary_condition != BoundaryCondition::Periodic)
 class StencilUpdateKernel {
   private:
     using Cell = typename TransFunc::Cell;
     using TDV = typename TransFunc::TimeDependentValue;
     using TDVLocalState = typename TDVKernelArgument::LocalState;
-    using StencilImpl = Stencil<Cell, TransFunc::stencil_radius, TDV>;
+    using ConstantTable = ConstantTableOf<TransFunc>;
+    using History = KernelHistory<TransFunc>;
+    using BufferCell = typename History::Cell;
+    using StencilImpl = Stencil<BufferCell, TransFunc::stencil_radius, TDV, std::monostate,
+                                ConstantTable, typename History::History>;
+    using CellVectorImpl = std::array<Cell, vector_width>;
+    using CellVectorStorage = std::array<CellStorage<Cell, dense_storage>, vector_width>;
+    using BufferVectorImpl = std::array<BufferCell, vector_width>;
+    using BufferVectorStorage = std::array<CellStorage<BufferCell, dense_storage>, vector_width>;
+    using LevelsVector = std::array<typename History::Levels, vector_width>;
 
     /**
      * \brief The width and height of the stencil buffer.
      */
     static constexpr uindex_t stencil_diameter = StencilImpl::diameter;
 
+    /**
+     * \brief The cells of the stencil that are actually read by the transition function.
+     */
+    static constexpr StencilShape stencil_shape = stencil_shape_of<TransFunc>;
+
+    /**
+     * \brief The first stencil buffer column that contains cells in the stencil shape, or that a
+     * cell in the shape is reflected from.
+     *
+     * The columns west of it are never read, so they are neither loaded from nor stored to the
+     * cache. At the eastern border, the reflected eastern cells of the shape are read from up to
+     * `stencil_shape.east - 1` columns west of the central cell, so these columns are kept too.
+     */
+    static constexpr uindex_t first_live_column =
+        TransFunc::stencil_radius -
+        ((boundary_condition == BoundaryCondition::Reflect)
+             ? std::max(stencil_shape.west, stencil_shape.east)
+             : stencil_shape.west);
+
+    /**
+     * \brief The number of vectors above and below the central vector that are needed to update
+     * it.
+     */
+    static constexpr uindex_t vector_radius =
+        n_cells_to_n_words(TransFunc::stencil_radius, vector_width);
+
+    /**
+     * \brief The number of cell rows in the stencil buffer.
+     */
+    static constexpr uindex_t stencil_buffer_height = (2 * vector_radius + 1) * vector_width;
+
+    static constexpr uindex_t max_vector_height =
+        n_cells_to_n_words(max_grid_height, vector_width);
+
     static constexpr uindex_t iters_per_pass = n_processing_elements / TransFunc::n_subiterations;
 
-    static constexpr uindex_t calc_pipeline_latency(uindex_t grid_height) {
-        return n_processing_elements * TransFunc::stencil_radius * (grid_height + 1);
+    /**
+     * \brief The number of entries in the history delay line of every processing element.
+     *
+     * A vector reaches the center of the stencil buffer `stencil_radius` columns and
+     * `vector_radius` vectors after it has entered it. Without a history, there are no delay
+     * lines.
+     */
+    static constexpr uindex_t max_history_delay =
+        History::enabled ? TransFunc::stencil_radius * max_vector_height + vector_radius : 1;
+
+  public:
+    /**
+     * \brief Return the number of processing elements that compute in a pass.
+     *
+     * A pass that only has to compute the last few iterations of an update leaves the trailing
+     * processing elements idle. Those let the vectors bypass them, so the stream already leaves
+     * the pipeline after the last active processing element.
+     *
+     * \param n_remaining_iterations The number of iterations that are still to be computed when
+     * the pass starts.
+     */
+    static constexpr uindex_t calc_n_active_processing_elements(uindex_t n_remaining_iterations) {
+        return std::min(n_processing_elements, n_remaining_iterations * TransFunc::n_subiterations);
+    }
+
+    /**
+     * \brief Return the number of loop iterations between reading a vector and writing its
+     * updated version.
+     *
+     * Every active processing element lags behind its predecessor by the stencil radius in
+     * columns.
+     */
+    static constexpr uindex_t
+    calc_pipeline_latency(uindex_t vector_height,
+                          uindex_t n_active_processing_elements = n_processing_elements) {
+        return n_active_processing_elements *
+               (TransFunc::stencil_radius * vector_height + vector_radius);
     }
 
-    static constexpr uindex_t calc_n_iterations(uindex_t grid_width, uindex_t grid_height) {
-        return grid_width * grid_height + calc_pipeline_latency(grid_height);
+    /**
+     * \brief Return the number of loop iterations of one pass over a strip with the given width
+     * and height in vectors.
+     */
+    static constexpr uindex_t
+    calc_n_iterations(uindex_t grid_width, uindex_t vector_height,
+                      uindex_t n_active_processing_elements = n_processing_elements) {
+        return grid_width * vector_height +
+               calc_pipeline_latency(vector_height, n_active_processing_elements);
     }
 
+  private:
     using index_stencil_t = typename StencilImpl::index_stencil_t;
     using uindex_stencil_t = typename StencilImpl::uindex_stencil_t;
     using StencilID = typename StencilImpl::StencilID;
     using StencilUID = typename StencilImpl::StencilUID;
 
     static constexpr unsigned long bits_1d =
-        std::bit_width(std::max(max_grid_width, max_grid_height));
+        std::bit_width(std::max(max_grid_width, max_vector_height * vector_width));
     using index_1d_t = ac_int<bits_1d + 1, true>;
     using uindex_1d_t = ac_int<bits_1d, false>;
 
@@ -105,7 +247,7 @@ class StencilUpdateKernel {
     using uindex_pes_t = ac_int<bits_pes, false>;
 
     static constexpr unsigned long bits_n_iterations =
-        std::bit_width(calc_n_iterations(max_grid_width, max_grid_height));
+        std::bit_width(calc_n_iterations(max_grid_width, max_vector_height));
     using index_n_iterations_t = ac_int<bits_n_iterations + 1, true>;
     using uindex_n_iterations_t = ac_int<bits_n_iterations, false>;
 
@@ -133,29 +275,184 @@ class StencilUpdateKernel {
     StencilUpdateKernel(TransFunc trans_func, uindex_t i_iteration, uindex_t target_i_iteration,
                         uindex_t grid_width, uindex_t grid_height, Cell halo_value,
                         TDVKernelArgument tdv_kernel_argument)
+        : StencilUpdateKernel(trans_func, i_iteration, target_i_iteration, grid_width, grid_height,
+                              halo_value, tdv_kernel_argument, 0, grid_width, 0, grid_width) {}
+
+    /**
+     * \brief Create and configure an execution kernel that only processes a strip of columns.
+     *
+     * The kernel receives the columns `strip_begin` to `strip_end - 1` of the grid and only
+     * writes the columns `core_begin` to `core_end - 1` to the `out_pipe`. Cell positions and
+     * halo checks still refer to the whole grid. The columns at the edges of the strip that
+     * aren't grid edges are computed with incomplete inputs, so the strip needs to contain at
+     * least `n_processing_elements * stencil_radius` columns more than the core on every such
+     * edge.
+     *
+     * The other parameters are the same as for the other constructor.
+     */
+    StencilUpdateKernel(TransFunc trans_func, uindex_t i_iteration, uindex_t target_i_iteration,
+                        uindex_t grid_width, uindex_t grid_height, Cell halo_value,
+                        TDVKernelArgument tdv_kernel_argument, uindex_t strip_begin,
+                        uindex_t strip_end, uindex_t core_begin, uindex_t core_end)
         : trans_func(trans_func), i_iteration(i_iteration), target_i_iteration(target_i_iteration),
-          grid_width(grid_width), grid_height(grid_height), halo_value(halo_value),
-          tdv_kernel_argument(tdv_kernel_argument) {
+          grid_width(grid_width), grid_height(grid_height),
+          vector_height(n_cells_to_n_words(grid_height, vector_width)), strip_begin(strip_begin),
+          strip_width(strip_end - strip_begin), core_begin(core_begin), core_end(core_end),
+          halo_value(halo_value), tdv_kernel_argument(tdv_kernel_argument), constant_table() {
         assert(grid_height <= max_grid_height);
+        assert(strip_begin <= core_begin && core_begin <= core_end && core_end <= strip_end);
+        assert(!fixed_grid_range ||
+               (grid_width == max_grid_width && grid_height == max_grid_height &&
+                strip_begin == 0 && strip_end == grid_width && core_begin == 0 &&
+                core_end == grid_width));
+    }
+
+    /**
+     * \brief Set the contents of the constant table of the transition function.
+     *
+     * The kernel copies the table into its on-chip memory once and all processing elements read
+     * from this single copy.
+     */
+    void set_constant_table(ConstantTable const &constant_table) {
+        this->constant_table = constant_table;
+    }
+
+    /**
+     * \brief Set the accessor to the buffer that the kernel adds its counters to.
+     */
+    void set_counters(KernelCountersArgument<instrumented> counters)
+        requires(instrumented)
+    {
+        this->counters = counters;
     }
 
     /**
      * \brief Execute the kernel.
      */
     void operator()() const {
+        [[intel::fpga_memory]] ConstantTable local_constant_table = constant_table;
+        KernelCounterRecorder<instrumented> recorder;
+        uint64_t n_cycles = 0;
+
+        if constexpr (on_chip_loopback) {
+            [[intel::fpga_memory]] CellVectorStorage
+                grid_buffer[max_grid_width * max_vector_height];
+
+            uindex_t n_passes =
+                n_cells_to_n_words(target_i_iteration - i_iteration, iters_per_pass);
+            for (uindex_t i_pass = 0; i_pass < n_passes; i_pass++) {
+                TDVLocalState tdv_local_state(tdv_kernel_argument, i_pass * iters_per_pass);
+                bool first_pass = i_pass == 0;
+                bool last_pass = i_pass == n_passes - 1;
+
+                // The output of a pass lags behind its input, so every vector of the buffer has
+                // already been read when it's overwritten.
+                n_cycles += run_pass(
+                    i_iteration + i_pass * iters_per_pass, tdv_local_state, local_constant_table,
+                    [&](uindex_t i_vector) {
+                        if (first_pass) {
+                            return read_vector(recorder);
+                        }
+                        CellVectorImpl vector;
+#pragma unroll
+                        for (uindex_t i = 0; i < vector_width; i++) {
+                            vector[i] = grid_buffer[i_vector][i].value;
+                        }
+                        return vector;
+                    },
+                    [&](uindex_t i_vector, CellVectorImpl const &vector) {
+                        if (last_pass) {
+                            write_vector(recorder, vector);
+                        } else {
+#pragma unroll
+                            for (uindex_t i = 0; i < vector_width; i++) {
+                                grid_buffer[i_vector][i].value = vector[i];
+                            }
+                        }
+                    });
+            }
+        } else {
+            TDVLocalState tdv_local_state(tdv_kernel_argument);
+            n_cycles = run_pass(
+                i_iteration, tdv_local_state, local_constant_table,
+                [&](uindex_t i_vector) { return read_vector(recorder); },
+                [&](uindex_t i_vector, CellVectorImpl const &vector) {
+                    write_vector(recorder, vector);
+                });
+        }
+        recorder.store(counters, n_cycles, (get_core_end() - get_core_begin()) * get_grid_height());
+    }
+
+  private:
+    /*
+     * The grid and strip dimensions. With a fixed grid range, they are compile-time constants, so
+     * that all dependent computations and comparisons are folded.
+     */
+    uindex_t get_grid_width() const { return fixed_grid_range ? max_grid_width : grid_width; }
+
+    uindex_t get_grid_height() const { return fixed_grid_range ? max_grid_height : grid_height; }
+
+    uindex_t get_vector_height() const {
+        return fixed_grid_range ? max_vector_height : vector_height;
+    }
+
+    uindex_t get_strip_begin() const { return fixed_grid_range ? 0 : strip_begin; }
+
+    uindex_t get_strip_width() const { return fixed_grid_range ? max_grid_width : strip_width; }
+
+    uindex_t get_core_begin() const { return fixed_grid_range ? 0 : core_begin; }
+
+    uindex_t get_core_end() const { return fixed_grid_range ? max_grid_width : core_end; }
+
+    static CellVectorImpl read_vector(KernelCounterRecorder<instrumented> &recorder) {
+        if constexpr (vector_width == 1) {
+            return CellVectorImpl{recorder.template read<in_pipe>()};
+        } else {
+            return recorder.template read<in_pipe>();
+        }
+    }
+
+    static void write_vector(KernelCounterRecorder<instrumented> &recorder,
+                             CellVectorImpl const &vector) {
+        if constexpr (vector_width == 1) {
+            recorder.template write<out_pipe>(vector[0]);
+        } else {
+            recorder.template write<out_pipe>(vector);
+        }
+    }
+
+    /**
+     * \brief Compute one pass over the grid.
+     *
+     * \param pass_i_iteration The iteration index of the input cells of this pass.
+     *
+     * \param tdv_local_state The TDV local state of this pass.
+     *
+     * \param constant_table The on-chip copy of the constant table.
+     *
+     * \param read_vector A function that returns the input vector with the given index.
+     *
+     * \param write_vector A function that receives the index and the value of an output vector.
+     *
+     * \return The number of loop iterations of the pass.
+     */
+    template <typename ReadVector, typename WriteVector>
+    uindex_t run_pass(uindex_t pass_i_iteration, TDVLocalState const &tdv_local_state,
+                  ConstantTable const &constant_table, ReadVector read_vector,
+                  WriteVector write_vector) const {
+        // The column and vector row counters of the processing elements.
         [[intel::fpga_register]] index_1d_t c[n_processing_elements];
         [[intel::fpga_register]] index_1d_t r[n_processing_elements];
-        TDVLocalState tdv_local_state(tdv_kernel_argument);
 
         // Initializing (output) column and row counters.
-        index_1d_t prev_c = 0;
+        index_1d_t prev_c = get_strip_begin();
         index_1d_t prev_r = 0;
 #pragma unroll
         for (uindex_pes_t i = 0; i < uindex_pes_t(n_processing_elements); i++) {
             c[i] = prev_c - TransFunc::stencil_radius;
-            r[i] = prev_r - TransFunc::stencil_radius;
+            r[i] = prev_r - vector_radius;
             if (r[i] < index_pes_t(0)) {
-                r[i] += grid_height;
+                r[i] += get_vector_height();
                 c[i] -= 1;
             }
             prev_c = c[i];
@@ -170,18 +467,45 @@ class StencilUpdateKernel {
          * optimizes them away.
          */
         [[intel::fpga_memory,
-          intel::numbanks(2 * std::bit_ceil(n_processing_elements))]] Padded<Cell>
-            cache[2][max_grid_height][std::bit_ceil(n_processing_elements)][stencil_diameter - 1];
-        [[intel::fpga_register]] Cell stencil_buffer[n_processing_elements][stencil_diameter]
-                                                    [stencil_diameter];
+          intel::numbanks(2 * std::bit_ceil(n_processing_elements))]]
+        BufferVectorStorage
+            cache[2][max_vector_height][std::bit_ceil(n_processing_elements)][stencil_diameter - 1];
+        [[intel::fpga_register]] BufferCell stencil_buffer[n_processing_elements][stencil_diameter]
+                                                          [stencil_buffer_height];
+
+        // The past levels of the vectors between entering the stencil buffer and reaching its
+        // center. All processing elements share the position in their delay lines.
+        [[intel::fpga_memory, intel::numbanks(std::bit_ceil(n_processing_elements))]]
+        LevelsVector history_delay_line[max_history_delay][std::bit_ceil(n_processing_elements)];
+        uindex_t history_delay = calc_pipeline_latency(get_vector_height(), 1);
+        uindex_t i_history_delay = 0;
+        BufferCell buffer_halo_value = History::get_cell(halo_value);
 
-        uindex_n_iterations_t n_iterations = calc_n_iterations(grid_width, grid_height);
+        // The position of the next vector that leaves the pipeline.
+        index_1d_t output_c = get_strip_begin();
+        index_1d_t output_r = 0;
+
+        uindex_t n_active_processing_elements =
+            calc_n_active_processing_elements(target_i_iteration - pass_i_iteration);
+        uindex_t pipeline_latency =
+            calc_pipeline_latency(get_vector_height(), n_active_processing_elements);
+        uindex_n_iterations_t n_iterations =
+            calc_n_iterations(get_strip_width(), get_vector_height(), n_active_processing_elements);
         for (uindex_n_iterations_t i = 0; i < n_iterations; i++) {
-            Cell carry;
-            if (i < uindex_n_iterations_t(grid_width * grid_height)) {
-                carry = in_pipe::read();
+            BufferVectorImpl carry;
+            LevelsVector levels_carry;
+            if (i < uindex_n_iterations_t(get_strip_width() * get_vector_height())) {
+                CellVectorImpl input = read_vector(i.to_uint());
+#pragma unroll
+                for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                    carry[i_cell] = History::get_cell(input[i_cell]);
+                    levels_carry[i_cell] = History::get_levels(input[i_cell]);
+                }
             } else {
-                carry = halo_value;
+#pragma unroll
+                for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                    carry[i_cell] = buffer_halo_value;
+                }
             }
 
 #pragma unroll
@@ -189,116 +513,213 @@ class StencilUpdateKernel {
                  i_processing_element < uindex_pes_t(n_processing_elements);
                  i_processing_element++) {
 #pragma unroll
-                for (uindex_stencil_t r = 0; r < uindex_stencil_t(stencil_diameter - 1); r++) {
+                for (uindex_t r = 0; r < stencil_buffer_height - vector_width; r++) {
 #pragma unroll
                     for (uindex_stencil_t c = 0; c < uindex_stencil_t(stencil_diameter); c++) {
                         stencil_buffer[i_processing_element][c][r] =
-                            stencil_buffer[i_processing_element][c][r + 1];
+                            stencil_buffer[i_processing_element][c][r + vector_width];
                     }
                 }
 
                 // Update the stencil buffer and cache with previous cache contents and the new
-                // input cell.
+                // input vector.
 #pragma unroll
                 for (uindex_stencil_t cache_c = 0; cache_c < uindex_stencil_t(stencil_diameter);
                      cache_c++) {
-                    Cell new_value;
+                    BufferVectorStorage new_value;
                     if (cache_c == uindex_stencil_t(stencil_diameter - 1)) {
-                        new_value = carry;
-                    } else {
+#pragma unroll
+                        for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                            new_value[i_cell].value = carry[i_cell];
+                        }
+                    } else if (cache_c >= uindex_stencil_t(first_live_column)) {
                         new_value = cache[c[i_processing_element][0]][r[i_processing_element]]
-                                         [i_processing_element][cache_c]
-                                             .value;
+                                         [i_processing_element][cache_c];
+                    } else {
+#pragma unroll
+                        for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                            new_value[i_cell].value = buffer_halo_value;
+                        }
                     }
 
-                    stencil_buffer[i_processing_element][cache_c][stencil_diameter - 1] = new_value;
-                    if (cache_c > 0) {
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        stencil_buffer[i_processing_element][cache_c]
+                                      [stencil_buffer_height - vector_width + i_cell] =
+                                          new_value[i_cell].value;
+                    }
+                    if (cache_c > uindex_stencil_t(first_live_column)) {
                         cache[(~c[i_processing_element])[0]][r[i_processing_element]]
-                             [i_processing_element][cache_c - 1]
-                                 .value = new_value;
+                             [i_processing_element][cache_c - 1] = new_value;
                     }
                 }
 
                 uindex_t pe_iteration =
-                    (i_iteration + i_processing_element / TransFunc::n_subiterations).to_uint();
+                    (pass_i_iteration + i_processing_element / TransFunc::n_subiterations)
+                        .to_uint();
                 uindex_t pe_subiteration =
                     (i_processing_element % TransFunc::n_subiterations).to_uint();
 
                 if (pe_iteration < target_i_iteration) {
                     TDV tdv = tdv_local_state.get_time_dependent_value(
                         (i_processing_element / TransFunc::n_subiterations).to_uint());
-                    StencilImpl stencil(ID(c[i_processing_element], r[i_processing_element]),
-                                        UID(grid_width, grid_height), pe_iteration, pe_subiteration,
-                                        tdv);
+
+                    // Exchange the levels of the input vector with the levels of the central
+                    // vector.
+                    if constexpr (History::enabled) {
+                        LevelsVector input_levels = levels_carry;
+                        levels_carry = history_delay_line[i_history_delay][i_processing_element];
+                        history_delay_line[i_history_delay][i_processing_element] = input_levels;
+                    }
 
                     bool h_halo_mask[stencil_diameter];
-                    bool v_halo_mask[stencil_diameter];
+                    uindex_stencil_t h_source[stencil_diameter];
 #pragma unroll
                     for (uindex_stencil_t mask_i = 0; mask_i < uindex_stencil_t(stencil_diameter);
                          mask_i++) {
+                        h_source[mask_i] = mask_i;
+                        if constexpr (boundary_condition != BoundaryCondition::Constant) {
+                            index_t offset = remap_stencil_offset<boundary_condition>(
+                                c[i_processing_element].to_int64(),
+                                index_t(mask_i) - index_t(TransFunc::stencil_radius),
+                                index_t(get_grid_width()));
+                            h_source[mask_i] =
+                                uindex_stencil_t(offset + TransFunc::stencil_radius);
+                        }
+
                         // These computation assume that the central cell is in the grid. If it's
                         // not, the resulting value of this processing element will be discarded
                         // anyways, so this is safe.
                         if (mask_i < uindex_stencil_t(TransFunc::stencil_radius)) {
                             h_halo_mask[mask_i] = c[i_processing_element] >=
                                                   index_1d_t(TransFunc::stencil_radius - mask_i);
-                            v_halo_mask[mask_i] = r[i_processing_element] >=
-                                                  index_1d_t(TransFunc::stencil_radius - mask_i);
                         } else if (mask_i == uindex_stencil_t(TransFunc::stencil_radius)) {
                             h_halo_mask[mask_i] = true;
-                            v_halo_mask[mask_i] = true;
                         } else {
                             h_halo_mask[mask_i] =
                                 c[i_processing_element] <
-                                grid_width + index_1d_t(TransFunc::stencil_radius - mask_i);
-                            v_halo_mask[mask_i] =
-                                r[i_processing_element] <
-                                grid_height + index_1d_t(TransFunc::stencil_radius - mask_i);
+                                get_grid_width() +
+                                    index_1d_t(TransFunc::stencil_radius - mask_i);
                         }
+                        h_halo_mask[mask_i] |= boundary_condition != BoundaryCondition::Constant;
                     }
 
 #pragma unroll
-                    for (uindex_stencil_t cell_c = 0; cell_c < uindex_stencil_t(stencil_diameter);
-                         cell_c++) {
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        index_1d_t cell_row = r[i_processing_element] * vector_width + i_cell;
+                        StencilImpl stencil(
+                            ID(c[i_processing_element], cell_row),
+                            UID(get_grid_width(), get_grid_height()), pe_iteration,
+                            pe_subiteration, tdv, std::monostate(), &constant_table,
+                            History::select_history(levels_carry[i_cell], pe_subiteration));
+
+                        bool v_halo_mask[stencil_diameter];
+                        uindex_stencil_t v_source[stencil_diameter];
 #pragma unroll
-                        for (uindex_stencil_t cell_r = 0;
-                             cell_r < uindex_stencil_t(stencil_diameter); cell_r++) {
-                            if (h_halo_mask[cell_c] && v_halo_mask[cell_r]) {
-                                stencil[StencilUID(cell_c, cell_r)] =
-                                    stencil_buffer[i_processing_element][cell_c][cell_r];
+                        for (uindex_stencil_t mask_i = 0;
+                             mask_i < uindex_stencil_t(stencil_diameter); mask_i++) {
+                            v_source[mask_i] = mask_i;
+                            if constexpr (boundary_condition != BoundaryCondition::Constant) {
+                                index_t offset = remap_stencil_offset<boundary_condition>(
+                                    cell_row.to_int64(),
+                                    index_t(mask_i) - index_t(TransFunc::stencil_radius),
+                                    index_t(get_grid_height()));
+                                v_source[mask_i] =
+                                    uindex_stencil_t(offset + TransFunc::stencil_radius);
+                            }
+
+                            if (mask_i < uindex_stencil_t(TransFunc::stencil_radius)) {
+                                v_halo_mask[mask_i] =
+                                    cell_row >= index_1d_t(TransFunc::stencil_radius - mask_i);
+                            } else if (mask_i == uindex_stencil_t(TransFunc::stencil_radius)) {
+                                v_halo_mask[mask_i] = true;
                             } else {
-                                stencil[StencilUID(cell_c, cell_r)] = halo_value;
+                                v_halo_mask[mask_i] =
+                                    cell_row <
+                                    get_grid_height() +
+                                        index_1d_t(TransFunc::stencil_radius - mask_i);
                             }
+                            v_halo_mask[mask_i] |=
+                                boundary_condition != BoundaryCondition::Constant;
                         }
-                    }
 
-                    carry = trans_func(stencil);
-                } else {
-                    carry = stencil_buffer[i_processing_element][TransFunc::stencil_radius]
-                                          [TransFunc::stencil_radius];
+#pragma unroll
+                        for (uindex_stencil_t cell_c = 0;
+                             cell_c < uindex_stencil_t(stencil_diameter); cell_c++) {
+#pragma unroll
+                            for (uindex_stencil_t cell_r = 0;
+                                 cell_r < uindex_stencil_t(stencil_diameter); cell_r++) {
+                                bool in_shape = stencil_shape.contains(
+                                    index_t(cell_c) - index_t(TransFunc::stencil_radius),
+                                    index_t(cell_r) - index_t(TransFunc::stencil_radius));
+                                if (in_shape && h_halo_mask[cell_c] && v_halo_mask[cell_r]) {
+                                    stencil[StencilUID(cell_c, cell_r)] =
+                                        stencil_buffer[i_processing_element][h_source[cell_c]]
+                                                      [vector_radius * vector_width -
+                                                       TransFunc::stencil_radius + i_cell +
+                                                       v_source[cell_r]];
+                                } else {
+                                    stencil[StencilUID(cell_c, cell_r)] = buffer_halo_value;
+                                }
+                            }
+                        }
+
+                        carry[i_cell] =
+                            History::get_transition_function(trans_func)(stencil);
+                        levels_carry[i_cell] = History::advance_history(
+                            stencil_buffer[i_processing_element][TransFunc::stencil_radius]
+                                          [vector_radius * vector_width + i_cell],
+                            levels_carry[i_cell], pe_subiteration);
+                    }
                 }
+                // Otherwise, the processing element is idle in this pass and the carry bypasses
+                // it unchanged.
 
                 r[i_processing_element] += 1;
-                if (r[i_processing_element] == index_1d_t(grid_height)) {
+                if (r[i_processing_element] == index_1d_t(get_vector_height())) {
                     r[i_processing_element] = 0;
                     c[i_processing_element] += 1;
                 }
             }
 
-            if (i >= uindex_n_iterations_t(calc_pipeline_latency(grid_height))) {
-                out_pipe::write(carry);
+            if constexpr (History::enabled) {
+                i_history_delay = (i_history_delay == history_delay - 1) ? 0 : i_history_delay + 1;
+            }
+
+            if (i >= uindex_n_iterations_t(pipeline_latency)) {
+                if (output_c >= index_1d_t(get_core_begin()) &&
+                    output_c < index_1d_t(get_core_end())) {
+                    CellVectorImpl output;
+#pragma unroll
+                    for (uindex_t i_cell = 0; i_cell < vector_width; i_cell++) {
+                        output[i_cell] = History::bundle(carry[i_cell], levels_carry[i_cell]);
+                    }
+                    write_vector((i - pipeline_latency).to_uint(), output);
+                }
+                output_r += 1;
+                if (output_r == index_1d_t(get_vector_height())) {
+                    output_r = 0;
+                    output_c += 1;
+                }
             }
         }
+        return n_iterations.to_uint();
     }
 
-  private:
     TransFunc trans_func;
     uindex_t i_iteration;
     uindex_t target_i_iteration;
     uindex_t grid_width;
     uindex_t grid_height;
+    uindex_t vector_height;
+    uindex_t strip_begin;
+    uindex_t strip_width;
+    uindex_t core_begin;
+    uindex_t core_end;
     Cell halo_value;
     TDVKernelArgument tdv_kernel_argument;
+    ConstantTable constant_table;
+    KernelCountersArgument<instrumented> counters;
 };
 
 /**
@@ -309,7 +730,8 @@ class StencilUpdateKernel {
  * (See \ref monotile), an instance of this updater template can only process grids up to the
  * defined `max_grid_width` and `max_grid_height`.
  *
- * \tparam F The transition function to apply to input grids.
+ * \tparam F The transition function to apply to input grids. If it reads past time levels of the
+ * cells, wrap it in a \ref stencil::HistoryTransitionFunction first.
  *
  * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs) to
  * implement. Increasing the number of PEs leads to a higher performance since more iterations are
@@ -330,20 +752,99 @@ class StencilUpdateKernel {
  *
  * \tparam word_size (Optimization parameter) The width of the global memory channel, in bytes. For
  * DDR-based systems, this should be 512 bits, or 64 bytes.
+ *
+ * \tparam dense_storage (Optimization parameter) Store cells densely packed in global memory and
+ * on-chip caches instead of padding them to the next power of two. This saves memory bandwidth and
+ * on-chip memory for cells whose size isn't a power of two, but may require wider memory ports.
+ *
+ * \tparam on_chip_loopback (Optimization parameter) Compute all requested iterations with one
+ * invocation of the execution kernel, which keeps the grid in an on-chip buffer between the passes.
+ * This way, global memory is only accessed at the start and the end of an update and the per-pass
+ * kernel launches are avoided. The buffer needs on-chip memory for `max_grid_width *
+ * max_grid_height` cells, so this is only feasible for small maximal grid sizes. The TDV strategy
+ * has to support \ref tdv::single_pass::MultiPassKernelArgument, like all built-in strategies
+ * except the \ref tdv::single_pass::ChunkedPrecomputeOnHostStrategy do.
+ *
+ * \tparam vector_width (Optimization parameter) The number of vertically adjacent cells that every
+ * processing element updates per clock cycle. A higher vector width uses more of the memory
+ * bandwidth for narrow cells and trades temporal parallelism (more PEs) for spatial parallelism:
+ * Every PE instantiates the transition function `vector_width` times and the caches become
+ * `vector_width` times wider, but the number of loop iterations per pass shrinks by the same
+ * factor. Grids whose height isn't a multiple of the vector width are padded internally.
+ *
+ * \tparam n_compute_units (Optimization parameter) The number of replicated chains of input,
+ * execution and output kernels. Every compute unit updates a strip of columns of the grid with its
+ * own memory streams, which lets bandwidth-bound designs use multiple memory channels. The strips
+ * overlap by `n_processing_elements * stencil_radius` columns that are recomputed by both
+ * neighbours in every pass. Between the passes, the cores of the strips are kept in separate
+ * buffers so that the compute units can write concurrently. The on-chip loopback and host streams
+ * are not supported with multiple compute units, the latter since a host pipe may only be written
+ * by a single kernel.
+ *
+ * \tparam instrumented (Debugging parameter) Let the input, execution and output kernels count
+ * their active cycles, their stalls on empty and full pipes and the cells they move. This shows
+ * whether the execution kernel is starved by the input or blocked by the output, but the counters
+ * and the non-blocking pipe operations cost additional resources. The counters of the last call to
+ * \ref operator()() can be fetched with \ref get_kernel_counters.
+ *
+ * \tparam fixed_grid_range (Optimization parameter) Only support grids with exactly
+ * `max_grid_width` columns and `max_grid_height` rows. The grid size becomes a compile-time
+ * constant of the execution kernel, which removes the logic for variable grid sizes, like the
+ * comparisons of the halo checks and the computation of the loop trip count. This is useful for
+ * applications that always simulate grids of the same size and may improve the clock frequency
+ * and the resource usage. It can't be combined with multiple compute units.
+ *
+ * If the transition function uses static values, the static grid has to be set with \ref
+ * set_static_grid before the first update. In every pass, the static values are streamed into the
+ * execution kernel alongside the cells, but only the cells are written back.
+ *
+ * If the transition function defines a reduction and \ref Params::reduction is set, the cells of
+ * the last pass are reduced by an additional kernel between the execution and the output kernel of
+ * every compute unit. Its result can be fetched with \ref get_reduction_result.
+ *
+ * If the transition function defines a host stream and \ref Params::host_stream is set, the cells
+ * of every pass are passed through an additional kernel that sends the selected cells to the
+ * host, see \ref stencil::concepts::HostStream "HostStream".
+ *
+ * If the transition function defines a clamp or reflect \ref stencil::BoundaryCondition
+ * "boundary condition", the processing elements fill the stencils of the border cells from other
+ * cells of the same stencil. Periodic boundaries are not supported, since the opposite side of the
+ * grid is not available when a border cell is updated.
  */
 template <concepts::TransitionFunction F, uindex_t n_processing_elements = 1,
           uindex_t max_grid_width = 1024, uindex_t max_grid_height = 1024,
           tdv::single_pass::Strategy<F, n_processing_elements> TDVStrategy =
               tdv::single_pass::InlineStrategy,
-          uindex_t word_size = 64>
+          uindex_t word_size = 64, bool dense_storage = false, bool on_chip_loopback = false,
+          uindex_t vector_width = 1, uindex_t n_compute_units = 1, bool instrumented = false,
+          bool fixed_grid_range = false>
+    requires(n_compute_units >= 1 && (n_compute_units == 1 || !on_chip_loopback) &&
+             (n_compute_units == 1 || !fixed_grid_range) &&
+             (n_compute_units == 1 || !has_host_stream<F>) && !has_history<F> &&
+             boundary_condition_of<F> != BoundaryCondition::Periodic)
 class StencilUpdate {
   private:
     using Cell = F::Cell;
     using TDV = typename F::TimeDependentValue;
+    using KernelFunction =
+        std::conditional_t<has_static_values<F>, StaticValueTransitionFunction<F>, F>;
+
+    static constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+    using TDVGlobalState = TDVStrategy::template GlobalState<KernelFunction, iters_per_pass>;
+    using TDVKernelArgument = typename TDVGlobalState::KernelArgument;
+
+    /// \brief The IDs of the pipes of a compute unit.
+    template <uindex_t i_compute_unit, uindex_t i_pipe> class ComputeUnitPipeID;
+
+    /// \brief A pipe that is never used, only to name an execution kernel in the performance model.
+    using ModelPipe = sycl::pipe<class monotile_model_pipe, CellVector<Cell, vector_width>>;
 
   public:
     /// \brief Shorthand for the used and supported grid type.
-    using GridImpl = Grid<Cell, word_size>;
+    using GridImpl = Grid<Cell, word_size, dense_storage>;
+
+    /// \brief Shorthand for the grid type of the static values.
+    using StaticGridImpl = Grid<StaticValueOf<F>, word_size, dense_storage>;
 
     /**
      * \brief Parameters for the stencil updater.
@@ -358,6 +859,9 @@ class StencilUpdate {
 
         /**
          *  \brief The cell value to present for cells outside of the grid.
+         *
+         * This is only used with the \ref BoundaryCondition::Constant "constant" boundary
+         * condition.
          */
         Cell halo_value = Cell();
 
@@ -400,16 +904,78 @@ class StencilUpdate {
          *
          * Setting this option to true will enable the recording of computation start and end
          * timestamps. The recorded kernel runtime can be fetched using the \ref
-         * StencilUpdate::get_kernel_runtime method.
+         * StencilUpdate::get_kernel_runtime method. Additionally, all kernels and the host-side
+         * allocation and submission phases are recorded in the \ref StencilUpdate::get_timeline
+         * "timeline" of the updater.
          */
         bool profiling = false;
+
+        /**
+         * \brief Allow the updater to overwrite the source grid.
+         *
+         * By default, the updater leaves the source grid untouched and uses two additional grids
+         * for its double buffering scheme. If this option is set to true, the source grid is used
+         * as one of these two buffers instead, which reduces the required memory from three to two
+         * times the grid size. The contents of the source grid are undefined afterwards, unless it
+         * is returned as the result.
+         */
+        bool overwrite_source = false;
+
+        /**
+         * \brief The reduction to evaluate on the updated grid.
+         *
+         * If the transition function defines a reduction and this field is set, the cells of the
+         * returned grid are reduced on the device while they are written back. The result is
+         * available via \ref StencilUpdate::get_reduction_result. Since it's computed in the last
+         * pass, no reduction is evaluated if no iterations are computed.
+         */
+        std::optional<ReductionOf<F>> reduction = std::nullopt;
+
+        /**
+         * \brief The contents of the constant table of the transition function.
+         *
+         * This is only used if the transition function defines a \ref stencil::ConstantTable
+         * "constant table". The table is copied to the device once per kernel and shared by all
+         * processing elements.
+         */
+        ConstantTableOf<F> constant_table = ConstantTableOf<F>();
+
+        /**
+         * \brief The clock frequency of the design in Hz.
+         *
+         * If this field is set and profiling is enabled, the measured kernel runtime of every call
+         * to \ref StencilUpdate::operator()() is compared with \ref StencilUpdate::model_runtime.
+         * The result is available via \ref StencilUpdate::get_efficiency.
+         */
+        std::optional<double> clock_frequency = std::nullopt;
+
+        /**
+         * \brief The latency of the execution kernel's main loop in clock cycles.
+         *
+         * This is added to the modeled runtime of every pass. The synthesis report lists it as the
+         * latency of the loop.
+         */
+        uindex_t loop_latency = 0;
+
+        /**
+         * \brief The selection of cells to send to the host.
+         *
+         * This is only used if the transition function defines a \ref
+         * stencil::concepts::HostStream "host stream". If this field is set, the selected cells of
+         * every pass are written to the pipe of the host stream while the pass is computed. With
+         * the on-chip loopback, only the cells of the last pass are available.
+         */
+        std::optional<HostStreamOf<F>> host_stream = std::nullopt;
     };
 
     /**
      * \brief Create a new stencil updater object.
      */
     StencilUpdate(Params params)
-        : params(params), n_processed_cells(0), work_events(), walltime(0.0) {}
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          static_grid(std::nullopt), queues_profiling(false), n_processed_cells(0), work_events(),
+          walltime(0.0), timeline(), counters_buffers(), last_call_first_work_event(0),
+          last_call_model_runtime(std::nullopt) {}
 
     /**
      * \brief Return a reference to the parameters.
@@ -418,71 +984,452 @@ class StencilUpdate {
      */
     Params &get_params() { return params; }
 
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the grid of static values, if one has been set.
+     */
+    std::optional<StaticGridImpl> get_static_grid() const { return static_grid; }
+
+    /**
+     * \brief Set the grid of static values.
+     *
+     * Every cell of the source grid receives the static value at the same position of this grid
+     * as `stencil.static_value`. The static grid is only read and therefore may be used for
+     * multiple updates and updaters. It must have the same size as the grids it's used with.
+     */
+    void set_static_grid(StaticGridImpl static_grid)
+        requires(has_static_values<F>)
+    {
+        this->static_grid = static_grid;
+    }
+
+    /**
+     * \brief Prepare the updater for timed computations.
+     *
+     * This method creates the queues of the updater and computes one iteration of a small grid.
+     * This forces the compilation of the kernels or the programming of the FPGA, so that it
+     * doesn't distort the measurements of later calls to \ref operator()(). The accumulated
+     * statistics of the updater are not affected and this method blocks until the computation is
+     * complete.
+     */
+    void warm_up() {
+        // A fixed-size kernel can't process smaller grids.
+        uindex_t warm_up_width = fixed_grid_range ? max_grid_width : 1;
+        uindex_t warm_up_height = fixed_grid_range ? max_grid_height : 1;
+        GridImpl grid(warm_up_width, warm_up_height);
+        {
+            typename GridImpl::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+            ac[0][0] = params.halo_value;
+        }
+
+        // The guards restore the state of the updater even if the warm-up computation throws.
+        RestoreGuard params_guard(params);
+        RestoreGuard static_grid_guard(static_grid);
+        RestoreGuard n_processed_cells_guard(n_processed_cells);
+        RestoreGuard walltime_guard(walltime);
+        RestoreGuard work_events_guard(work_events);
+        RestoreGuard reduction_result_guard(reduction_result);
+        RestoreGuard first_work_event_guard(last_call_first_work_event);
+        RestoreGuard model_runtime_guard(last_call_model_runtime);
+        RestoreGuard timeline_guard(timeline);
+
+        if constexpr (has_static_values<F>) {
+            static_grid = StaticGridImpl(warm_up_width, warm_up_height);
+            typename StaticGridImpl::template GridAccessor<sycl::access::mode::read_write> ac(
+                *static_grid);
+            ac[0][0] = StaticValueOf<F>();
+        }
+        params.n_iterations = 1;
+        params.blocking = true;
+        (*this)(grid);
+    }
+
     /**
      * \brief Compute a new grid based on the source grid, using the configured transition function.
      *
-     * The computation does not work in-place. Instead, it will allocate two additional grids with
-     * the same size as the source grid and use them for a double buffering scheme. Therefore, you
-     * are free to reuse the source grid as it will not be altered.
+     * The computation does not work in-place. Instead, it will request two additional grids with
+     * the same size as the source grid from the grid pool and use them for a double buffering
+     * scheme. Therefore, you are free to reuse the source grid as it will not be altered. If \ref
+     * Params::overwrite_source is true, the source grid is used as one of the buffers instead and
+     * only one additional grid is requested.
      *
      * If \ref Params::blocking is set to true, this method will block until the computation is
      * complete. Otherwise, it will return as soon as all kernels are submitted.
+     *
+     * \throws std::invalid_argument The transition function uses static values, but no static
+     * grid has been set.
+     *
+     * \throws std::range_error The static grid doesn't have the same size as the source grid.
+     *
+     * \throws std::invalid_argument The transition function reflects the grid at its borders, but
+     * the grid is narrower or lower than the stencil radius.
+     *
+     * \throws std::range_error The updater has a fixed grid range and the source grid doesn't have
+     * exactly this size.
      */
     GridImpl operator()(GridImpl &source_grid) {
         if (source_grid.get_grid_height() > max_grid_height) {
             throw std::range_error("The grid is too tall for the stencil update kernel.");
         }
+        if (boundary_condition_of<F> == BoundaryCondition::Reflect &&
+            std::min(source_grid.get_grid_width(), source_grid.get_grid_height()) <
+                F::stencil_radius) {
+            throw std::invalid_argument(
+                "Reflected grids must be at least as wide and high as the stencil radius.");
+        }
         if (source_grid.get_grid_width() > max_grid_width) {
             throw std::range_error("The grid is too wide for the stencil update kernel.");
         }
-        using in_pipe = sycl::pipe<class monotile_in_pipe, Cell>;
-        using out_pipe = sycl::pipe<class monotile_out_pipe, Cell>;
+        if (fixed_grid_range && (source_grid.get_grid_width() != max_grid_width ||
+                                 source_grid.get_grid_height() != max_grid_height)) {
+            throw std::range_error("The grid doesn't have the fixed size of the stencil update "
+                                   "kernel.");
+        }
+        if constexpr (has_static_values<F>) {
+            if (!static_grid.has_value()) {
+                throw std::invalid_argument("The transition function uses static values, but no "
+                                            "static grid has been set.");
+            }
+            if (static_grid->get_grid_width() != source_grid.get_grid_width() ||
+                static_grid->get_grid_height() != source_grid.get_grid_height()) {
+                throw std::range_error("The static grid and the source grid differ in size.");
+            }
+        }
 
-        constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+        reduction_result = std::nullopt;
+        if (params.n_iterations == 0) {
+            return GridImpl(source_grid);
+        }
 
-        using TDVGlobalState = TDVStrategy::template GlobalState<F, iters_per_pass>;
-        using TDVKernelArgument = typename TDVGlobalState::KernelArgument;
-        using ExecutionKernelImpl =
-            StencilUpdateKernel<F, TDVKernelArgument, n_processing_elements, max_grid_width,
-                                max_grid_height, in_pipe, out_pipe>;
+        prepare_queues();
+        if constexpr (instrumented) {
+            counters_buffers = std::vector<StencilUpdateCountersBuffers>(n_compute_units);
+        }
 
-        sycl::queue input_kernel_queue =
-            sycl::queue(params.device, {sycl::property::queue::in_order{}});
-        sycl::queue output_kernel_queue =
-            sycl::queue(params.device, {sycl::property::queue::in_order{}});
+        last_call_first_work_event = work_events.size();
+        last_call_model_runtime = std::nullopt;
+        if (params.profiling && params.clock_frequency.has_value()) {
+            last_call_model_runtime =
+                model_runtime(source_grid.get_grid_width(), source_grid.get_grid_height(),
+                              params.n_iterations, *params.clock_frequency, params.loop_latency);
+        }
 
-        sycl::queue update_kernel_queue =
-            sycl::queue(params.device, {cl::sycl::property::queue::enable_profiling{},
-                                        sycl::property::queue::in_order{}});
+        if constexpr (has_reduction<F>) {
+            if (params.reduction.has_value()) {
+                reduction_result = ReductionResult<Cell, ReductionOf<F>>(*params.reduction);
+            }
+        }
 
-        GridImpl swap_grid_a = source_grid.make_similar();
-        GridImpl swap_grid_b = source_grid.make_similar();
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        GridImpl target_grid = source_grid;
+        if constexpr (n_compute_units == 1) {
+            target_grid = run_single_unit(source_grid);
+        } else {
+            target_grid = run_compute_units(source_grid);
+        }
+
+        if (params.blocking) {
+            for (std::optional<sycl::queue> &queue : output_kernel_queues) {
+                queue->wait();
+            }
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+
+        n_processed_cells +=
+            params.n_iterations * source_grid.get_grid_width() * source_grid.get_grid_height();
+
+        return target_grid;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the width times the height of the grid, times
+     * the number of computed iterations. This will also be accumulated across multiple calls to
+     * \ref operator()().
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated total runtime of the execution kernel.
+     *
+     * This runtime is accumulated across multiple calls to \ref operator()(). However, this is only
+     * possible if \ref Params::profiling is set to true.
+     */
+    double get_kernel_runtime() const { return calc_kernel_runtime(0); }
+
+    /**
+     * \brief Check whether the updater can process grids of the given size.
+     *
+     * The size of the cache in the execution kernel limits the grids to `max_grid_width`
+     * columns and `max_grid_height` rows. With a fixed grid range, the grid has to have exactly
+     * this size.
+     */
+    static constexpr bool supports_grid_range(uindex_t grid_width, uindex_t grid_height) {
+        if constexpr (fixed_grid_range) {
+            return grid_width == max_grid_width && grid_height == max_grid_height;
+        } else {
+            return grid_width <= max_grid_width && grid_height <= max_grid_height;
+        }
+    }
+
+    /**
+     * \brief Model the runtime of the execution kernels for a grid of the given size.
+     *
+     * The model assumes that the execution kernel processes one vector per clock cycle, or fewer
+     * if a vector doesn't fit into one memory word, and that the input and output kernels keep
+     * up with it. A pass over a strip takes \ref StencilUpdateKernel::calc_n_iterations loop
+     * iterations plus the latency of the loop. The compute units run concurrently, so a pass
+     * takes as long as the widest strip. A final pass that computes fewer iterations than the
+     * others is shorter, since its pipeline only spans the active processing elements.
+     *
+     * \param grid_width The number of columns of the grid.
+     *
+     * \param grid_height The number of rows of the grid.
+     *
+     * \param n_iterations The number of computed iterations.
+     *
+     * \param clock_frequency The clock frequency of the design in Hz.
+     *
+     * \param loop_latency The latency of the execution kernel's main loop in clock cycles.
+     *
+     * \return The modeled runtime in seconds.
+     */
+    static constexpr double model_runtime(uindex_t grid_width, uindex_t grid_height,
+                                          uindex_t n_iterations, double clock_frequency,
+                                          uindex_t loop_latency = 0) {
+        using ModelKernel =
+            StencilUpdateKernel<KernelFunction, TDVKernelArgument, n_processing_elements,
+                                max_grid_width, max_grid_height, ModelPipe, ModelPipe,
+                                dense_storage, on_chip_loopback, vector_width>;
+        uindex_t vector_height = n_cells_to_n_words(grid_height, vector_width);
+        uindex_t n_cycles_per_iteration = n_cells_to_n_words(
+            vector_width * sizeof(CellStorage<Cell, dense_storage>), word_size);
+
+        auto calc_n_pass_cycles = [&](uindex_t n_active_processing_elements) {
+            uint64_t n_pass_cycles = 0;
+            for (ColumnStrip const &strip : partition_columns(grid_width, grid_height)) {
+                if (strip.core_begin == strip.core_end) {
+                    continue;
+                }
+                uint64_t n_strip_cycles =
+                    uint64_t(ModelKernel::calc_n_iterations(strip.end - strip.begin, vector_height,
+                                                            n_active_processing_elements)) *
+                        n_cycles_per_iteration +
+                    loop_latency;
+                n_pass_cycles = std::max(n_pass_cycles, n_strip_cycles);
+            }
+            return n_pass_cycles;
+        };
+
+        uint64_t n_full_passes = n_iterations / iters_per_pass;
+        uint64_t n_cycles = n_full_passes * calc_n_pass_cycles(n_processing_elements);
+        if (n_iterations % iters_per_pass != 0) {
+            n_cycles += calc_n_pass_cycles(ModelKernel::calc_n_active_processing_elements(
+                n_iterations % iters_per_pass));
+        }
+        return double(n_cycles) / clock_frequency;
+    }
+
+    /**
+     * \brief Return the efficiency of the last call to \ref operator()().
+     *
+     * This is the runtime from \ref model_runtime divided by the measured runtime of the
+     * execution kernels, so values well below one indicate that the kernels were stalled, for
+     * example by a slow memory system or a degraded board. The efficiency is only available if
+     * the last call was profiled, \ref Params::clock_frequency was set and at least one iteration
+     * was computed. This method blocks until the kernels of the last call have completed.
+     */
+    std::optional<double> get_efficiency() const {
+        if (!last_call_model_runtime.has_value() || *last_call_model_runtime == 0.0) {
+            return std::nullopt;
+        }
+        double kernel_runtime = calc_kernel_runtime(last_call_first_work_event);
+        if (kernel_runtime == 0.0) {
+            return std::nullopt;
+        }
+        return *last_call_model_runtime / kernel_runtime;
+    }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     *
+     * For each call to \ref operator()(), the time it took to submit all kernels and, if \ref
+     * Params::blocking is true, to finish the computation is recorded and accumulated.
+     */
+    double get_walltime() const { return walltime; }
+
+    /**
+     * \brief Return the timeline of the kernels and host-side phases of all profiled calls.
+     *
+     * Events are only recorded if \ref Params::profiling is set to true. In every pass, the input,
+     * execution and output kernels of every compute unit are recorded, tagged with the pass, the
+     * compute unit and the computed iterations, as well as the time it took the host to submit
+     * them. The allocation of the grids is recorded as the host-side phase "allocate".
+     */
+    Timeline &get_timeline() { return timeline; }
+
+    /**
+     * \brief Return the kernel counters of a compute unit from the last call to \ref operator()().
+     *
+     * The counters are recorded on the device and summed up over all passes. The read counters
+     * cover the input kernels of the cells, but not those of the static values, and the write
+     * counters cover the output kernels. This method blocks until the kernels have completed. If
+     * the updater hasn't been called yet, all counters are zero.
+     *
+     * \throws std::out_of_range The compute unit doesn't exist.
+     */
+    StencilUpdateCounters get_kernel_counters(uindex_t i_unit = 0) const
+        requires(instrumented)
+    {
+        if (i_unit >= n_compute_units) {
+            throw std::out_of_range("The compute unit doesn't exist.");
+        }
+        if (counters_buffers.empty()) {
+            return StencilUpdateCounters();
+        }
+        return counters_buffers[i_unit].get();
+    }
+
+    /**
+     * \brief Return the result of the reduction of the grid returned by the last call to \ref
+     * operator()().
+     *
+     * This method blocks until the reduction is complete. If the last call didn't evaluate a
+     * reduction, since \ref Params::reduction wasn't set or no iterations were computed, nothing is
+     * returned.
+     */
+    auto get_reduction_result()
+        requires(has_reduction<F>)
+    {
+        using Value = typename ReductionOf<F>::Value;
+        return reduction_result.has_value() ? std::optional<Value>(reduction_result->get())
+                                            : std::optional<Value>();
+    }
+
+    /**
+     * \brief Return the pending reduction of the grid returned by the last call to \ref
+     * operator()(), without waiting for it.
+     *
+     * \ref stencil::run_until uses this to check the reduction of one interval while the next
+     * interval is computed. Nothing is returned if the last call didn't evaluate a reduction.
+     */
+    std::optional<ReductionResult<Cell, ReductionOf<F>>> get_pending_reduction_result() const
+        requires(has_reduction<F>)
+    {
+        return reduction_result;
+    }
+
+    /**
+     * \brief Replace the pending reduction that \ref get_reduction_result returns.
+     *
+     * \ref stencil::run_until uses this to drop the reduction of its speculative interval.
+     */
+    void set_pending_reduction_result(std::optional<ReductionResult<Cell, ReductionOf<F>>> result)
+        requires(has_reduction<F>)
+    {
+        reduction_result = result;
+    }
+
+  private:
+    /**
+     * \brief Compute all passes with one chain of input, execution and output kernels.
+     */
+    GridImpl run_single_unit(GridImpl &source_grid) {
+        using cell_in_pipe = sycl::pipe<class monotile_in_pipe, CellVector<Cell, vector_width>>;
+        using cell_out_pipe = sycl::pipe<class monotile_out_pipe, CellVector<Cell, vector_width>>;
+        using static_value_pipe = sycl::pipe<class monotile_static_value_pipe,
+                                             CellVector<StaticValueOf<F>, vector_width>>;
+        using in_pipe =
+            std::conditional_t<has_static_values<F>,
+                               StaticValueInputPipe<Cell, StaticValueOf<F>, cell_in_pipe,
+                                                    static_value_pipe, vector_width>,
+                               cell_in_pipe>;
+        using out_pipe = std::conditional_t<has_static_values<F>,
+                                            StaticValueOutputPipe<cell_out_pipe>, cell_out_pipe>;
+        using ExecutionKernelImpl =
+            StencilUpdateKernel<KernelFunction, TDVKernelArgument, n_processing_elements,
+                                max_grid_width, max_grid_height, in_pipe, out_pipe, dense_storage,
+                                on_chip_loopback, vector_width, instrumented, fixed_grid_range,
+                                boundary_condition_of<F>>;
+
+        // With the on-chip loopback, the execution kernel is only submitted once and the second
+        // swap grid is never used.
+        double allocation_start = timeline.now();
+        GridImpl swap_grid_a = (params.overwrite_source || on_chip_loopback)
+                                   ? source_grid
+                                   : grid_pool->acquire(source_grid);
+        GridImpl swap_grid_b = grid_pool->acquire(source_grid);
+        record_host_phase("allocate", TimelineEvent(), allocation_start);
 
         GridImpl *pass_source = &source_grid;
         GridImpl *pass_target = &swap_grid_b;
 
-        F trans_func = params.transition_function;
+        KernelFunction trans_func(params.transition_function);
+        typename KernelFunction::Cell halo_value = get_kernel_halo_value();
         TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
 
-        auto walltime_start = std::chrono::high_resolution_clock::now();
-
         uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
-        for (uindex_t i = params.iteration_offset; i < target_n_iterations; i += iters_per_pass) {
-            pass_source->template submit_read<in_pipe>(input_kernel_queue);
-            uindex_t iters_in_this_pass = std::min(iters_per_pass, target_n_iterations - i);
+        uindex_t iters_per_submission = on_chip_loopback ? params.n_iterations : iters_per_pass;
+        for (uindex_t i = params.iteration_offset; i < target_n_iterations;
+             i += iters_per_submission) {
+            uindex_t iters_in_this_pass = std::min(iters_per_submission, target_n_iterations - i);
+            TimelineEvent pass_tags{.pass = (i - params.iteration_offset) / iters_per_submission,
+                                    .iteration_begin = i,
+                                    .iteration_end = i + iters_in_this_pass};
+            double submission_start = timeline.now();
 
-            sycl::event work_event = update_kernel_queue.submit([&](sycl::handler &cgh) {
+            record_kernel("read", pass_tags,
+                          submit_grid_read<cell_in_pipe>(0, *pass_source, 0,
+                                                         source_grid.get_grid_width()));
+            if constexpr (has_static_values<F>) {
+                record_kernel("read static values", pass_tags,
+                              static_grid->template submit_read<static_value_pipe, vector_width>(
+                                  *static_input_kernel_queues[0]));
+            }
+
+            sycl::event work_event = update_kernel_queues[0]->submit([&](sycl::handler &cgh) {
                 TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i, iters_in_this_pass);
                 ExecutionKernelImpl exec_kernel(
                     trans_func, i, target_n_iterations, source_grid.get_grid_width(),
-                    source_grid.get_grid_height(), params.halo_value, tdv_kernel_argument);
+                    source_grid.get_grid_height(), halo_value, tdv_kernel_argument);
+                exec_kernel.set_constant_table(params.constant_table);
+                if constexpr (instrumented) {
+                    exec_kernel.set_counters(
+                        make_kernel_counters_argument<true>(counters_buffers[0].compute, cgh));
+                }
                 cgh.single_task<ExecutionKernelImpl>(exec_kernel);
             });
             if (params.profiling) {
-                work_events.push_back(work_event);
+                work_events.push_back({work_event});
             }
+            record_kernel("compute", pass_tags, work_event);
 
-            pass_target->template submit_write<out_pipe>(output_kernel_queue);
+            using stream_pipe =
+                sycl::pipe<class monotile_host_stream_pipe, CellVector<Cell, vector_width>>;
+            using reduction_pipe =
+                sycl::pipe<class monotile_reduction_pipe, CellVector<Cell, vector_width>>;
+            submit_output<cell_out_pipe, stream_pipe, reduction_pipe>(
+                0, *pass_target, 0, source_grid.get_grid_width(), 0, i + iters_in_this_pass,
+                i + iters_in_this_pass == target_n_iterations, pass_tags);
+            record_host_phase("submit", pass_tags, submission_start);
 
             if (i == params.iteration_offset) {
                 pass_source = &swap_grid_b;
@@ -492,65 +1439,430 @@ class StencilUpdate {
             }
         }
 
-        if (params.blocking) {
-            output_kernel_queue.wait();
+        return *pass_source;
+    }
+
+    /**
+     * \brief Return the accumulated runtime of the execution kernels, starting with the pass of the
+     * given work event.
+     */
+    double calc_kernel_runtime(std::size_t first_work_event) const {
+        double kernel_runtime = 0.0;
+        for (std::size_t i_pass = first_work_event; i_pass < work_events.size(); i_pass++) {
+            std::vector<sycl::event> const &pass_work_events = work_events[i_pass];
+            // With multiple compute units, the execution kernels of a pass run concurrently, so
+            // the runtime of the pass is measured from the first start to the last end.
+            const double timesteps_per_second = 1000000000.0;
+            double start = std::numeric_limits<double>::max();
+            double end = 0.0;
+            for (sycl::event work_event : pass_work_events) {
+                start = std::min(
+                    start,
+                    double(work_event.get_profiling_info<
+                           cl::sycl::info::event_profiling::command_start>()) /
+                        timesteps_per_second);
+                end = std::max(
+                    end, double(work_event.get_profiling_info<
+                                cl::sycl::info::event_profiling::command_end>()) /
+                             timesteps_per_second);
+            }
+            kernel_runtime += end - start;
         }
+        return kernel_runtime;
+    }
 
-        auto walltime_end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> walltime = walltime_end - walltime_start;
-        this->walltime += walltime.count();
+    /**
+     * \brief The columns that a compute unit reads and writes in a pass.
+     */
+    struct ColumnStrip {
+        /// \brief The first column that the compute unit writes.
+        uindex_t core_begin;
+        /// \brief One past the last column that the compute unit writes.
+        uindex_t core_end;
+        /// \brief The first column that the compute unit reads.
+        uindex_t begin;
+        /// \brief One past the last column that the compute unit reads.
+        uindex_t end;
+    };
 
-        n_processed_cells +=
-            params.n_iterations * source_grid.get_grid_width() * source_grid.get_grid_height();
+    /**
+     * \brief Split the columns of the grid into one strip per compute unit.
+     *
+     * The cores of the strips are aligned to the column alignment of the grid, so that the
+     * compute units never write to the same memory word. Therefore, some cores may be empty for
+     * narrow grids. Every strip extends its core by the columns that are needed to compute all
+     * iterations of a pass.
+     */
+    static constexpr std::array<ColumnStrip, n_compute_units>
+    partition_columns(uindex_t grid_width, uindex_t grid_height) {
+        uindex_t alignment = GridImpl::calc_column_alignment(grid_height);
+        uindex_t halo_width = F::stencil_radius * n_processing_elements;
 
-        return *pass_source;
+        std::array<ColumnStrip, n_compute_units> strips;
+        for (uindex_t i_unit = 0; i_unit < n_compute_units; i_unit++) {
+            uindex_t core_begin = (i_unit * grid_width / n_compute_units) / alignment * alignment;
+            uindex_t core_end =
+                (i_unit == n_compute_units - 1)
+                    ? grid_width
+                    : ((i_unit + 1) * grid_width / n_compute_units) / alignment * alignment;
+            strips[i_unit] = {
+                .core_begin = core_begin,
+                .core_end = core_end,
+                .begin = core_begin - std::min(core_begin, halo_width),
+                .end = std::min(grid_width, core_end + halo_width),
+            };
+        }
+        return strips;
     }
 
     /**
-     * \brief Return the accumulated total number of cells processed by this updater.
+     * \brief Compute all passes with `n_compute_units` parallel chains of input, execution and
+     * output kernels.
      *
-     * For each call of to \ref operator()(), this is the width times the height of the grid, times
-     * the number of computed iterations. This will also be accumulated across multiple calls to
-     * \ref operator()().
+     * Between the passes, every compute unit stores its core in a grid of its own. This way, the
+     * output kernels of the compute units don't access the same buffer and may run concurrently.
+     * In the next pass, every compute unit reads its core and the neighbouring columns from these
+     * grids. Only the last pass writes to one target grid.
      */
-    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+    GridImpl run_compute_units(GridImpl &source_grid) {
+        std::array<ColumnStrip, n_compute_units> strips =
+            partition_columns(source_grid.get_grid_width(), source_grid.get_grid_height());
+        uindex_t grid_height = source_grid.get_grid_height();
+
+        uindex_t n_passes = n_cells_to_n_words(params.n_iterations, iters_per_pass);
+        double allocation_start = timeline.now();
+        GridImpl target_grid = (params.overwrite_source && n_passes > 1)
+                                   ? source_grid
+                                   : grid_pool->acquire(source_grid);
+
+        // Allocate the core grids, or reuse the ones of the previous call if they fit.
+        bool core_grids_fit = core_grids[0].size() == n_compute_units;
+        for (uindex_t i_unit = 0; core_grids_fit && i_unit < n_compute_units; i_unit++) {
+            for (std::vector<GridImpl> &grids : core_grids) {
+                core_grids_fit &= grids[i_unit].get_grid_width() ==
+                                      strips[i_unit].core_end - strips[i_unit].core_begin &&
+                                  grids[i_unit].get_grid_height() == grid_height;
+            }
+        }
+        if (!core_grids_fit) {
+            for (std::vector<GridImpl> &grids : core_grids) {
+                grids.clear();
+                for (ColumnStrip const &strip : strips) {
+                    grids.push_back(GridImpl(strip.core_end - strip.core_begin, grid_height));
+                }
+            }
+        }
+        record_host_phase("allocate", TimelineEvent(), allocation_start);
+
+        KernelFunction trans_func(params.transition_function);
+        typename KernelFunction::Cell halo_value = get_kernel_halo_value();
+        TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
+
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i_pass = 0; i_pass < n_passes; i_pass++) {
+            uindex_t i = params.iteration_offset + i_pass * iters_per_pass;
+            uindex_t iters_in_this_pass = std::min(iters_per_pass, target_n_iterations - i);
+            std::vector<GridImpl> &pass_sources = core_grids[i_pass % 2];
+            std::vector<GridImpl> &pass_targets = core_grids[(i_pass + 1) % 2];
+            std::vector<sycl::event> pass_work_events;
+            double submission_start = timeline.now();
+
+            auto submit_unit = [&]<uindex_t i_unit>() {
+                using cell_in_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 0>,
+                                                CellVector<Cell, vector_width>>;
+                using cell_out_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 1>,
+                                                 CellVector<Cell, vector_width>>;
+                using static_value_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 2>,
+                                                     CellVector<StaticValueOf<F>, vector_width>>;
+                using in_pipe =
+                    std::conditional_t<has_static_values<F>,
+                                       StaticValueInputPipe<Cell, StaticValueOf<F>, cell_in_pipe,
+                                                            static_value_pipe, vector_width>,
+                                       cell_in_pipe>;
+                using out_pipe =
+                    std::conditional_t<has_static_values<F>, StaticValueOutputPipe<cell_out_pipe>,
+                                       cell_out_pipe>;
+                using ExecutionKernelImpl =
+                    StencilUpdateKernel<KernelFunction, TDVKernelArgument, n_processing_elements,
+                                        max_grid_width, max_grid_height, in_pipe, out_pipe,
+                                        dense_storage, false, vector_width, instrumented, false,
+                                        boundary_condition_of<F>>;
+
+                ColumnStrip strip = strips[i_unit];
+                if (strip.core_begin == strip.core_end) {
+                    return;
+                }
+                TimelineEvent unit_tags{.pass = i_pass,
+                                        .unit = i_unit,
+                                        .iteration_begin = i,
+                                        .iteration_end = i + iters_in_this_pass};
+
+                if (i_pass == 0) {
+                    record_kernel("read", unit_tags,
+                                  submit_grid_read<cell_in_pipe>(i_unit, source_grid, strip.begin,
+                                                                 strip.end));
+                } else {
+                    // Collect the strip from the cores of this and the neighbouring units.
+                    for (uindex_t i_other = 0; i_other < n_compute_units; i_other++) {
+                        uindex_t begin = std::max(strip.begin, strips[i_other].core_begin);
+                        uindex_t end = std::min(strip.end, strips[i_other].core_end);
+                        if (begin < end) {
+                            record_kernel("read", unit_tags,
+                                          submit_grid_read<cell_in_pipe>(
+                                              i_unit, pass_sources[i_other],
+                                              begin - strips[i_other].core_begin,
+                                              end - strips[i_other].core_begin));
+                        }
+                    }
+                }
+                if constexpr (has_static_values<F>) {
+                    record_kernel(
+                        "read static values", unit_tags,
+                        static_grid->template submit_read<static_value_pipe, vector_width>(
+                            *static_input_kernel_queues[i_unit], strip.begin, strip.end));
+                }
+
+                sycl::event work_event =
+                    update_kernel_queues[i_unit]->submit([&](sycl::handler &cgh) {
+                        TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i,
+                                                              iters_in_this_pass);
+                        ExecutionKernelImpl exec_kernel(
+                            trans_func, i, target_n_iterations, source_grid.get_grid_width(),
+                            grid_height, halo_value, tdv_kernel_argument, strip.begin, strip.end,
+                            strip.core_begin, strip.core_end);
+                        exec_kernel.set_constant_table(params.constant_table);
+                        if constexpr (instrumented) {
+                            exec_kernel.set_counters(make_kernel_counters_argument<true>(
+                                counters_buffers[i_unit].compute, cgh));
+                        }
+                        cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+                    });
+                pass_work_events.push_back(work_event);
+                record_kernel("compute", unit_tags, work_event);
+
+                using stream_pipe =
+                    sycl::pipe<ComputeUnitPipeID<i_unit, 4>, CellVector<Cell, vector_width>>;
+                if (i_pass == n_passes - 1) {
+                    using reduction_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 3>,
+                                                      CellVector<Cell, vector_width>>;
+                    submit_output<cell_out_pipe, stream_pipe, reduction_pipe>(
+                        i_unit, target_grid, strip.core_begin, strip.core_end, strip.core_begin,
+                        i + iters_in_this_pass, true, unit_tags);
+                } else {
+                    // The reduction pipe is never used since this isn't the last pass.
+                    submit_output<cell_out_pipe, stream_pipe, cell_out_pipe>(
+                        i_unit, pass_targets[i_unit], 0, pass_targets[i_unit].get_grid_width(),
+                        strip.core_begin, i + iters_in_this_pass, false, unit_tags);
+                }
+            };
+            [&]<uindex_t... i_units>(std::integer_sequence<uindex_t, i_units...>) {
+                (submit_unit.template operator()<i_units>(), ...);
+            }(std::make_integer_sequence<uindex_t, n_compute_units>());
+
+            if (params.profiling) {
+                work_events.push_back(pass_work_events);
+            }
+            record_host_phase("submit", TimelineEvent{.pass = i_pass,
+                                                      .iteration_begin = i,
+                                                      .iteration_end = i + iters_in_this_pass},
+                              submission_start);
+        }
+
+        return target_grid;
+    }
 
     /**
-     * \brief Return the accumulated total runtime of the execution kernel.
+     * \brief Submit the output kernel of a compute unit that writes the given columns.
      *
-     * This runtime is accumulated across multiple calls to \ref operator()(). However, this is only
-     * possible if \ref Params::profiling is set to true.
+     * If a host stream is requested, the cells are passed through a host stream kernel first. It
+     * sends the selected cells to the host, tagged with the given iteration index and with their
+     * column index plus `grid_column_begin`. Then, if this is the last pass and a reduction is
+     * requested, the cells are passed through a reduction kernel. Otherwise, the output kernel
+     * reads directly from the `cell_out_pipe`. The kernels are recorded in the timeline with the
+     * given tags.
      */
-    double get_kernel_runtime() const {
-        double kernel_runtime = 0.0;
-        for (sycl::event work_event : work_events) {
-            const double timesteps_per_second = 1000000000.0;
-            double start =
-                double(work_event
-                           .get_profiling_info<cl::sycl::info::event_profiling::command_start>()) /
-                timesteps_per_second;
-            double end =
-                double(
-                    work_event.get_profiling_info<cl::sycl::info::event_profiling::command_end>()) /
-                timesteps_per_second;
-            kernel_runtime += end - start;
+    template <typename cell_out_pipe, typename stream_pipe, typename reduction_pipe>
+    void submit_output(uindex_t i_unit, GridImpl &pass_target, uindex_t column_begin,
+                       uindex_t column_end, uindex_t grid_column_begin, uindex_t i_iteration,
+                       bool last_pass, TimelineEvent const &tags) {
+        if constexpr (has_host_stream<F>) {
+            if (params.host_stream.has_value()) {
+                record_kernel("stream", tags,
+                              submit_host_stream_kernel<Cell, cell_out_pipe, stream_pipe,
+                                                        vector_width>(
+                                  *host_stream_kernel_queues[i_unit], *params.host_stream,
+                                  i_iteration, grid_column_begin, column_end - column_begin,
+                                  pass_target.get_grid_height()));
+                submit_reduction_and_write<stream_pipe, reduction_pipe>(
+                    i_unit, pass_target, column_begin, column_end, last_pass, tags);
+                return;
+            }
         }
-        return kernel_runtime;
+        submit_reduction_and_write<cell_out_pipe, reduction_pipe>(i_unit, pass_target, column_begin,
+                                                                   column_end, last_pass, tags);
     }
 
     /**
-     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     * \brief Submit the kernels that write the cells from the `cell_pipe` to the given columns.
      *
-     * For each call to \ref operator()(), the time it took to submit all kernels and, if \ref
-     * Params::blocking is true, to finish the computation is recorded and accumulated.
+     * If this is the last pass and a reduction is requested, the cells are passed through a
+     * reduction kernel first.
      */
-    double get_walltime() const { return walltime; }
+    template <typename cell_pipe, typename reduction_pipe>
+    void submit_reduction_and_write(uindex_t i_unit, GridImpl &pass_target, uindex_t column_begin,
+                                    uindex_t column_end, bool last_pass,
+                                    TimelineEvent const &tags) {
+        if constexpr (has_reduction<F>) {
+            if (last_pass && reduction_result.has_value()) {
+                record_kernel(
+                    "reduce", tags,
+                    submit_reduction_kernel<Cell, cell_pipe, reduction_pipe, vector_width>(
+                        *reduction_kernel_queues[i_unit], *params.reduction,
+                        column_end - column_begin, pass_target.get_grid_height(),
+                        reduction_result->add_partial_results(1)));
+                record_kernel("write", tags,
+                              submit_grid_write<reduction_pipe>(i_unit, pass_target, column_begin,
+                                                                column_end));
+                return;
+            }
+        }
+        record_kernel("write", tags,
+                      submit_grid_write<cell_pipe>(i_unit, pass_target, column_begin, column_end));
+    }
+
+    /**
+     * \brief Submit an input kernel of a compute unit that sends the given columns of the grid.
+     *
+     * If the updater is instrumented, the kernel adds its counters to the read counters of the
+     * compute unit.
+     */
+    template <typename pipe>
+    sycl::event submit_grid_read(uindex_t i_unit, GridImpl &grid, uindex_t column_begin,
+                                 uindex_t column_end) {
+        if constexpr (instrumented) {
+            return grid.template submit_read<pipe, vector_width>(*input_kernel_queues[i_unit],
+                                                                 column_begin, column_end,
+                                                                 counters_buffers[i_unit].read);
+        } else {
+            return grid.template submit_read<pipe, vector_width>(*input_kernel_queues[i_unit],
+                                                                 column_begin, column_end);
+        }
+    }
+
+    /**
+     * \brief Submit an output kernel of a compute unit that receives the given columns of the
+     * grid.
+     *
+     * If the updater is instrumented, the kernel adds its counters to the write counters of the
+     * compute unit.
+     */
+    template <typename pipe>
+    sycl::event submit_grid_write(uindex_t i_unit, GridImpl &grid, uindex_t column_begin,
+                                  uindex_t column_end) {
+        if constexpr (instrumented) {
+            return grid.template submit_write<pipe, vector_width>(*output_kernel_queues[i_unit],
+                                                                  column_begin, column_end,
+                                                                  counters_buffers[i_unit].write);
+        } else {
+            return grid.template submit_write<pipe, vector_width>(*output_kernel_queues[i_unit],
+                                                                  column_begin, column_end);
+        }
+    }
+
+    /**
+     * \brief Record a kernel with the given name and tags in the timeline, if profiling is enabled.
+     */
+    void record_kernel(char const *name, TimelineEvent tags, sycl::event event) {
+        if (params.profiling) {
+            tags.name = name;
+            timeline.record_kernel(tags, event);
+        }
+    }
+
+    /**
+     * \brief Record a host-side phase that started at the given time and ends now, if profiling
+     * is enabled.
+     */
+    void record_host_phase(char const *name, TimelineEvent tags, double start) {
+        if (params.profiling) {
+            tags.name = name;
+            timeline.record_host(tags, start);
+        }
+    }
+
+    typename KernelFunction::Cell get_kernel_halo_value() const {
+        if constexpr (has_static_values<F>) {
+            return {params.halo_value, StaticValueOf<F>()};
+        } else {
+            return params.halo_value;
+        }
+    }
+
+    /**
+     * \brief Create the queues of the updater if necessary.
+     *
+     * The queues are kept for the whole lifetime of the updater and are only rebuilt if \ref
+     * Params::device or \ref Params::profiling has changed since the last call. Every compute unit
+     * has queues of its own.
+     */
+    void prepare_queues() {
+        if (update_kernel_queues[0].has_value() &&
+            update_kernel_queues[0]->get_device() == params.device &&
+            queues_profiling == params.profiling) {
+            return;
+        }
+        queues_profiling = params.profiling;
+        for (uindex_t i_unit = 0; i_unit < n_compute_units; i_unit++) {
+            input_kernel_queues[i_unit] = make_queue();
+            output_kernel_queues[i_unit] = make_queue();
+            if constexpr (has_static_values<F>) {
+                // The static values are read by a separate kernel that runs concurrently to the
+                // cell input kernel, so it needs a queue of its own.
+                static_input_kernel_queues[i_unit] = make_queue();
+            }
+            if constexpr (has_reduction<F>) {
+                reduction_kernel_queues[i_unit] = make_queue();
+            }
+            if constexpr (has_host_stream<F>) {
+                host_stream_kernel_queues[i_unit] = make_queue();
+            }
+            update_kernel_queues[i_unit] = make_queue();
+        }
+    }
+
+    /**
+     * \brief Create a new in-order queue for the configured device.
+     *
+     * Profiling is only enabled for the queue if \ref Params::profiling is set, since it may add
+     * overhead to every command.
+     */
+    sycl::queue make_queue() const {
+        if (params.profiling) {
+            return sycl::queue(params.device, {sycl::property::queue::enable_profiling{},
+                                               sycl::property::queue::in_order{}});
+        }
+        return sycl::queue(params.device, {sycl::property::queue::in_order{}});
+    }
 
-  private:
     Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<StaticGridImpl> static_grid;
+    std::array<std::vector<GridImpl>, 2> core_grids;
+    std::array<std::optional<sycl::queue>, n_compute_units> input_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> static_input_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> output_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> reduction_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> host_stream_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> update_kernel_queues;
+    bool queues_profiling;
+    std::optional<ReductionResult<Cell, ReductionOf<F>>> reduction_result;
     uindex_t n_processed_cells;
     double walltime;
-    std::vector<sycl::event> work_events;
+    std::vector<std::vector<sycl::event>> work_events;
+    Timeline timeline;
+    std::vector<StencilUpdateCountersBuffers> counters_buffers;
+    std::size_t last_call_first_work_event;
+    std::optional<double> last_call_model_runtime;
 };
 
 } // namespace monotile
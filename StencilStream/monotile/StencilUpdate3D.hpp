@@ -0,0 +1,521 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../Concepts.hpp"
+#include "../Grid3D.hpp"
+#include "../GridPool.hpp"
+#include "../Index.hpp"
+#include "../Stencil3D.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace stencil {
+namespace monotile {
+
+/**
+ * \brief A kernel that executes a three-dimensional stencil transition function using the
+ * monotile approach.
+ *
+ * This is the three-dimensional version of \ref StencilUpdateKernel. It reads the cells of the
+ * grid in column-major order, meaning that the layer index changes with every cell, the row index
+ * after every row and the column index after every plane of `grid_height * grid_depth` cells.
+ *
+ * Every processing element holds the cube of its current stencil in registers, which is shifted
+ * along the layer axis with every cell. The new layer of the cube is assembled from the new input
+ * cell and two caches: A plane cache contains the last `stencil_diameter - 1` planes of the grid
+ * and a row cache contains the last `stencil_diameter - 1` rows of every column of the cube.
+ * Therefore, every processing element needs `(stencil_diameter - 1) * max_grid_height *
+ * max_grid_depth` cells of on-chip memory for the plane cache, which is the 3D equivalent of the
+ * column cache of the 2D kernel.
+ *
+ * The processing elements are chained like in the 2D kernel, so that every pass computes
+ * `n_processing_elements / n_subiterations` iterations.
+ *
+ * The time-dependent values are computed inline by every processing element.
+ *
+ * \tparam TransFunc The transition function to apply.
+ *
+ * \tparam n_processing_elements The number of processing elements in the chain.
+ *
+ * \tparam max_grid_height The maximal number of rows of the grid.
+ *
+ * \tparam max_grid_depth The maximal number of layers of the grid.
+ */
+template <concepts::TransitionFunction3D TransFunc, uindex_t n_processing_elements,
+          uindex_t max_grid_height, uindex_t max_grid_depth>
+    requires(n_processing_elements % TransFunc::n_subiterations == 0)
+class StencilUpdate3DKernel {
+  private:
+    using Cell = typename TransFunc::Cell;
+    using TDV = typename TransFunc::TimeDependentValue;
+    using StencilImpl = Stencil3D<Cell, TransFunc::stencil_radius, TDV>;
+
+    static constexpr uindex_t stencil_radius = TransFunc::stencil_radius;
+    static constexpr uindex_t stencil_diameter = StencilImpl::diameter;
+
+  public:
+    /// \brief The accessor type that is used to read the source grid.
+    using SourceAccessor = sycl::accessor<Cell, 3, sycl::access::mode::read>;
+
+    /// \brief The accessor type that is used to write the target grid.
+    using TargetAccessor = sycl::accessor<Cell, 3, sycl::access::mode::write>;
+
+    /**
+     * \brief The number of cycles between the input of a cell and the output of its updated
+     * value.
+     *
+     * Processing elements that have no iteration left to compute are bypassed, so only the
+     * `n_active_processing_elements` first ones contribute to the latency.
+     */
+    static constexpr uindex_t
+    calc_pipeline_latency(uindex_t grid_height, uindex_t grid_depth,
+                          uindex_t n_active_processing_elements = n_processing_elements) {
+        return n_active_processing_elements * stencil_radius *
+               (grid_height * grid_depth + grid_depth + 1);
+    }
+
+    /**
+     * \brief Create and configure the execution kernel.
+     *
+     * \param trans_func The instance of the transition function to use.
+     *
+     * \param source_ac The accessor to the input grid.
+     *
+     * \param target_ac The accessor to the output grid.
+     *
+     * \param i_iteration The iteration index of the input cells.
+     *
+     * \param target_i_iteration The final, requested iteration index after the updates. The
+     * kernel computes at most `n_processing_elements / n_subiterations` iterations.
+     *
+     * \param grid_range The width, height and depth of the grid. The height and the depth must
+     * be greater than the stencil radius.
+     *
+     * \param halo_value The value of cells outside the grid.
+     */
+    StencilUpdate3DKernel(TransFunc trans_func, SourceAccessor source_ac, TargetAccessor target_ac,
+                          uindex_t i_iteration, uindex_t target_i_iteration, UID3D grid_range,
+                          Cell halo_value)
+        : trans_func(trans_func), source_ac(source_ac), target_ac(target_ac),
+          i_iteration(i_iteration), target_i_iteration(target_i_iteration),
+          grid_range(grid_range), halo_value(halo_value) {
+        assert(grid_range.r <= max_grid_height && grid_range.l <= max_grid_depth);
+        assert(grid_range.r > stencil_radius && grid_range.l > stencil_radius);
+    }
+
+    /**
+     * \brief Execute the kernel.
+     */
+    void operator()() const {
+        index_t grid_width = grid_range.c;
+        index_t grid_height = grid_range.r;
+        index_t grid_depth = grid_range.l;
+
+        // The position of the central cell of every processing element. Every processing element
+        // lags behind its predecessor by the stencil radius in every dimension.
+        [[intel::fpga_register]] index_t c[n_processing_elements];
+        [[intel::fpga_register]] index_t r[n_processing_elements];
+        [[intel::fpga_register]] index_t l[n_processing_elements];
+        // Selects the half of the double-buffered row cache, flipped with every row.
+        [[intel::fpga_register]] bool row_parity[n_processing_elements];
+
+        index_t prev_c = 0;
+        index_t prev_r = 0;
+        index_t prev_l = 0;
+#pragma unroll
+        for (uindex_t i = 0; i < n_processing_elements; i++) {
+            c[i] = prev_c - index_t(stencil_radius);
+            r[i] = prev_r - index_t(stencil_radius);
+            l[i] = prev_l - index_t(stencil_radius);
+            if (l[i] < 0) {
+                l[i] += grid_depth;
+                r[i] -= 1;
+            }
+            if (r[i] < 0) {
+                r[i] += grid_height;
+                c[i] -= 1;
+            }
+            row_parity[i] = false;
+            prev_c = c[i];
+            prev_r = r[i];
+            prev_l = l[i];
+        }
+
+        [[intel::fpga_memory]] Cell plane_cache[2][max_grid_height][max_grid_depth]
+                                               [n_processing_elements][stencil_diameter - 1];
+        [[intel::fpga_memory]] Cell row_cache[2][max_grid_depth][n_processing_elements]
+                                             [stencil_diameter][stencil_diameter - 1];
+        [[intel::fpga_register]] Cell stencil_buffer[n_processing_elements][stencil_diameter]
+                                                    [stencil_diameter][stencil_diameter];
+
+        uindex_t n_cells = grid_range.c * grid_range.r * grid_range.l;
+        uindex_t n_active_processing_elements =
+            std::min(n_processing_elements,
+                     (target_i_iteration - i_iteration) * TransFunc::n_subiterations);
+        uindex_t pipeline_latency =
+            calc_pipeline_latency(grid_range.r, grid_range.l, n_active_processing_elements);
+        UID3D input(0, 0, 0);
+        UID3D output(0, 0, 0);
+        auto advance = [&](UID3D &id) {
+            id.l++;
+            if (id.l == grid_range.l) {
+                id.l = 0;
+                id.r++;
+                if (id.r == grid_range.r) {
+                    id.r = 0;
+                    id.c++;
+                }
+            }
+        };
+
+        for (uindex_t i = 0; i < n_cells + pipeline_latency; i++) {
+            Cell carry = halo_value;
+            if (i < n_cells) {
+                carry = source_ac[sycl::id<3>(input.c, input.r, input.l)];
+                advance(input);
+            }
+
+#pragma unroll
+            for (uindex_t i_pe = 0; i_pe < n_processing_elements; i_pe++) {
+#pragma unroll
+                for (uindex_t cell_c = 0; cell_c < stencil_diameter; cell_c++) {
+#pragma unroll
+                    for (uindex_t cell_r = 0; cell_r < stencil_diameter; cell_r++) {
+#pragma unroll
+                        for (uindex_t cell_l = 0; cell_l < stencil_diameter - 1; cell_l++) {
+                            stencil_buffer[i_pe][cell_c][cell_r][cell_l] =
+                                stencil_buffer[i_pe][cell_c][cell_r][cell_l + 1];
+                        }
+                    }
+                }
+
+                // Assemble the new layer of the stencil buffer: The input cell is the newest cell
+                // of the newest plane, the plane cache provides the same position in the older
+                // planes and the row cache provides the older rows of every plane.
+                uindex_t plane_parity = c[i_pe] & 1;
+#pragma unroll
+                for (uindex_t cache_c = 0; cache_c < stencil_diameter; cache_c++) {
+                    Cell plane_value;
+                    if (cache_c == stencil_diameter - 1) {
+                        plane_value = carry;
+                    } else {
+                        plane_value = plane_cache[plane_parity][r[i_pe]][l[i_pe]][i_pe][cache_c];
+                    }
+                    if (cache_c > 0) {
+                        plane_cache[1 - plane_parity][r[i_pe]][l[i_pe]][i_pe][cache_c - 1] =
+                            plane_value;
+                    }
+
+#pragma unroll
+                    for (uindex_t cache_r = 0; cache_r < stencil_diameter; cache_r++) {
+                        Cell row_value;
+                        if (cache_r == stencil_diameter - 1) {
+                            row_value = plane_value;
+                        } else {
+                            row_value =
+                                row_cache[row_parity[i_pe]][l[i_pe]][i_pe][cache_c][cache_r];
+                        }
+                        if (cache_r > 0) {
+                            row_cache[!row_parity[i_pe]][l[i_pe]][i_pe][cache_c][cache_r - 1] =
+                                row_value;
+                        }
+                        stencil_buffer[i_pe][cache_c][cache_r][stencil_diameter - 1] = row_value;
+                    }
+                }
+
+                uindex_t pe_iteration = i_iteration + i_pe / TransFunc::n_subiterations;
+                uindex_t pe_subiteration = i_pe % TransFunc::n_subiterations;
+                if (pe_iteration < target_i_iteration) {
+                    TDV tdv = trans_func.get_time_dependent_value(pe_iteration);
+                    StencilImpl stencil(ID3D(c[i_pe], r[i_pe], l[i_pe]), grid_range, pe_iteration,
+                                        pe_subiteration, tdv);
+#pragma unroll
+                    for (uindex_t cell_c = 0; cell_c < stencil_diameter; cell_c++) {
+                        index_t grid_c = c[i_pe] + index_t(cell_c) - index_t(stencil_radius);
+#pragma unroll
+                        for (uindex_t cell_r = 0; cell_r < stencil_diameter; cell_r++) {
+                            index_t grid_r = r[i_pe] + index_t(cell_r) - index_t(stencil_radius);
+#pragma unroll
+                            for (uindex_t cell_l = 0; cell_l < stencil_diameter; cell_l++) {
+                                index_t grid_l =
+                                    l[i_pe] + index_t(cell_l) - index_t(stencil_radius);
+                                bool within_grid = grid_c >= 0 && grid_c < grid_width &&
+                                                   grid_r >= 0 && grid_r < grid_height &&
+                                                   grid_l >= 0 && grid_l < grid_depth;
+                                stencil[UID3D(cell_c, cell_r, cell_l)] =
+                                    within_grid ? stencil_buffer[i_pe][cell_c][cell_r][cell_l]
+                                                : halo_value;
+                            }
+                        }
+                    }
+                    carry = trans_func(stencil);
+                }
+                // Idle processing elements pass the carry on without delaying it.
+
+                l[i_pe] += 1;
+                if (l[i_pe] == grid_depth) {
+                    l[i_pe] = 0;
+                    row_parity[i_pe] = !row_parity[i_pe];
+                    r[i_pe] += 1;
+                    if (r[i_pe] == grid_height) {
+                        r[i_pe] = 0;
+                        c[i_pe] += 1;
+                    }
+                }
+            }
+
+            if (i >= pipeline_latency) {
+                target_ac[sycl::id<3>(output.c, output.r, output.l)] = carry;
+                advance(output);
+            }
+        }
+    }
+
+  private:
+    TransFunc trans_func;
+    SourceAccessor source_ac;
+    TargetAccessor target_ac;
+    uindex_t i_iteration;
+    uindex_t target_i_iteration;
+    UID3D grid_range;
+    Cell halo_value;
+};
+
+/**
+ * \brief A grid updater that applies an iterative, three-dimensional stencil code to a grid.
+ *
+ * This is the three-dimensional sibling of \ref StencilUpdate. It uses the \ref
+ * StencilUpdate3DKernel, which streams the grid plane by plane through a chain of processing
+ * elements and therefore provides the same temporal parallelism as the 2D monotile kernel. Since
+ * the processing elements cache whole planes of the grid, an instance of this updater can only
+ * process grids up to the defined `max_grid_height` and `max_grid_depth`. The width of the grid is
+ * not limited. Bigger grids can be processed by \ref tiling::StencilUpdate3D.
+ *
+ * The execution kernel reads and writes the grids in global memory directly.
+ *
+ * \tparam F The transition function to apply to input grids.
+ *
+ * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs)
+ * to implement. It must be a multiple of the number of sub-iterations of the transition function.
+ *
+ * \tparam max_grid_height (Optimization parameter) The maximally supported grid height. The
+ * on-chip memory usage of every PE grows linearly with it.
+ *
+ * \tparam max_grid_depth (Optimization parameter) The maximally supported grid depth. The on-chip
+ * memory usage of every PE grows linearly with it.
+ */
+template <concepts::TransitionFunction3D F, uindex_t n_processing_elements = 1,
+          uindex_t max_grid_height = 64, uindex_t max_grid_depth = 64>
+    requires(n_processing_elements % F::n_subiterations == 0)
+class StencilUpdate3D {
+  private:
+    using Cell = F::Cell;
+    using ExecutionKernelImpl =
+        StencilUpdate3DKernel<F, n_processing_elements, max_grid_height, max_grid_depth>;
+
+    static constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+
+  public:
+    /// \brief Shorthand for the used and supported grid type.
+    using GridImpl = Grid3D<Cell>;
+
+    /**
+     * \brief Parameters for the stencil updater.
+     */
+    struct Params {
+        /**
+         * \brief An instance of the transition function type.
+         *
+         * User applications may store runtime parameters here.
+         */
+        F transition_function;
+
+        /**
+         *  \brief The cell value to present for cells outside of the grid.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         *
+         * This offset will be added to the "actual" iteration index. This way, simulations can
+         * "resume" with the next timestep if the intermediate grid has been evaluated by the host.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The device to use for computations.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief Should the stencil updater block until completion, or return immediately after all
+         * kernels have been submitted.
+         */
+        bool blocking = false;
+    };
+
+    /**
+     * \brief Create a new stencil updater object.
+     */
+    StencilUpdate3D(Params params)
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          kernel_queue(std::nullopt), n_processed_cells(0), walltime(0.0) {}
+
+    /**
+     * \brief Compute a new grid based on the source grid, using the configured transition function.
+     *
+     * The computation does not work in-place. Instead, two additional grids with the same size as
+     * the source grid are requested from the grid pool and used for a double buffering scheme, so
+     * the source grid isn't altered. Without any iterations, a copy of the source grid is
+     * returned.
+     *
+     * If \ref Params::blocking is set to true, this method will block until the computation is
+     * complete. Otherwise, it will return as soon as all kernels are submitted.
+     *
+     * \throws std::range_error The grid is taller or deeper than supported, or its height or depth
+     * isn't greater than the stencil radius.
+     */
+    GridImpl operator()(GridImpl &source_grid) {
+        if (source_grid.get_grid_height() > max_grid_height) {
+            throw std::range_error("The grid is too tall for the stencil update kernel.");
+        }
+        if (source_grid.get_grid_depth() > max_grid_depth) {
+            throw std::range_error("The grid is too deep for the stencil update kernel.");
+        }
+        if (source_grid.get_grid_height() <= F::stencil_radius ||
+            source_grid.get_grid_depth() <= F::stencil_radius) {
+            throw std::range_error(
+                "The height and depth of the grid must be greater than the stencil radius.");
+        }
+
+        sycl::queue queue = get_queue();
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        GridImpl swap_grid_a = grid_pool->acquire(source_grid);
+        GridImpl swap_grid_b = grid_pool->acquire(source_grid);
+        GridImpl *pass_source = &source_grid;
+        GridImpl *pass_target = &swap_grid_b;
+        if (params.n_iterations == 0) {
+            swap_grid_b.submit_copy_from(queue, source_grid);
+            pass_source = &swap_grid_b;
+        }
+
+        UID3D grid_range(source_grid.get_grid_width(), source_grid.get_grid_height(),
+                         source_grid.get_grid_depth());
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i = params.iteration_offset; i < target_n_iterations; i += iters_per_pass) {
+            queue.submit([&](sycl::handler &cgh) {
+                typename ExecutionKernelImpl::SourceAccessor source_ac(pass_source->get_buffer(),
+                                                                       cgh);
+                typename ExecutionKernelImpl::TargetAccessor target_ac(pass_target->get_buffer(),
+                                                                       cgh);
+                ExecutionKernelImpl exec_kernel(params.transition_function, source_ac, target_ac, i,
+                                                target_n_iterations, grid_range,
+                                                params.halo_value);
+                cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+            });
+
+            if (i == params.iteration_offset) {
+                pass_source = &swap_grid_b;
+                pass_target = &swap_grid_a;
+            } else {
+                std::swap(pass_source, pass_target);
+            }
+        }
+
+        if (params.blocking) {
+            queue.wait();
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+        n_processed_cells += params.n_iterations * grid_range.c * grid_range.r * grid_range.l;
+
+        return *pass_source;
+    }
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the number of cells in the grid times the
+     * number of computed iterations.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     */
+    double get_walltime() const { return walltime; }
+
+  private:
+    /**
+     * \brief Return the queue of the updater.
+     *
+     * The queue is kept for the whole lifetime of the updater and is only rebuilt if \ref
+     * Params::device has changed since the last call.
+     */
+    sycl::queue get_queue() {
+        if (!kernel_queue.has_value() || kernel_queue->get_device() != params.device) {
+            kernel_queue = sycl::queue(params.device);
+        }
+        return *kernel_queue;
+    }
+
+    Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<sycl::queue> kernel_queue;
+    uindex_t n_processed_cells;
+    double walltime;
+};
+
+} // namespace monotile
+} // namespace stencil
@@ -19,6 +19,12 @@
  */
 #pragma once
 #include "../Concepts.hpp"
+#include "../Helpers.hpp"
+#include <array>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
 
 namespace stencil {
 namespace tdv {
@@ -66,6 +72,23 @@ concept KernelArgument = stencil::concepts::TransitionFunction<TransFunc> &&
                          LocalState<typename T::LocalState, TransFunc> && std::copyable<T> &&
                          std::constructible_from<typename T::LocalState, T const &>;
 
+/**
+ * \brief The requirements for a TDV kernel argument that covers multiple passes.
+ *
+ * Some execution kernels compute multiple passes in one invocation, for example the monotile
+ * kernel with on-chip loopback. The kernel argument for these kernels is constructed for all
+ * iterations of all passes, and the kernel constructs one \ref
+ * stencil::tdv::single_pass::LocalState "LocalState" per pass from it. For this, the local state
+ * also needs to be constructible from the kernel argument and the iteration offset of the pass,
+ * relative to the iteration offset of the kernel argument.
+ *
+ * \tparam TransFunc The transition function that contains the TDV definition.
+ */
+template <typename T, typename TransFunc>
+concept MultiPassKernelArgument =
+    KernelArgument<T, TransFunc> &&
+    std::constructible_from<typename T::LocalState, T const &, uindex_t>;
+
 /**
  * \brief The requirements for a TDV system's global state.
  *
@@ -79,7 +102,9 @@ concept KernelArgument = stencil::concepts::TransitionFunction<TransFunc> &&
  * The stencil updater will then submit execution kernels for one or multiple passes. For each of
  * these passes, it will construct a \ref stencil::tdv::single_pass::KernelArgument "KernelArgument"
  * on the host using a reference to this global state, a reference to the SYCL handler, as well as
- * the iteration offset and number of iterations of this pass.
+ * the iteration offset and number of iterations of this pass. Kernels that compute multiple passes
+ * in one invocation construct a single kernel argument for all of their iterations instead, see
+ * \ref stencil::tdv::single_pass::MultiPassKernelArgument "MultiPassKernelArgument".
  */
 template <typename T, typename TransFunc>
 concept GlobalState =
@@ -124,6 +149,12 @@ struct InlineStrategy {
                            uindex_t n_iterations)
                 : trans_func(global_state.trans_func), iteration_offset(iteration_offset) {}
 
+            KernelArgument(KernelArgument const &kernel_argument, uindex_t pass_offset)
+                : trans_func(kernel_argument.trans_func),
+                  iteration_offset(kernel_argument.iteration_offset + pass_offset) {}
+
+            KernelArgument(KernelArgument const &kernel_argument) = default;
+
             using LocalState = KernelArgument;
 
             TDV get_time_dependent_value(uindex_t i_iteration) const {
@@ -163,10 +194,11 @@ struct PrecomputeOnDeviceStrategy {
                 : trans_func(global_state.trans_func), iteration_offset(iteration_offset) {}
 
             struct LocalState {
-                LocalState(KernelArgument const &kernel_argument) : values() {
+                LocalState(KernelArgument const &kernel_argument, uindex_t pass_offset = 0)
+                    : values() {
                     for (uindex_t i = 0; i < max_n_iterations; i++) {
                         values[i] = kernel_argument.trans_func.get_time_dependent_value(
-                            kernel_argument.iteration_offset + i);
+                            kernel_argument.iteration_offset + pass_offset + i);
                     }
                 }
 
@@ -220,7 +252,6 @@ struct PrecomputeOnHostStrategy {
             KernelArgument(GlobalState &global_state, sycl::handler &cgh, uindex_t i_iteration,
                            uindex_t n_iterations)
                 : ac() {
-                assert(n_iterations <= max_n_iterations);
                 assert(i_iteration >= global_state.iteration_offset);
                 assert(i_iteration + n_iterations <=
                        global_state.iteration_offset + global_state.value_buffer.get_range()[0]);
@@ -232,12 +263,14 @@ struct PrecomputeOnHostStrategy {
             }
 
             struct LocalState {
-                LocalState(KernelArgument const &kernel_argument) : values() {
+                LocalState(KernelArgument const &kernel_argument, uindex_t pass_offset = 0)
+                    : values() {
                     uindex_t n_values =
-                        std::min(max_n_iterations, uindex_t(kernel_argument.ac.get_range()[0]));
+                        std::min(max_n_iterations,
+                                 uindex_t(kernel_argument.ac.get_range()[0]) - pass_offset);
 
                     for (uindex_t i = 0; i < n_values; i++)
-                        values[i] = kernel_argument.ac[i];
+                        values[i] = kernel_argument.ac[pass_offset + i];
                 }
 
                 TDV get_time_dependent_value(uindex_t i) const { return values[i]; }
@@ -257,6 +290,151 @@ struct PrecomputeOnHostStrategy {
     };
 };
 
+/**
+ * \brief A TDV implementation strategy that precomputes TDVs on the host in chunks of bounded size.
+ *
+ * Like the \ref PrecomputeOnHostStrategy, this strategy computes the time-dependent values on the
+ * host and the execution kernel loads the values of its pass from a global memory buffer. However,
+ * the values aren't computed all at once before the first pass, but in chunks of `chunk_length`
+ * iterations. The global state keeps a ring of `n_chunks` chunks, which are computed by host worker
+ * threads. Once the first pass of a chunk is submitted, the previous chunk isn't needed anymore and
+ * the computation of the chunk that replaces it in the ring starts. Therefore, the host computes
+ * the next chunks while the device works on the current one, the first kernel only waits for the
+ * first chunk and the required memory doesn't depend on the number of iterations.
+ *
+ * Since the slots of the ring are reused, the passes have to be submitted in the order of their
+ * iterations, which all stencil updaters do. Every pass must be contained in a single chunk, so
+ * `chunk_length` has to be a multiple of the maximal number of iterations the global state is
+ * instantiated with, which is the number of processing elements for the built-in updaters. Since
+ * the kernel argument never covers more than one chunk, this strategy doesn't support the \ref
+ * MultiPassKernelArgument "multi-pass kernel arguments" of the monotile on-chip loopback.
+ *
+ * \tparam chunk_length The number of time-dependent values in a chunk.
+ *
+ * \tparam n_chunks The number of chunks that are kept at the same time. Two chunks give double
+ * buffering.
+ */
+template <uindex_t chunk_length = 1024, uindex_t n_chunks = 2>
+    requires(chunk_length >= 1 && n_chunks >= 1)
+struct ChunkedPrecomputeOnHostStrategy {
+    template <stencil::concepts::TransitionFunction TransFunc, uindex_t max_n_iterations>
+        requires(chunk_length % max_n_iterations == 0)
+    class GlobalState {
+      public:
+        using TDV = typename TransFunc::TimeDependentValue;
+
+        GlobalState(TransFunc function, uindex_t iteration_offset, uindex_t n_iterations)
+            : ring(std::make_shared<Ring>(function, iteration_offset, n_iterations)) {
+            for (uindex_t i_chunk = 0; i_chunk < std::min(n_chunks, ring->n_chunks_total);
+                 i_chunk++) {
+                ring->start_chunk(i_chunk);
+            }
+        }
+
+        struct KernelArgument {
+            KernelArgument(GlobalState &global_state, sycl::handler &cgh, uindex_t i_iteration,
+                           uindex_t n_iterations)
+                : ac() {
+                Ring &ring = *global_state.ring;
+                assert(i_iteration >= ring.iteration_offset);
+                uindex_t i_chunk = (i_iteration - ring.iteration_offset) / chunk_length;
+                uindex_t chunk_offset = (i_iteration - ring.iteration_offset) % chunk_length;
+                assert(chunk_offset + n_iterations <= chunk_length);
+
+                sycl::buffer<TDV, 1> chunk_buffer = ring.load_chunk(i_chunk);
+                sycl::range<1> access_range(n_iterations);
+                sycl::id<1> access_offset(chunk_offset);
+                ac = sycl::accessor<TDV, 1, sycl::access::mode::read>(chunk_buffer, cgh,
+                                                                      access_range, access_offset);
+            }
+
+            struct LocalState {
+                LocalState(KernelArgument const &kernel_argument) : values() {
+                    uindex_t n_values =
+                        std::min(max_n_iterations, uindex_t(kernel_argument.ac.get_range()[0]));
+
+                    for (uindex_t i = 0; i < n_values; i++)
+                        values[i] = kernel_argument.ac[i];
+                }
+
+                TDV get_time_dependent_value(uindex_t i) const { return values[i]; }
+
+              private:
+                TDV values[max_n_iterations];
+            };
+
+          private:
+            sycl::accessor<TDV, 1, sycl::access::mode::read> ac;
+        };
+
+      private:
+        /**
+         * \brief The ring of chunks, which is shared by all copies of the global state.
+         */
+        struct Ring {
+            Ring(TransFunc function, uindex_t iteration_offset, uindex_t n_iterations)
+                : function(function), iteration_offset(iteration_offset),
+                  n_iterations(n_iterations),
+                  n_chunks_total(n_cells_to_n_words(n_iterations, chunk_length)), slots() {}
+
+            /**
+             * \brief Start the computation of the given chunk in its slot.
+             */
+            void start_chunk(uindex_t i_chunk) {
+                uindex_t first_iteration = iteration_offset + i_chunk * chunk_length;
+                uindex_t n_values = std::min(chunk_length, n_iterations - i_chunk * chunk_length);
+                Slot &slot = slots[i_chunk % n_chunks];
+                slot.i_chunk = i_chunk;
+                slot.buffer = std::nullopt;
+                slot.values = std::async(std::launch::async, [=, function = this->function]() {
+                    std::vector<TDV> values(n_values);
+                    for (uindex_t i = 0; i < n_values; i++) {
+                        values[i] = function.get_time_dependent_value(first_iteration + i);
+                    }
+                    return values;
+                });
+            }
+
+            /**
+             * \brief Return the buffer with the values of the given chunk.
+             *
+             * If the chunk is loaded for the first time, this waits for its computation and
+             * copies the values into a buffer. Since the chunks are loaded in order, the previous
+             * chunk isn't needed anymore and its slot is refilled with the next chunk that uses it.
+             */
+            sycl::buffer<TDV, 1> load_chunk(uindex_t i_chunk) {
+                Slot &slot = slots[i_chunk % n_chunks];
+                if (slot.i_chunk != i_chunk || (!slot.buffer.has_value() && !slot.values.valid())) {
+                    // Only happens if there is a single slot.
+                    start_chunk(i_chunk);
+                }
+                if (!slot.buffer.has_value()) {
+                    std::vector<TDV> values = slot.values.get();
+                    slot.buffer = sycl::buffer<TDV, 1>(values.begin(), values.end());
+                    if (n_chunks > 1 && i_chunk >= 1 && i_chunk - 1 + n_chunks < n_chunks_total) {
+                        start_chunk(i_chunk - 1 + n_chunks);
+                    }
+                }
+                return *slot.buffer;
+            }
+
+            struct Slot {
+                uindex_t i_chunk = 0;
+                std::future<std::vector<TDV>> values;
+                std::optional<sycl::buffer<TDV, 1>> buffer;
+            };
+
+            TransFunc function;
+            uindex_t iteration_offset;
+            uindex_t n_iterations;
+            uindex_t n_chunks_total;
+            std::array<Slot, n_chunks> slots;
+        };
+
+        std::shared_ptr<Ring> ring;
+    };
+};
+
 } // namespace single_pass
 } // namespace tdv
 } // namespace stencil
\ No newline at end of file
@@ -0,0 +1,475 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../Concepts.hpp"
+#include "../GridPool.hpp"
+#include "../Index.hpp"
+#include "../tdv/SinglePassStrategies.hpp"
+#include "Grid.hpp"
+#include "StencilUpdate.hpp"
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stencil {
+namespace tiling {
+
+/**
+ * \brief A grid updater that distributes a grid across multiple ranks, for example the FPGAs of a
+ * cluster.
+ *
+ * The global grid is partitioned into vertical strips, one per rank, which are returned by \ref
+ * get_column_begin and \ref get_column_end. Every rank stores its strip in a local grid and
+ * updates it with the kernels of the \ref StencilUpdate. Internally, the strip is extended by
+ * `halo_radius` ghost columns on every side with a neighbor. After every pass, the outermost
+ * `halo_radius` columns of the strip are sent to the neighbors, which store them in their ghost
+ * columns. Since one pass only consumes `halo_radius` cells of halo, this keeps the strip exact.
+ *
+ * To overlap the exchange with the computation, the tile columns that contain the border columns
+ * are computed first. Then, the border columns are copied into small buffers, and the remaining
+ * tiles are submitted. While the device computes these interior tiles, the host transfers the
+ * border columns and finally enqueues the copy of the received columns into the ghost columns.
+ *
+ * The transition function sees global cell positions and the size of the global grid. Static
+ * values, reductions and boundary conditions other than the constant one are not supported.
+ *
+ * \tparam F The transition function to apply.
+ *
+ * \tparam Communicator The type of the channel between the ranks. It has to fulfill the \ref
+ * stencil::concepts::Communicator "Communicator" concept for the cell type, for example \ref
+ * MPICommunicator.
+ *
+ * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs) to
+ * implement. See \ref StencilUpdate.
+ *
+ * \tparam tile_width (Optimization parameter) The width of the tile that is updated in one pass.
+ * See \ref StencilUpdate.
+ *
+ * \tparam tile_height (Optimization parameter) The height of the tile that is updated in one pass.
+ * See \ref StencilUpdate.
+ *
+ * \tparam TDVStrategy (Optimization parameter) The precomputation strategy for the time-dependent
+ * value system.
+ *
+ * \tparam dense_storage (Optimization parameter) Store cells densely packed in the on-chip caches.
+ * See \ref StencilUpdate.
+ */
+template <concepts::TransitionFunction F, typename Communicator,
+          uindex_t n_processing_elements = 1, uindex_t tile_width = 1024,
+          uindex_t tile_height = 1024,
+          tdv::single_pass::Strategy<F, n_processing_elements> TDVStrategy =
+              tdv::single_pass::InlineStrategy,
+          bool dense_storage = false>
+    requires(concepts::Communicator<Communicator, typename F::Cell> && !has_static_values<F> &&
+             boundary_condition_of<F> == BoundaryCondition::Constant)
+class DistributedStencilUpdate {
+  private:
+    using Cell = F::Cell;
+    using TDVGlobalState = typename TDVStrategy::template GlobalState<F, n_processing_elements>;
+    using TDVKernelArgument = typename TDVGlobalState::KernelArgument;
+
+  public:
+    /**
+     * \brief The radius of an input's tile halo, and the number of ghost columns.
+     */
+    static constexpr uindex_t halo_radius = F::stencil_radius * n_processing_elements;
+
+    /**
+     * \brief A shorthand for the used and supported grid type.
+     */
+    using GridImpl = Grid<Cell, tile_width, tile_height, halo_radius>;
+
+    /**
+     * \brief Parameters for the distributed stencil updater.
+     */
+    struct Params {
+        /**
+         * \brief An instance of the transition function type.
+         */
+        F transition_function;
+
+        /**
+         *  \brief The cell value to present for cells outside of the global grid.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The device to use for computations.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief Should the stencil updater block until completion, or return immediately after all
+         * kernels have been submitted.
+         *
+         * Either way, the host blocks for the exchange after every pass but the last one.
+         */
+        bool blocking = false;
+
+        /**
+         * \brief The contents of the constant table of the transition function.
+         *
+         * This is only used if the transition function defines a \ref stencil::ConstantTable
+         * "constant table". The table is copied to the device once per kernel and shared by all
+         * processing elements.
+         */
+        ConstantTableOf<F> constant_table = ConstantTableOf<F>();
+    };
+
+    /**
+     * \brief Create a new distributed stencil updater object.
+     *
+     * All ranks have to create their updater with the same global grid width.
+     *
+     * \param params The parameters of the updater.
+     *
+     * \param communicator The channel to the neighboring ranks.
+     *
+     * \param global_grid_width The width of the global grid.
+     *
+     * \throws std::invalid_argument A strip of the grid would be narrower than the halo radius.
+     */
+    DistributedStencilUpdate(Params params, Communicator communicator, uindex_t global_grid_width)
+        : params(params), communicator(communicator), global_grid_width(global_grid_width),
+          grid_pool(std::make_shared<GridPool<GridImpl>>()), swap_grids(), n_processed_cells(0),
+          walltime(0.0) {
+        uindex_t rank = communicator.get_rank();
+        uindex_t n_ranks = communicator.get_n_ranks();
+        column_begin = rank * global_grid_width / n_ranks;
+        column_end = (rank + 1) * global_grid_width / n_ranks;
+        // All strips have a width of either floor(W/n) or ceil(W/n). The check covers the narrowest
+        // one, so that all ranks agree.
+        if (n_ranks > 1 && global_grid_width / n_ranks < halo_radius) {
+            throw std::invalid_argument("Every rank needs at least halo_radius grid columns.");
+        }
+    }
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return the pool from which the updater requests its output grids.
+     *
+     * The swap grids with the ghost columns are only used internally. They are kept by the updater
+     * and only reallocated if the height of the local grid changes.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the index of the first global grid column that is stored by this rank.
+     */
+    uindex_t get_column_begin() const { return column_begin; }
+
+    /**
+     * \brief Return the index after the last global grid column that is stored by this rank.
+     */
+    uindex_t get_column_end() const { return column_end; }
+
+    /**
+     * \brief Compute the next strip of the grid, based on the strip of this rank.
+     *
+     * All ranks have to call this method with the same parameters, since they exchange their
+     * border columns after every pass.
+     *
+     * \param local_grid The columns \ref get_column_begin to \ref get_column_end of the global
+     * grid. It isn't modified.
+     *
+     * \returns The updated columns of this rank.
+     *
+     * \throws std::range_error The local grid doesn't have the width of this rank's strip.
+     */
+    GridImpl operator()(GridImpl &local_grid) {
+        uindex_t n_columns = column_end - column_begin;
+        if (local_grid.get_grid_width() != n_columns) {
+            throw std::range_error("The local grid doesn't match the columns of this rank.");
+        }
+        if (params.n_iterations == 0) {
+            return GridImpl(local_grid);
+        }
+
+        prepare_queues();
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        uindex_t grid_height = local_grid.get_grid_height();
+        uindex_t rank = communicator.get_rank();
+        uindex_t left_ghost = rank > 0 ? halo_radius : 0;
+        uindex_t right_ghost = rank + 1 < communicator.get_n_ranks() ? halo_radius : 0;
+        uindex_t extended_width = left_ghost + n_columns + right_ghost;
+
+        for (std::optional<GridImpl> &swap_grid : swap_grids) {
+            if (!swap_grid.has_value() || swap_grid->get_grid_height() != grid_height) {
+                swap_grid = GridImpl(extended_width, grid_height);
+            }
+        }
+        GridImpl &swap_grid_a = *swap_grids[0];
+        GridImpl &swap_grid_b = *swap_grids[1];
+        sycl::buffer<Cell, 2> strip_buffer(sycl::range<2>(n_columns, grid_height));
+        local_grid.submit_copy_columns_to_buffer(*output_kernel_queue, strip_buffer, 0);
+        swap_grid_a.submit_copy_columns_from_buffer(*output_kernel_queue, strip_buffer,
+                                                    left_ghost);
+        exchange_borders(swap_grid_a, submit_border_copies(swap_grid_a, left_ghost, n_columns,
+                                                           right_ghost),
+                         left_ghost, n_columns);
+
+        // The tile columns that contain border columns are computed first.
+        UID tile_range = swap_grid_a.get_tile_range();
+        std::vector<uindex_t> border_tile_columns, interior_tile_columns;
+        for (uindex_t tile_c = 0; tile_c < tile_range.c; tile_c++) {
+            uindex_t tile_begin = tile_c * tile_width;
+            uindex_t tile_end = tile_begin + tile_width;
+            bool has_left_border = left_ghost != 0 && tile_begin < left_ghost + halo_radius &&
+                                   tile_end > left_ghost;
+            bool has_right_border = right_ghost != 0 && tile_begin < left_ghost + n_columns &&
+                                    tile_end > left_ghost + n_columns - halo_radius;
+            if (has_left_border || has_right_border) {
+                border_tile_columns.push_back(tile_c);
+            } else {
+                interior_tile_columns.push_back(tile_c);
+            }
+        }
+
+        F trans_func(params.transition_function);
+        TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
+        uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+        GridImpl *pass_source = &swap_grid_a;
+        GridImpl *pass_target = &swap_grid_b;
+
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i = params.iteration_offset; i < target_n_iterations; i += iters_per_pass) {
+            uindex_t iters_in_this_pass = std::min(iters_per_pass, target_n_iterations - i);
+            bool last_pass = i + iters_in_this_pass == target_n_iterations;
+
+            auto submit_tile_column = [&](uindex_t tile_c) {
+                for (uindex_t tile_r = 0; tile_r < tile_range.r; tile_r++) {
+                    submit_tile(*pass_source, *pass_target, tile_c, tile_r, i, iters_in_this_pass,
+                                target_n_iterations, left_ghost, tdv_global_state);
+                }
+            };
+
+            for (uindex_t tile_c : border_tile_columns) {
+                submit_tile_column(tile_c);
+            }
+            BorderCopies border_copies;
+            if (!last_pass) {
+                border_copies =
+                    submit_border_copies(*pass_target, left_ghost, n_columns, right_ghost);
+            }
+            for (uindex_t tile_c : interior_tile_columns) {
+                submit_tile_column(tile_c);
+            }
+            if (!last_pass) {
+                exchange_borders(*pass_target, border_copies, left_ghost, n_columns);
+            }
+
+            std::swap(pass_source, pass_target);
+        }
+
+        GridImpl result = grid_pool->acquire(local_grid);
+        pass_source->submit_copy_columns_to_buffer(*output_kernel_queue, strip_buffer, left_ghost);
+        result.submit_copy_columns_from_buffer(*output_kernel_queue, strip_buffer, 0);
+
+        if (params.blocking) {
+            output_kernel_queue->wait();
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+        n_processed_cells += params.n_iterations * n_columns * grid_height;
+
+        return result;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this rank.
+     *
+     * Only the cells of this rank's strip are counted, not the ghost columns.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     */
+    double get_walltime() const { return walltime; }
+
+  private:
+    /**
+     * \brief The buffers with the border columns of a grid that are sent to the neighbors.
+     */
+    struct BorderCopies {
+        std::optional<sycl::buffer<Cell, 2>> left, right;
+    };
+
+    /**
+     * \brief Submit the kernels that compute a tile of a pass.
+     */
+    void submit_tile(GridImpl &pass_source, GridImpl &pass_target, uindex_t tile_c,
+                     uindex_t tile_r, uindex_t i_iteration, uindex_t iters_in_this_pass,
+                     uindex_t target_n_iterations, uindex_t left_ghost,
+                     TDVGlobalState &tdv_global_state) {
+        using in_pipe = sycl::pipe<class distributed_tiling_in_pipe, Cell>;
+        using out_pipe = sycl::pipe<class distributed_tiling_out_pipe, Cell>;
+        using ExecutionKernelImpl =
+            StencilUpdateKernel<F, TDVKernelArgument, n_processing_elements, tile_width,
+                                tile_height, in_pipe, out_pipe, dense_storage>;
+
+        pass_source.template submit_read<in_pipe>(*input_kernel_queue, tile_c, tile_r,
+                                                  params.halo_value);
+        working_queue->submit([&](sycl::handler &cgh) {
+            TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i_iteration,
+                                                  iters_in_this_pass);
+            ExecutionKernelImpl exec_kernel(
+                params.transition_function, i_iteration, target_n_iterations, tile_c * tile_width,
+                tile_r * tile_height, pass_source.get_grid_width(), pass_source.get_grid_height(),
+                params.halo_value, tdv_kernel_argument);
+            exec_kernel.set_global_columns(index_t(column_begin) - index_t(left_ghost),
+                                           global_grid_width);
+            exec_kernel.set_constant_table(params.constant_table);
+            cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+        });
+        pass_target.template submit_write<out_pipe>(*output_kernel_queue, tile_c, tile_r);
+    }
+
+    /**
+     * \brief Submit the copies of the columns of the grid that are sent to the neighbors.
+     */
+    BorderCopies submit_border_copies(GridImpl &grid, uindex_t left_ghost, uindex_t n_columns,
+                                      uindex_t right_ghost) {
+        sycl::range<2> border_range(halo_radius, grid.get_grid_height());
+        BorderCopies copies;
+        if (left_ghost != 0) {
+            copies.left = sycl::buffer<Cell, 2>(border_range);
+            grid.submit_copy_columns_to_buffer(*output_kernel_queue, *copies.left, left_ghost);
+        }
+        if (right_ghost != 0) {
+            copies.right = sycl::buffer<Cell, 2>(border_range);
+            grid.submit_copy_columns_to_buffer(*output_kernel_queue, *copies.right,
+                                               left_ghost + n_columns - halo_radius);
+        }
+        return copies;
+    }
+
+    /**
+     * \brief Send the border columns to the neighbors and copy their border columns into the
+     * ghost columns of the grid.
+     *
+     * This blocks until the border copies are complete and the neighbors have sent their border
+     * columns, but not until the rest of the grid is computed.
+     */
+    void exchange_borders(GridImpl &grid, BorderCopies const &copies, uindex_t left_ghost,
+                          uindex_t n_columns) {
+        uindex_t grid_height = grid.get_grid_height();
+        uindex_t n_border_cells = halo_radius * grid_height;
+
+        auto to_vector = [&](std::optional<sycl::buffer<Cell, 2>> buffer) {
+            std::vector<Cell> cells;
+            if (buffer.has_value()) {
+                sycl::host_accessor ac(*buffer, sycl::read_only);
+                cells.reserve(n_border_cells);
+                for (uindex_t c = 0; c < halo_radius; c++) {
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        cells.push_back(ac[c][r]);
+                    }
+                }
+            }
+            return cells;
+        };
+        std::vector<Cell> send_left = to_vector(copies.left);
+        std::vector<Cell> send_right = to_vector(copies.right);
+        std::vector<Cell> receive_left(copies.left.has_value() ? n_border_cells : 0);
+        std::vector<Cell> receive_right(copies.right.has_value() ? n_border_cells : 0);
+
+        communicator.exchange(send_left, send_right, receive_left, receive_right);
+
+        auto copy_to_ghosts = [&](std::vector<Cell> const &cells, uindex_t column_begin) {
+            sycl::buffer<Cell, 2> ghost_buffer(sycl::range<2>(halo_radius, grid_height));
+            {
+                sycl::host_accessor ac(ghost_buffer, sycl::write_only);
+                for (uindex_t c = 0; c < halo_radius; c++) {
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        ac[c][r] = cells[c * grid_height + r];
+                    }
+                }
+            }
+            grid.submit_copy_columns_from_buffer(*output_kernel_queue, ghost_buffer,
+                                                 column_begin);
+        };
+        if (copies.left.has_value()) {
+            copy_to_ghosts(receive_left, 0);
+        }
+        if (copies.right.has_value()) {
+            copy_to_ghosts(receive_right, left_ghost + n_columns);
+        }
+    }
+
+    /**
+     * \brief Create the queues of the updater if necessary.
+     */
+    void prepare_queues() {
+        if (working_queue.has_value() && working_queue->get_device() == params.device) {
+            return;
+        }
+        input_kernel_queue = sycl::queue(params.device, {sycl::property::queue::in_order{}});
+        output_kernel_queue = sycl::queue(params.device, {sycl::property::queue::in_order{}});
+        working_queue = sycl::queue(params.device, {sycl::property::queue::in_order{}});
+    }
+
+    Params params;
+    Communicator communicator;
+    uindex_t global_grid_width;
+    uindex_t column_begin, column_end;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::array<std::optional<GridImpl>, 2> swap_grids;
+    std::optional<sycl::queue> input_kernel_queue;
+    std::optional<sycl::queue> output_kernel_queue;
+    std::optional<sycl::queue> working_queue;
+    uindex_t n_processed_cells;
+    double walltime;
+};
+
+} // namespace tiling
+} // namespace stencil
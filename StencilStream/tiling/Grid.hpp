@@ -21,8 +21,18 @@
 #include "../AccessorSubscript.hpp"
 #include "../Concepts.hpp"
 #include "../GenericID.hpp"
+#include "../Helpers.hpp"
+#include "../KernelCounters.hpp"
+#include <array>
+#include <concepts>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 namespace stencil {
@@ -56,7 +66,19 @@ namespace tiling {
  *
  * On the device side, the data can be read or written with the help of the method templates \ref
  * submit_read and \ref submit_write. Those take a SYCL pipe as a template argument and enqueue
- * kernels that read/write the contents of the grid to/from the pipes.
+ * kernels that read/write the contents of the grid to/from the pipes. \ref submit_read_tiles and
+ * \ref submit_write_tiles do the same for all tiles of the grid in a single kernel each.
+ *
+ * The cells are stored in tile-major order: The cells of a tile are stored next to each other,
+ * column by column, and every tile column is padded to a whole number of memory words. The
+ * kernels therefore move whole, aligned words to and from global memory, and a tile can be read in
+ * long bursts instead of one strided column of the grid at a time. The halo of a tile is made up of
+ * column segments of the neighboring tiles, which are aligned words too. Whether a segment lies
+ * outside of the grid, and has to be replaced by the halo value, is decided once per segment
+ * instead of once per cell.
+ *
+ * The cells are stored in the format of their \ref CellCodec. The read kernels decode them
+ * before they are sent into the pipe and the write kernels encode them after they are received.
  *
  * \tparam Cell The cell type to store.
  *
@@ -68,12 +90,29 @@ namespace tiling {
  *
  * \tparam halo_radius The halo radius required for input tiles. This has to be the number of PEs in
  * a \ref StencilUpdate times the stencil radius of the implemented transition function.
+ *
+ * \tparam word_size The word size of the memory system, in bytes. This is used to optimize the
+ * kernels submitted by \ref submit_read and \ref submit_write.
  */
 template <typename Cell, uindex_t tile_width = 1024, uindex_t tile_height = 1024,
-          uindex_t halo_radius = 1>
+          uindex_t halo_radius = 1, uindex_t word_size = 64>
 class Grid {
     static_assert(2 * halo_radius < tile_height && 2 * halo_radius < tile_width);
 
+  private:
+    using Codec = CellCodec<Cell>;
+    using StoredCell = typename Codec::Storage;
+    static constexpr uindex_t word_length =
+        std::lcm(sizeof(StoredCell), word_size) / sizeof(StoredCell);
+    using IOWord = std::array<StoredCell, word_length>;
+    static constexpr uindex_t words_per_tile_column = n_cells_to_n_words(tile_height, word_length);
+    static constexpr uindex_t words_per_tile = tile_width * words_per_tile_column;
+
+    static sycl::range<1> buffer_range(uindex_t grid_width, uindex_t grid_height) {
+        return sycl::range<1>(n_cells_to_n_words(grid_width, tile_width) *
+                              n_cells_to_n_words(grid_height, tile_height) * words_per_tile);
+    }
+
   public:
     /**
      * \brief The number of dimensions of the grid.
@@ -90,7 +129,8 @@ class Grid {
      * \param grid_height The height, or number of rows, of the new grid.
      */
     Grid(uindex_t grid_width, uindex_t grid_height)
-        : grid_buffer(sycl::range<2>(grid_width, grid_height)) {}
+        : tile_buffer(buffer_range(grid_width, grid_height)), grid_width(grid_width),
+          grid_height(grid_height) {}
 
     /**
      * \brief Create a new, uninitialized grid with the given dimensions.
@@ -98,7 +138,9 @@ class Grid {
      * \param range The range of the new grid. The first index will be the width and the second
      * index will be the height of the grid.
      */
-    Grid(sycl::range<2> range) : grid_buffer(range) {}
+    Grid(sycl::range<2> range)
+        : tile_buffer(buffer_range(range[0], range[1])), grid_width(range[0]),
+          grid_height(range[1]) {}
 
     /**
      * \brief Create a new grid with the same size and contents as the given SYCL buffer.
@@ -108,7 +150,9 @@ class Grid {
      *
      * \param input_buffer The buffer with the contents of the new grid.
      */
-    Grid(sycl::buffer<Cell, 2> input_buffer) : grid_buffer(input_buffer.get_range()) {
+    Grid(sycl::buffer<Cell, 2> input_buffer)
+        : tile_buffer(buffer_range(input_buffer.get_range()[0], input_buffer.get_range()[1])),
+          grid_width(input_buffer.get_range()[0]), grid_height(input_buffer.get_range()[1]) {
         copy_from_buffer(input_buffer);
     }
 
@@ -121,18 +165,26 @@ class Grid {
      *
      * \param other_grid The other grid the new grid should reference.
      */
-    Grid(Grid const &other_grid) : grid_buffer(other_grid.grid_buffer) {}
+    Grid(Grid const &other_grid)
+        : tile_buffer(other_grid.tile_buffer), grid_width(other_grid.grid_width),
+          grid_height(other_grid.grid_height), references(other_grid.references) {}
 
     /**
-     * \brief An accessor for the monotile grid.
+     * \brief An accessor for the tiling grid.
      *
      * Instances of this class provide access to a grid, so that host code can read and write the
      * contents of a grid. As such, it fullfils the \ref stencil::concepts::GridAccessor
-     * "GridAccessor" concept.
+     * "GridAccessor" concept. If the cells are stored in the format of a \ref CellCodec, they are
+     * decoded when the accessor is created and encoded again when it's destroyed.
      *
      * \tparam access_mode The access mode for the accessor.
      */
     template <sycl::access::mode access_mode> class GridAccessor {
+      private:
+        using accessor_t = sycl::host_accessor<IOWord, 1, access_mode>;
+        using CellRef =
+            std::conditional_t<access_mode == sycl::access::mode::read, Cell const, Cell>;
+
       public:
         /**
          * \brief The number of dimensions of the underlying grid.
@@ -142,7 +194,38 @@ class Grid {
         /**
          * \brief Create a new accessor to the given grid.
          */
-        GridAccessor(Grid &grid) : accessor(grid.grid_buffer) {}
+        GridAccessor(Grid &grid)
+            : ac(grid.tile_buffer), tile_range_r(grid.get_tile_range().r),
+              grid_width(grid.get_grid_width()), grid_height(grid.get_grid_height()) {
+            if constexpr (has_cell_codec<Cell>) {
+                cells = std::make_unique<Cell[]>(grid_width * grid_height);
+                if constexpr (access_mode != sycl::access::mode::discard_write &&
+                              access_mode != sycl::access::mode::discard_read_write) {
+                    for (uindex_t c = 0; c < grid_width; c++) {
+                        for (uindex_t r = 0; r < grid_height; r++) {
+                            cells[c * grid_height + r] = Codec::decode(stored_cell(c, r));
+                        }
+                    }
+                }
+            }
+        }
+
+        GridAccessor(GridAccessor const &) = delete;
+        GridAccessor &operator=(GridAccessor const &) = delete;
+
+        /**
+         * \brief Encode the cells back into the grid, if they are decoded and the accessor isn't
+         * read-only.
+         */
+        ~GridAccessor() {
+            if constexpr (has_cell_codec<Cell> && access_mode != sycl::access::mode::read) {
+                for (uindex_t c = 0; c < grid_width; c++) {
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        stored_cell(c, r) = Codec::encode(cells[c * grid_height + r]);
+                    }
+                }
+            }
+        }
 
         /**
          * \brief Shorthand for the used subscript type.
@@ -167,7 +250,11 @@ class Grid {
         Cell const &operator[](sycl::id<2> id)
             requires(access_mode == sycl::access::mode::read)
         {
-            return accessor[id];
+            if constexpr (has_cell_codec<Cell>) {
+                return cells[id[0] * grid_height + id[1]];
+            } else {
+                return stored_cell(id[0], id[1]);
+            }
         }
 
         /**
@@ -179,11 +266,51 @@ class Grid {
         Cell &operator[](sycl::id<2> id)
             requires(access_mode != sycl::access::mode::read)
         {
-            return accessor[id];
+            if constexpr (has_cell_codec<Cell>) {
+                return cells[id[0] * grid_height + id[1]];
+            } else {
+                return stored_cell(id[0], id[1]);
+            }
+        }
+
+        /**
+         * \brief Return a view of the cells of a column that lie in one row of tiles.
+         *
+         * Within a tile, the cells of a column are stored next to each other, but the segments of
+         * a grid column in different tiles are not. Host code that walks the grid column by column
+         * can therefore iterate over the tile rows and process the returned span of every
+         * segment sequentially, instead of computing the position of every cell like the subscript
+         * operators.
+         *
+         * \param c The index of the grid column.
+         *
+         * \param tile_r The index of the tile row. The span contains the grid rows from
+         * `tile_r * tile_height` on, up to the end of the tile or the grid.
+         */
+        std::span<CellRef> get_column_segment(uindex_t c, uindex_t tile_r) {
+            uindex_t r = tile_r * tile_height;
+            uindex_t n_cells = std::min<uindex_t>(tile_height, grid_height - r);
+            if constexpr (has_cell_codec<Cell>) {
+                return std::span<CellRef>(cells.get() + c * grid_height + r, n_cells);
+            } else {
+                uindex_t word_i =
+                    Grid::word_index(tile_range_r, c / tile_width, tile_r, c % tile_width);
+                return std::span<CellRef>(ac[word_i].data(), n_cells);
+            }
         }
 
       private:
-        sycl::host_accessor<Cell, 2, access_mode> accessor;
+        decltype(auto) stored_cell(uindex_t c, uindex_t r) const {
+            uindex_t word_i =
+                Grid::word_index(tile_range_r, c / tile_width, r / tile_height, c % tile_width) +
+                r % tile_height / word_length;
+            return ac[word_i][r % tile_height % word_length];
+        }
+
+        accessor_t ac;
+        uindex_t tile_range_r, grid_width, grid_height;
+        // Only used if the cells are stored in a different format.
+        std::unique_ptr<Cell[]> cells;
     };
 
     /**
@@ -193,21 +320,32 @@ class Grid {
      * buffer however has to have the same size as the grid, otherwise a \ref std::range_error is
      * thrown.
      *
+     * The cells are copied by multiple host threads, one column segment of a tile at a time. These
+     * segments are contiguous in both layouts, so they are copied bytewise unless there is a \ref
+     * CellCodec for the cell type.
+     *
      * \param input_buffer The buffer to copy the data from.
      * \throws std::range_error The size of the buffer does not match the grid.
      */
     void copy_from_buffer(sycl::buffer<Cell, 2> input_buffer) {
-        if (input_buffer.get_range() != grid_buffer.get_range()) {
+        if (input_buffer.get_range() != sycl::range<2>(grid_width, grid_height)) {
             throw std::out_of_range("The target buffer has not the same size as the grid");
         }
 
-        sycl::host_accessor grid_ac{grid_buffer, sycl::write_only};
+        sycl::host_accessor tile_ac(tile_buffer, sycl::write_only, sycl::no_init);
         sycl::host_accessor input_ac{input_buffer, sycl::read_only};
-        for (uindex_t c = 0; c < get_grid_width(); c++) {
-            for (uindex_t r = 0; r < get_grid_height(); r++) {
-                grid_ac[c][r] = input_ac[c][r];
+        Cell const *cells = input_ac.get_pointer();
+        for_each_tile_column_segment([&](uindex_t c, uindex_t r, uindex_t word_i, uindex_t n) {
+            StoredCell *segment = tile_ac[word_i].data();
+            Cell const *column = cells + c * grid_height + r;
+            if constexpr (has_cell_codec<Cell>) {
+                for (uindex_t i = 0; i < n; i++) {
+                    segment[i] = Codec::encode(column[i]);
+                }
+            } else {
+                std::memcpy(segment, column, n * sizeof(Cell));
             }
-        }
+        });
     }
 
     /**
@@ -216,37 +354,55 @@ class Grid {
      * The contents of the SYCL buffer will be overwritten on the host. The buffer also has to have
      * the same size as the grid, otherwise a \ref std::range_error is thrown.
      *
+     * Like \ref copy_from_buffer, the cells are copied by multiple host threads.
+     *
      * \param output_buffer The buffer to copy the data to.
      * \throws std::range_error The size of the buffer does not match the grid.
      */
     void copy_to_buffer(sycl::buffer<Cell, 2> output_buffer) {
-        if (output_buffer.get_range() != grid_buffer.get_range()) {
+        if (output_buffer.get_range() != sycl::range<2>(grid_width, grid_height)) {
             throw std::out_of_range("The target buffer has not the same size as the grid");
         }
 
-        sycl::host_accessor grid_ac{grid_buffer, sycl::read_only};
-        sycl::host_accessor output_ac{output_buffer, sycl::write_only};
-        for (uindex_t c = 0; c < get_grid_width(); c++) {
-            for (uindex_t r = 0; r < get_grid_height(); r++) {
-                output_ac[c][r] = grid_ac[c][r];
+        sycl::host_accessor tile_ac(tile_buffer, sycl::read_only);
+        sycl::host_accessor output_ac{output_buffer, sycl::write_only, sycl::no_init};
+        Cell *cells = output_ac.get_pointer();
+        for_each_tile_column_segment([&](uindex_t c, uindex_t r, uindex_t word_i, uindex_t n) {
+            StoredCell const *segment = tile_ac[word_i].data();
+            Cell *column = cells + c * grid_height + r;
+            if constexpr (has_cell_codec<Cell>) {
+                for (uindex_t i = 0; i < n; i++) {
+                    column[i] = Codec::decode(segment[i]);
+                }
+            } else {
+                std::memcpy(column, segment, n * sizeof(Cell));
             }
-        }
+        });
     }
 
     /**
      * \brief Create an new, uninitialized grid with the same size as the current one.
      */
-    Grid make_similar() const { return Grid(grid_buffer.get_range()); }
+    Grid make_similar() const { return Grid(grid_width, grid_height); }
+
+    /**
+     * \brief Return the number of grid objects that reference the same data as this grid.
+     *
+     * Copies of a grid share the same underlying data. This method is used by the \ref
+     * stencil::GridPool to find grids that aren't referenced anywhere else and can therefore be
+     * reused.
+     */
+    long get_n_references() const { return references.use_count(); }
 
     /**
      * \brief Return the width, or number of columns, of the grid.
      */
-    uindex_t get_grid_width() const { return grid_buffer.get_range()[0]; }
+    uindex_t get_grid_width() const { return grid_width; }
 
     /**
      * \brief Return the height, or number of rows, of the grid.
      */
-    uindex_t get_grid_height() const { return grid_buffer.get_range()[1]; }
+    uindex_t get_grid_height() const { return grid_height; }
 
     /**
      * \brief Return the range of (central) tiles of the grid.
@@ -296,46 +452,64 @@ class Grid {
         if (tile_c >= get_tile_range().c || tile_r >= get_tile_range().r) {
             throw std::out_of_range("Tile index out of range!");
         }
+        return submit_tile_range_read<in_pipe, false>(queue, tile_c, tile_r, 1, 1, halo_value,
+                                                      std::nullopt);
+    }
 
-        constexpr uindex_t column_bits = 1 + std::bit_width(tile_width + halo_radius);
-        constexpr uindex_t row_bits = 1 + std::bit_width(tile_height + halo_radius);
-        using index_c_t = ac_int<column_bits, true>;
-        using index_r_t = ac_int<row_bits, true>;
+    /**
+     * \brief Submit an instrumented kernel that sends a tile of the grid into a pipe.
+     *
+     * This works like \ref submit_read(sycl::queue &, uindex_t, uindex_t, Cell), but the kernel
+     * records its \ref KernelCounters and adds them to the given buffer.
+     *
+     * \throws std::out_of_range The grid does not contain the requested tile.
+     */
+    template <typename in_pipe>
+    sycl::event submit_read(sycl::queue &queue, uindex_t tile_c, uindex_t tile_r, Cell halo_value,
+                            KernelCountersBuffer counters) {
+        if (tile_c >= get_tile_range().c || tile_r >= get_tile_range().r) {
+            throw std::out_of_range("Tile index out of range!");
+        }
+        return submit_tile_range_read<in_pipe, true>(queue, tile_c, tile_r, 1, 1, halo_value,
+                                                     counters);
+    }
 
-        return queue.submit([&](sycl::handler &cgh) {
-            sycl::accessor grid_ac{grid_buffer, cgh, sycl::read_only};
-            index_t grid_width = this->get_grid_width();
-            index_t grid_height = this->get_grid_height();
+    /**
+     * \brief Submit a kernel that sends all tiles of the grid into a pipe.
+     *
+     * The submitted kernel sends the tiles in column-major tile order, i.e. first all tiles of the
+     * first tile column from top to bottom, then all tiles of the second tile column, and so on.
+     * Every tile is sent together with its halo, exactly like \ref submit_read would. This way, a
+     * single kernel feeds an execution kernel that processes all tiles in one invocation.
+     *
+     * The input sections of two vertically adjacent tiles overlap by `2 * halo_radius` rows. The
+     * kernel keeps these rows of the previous tile in an on-chip buffer and sends them again from
+     * there instead of reading them from global memory a second time.
+     *
+     * \tparam in_pipe The pipe the data is sent into.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param halo_value The value to present for cells outside of the grid.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename in_pipe> sycl::event submit_read_tiles(sycl::queue &queue, Cell halo_value) {
+        return submit_tile_range_read<in_pipe, false>(queue, 0, 0, get_tile_range().c,
+                                                      get_tile_range().r, halo_value, std::nullopt);
+    }
 
-            cgh.single_task([=]() {
-                index_t c_offset = tile_c * tile_width;
-                index_c_t start_tile_c = -halo_radius;
-                index_c_t end_tile_c =
-                    index_c_t(std::min(grid_width - tile_c * tile_width, tile_width)) + halo_radius;
-
-                index_t r_offset = tile_r * tile_height;
-                index_r_t start_tile_r = -halo_radius;
-                index_r_t end_tile_r =
-                    index_r_t(std::min(grid_height - tile_r * tile_height, tile_height)) +
-                    halo_radius;
-
-                [[intel::loop_coalesce(2)]] for (index_c_t tile_c = start_tile_c;
-                                                 tile_c < end_tile_c; tile_c++) {
-                    for (index_r_t tile_r = start_tile_r; tile_r < end_tile_r; tile_r++) {
-                        index_t c = c_offset + tile_c.to_long();
-                        index_t r = r_offset + tile_r.to_long();
-
-                        Cell value;
-                        if (c >= 0 && r >= 0 && c < grid_width && r < grid_height) {
-                            value = grid_ac[c][r];
-                        } else {
-                            value = halo_value;
-                        }
-                        in_pipe::write(value);
-                    }
-                }
-            });
-        });
+    /**
+     * \brief Submit an instrumented kernel that sends all tiles of the grid into a pipe.
+     *
+     * This works like \ref submit_read_tiles(sycl::queue &, Cell), but the kernel records its
+     * \ref KernelCounters and adds them to the given buffer.
+     */
+    template <typename in_pipe>
+    sycl::event submit_read_tiles(sycl::queue &queue, Cell halo_value,
+                                  KernelCountersBuffer counters) {
+        return submit_tile_range_read<in_pipe, true>(queue, 0, 0, get_tile_range().c,
+                                                     get_tile_range().r, halo_value, counters);
     }
 
     /**
@@ -371,31 +545,325 @@ class Grid {
         if (tile_c >= get_tile_range().c || tile_r >= get_tile_range().r) {
             throw std::out_of_range("Tile index out of range!");
         }
+        return submit_tile_range_write<out_pipe, false>(queue, tile_c, tile_r, 1, 1, std::nullopt);
+    }
+
+    /**
+     * \brief Submit an instrumented kernel that receives a tile from the pipe and writes it to the
+     * grid.
+     *
+     * This works like \ref submit_write(sycl::queue, uindex_t, uindex_t), but the kernel records
+     * its \ref KernelCounters and adds them to the given buffer.
+     *
+     * \throws std::out_of_range The grid does not contain the requested tile.
+     */
+    template <typename out_pipe>
+    sycl::event submit_write(sycl::queue queue, uindex_t tile_c, uindex_t tile_r,
+                             KernelCountersBuffer counters) {
+        if (tile_c >= get_tile_range().c || tile_r >= get_tile_range().r) {
+            throw std::out_of_range("Tile index out of range!");
+        }
+        return submit_tile_range_write<out_pipe, true>(queue, tile_c, tile_r, 1, 1, counters);
+    }
+
+    /**
+     * \brief Submit a kernel that receives all tiles of the grid from a pipe.
+     *
+     * The kernel expects the tiles in column-major tile order, as sent by \ref submit_read_tiles,
+     * and the cells of every tile as expected by \ref submit_write.
+     *
+     * \tparam out_pipe The pipe the data is received from.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename out_pipe> sycl::event submit_write_tiles(sycl::queue queue) {
+        return submit_tile_range_write<out_pipe, false>(queue, 0, 0, get_tile_range().c,
+                                                        get_tile_range().r, std::nullopt);
+    }
+
+    /**
+     * \brief Submit an instrumented kernel that receives all tiles of the grid from a pipe.
+     *
+     * This works like \ref submit_write_tiles(sycl::queue), but the kernel records its \ref
+     * KernelCounters and adds them to the given buffer.
+     */
+    template <typename out_pipe>
+    sycl::event submit_write_tiles(sycl::queue queue, KernelCountersBuffer counters) {
+        return submit_tile_range_write<out_pipe, true>(queue, 0, 0, get_tile_range().c,
+                                                       get_tile_range().r, counters);
+    }
+
+    /**
+     * \brief Submit a kernel that receives a tile from a pipe and records whether it changed.
+     *
+     * This works like \ref submit_write, but every received cell is also compared with the cell at
+     * the same position of the reference grid. After the kernel has completed, the element
+     * `tile_c * get_tile_range().r + tile_r` of the flag buffer is true if at least one cell of the
+     * tile differs from the reference grid, and false otherwise.
+     *
+     * \tparam out_pipe The pipe the data is received from.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param tile_c The column index of the tile to write.
+     *
+     * \param tile_r The row index of the tile to write.
+     *
+     * \param reference The grid to compare the received cells with. It must have the same size as
+     * this grid and must not reference the same data.
+     *
+     * \param changed_flags A buffer with one flag for every tile of the grid.
+     *
+     * \throws std::out_of_range The grid does not contain the requested tile.
+     *
+     * \throws std::range_error The reference grid or the flag buffer has the wrong size.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename out_pipe>
+    sycl::event submit_tracked_write(sycl::queue queue, uindex_t tile_c, uindex_t tile_r,
+                                     Grid &reference, sycl::buffer<bool, 1> changed_flags)
+        requires(std::equality_comparable<Cell>)
+    {
+        GenericID<uindex_t> tile_range = get_tile_range();
+        if (tile_c >= tile_range.c || tile_r >= tile_range.r) {
+            throw std::out_of_range("Tile index out of range!");
+        }
+        if (reference.grid_width != grid_width || reference.grid_height != grid_height) {
+            throw std::range_error("The reference grid differs in size.");
+        }
+        if (changed_flags.get_range()[0] != tile_range.c * tile_range.r) {
+            throw std::range_error("The flag buffer doesn't have one flag per tile.");
+        }
+
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac{tile_buffer, cgh, sycl::write_only};
+            sycl::accessor reference_ac{reference.tile_buffer, cgh, sycl::read_only};
+            sycl::accessor changed_ac{changed_flags, cgh, sycl::write_only};
+            uindex_t section_width = std::min(grid_width - tile_c * tile_width, tile_width);
+            uindex_t section_height = std::min(grid_height - tile_r * tile_height, tile_height);
+            uindex_t tile_range_r = tile_range.r;
+
+            cgh.single_task([=]() {
+                bool changed = false;
+                for (uindex_t column = 0; column < section_width; column++) {
+                    IOWord cache, reference_cache;
+                    uindex_t word_i = word_index(tile_range_r, tile_c, tile_r, column);
+                    uindex_t cell_i = 0;
+                    for (uindex_t r = 0; r < section_height; r++) {
+                        if (cell_i == 0) {
+                            reference_cache = reference_ac[word_i];
+                        }
+                        cache[cell_i] = Codec::encode(out_pipe::read());
+                        changed |= !(Codec::decode(cache[cell_i]) ==
+                                     Codec::decode(reference_cache[cell_i]));
+                        cell_i++;
+                        if (cell_i == word_length || r == section_height - 1) {
+                            ac[word_i] = cache;
+                            cell_i = 0;
+                            word_i++;
+                        }
+                    }
+                }
+                changed_ac[tile_c * tile_range_r + tile_r] = changed;
+            });
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that copies a tile of another grid into this grid.
+     *
+     * Since the cells of a tile are stored next to each other, this is a plain copy of
+     * consecutive memory words.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param source The grid to copy the tile from. It must have the same size as this grid.
+     *
+     * \param tile_c The column index of the tile to copy.
+     *
+     * \param tile_r The row index of the tile to copy.
+     *
+     * \throws std::out_of_range The grid does not contain the requested tile.
+     *
+     * \throws std::range_error The source grid differs in size.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    sycl::event submit_copy_tile(sycl::queue queue, Grid &source, uindex_t tile_c,
+                                 uindex_t tile_r) {
+        if (tile_c >= get_tile_range().c || tile_r >= get_tile_range().r) {
+            throw std::out_of_range("Tile index out of range!");
+        }
+        if (source.grid_width != grid_width || source.grid_height != grid_height) {
+            throw std::range_error("The source grid differs in size.");
+        }
+
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac{tile_buffer, cgh, sycl::write_only};
+            sycl::accessor source_ac{source.tile_buffer, cgh, sycl::read_only};
+            uindex_t first_word = word_index(get_tile_range().r, tile_c, tile_r, 0);
+
+            cgh.single_task([=]() {
+                for (uindex_t i = first_word; i < first_word + words_per_tile; i++) {
+                    ac[i] = source_ac[i];
+                }
+            });
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that copies a range of columns of the grid into a buffer.
+     *
+     * The column `c` of the buffer receives the column `column_begin + c` of the grid. Since every
+     * column of a tile is stored in words of its own, this only reads the words of these columns.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param output_buffer The buffer to copy the columns to. Its height must match the grid.
+     *
+     * \param column_begin The index of the first grid column to copy.
+     *
+     * \throws std::range_error The columns exceed the grid or the heights differ.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    sycl::event submit_copy_columns_to_buffer(sycl::queue queue,
+                                              sycl::buffer<Cell, 2> output_buffer,
+                                              uindex_t column_begin) {
+        return submit_projected_copy(queue, output_buffer, column_begin,
+                                     [](Cell const &cell) { return cell; });
+    }
+
+    /**
+     * \brief Submit a kernel that extracts one value of every cell into a compact buffer.
+     *
+     * Host code that only needs one field of the cells, for example for a snapshot, would
+     * otherwise map the whole grid and transfer all fields and the padding of every tile from the
+     * device. Instead, this kernel applies the projection to every cell on the device and only
+     * writes the results to the returned buffer, so that only these values are transferred when
+     * the buffer is accessed on the host.
+     *
+     * \tparam Projection A callable object that is invoked as `projection(cell)` on the device.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param projection The projection to apply to every cell.
+     *
+     * \returns A buffer with the projected values, with the same range as the grid.
+     */
+    template <typename Projection>
+        requires std::invocable<Projection const &, Cell const &>
+    auto project(sycl::queue queue, Projection projection) {
+        using Value = std::remove_cvref_t<std::invoke_result_t<Projection const &, Cell const &>>;
+        sycl::buffer<Value, 2> output_buffer(sycl::range<2>(grid_width, grid_height));
+        submit_projected_copy(queue, output_buffer, 0, projection);
+        return output_buffer;
+    }
+
+    /**
+     * \brief Submit a kernel that extracts one field of every cell into a compact buffer.
+     *
+     * This is a shorthand for \ref project(sycl::queue, Projection) with a projection that reads
+     * the given member, for example `grid.project<&Cell::hz>(queue)`.
+     *
+     * \tparam field A pointer to the member of the cell type to extract.
+     */
+    template <auto field> auto project(sycl::queue queue) {
+        return project(queue, [](Cell const &cell) { return std::invoke(field, cell); });
+    }
+
+    /**
+     * \brief Submit a kernel that overwrites every cell of the grid with the results of a
+     * generator.
+     *
+     * This is the device-side counterpart to writing the grid with a \ref GridAccessor: The cells
+     * are generated where they are stored, encoded and written into their tiles one whole word at
+     * a time. Neither a host loop over all cells nor a transfer of the whole grid is necessary.
+     *
+     * \tparam Generator A callable object that is invoked as `generator(c, r)` on the device with
+     * the column and row index of a cell. It returns the new value of the cell.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param generator The generator to call for every cell.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    template <typename Generator>
+        requires std::convertible_to<std::invoke_result_t<Generator const &, uindex_t, uindex_t>,
+                                     Cell>
+    sycl::event generate(sycl::queue queue, Generator generator) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac{tile_buffer, cgh, sycl::write_only, sycl::no_init};
+            uindex_t grid_width = this->grid_width;
+            uindex_t grid_height = this->grid_height;
+            uindex_t tile_range_r = get_tile_range().r;
+
+            cgh.single_task([=]() {
+                for (uindex_t c = 0; c < grid_width; c++) {
+                    IOWord cache;
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        uindex_t tile_row = r % tile_height;
+                        cache[tile_row % word_length] = Codec::encode(generator(c, r));
+                        if (tile_row % word_length == word_length - 1 ||
+                            tile_row == tile_height - 1 || r == grid_height - 1) {
+                            ac[word_index(tile_range_r, c / tile_width, r / tile_height,
+                                          c % tile_width) +
+                               tile_row / word_length] = cache;
+                        }
+                    }
+                }
+            });
+        });
+    }
 
-        constexpr uindex_t column_bits = std::bit_width(tile_width);
-        constexpr uindex_t row_bits = std::bit_width(tile_height);
-        using uindex_c_t = ac_int<column_bits, false>;
-        using uindex_r_t = ac_int<row_bits, false>;
+    /**
+     * \brief Submit a kernel that copies the columns of a buffer into a range of columns of the
+     * grid.
+     *
+     * This is the reverse of \ref submit_copy_columns_to_buffer: The column `c` of the buffer
+     * overwrites the column `column_begin + c` of the grid. The other columns are not touched.
+     *
+     * \param queue The queue to submit the kernel to.
+     *
+     * \param input_buffer The buffer to copy the columns from. Its height must match the grid.
+     *
+     * \param column_begin The index of the first grid column to overwrite.
+     *
+     * \throws std::range_error The columns exceed the grid or the heights differ.
+     *
+     * \returns The event object of the submitted kernel.
+     */
+    sycl::event submit_copy_columns_from_buffer(sycl::queue queue,
+                                                sycl::buffer<Cell, 2> input_buffer,
+                                                uindex_t column_begin) {
+        uindex_t n_columns = input_buffer.get_range()[0];
+        if (column_begin + n_columns > grid_width || input_buffer.get_range()[1] != grid_height) {
+            throw std::range_error("The column range exceeds the grid.");
+        }
 
         return queue.submit([&](sycl::handler &cgh) {
-            sycl::accessor grid_ac{grid_buffer, cgh, sycl::read_write};
-            uindex_t grid_width = this->get_grid_width();
-            uindex_t grid_height = this->get_grid_height();
+            sycl::accessor ac{tile_buffer, cgh, sycl::write_only};
+            sycl::accessor in_ac{input_buffer, cgh, sycl::read_only};
+            uindex_t grid_height = this->grid_height;
+            uindex_t tile_range_r = get_tile_range().r;
 
             cgh.single_task([=]() {
-                uindex_t c_offset = tile_c * tile_width;
-                uindex_c_t end_tile_c =
-                    uindex_c_t(std::min(grid_width - tile_c * tile_width, tile_width));
-
-                uindex_t r_offset = tile_r * tile_height;
-                uindex_r_t end_tile_r =
-                    uindex_r_t(std::min(grid_height - tile_r * tile_height, tile_height));
-
-                [[intel::loop_coalesce(2)]] for (uindex_c_t tile_c = 0; tile_c < end_tile_c;
-                                                 tile_c++) {
-                    for (uindex_r_t tile_r = 0; tile_r < end_tile_r; tile_r++) {
-                        grid_ac[c_offset + tile_c.to_long()][r_offset + tile_r.to_long()] =
-                            out_pipe::read();
+                for (uindex_t c = 0; c < n_columns; c++) {
+                    uindex_t grid_c = column_begin + c;
+                    IOWord cache;
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        uindex_t tile_row = r % tile_height;
+                        cache[tile_row % word_length] = Codec::encode(in_ac[c][r]);
+                        if (tile_row % word_length == word_length - 1 ||
+                            tile_row == tile_height - 1 || r == grid_height - 1) {
+                            ac[word_index(tile_range_r, grid_c / tile_width, r / tile_height,
+                                          grid_c % tile_width) +
+                               tile_row / word_length] = cache;
+                        }
                     }
                 }
             });
@@ -403,7 +871,268 @@ class Grid {
     }
 
   private:
-    sycl::buffer<Cell, 2> grid_buffer;
+    /**
+     * \brief Submit a kernel that copies the projections of a range of columns into a buffer.
+     *
+     * The column `c` of the buffer receives the projected cells of the column `column_begin + c`.
+     * Since every column of a tile is stored in words of its own, this only reads the words of
+     * these columns.
+     *
+     * \throws std::range_error The columns exceed the grid or the heights differ.
+     */
+    template <typename Value, typename Projection>
+    sycl::event submit_projected_copy(sycl::queue queue, sycl::buffer<Value, 2> output_buffer,
+                                      uindex_t column_begin, Projection projection) {
+        uindex_t n_columns = output_buffer.get_range()[0];
+        if (column_begin + n_columns > grid_width || output_buffer.get_range()[1] != grid_height) {
+            throw std::range_error("The column range exceeds the grid.");
+        }
+
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac{tile_buffer, cgh, sycl::read_only};
+            sycl::accessor out_ac{output_buffer, cgh, sycl::write_only};
+            uindex_t grid_height = this->grid_height;
+            uindex_t tile_range_r = get_tile_range().r;
+
+            cgh.single_task([=]() {
+                for (uindex_t c = 0; c < n_columns; c++) {
+                    uindex_t grid_c = column_begin + c;
+                    IOWord cache;
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        uindex_t tile_row = r % tile_height;
+                        if (tile_row % word_length == 0) {
+                            cache = ac[word_index(tile_range_r, grid_c / tile_width,
+                                                  r / tile_height, grid_c % tile_width) +
+                                       tile_row / word_length];
+                        }
+                        out_ac[c][r] = projection(Codec::decode(cache[tile_row % word_length]));
+                    }
+                }
+            });
+        });
+    }
+
+    /**
+     * \brief Return the index of the first word of a tile column in the tile buffer.
+     */
+    static uindex_t word_index(uindex_t tile_range_r, uindex_t tile_c, uindex_t tile_r,
+                               uindex_t column) {
+        return ((tile_c * tile_range_r + tile_r) * tile_width + column) * words_per_tile_column;
+    }
+
+    /**
+     * \brief Call `f(c, r, word_i, n_cells)` for every segment of a grid column that lies within
+     * one tile, using multiple host threads.
+     *
+     * `c` and `r` are the grid column and the first grid row of the segment, `word_i` is the index
+     * of the segment's first word in the tile buffer and `n_cells` is the number of cells in the
+     * segment. The columns are distributed among the threads, so different calls never touch the
+     * same words.
+     */
+    template <typename F> void for_each_tile_column_segment(F f) const {
+        uindex_t tile_range_r = get_tile_range().r;
+        host_parallel_for(
+            grid_width, 1,
+            [&](uindex_t c_begin, uindex_t c_end) {
+                for (uindex_t c = c_begin; c < c_end; c++) {
+                    for (uindex_t tile_r = 0; tile_r < tile_range_r; tile_r++) {
+                        uindex_t r = tile_r * tile_height;
+                        uindex_t word_i =
+                            word_index(tile_range_r, c / tile_width, tile_r, c % tile_width);
+                        f(c, r, word_i, std::min<uindex_t>(tile_height, grid_height - r));
+                    }
+                }
+            },
+            std::max<uindex_t>((1 << 16) / std::max<uindex_t>(grid_height, 1), 1));
+    }
+
+    /**
+     * \brief Submit a kernel that sends a rectangle of tiles, in column-major tile order, into a
+     * pipe.
+     *
+     * Every column of a tile and its halo is sent as four segments: The lower halo rows of the tile
+     * above, the column of the tile itself, the upper rows of the tile below, and the rows below
+     * the grid. The words of a segment are read in order, and segments outside of the grid are
+     * replaced by the halo value as a whole.
+     *
+     * The last `2 * halo_radius` cells of every column are also stored in an overlap buffer. For
+     * all but the first tile of a tile column, these are the first cells of the column, so they
+     * are sent from the buffer and skipped in the segments.
+     *
+     * If the kernel is instrumented, it adds its \ref KernelCounters to the given buffer.
+     */
+    template <typename in_pipe, bool instrumented>
+    sycl::event submit_tile_range_read(sycl::queue &queue, uindex_t first_tile_c,
+                                       uindex_t first_tile_r, uindex_t n_tile_columns,
+                                       uindex_t n_tile_rows, Cell halo_value,
+                                       std::optional<KernelCountersBuffer> counters) {
+        constexpr uindex_t overlap_height = 2 * halo_radius;
+
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac{tile_buffer, cgh, sycl::read_only};
+            auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+            uindex_t grid_width = this->grid_width;
+            uindex_t grid_height = this->grid_height;
+            uindex_t tile_range_r = get_tile_range().r;
+
+            cgh.single_task([=]() {
+                KernelCounterRecorder<instrumented> recorder;
+                uint64_t n_sent_cells = 0;
+                [[intel::fpga_memory]] Cell overlap[tile_width + 2 * halo_radius][overlap_height];
+
+                for (uindex_t tile_c = first_tile_c; tile_c < first_tile_c + n_tile_columns;
+                     tile_c++) {
+                    for (uindex_t tile_r = first_tile_r; tile_r < first_tile_r + n_tile_rows;
+                         tile_r++) {
+                        bool reuse_overlap = tile_r != first_tile_r;
+                        index_t c_offset = tile_c * tile_width;
+                        index_t section_width = std::min(grid_width - c_offset, tile_width);
+                        uindex_t r_offset = tile_r * tile_height;
+                        uindex_t section_height = std::min(grid_height - r_offset, tile_height);
+                        uindex_t next_r_offset = std::min(r_offset + tile_height, grid_height);
+                        uindex_t n_lower_rows = std::min(grid_height - next_r_offset, halo_radius);
+                        uindex_t column_height = section_height + overlap_height;
+
+                        for (index_t cell_c = -index_t(halo_radius);
+                             cell_c < section_width + index_t(halo_radius); cell_c++) {
+                            index_t c = c_offset + cell_c;
+                            bool column_valid = c >= 0 && c < index_t(grid_width);
+                            uindex_t source_tile_c = column_valid ? c / tile_width : 0;
+                            uindex_t column = column_valid ? c % tile_width : 0;
+                            uindex_t overlap_c = cell_c + halo_radius;
+
+                            // Send the cached rows and store the last rows of the column.
+                            uindex_t i_row = 0;
+                            auto send = [&](Cell cell) {
+                                recorder.template write<in_pipe>(cell);
+                                n_sent_cells++;
+                                if (i_row >= column_height - overlap_height) {
+                                    overlap[overlap_c][i_row - (column_height - overlap_height)] =
+                                        cell;
+                                }
+                                i_row++;
+                            };
+
+                            uindex_t n_skipped_rows = 0;
+                            if (reuse_overlap) {
+                                for (uindex_t r = 0; r < overlap_height; r++) {
+                                    send(overlap[overlap_c][r]);
+                                }
+                                n_skipped_rows = overlap_height;
+                            }
+
+                            for (uindex_t i_segment = 0; i_segment < 4; i_segment++) {
+                                uindex_t source_tile_r = tile_r;
+                                uindex_t segment_begin = 0;
+                                uindex_t segment_height;
+                                bool segment_valid = column_valid;
+                                if (i_segment == 0) {
+                                    source_tile_r = tile_r - 1;
+                                    segment_begin = tile_height - halo_radius;
+                                    segment_height = halo_radius;
+                                    segment_valid &= tile_r > 0;
+                                } else if (i_segment == 1) {
+                                    segment_height = section_height;
+                                } else if (i_segment == 2) {
+                                    source_tile_r = tile_r + 1;
+                                    segment_height = n_lower_rows;
+                                } else {
+                                    segment_height = halo_radius - n_lower_rows;
+                                    segment_valid = false;
+                                }
+
+                                uindex_t n_skipped = std::min(n_skipped_rows, segment_height);
+                                segment_begin += n_skipped;
+                                segment_height -= n_skipped;
+                                n_skipped_rows -= n_skipped;
+
+                                uindex_t word_i =
+                                    word_index(tile_range_r, source_tile_c, source_tile_r,
+                                               column) +
+                                    segment_begin / word_length;
+                                uindex_t cell_i = segment_begin % word_length;
+                                IOWord cache;
+                                if (segment_valid && segment_height != 0) {
+                                    cache = ac[word_i];
+                                }
+                                for (uindex_t i = 0; i < segment_height; i++) {
+                                    if (cell_i == word_length) {
+                                        word_i++;
+                                        if (segment_valid) {
+                                            cache = ac[word_i];
+                                        }
+                                        cell_i = 0;
+                                    }
+                                    send(segment_valid ? Codec::decode(cache[cell_i]) : halo_value);
+                                    cell_i++;
+                                }
+                            }
+                        }
+                    }
+                }
+                recorder.store(counters_ac, n_sent_cells, n_sent_cells);
+            });
+        });
+    }
+
+    /**
+     * \brief Submit a kernel that receives a rectangle of tiles, in column-major tile order, from
+     * a pipe.
+     *
+     * The cells of every tile column are collected in a word and written once the word is full or
+     * the column is complete. If the kernel is instrumented, it adds its \ref KernelCounters to
+     * the given buffer.
+     */
+    template <typename out_pipe, bool instrumented>
+    sycl::event submit_tile_range_write(sycl::queue queue, uindex_t first_tile_c,
+                                        uindex_t first_tile_r, uindex_t n_tile_columns,
+                                        uindex_t n_tile_rows,
+                                        std::optional<KernelCountersBuffer> counters) {
+        return queue.submit([&](sycl::handler &cgh) {
+            sycl::accessor ac{tile_buffer, cgh, sycl::write_only};
+            auto counters_ac = make_kernel_counters_argument<instrumented>(counters, cgh);
+            uindex_t grid_width = this->grid_width;
+            uindex_t grid_height = this->grid_height;
+            uindex_t tile_range_r = get_tile_range().r;
+
+            cgh.single_task([=]() {
+                KernelCounterRecorder<instrumented> recorder;
+                uint64_t n_received_cells = 0;
+                for (uindex_t tile_c = first_tile_c; tile_c < first_tile_c + n_tile_columns;
+                     tile_c++) {
+                    for (uindex_t tile_r = first_tile_r; tile_r < first_tile_r + n_tile_rows;
+                         tile_r++) {
+                        uindex_t section_width =
+                            std::min(grid_width - tile_c * tile_width, tile_width);
+                        uindex_t section_height =
+                            std::min(grid_height - tile_r * tile_height, tile_height);
+
+                        for (uindex_t column = 0; column < section_width; column++) {
+                            IOWord cache;
+                            uindex_t word_i = word_index(tile_range_r, tile_c, tile_r, column);
+                            uindex_t cell_i = 0;
+                            for (uindex_t r = 0; r < section_height; r++) {
+                                cache[cell_i] = Codec::encode(recorder.template read<out_pipe>());
+                                n_received_cells++;
+                                cell_i++;
+                                if (cell_i == word_length || r == section_height - 1) {
+                                    ac[word_i] = cache;
+                                    cell_i = 0;
+                                    word_i++;
+                                }
+                            }
+                        }
+                    }
+                }
+                recorder.store(counters_ac, n_received_cells, n_received_cells);
+            });
+        });
+    }
+
+    sycl::buffer<IOWord, 1> tile_buffer;
+    uindex_t grid_width, grid_height;
+    // Only used to count the references to the grid data, see get_n_references().
+    std::shared_ptr<char> references = std::make_shared<char>();
 };
 
 } // namespace tiling
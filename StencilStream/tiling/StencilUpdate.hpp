@@ -18,15 +18,29 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #pragma once
+#include "../BoundaryCondition.hpp"
 #include "../Concepts.hpp"
 #include "../GenericID.hpp"
+#include "../GridPool.hpp"
 #include "../Helpers.hpp"
+#include "../HistoryTransitionFunction.hpp"
 #include "../Index.hpp"
+#include "../KernelCounters.hpp"
+#include "../Reduction.hpp"
+#include "../StaticValues.hpp"
+#include "../Timeline.hpp"
 #include "../tdv/SinglePassStrategies.hpp"
 #include "Grid.hpp"
 
+#include <array>
 #include <chrono>
+#include <concepts>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace stencil {
 namespace tiling {
@@ -35,7 +49,9 @@ namespace tiling {
  * \brief A kernel that executes a stencil transition function on a tile.
  *
  * It receives the contents of a tile and it's halo from the `in_pipe`, applies the transition
- * function when applicable and writes the result to the `out_pipe`.
+ * function when applicable and writes the result to the `out_pipe`. It may also process a schedule
+ * of multiple tiles back-to-back, in which case the tiles (with their halos) have to be sent in
+ * column-major tile order, just like \ref Grid::submit_read_tiles does.
  *
  * \tparam TransFunc The type of transition function to use.
  *
@@ -52,21 +68,67 @@ namespace tiling {
  * \tparam in_pipe The pipe to read from.
  *
  * \tparam out_pipe The pipe to write to.
+ *
+ * \tparam dense_storage If true, the cells in the cache are densely packed instead of being padded
+ * to the next power of two. See \ref CellStorage.
+ *
+ * \tparam instrumented If true, the kernel records its \ref KernelCounters and adds them to the
+ * buffer that is set with \ref set_counters. The active cycles are the loop iterations and the
+ * moved cells are the output cells.
+ *
+ * \tparam boundary_condition The values of the cells outside of the grid. Only the constant, clamp
+ * and reflect boundary conditions are supported. For the latter two, the kernel replaces the cells
+ * of the loaded stencils that lie outside of the global grid with the clamped or reflected cells
+ * of the same stencil buffer. The constant boundary condition needs no replacement logic. Periodic
+ * boundaries would need the input halo to be wrapped to the opposite border, which the read
+ * kernels of the \ref Grid don't do, see \ref StencilUpdate.
+ *
+ * If the transition function is a \ref HistoryTransitionFunction, the pipes transfer its bundles,
+ * but only the wrapped cells are kept in the stencil buffers and the cache. Every processing
+ * element delays the past levels of its input cell until the cell has reached the center of its
+ * stencil buffer.
  */
 template <concepts::TransitionFunction TransFunc,
           tdv::single_pass::KernelArgument<TransFunc> TDVKernelArgument,
           uindex_t n_processing_elements, uindex_t output_tile_width, uindex_t output_tile_height,
-          typename in_pipe, typename out_pipe>
-    requires(n_processing_elements % TransFunc::n_subiterations == 0)
+          typename in_pipe, typename out_pipe, bool dense_storage = false,
+          bool instrumented = false,
+          BoundaryCondition boundary_condition = BoundaryCondition::Constant>
+    requires(n_processing_elements % TransFunc::n_subiterations == 0) &&
+            (boundary_condition != BoundaryCondition::Periodic)
 class StencilUpdateKernel {
   private:
     using Cell = typename TransFunc::Cell;
     using TDV = typename TransFunc::TimeDependentValue;
-    using StencilImpl = Stencil<Cell, TransFunc::stencil_radius, TDV>;
+    using ConstantTable = ConstantTableOf<TransFunc>;
+    using History = KernelHistory<TransFunc>;
+    using BufferCell = typename History::Cell;
+    using Levels = typename History::Levels;
+    using StencilImpl = Stencil<BufferCell, TransFunc::stencil_radius, TDV, std::monostate,
+                                ConstantTable, typename History::History>;
     using TDVLocalState = typename TDVKernelArgument::LocalState;
 
     static constexpr uindex_t stencil_diameter = StencilImpl::diameter;
 
+    /**
+     * \brief The cells of the stencil that are actually read by the transition function.
+     */
+    static constexpr StencilShape stencil_shape = stencil_shape_of<TransFunc>;
+
+    /**
+     * \brief The first stencil buffer column that contains cells in the stencil shape, or that a
+     * cell in the shape is reflected from.
+     *
+     * The columns west of it are never read, so they are neither loaded from nor stored to the
+     * cache. A reflected eastern cell of the shape lies up to `stencil_shape.east - 1` columns west
+     * of the central cell.
+     */
+    static constexpr uindex_t first_live_column =
+        TransFunc::stencil_radius -
+        ((boundary_condition == BoundaryCondition::Reflect)
+             ? std::max(stencil_shape.west, stencil_shape.east)
+             : stencil_shape.west);
+
     static constexpr uindex_t halo_radius = TransFunc::stencil_radius * n_processing_elements;
 
     static constexpr uindex_t max_input_tile_width = 2 * halo_radius + output_tile_width;
@@ -75,6 +137,15 @@ class StencilUpdateKernel {
 
     static constexpr uindex_t n_input_cells = max_input_tile_width * input_tile_height;
 
+    /**
+     * \brief The number of entries in the history delay line of every processing element.
+     *
+     * A cell reaches the center of the stencil buffer `stencil_radius` columns and rows after it
+     * has entered it. Without a history, there are no delay lines.
+     */
+    static constexpr uindex_t max_history_delay =
+        History::enabled ? TransFunc::stencil_radius * (input_tile_height + 1) : 1;
+
     using index_stencil_t = typename StencilImpl::index_stencil_t;
     using uindex_stencil_t = typename StencilImpl::uindex_stencil_t;
     using StencilID = typename StencilImpl::StencilID;
@@ -97,6 +168,18 @@ class StencilUpdateKernel {
     using uindex_pes_t = ac_int<bits_pes, false>;
 
   public:
+    /**
+     * \brief Return the number of loop iterations that are needed to process a tile section with
+     * the given width and height.
+     *
+     * The kernel receives the section together with its halo and every loop iteration processes
+     * one cell.
+     */
+    static constexpr uindex_t calc_n_iterations(uindex_t tile_section_width,
+                                                uindex_t tile_section_height) {
+        return (tile_section_width + 2 * halo_radius) * (tile_section_height + 2 * halo_radius);
+    }
+
     /**
      * \brief Create and configure the execution kernel.
      *
@@ -129,17 +212,88 @@ class StencilUpdateKernel {
                         TDVKernelArgument tdv_kernel_argument)
         : trans_func(trans_func), i_iteration(i_iteration), target_i_iteration(target_i_iteration),
           grid_c_offset(grid_c_offset), grid_r_offset(grid_r_offset), grid_width(grid_width),
-          grid_height(grid_height), halo_value(halo_value),
-          tdv_kernel_argument(tdv_kernel_argument) {
+          grid_height(grid_height), n_tile_columns(1), n_tile_rows(1), stencil_c_offset(0),
+          stencil_grid_width(grid_width), halo_value(halo_value),
+          tdv_kernel_argument(tdv_kernel_argument), constant_table() {
         assert(grid_c_offset % output_tile_width == 0);
         assert(grid_r_offset % output_tile_height == 0);
     }
 
+    /**
+     * \brief Create an execution kernel that processes a schedule of tiles in one invocation.
+     *
+     * The kernel processes the tiles with the indices `(0, 0)` to `tile_range - (1, 1)` in
+     * column-major order, one directly after the other. The offsets and sizes of the tiles are
+     * computed on the fly, so the pipeline doesn't have to be drained between the tiles. Passing
+     * the tile range of the grid processes the whole grid.
+     *
+     * \param trans_func The instance of the transition function to use.
+     *
+     * \param i_iteration The iteration index of the input cells.
+     *
+     * \param target_i_iteration The number of iterations to compute. If this number is bigger
+     * than `n_processing_elements`, only `n_processing_elements` iterations will be computed.
+     *
+     * \param tile_range The number of tile columns and rows to process.
+     *
+     * \param grid_width The number of cell columns in the grid.
+     *
+     * \param grid_height The number of cell rows in the grid.
+     *
+     * \param halo_value The value of cells in the grid halo.
+     *
+     * \param tdv_kernel_argument The argument for the TDV system that is passed from the host to
+     * the device. This may for example contain global memory accessors.
+     */
+    StencilUpdateKernel(TransFunc trans_func, uindex_t i_iteration, uindex_t target_i_iteration,
+                        UID tile_range, uindex_t grid_width, uindex_t grid_height,
+                        Cell halo_value, TDVKernelArgument tdv_kernel_argument)
+        : trans_func(trans_func), i_iteration(i_iteration), target_i_iteration(target_i_iteration),
+          grid_c_offset(0), grid_r_offset(0), grid_width(grid_width), grid_height(grid_height),
+          n_tile_columns(tile_range.c), n_tile_rows(tile_range.r), stencil_c_offset(0),
+          stencil_grid_width(grid_width), halo_value(halo_value),
+          tdv_kernel_argument(tdv_kernel_argument), constant_table() {}
+
+    /**
+     * \brief Present shifted column indices to the transition function.
+     *
+     * The tile offsets, the grid size and the detection of halo cells still refer to the grid the
+     * kernel processes, but the transition function sees the column `c + column_offset` of a grid
+     * that is `global_grid_width` columns wide. This is used by \ref DistributedStencilUpdate,
+     * where the processed grid is a strip of a bigger grid.
+     */
+    void set_global_columns(index_t column_offset, uindex_t global_grid_width) {
+        stencil_c_offset = column_offset;
+        stencil_grid_width = global_grid_width;
+    }
+
+    /**
+     * \brief Set the contents of the constant table of the transition function.
+     *
+     * The kernel copies the table into its on-chip memory once and all processing elements read
+     * from this single copy.
+     */
+    void set_constant_table(ConstantTable const &constant_table) {
+        this->constant_table = constant_table;
+    }
+
+    /**
+     * \brief Set the accessor to the buffer that the kernel adds its counters to.
+     */
+    void set_counters(KernelCountersArgument<instrumented> counters)
+        requires(instrumented)
+    {
+        this->counters = counters;
+    }
+
     /**
      * \brief Execute the configured operations.
      */
     void operator()() const {
         TDVLocalState tdv_local_state(tdv_kernel_argument);
+        [[intel::fpga_memory]] ConstantTable local_constant_table = constant_table;
+        KernelCounterRecorder<instrumented> recorder;
+        uint64_t n_output_cells = 0;
 
         uindex_1d_t input_tile_c = 0;
         uindex_1d_t input_tile_r = 0;
@@ -152,21 +306,42 @@ class StencilUpdateKernel {
          * optimizes them away.
          */
         [[intel::fpga_memory,
-          intel::numbanks(2 * std::bit_ceil(n_processing_elements))]] Padded<Cell>
+          intel::numbanks(2 * std::bit_ceil(n_processing_elements))]]
+        CellStorage<BufferCell, dense_storage>
             cache[2][input_tile_height][std::bit_ceil(n_processing_elements)][stencil_diameter - 1];
-        [[intel::fpga_register]] Cell stencil_buffer[n_processing_elements][stencil_diameter]
-                                                    [stencil_diameter];
-
-        uindex_1d_t output_tile_section_width =
-            std::min(output_tile_width, grid_width - grid_c_offset);
-        uindex_1d_t output_tile_section_height =
-            std::min(output_tile_height, grid_height - grid_r_offset);
-        uindex_1d_t input_tile_section_width = output_tile_section_width + 2 * halo_radius;
-        uindex_1d_t input_tile_section_height = output_tile_section_height + 2 * halo_radius;
-        uindex_2d_t n_iterations = input_tile_section_width * input_tile_section_height;
-
-        for (uindex_2d_t i = 0; i < n_iterations; i++) {
-            [[intel::fpga_register]] Cell carry = in_pipe::read();
+        [[intel::fpga_register]] BufferCell stencil_buffer[n_processing_elements][stencil_diameter]
+                                                          [stencil_diameter];
+        BufferCell buffer_halo_value = History::get_cell(halo_value);
+
+        // The offsets and section sizes of the currently processed tile.
+        uindex_t tile_c_offset = this->grid_c_offset;
+        uindex_t tile_r_offset = this->grid_r_offset;
+        uindex_t i_tile_r = 0;
+        uindex_1d_t input_tile_section_width =
+            std::min(output_tile_width, grid_width - tile_c_offset) + 2 * halo_radius;
+        uindex_1d_t input_tile_section_height =
+            std::min(output_tile_height, grid_height - tile_r_offset) + 2 * halo_radius;
+
+        // The number of cells in all tile sections, including the halos. Every tile column sends
+        // its output width plus the halo for every tile row, and vice versa.
+        uindex_t last_c = std::min(tile_c_offset + n_tile_columns * output_tile_width, grid_width);
+        uindex_t last_r = std::min(tile_r_offset + n_tile_rows * output_tile_height, grid_height);
+        uindex_t n_iterations = (last_c - tile_c_offset + n_tile_columns * 2 * halo_radius) *
+                                (last_r - tile_r_offset + n_tile_rows * 2 * halo_radius);
+
+        // The past levels of the cells between entering the stencil buffer and reaching its
+        // center. All processing elements share the position in their delay lines, which restarts
+        // with every tile. The first delayed levels of a tile belong to the previous one, but so do
+        // the centers of the stencil buffers, whose results are discarded.
+        [[intel::fpga_memory, intel::numbanks(std::bit_ceil(n_processing_elements))]]
+        Levels history_delay_line[max_history_delay][std::bit_ceil(n_processing_elements)];
+        uindex_t history_delay = TransFunc::stencil_radius * (input_tile_section_height + 1);
+        uindex_t i_history_delay = 0;
+
+        for (uindex_t i = 0; i < n_iterations; i++) {
+            Cell input = recorder.template read<in_pipe>();
+            [[intel::fpga_register]] BufferCell carry = History::get_cell(input);
+            [[intel::fpga_register]] Levels levels_carry = History::get_levels(input);
 
 #pragma unroll
             for (uindex_pes_t i_processing_element = 0;
@@ -191,34 +366,36 @@ class StencilUpdateKernel {
                     index_1d_t((stencil_diameter - 1) +
                                (n_processing_elements + i_processing_element - 2) *
                                    TransFunc::stencil_radius);
-                index_t input_grid_c = grid_c_offset + rel_input_grid_c.to_int64();
+                index_t input_grid_c = tile_c_offset + rel_input_grid_c.to_int64();
                 index_1d_t rel_input_grid_r =
                     index_1d_t(input_tile_r) -
                     index_1d_t((stencil_diameter - 1) +
                                (n_processing_elements + i_processing_element - 2) *
                                    TransFunc::stencil_radius);
-                index_t input_grid_r = grid_r_offset + rel_input_grid_r.to_int64();
+                index_t input_grid_r = tile_r_offset + rel_input_grid_r.to_int64();
 
                 // Update the stencil buffer and cache with previous cache contents and the new
                 // input cell.
 #pragma unroll
                 for (uindex_stencil_t cache_c = 0; cache_c < uindex_stencil_t(stencil_diameter);
                      cache_c++) {
-                    Cell new_value;
+                    BufferCell new_value;
                     if (cache_c == uindex_stencil_t(stencil_diameter - 1)) {
-                        bool is_halo = (grid_c_offset == 0 && rel_input_grid_c < 0);
-                        is_halo |= (grid_r_offset == 0 && rel_input_grid_r < 0);
+                        bool is_halo = (tile_c_offset == 0 && rel_input_grid_c < 0);
+                        is_halo |= (tile_r_offset == 0 && rel_input_grid_r < 0);
                         is_halo |= input_grid_c >= grid_width || input_grid_r >= grid_height;
 
-                        new_value = is_halo ? halo_value : carry;
-                    } else {
+                        new_value = is_halo ? buffer_halo_value : carry;
+                    } else if (cache_c >= uindex_stencil_t(first_live_column)) {
                         new_value =
                             cache[input_tile_c[0]][input_tile_r][i_processing_element][cache_c]
                                 .value;
+                    } else {
+                        new_value = buffer_halo_value;
                     }
 
                     stencil_buffer[i_processing_element][cache_c][stencil_diameter - 1] = new_value;
-                    if (cache_c > 0) {
+                    if (cache_c > uindex_stencil_t(first_live_column)) {
                         cache[(~input_tile_c)[0]][input_tile_r][i_processing_element][cache_c - 1]
                             .value = new_value;
                     }
@@ -232,12 +409,58 @@ class StencilUpdateKernel {
                 index_t output_grid_r = input_grid_r - index_t(TransFunc::stencil_radius);
                 TDV tdv = tdv_local_state.get_time_dependent_value(i_processing_element /
                                                                    TransFunc::n_subiterations);
-                StencilImpl stencil(ID(output_grid_c, output_grid_r), UID(grid_width, grid_height),
-                                    pe_iteration, pe_subiteration, tdv,
-                                    stencil_buffer[i_processing_element]);
+
+                // Exchange the levels of the input cell with the levels of the central cell.
+                if constexpr (History::enabled) {
+                    Levels input_levels = levels_carry;
+                    levels_carry = history_delay_line[i_history_delay][i_processing_element];
+                    history_delay_line[i_history_delay][i_processing_element] = input_levels;
+                }
+
+                StencilImpl stencil(ID(output_grid_c + stencil_c_offset, output_grid_r),
+                                    UID(stencil_grid_width, grid_height), pe_iteration,
+                                    pe_subiteration, tdv, stencil_buffer[i_processing_element],
+                                    std::monostate(), &local_constant_table,
+                                    History::select_history(levels_carry, pe_subiteration));
+
+                // Cells outside of the stencil shape are never read, so their registers can be
+                // removed.
+#pragma unroll
+                for (uindex_stencil_t cell_c = 0; cell_c < uindex_stencil_t(stencil_diameter);
+                     cell_c++) {
+#pragma unroll
+                    for (uindex_stencil_t cell_r = 0; cell_r < uindex_stencil_t(stencil_diameter);
+                         cell_r++) {
+                        if (!stencil_shape.contains(
+                                index_t(cell_c) - index_t(TransFunc::stencil_radius),
+                                index_t(cell_r) - index_t(TransFunc::stencil_radius))) {
+                            stencil[StencilUID(cell_c, cell_r)] = buffer_halo_value;
+                        } else if constexpr (boundary_condition != BoundaryCondition::Constant) {
+                            // Clamped and reflected cells are read from other positions of the
+                            // stencil buffer. The columns of a strip are remapped with their
+                            // global index, since only the borders of the global grid reflect.
+                            index_t source_c = remap_stencil_offset<boundary_condition>(
+                                output_grid_c + stencil_c_offset,
+                                index_t(cell_c) - index_t(TransFunc::stencil_radius),
+                                index_t(stencil_grid_width));
+                            index_t source_r = remap_stencil_offset<boundary_condition>(
+                                output_grid_r,
+                                index_t(cell_r) - index_t(TransFunc::stencil_radius),
+                                index_t(grid_height));
+                            stencil[StencilUID(cell_c, cell_r)] =
+                                stencil_buffer[i_processing_element]
+                                              [source_c + index_t(TransFunc::stencil_radius)]
+                                              [source_r + index_t(TransFunc::stencil_radius)];
+                        }
+                    }
+                }
 
                 if (pe_iteration < target_i_iteration) {
-                    carry = trans_func(stencil);
+                    carry = History::get_transition_function(trans_func)(stencil);
+                    levels_carry = History::advance_history(
+                        stencil_buffer[i_processing_element][TransFunc::stencil_radius]
+                                      [TransFunc::stencil_radius],
+                        levels_carry, pe_subiteration);
                 } else {
                     carry = stencil_buffer[i_processing_element][TransFunc::stencil_radius]
                                           [TransFunc::stencil_radius];
@@ -250,16 +473,43 @@ class StencilUpdateKernel {
                 input_tile_r >= uindex_1d_t((stencil_diameter - 1) * n_processing_elements);
 
             if (is_valid_output) {
-                out_pipe::write(carry);
+                recorder.template write<out_pipe>(History::bundle(carry, levels_carry));
+                n_output_cells++;
+            }
+
+            if constexpr (History::enabled) {
+                i_history_delay = (i_history_delay == history_delay - 1) ? 0 : i_history_delay + 1;
             }
 
             if (input_tile_r == input_tile_section_height - 1) {
                 input_tile_r = 0;
-                input_tile_c++;
+                if (input_tile_c == input_tile_section_width - 1) {
+                    // Continue with the next tile of the schedule.
+                    input_tile_c = 0;
+                    if (i_tile_r == n_tile_rows - 1) {
+                        i_tile_r = 0;
+                        tile_r_offset = this->grid_r_offset;
+                        tile_c_offset += output_tile_width;
+                    } else {
+                        i_tile_r++;
+                        tile_r_offset += output_tile_height;
+                    }
+                    // The column offset passes the grid width after the last tile.
+                    uindex_t remaining_width = grid_width - std::min(grid_width, tile_c_offset);
+                    input_tile_section_width =
+                        std::min(output_tile_width, remaining_width) + 2 * halo_radius;
+                    input_tile_section_height =
+                        std::min(output_tile_height, grid_height - tile_r_offset) + 2 * halo_radius;
+                    history_delay = TransFunc::stencil_radius * (input_tile_section_height + 1);
+                    i_history_delay = 0;
+                } else {
+                    input_tile_c++;
+                }
             } else {
                 input_tile_r++;
             }
         }
+        recorder.store(counters, n_iterations, n_output_cells);
     }
 
   private:
@@ -270,8 +520,14 @@ class StencilUpdateKernel {
     uindex_t grid_r_offset;
     uindex_t grid_width;
     uindex_t grid_height;
+    uindex_t n_tile_columns;
+    uindex_t n_tile_rows;
+    index_t stencil_c_offset;
+    uindex_t stencil_grid_width;
     Cell halo_value;
     TDVKernelArgument tdv_kernel_argument;
+    ConstantTable constant_table;
+    KernelCountersArgument<instrumented> counters;
 };
 
 /**
@@ -280,7 +536,8 @@ class StencilUpdateKernel {
  * This updater applies an iterative stencil code, defined by the template parameter `F`, to the
  * grid; As often as requested.
  *
- * \tparam F The transition function to apply to input grids.
+ * \tparam F The transition function to apply to input grids. A transition function with a history
+ * is supported once it is wrapped in a \ref stencil::HistoryTransitionFunction.
  *
  * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs) to
  * implement. Increasing the number of PEs leads to a higher performance since more iterations are
@@ -300,17 +557,72 @@ class StencilUpdateKernel {
  *
  * \tparam TDVStrategy (Optimization parameter) The precomputation strategy for the time-dependent
  * value system (\ref page-tdv "See guide").
+ *
+ * \tparam dense_storage (Optimization parameter) Store cells densely packed in the on-chip caches
+ * instead of padding them to the next power of two. This saves on-chip memory for cells whose size
+ * isn't a power of two.
+ *
+ * \tparam persistent_kernel (Optimization parameter) Process all tiles of a pass with a single
+ * invocation of the input, execution, and output kernels instead of launching three kernels per
+ * tile. This removes the per-tile launch overhead, which dominates for grids with many small tiles.
+ *
+ * \tparam instrumented (Debugging parameter) Let the input, execution and output kernels count
+ * their active cycles, their stalls on empty and full pipes and the cells they move. This shows
+ * whether the execution kernel is starved by the input or blocked by the output, but the counters
+ * and the non-blocking pipe operations cost additional resources. The counters of the last call to
+ * \ref operator()() can be fetched with \ref get_kernel_counters.
+ *
+ * \tparam n_compute_units (Optimization parameter) The number of replicated chains of input,
+ * execution and output kernels. The tile columns of the grid are split statically into one
+ * contiguous range of nearly equal length per compute unit and every unit processes its tiles on
+ * its own queues and pipes, so that independent tiles are computed concurrently and may be served
+ * by different memory banks. The tiles aren't rebalanced at runtime, so a unit with a narrow edge
+ * tile column finishes its passes early and waits for the others. Between the passes, every unit
+ * keeps its tiles in a strip grid of its own, together with one tile column of every neighbour
+ * whose border columns are copied over after each pass. Multiple compute units can't be combined
+ * with a persistent kernel or the instrumentation.
+ *
+ * If the transition function uses static values, the static grid has to be set with \ref
+ * set_static_grid before the first update. The static values of every tile and its halo are
+ * streamed into the execution kernel alongside the cells, but only the cells are written back.
+ *
+ * If the transition function defines a reduction and \ref Params::reduction is set, the cells of
+ * every tile are reduced in the last pass by an additional kernel between the execution and the
+ * output kernel. The result can be fetched with \ref get_reduction_result.
+ *
+ * If the transition function defines a clamp or reflect \ref stencil::BoundaryCondition
+ * "boundary condition", the processing elements replace the cells outside of the grid with other
+ * cells of the same stencil. Periodic boundaries are not supported yet: Since every tile is read
+ * with its halo and the halo is recomputed redundantly, they would only need a wrapped halo.
+ * However, \ref Grid assembles the halo of a tile from column segments of its geometric
+ * neighbours, replaces the segments outside of the grid with the halo value as a whole and reuses
+ * the overlap rows of vertically adjacent tiles. Wrapped halos would have to be read from the
+ * opposite border instead, possibly from two tiles if the last tile row is lower than the halo.
  */
 template <concepts::TransitionFunction F, uindex_t n_processing_elements = 1,
           uindex_t tile_width = 1024, uindex_t tile_height = 1024,
           tdv::single_pass::Strategy<F, n_processing_elements> TDVStrategy =
-              tdv::single_pass::InlineStrategy>
+              tdv::single_pass::InlineStrategy,
+          bool dense_storage = false, bool persistent_kernel = false, bool instrumented = false,
+          uindex_t n_compute_units = 1>
+    requires(n_compute_units >= 1 &&
+             (n_compute_units == 1 || (!persistent_kernel && !instrumented)) && !has_history<F> &&
+             boundary_condition_of<F> != BoundaryCondition::Periodic)
 class StencilUpdate {
   private:
     using Cell = F::Cell;
-    using TDVGlobalState = typename TDVStrategy::template GlobalState<F, n_processing_elements>;
+    using KernelFunction =
+        std::conditional_t<has_static_values<F>, StaticValueTransitionFunction<F>, F>;
+    using TDVGlobalState =
+        typename TDVStrategy::template GlobalState<KernelFunction, n_processing_elements>;
     using TDVKernelArgument = typename TDVGlobalState::KernelArgument;
 
+    /// \brief A pipe that is never used, only to name an execution kernel in the performance model.
+    using ModelPipe = sycl::pipe<class tiling_model_pipe, Cell>;
+
+    /// \brief The name of a pipe of a compute unit.
+    template <uindex_t i_compute_unit, uindex_t i_pipe> class ComputeUnitPipeID;
+
   public:
     /**
      * \brief The radius of an input's tile halo.
@@ -322,6 +634,11 @@ class StencilUpdate {
      */
     using GridImpl = Grid<Cell, tile_width, tile_height, halo_radius>;
 
+    /**
+     * \brief A shorthand for the grid type of the static values.
+     */
+    using StaticGridImpl = Grid<StaticValueOf<F>, tile_width, tile_height, halo_radius>;
+
     /**
      * \brief Parameters for the stencil updater.
      */
@@ -335,6 +652,9 @@ class StencilUpdate {
 
         /**
          *  \brief The cell value to present for cells outside of the grid.
+         *
+         * This is only used with the \ref BoundaryCondition::Constant "constant" boundary
+         * condition.
          */
         Cell halo_value = Cell();
 
@@ -377,16 +697,83 @@ class StencilUpdate {
          *
          * Setting this option to true will enable the recording of computation start and end
          * timestamps. The recorded kernel runtime can be fetched using the \ref
-         * StencilUpdate::get_kernel_runtime method.
+         * StencilUpdate::get_kernel_runtime method. Additionally, all kernels and the host-side
+         * allocation and submission phases are recorded in the \ref StencilUpdate::get_timeline
+         * "timeline" of the updater.
          */
         bool profiling = false;
+
+        /**
+         * \brief Allow the updater to overwrite the source grid.
+         *
+         * By default, the updater leaves the source grid untouched and uses two additional grids
+         * for its double buffering scheme. If this option is set to true, the source grid is used
+         * as one of these two buffers instead, which reduces the required memory from three to two
+         * times the grid size. The contents of the source grid are undefined afterwards, unless it
+         * is returned as the result.
+         */
+        bool overwrite_source = false;
+
+        /**
+         * \brief The reduction to evaluate on the updated grid.
+         *
+         * If the transition function defines a reduction and this field is set, the cells of the
+         * returned grid are reduced on the device while they are written back. The result is
+         * available via \ref StencilUpdate::get_reduction_result. Since it's computed in the last
+         * pass, no reduction is evaluated if no iterations are computed.
+         */
+        std::optional<ReductionOf<F>> reduction = std::nullopt;
+
+        /**
+         * \brief Skip tiles whose neighborhood didn't change in the previous pass.
+         *
+         * If set, the output kernels compare every updated tile with its previous contents. In the
+         * following pass, a tile is copied instead of recomputed if neither it nor any of its eight
+         * neighbors has changed. This is only correct if the new value of a cell solely depends
+         * on the values of the stencil, and not on the iteration index, a time-dependent value, or
+         * the position of the cell. Passes with a different number of iterations than the previous
+         * pass and passes that evaluate a reduction are always fully computed. Since the host has
+         * to inspect the changes of one pass before submitting the next one, the passes are no
+         * longer queued ahead. This requires an equality-comparable cell type and isn't supported
+         * together with `persistent_kernel` or multiple compute units.
+         */
+        bool skip_inactive_tiles = false;
+
+        /**
+         * \brief The contents of the constant table of the transition function.
+         *
+         * This is only used if the transition function defines a \ref stencil::ConstantTable
+         * "constant table". The table is copied to the device once per kernel and shared by all
+         * processing elements.
+         */
+        ConstantTableOf<F> constant_table = ConstantTableOf<F>();
+
+        /**
+         * \brief The clock frequency of the design in Hz.
+         *
+         * If this field is set and profiling is enabled, the measured kernel runtime of every call
+         * to \ref StencilUpdate::operator()() is compared with \ref StencilUpdate::model_runtime.
+         * The result is available via \ref StencilUpdate::get_efficiency.
+         */
+        std::optional<double> clock_frequency = std::nullopt;
+
+        /**
+         * \brief The latency of the execution kernel's main loop in clock cycles.
+         *
+         * This is added to the modeled runtime of every execution kernel invocation. The synthesis
+         * report lists it as the latency of the loop.
+         */
+        uindex_t loop_latency = 0;
     };
 
     /**
      * \brief Create a new stencil updater object.
      */
     StencilUpdate(Params params)
-        : params(params), n_processed_cells(0), work_events(), walltime(0.0) {}
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          static_grid(std::nullopt), queues_profiling(false), n_processed_cells(0),
+          n_skipped_tiles(0), work_events(), walltime(0.0), timeline(), counters_buffers(),
+          last_call_first_work_event(0), last_call_model_runtime(std::nullopt) {}
 
     /**
      * \brief Return a reference to the parameters.
@@ -395,36 +782,394 @@ class StencilUpdate {
      */
     Params &get_params() { return params; }
 
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the grid of static values, if one has been set.
+     */
+    std::optional<StaticGridImpl> get_static_grid() const { return static_grid; }
+
+    /**
+     * \brief Set the grid of static values.
+     *
+     * Every cell of the source grid receives the static value at the same position of this grid
+     * as `stencil.static_value`. The static grid is only read and therefore may be used for
+     * multiple updates and updaters. It must have the same size as the grids it's used with.
+     */
+    void set_static_grid(StaticGridImpl static_grid)
+        requires(has_static_values<F>)
+    {
+        this->static_grid = static_grid;
+    }
+
+    /**
+     * \brief Prepare the updater for timed computations.
+     *
+     * This method creates the queues of the updater and computes one iteration of a small grid.
+     * This forces the compilation of the kernels or the programming of the FPGA, so that it
+     * doesn't distort the measurements of later calls to \ref operator()(). The accumulated
+     * statistics of the updater are not affected and this method blocks until the computation is
+     * complete.
+     */
+    void warm_up() {
+        GridImpl grid(1, 1);
+        {
+            typename GridImpl::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+            ac[0][0] = params.halo_value;
+        }
+
+        // The guards restore the state of the updater even if the warm-up computation throws.
+        RestoreGuard params_guard(params);
+        RestoreGuard static_grid_guard(static_grid);
+        RestoreGuard n_processed_cells_guard(n_processed_cells);
+        RestoreGuard walltime_guard(walltime);
+        RestoreGuard work_events_guard(work_events);
+        RestoreGuard reduction_result_guard(reduction_result);
+        RestoreGuard first_work_event_guard(last_call_first_work_event);
+        RestoreGuard model_runtime_guard(last_call_model_runtime);
+        RestoreGuard timeline_guard(timeline);
+
+        if constexpr (has_static_values<F>) {
+            static_grid = StaticGridImpl(1, 1);
+            typename StaticGridImpl::template GridAccessor<sycl::access::mode::read_write> ac(
+                *static_grid);
+            ac[0][0] = StaticValueOf<F>();
+        }
+        params.n_iterations = 1;
+        params.blocking = true;
+        (*this)(grid);
+    }
+
     /**
      * \brief Compute a new grid based on the source grid, using the configured transition function.
      *
-     * The computation does not work in-place. Instead, it will allocate two additional grids with
-     * the same size as the source grid and use them for a double buffering scheme. Therefore, you
-     * are free to reuse the source grid as it will not be altered.
+     * The computation does not work in-place. Instead, it will request two additional grids with
+     * the same size as the source grid from the grid pool and use them for a double buffering
+     * scheme. Therefore, you are free to reuse the source grid as it will not be altered. If \ref
+     * Params::overwrite_source is true, the source grid is used as one of the buffers instead and
+     * only one additional grid is requested.
      *
      * If \ref Params::blocking is set to true, this method will block until the computation is
      * complete. Otherwise, it will return as soon as all kernels are submitted.
+     *
+     * \throws std::invalid_argument The transition function uses static values, but no static
+     * grid has been set.
+     *
+     * \throws std::range_error The static grid doesn't have the same size as the source grid.
+     *
+     * \throws std::invalid_argument The transition function reflects the grid at its borders, but
+     * the grid is narrower or lower than the stencil radius.
      */
     GridImpl operator()(GridImpl &source_grid) {
-        using in_pipe = sycl::pipe<class tiling_in_pipe, Cell>;
-        using out_pipe = sycl::pipe<class tiling_out_pipe, Cell>;
-        using ExecutionKernelImpl = StencilUpdateKernel<F, TDVKernelArgument, n_processing_elements,
-                                                        tile_width, tile_height, in_pipe, out_pipe>;
+        if constexpr (has_static_values<F>) {
+            if (!static_grid.has_value()) {
+                throw std::invalid_argument("The transition function uses static values, but no "
+                                            "static grid has been set.");
+            }
+            if (static_grid->get_grid_width() != source_grid.get_grid_width() ||
+                static_grid->get_grid_height() != source_grid.get_grid_height()) {
+                throw std::range_error("The static grid and the source grid differ in size.");
+            }
+        }
+        if (boundary_condition_of<F> == BoundaryCondition::Reflect &&
+            std::min(source_grid.get_grid_width(), source_grid.get_grid_height()) <
+                F::stencil_radius) {
+            throw std::invalid_argument(
+                "Reflected grids must be at least as wide and high as the stencil radius.");
+        }
+        if (params.skip_inactive_tiles &&
+            (persistent_kernel || n_compute_units > 1 || !std::equality_comparable<Cell>)) {
+            throw std::invalid_argument("Inactive tiles can only be skipped with a single compute "
+                                        "unit, per-tile kernels and an equality-comparable cell "
+                                        "type.");
+        }
 
+        reduction_result = std::nullopt;
         if (params.n_iterations == 0) {
             return GridImpl(source_grid);
         }
 
-        sycl::queue input_kernel_queue =
-            sycl::queue(params.device, {sycl::property::queue::in_order{}});
-        sycl::queue output_kernel_queue =
-            sycl::queue(params.device, {sycl::property::queue::in_order{}});
-        sycl::queue working_queue =
-            sycl::queue(params.device, {cl::sycl::property::queue::enable_profiling{},
-                                        sycl::property::queue::in_order{}});
+        prepare_queues();
+        if constexpr (instrumented) {
+            counters_buffers = StencilUpdateCountersBuffers();
+        }
 
-        GridImpl swap_grid_a = source_grid.make_similar();
-        GridImpl swap_grid_b = source_grid.make_similar();
+        last_call_first_work_event = work_events.size();
+        last_call_model_runtime = std::nullopt;
+        if (params.profiling && params.clock_frequency.has_value()) {
+            last_call_model_runtime =
+                model_runtime(source_grid.get_grid_width(), source_grid.get_grid_height(),
+                              params.n_iterations, *params.clock_frequency, params.loop_latency);
+        }
+        if constexpr (has_reduction<F>) {
+            if (params.reduction.has_value()) {
+                reduction_result = ReductionResult<Cell, ReductionOf<F>>(*params.reduction);
+            }
+        }
+
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        GridImpl target_grid = source_grid;
+        if constexpr (n_compute_units == 1) {
+            target_grid = run_single_unit(source_grid);
+        } else {
+            target_grid = run_compute_units(source_grid);
+        }
+
+        if (params.blocking) {
+            for (std::optional<sycl::queue> &queue : output_kernel_queues) {
+                queue->wait();
+            }
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+
+        n_processed_cells +=
+            params.n_iterations * source_grid.get_grid_width() * source_grid.get_grid_height();
+
+        return target_grid;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the width times the height of the grid, times
+     * the number of computed iterations. This will also be accumulated across multiple calls to
+     * \ref operator()().
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated total number of tiles that were copied instead of recomputed.
+     *
+     * Tiles are only skipped if \ref Params::skip_inactive_tiles is set. The skipped tiles are
+     * still included in \ref get_n_processed_cells.
+     */
+    uindex_t get_n_skipped_tiles() const { return n_skipped_tiles; }
+
+    /**
+     * \brief Return the accumulated total runtime of the execution kernel.
+     *
+     * This runtime is accumulated across multiple calls to \ref operator()(). However, this is only
+     * possible if \ref Params::profiling is set to true.
+     */
+    double get_kernel_runtime() const { return calc_kernel_runtime(0); }
+
+    /**
+     * \brief Model the runtime of the execution kernels for a grid of the given size.
+     *
+     * The model assumes that the execution kernel processes one cell per clock cycle and that the
+     * input and output kernels keep up with it. Every tile takes \ref
+     * StencilUpdateKernel::calc_n_iterations loop iterations, so the halos of small tiles are
+     * accounted for, and every invocation of the execution kernel adds the latency of its loop.
+     * With a persistent kernel, there is one invocation per pass instead of one per tile. With
+     * multiple compute units, a pass takes as long as the unit with the most work, while the
+     * exchange of the border columns between the units is neglected. Tiles that are skipped
+     * because of \ref Params::skip_inactive_tiles are still included.
+     *
+     * \param grid_width The number of columns of the grid.
+     *
+     * \param grid_height The number of rows of the grid.
+     *
+     * \param n_iterations The number of computed iterations.
+     *
+     * \param clock_frequency The clock frequency of the design in Hz.
+     *
+     * \param loop_latency The latency of the execution kernel's main loop in clock cycles.
+     *
+     * \return The modeled runtime in seconds.
+     */
+    static constexpr double model_runtime(uindex_t grid_width, uindex_t grid_height,
+                                          uindex_t n_iterations, double clock_frequency,
+                                          uindex_t loop_latency = 0) {
+        using ModelKernel =
+            StencilUpdateKernel<KernelFunction, TDVKernelArgument, n_processing_elements,
+                                tile_width, tile_height, ModelPipe, ModelPipe, dense_storage>;
+
+        uint64_t n_cycles_per_pass = 0;
+        for (TileStrip const &strip : partition_tiles(grid_width)) {
+            if (strip.tile_begin == strip.tile_end) {
+                continue;
+            }
+            uint64_t n_strip_cycles = persistent_kernel ? loop_latency : 0;
+            for (uindex_t tile_c = strip.tile_begin; tile_c < strip.tile_end; tile_c++) {
+                for (uindex_t tile_r = 0; tile_r < n_cells_to_n_words(grid_height, tile_height);
+                     tile_r++) {
+                    uindex_t section_width =
+                        std::min(tile_width, grid_width - tile_c * tile_width);
+                    uindex_t section_height =
+                        std::min(tile_height, grid_height - tile_r * tile_height);
+                    n_strip_cycles +=
+                        ModelKernel::calc_n_iterations(section_width, section_height);
+                    if constexpr (!persistent_kernel) {
+                        n_strip_cycles += loop_latency;
+                    }
+                }
+            }
+            n_cycles_per_pass = std::max(n_cycles_per_pass, n_strip_cycles);
+        }
+
+        uint64_t n_passes =
+            n_cells_to_n_words(n_iterations, n_processing_elements / F::n_subiterations);
+        return double(n_passes * n_cycles_per_pass) / clock_frequency;
+    }
+
+    /**
+     * \brief Return the efficiency of the last call to \ref operator()().
+     *
+     * This is the runtime from \ref model_runtime divided by the measured runtime of the
+     * execution kernels, so values well below one indicate that the kernels were stalled, for
+     * example by a slow memory system or a degraded board. The efficiency is only available if
+     * the last call was profiled, \ref Params::clock_frequency was set and at least one iteration
+     * was computed. This method blocks until the kernels of the last call have completed.
+     */
+    std::optional<double> get_efficiency() const {
+        if (!last_call_model_runtime.has_value() || *last_call_model_runtime == 0.0) {
+            return std::nullopt;
+        }
+        double kernel_runtime = calc_kernel_runtime(last_call_first_work_event);
+        if (kernel_runtime == 0.0) {
+            return std::nullopt;
+        }
+        return *last_call_model_runtime / kernel_runtime;
+    }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     *
+     * For each call to \ref operator()(), the time it took to submit all kernels and, if \ref
+     * Params::blocking is true, to finish the computation is recorded and accumulated.
+     */
+    double get_walltime() const { return walltime; }
+
+    /**
+     * \brief Return the timeline of the kernels and host-side phases of all profiled calls.
+     *
+     * Events are only recorded if \ref Params::profiling is set to true. In every pass, the input,
+     * execution and output kernels are recorded, tagged with the pass, the tile if per-tile kernels
+     * are used, and the computed iterations, as well as the time it took the host to submit them.
+     * The allocation of the grids is recorded as the host-side phase "allocate".
+     */
+    Timeline &get_timeline() { return timeline; }
+
+    /**
+     * \brief Return the kernel counters from the last call to \ref operator()().
+     *
+     * The counters are recorded on the device and summed up over all passes and tiles. The read
+     * counters cover the input kernels of the cells, but not those of the static values, and the
+     * write counters cover the output kernels, except for the tracked writes and copies of \ref
+     * Params::skip_inactive_tiles. This method blocks until the kernels have completed. If the
+     * updater hasn't been called yet, all counters are zero.
+     */
+    StencilUpdateCounters get_kernel_counters() const
+        requires(instrumented)
+    {
+        return counters_buffers.has_value() ? counters_buffers->get() : StencilUpdateCounters();
+    }
+
+    /**
+     * \brief Return the result of the reduction of the grid returned by the last call to \ref
+     * operator()().
+     *
+     * This method blocks until the reduction is complete. If the last call didn't evaluate a
+     * reduction, since \ref Params::reduction wasn't set or no iterations were computed, nothing is
+     * returned.
+     */
+    auto get_reduction_result()
+        requires(has_reduction<F>)
+    {
+        using Value = typename ReductionOf<F>::Value;
+        return reduction_result.has_value() ? std::optional<Value>(reduction_result->get())
+                                            : std::optional<Value>();
+    }
+
+    /**
+     * \brief Return the pending reduction of the grid returned by the last call to \ref
+     * operator()(), without waiting for it.
+     *
+     * \ref stencil::run_until uses this to check the reduction of one interval while the next
+     * interval is computed. Nothing is returned if the last call didn't evaluate a reduction.
+     */
+    std::optional<ReductionResult<Cell, ReductionOf<F>>> get_pending_reduction_result() const
+        requires(has_reduction<F>)
+    {
+        return reduction_result;
+    }
+
+    /**
+     * \brief Replace the pending reduction that \ref get_reduction_result returns.
+     *
+     * \ref stencil::run_until uses this to drop the reduction of its speculative interval.
+     */
+    void set_pending_reduction_result(std::optional<ReductionResult<Cell, ReductionOf<F>>> result)
+        requires(has_reduction<F>)
+    {
+        reduction_result = result;
+    }
+
+  private:
+    /**
+     * \brief Return the accumulated runtime of the execution kernels, starting with the given
+     * group of work events.
+     */
+    double calc_kernel_runtime(std::size_t first_work_event) const {
+        double kernel_runtime = 0.0;
+        for (std::size_t i_group = first_work_event; i_group < work_events.size(); i_group++) {
+            // A group holds either a single execution kernel or all execution kernels of one pass
+            // of the compute units. These run concurrently, so the group is measured from its
+            // first start to its last end.
+            const double timesteps_per_second = 1000000000.0;
+            double start = std::numeric_limits<double>::max();
+            double end = 0.0;
+            for (sycl::event work_event : work_events[i_group]) {
+                start = std::min(
+                    start,
+                    double(work_event.get_profiling_info<
+                           cl::sycl::info::event_profiling::command_start>()) /
+                        timesteps_per_second);
+                end = std::max(
+                    end, double(work_event.get_profiling_info<
+                                cl::sycl::info::event_profiling::command_end>()) /
+                             timesteps_per_second);
+            }
+            kernel_runtime += end - start;
+        }
+        return kernel_runtime;
+    }
+
+    /**
+     * \brief Compute all passes with a single chain of input, execution and output kernels.
+     *
+     * The passes alternate between two swap grids, and the kernels are submitted either once per
+     * tile or, with a persistent kernel, once per pass.
+     */
+    GridImpl run_single_unit(GridImpl &source_grid) {
+        using Pipes = ComputeUnitPipes<0>;
+        using cell_in_pipe = typename Pipes::cell_in_pipe;
+        using cell_out_pipe = typename Pipes::cell_out_pipe;
+        using static_value_pipe = typename Pipes::static_value_pipe;
+        using reduction_pipe = typename Pipes::reduction_pipe;
+        using ExecutionKernelImpl = typename Pipes::ExecutionKernelImpl;
+
+        double allocation_start = timeline.now();
+        GridImpl swap_grid_a =
+            params.overwrite_source ? source_grid : grid_pool->acquire(source_grid);
+        GridImpl swap_grid_b = grid_pool->acquire(source_grid);
+        record_host_phase("allocate", TimelineEvent(), allocation_start);
 
         uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
         GridImpl *pass_source = &source_grid;
@@ -434,40 +1179,120 @@ class StencilUpdate {
         uindex_t grid_width = source_grid.get_grid_width();
         uindex_t grid_height = source_grid.get_grid_height();
 
-        F trans_func = params.transition_function;
+        KernelFunction trans_func(params.transition_function);
+        typename KernelFunction::Cell halo_value = get_kernel_halo_value();
         TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
 
-        auto walltime_start = std::chrono::high_resolution_clock::now();
+        // The tiles that changed in the previous pass, if they are tracked.
+        std::optional<sycl::buffer<bool, 1>> previous_changed_flags;
+        uindex_t iters_in_previous_pass = 0;
 
         uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
         for (uindex_t i = params.iteration_offset; i < target_n_iterations; i += iters_per_pass) {
             uindex_t iters_in_this_pass = std::min(iters_per_pass, target_n_iterations - i);
+            bool reduction_pass = false;
+            if constexpr (has_reduction<F>) {
+                reduction_pass =
+                    reduction_result.has_value() && i + iters_in_this_pass == target_n_iterations;
+            }
+            PassContext pass{.trans_func = trans_func,
+                             .tdv_global_state = tdv_global_state,
+                             .halo_value = halo_value,
+                             .i_iteration = i,
+                             .iters_in_pass = iters_in_this_pass,
+                             .target_n_iterations = target_n_iterations,
+                             .grid_width = grid_width,
+                             .grid_height = grid_height,
+                             .reduction_pass = reduction_pass};
+            TimelineEvent pass_tags{.pass = (i - params.iteration_offset) / iters_per_pass,
+                                    .iteration_begin = i,
+                                    .iteration_end = i + iters_in_this_pass};
+            double submission_start = timeline.now();
+
+            if constexpr (persistent_kernel) {
+                record_kernel("read", pass_tags,
+                              submit_grid_read<cell_in_pipe>(0, *pass_source, std::nullopt));
+                if constexpr (has_static_values<F>) {
+                    record_kernel("read static values", pass_tags,
+                                  static_grid->template submit_read_tiles<static_value_pipe>(
+                                      *static_input_kernel_queues[0], StaticValueOf<F>()));
+                }
 
-            for (uindex_t i_tile_c = 0; i_tile_c < tile_range.c; i_tile_c++) {
-                for (uindex_t i_tile_r = 0; i_tile_r < tile_range.r; i_tile_r++) {
-                    pass_source->template submit_read<in_pipe>(input_kernel_queue, i_tile_c,
-                                                               i_tile_r, params.halo_value);
-
-                    auto work_event = working_queue.submit([&](sycl::handler &cgh) {
-                        TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i,
-                                                              iters_in_this_pass);
-                        uindex_t c_offset = i_tile_c * tile_width;
-                        uindex_t r_offset = i_tile_r * tile_height;
-
-                        ExecutionKernelImpl exec_kernel(trans_func, i, target_n_iterations,
-                                                        c_offset, r_offset, grid_width, grid_height,
-                                                        params.halo_value, tdv_kernel_argument);
-
-                        cgh.single_task<ExecutionKernelImpl>(exec_kernel);
-                    });
-                    if (params.profiling) {
-                        work_events.push_back(work_event);
+                auto work_event = working_queues[0]->submit([&](sycl::handler &cgh) {
+                    TDVKernelArgument tdv_kernel_argument(tdv_global_state, cgh, i,
+                                                          iters_in_this_pass);
+                    ExecutionKernelImpl exec_kernel(trans_func, i, target_n_iterations, tile_range,
+                                                    grid_width, grid_height, halo_value,
+                                                    tdv_kernel_argument);
+                    exec_kernel.set_constant_table(params.constant_table);
+                    if constexpr (instrumented) {
+                        exec_kernel.set_counters(
+                            make_kernel_counters_argument<true>(counters_buffers->compute, cgh));
+                    }
+                    cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+                });
+                if (params.profiling) {
+                    work_events.push_back({work_event});
+                }
+                record_kernel("compute", pass_tags, work_event);
+
+                if (reduction_pass) {
+                    if constexpr (has_reduction<F>) {
+                        record_kernel("reduce", pass_tags,
+                                      submit_reduction_kernel<Cell, cell_out_pipe, reduction_pipe>(
+                                          *reduction_kernel_queues[0], *params.reduction,
+                                          grid_width, grid_height,
+                                          reduction_result->add_partial_results(1)));
+                        record_kernel("write", pass_tags,
+                                      submit_grid_write<reduction_pipe>(0, *pass_target,
+                                                                        std::nullopt));
+                    }
+                } else {
+                    record_kernel("write", pass_tags,
+                                  submit_grid_write<cell_out_pipe>(0, *pass_target, std::nullopt));
+                }
+            } else {
+                std::vector<bool> skip_tile(tile_range.c * tile_range.r, false);
+                std::optional<sycl::buffer<bool, 1>> changed_flags;
+                if (params.skip_inactive_tiles && !reduction_pass) {
+                    if (previous_changed_flags.has_value() &&
+                        iters_in_this_pass == iters_in_previous_pass) {
+                        skip_tile = find_inactive_tiles(*previous_changed_flags, tile_range);
                     }
+                    changed_flags = sycl::buffer<bool, 1>(sycl::range<1>(skip_tile.size()));
+                    sycl::host_accessor changed_ac(*changed_flags, sycl::write_only);
+                    for (uindex_t i_flag = 0; i_flag < skip_tile.size(); i_flag++) {
+                        changed_ac[i_flag] = false;
+                    }
+                }
 
-                    pass_target->template submit_write<out_pipe>(output_kernel_queue, i_tile_c,
-                                                                 i_tile_r);
+                for (uindex_t i_tile_c = 0; i_tile_c < tile_range.c; i_tile_c++) {
+                    for (uindex_t i_tile_r = 0; i_tile_r < tile_range.r; i_tile_r++) {
+                        TimelineEvent tile_tags = pass_tags;
+                        tile_tags.tile = UID(i_tile_c, i_tile_r);
+
+                        if (skip_tile[i_tile_c * tile_range.r + i_tile_r]) {
+                            record_kernel("copy", tile_tags,
+                                          pass_target->submit_copy_tile(*output_kernel_queues[0],
+                                                                        *pass_source, i_tile_c,
+                                                                        i_tile_r));
+                            n_skipped_tiles++;
+                            continue;
+                        }
+
+                        sycl::event work_event =
+                            submit_tile<0>(pass, *pass_source, 0, *pass_target, 0, i_tile_c,
+                                           i_tile_r, tile_tags, changed_flags);
+                        if (params.profiling) {
+                            work_events.push_back({work_event});
+                        }
+                    }
                 }
+
+                previous_changed_flags = changed_flags;
+                iters_in_previous_pass = iters_in_this_pass;
             }
+            record_host_phase("submit", pass_tags, submission_start);
 
             if (i == params.iteration_offset) {
                 pass_source = &swap_grid_b;
@@ -477,65 +1302,548 @@ class StencilUpdate {
             }
         }
 
-        if (params.blocking) {
-            output_kernel_queue.wait();
+        return *pass_source;
+    }
+
+    /**
+     * \brief The pipes and the execution kernel of a compute unit.
+     *
+     * Every compute unit needs pipes of its own, since a pipe connects exactly one writing and one
+     * reading kernel.
+     */
+    template <uindex_t i_unit> struct ComputeUnitPipes {
+        using cell_in_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 0>, Cell>;
+        using cell_out_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 1>, Cell>;
+        using static_value_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 2>, StaticValueOf<F>>;
+        using reduction_pipe = sycl::pipe<ComputeUnitPipeID<i_unit, 3>, Cell>;
+        using in_pipe = std::conditional_t<
+            has_static_values<F>,
+            StaticValueInputPipe<Cell, StaticValueOf<F>, cell_in_pipe, static_value_pipe>,
+            cell_in_pipe>;
+        using out_pipe = std::conditional_t<has_static_values<F>,
+                                            StaticValueOutputPipe<cell_out_pipe>, cell_out_pipe>;
+        using ExecutionKernelImpl =
+            StencilUpdateKernel<KernelFunction, TDVKernelArgument, n_processing_elements,
+                                tile_width, tile_height, in_pipe, out_pipe, dense_storage,
+                                instrumented, boundary_condition_of<F>>;
+    };
+
+    /**
+     * \brief The arguments of a pass that are the same for all of its tiles.
+     */
+    struct PassContext {
+        KernelFunction const &trans_func;
+        TDVGlobalState &tdv_global_state;
+        typename KernelFunction::Cell halo_value;
+        uindex_t i_iteration;
+        uindex_t iters_in_pass;
+        uindex_t target_n_iterations;
+        uindex_t grid_width;
+        uindex_t grid_height;
+        bool reduction_pass;
+    };
+
+    /**
+     * \brief Submit the input, execution and output kernels that update one tile in a pass.
+     *
+     * The tile is read from `read_grid` and written to `write_grid`. Either of them may be a strip
+     * grid of a compute unit, whose first tile column is the tile column `read_tile_offset` or
+     * `write_tile_offset` of the whole grid. `i_tile_c` and `i_tile_r` always refer to the whole
+     * grid.
+     *
+     * \tparam i_unit The compute unit whose pipes and queues are used.
+     *
+     * \param changed_flags If set, the output kernel still writes every cell of the tile, but it
+     * also compares them with the read grid and records in these flags whether any cell changed.
+     *
+     * \returns The event of the execution kernel.
+     */
+    template <uindex_t i_unit>
+    sycl::event submit_tile(PassContext const &pass, GridImpl &read_grid,
+                            uindex_t read_tile_offset, GridImpl &write_grid,
+                            uindex_t write_tile_offset, uindex_t i_tile_c, uindex_t i_tile_r,
+                            TimelineEvent tile_tags,
+                            std::optional<sycl::buffer<bool, 1>> const &changed_flags) {
+        using Pipes = ComputeUnitPipes<i_unit>;
+        using cell_in_pipe = typename Pipes::cell_in_pipe;
+        using cell_out_pipe = typename Pipes::cell_out_pipe;
+        using static_value_pipe = typename Pipes::static_value_pipe;
+        using reduction_pipe = typename Pipes::reduction_pipe;
+        using ExecutionKernelImpl = typename Pipes::ExecutionKernelImpl;
+
+        UID read_tile(i_tile_c - read_tile_offset, i_tile_r);
+        UID write_tile(i_tile_c - write_tile_offset, i_tile_r);
+
+        record_kernel("read", tile_tags,
+                      submit_grid_read<cell_in_pipe>(i_unit, read_grid, read_tile));
+        if constexpr (has_static_values<F>) {
+            record_kernel("read static values", tile_tags,
+                          static_grid->template submit_read<static_value_pipe>(
+                              *static_input_kernel_queues[i_unit], i_tile_c, i_tile_r,
+                              StaticValueOf<F>()));
         }
 
-        auto walltime_end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> walltime = walltime_end - walltime_start;
-        this->walltime += walltime.count();
+        sycl::event work_event = working_queues[i_unit]->submit([&](sycl::handler &cgh) {
+            TDVKernelArgument tdv_kernel_argument(pass.tdv_global_state, cgh, pass.i_iteration,
+                                                  pass.iters_in_pass);
+            ExecutionKernelImpl exec_kernel(
+                pass.trans_func, pass.i_iteration, pass.target_n_iterations,
+                read_tile.c * tile_width, read_tile.r * tile_height, read_grid.get_grid_width(),
+                pass.grid_height, pass.halo_value, tdv_kernel_argument);
+            exec_kernel.set_global_columns(read_tile_offset * tile_width, pass.grid_width);
+            exec_kernel.set_constant_table(params.constant_table);
+            if constexpr (instrumented) {
+                exec_kernel.set_counters(
+                    make_kernel_counters_argument<true>(counters_buffers->compute, cgh));
+            }
+            cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+        });
+        record_kernel("compute", tile_tags, work_event);
+
+        if (pass.reduction_pass) {
+            if constexpr (has_reduction<F>) {
+                record_kernel("reduce", tile_tags,
+                              submit_reduction_kernel<Cell, cell_out_pipe, reduction_pipe>(
+                                  *reduction_kernel_queues[i_unit], *params.reduction,
+                                  std::min(pass.grid_width - i_tile_c * tile_width, tile_width),
+                                  std::min(pass.grid_height - i_tile_r * tile_height, tile_height),
+                                  reduction_result->add_partial_results(1)));
+                record_kernel("write", tile_tags,
+                              submit_grid_write<reduction_pipe>(i_unit, write_grid, write_tile));
+            }
+        } else if (changed_flags.has_value()) {
+            if constexpr (std::equality_comparable<Cell>) {
+                record_kernel("write", tile_tags,
+                              write_grid.template submit_tracked_write<cell_out_pipe>(
+                                  *output_kernel_queues[i_unit], write_tile.c, write_tile.r,
+                                  read_grid, *changed_flags));
+            }
+        } else {
+            record_kernel("write", tile_tags,
+                          submit_grid_write<cell_out_pipe>(i_unit, write_grid, write_tile));
+        }
+        return work_event;
+    }
 
-        n_processed_cells +=
-            params.n_iterations * source_grid.get_grid_width() * source_grid.get_grid_height();
+    /**
+     * \brief The tile columns that a compute unit updates.
+     */
+    struct TileStrip {
+        /// \brief The first tile column of the grid that the compute unit updates.
+        uindex_t tile_begin;
+        /// \brief One past the last tile column of the grid that the compute unit updates.
+        uindex_t tile_end;
+        /// \brief The first grid column of the strip grid of the compute unit.
+        uindex_t begin;
+        /// \brief One past the last grid column of the strip grid of the compute unit.
+        uindex_t end;
+    };
 
-        return *pass_source;
+    /**
+     * \brief Distribute the tile columns of the grid among the compute units.
+     *
+     * This is a static split by the number of tile columns: Every compute unit receives a
+     * contiguous range of tile columns and if they can't be distributed evenly, the first units
+     * receive one tile column more. The width of the tiles isn't taken into account, so the
+     * narrower tile column at the right edge of the grid counts as a full one. Units are left
+     * without tile columns if there are less tile columns than units. The strip grid of a unit
+     * additionally covers the neighbouring tile columns, so that its tiles are aligned with the
+     * tiles of the grid and the halos of its border tiles are on hand.
+     */
+    static constexpr std::array<TileStrip, n_compute_units> partition_tiles(uindex_t grid_width) {
+        uindex_t n_tile_columns = n_cells_to_n_words(grid_width, tile_width);
+        std::array<TileStrip, n_compute_units> strips;
+        uindex_t tile_begin = 0;
+        for (uindex_t i_unit = 0; i_unit < n_compute_units; i_unit++) {
+            uindex_t tile_end = tile_begin + n_tile_columns / n_compute_units +
+                                (i_unit < n_tile_columns % n_compute_units ? 1 : 0);
+            uindex_t strip_tile_begin = tile_begin - std::min<uindex_t>(tile_begin, 1);
+            uindex_t strip_tile_end = std::min(tile_end + 1, n_tile_columns);
+            strips[i_unit] = {
+                .tile_begin = tile_begin,
+                .tile_end = tile_end,
+                .begin = strip_tile_begin * tile_width,
+                .end = std::min(grid_width, strip_tile_end * tile_width),
+            };
+            tile_begin = tile_end;
+        }
+        return strips;
     }
 
     /**
-     * \brief Return the accumulated total number of cells processed by this updater.
+     * \brief The grids and buffers that a compute unit keeps between the passes.
+     */
+    struct ComputeUnitBuffers {
+        /// \brief The two strip grids of the compute unit's double buffering scheme.
+        std::array<GridImpl, 2> strip_grids;
+        /// \brief The staging buffer for the border columns of the left neighbour, if any.
+        std::optional<sycl::buffer<Cell, 2>> left_border;
+        /// \brief The staging buffer for the border columns of the right neighbour, if any.
+        std::optional<sycl::buffer<Cell, 2>> right_border;
+    };
+
+    /**
+     * \brief Compute all passes with `n_compute_units` parallel chains of input, execution and
+     * output kernels.
      *
-     * For each call of to \ref operator()(), this is the width times the height of the grid, times
-     * the number of computed iterations. This will also be accumulated across multiple calls to
-     * \ref operator()().
+     * Every compute unit updates the tiles of its \ref TileStrip. The first pass reads the tiles
+     * directly from the source grid and the last pass writes them directly to the target grid.
+     * In between, the units write to strip grids of their own, so that their output kernels never
+     * access the same buffer and may run concurrently. After every intermediate pass, the first
+     * and last `halo_radius` columns of every unit are copied into the strip grids of its
+     * neighbours, since they are read as the halos of the neighbours' border tiles.
      */
-    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+    GridImpl run_compute_units(GridImpl &source_grid) {
+        uindex_t grid_width = source_grid.get_grid_width();
+        uindex_t grid_height = source_grid.get_grid_height();
+        std::array<TileStrip, n_compute_units> strips = partition_tiles(grid_width);
+        uindex_t n_active_units = 0;
+        while (n_active_units < n_compute_units &&
+               strips[n_active_units].tile_begin != strips[n_active_units].tile_end) {
+            n_active_units++;
+        }
+
+        uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+        uindex_t n_passes = n_cells_to_n_words(params.n_iterations, iters_per_pass);
+        double allocation_start = timeline.now();
+        GridImpl target_grid = (params.overwrite_source && n_passes > 1)
+                                   ? source_grid
+                                   : grid_pool->acquire(source_grid);
+
+        // The border columns that a unit receives from its left and right neighbour.
+        auto calc_border_range = [&](uindex_t i_unit, bool left) {
+            TileStrip strip = strips[i_unit];
+            if (left) {
+                return strip.tile_begin == 0 ? std::optional<sycl::range<2>>()
+                                             : sycl::range<2>(halo_radius, grid_height);
+            }
+            if (strip.tile_end * tile_width >= grid_width) {
+                return std::optional<sycl::range<2>>();
+            }
+            return std::optional<sycl::range<2>>(sycl::range<2>(
+                std::min(halo_radius, strip.end - strip.tile_end * tile_width), grid_height));
+        };
+        auto get_border_range = [](std::optional<sycl::buffer<Cell, 2>> const &buffer) {
+            return buffer.has_value() ? std::optional<sycl::range<2>>(buffer->get_range())
+                                      : std::optional<sycl::range<2>>();
+        };
+
+        // Allocate the strip grids and border buffers, or reuse the ones of the previous call if
+        // they fit.
+        if (n_passes > 1) {
+            bool unit_buffers_fit = unit_buffers.size() == n_active_units;
+            for (uindex_t i_unit = 0; unit_buffers_fit && i_unit < n_active_units; i_unit++) {
+                ComputeUnitBuffers const &buffers = unit_buffers[i_unit];
+                for (GridImpl const &grid : buffers.strip_grids) {
+                    unit_buffers_fit &=
+                        grid.get_grid_width() == strips[i_unit].end - strips[i_unit].begin &&
+                        grid.get_grid_height() == grid_height;
+                }
+                unit_buffers_fit &=
+                    get_border_range(buffers.left_border) == calc_border_range(i_unit, true) &&
+                    get_border_range(buffers.right_border) == calc_border_range(i_unit, false);
+            }
+            if (!unit_buffers_fit) {
+                unit_buffers.clear();
+                for (uindex_t i_unit = 0; i_unit < n_active_units; i_unit++) {
+                    uindex_t strip_width = strips[i_unit].end - strips[i_unit].begin;
+                    ComputeUnitBuffers buffers{
+                        .strip_grids = {GridImpl(strip_width, grid_height),
+                                        GridImpl(strip_width, grid_height)}};
+                    for (bool left : {true, false}) {
+                        std::optional<sycl::range<2>> range = calc_border_range(i_unit, left);
+                        if (range.has_value()) {
+                            (left ? buffers.left_border : buffers.right_border) =
+                                sycl::buffer<Cell, 2>(*range);
+                        }
+                    }
+                    unit_buffers.push_back(buffers);
+                }
+            }
+        }
+        record_host_phase("allocate", TimelineEvent(), allocation_start);
+
+        KernelFunction trans_func(params.transition_function);
+        typename KernelFunction::Cell halo_value = get_kernel_halo_value();
+        TDVGlobalState tdv_global_state(trans_func, params.iteration_offset, params.n_iterations);
+        UID tile_range = source_grid.get_tile_range();
+
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i_pass = 0; i_pass < n_passes; i_pass++) {
+            uindex_t i = params.iteration_offset + i_pass * iters_per_pass;
+            uindex_t iters_in_this_pass = std::min(iters_per_pass, target_n_iterations - i);
+            bool first_pass = i_pass == 0;
+            bool last_pass = i_pass == n_passes - 1;
+            bool reduction_pass = false;
+            if constexpr (has_reduction<F>) {
+                reduction_pass = reduction_result.has_value() && last_pass;
+            }
+            std::vector<sycl::event> pass_work_events;
+            double submission_start = timeline.now();
+
+            PassContext pass{.trans_func = trans_func,
+                             .tdv_global_state = tdv_global_state,
+                             .halo_value = halo_value,
+                             .i_iteration = i,
+                             .iters_in_pass = iters_in_this_pass,
+                             .target_n_iterations = target_n_iterations,
+                             .grid_width = grid_width,
+                             .grid_height = grid_height,
+                             .reduction_pass = reduction_pass};
+
+            auto submit_unit = [&]<uindex_t i_unit>() {
+                if (i_unit >= n_active_units) {
+                    return;
+                }
+                TileStrip strip = strips[i_unit];
+                // The tiles are read from and written to either the grid itself or the strip
+                // grids of the unit, whose first tile column is the one at `strip.begin`.
+                GridImpl &read_grid =
+                    first_pass ? source_grid : unit_buffers[i_unit].strip_grids[i_pass % 2];
+                GridImpl &write_grid =
+                    last_pass ? target_grid : unit_buffers[i_unit].strip_grids[(i_pass + 1) % 2];
+                uindex_t read_tile_offset = first_pass ? 0 : strip.begin / tile_width;
+                uindex_t write_tile_offset = last_pass ? 0 : strip.begin / tile_width;
+
+                for (uindex_t i_tile_c = strip.tile_begin; i_tile_c < strip.tile_end; i_tile_c++) {
+                    for (uindex_t i_tile_r = 0; i_tile_r < tile_range.r; i_tile_r++) {
+                        TimelineEvent tile_tags{.pass = i_pass,
+                                                .unit = i_unit,
+                                                .tile = UID(i_tile_c, i_tile_r),
+                                                .iteration_begin = i,
+                                                .iteration_end = i + iters_in_this_pass};
+                        pass_work_events.push_back(submit_tile<i_unit>(
+                            pass, read_grid, read_tile_offset, write_grid, write_tile_offset,
+                            i_tile_c, i_tile_r, tile_tags, std::nullopt));
+                    }
+                }
+            };
+            [&]<uindex_t... i_units>(std::integer_sequence<uindex_t, i_units...>) {
+                (submit_unit.template operator()<i_units>(), ...);
+            }(std::make_integer_sequence<uindex_t, n_compute_units>());
+
+            if (!last_pass) {
+                exchange_borders(strips, n_active_units, (i_pass + 1) % 2, i_pass);
+            }
+
+            if (params.profiling) {
+                work_events.push_back(pass_work_events);
+            }
+            record_host_phase("submit",
+                              TimelineEvent{.pass = i_pass,
+                                            .iteration_begin = i,
+                                            .iteration_end = i + iters_in_this_pass},
+                              submission_start);
+        }
+
+        return target_grid;
+    }
 
     /**
-     * \brief Return the accumulated total runtime of the execution kernel.
+     * \brief Copy the border columns of every compute unit into the strip grids of its neighbours.
      *
-     * This runtime is accumulated across multiple calls to \ref operator()(). However, this is only
-     * possible if \ref Params::profiling is set to true.
+     * Every unit receives the last `halo_radius` columns of its left neighbour and the first
+     * `halo_radius` columns of its right neighbour, or less if the right neighbour is narrower.
+     * The copies are staged in the border buffers of the receiving unit and submitted to its
+     * output queue, so that they follow its output kernels.
      */
-    double get_kernel_runtime() const {
-        double kernel_runtime = 0.0;
-        for (sycl::event work_event : work_events) {
-            const double timesteps_per_second = 1000000000.0;
-            double start =
-                double(work_event
-                           .get_profiling_info<cl::sycl::info::event_profiling::command_start>()) /
-                timesteps_per_second;
-            double end =
-                double(
-                    work_event.get_profiling_info<cl::sycl::info::event_profiling::command_end>()) /
-                timesteps_per_second;
-            kernel_runtime += end - start;
+    void exchange_borders(std::array<TileStrip, n_compute_units> const &strips,
+                          uindex_t n_active_units, uindex_t i_grid, uindex_t i_pass) {
+        auto copy_border = [&](uindex_t i_unit, uindex_t i_neighbour, uindex_t column_begin,
+                               sycl::buffer<Cell, 2> border) {
+            GridImpl &source = unit_buffers[i_neighbour].strip_grids[i_grid];
+            GridImpl &target = unit_buffers[i_unit].strip_grids[i_grid];
+            sycl::queue &queue = *output_kernel_queues[i_unit];
+            source.submit_copy_columns_to_buffer(queue, border,
+                                                 column_begin - strips[i_neighbour].begin);
+            record_kernel("exchange", TimelineEvent{.pass = i_pass, .unit = i_unit},
+                          target.submit_copy_columns_from_buffer(
+                              queue, border, column_begin - strips[i_unit].begin));
+        };
+
+        for (uindex_t i_unit = 0; i_unit < n_active_units; i_unit++) {
+            ComputeUnitBuffers &buffers = unit_buffers[i_unit];
+            if (buffers.left_border.has_value()) {
+                copy_border(i_unit, i_unit - 1,
+                            strips[i_unit].tile_begin * tile_width - halo_radius,
+                            *buffers.left_border);
+            }
+            if (buffers.right_border.has_value()) {
+                copy_border(i_unit, i_unit + 1, strips[i_unit].tile_end * tile_width,
+                            *buffers.right_border);
+            }
         }
-        return kernel_runtime;
     }
 
     /**
-     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     * \brief Return the halo value that is passed to the execution kernels.
      *
-     * For each call to \ref operator()(), the time it took to submit all kernels and, if \ref
-     * Params::blocking is true, to finish the computation is recorded and accumulated.
+     * With static values, the halo value of the cells is paired with the default static value.
      */
-    double get_walltime() const { return walltime; }
+    typename KernelFunction::Cell get_kernel_halo_value() const {
+        if constexpr (has_static_values<F>) {
+            return {params.halo_value, StaticValueOf<F>()};
+        } else {
+            return params.halo_value;
+        }
+    }
+
+    /**
+     * \brief Submit an input kernel of a compute unit that sends the given tile, or all tiles, of
+     * the grid.
+     *
+     * If the updater is instrumented, the kernel adds its counters to the read counters.
+     */
+    template <typename pipe>
+    sycl::event submit_grid_read(uindex_t i_unit, GridImpl &grid, std::optional<UID> tile) {
+        sycl::queue &queue = *input_kernel_queues[i_unit];
+        if constexpr (instrumented) {
+            if (tile.has_value()) {
+                return grid.template submit_read<pipe>(queue, tile->c, tile->r, params.halo_value,
+                                                       counters_buffers->read);
+            }
+            return grid.template submit_read_tiles<pipe>(queue, params.halo_value,
+                                                         counters_buffers->read);
+        } else {
+            if (tile.has_value()) {
+                return grid.template submit_read<pipe>(queue, tile->c, tile->r, params.halo_value);
+            }
+            return grid.template submit_read_tiles<pipe>(queue, params.halo_value);
+        }
+    }
+
+    /**
+     * \brief Submit an output kernel of a compute unit that receives the given tile, or all tiles,
+     * of the grid.
+     *
+     * If the updater is instrumented, the kernel adds its counters to the write counters.
+     */
+    template <typename pipe>
+    sycl::event submit_grid_write(uindex_t i_unit, GridImpl &grid, std::optional<UID> tile) {
+        sycl::queue &queue = *output_kernel_queues[i_unit];
+        if constexpr (instrumented) {
+            if (tile.has_value()) {
+                return grid.template submit_write<pipe>(queue, tile->c, tile->r,
+                                                        counters_buffers->write);
+            }
+            return grid.template submit_write_tiles<pipe>(queue, counters_buffers->write);
+        } else {
+            if (tile.has_value()) {
+                return grid.template submit_write<pipe>(queue, tile->c, tile->r);
+            }
+            return grid.template submit_write_tiles<pipe>(queue);
+        }
+    }
+
+    /**
+     * \brief Record a kernel with the given name and tags in the timeline, if profiling is enabled.
+     */
+    void record_kernel(char const *name, TimelineEvent tags, sycl::event event) {
+        if (params.profiling) {
+            tags.name = name;
+            timeline.record_kernel(tags, event);
+        }
+    }
+
+    /**
+     * \brief Record a host-side phase that started at the given time and ends now, if profiling
+     * is enabled.
+     */
+    void record_host_phase(char const *name, TimelineEvent tags, double start) {
+        if (params.profiling) {
+            tags.name = name;
+            timeline.record_host(tags, start);
+        }
+    }
+
+    /**
+     * \brief Find the tiles that can't change in the next pass.
+     *
+     * A tile can't change if neither it nor any of its neighbors has changed in the previous pass,
+     * since its halo is made up of the neighboring tiles. This method blocks until the flags of the
+     * previous pass are available.
+     */
+    std::vector<bool> find_inactive_tiles(sycl::buffer<bool, 1> changed_flags, UID tile_range) {
+        sycl::host_accessor changed_ac(changed_flags, sycl::read_only);
+        std::vector<bool> inactive(tile_range.c * tile_range.r, true);
+        for (index_t tile_c = 0; tile_c < index_t(tile_range.c); tile_c++) {
+            for (index_t tile_r = 0; tile_r < index_t(tile_range.r); tile_r++) {
+                for (index_t neighbor_c = std::max(tile_c - 1, index_t(0));
+                     neighbor_c <= std::min(tile_c + 1, index_t(tile_range.c) - 1); neighbor_c++) {
+                    for (index_t neighbor_r = std::max(tile_r - 1, index_t(0));
+                         neighbor_r <= std::min(tile_r + 1, index_t(tile_range.r) - 1);
+                         neighbor_r++) {
+                        if (changed_ac[neighbor_c * tile_range.r + neighbor_r]) {
+                            inactive[tile_c * tile_range.r + tile_r] = false;
+                        }
+                    }
+                }
+            }
+        }
+        return inactive;
+    }
+
+    /**
+     * \brief Create the queues of the updater if necessary.
+     *
+     * The queues are kept for the whole lifetime of the updater and are only rebuilt if \ref
+     * Params::device or \ref Params::profiling has changed since the last call. Every compute unit
+     * has queues of its own.
+     */
+    void prepare_queues() {
+        if (working_queues[0].has_value() && working_queues[0]->get_device() == params.device &&
+            queues_profiling == params.profiling) {
+            return;
+        }
+        queues_profiling = params.profiling;
+        for (uindex_t i_unit = 0; i_unit < n_compute_units; i_unit++) {
+            input_kernel_queues[i_unit] = make_queue();
+            output_kernel_queues[i_unit] = make_queue();
+            if constexpr (has_static_values<F>) {
+                // The static values are read by a separate kernel that runs concurrently to the
+                // cell input kernel, so it needs a queue of its own.
+                static_input_kernel_queues[i_unit] = make_queue();
+            }
+            if constexpr (has_reduction<F>) {
+                reduction_kernel_queues[i_unit] = make_queue();
+            }
+            working_queues[i_unit] = make_queue();
+        }
+    }
+
+    /**
+     * \brief Create a new in-order queue for the configured device.
+     *
+     * Profiling is only enabled for the queue if \ref Params::profiling is set, since it may add
+     * overhead to every command.
+     */
+    sycl::queue make_queue() const {
+        if (params.profiling) {
+            return sycl::queue(params.device, {sycl::property::queue::enable_profiling{},
+                                               sycl::property::queue::in_order{}});
+        }
+        return sycl::queue(params.device, {sycl::property::queue::in_order{}});
+    }
 
-  private:
     Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<StaticGridImpl> static_grid;
+    std::vector<ComputeUnitBuffers> unit_buffers;
+    std::array<std::optional<sycl::queue>, n_compute_units> input_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> static_input_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> output_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> reduction_kernel_queues;
+    std::array<std::optional<sycl::queue>, n_compute_units> working_queues;
+    bool queues_profiling;
+    std::optional<ReductionResult<Cell, ReductionOf<F>>> reduction_result;
     uindex_t n_processed_cells;
+    uindex_t n_skipped_tiles;
     double walltime;
-    std::vector<sycl::event> work_events;
+    std::vector<std::vector<sycl::event>> work_events;
+    Timeline timeline;
+    std::optional<StencilUpdateCountersBuffers> counters_buffers;
+    std::size_t last_call_first_work_event;
+    std::optional<double> last_call_model_runtime;
 };
 
 } // namespace tiling
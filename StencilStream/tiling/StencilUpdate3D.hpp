@@ -0,0 +1,563 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include "../Concepts.hpp"
+#include "../Grid3D.hpp"
+#include "../GridPool.hpp"
+#include "../Index.hpp"
+#include "../Stencil3D.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace stencil {
+namespace tiling {
+
+/**
+ * \brief A kernel that executes a three-dimensional stencil transition function on a tile of the
+ * grid's planes.
+ *
+ * The grid is partitioned along its rows and layers into tiles of `output_tile_height *
+ * output_tile_depth` cells per plane. Every tile reaches through all columns of the grid, and the
+ * kernel streams it plane by plane through a chain of processing elements, just like \ref
+ * monotile::StencilUpdate3DKernel streams the whole grid. This is the 2.5D equivalent of the
+ * two-dimensional \ref StencilUpdateKernel: The kernel also receives a halo of `stencil_radius *
+ * n_processing_elements` rows and layers around the tile, whose cells are computed with incomplete
+ * inputs. Only the updated cells of the tile itself are written. Along the columns, no halo is
+ * needed since the planes enter the pipeline in order.
+ *
+ * Every processing element holds the cube of its current stencil in registers. The new layer of
+ * the cube is assembled from the new input cell, a plane cache with the last `stencil_diameter -
+ * 1` planes of the tile and its halo, and a row cache with the last rows of every column of the
+ * cube. The plane cache of every processing element therefore contains `(stencil_diameter - 1) *
+ * (output_tile_height + 2 * halo_radius) * (output_tile_depth + 2 * halo_radius)` cells,
+ * independent of the grid size.
+ *
+ * The time-dependent values are computed inline by every processing element.
+ *
+ * \tparam TransFunc The transition function to apply.
+ *
+ * \tparam n_processing_elements The number of processing elements in the chain.
+ *
+ * \tparam output_tile_height The number of rows of a tile.
+ *
+ * \tparam output_tile_depth The number of layers of a tile.
+ */
+template <concepts::TransitionFunction3D TransFunc, uindex_t n_processing_elements,
+          uindex_t output_tile_height, uindex_t output_tile_depth>
+    requires(n_processing_elements % TransFunc::n_subiterations == 0)
+class StencilUpdate3DKernel {
+  private:
+    using Cell = typename TransFunc::Cell;
+    using TDV = typename TransFunc::TimeDependentValue;
+    using StencilImpl = Stencil3D<Cell, TransFunc::stencil_radius, TDV>;
+
+    static constexpr uindex_t stencil_radius = TransFunc::stencil_radius;
+    static constexpr uindex_t stencil_diameter = StencilImpl::diameter;
+
+  public:
+    /// \brief The number of rows and layers around a tile that the kernel receives in addition.
+    static constexpr uindex_t halo_radius = stencil_radius * n_processing_elements;
+
+    /// \brief The maximal number of rows of a tile together with its halo.
+    static constexpr uindex_t max_input_tile_height = output_tile_height + 2 * halo_radius;
+
+    /// \brief The maximal number of layers of a tile together with its halo.
+    static constexpr uindex_t max_input_tile_depth = output_tile_depth + 2 * halo_radius;
+
+    /// \brief The accessor type that is used to read the source grid.
+    using SourceAccessor = sycl::accessor<Cell, 3, sycl::access::mode::read>;
+
+    /// \brief The accessor type that is used to write the target grid.
+    using TargetAccessor = sycl::accessor<Cell, 3, sycl::access::mode::write>;
+
+    /**
+     * \brief The number of cycles between the input of a cell and the output of its updated
+     * value.
+     *
+     * The height and the depth are the ones of the tile together with its halo. Processing
+     * elements that have no iteration left to compute are bypassed, so only the
+     * `n_active_processing_elements` first ones contribute to the latency.
+     */
+    static constexpr uindex_t
+    calc_pipeline_latency(uindex_t input_tile_height, uindex_t input_tile_depth,
+                          uindex_t n_active_processing_elements = n_processing_elements) {
+        return n_active_processing_elements * stencil_radius *
+               (input_tile_height * input_tile_depth + input_tile_depth + 1);
+    }
+
+    /**
+     * \brief Create and configure the execution kernel.
+     *
+     * \param trans_func The instance of the transition function to use.
+     *
+     * \param source_ac The accessor to the input grid.
+     *
+     * \param target_ac The accessor to the output grid. Only the cells of the tile are written.
+     *
+     * \param i_iteration The iteration index of the input cells.
+     *
+     * \param target_i_iteration The final, requested iteration index after the updates. The
+     * kernel computes at most `n_processing_elements / n_subiterations` iterations.
+     *
+     * \param grid_range The width, height and depth of the grid.
+     *
+     * \param tile_r_offset The index of the first row of the tile. It must be a multiple of the
+     * tile height.
+     *
+     * \param tile_l_offset The index of the first layer of the tile. It must be a multiple of the
+     * tile depth.
+     *
+     * \param halo_value The value of cells outside the grid.
+     */
+    StencilUpdate3DKernel(TransFunc trans_func, SourceAccessor source_ac, TargetAccessor target_ac,
+                          uindex_t i_iteration, uindex_t target_i_iteration, UID3D grid_range,
+                          uindex_t tile_r_offset, uindex_t tile_l_offset, Cell halo_value)
+        : trans_func(trans_func), source_ac(source_ac), target_ac(target_ac),
+          i_iteration(i_iteration), target_i_iteration(target_i_iteration),
+          grid_range(grid_range), tile_r_offset(tile_r_offset), tile_l_offset(tile_l_offset),
+          halo_value(halo_value) {
+        assert(tile_r_offset % output_tile_height == 0 && tile_r_offset < grid_range.r);
+        assert(tile_l_offset % output_tile_depth == 0 && tile_l_offset < grid_range.l);
+    }
+
+    /**
+     * \brief Execute the kernel.
+     */
+    void operator()() const {
+        index_t grid_width = grid_range.c;
+        index_t grid_height = grid_range.r;
+        index_t grid_depth = grid_range.l;
+
+        // The received section of the grid, i.e. the tile and its halo. All row and layer indices
+        // of the pipeline are relative to it.
+        uindex_t section_height =
+            std::min(output_tile_height, grid_range.r - tile_r_offset) + 2 * halo_radius;
+        uindex_t section_depth =
+            std::min(output_tile_depth, grid_range.l - tile_l_offset) + 2 * halo_radius;
+        index_t section_r_offset = index_t(tile_r_offset) - index_t(halo_radius);
+        index_t section_l_offset = index_t(tile_l_offset) - index_t(halo_radius);
+
+        // The position of the central cell of every processing element. Every processing element
+        // lags behind its predecessor by the stencil radius in every dimension.
+        [[intel::fpga_register]] index_t c[n_processing_elements];
+        [[intel::fpga_register]] index_t r[n_processing_elements];
+        [[intel::fpga_register]] index_t l[n_processing_elements];
+        // Selects the half of the double-buffered row cache, flipped with every row.
+        [[intel::fpga_register]] bool row_parity[n_processing_elements];
+
+        index_t prev_c = 0;
+        index_t prev_r = 0;
+        index_t prev_l = 0;
+#pragma unroll
+        for (uindex_t i = 0; i < n_processing_elements; i++) {
+            c[i] = prev_c - index_t(stencil_radius);
+            r[i] = prev_r - index_t(stencil_radius);
+            l[i] = prev_l - index_t(stencil_radius);
+            if (l[i] < 0) {
+                l[i] += section_depth;
+                r[i] -= 1;
+            }
+            if (r[i] < 0) {
+                r[i] += section_height;
+                c[i] -= 1;
+            }
+            row_parity[i] = false;
+            prev_c = c[i];
+            prev_r = r[i];
+            prev_l = l[i];
+        }
+
+        [[intel::fpga_memory]] Cell
+            plane_cache[2][max_input_tile_height][max_input_tile_depth][n_processing_elements]
+                       [stencil_diameter - 1];
+        [[intel::fpga_memory]] Cell row_cache[2][max_input_tile_depth][n_processing_elements]
+                                             [stencil_diameter][stencil_diameter - 1];
+        [[intel::fpga_register]] Cell stencil_buffer[n_processing_elements][stencil_diameter]
+                                                    [stencil_diameter][stencil_diameter];
+
+        uindex_t n_cells = grid_range.c * section_height * section_depth;
+        uindex_t n_active_processing_elements =
+            std::min(n_processing_elements,
+                     (target_i_iteration - i_iteration) * TransFunc::n_subiterations);
+        uindex_t pipeline_latency =
+            calc_pipeline_latency(section_height, section_depth, n_active_processing_elements);
+        UID3D input(0, 0, 0);
+        UID3D output(0, 0, 0);
+        auto advance = [&](UID3D &id) {
+            id.l++;
+            if (id.l == section_depth) {
+                id.l = 0;
+                id.r++;
+                if (id.r == section_height) {
+                    id.r = 0;
+                    id.c++;
+                }
+            }
+        };
+
+        for (uindex_t i = 0; i < n_cells + pipeline_latency; i++) {
+            Cell carry = halo_value;
+            if (i < n_cells) {
+                index_t input_r = section_r_offset + index_t(input.r);
+                index_t input_l = section_l_offset + index_t(input.l);
+                if (input_r >= 0 && input_r < grid_height && input_l >= 0 &&
+                    input_l < grid_depth) {
+                    carry = source_ac[sycl::id<3>(input.c, input_r, input_l)];
+                }
+                advance(input);
+            }
+
+#pragma unroll
+            for (uindex_t i_pe = 0; i_pe < n_processing_elements; i_pe++) {
+#pragma unroll
+                for (uindex_t cell_c = 0; cell_c < stencil_diameter; cell_c++) {
+#pragma unroll
+                    for (uindex_t cell_r = 0; cell_r < stencil_diameter; cell_r++) {
+#pragma unroll
+                        for (uindex_t cell_l = 0; cell_l < stencil_diameter - 1; cell_l++) {
+                            stencil_buffer[i_pe][cell_c][cell_r][cell_l] =
+                                stencil_buffer[i_pe][cell_c][cell_r][cell_l + 1];
+                        }
+                    }
+                }
+
+                // Assemble the new layer of the stencil buffer from the input cell and the caches,
+                // like the monotile kernel does.
+                uindex_t plane_parity = c[i_pe] & 1;
+#pragma unroll
+                for (uindex_t cache_c = 0; cache_c < stencil_diameter; cache_c++) {
+                    Cell plane_value;
+                    if (cache_c == stencil_diameter - 1) {
+                        plane_value = carry;
+                    } else {
+                        plane_value = plane_cache[plane_parity][r[i_pe]][l[i_pe]][i_pe][cache_c];
+                    }
+                    if (cache_c > 0) {
+                        plane_cache[1 - plane_parity][r[i_pe]][l[i_pe]][i_pe][cache_c - 1] =
+                            plane_value;
+                    }
+
+#pragma unroll
+                    for (uindex_t cache_r = 0; cache_r < stencil_diameter; cache_r++) {
+                        Cell row_value;
+                        if (cache_r == stencil_diameter - 1) {
+                            row_value = plane_value;
+                        } else {
+                            row_value =
+                                row_cache[row_parity[i_pe]][l[i_pe]][i_pe][cache_c][cache_r];
+                        }
+                        if (cache_r > 0) {
+                            row_cache[!row_parity[i_pe]][l[i_pe]][i_pe][cache_c][cache_r - 1] =
+                                row_value;
+                        }
+                        stencil_buffer[i_pe][cache_c][cache_r][stencil_diameter - 1] = row_value;
+                    }
+                }
+
+                uindex_t pe_iteration = i_iteration + i_pe / TransFunc::n_subiterations;
+                uindex_t pe_subiteration = i_pe % TransFunc::n_subiterations;
+                if (pe_iteration < target_i_iteration) {
+                    // The cells at the borders of the section are computed from the wrapped-around
+                    // contents of the caches, but they only influence the halo of the tile.
+                    index_t center_r = section_r_offset + r[i_pe];
+                    index_t center_l = section_l_offset + l[i_pe];
+                    TDV tdv = trans_func.get_time_dependent_value(pe_iteration);
+                    StencilImpl stencil(ID3D(c[i_pe], center_r, center_l), grid_range,
+                                        pe_iteration, pe_subiteration, tdv);
+#pragma unroll
+                    for (uindex_t cell_c = 0; cell_c < stencil_diameter; cell_c++) {
+                        index_t grid_c = c[i_pe] + index_t(cell_c) - index_t(stencil_radius);
+#pragma unroll
+                        for (uindex_t cell_r = 0; cell_r < stencil_diameter; cell_r++) {
+                            index_t grid_r = center_r + index_t(cell_r) - index_t(stencil_radius);
+#pragma unroll
+                            for (uindex_t cell_l = 0; cell_l < stencil_diameter; cell_l++) {
+                                index_t grid_l =
+                                    center_l + index_t(cell_l) - index_t(stencil_radius);
+                                bool within_grid = grid_c >= 0 && grid_c < grid_width &&
+                                                   grid_r >= 0 && grid_r < grid_height &&
+                                                   grid_l >= 0 && grid_l < grid_depth;
+                                stencil[UID3D(cell_c, cell_r, cell_l)] =
+                                    within_grid ? stencil_buffer[i_pe][cell_c][cell_r][cell_l]
+                                                : halo_value;
+                            }
+                        }
+                    }
+                    carry = trans_func(stencil);
+                }
+                // Idle processing elements pass the carry on without delaying it.
+
+                l[i_pe] += 1;
+                if (l[i_pe] == index_t(section_depth)) {
+                    l[i_pe] = 0;
+                    row_parity[i_pe] = !row_parity[i_pe];
+                    r[i_pe] += 1;
+                    if (r[i_pe] == index_t(section_height)) {
+                        r[i_pe] = 0;
+                        c[i_pe] += 1;
+                    }
+                }
+            }
+
+            if (i >= pipeline_latency) {
+                bool in_tile = output.r >= halo_radius && output.r < section_height - halo_radius &&
+                               output.l >= halo_radius && output.l < section_depth - halo_radius;
+                if (in_tile) {
+                    target_ac[sycl::id<3>(output.c, section_r_offset + index_t(output.r),
+                                          section_l_offset + index_t(output.l))] = carry;
+                }
+                advance(output);
+            }
+        }
+    }
+
+  private:
+    TransFunc trans_func;
+    SourceAccessor source_ac;
+    TargetAccessor target_ac;
+    uindex_t i_iteration;
+    uindex_t target_i_iteration;
+    UID3D grid_range;
+    uindex_t tile_r_offset;
+    uindex_t tile_l_offset;
+    Cell halo_value;
+};
+
+/**
+ * \brief A grid updater that applies an iterative, three-dimensional stencil code to grids of
+ * arbitrary size.
+ *
+ * This is the three-dimensional sibling of \ref StencilUpdate. It partitions the rows and layers
+ * of the grid into tiles and submits one \ref StencilUpdate3DKernel per tile and pass, which
+ * streams the tile through all columns of the grid. In contrast to \ref
+ * monotile::StencilUpdate3D, the on-chip memory therefore only depends on the tile size, and grids
+ * of any height and depth are supported. In exchange, every pass reads a halo of `stencil_radius *
+ * n_processing_elements` rows and layers around every tile and computes it redundantly.
+ *
+ * The execution kernel reads and writes the grids in global memory directly.
+ *
+ * \tparam F The transition function to apply to input grids.
+ *
+ * \tparam n_processing_elements (Optimization parameter) The number of processing elements (PEs)
+ * to implement. It must be a multiple of the number of sub-iterations of the transition function.
+ *
+ * \tparam tile_height (Optimization parameter) The number of rows of a tile. The on-chip memory
+ * usage of every PE grows linearly with the tile height plus the halo.
+ *
+ * \tparam tile_depth (Optimization parameter) The number of layers of a tile. The on-chip memory
+ * usage of every PE grows linearly with the tile depth plus the halo.
+ */
+template <concepts::TransitionFunction3D F, uindex_t n_processing_elements = 1,
+          uindex_t tile_height = 64, uindex_t tile_depth = 64>
+    requires(n_processing_elements % F::n_subiterations == 0) && (tile_height >= 1) &&
+            (tile_depth >= 1)
+class StencilUpdate3D {
+  private:
+    using Cell = F::Cell;
+    using ExecutionKernelImpl =
+        StencilUpdate3DKernel<F, n_processing_elements, tile_height, tile_depth>;
+
+    static constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+
+  public:
+    /// \brief Shorthand for the used and supported grid type.
+    using GridImpl = Grid3D<Cell>;
+
+    /**
+     * \brief Parameters for the stencil updater.
+     */
+    struct Params {
+        /**
+         * \brief An instance of the transition function type.
+         *
+         * User applications may store runtime parameters here.
+         */
+        F transition_function;
+
+        /**
+         *  \brief The cell value to present for cells outside of the grid.
+         */
+        Cell halo_value = Cell();
+
+        /**
+         * \brief The iteration index offset.
+         *
+         * This offset will be added to the "actual" iteration index. This way, simulations can
+         * "resume" with the next timestep if the intermediate grid has been evaluated by the host.
+         */
+        uindex_t iteration_offset = 0;
+
+        /**
+         * \brief The number of iterations to compute.
+         */
+        uindex_t n_iterations = 1;
+
+        /**
+         * \brief The device to use for computations.
+         */
+        sycl::device device = sycl::device();
+
+        /**
+         * \brief Should the stencil updater block until completion, or return immediately after all
+         * kernels have been submitted.
+         */
+        bool blocking = false;
+    };
+
+    /**
+     * \brief Create a new stencil updater object.
+     */
+    StencilUpdate3D(Params params)
+        : params(params), grid_pool(std::make_shared<GridPool<GridImpl>>()),
+          kernel_queue(std::nullopt), n_processed_cells(0), walltime(0.0) {}
+
+    /**
+     * \brief Compute a new grid based on the source grid, using the configured transition function.
+     *
+     * The computation does not work in-place. Instead, two additional grids with the same size as
+     * the source grid are requested from the grid pool and used for a double buffering scheme, so
+     * the source grid isn't altered. Without any iterations, a copy of the source grid is
+     * returned.
+     *
+     * If \ref Params::blocking is set to true, this method will block until the computation is
+     * complete. Otherwise, it will return as soon as all kernels are submitted.
+     */
+    GridImpl operator()(GridImpl &source_grid) {
+        sycl::queue queue = get_queue();
+        auto walltime_start = std::chrono::high_resolution_clock::now();
+
+        GridImpl swap_grid_a = grid_pool->acquire(source_grid);
+        GridImpl swap_grid_b = grid_pool->acquire(source_grid);
+        GridImpl *pass_source = &source_grid;
+        GridImpl *pass_target = &swap_grid_b;
+        if (params.n_iterations == 0) {
+            swap_grid_b.submit_copy_from(queue, source_grid);
+            pass_source = &swap_grid_b;
+        }
+
+        UID3D grid_range(source_grid.get_grid_width(), source_grid.get_grid_height(),
+                         source_grid.get_grid_depth());
+        uindex_t target_n_iterations = params.iteration_offset + params.n_iterations;
+        for (uindex_t i = params.iteration_offset; i < target_n_iterations; i += iters_per_pass) {
+            for (uindex_t tile_r_offset = 0; tile_r_offset < grid_range.r;
+                 tile_r_offset += tile_height) {
+                for (uindex_t tile_l_offset = 0; tile_l_offset < grid_range.l;
+                     tile_l_offset += tile_depth) {
+                    submit_tile(queue, *pass_source, *pass_target, i, target_n_iterations,
+                                grid_range, tile_r_offset, tile_l_offset);
+                }
+            }
+
+            if (i == params.iteration_offset) {
+                pass_source = &swap_grid_b;
+                pass_target = &swap_grid_a;
+            } else {
+                std::swap(pass_source, pass_target);
+            }
+        }
+
+        if (params.blocking) {
+            queue.wait();
+        }
+
+        auto walltime_end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> walltime = walltime_end - walltime_start;
+        this->walltime += walltime.count();
+        n_processed_cells += params.n_iterations * grid_range.c * grid_range.r * grid_range.l;
+
+        return *pass_source;
+    }
+
+    /**
+     * \brief Return a reference to the parameters.
+     *
+     * Modifications to the parameters struct will be used in the next call to \ref operator()().
+     */
+    Params &get_params() { return params; }
+
+    /**
+     * \brief Return the pool from which the updater requests its swap grids.
+     */
+    std::shared_ptr<GridPool<GridImpl>> get_grid_pool() const { return grid_pool; }
+
+    /**
+     * \brief Replace the grid pool of the updater.
+     *
+     * This may be used to share one pool between multiple updaters with the same grid type.
+     */
+    void set_grid_pool(std::shared_ptr<GridPool<GridImpl>> grid_pool) {
+        this->grid_pool = grid_pool;
+    }
+
+    /**
+     * \brief Return the accumulated total number of cells processed by this updater.
+     *
+     * For each call of to \ref operator()(), this is the number of cells in the grid times the
+     * number of computed iterations. The redundantly computed halos of the tiles are not counted.
+     */
+    uindex_t get_n_processed_cells() const { return n_processed_cells; }
+
+    /**
+     * \brief Return the accumulated runtime of the updater, measured from the host side.
+     */
+    double get_walltime() const { return walltime; }
+
+  private:
+    /**
+     * \brief Return the queue of the updater.
+     *
+     * The queue is kept for the whole lifetime of the updater and is only rebuilt if \ref
+     * Params::device has changed since the last call.
+     */
+    sycl::queue get_queue() {
+        if (!kernel_queue.has_value() || kernel_queue->get_device() != params.device) {
+            kernel_queue = sycl::queue(params.device);
+        }
+        return *kernel_queue;
+    }
+
+    /**
+     * \brief Submit the kernel that computes one pass over the tile with the given offsets.
+     */
+    void submit_tile(sycl::queue queue, GridImpl &pass_source, GridImpl &pass_target,
+                     uindex_t i_iteration, uindex_t target_n_iterations, UID3D grid_range,
+                     uindex_t tile_r_offset, uindex_t tile_l_offset) {
+        queue.submit([&](sycl::handler &cgh) {
+            typename ExecutionKernelImpl::SourceAccessor source_ac(pass_source.get_buffer(), cgh);
+            typename ExecutionKernelImpl::TargetAccessor target_ac(pass_target.get_buffer(), cgh);
+            ExecutionKernelImpl exec_kernel(params.transition_function, source_ac, target_ac,
+                                            i_iteration, target_n_iterations, grid_range,
+                                            tile_r_offset, tile_l_offset, params.halo_value);
+            cgh.single_task<ExecutionKernelImpl>(exec_kernel);
+        });
+    }
+
+    Params params;
+    std::shared_ptr<GridPool<GridImpl>> grid_pool;
+    std::optional<sycl::queue> kernel_queue;
+    uindex_t n_processed_cells;
+    double walltime;
+};
+
+} // namespace tiling
+} // namespace stencil
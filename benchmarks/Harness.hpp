@@ -0,0 +1,227 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include <StencilStream/Concepts.hpp>
+#include <StencilStream/Helpers.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <sycl/sycl.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace bench {
+
+using namespace stencil;
+
+/**
+ * \brief The points of the sweep that the harness runs for every kernel.
+ */
+struct Sweep {
+    /// \brief The widths and heights of the grids.
+    std::vector<UID> grid_ranges;
+
+    /// \brief The numbers of iterations that are computed per measured call.
+    std::vector<uindex_t> n_iterations;
+
+    /// \brief The number of unmeasured calls before the measurements.
+    uindex_t n_warmup = 1;
+
+    /// \brief The number of measured calls per point of the sweep.
+    uindex_t n_repetitions = 5;
+};
+
+/**
+ * \brief Summary statistics of a series of measurements.
+ */
+struct Statistics {
+    double mean, stddev, min, median, max;
+
+    /**
+     * \brief Compute the statistics of the given, non-empty series of samples.
+     */
+    static Statistics of(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        uindex_t n = samples.size();
+
+        double mean = 0.0;
+        for (double sample : samples) {
+            mean += sample / n;
+        }
+        double variance = 0.0;
+        for (double sample : samples) {
+            variance += (sample - mean) * (sample - mean) / n;
+        }
+        double median =
+            n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+
+        return Statistics{.mean = mean,
+                          .stddev = std::sqrt(variance),
+                          .min = samples.front(),
+                          .median = median,
+                          .max = samples.back()};
+    }
+};
+
+/**
+ * \brief The result of one point of the sweep.
+ *
+ * The throughput metrics are computed from the median walltime. The effective bandwidth counts
+ * every cell and static value that has to be read and every cell that has to be written once per
+ * pass, so it excludes halos and redundant loads and is comparable across backends.
+ */
+struct Result {
+    std::string backend;
+    std::string kernel;
+    uindex_t grid_width, grid_height, n_iterations, n_warmup, n_repetitions;
+    Statistics walltime;
+    double gcells_per_second, gflops, bandwidth;
+};
+
+/**
+ * \brief Run one point of the sweep with the given stencil updater.
+ *
+ * \tparam F The transition function to benchmark. It has to provide the members described in
+ * Kernels.hpp.
+ *
+ * \tparam Updater The stencil updater template of the backend, instantiated with the transition
+ * function.
+ *
+ * \param backend The name of the backend in the result.
+ * \param device The device to run the updater on.
+ * \param iters_per_pass The number of iterations the updater computes per pass over the grid.
+ * \param grid_range The width and height of the grid.
+ * \param n_iterations The number of iterations per measured call.
+ * \param sweep The warm-up and repetition counts.
+ */
+template <typename F, template <typename> typename Updater>
+Result run_benchmark(std::string backend, sycl::device device, uindex_t iters_per_pass,
+                     UID grid_range, uindex_t n_iterations, Sweep const &sweep) {
+    using Grid = typename Updater<F>::GridImpl;
+    using Cell = typename F::Cell;
+
+    typename Updater<F>::Params params;
+    params.transition_function = F();
+    params.halo_value = F::halo();
+    params.n_iterations = n_iterations;
+    params.device = device;
+    params.blocking = true; // Every call has to finish before the timer stops.
+    Updater<F> update(params);
+
+    Grid grid(grid_range.c, grid_range.r);
+    {
+        typename Grid::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < grid_range.c; c++) {
+            for (uindex_t r = 0; r < grid_range.r; r++) {
+                ac[c][r] = F::initial_cell(c, r);
+            }
+        }
+    }
+
+    uint64_t n_bytes_per_pass = 2 * sizeof(Cell);
+    if constexpr (has_static_values<F>) {
+        using StaticGrid = typename Updater<F>::StaticGridImpl;
+        StaticGrid static_grid(grid_range.c, grid_range.r);
+        {
+            typename StaticGrid::template GridAccessor<sycl::access::mode::read_write> ac(
+                static_grid);
+            for (uindex_t c = 0; c < grid_range.c; c++) {
+                for (uindex_t r = 0; r < grid_range.r; r++) {
+                    ac[c][r] = F::initial_static_value(c, r);
+                }
+            }
+        }
+        update.set_static_grid(static_grid);
+        n_bytes_per_pass += sizeof(StaticValueOf<F>);
+    }
+
+    for (uindex_t i = 0; i < sweep.n_warmup; i++) {
+        update(grid);
+    }
+
+    std::vector<double> walltimes;
+    for (uindex_t i = 0; i < sweep.n_repetitions; i++) {
+        auto start = std::chrono::steady_clock::now();
+        update(grid);
+        auto end = std::chrono::steady_clock::now();
+        walltimes.push_back(std::chrono::duration<double>(end - start).count());
+    }
+    Statistics walltime = Statistics::of(walltimes);
+
+    uint64_t n_cells = uint64_t(grid_range.c) * uint64_t(grid_range.r);
+    uint64_t n_cell_updates = n_cells * n_iterations;
+    uint64_t n_passes = n_cells_to_n_words(n_iterations, iters_per_pass);
+    return Result{.backend = backend,
+                  .kernel = F::name,
+                  .grid_width = grid_range.c,
+                  .grid_height = grid_range.r,
+                  .n_iterations = n_iterations,
+                  .n_warmup = sweep.n_warmup,
+                  .n_repetitions = sweep.n_repetitions,
+                  .walltime = walltime,
+                  .gcells_per_second = n_cell_updates / walltime.median / 1e9,
+                  .gflops = n_cell_updates * F::n_flops / walltime.median / 1e9,
+                  .bandwidth = n_cells * n_passes * n_bytes_per_pass / walltime.median / 1e9};
+}
+
+/**
+ * \brief Write the results as CSV, with one header line and one line per result.
+ */
+inline void write_csv(std::ostream &out, std::vector<Result> const &results) {
+    out << "backend,kernel,grid_width,grid_height,n_iterations,n_warmup,n_repetitions,"
+           "walltime_mean,walltime_stddev,walltime_min,walltime_median,walltime_max,"
+           "gcells_per_second,gflops,bandwidth_gb_per_second\n";
+    for (Result const &result : results) {
+        out << result.backend << "," << result.kernel << "," << result.grid_width << ","
+            << result.grid_height << "," << result.n_iterations << "," << result.n_warmup << ","
+            << result.n_repetitions << "," << result.walltime.mean << ","
+            << result.walltime.stddev << "," << result.walltime.min << ","
+            << result.walltime.median << "," << result.walltime.max << ","
+            << result.gcells_per_second << "," << result.gflops << "," << result.bandwidth
+            << "\n";
+    }
+}
+
+/**
+ * \brief Write the results as a JSON array of objects.
+ */
+inline void write_json(std::ostream &out, std::vector<Result> const &results) {
+    out << "[";
+    for (uindex_t i = 0; i < results.size(); i++) {
+        Result const &result = results[i];
+        Statistics const &walltime = result.walltime;
+        out << (i == 0 ? "\n" : ",\n") << "  {\"backend\":\"" << result.backend
+            << "\",\"kernel\":\"" << result.kernel << "\",\"grid_width\":" << result.grid_width
+            << ",\"grid_height\":" << result.grid_height
+            << ",\"n_iterations\":" << result.n_iterations << ",\"n_warmup\":" << result.n_warmup
+            << ",\"n_repetitions\":" << result.n_repetitions << ",\"walltime\":{\"mean\":"
+            << walltime.mean << ",\"stddev\":" << walltime.stddev << ",\"min\":" << walltime.min
+            << ",\"median\":" << walltime.median << ",\"max\":" << walltime.max
+            << "},\"gcells_per_second\":" << result.gcells_per_second
+            << ",\"gflops\":" << result.gflops
+            << ",\"bandwidth_gb_per_second\":" << result.bandwidth << "}";
+    }
+    out << "\n]\n";
+}
+
+} // namespace bench
@@ -0,0 +1,229 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+#include <StencilStream/BaseTransitionFunction.hpp>
+#include <cstdint>
+
+/**
+ * \file
+ * \brief The transition functions that are benchmarked by `stencilstream_bench`.
+ *
+ * The kernels are compact versions of the example applications and a family of synthetic
+ * stencils with a variable radius. They don't model the full applications, but have the same
+ * cell types, stencil shapes and arithmetic intensities. Every kernel provides the following
+ * additional members:
+ *
+ * ```
+ * static constexpr char const *name;            // The name of the kernel in reports.
+ * static constexpr uint64_t n_flops;            // The floating-point operations per cell update.
+ * static Cell initial_cell(uindex_t c, uindex_t r);
+ * static Cell halo();
+ * ```
+ *
+ * Kernels with static values additionally provide `static StaticValue initial_static_value(uindex_t
+ * c, uindex_t r)`.
+ */
+
+namespace bench {
+
+using namespace stencil;
+
+/**
+ * \brief A deterministic pseudo-random value in [0, 1) for the cell at the given position.
+ *
+ * This is used to fill the grids reproducibly without a random number generator.
+ */
+inline float cell_noise(uindex_t c, uindex_t r) {
+    uint32_t x = uint32_t(c) * 0x9E3779B1u ^ uint32_t(r) * 0x85EBCA77u;
+    x ^= x >> 15;
+    x *= 0x2C1B3C6Du;
+    x ^= x >> 12;
+    return float(x & 0xFFFFFF) / float(1 << 24);
+}
+
+/**
+ * \brief The HotSpot kernel from examples/hotspot, with the dissipated power as static value.
+ */
+struct HotspotKernel : public BaseTransitionFunction {
+    using Cell = float;
+    using StaticValue = float;
+
+    static constexpr char const *name = "hotspot";
+    static constexpr uint64_t n_flops = 15;
+    static constexpr StencilShape stencil_shape = StencilShape::star(1);
+
+    static constexpr float amb_temp = 80.0;
+    float Rx_1 = 0.1, Ry_1 = 0.1, Rz_1 = 0.05, Cap_1 = 0.5;
+
+    static Cell initial_cell(uindex_t c, uindex_t r) { return 300.0 + cell_noise(c, r); }
+
+    static StaticValue initial_static_value(uindex_t c, uindex_t r) {
+        return cell_noise(r, c) * 1e-3;
+    }
+
+    static Cell halo() { return 0.0; }
+
+    Cell operator()(Stencil<Cell, 1, std::monostate, StaticValue> const &temp) const {
+        ID idx = temp.id;
+        float old = temp[ID(0, 0)];
+        float left = idx.c == 0 ? old : temp[ID(-1, 0)];
+        float right = idx.c == index_t(temp.grid_range.c) - 1 ? old : temp[ID(1, 0)];
+        float top = idx.r == 0 ? old : temp[ID(0, -1)];
+        float bottom = idx.r == index_t(temp.grid_range.r) - 1 ? old : temp[ID(0, 1)];
+
+        return old + Cap_1 * (temp.static_value + (bottom + top - 2.f * old) * Ry_1 +
+                              (right + left - 2.f * old) * Rx_1 + (amb_temp - old) * Rz_1);
+    }
+};
+
+/**
+ * \brief A two-dimensional FDTD kernel in the style of examples/fdtd.
+ *
+ * The first sub-iteration updates the magnetic field and the second one updates the electric
+ * field. The grid is surrounded by a perfect electric conductor and the material is vacuum, so the
+ * kernel has no time-dependent source and no material lookup.
+ */
+struct FDTDKernel : public BaseTransitionFunction {
+    struct Cell {
+        float ex, ey, hz;
+    };
+
+    static constexpr char const *name = "fdtd";
+    static constexpr uint64_t n_flops = 11;
+    static constexpr uindex_t n_subiterations = 2;
+    static constexpr StencilShape stencil_shape = StencilShape::star(1);
+
+    float ce = 0.5, ch = 0.5;
+
+    static Cell initial_cell(uindex_t c, uindex_t r) {
+        return Cell{.ex = 0.0, .ey = 0.0, .hz = cell_noise(c, r)};
+    }
+
+    static Cell halo() { return Cell{.ex = 0.0, .ey = 0.0, .hz = 0.0}; }
+
+    Cell operator()(Stencil<Cell, 1> const &stencil) const {
+        Cell cell = stencil[ID(0, 0)];
+        if (stencil.subiteration == 0) {
+            cell.hz += ch * ((stencil[ID(0, 1)].ex - cell.ex) - (stencil[ID(1, 0)].ey - cell.ey));
+        } else {
+            cell.ex += ce * (cell.hz - stencil[ID(0, -1)].hz);
+            cell.ey -= ce * (cell.hz - stencil[ID(-1, 0)].hz);
+        }
+        return cell;
+    }
+};
+
+/**
+ * \brief Conway's Game of Life, as in examples/conway.
+ */
+struct ConwayKernel : public BaseTransitionFunction {
+    using Cell = bool;
+
+    static constexpr char const *name = "conway";
+    static constexpr uint64_t n_flops = 0;
+
+    static Cell initial_cell(uindex_t c, uindex_t r) { return cell_noise(c, r) < 0.3; }
+
+    static Cell halo() { return false; }
+
+    Cell operator()(Stencil<Cell, 1> const &stencil) const {
+        uint8_t alive_neighbours = 0;
+#pragma unroll
+        for (index_t c = -1; c <= 1; c++) {
+#pragma unroll
+            for (index_t r = -1; r <= 1; r++) {
+                if (stencil[ID(c, r)] && !(c == 0 && r == 0)) {
+                    alive_neighbours += 1;
+                }
+            }
+        }
+        return alive_neighbours == 3 || (stencil[ID(0, 0)] && alive_neighbours == 2);
+    }
+};
+
+/**
+ * \brief The temperature update of examples/convection, reduced to an advection-diffusion step.
+ *
+ * The velocity field is constant and the advection uses upwind differences, so that the kernel
+ * has the same five-point access pattern and a similar number of operations per cell as the
+ * temperature update of the convection app.
+ */
+struct ConvectionKernel : public BaseTransitionFunction {
+    using Cell = float;
+
+    static constexpr char const *name = "convection";
+    static constexpr uint64_t n_flops = 14;
+    static constexpr StencilShape stencil_shape = StencilShape::star(1);
+
+    float dt = 0.1, kappa = 0.2, vx = 0.3, vy = -0.2;
+
+    static Cell initial_cell(uindex_t c, uindex_t r) { return cell_noise(c, r); }
+
+    static Cell halo() { return 0.0; }
+
+    Cell operator()(Stencil<Cell, 1> const &stencil) const {
+        float t = stencil[ID(0, 0)];
+        float west = stencil[ID(-1, 0)];
+        float east = stencil[ID(1, 0)];
+        float north = stencil[ID(0, -1)];
+        float south = stencil[ID(0, 1)];
+
+        float laplace = west + east + north + south - 4.f * t;
+        float dt_dx = vx > 0.f ? t - west : east - t;
+        float dt_dy = vy > 0.f ? t - north : south - t;
+        return t + dt * (kappa * laplace - vx * dt_dx - vy * dt_dy);
+    }
+};
+
+/**
+ * \brief A synthetic box filter that averages all cells within the given radius.
+ *
+ * Its arithmetic intensity and the size of the stencil buffer grow with the radius, which makes
+ * it useful to find the point where a backend becomes compute-bound.
+ *
+ * \tparam radius The radius of the stencil.
+ */
+template <uindex_t radius> struct BoxKernel : public BaseTransitionFunction {
+    using Cell = float;
+
+    static constexpr uindex_t stencil_radius = radius;
+    static constexpr uindex_t diameter = 2 * radius + 1;
+    static_assert(radius < 10, "The name of the kernel only has room for one digit");
+    static constexpr char name[] = {'b', 'o', 'x', char('0' + radius), '\0'};
+    static constexpr uint64_t n_flops = diameter * diameter + 1;
+
+    static Cell initial_cell(uindex_t c, uindex_t r) { return cell_noise(c, r); }
+
+    static Cell halo() { return 0.0; }
+
+    Cell operator()(Stencil<Cell, radius> const &stencil) const {
+        float sum = 0.0;
+#pragma unroll
+        for (index_t c = -index_t(radius); c <= index_t(radius); c++) {
+#pragma unroll
+            for (index_t r = -index_t(radius); r <= index_t(radius); r++) {
+                sum += stencil[ID(c, r)];
+            }
+        }
+        return sum * (1.f / float(diameter * diameter));
+    }
+};
+
+} // namespace bench
@@ -0,0 +1,247 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Harness.hpp"
+#include "Kernels.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <sycl/ext/intel/fpga_extensions.hpp>
+
+#if defined(STENCILSTREAM_BACKEND_MONOTILE)
+    #include <StencilStream/monotile/StencilUpdate.hpp>
+#elif defined(STENCILSTREAM_BACKEND_TILING)
+    #include <StencilStream/tiling/StencilUpdate.hpp>
+#elif defined(STENCILSTREAM_BACKEND_CPU)
+    #include <StencilStream/cpu/StencilUpdate.hpp>
+#elif defined(STENCILSTREAM_BACKEND_GPU)
+    #include <StencilStream/gpu/StencilUpdate.hpp>
+#endif
+
+using namespace stencil;
+using namespace bench;
+
+#if defined(STENCILSTREAM_BACKEND_MONOTILE)
+const char *backend = "monotile";
+const uindex_t n_processing_elements = 16;
+const uindex_t max_grid_width = 1024;
+const uindex_t max_grid_height = 1024;
+template <typename F>
+using Updater =
+    monotile::StencilUpdate<F, n_processing_elements, max_grid_width, max_grid_height>;
+template <typename F>
+constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+
+#elif defined(STENCILSTREAM_BACKEND_TILING)
+const char *backend = "tiling";
+const uindex_t n_processing_elements = 16;
+const uindex_t max_grid_width = std::numeric_limits<uindex_t>::max();
+const uindex_t max_grid_height = std::numeric_limits<uindex_t>::max();
+template <typename F> using Updater = tiling::StencilUpdate<F, n_processing_elements>;
+template <typename F>
+constexpr uindex_t iters_per_pass = n_processing_elements / F::n_subiterations;
+
+#elif defined(STENCILSTREAM_BACKEND_CPU)
+const char *backend = "cpu";
+const uindex_t max_grid_width = std::numeric_limits<uindex_t>::max();
+const uindex_t max_grid_height = std::numeric_limits<uindex_t>::max();
+template <typename F> using Updater = cpu::StencilUpdate<F>;
+template <typename F> constexpr uindex_t iters_per_pass = 1;
+
+#elif defined(STENCILSTREAM_BACKEND_GPU)
+const char *backend = "gpu";
+const uindex_t max_grid_width = std::numeric_limits<uindex_t>::max();
+const uindex_t max_grid_height = std::numeric_limits<uindex_t>::max();
+template <typename F> using Updater = gpu::StencilUpdate<F>;
+template <typename F> constexpr uindex_t iters_per_pass = 1;
+
+#endif
+
+/**
+ * \brief The list of benchmarked kernels.
+ *
+ * New kernels are added by appending them to the \ref Registry alias.
+ */
+template <typename... Kernels> struct KernelRegistry {
+    static std::vector<std::string> names() { return {Kernels::name...}; }
+
+    static void run(std::vector<std::string> const &selected, Sweep const &sweep,
+                    sycl::device device, std::vector<Result> &results) {
+        (run_kernel<Kernels>(selected, sweep, device, results), ...);
+    }
+
+  private:
+    template <typename F>
+    static void run_kernel(std::vector<std::string> const &selected, Sweep const &sweep,
+                           sycl::device device, std::vector<Result> &results) {
+        if (std::find(selected.begin(), selected.end(), F::name) == selected.end()) {
+            return;
+        }
+        for (UID grid_range : sweep.grid_ranges) {
+            if (grid_range.c > max_grid_width || grid_range.r > max_grid_height) {
+                std::cerr << "Skipping " << F::name << " on a " << grid_range.c << "x"
+                          << grid_range.r << " grid: The backend supports at most "
+                          << max_grid_width << "x" << max_grid_height << " cells." << std::endl;
+                continue;
+            }
+            for (uindex_t n_iterations : sweep.n_iterations) {
+                std::cerr << "Running " << F::name << " on a " << grid_range.c << "x"
+                          << grid_range.r << " grid for " << n_iterations << " iterations"
+                          << std::endl;
+                results.push_back(run_benchmark<F, Updater>(
+                    backend, device, iters_per_pass<F>, grid_range, n_iterations, sweep));
+            }
+        }
+    }
+};
+
+using Registry = KernelRegistry<HotspotKernel, FDTDKernel, ConwayKernel, ConvectionKernel,
+                                BoxKernel<1>, BoxKernel<2>, BoxKernel<4>>;
+
+/**
+ * \brief Split a comma-separated list.
+ */
+std::vector<std::string> split_list(std::string const &list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * \brief Parse a grid range, either as `<width>x<height>` or as `<size>` for square grids.
+ */
+UID parse_grid_range(std::string const &item) {
+    std::size_t separator = item.find('x');
+    uindex_t width = std::stoul(item.substr(0, separator));
+    uindex_t height =
+        separator == std::string::npos ? width : std::stoul(item.substr(separator + 1));
+    if (width == 0 || height == 0) {
+        throw std::invalid_argument("Grid ranges may not be zero");
+    }
+    return UID(width, height);
+}
+
+void usage(char const *program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl
+              << "Options:" << std::endl
+              << "  --kernels <k1,k2,...>     The kernels to run (default: all)" << std::endl
+              << "  --sizes <WxH,N,...>       The grid ranges (default: 256,512,1024)" << std::endl
+              << "  --iterations <n1,n2,...>  The iteration counts (default: 64,256)" << std::endl
+              << "  --warmup <n>              Unmeasured calls per point (default: 1)" << std::endl
+              << "  --repetitions <n>         Measured calls per point (default: 5)" << std::endl
+              << "  --format <csv|json>       The output format (default: csv)" << std::endl
+              << "  --output <file>           The output file (default: stdout)" << std::endl
+              << "Kernels:";
+    for (std::string const &name : Registry::names()) {
+        std::cerr << " " << name;
+    }
+    std::cerr << std::endl;
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> kernels = Registry::names();
+    Sweep sweep{.grid_ranges = {UID(256, 256), UID(512, 512), UID(1024, 1024)},
+                .n_iterations = {64, 256}};
+    std::string format = "csv";
+    std::string output_path;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string option = argv[i];
+            if (option == "--help" || i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            std::string value = argv[++i];
+            if (option == "--kernels") {
+                kernels = split_list(value);
+            } else if (option == "--sizes") {
+                sweep.grid_ranges.clear();
+                for (std::string const &item : split_list(value)) {
+                    sweep.grid_ranges.push_back(parse_grid_range(item));
+                }
+            } else if (option == "--iterations") {
+                sweep.n_iterations.clear();
+                for (std::string const &item : split_list(value)) {
+                    sweep.n_iterations.push_back(std::stoul(item));
+                }
+            } else if (option == "--warmup") {
+                sweep.n_warmup = std::stoul(value);
+            } else if (option == "--repetitions") {
+                sweep.n_repetitions = std::stoul(value);
+            } else if (option == "--format") {
+                format = value;
+            } else if (option == "--output") {
+                output_path = value;
+            } else {
+                usage(argv[0]);
+            }
+        }
+    } catch (std::logic_error const &error) {
+        std::cerr << "Error: Invalid argument: " << error.what() << std::endl;
+        usage(argv[0]);
+    }
+    if ((format != "csv" && format != "json") || sweep.n_repetitions == 0) {
+        usage(argv[0]);
+    }
+    for (std::string const &kernel : kernels) {
+        std::vector<std::string> names = Registry::names();
+        if (std::find(names.begin(), names.end(), kernel) == names.end()) {
+            std::cerr << "Error: Unknown kernel " << kernel << std::endl;
+            usage(argv[0]);
+        }
+    }
+
+#if defined(STENCILSTREAM_TARGET_FPGA)
+    sycl::device device(sycl::ext::intel::fpga_selector_v);
+#elif defined(STENCILSTREAM_TARGET_GPU)
+    sycl::device device(sycl::gpu_selector_v);
+#else
+    sycl::device device;
+#endif
+
+    std::vector<Result> results;
+    Registry::run(kernels, sweep, device, results);
+
+    std::ofstream output_file;
+    if (!output_path.empty()) {
+        output_file.open(output_path);
+        if (!output_file.is_open()) {
+            std::cerr << "Error: Could not open " << output_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &out = output_path.empty() ? std::cout : output_file;
+    if (format == "csv") {
+        write_csv(out, results);
+    } else {
+        write_json(out, results);
+    }
+
+    return 0;
+}
@@ -365,24 +365,33 @@ int main(int argc, char **argv) {
         .device = device,
     });
 
+    // The initial temperatures are computed on the device.
     Grid grid(nx + 1, ny + 1);
-    {
-        Grid::GridAccessor<sycl::access::mode::read_write> ac(grid);
-        for (uint32_t x = 0; x < nx + 1; x++) {
-            for (uint32_t y = 0; y < ny + 1; y++) {
-                ThermalConvectionCell cell = ThermalConvectionCell::halo_value();
-                if (y == 0) {
-                    cell.T = deltaT / 2.0;
-                } else if (y == ny - 1) {
-                    cell.T = -deltaT / 2.0;
-                } else if (x < nx && y < ny) {
-                    cell.T = deltaT * std::exp(-std::pow((x * dx - px) / w, 2) -
-                                               std::pow((y * dy - py) / w, 2));
-                }
-                ac[x][y] = cell;
-            }
+    sycl::queue init_queue(device);
+    grid.generate(init_queue, [=](uindex_t x, uindex_t y) {
+        ThermalConvectionCell cell = ThermalConvectionCell::halo_value();
+        if (y == 0) {
+            cell.T = deltaT / 2.0;
+        } else if (y == ny - 1) {
+            cell.T = -deltaT / 2.0;
+        } else if (x < nx && y < ny) {
+            cell.T = deltaT * sycl::exp(-sycl::pown((x * dx - px) / w, 2) -
+                                        sycl::pown((y * dy - py) / w, 2));
         }
-    }
+        return cell;
+    });
+
+    // The time step of the thermal solver is updated in every iteration.
+    ThermalSolverUpdate thermal_solver_update({
+        .transition_function =
+            ThermalSolverKernel{.nx = nx, .ny = ny, .dx = dx, .dy = dy, .dt = 0.0, .DcT = DcT},
+        .halo_value = ThermalConvectionCell::halo_value(),
+        .n_iterations = 1,
+        .device = device,
+    });
+
+    pseudo_transient_update.warm_up();
+    thermal_solver_update.warm_up();
 
     // Starting iteration with one and using an inclusive upper bound to stay compatible with the
     // reference.
@@ -402,8 +411,9 @@ int main(int argc, char **argv) {
             {
                 Grid::GridAccessor<sycl::access::mode::read> ac(grid);
                 for (uint32_t x = 0; x < nx + 1; x++) {
+                    auto column = ac.get_column(x);
                     for (uint32_t y = 0; y < ny + 1; y++) {
-                        auto cell = ac[x][y];
+                        auto const &cell = column[y];
                         if (x < nx && y < ny + 1 && std::abs(cell.ErrV) > max_ErrV) {
                             max_ErrV = std::abs(cell.ErrV);
                         }
@@ -437,13 +447,7 @@ int main(int argc, char **argv) {
         double dt_adv = std::min(dx / max_Vx, dy / max_Vy) / 2.1;
         double dt = std::min(dt_diff, dt_adv);
 
-        ThermalSolverUpdate thermal_solver_update({
-            .transition_function =
-                ThermalSolverKernel{.nx = nx, .ny = ny, .dx = dx, .dy = dy, .dt = dt, .DcT = DcT},
-            .halo_value = ThermalConvectionCell::halo_value(),
-            .n_iterations = 1,
-            .device = device,
-        });
+        thermal_solver_update.get_params().transition_function.dt = dt;
         grid = thermal_solver_update(grid);
 
         if (it > 0 && it % nout == 0) {
@@ -453,8 +457,9 @@ int main(int argc, char **argv) {
             {
                 Grid::GridAccessor<sycl::access::mode::read> ac(grid);
                 for (uindex_t c = 0; c < nx; c++) {
+                    auto column = ac.get_column(c);
                     for (uindex_t r = 0; r < ny; r++) {
-                        out_file << ac[c][r].T;
+                        out_file << column[r].T;
                         if (r != ny - 1) {
                             out_file << ",";
                         }
@@ -22,14 +22,17 @@
 #include "defines.hpp"
 #include "material/Material.hpp"
 #include <StencilStream/BaseTransitionFunction.hpp>
+#include <StencilStream/Concepts.hpp>
 #include <StencilStream/Stencil.hpp>
 
 template <typename MaterialResolver> class Kernel {
   public:
     using Cell = typename MaterialResolver::MaterialCell;
     using TimeDependentValue = float;
+    using ConstantTable = stencil::ConstantTableOf<MaterialResolver>;
 
     static constexpr uindex_t stencil_radius = 1;
+    static constexpr StencilShape stencil_shape = StencilShape::star(1);
     static constexpr uindex_t n_subiterations = 2;
 
     Kernel(Parameters const &parameters, MaterialResolver mat_resolver)
@@ -52,6 +55,14 @@ template <typename MaterialResolver> class Kernel {
         double_center_cr = parameters.grid_range()[0];
     }
 
+    static ConstantTable get_constant_table(Parameters const &parameters) {
+        if constexpr (has_constant_table<MaterialResolver>) {
+            return MaterialResolver::get_constant_table(parameters);
+        } else {
+            return ConstantTable();
+        }
+    }
+
     float get_time_dependent_value(uindex_t i_iteration) const {
         float current_time = i_iteration * dt;
         float wave_progress = (current_time - t_0) / tau;
@@ -59,7 +70,7 @@ template <typename MaterialResolver> class Kernel {
                cl::sycl::exp(-1 * wave_progress * wave_progress);
     }
 
-    Cell operator()(Stencil<Cell, 1, float> const &stencil) const {
+    Cell operator()(Stencil<Cell, 1, float, std::monostate, ConstantTable> const &stencil) const {
         Cell cell = stencil[ID(0, 0)];
 
         index_t c = stencil.id.c;
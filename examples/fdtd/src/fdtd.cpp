@@ -18,6 +18,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "Kernel.hpp"
+#include <array>
 #include <deque>
 #include <sycl/ext/intel/fpga_extensions.hpp>
 
@@ -35,6 +36,7 @@ using MaterialResolver = RenderResolver;
 using KernelImpl = Kernel<MaterialResolver>;
 using CellImpl = KernelImpl::Cell;
 
+#include <StencilStream/Snapshots.hpp>
 #include <StencilStream/tdv/SinglePassStrategies.hpp>
 
 #if TDVS_TYPE == 0
@@ -43,6 +45,8 @@ using TDVStrategy = tdv::single_pass::InlineStrategy;
 using TDVStrategy = tdv::single_pass::PrecomputeOnDeviceStrategy;
 #elif TDVS_TYPE == 2
 using TDVStrategy = tdv::single_pass::PrecomputeOnHostStrategy;
+#elif TDVS_TYPE == 3
+using TDVStrategy = tdv::single_pass::ChunkedPrecomputeOnHostStrategy<16 * n_processing_elements>;
 #endif
 
 #if defined(STENCILSTREAM_BACKEND_MONOTILE)
@@ -148,37 +152,43 @@ int main(int argc, char **argv) {
 
     MaterialResolver mat_resolver(parameters);
 
-    Grid grid(parameters.grid_range());
-    {
-        Grid::GridAccessor<access::mode::read_write> init_ac(grid);
-        for (uindex_t c = 0; c < parameters.grid_range()[0]; c++) {
-            for (uindex_t r = 0; r < parameters.grid_range()[1]; r++) {
-                float a = float(c) - float(parameters.grid_range()[0]) / 2.0;
-                float b = float(r) - float(parameters.grid_range()[1]) / 2.0;
-                float distance = parameters.dx * sqrt(a * a + b * b);
-
-                float radius = 0.0;
-                for (uindex_t i = 0; i <= parameters.rings.size(); i++) {
-                    if (i < parameters.rings.size()) {
-                        radius += parameters.rings[i].width;
-                        if (distance < radius) {
-                            init_ac[c][r] = CellImpl::from_parameters(parameters, i);
-                            break;
-                        }
-                    } else {
-                        init_ac[c][r] = CellImpl::from_parameters(parameters, i);
-                    }
-                }
-            }
-        }
-    }
-
 #if defined(STENCILSTREAM_TARGET_FPGA)
     sycl::device device(sycl::ext::intel::fpga_selector_v);
 #else
     sycl::device device;
 #endif
 
+    // The materials of the cells are resolved on the device, which needs the outer radii and the
+    // cells of the rings in arrays of a fixed size. The last cell is the one outside of all rings.
+    uindex_t n_rings = parameters.rings.size();
+    std::array<float, max_n_rings> ring_radii;
+    std::array<CellImpl, max_n_rings + 1> ring_cells;
+    float radius = 0.0;
+    for (uindex_t i = 0; i <= n_rings; i++) {
+        if (i < n_rings) {
+            radius += parameters.rings[i].width;
+            ring_radii[i] = radius;
+        }
+        ring_cells[i] = CellImpl::from_parameters(parameters, i);
+    }
+
+    Grid grid(parameters.grid_range());
+    float dx = parameters.dx;
+    float center_c = float(parameters.grid_range()[0]) / 2.0;
+    float center_r = float(parameters.grid_range()[1]) / 2.0;
+    sycl::queue init_queue(device);
+    grid.generate(init_queue, [=](uindex_t c, uindex_t r) {
+        float a = float(c) - center_c;
+        float b = float(r) - center_r;
+        float distance = dx * sycl::sqrt(a * a + b * b);
+        for (uindex_t i = 0; i < n_rings; i++) {
+            if (distance < ring_radii[i]) {
+                return ring_cells[i];
+            }
+        }
+        return ring_cells[n_rings];
+    });
+
     StencilUpdate simulation({
         .transition_function = KernelImpl(parameters, mat_resolver), .halo_value = CellImpl::halo(),
         .iteration_offset = 0, .n_iterations = parameters.n_timesteps(), .device = device,
@@ -188,19 +198,20 @@ int main(int argc, char **argv) {
 #endif
     });
 
+    simulation.get_params().constant_table = KernelImpl::get_constant_table(parameters);
+
     uindex_t n_timesteps = parameters.n_timesteps();
     uindex_t last_saved_iteration = 0;
 
     std::cout << "Simulating..." << std::endl;
 
     if (parameters.n_snap_timesteps().has_value()) {
-        uindex_t n_snap_timesteps = parameters.n_snap_timesteps().value();
-        simulation.get_params().n_iterations = n_snap_timesteps;
-        for (uindex_t &i = simulation.get_params().iteration_offset; i < parameters.n_timesteps();
-             i += n_snap_timesteps) {
-            grid = simulation(grid);
-            save_frame(grid, i + n_snap_timesteps, CellField::HZ, parameters);
-        }
+        // The frames are written by a worker thread while the next frames are computed.
+        grid = run_with_snapshots(
+            simulation, grid, n_timesteps, parameters.n_snap_timesteps().value(),
+            [&](Grid &frame, uindex_t i_iteration) {
+                save_frame(frame, i_iteration, CellField::HZ, parameters);
+            });
     } else {
         grid = simulation(grid);
     }
@@ -21,6 +21,7 @@
 #include "../Cell.hpp"
 #include "../Parameters.hpp"
 #include "Material.hpp"
+#include <StencilStream/ConstantTable.hpp>
 #include <StencilStream/Stencil.hpp>
 
 class LUTResolver {
@@ -36,7 +37,16 @@ class LUTResolver {
         }
     };
 
-    LUTResolver(Parameters const &parameters) : materials() {
+    /**
+     * The coefficients of the materials, indexed by the ring index of a cell. The table is shared
+     * by all processing elements instead of being copied into every one of them.
+     */
+    using ConstantTable = stencil::ConstantTable<CoefMaterial, max_n_rings + 1>;
+
+    LUTResolver(Parameters const &parameters) {}
+
+    static ConstantTable get_constant_table(Parameters const &parameters) {
+        ConstantTable materials;
         for (uindex_t i = 0; i < max_n_rings + 1; i++) {
             if (i < parameters.rings.size()) {
                 materials[i] = CoefMaterial::from_relative_material(parameters.rings[i].material,
@@ -45,13 +55,12 @@ class LUTResolver {
                 materials[i] = CoefMaterial::perfect_metal();
             }
         }
+        return materials;
     }
 
-    CoefMaterial get_material_coefficients(Stencil<MaterialCell, 1, float> const &stencil,
-                                           index_t distance_score) const {
-        return materials[stencil[ID(0, 0)].index];
+    CoefMaterial get_material_coefficients(
+        Stencil<MaterialCell, 1, float, std::monostate, ConstantTable> const &stencil,
+        index_t distance_score) const {
+        return stencil.constant_table()[stencil[ID(0, 0)].index];
     }
-
-  private:
-    CoefMaterial materials[max_n_rings + 1];
 };
@@ -21,6 +21,7 @@
 #include <chrono>
 #include <fstream>
 #include <sycl/ext/intel/fpga_extensions.hpp>
+#include <vector>
 
 #if defined(STENCILSTREAM_BACKEND_MONOTILE)
     #include <StencilStream/monotile/StencilUpdate.hpp>
@@ -54,47 +55,38 @@ const FLOAT chip_width = 0.016;
 const FLOAT amb_temp = 80.0;
 
 /* stencil parameters */
-using HotspotCell = vec<FLOAT, 2>;
+// The temperature is the only mutable value of a cell. The dissipated power never changes, so it's
+// stored in the static grid and never written back.
+using HotspotCell = FLOAT;
 
 struct HotspotKernel : public BaseTransitionFunction {
     using Cell = HotspotCell;
+    using StaticValue = FLOAT;
+
+    // Only the four direct neighbours are read.
+    static constexpr StencilShape stencil_shape = StencilShape::star(1);
+
+    // Missing neighbours at the borders are replaced by the cell itself.
+    static constexpr BoundaryCondition boundary_condition = BoundaryCondition::Clamp;
 
     float Rx_1, Ry_1, Rz_1, Cap_1;
 
-    Cell operator()(Stencil<HotspotCell, 1> const &temp) const {
-        using StencilID = typename Stencil<HotspotCell, 1>::StencilID;
-
-        ID idx = temp.id;
-        index_t c = idx.c;
-        index_t r = idx.r;
-        uindex_t width = temp.grid_range.c;
-        uindex_t height = temp.grid_range.r;
-
-        FLOAT power = temp[StencilID(0, 0)][1];
-        FLOAT old = temp[StencilID(0, 0)][0];
-        FLOAT left = temp[StencilID(-1, 0)][0];
-        FLOAT right = temp[StencilID(1, 0)][0];
-        FLOAT top = temp[StencilID(0, -1)][0];
-        FLOAT bottom = temp[StencilID(0, 1)][0];
-
-        if (c == 0) {
-            left = old;
-        } else if (c == width - 1) {
-            right = old;
-        }
+    Cell operator()(Stencil<HotspotCell, 1, std::monostate, FLOAT> const &temp) const {
+        using StencilID = typename Stencil<HotspotCell, 1, std::monostate, FLOAT>::StencilID;
 
-        if (r == 0) {
-            top = old;
-        } else if (r == height - 1) {
-            bottom = old;
-        }
+        FLOAT power = temp.static_value;
+        FLOAT old = temp[StencilID(0, 0)];
+        FLOAT left = temp[StencilID(-1, 0)];
+        FLOAT right = temp[StencilID(1, 0)];
+        FLOAT top = temp[StencilID(0, -1)];
+        FLOAT bottom = temp[StencilID(0, 1)];
 
         // As in the OpenCL version of the rodinia "hotspot" benchmark.
         FLOAT new_temp =
             old + Cap_1 * (power + (bottom + top - 2.f * old) * Ry_1 +
                            (right + left - 2.f * old) * Rx_1 + (amb_temp - old) * Rz_1);
 
-        return vec(new_temp, power);
+        return new_temp;
     }
 };
 
@@ -104,7 +96,7 @@ const uindex_t max_grid_height = 1024;
 const uindex_t n_processing_elements = 280;
 using StencilUpdate =
     monotile::StencilUpdate<HotspotKernel, n_processing_elements, max_grid_width, max_grid_height>;
-using Grid = monotile::Grid<HotspotCell>;
+using Grid = StencilUpdate::GridImpl;
 
 #elif defined(STENCILSTREAM_BACKEND_TILING)
 const uindex_t tile_width = 1 << 16;
@@ -119,6 +111,7 @@ using StencilUpdate = cpu::StencilUpdate<HotspotKernel>;
 using Grid = StencilUpdate::GridImpl;
 
 #endif
+using StaticGrid = StencilUpdate::StaticGridImpl;
 
 void write_output(Grid vect, string file, bool binary) {
     fstream out;
@@ -134,15 +127,21 @@ void write_output(Grid vect, string file, bool binary) {
 
     uindex_t n_columns = vect.get_grid_width();
     uindex_t n_rows = vect.get_grid_height();
-    Grid::GridAccessor<access::mode::read> vect_ac(vect);
+    std::vector<HotspotCell> temp_values(n_columns * n_rows);
+    {
+        sycl::buffer<HotspotCell, 2> temp_buffer(temp_values.data(),
+                                                 sycl::range<2>(n_columns, n_rows));
+        vect.copy_to_buffer(temp_buffer);
+    }
 
     int i = 0;
     for (index_t r = 0; r < n_rows; r++) {
         for (index_t c = 0; c < n_columns; c++) {
+            HotspotCell value = temp_values[c * n_rows + r];
             if (binary) {
-                out.write((char *)&vect_ac[c][r][0], sizeof(float));
+                out.write((char *)&value, sizeof(float));
             } else {
-                out << i << "\t" << vect_ac[c][r][0] << std::endl;
+                out << i << "\t" << value << std::endl;
             }
             i++;
         }
@@ -151,8 +150,8 @@ void write_output(Grid vect, string file, bool binary) {
     out.close();
 }
 
-Grid read_input(string temp_file, string power_file, uindex_t n_columns, uindex_t n_rows,
-                bool binary) {
+std::pair<Grid, StaticGrid> read_input(string temp_file, string power_file, uindex_t n_columns,
+                                       uindex_t n_rows, bool binary) {
     fstream temp, power;
     if (binary) {
         temp = fstream(temp_file, temp.in | temp.binary);
@@ -162,28 +161,36 @@ Grid read_input(string temp_file, string power_file, uindex_t n_columns, uindex_
         power = fstream(power_file, power.in);
     }
 
-    Grid vect(n_columns, n_rows);
-    {
-        Grid::GridAccessor<access::mode::read_write> vect_ac(vect);
-
-        for (index_t r = 0; r < n_rows; r++) {
-            for (index_t c = 0; c < n_columns; c++) {
-                FLOAT tmp_temp, tmp_power;
-                if (binary) {
-                    temp.read((char *)&tmp_temp, sizeof(float));
-                    power.read((char *)&tmp_power, sizeof(float));
-                } else {
-                    temp >> tmp_temp;
-                    power >> tmp_power;
-                }
-                vect_ac[c][r] = HotspotCell(tmp_temp, tmp_power);
+    // The cells are read into host buffers in the layout of a SYCL buffer, with the column index
+    // first, and then copied into the grids in one go instead of cell by cell.
+    std::vector<HotspotCell> temp_values(n_columns * n_rows);
+    std::vector<FLOAT> power_values(n_columns * n_rows);
+    for (index_t r = 0; r < n_rows; r++) {
+        for (index_t c = 0; c < n_columns; c++) {
+            FLOAT tmp_temp, tmp_power;
+            if (binary) {
+                temp.read((char *)&tmp_temp, sizeof(float));
+                power.read((char *)&tmp_power, sizeof(float));
+            } else {
+                temp >> tmp_temp;
+                power >> tmp_power;
             }
+            temp_values[c * n_rows + r] = tmp_temp;
+            power_values[c * n_rows + r] = tmp_power;
         }
     }
 
+    Grid vect(n_columns, n_rows);
+    StaticGrid power_vect(n_columns, n_rows);
+    {
+        sycl::range<2> range(n_columns, n_rows);
+        vect.copy_from_buffer(sycl::buffer<HotspotCell, 2>(temp_values.data(), range));
+        power_vect.copy_from_buffer(sycl::buffer<FLOAT, 2>(power_values.data(), range));
+    }
+
     temp.close();
     power.close();
-    return vect;
+    return {vect, power_vect};
 }
 
 void usage(int argc, char **argv) {
@@ -246,7 +253,7 @@ int main(int argc, char **argv) {
     bool binary_io = tfile.ends_with(".bin");
     assert(!binary_io || pfile.ends_with(".bin"));
 
-    Grid grid = read_input(tfile, pfile, n_columns, n_rows, binary_io);
+    auto [grid, power_grid] = read_input(tfile, pfile, n_columns, n_rows, binary_io);
 
     printf("Start computing the transient temperature\n");
 
@@ -275,12 +282,14 @@ int main(int argc, char **argv) {
     StencilUpdate update({
         .transition_function =
             HotspotKernel{.Rx_1 = Rx_1, .Ry_1 = Ry_1, .Rz_1 = Rz_1, .Cap_1 = Cap_1},
-        .halo_value = HotspotCell(0.0, 0.0), .n_iterations = sim_time, .device = device,
+        .halo_value = HotspotCell(0.0), .n_iterations = sim_time, .device = device,
         .blocking = true, // enable blocking for meaningful walltime measurements
 #if !defined(STENCILSTREAM_BACKEND_CPU)
             .profiling = true, // enable additional profiling for FPGA targets
 #endif
+        .overwrite_source = true, // the input grid is replaced by the result anyway
     });
+    update.set_static_grid(power_grid);
 
     grid = update(grid);
 
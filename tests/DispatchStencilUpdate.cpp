@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "StencilUpdateTest.hpp"
+#include "TransFuncs.hpp"
+#include "constants.hpp"
+#include <StencilStream/DispatchStencilUpdate.hpp>
+#include <StencilStream/cpu/StencilUpdate.hpp>
+#include <StencilStream/monotile/StencilUpdate.hpp>
+#include <StencilStream/tiling/StencilUpdate.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace sycl;
+using namespace stencil;
+
+using MonotileUpdate =
+    monotile::StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+using TilingUpdate =
+    tiling::StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+using CPUUpdate = cpu::StencilUpdate<FPGATransFunc<1>>;
+using Dispatcher = DispatchStencilUpdate<FPGATransFunc<1>, MonotileUpdate, TilingUpdate, CPUUpdate>;
+using GridImpl = Dispatcher::GridImpl;
+
+static_assert(concepts::StencilUpdate<Dispatcher, FPGATransFunc<1>, GridImpl>);
+
+TEST_CASE("DispatchStencilUpdate", "[DispatchStencilUpdate]") {
+    Dispatcher update({.transition_function = FPGATransFunc<1>(),
+                       .halo_value = Cell::halo(),
+                       .n_iterations = 2 * iters_per_pass + 1});
+
+    // Without any estimates, the first updater that supports the grid is picked.
+    REQUIRE(!update.get_last_choice().has_value());
+    test_stencil_update<GridImpl, Dispatcher>(tile_width / 2, tile_height / 2, update);
+    REQUIRE(update.get_last_choice() == 0);
+    REQUIRE(update.get_updater<0>().get_n_processed_cells() ==
+            (tile_width / 2) * (tile_height / 2) * (2 * iters_per_pass + 1));
+
+    // Monotile doesn't support grids bigger than a tile.
+    test_stencil_update<GridImpl, Dispatcher>(tile_width + 1, tile_height / 2, update);
+    REQUIRE(update.get_last_choice() == 1);
+    REQUIRE(update.get_updater<1>().get_n_processed_cells() ==
+            (tile_width + 1) * (tile_height / 2) * (2 * iters_per_pass + 1));
+    REQUIRE(update.get_updater<2>().get_n_processed_cells() == 0);
+}
+
+TEST_CASE("DispatchStencilUpdate (runtime estimates)", "[DispatchStencilUpdate]") {
+    Dispatcher::Params params{.transition_function = FPGATransFunc<1>(),
+                              .halo_value = Cell::halo(),
+                              .n_iterations = 2 * iters_per_pass + 1};
+    std::get<0>(params.updater_params).clock_frequency = 1.0;
+    std::get<1>(params.updater_params).clock_frequency = 1.0;
+    Dispatcher update(params);
+
+    // The performance models decide between monotile and tiling.
+    for (uindex_t grid_width : {uindex_t(1), tile_width / 2, tile_width}) {
+        double monotile_runtime =
+            MonotileUpdate::model_runtime(grid_width, tile_height, params.n_iterations, 1.0);
+        double tiling_runtime =
+            TilingUpdate::model_runtime(grid_width, tile_height, params.n_iterations, 1.0);
+        uindex_t expected_choice = monotile_runtime <= tiling_runtime ? 0 : 1;
+        REQUIRE(update.choose(grid_width, tile_height, params.n_iterations) == expected_choice);
+    }
+    REQUIRE(update.choose(tile_width + 1, tile_height, params.n_iterations) == 1);
+
+    // Updaters without a model are estimated from their previous calls.
+    using CPUDispatcher = DispatchStencilUpdate<FPGATransFunc<1>, CPUUpdate, TilingUpdate>;
+    CPUDispatcher::Params cpu_params{.transition_function = FPGATransFunc<1>(),
+                                     .halo_value = Cell::halo(),
+                                     .n_iterations = 2 * iters_per_pass + 1,
+                                     .blocking = true};
+    std::get<1>(cpu_params.updater_params).clock_frequency =
+        std::numeric_limits<double>::infinity();
+    CPUDispatcher cpu_update(cpu_params);
+    REQUIRE(cpu_update.choose(tile_width, tile_height, cpu_params.n_iterations) == 1);
+
+    std::get<1>(cpu_update.get_params().updater_params).clock_frequency = std::nullopt;
+    REQUIRE(cpu_update.choose(tile_width, tile_height, cpu_params.n_iterations) == 0);
+    test_stencil_update<GridImpl, CPUDispatcher>(tile_width, tile_height, cpu_update);
+    REQUIRE(cpu_update.get_last_choice() == 0);
+    REQUIRE(cpu_update.get_updater<0>().get_walltime() > 0.0);
+    REQUIRE(cpu_update.choose(tile_width, tile_height, cpu_params.n_iterations) == 0);
+
+    // The unscaled tiling model is a lower bound of its walltime, and a tiny bound beats the
+    // measured CPU walltime. A huge bound doesn't.
+    std::get<1>(cpu_update.get_params().updater_params).clock_frequency = 1e30;
+    REQUIRE(cpu_update.choose(tile_width, tile_height, cpu_params.n_iterations) == 1);
+    std::get<1>(cpu_update.get_params().updater_params).clock_frequency = 1e-30;
+    REQUIRE(cpu_update.choose(tile_width, tile_height, cpu_params.n_iterations) == 0);
+
+    // Once tiling has been measured, its model is scaled to the measured walltime, which is far
+    // longer than the tiny unscaled model. A model that is a thousand times slower is then beaten
+    // by the CPU again.
+    std::get<1>(cpu_update.get_params().updater_params).clock_frequency = 1e30;
+    test_stencil_update<GridImpl, CPUDispatcher>(tile_width, tile_height, cpu_update);
+    REQUIRE(cpu_update.get_last_choice() == 1);
+    std::get<1>(cpu_update.get_params().updater_params).clock_frequency = 1e27;
+    REQUIRE(cpu_update.choose(tile_width, tile_height, cpu_params.n_iterations) == 0);
+}
+
+TEST_CASE("DispatchStencilUpdate (no supporting updater)", "[DispatchStencilUpdate]") {
+    using MonotileDispatcher = DispatchStencilUpdate<FPGATransFunc<1>, MonotileUpdate>;
+    MonotileDispatcher update({.transition_function = FPGATransFunc<1>()});
+    REQUIRE_THROWS_AS(update.choose(tile_width + 1, tile_height, 1), std::range_error);
+    REQUIRE(update.choose(tile_width, tile_height, 1) == 0);
+}
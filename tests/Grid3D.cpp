@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <StencilStream/Concepts.hpp>
+#include <StencilStream/Grid3D.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace stencil;
+
+using TestGrid = Grid3D<ID3D>;
+
+static_assert(concepts::Grid3D<TestGrid, ID3D>);
+
+constexpr uindex_t grid_width = 7;
+constexpr uindex_t grid_height = 6;
+constexpr uindex_t grid_depth = 5;
+
+TEST_CASE("Grid3D::Grid3D", "[Grid3D]") {
+    TestGrid grid(grid_width, grid_height, grid_depth);
+    REQUIRE(grid.get_grid_width() == grid_width);
+    REQUIRE(grid.get_grid_height() == grid_height);
+    REQUIRE(grid.get_grid_depth() == grid_depth);
+
+    grid = TestGrid(sycl::range<3>(1, 2, 3));
+    REQUIRE(grid.get_grid_width() == 1);
+    REQUIRE(grid.get_grid_height() == 2);
+    REQUIRE(grid.get_grid_depth() == 3);
+}
+
+TEST_CASE("Grid3D::copy_{from,to}_buffer", "[Grid3D]") {
+    sycl::buffer<ID3D, 3> buffer(sycl::range<3>(grid_width, grid_height, grid_depth));
+    {
+        sycl::host_accessor ac(buffer, sycl::read_write);
+        for (index_t c = 0; c < grid_width; c++) {
+            for (index_t r = 0; r < grid_height; r++) {
+                for (index_t l = 0; l < grid_depth; l++) {
+                    ac[c][r][l] = ID3D(c, r, l);
+                }
+            }
+        }
+    }
+
+    TestGrid grid(buffer);
+    {
+        TestGrid::GridAccessor<sycl::access::mode::read_write> ac(grid);
+        for (index_t c = 0; c < grid_width; c++) {
+            for (index_t r = 0; r < grid_height; r++) {
+                for (index_t l = 0; l < grid_depth; l++) {
+                    REQUIRE(ac[c][r][l] == ID3D(c, r, l));
+                    ac[c][r][l] = ID3D(l, r, c);
+                }
+            }
+        }
+    }
+
+    grid.copy_to_buffer(buffer);
+    {
+        sycl::host_accessor ac(buffer, sycl::read_only);
+        for (index_t c = 0; c < grid_width; c++) {
+            for (index_t r = 0; r < grid_height; r++) {
+                for (index_t l = 0; l < grid_depth; l++) {
+                    REQUIRE(ac[c][r][l] == ID3D(l, r, c));
+                }
+            }
+        }
+    }
+
+    sycl::buffer<ID3D, 3> other_buffer(sycl::range<3>(grid_width, grid_height, grid_depth + 1));
+    REQUIRE_THROWS_AS(grid.copy_from_buffer(other_buffer), std::range_error);
+    REQUIRE_THROWS_AS(grid.copy_to_buffer(other_buffer), std::range_error);
+}
+
+TEST_CASE("Grid3D::make_similar", "[Grid3D]") {
+    TestGrid grid(grid_width, grid_height, grid_depth);
+    TestGrid similar_grid = grid.make_similar();
+    REQUIRE(similar_grid.get_grid_width() == grid_width);
+    REQUIRE(similar_grid.get_grid_height() == grid_height);
+    REQUIRE(similar_grid.get_grid_depth() == grid_depth);
+    REQUIRE(&similar_grid.get_buffer() != &grid.get_buffer());
+    REQUIRE(grid.get_n_references() == 1);
+
+    TestGrid copy = grid;
+    REQUIRE(grid.get_n_references() == 2);
+}
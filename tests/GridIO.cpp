@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "TransFuncs.hpp"
+#include "constants.hpp"
+#include <StencilStream/GridIO.hpp>
+#include <StencilStream/cpu/Grid.hpp>
+#include <StencilStream/monotile/Grid.hpp>
+#include <catch2/catch_all.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace sycl;
+using namespace stencil;
+
+std::string grid_file_path(std::string const &name) {
+    return (std::filesystem::temp_directory_path() / ("stencilstream_test_" + name)).string();
+}
+
+template <typename G> G make_io_test_grid() {
+    G grid(tile_width, tile_height);
+    typename G::template GridAccessor<access::mode::read_write> ac(grid);
+    for (uindex_t c = 0; c < tile_width; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            ac[c][r] = Cell{index_t(c), index_t(r), 42, 0, CellStatus::Normal};
+        }
+    }
+    return grid;
+}
+
+template <typename G> void test_grid_round_trip() {
+    std::string path = grid_file_path("round_trip.grid");
+    G grid = make_io_test_grid<G>();
+    io::write_grid<Cell>(path, grid, 42);
+
+    io::MappedGridFile file(path);
+    REQUIRE(file.get_grid_width() == tile_width);
+    REQUIRE(file.get_grid_height() == tile_height);
+    REQUIRE(file.get_iteration_offset() == 42);
+    REQUIRE(file.contains_cells());
+    REQUIRE(std::filesystem::file_size(path) ==
+            sizeof(io::FileHeader) + tile_width * tile_height * sizeof(Cell));
+
+    // The values can be accessed directly in the mapped file, or copied into a new grid.
+    std::span<Cell const> cells = file.get_values<Cell>();
+    REQUIRE(cells.size() == tile_width * tile_height);
+    REQUIRE(cells[3 * tile_height + 5].c == 3);
+    REQUIRE(cells[3 * tile_height + 5].r == 5);
+
+    G read_grid = io::read_grid<Cell, G>(file);
+    REQUIRE(read_grid.get_grid_width() == tile_width);
+    REQUIRE(read_grid.get_grid_height() == tile_height);
+    typename G::template GridAccessor<access::mode::read> ac(read_grid);
+    for (uindex_t c = 0; c < tile_width; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            REQUIRE(ac[c][r].c == c);
+            REQUIRE(ac[c][r].r == r);
+            REQUIRE(ac[c][r].i_iteration == 42);
+            REQUIRE(ac[c][r].status == CellStatus::Normal);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("io::write_grid", "[io]") {
+    test_grid_round_trip<cpu::Grid<Cell>>();
+    test_grid_round_trip<monotile::Grid<Cell>>();
+}
+
+TEST_CASE("io::write_field", "[io]") {
+    std::string path = grid_file_path("field.grid");
+    cpu::Grid<Cell> grid = make_io_test_grid<cpu::Grid<Cell>>();
+    io::write_field<Cell>(path, grid, 7, [](Cell const &cell) { return cell.r; });
+
+    io::MappedGridFile file(path);
+    REQUIRE(!file.contains_cells());
+    REQUIRE(file.get_iteration_offset() == 7);
+    std::span<index_t const> rows = file.get_values<index_t>();
+    for (uindex_t c = 0; c < tile_width; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            REQUIRE(rows[c * tile_height + r] == index_t(r));
+        }
+    }
+
+    // Single fields can't be read as cells.
+    REQUIRE_THROWS_AS(file.get_values<Cell>(), std::invalid_argument);
+    REQUIRE_THROWS_AS((io::read_grid<Cell, cpu::Grid<Cell>>(file)), std::invalid_argument);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("io::MappedGridFile (invalid files)", "[io]") {
+    REQUIRE_THROWS_AS((io::MappedGridFile(grid_file_path("missing.grid"))),
+                      std::runtime_error);
+
+    std::string path = grid_file_path("invalid.grid");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "This is not a grid file, but it's long enough to contain a header of 64 bytes.";
+    }
+    REQUIRE_THROWS_AS((io::MappedGridFile(path)), std::invalid_argument);
+
+    // Truncated files are detected.
+    cpu::Grid<Cell> grid = make_io_test_grid<cpu::Grid<Cell>>();
+    io::write_grid<Cell>(path, grid);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+    REQUIRE_THROWS_AS((io::MappedGridFile(path)), std::invalid_argument);
+
+    // Headers whose grid size overflows or is zero are rejected too.
+    auto write_header = [&](std::uint64_t grid_width, std::uint64_t grid_height) {
+        io::FileHeader header{};
+        std::memcpy(header.magic, io::FileHeader::file_magic, sizeof(header.magic));
+        header.version = io::FileHeader::current_version;
+        header.value_size = sizeof(Cell);
+        header.value_alignment = alignof(Cell);
+        header.contains_cells = true;
+        header.grid_width = grid_width;
+        header.grid_height = grid_height;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        Cell cell{};
+        out.write(reinterpret_cast<char const *>(&cell), sizeof(cell));
+    };
+    write_header(std::uint64_t(1) << 32, std::uint64_t(1) << 32);
+    REQUIRE_THROWS_AS((io::MappedGridFile(path)), std::invalid_argument);
+    write_header(0, 1);
+    REQUIRE_THROWS_AS((io::MappedGridFile(path)), std::invalid_argument);
+    write_header(1, 1);
+    REQUIRE(io::MappedGridFile(path).get_grid_width() == 1);
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "constants.hpp"
+#include <StencilStream/GenericID.hpp>
+#include <StencilStream/Grid3D.hpp>
+#include <StencilStream/GridPool.hpp>
+#include <StencilStream/cpu/Grid.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace stencil;
+
+using TestGrid = cpu::Grid<ID>;
+
+TEST_CASE("GridPool::acquire", "[GridPool]") {
+    GridPool<TestGrid> pool;
+    TestGrid source_grid(tile_width, tile_height);
+
+    {
+        TestGrid grid_a = pool.acquire(source_grid);
+        TestGrid grid_b = pool.acquire(source_grid);
+        REQUIRE(grid_a.get_grid_width() == tile_width);
+        REQUIRE(grid_a.get_grid_height() == tile_height);
+        REQUIRE(grid_a.get_buffer() != grid_b.get_buffer());
+        REQUIRE(grid_a.get_buffer() != source_grid.get_buffer());
+        REQUIRE(pool.get_n_grids() == 2);
+    }
+
+    // Both grids are free again and should be reused.
+    {
+        TestGrid grid_a = pool.acquire(source_grid);
+        TestGrid grid_b = pool.acquire(source_grid);
+        REQUIRE(grid_a.get_buffer() != grid_b.get_buffer());
+        REQUIRE(pool.get_n_grids() == 2);
+
+        // A third grid has to be allocated since the others are still in use.
+        TestGrid grid_c = pool.acquire(source_grid);
+        REQUIRE(pool.get_n_grids() == 3);
+    }
+}
+
+TEST_CASE("GridPool::acquire (different sizes)", "[GridPool]") {
+    GridPool<TestGrid> pool;
+    TestGrid small_grid(tile_width / 2, tile_height / 2);
+    TestGrid large_grid(tile_width, tile_height);
+
+    TestGrid used_grid = pool.acquire(small_grid);
+    pool.acquire(small_grid);
+    REQUIRE(pool.get_n_grids() == 2);
+
+    // The free small grid is released, but the used one is kept.
+    TestGrid grid = pool.acquire(large_grid);
+    REQUIRE(grid.get_grid_width() == tile_width);
+    REQUIRE(grid.get_grid_height() == tile_height);
+    REQUIRE(pool.get_n_grids() == 2);
+}
+
+TEST_CASE("GridPool::shrink", "[GridPool]") {
+    GridPool<TestGrid> pool;
+    TestGrid source_grid(tile_width, tile_height);
+
+    TestGrid used_grid = pool.acquire(source_grid);
+    pool.acquire(source_grid);
+    REQUIRE(pool.get_n_grids() == 2);
+
+    pool.shrink();
+    REQUIRE(pool.get_n_grids() == 1);
+}
+
+TEST_CASE("GridPool::acquire (different depths)", "[GridPool]") {
+    GridPool<Grid3D<index_t>> pool;
+    Grid3D<index_t> shallow_grid(4, 4, 2);
+    Grid3D<index_t> deep_grid(4, 4, 3);
+
+    pool.acquire(shallow_grid);
+    Grid3D<index_t> grid = pool.acquire(deep_grid);
+    REQUIRE(grid.get_grid_depth() == 3);
+    REQUIRE(pool.get_n_grids() == 1);
+}
@@ -20,6 +20,7 @@
 #pragma once
 #include "constants.hpp"
 #include <StencilStream/Concepts.hpp>
+#include <StencilStream/Helpers.hpp>
 #include <StencilStream/Index.hpp>
 #include <catch2/catch_all.hpp>
 
@@ -119,4 +120,216 @@ void test_make_similar(stencil::uindex_t grid_width, stencil::uindex_t grid_heig
     REQUIRE(similar_grid.get_grid_height() == grid_height);
 }
 
-} // namespace grid_test
\ No newline at end of file
+template <stencil::concepts::Grid<stencil::ID> G>
+void test_n_references(stencil::uindex_t grid_width, stencil::uindex_t grid_height) {
+    G grid(grid_width, grid_height);
+    REQUIRE(grid.get_n_references() == 1);
+    {
+        G grid_copy = grid;
+        REQUIRE(grid.get_n_references() == 2);
+        REQUIRE(grid_copy.get_n_references() == 2);
+
+        G similar_grid = grid.make_similar();
+        REQUIRE(similar_grid.get_n_references() == 1);
+    }
+    REQUIRE(grid.get_n_references() == 1);
+}
+
+template <stencil::concepts::Grid<stencil::ID> G>
+void test_project(stencil::uindex_t grid_width, stencil::uindex_t grid_height) {
+    G grid(grid_width, grid_height);
+    {
+        typename G::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+        for (stencil::index_t c = 0; c < grid_width; c++) {
+            for (stencil::index_t r = 0; r < grid_height; r++) {
+                ac[c][r] = stencil::ID(c, r);
+            }
+        }
+    }
+
+    sycl::queue queue;
+    sycl::buffer<stencil::index_t, 2> rows = grid.template project<&stencil::ID::r>(queue);
+    sycl::buffer<bool, 2> diagonal =
+        grid.project(queue, [](stencil::ID const &id) { return id.c == id.r; });
+    REQUIRE(rows.get_range() == sycl::range<2>(grid_width, grid_height));
+    REQUIRE(diagonal.get_range() == sycl::range<2>(grid_width, grid_height));
+
+    sycl::host_accessor rows_ac(rows, sycl::read_only);
+    sycl::host_accessor diagonal_ac(diagonal, sycl::read_only);
+    for (stencil::index_t c = 0; c < grid_width; c++) {
+        for (stencil::index_t r = 0; r < grid_height; r++) {
+            REQUIRE(rows_ac[c][r] == r);
+            REQUIRE(diagonal_ac[c][r] == (c == r));
+        }
+    }
+}
+
+template <stencil::concepts::Grid<stencil::ID> G>
+void test_generate(stencil::uindex_t grid_width, stencil::uindex_t grid_height) {
+    G grid(grid_width, grid_height);
+    sycl::queue queue;
+    auto generator = [](stencil::uindex_t c, stencil::uindex_t r) { return stencil::ID(c, r); };
+    grid.generate(queue, generator).wait();
+
+    typename G::template GridAccessor<sycl::access::mode::read> grid_ac(grid);
+    for (stencil::uindex_t c = 0; c < grid_width; c++) {
+        for (stencil::uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(grid_ac[c][r] == stencil::ID(c, r));
+        }
+    }
+}
+
+template <stencil::concepts::Grid<stencil::ID> G>
+void test_cell_views(stencil::uindex_t grid_width, stencil::uindex_t grid_height) {
+    G grid(grid_width, grid_height);
+    {
+        typename G::template GridAccessor<sycl::access::mode::read_write> grid_ac(grid);
+        for (stencil::uindex_t c = 0; c < grid_width; c++) {
+            stencil::uindex_t r = 0;
+            for (stencil::ID &cell : grid_ac.get_column(c)) {
+                cell = stencil::ID(c, r);
+                r++;
+            }
+            REQUIRE(r == grid_height);
+        }
+    }
+
+    typename G::template GridAccessor<sycl::access::mode::read> grid_ac(grid);
+    for (stencil::uindex_t c = 0; c < grid_width; c++) {
+        for (stencil::uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(grid_ac[c][r] == stencil::ID(c, r));
+        }
+    }
+
+    stencil::uindex_t i = 0;
+    for (stencil::ID const &cell : grid_ac.get_cells()) {
+        REQUIRE(cell == stencil::ID(i / grid_height, i % grid_height));
+        i++;
+    }
+    REQUIRE(i == grid_width * grid_height);
+}
+
+template <stencil::concepts::Grid<stencil::ID> G>
+void test_adopt(stencil::uindex_t grid_width, stencil::uindex_t grid_height) {
+    sycl::buffer<stencil::ID, 2> buffer = sycl::range<2>(grid_width, grid_height);
+    {
+        sycl::host_accessor buffer_ac(buffer, sycl::read_write);
+        for (stencil::index_t c = 0; c < grid_width; c++) {
+            for (stencil::index_t r = 0; r < grid_height; r++) {
+                buffer_ac[c][r] = stencil::ID(c, r);
+            }
+        }
+    }
+
+    G grid = G::adopt(buffer);
+    REQUIRE(grid.get_grid_width() == grid_width);
+    REQUIRE(grid.get_grid_height() == grid_height);
+    {
+        typename G::template GridAccessor<sycl::access::mode::read_write> grid_ac(grid);
+        for (stencil::index_t c = 0; c < grid_width; c++) {
+            for (stencil::index_t r = 0; r < grid_height; r++) {
+                REQUIRE(grid_ac[c][r] == stencil::ID(c, r));
+                grid_ac[c][r] = stencil::ID(r, c);
+            }
+        }
+    }
+
+    // The grid and the buffer share their memory.
+    sycl::host_accessor buffer_ac(buffer, sycl::read_only);
+    for (stencil::index_t c = 0; c < grid_width; c++) {
+        for (stencil::index_t r = 0; r < grid_height; r++) {
+            REQUIRE(buffer_ac[c][r] == stencil::ID(r, c));
+        }
+    }
+}
+
+/**
+ * \brief A cell with a double-precision value that the grids store with single precision.
+ */
+struct CodedCell {
+    double value;
+};
+
+/**
+ * \brief Return the value of a coded cell, most of which can't be represented as a float.
+ */
+inline double coded_value(stencil::uindex_t c, stencil::uindex_t r) { return c + r / 3.0; }
+
+/**
+ * \brief Return the value that a coded cell has after it has been stored in a grid.
+ */
+inline double stored_value(double value) { return double(float(value)); }
+
+} // namespace grid_test
+
+template <> struct stencil::CellCodec<grid_test::CodedCell> {
+    using Storage = float;
+
+    static Storage encode(grid_test::CodedCell const &cell) { return float(cell.value); }
+
+    static grid_test::CodedCell decode(Storage const &stored_cell) {
+        return grid_test::CodedCell{stored_cell};
+    }
+};
+
+namespace grid_test {
+template <stencil::concepts::Grid<CodedCell> G>
+void test_cell_codec(stencil::uindex_t grid_width, stencil::uindex_t grid_height) {
+    static_assert(stencil::has_cell_codec<CodedCell>);
+    REQUIRE(stored_value(coded_value(0, 1)) != coded_value(0, 1));
+
+    G grid(grid_width, grid_height);
+    {
+        typename G::template GridAccessor<sycl::access::mode::discard_write> ac(grid);
+        for (stencil::uindex_t c = 0; c < grid_width; c++) {
+            for (stencil::uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = CodedCell{coded_value(c, r)};
+            }
+        }
+    }
+
+    {
+        typename G::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+        for (stencil::uindex_t c = 0; c < grid_width; c++) {
+            for (stencil::uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac[c][r].value == stored_value(coded_value(c, r)));
+                ac[c][r].value += 1.0;
+            }
+        }
+    }
+
+    sycl::buffer<CodedCell, 2> out_buffer = sycl::range<2>(grid_width, grid_height);
+    grid.copy_to_buffer(out_buffer);
+    {
+        sycl::host_accessor ac(out_buffer, sycl::read_only);
+        for (stencil::uindex_t c = 0; c < grid_width; c++) {
+            for (stencil::uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac[c][r].value == stored_value(stored_value(coded_value(c, r)) + 1.0));
+            }
+        }
+    }
+
+    sycl::queue queue;
+    sycl::buffer<double, 2> values = grid.template project<&CodedCell::value>(queue);
+    sycl::host_accessor values_ac(values, sycl::read_only);
+    for (stencil::uindex_t c = 0; c < grid_width; c++) {
+        for (stencil::uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(values_ac[c][r] == stored_value(stored_value(coded_value(c, r)) + 1.0));
+        }
+    }
+
+    // Generated cells are encoded before they are stored.
+    G generated(grid_width, grid_height);
+    auto generator = [](stencil::uindex_t c, stencil::uindex_t r) {
+        return CodedCell{coded_value(c, r)};
+    };
+    generated.generate(queue, generator).wait();
+    typename G::template GridAccessor<sycl::access::mode::read> generated_ac(generated);
+    for (stencil::uindex_t c = 0; c < grid_width; c++) {
+        for (stencil::uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(generated_ac[c][r].value == stored_value(coded_value(c, r)));
+        }
+    }
+}
+
+} // namespace grid_test
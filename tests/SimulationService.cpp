@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "StencilUpdateTest.hpp"
+#include "TransFuncs.hpp"
+#include "constants.hpp"
+#include <StencilStream/SimulationService.hpp>
+#include <StencilStream/cpu/StencilUpdate.hpp>
+#include <catch2/catch_all.hpp>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace sycl;
+using namespace stencil;
+
+using CPUUpdate = cpu::StencilUpdate<FPGATransFunc<1>>;
+using Service = SimulationService<CPUUpdate>;
+using GridImpl = Service::GridImpl;
+using Accessor = GridImpl::GridAccessor<access::mode::read_write>;
+
+struct Submission {
+    uindex_t grid_width;
+    uindex_t grid_height;
+    uindex_t iteration_offset;
+    uindex_t n_iterations;
+    std::future<GridImpl> result;
+};
+
+Submission submit_job(Service &service, uindex_t grid_width, uindex_t grid_height,
+                      uindex_t iteration_offset, uindex_t n_iterations) {
+    GridImpl grid(grid_width, grid_height);
+    {
+        Accessor ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] =
+                    Cell{index_t(c), index_t(r), index_t(iteration_offset), 0, CellStatus::Normal};
+            }
+        }
+    }
+    return Submission{grid_width, grid_height, iteration_offset, n_iterations,
+                      service.submit(grid, {.transition_function = FPGATransFunc<1>(),
+                                            .halo_value = Cell::halo(),
+                                            .iteration_offset = iteration_offset,
+                                            .n_iterations = n_iterations})};
+}
+
+void check_result(Submission &submission) {
+    GridImpl grid = submission.result.get();
+    REQUIRE(grid.get_grid_width() == submission.grid_width);
+    REQUIRE(grid.get_grid_height() == submission.grid_height);
+
+    Accessor ac(grid);
+    for (uindex_t c = 0; c < submission.grid_width; c++) {
+        for (uindex_t r = 0; r < submission.grid_height; r++) {
+            REQUIRE(ac[c][r].c == c);
+            REQUIRE(ac[c][r].r == r);
+            REQUIRE(ac[c][r].i_iteration ==
+                    submission.iteration_offset + submission.n_iterations);
+            REQUIRE(ac[c][r].status == CellStatus::Normal);
+        }
+    }
+}
+
+TEST_CASE("SimulationService", "[SimulationService]") {
+    Service service({sycl::device(), sycl::device()}, 2);
+    REQUIRE(service.get_n_workers() == 4);
+
+    // Two threads submit jobs with different grid sizes and iterations at the same time.
+    constexpr uindex_t n_jobs_per_thread = 8;
+    std::vector<Submission> submissions[2];
+    auto submit_jobs = [&](uindex_t i_thread) {
+        for (uindex_t i_job = 0; i_job < n_jobs_per_thread; i_job++) {
+            submissions[i_thread].push_back(submit_job(service, 16 + 8 * i_job + i_thread,
+                                                       32 - i_job, i_thread, 1 + i_job % 3));
+        }
+    };
+    std::thread other_thread(submit_jobs, 1);
+    submit_jobs(0);
+    other_thread.join();
+    REQUIRE(service.get_n_submitted_jobs() == 2 * n_jobs_per_thread);
+
+    uindex_t n_expected_cells = 0;
+    for (std::vector<Submission> &thread_submissions : submissions) {
+        for (Submission &submission : thread_submissions) {
+            check_result(submission);
+            n_expected_cells +=
+                submission.grid_width * submission.grid_height * submission.n_iterations;
+        }
+    }
+
+    service.wait();
+    REQUIRE(service.get_n_completed_jobs() == 2 * n_jobs_per_thread);
+    REQUIRE(service.get_n_processed_cells() == n_expected_cells);
+}
+
+TEST_CASE("SimulationService (failing jobs)", "[SimulationService]") {
+    REQUIRE_THROWS_AS(Service({}), std::invalid_argument);
+    REQUIRE_THROWS_AS(Service({sycl::device()}, 0), std::invalid_argument);
+
+    Service service({sycl::device()});
+    GridImpl grid(16, 16);
+    std::future<GridImpl> failed_job =
+        service.submit(grid, {.transition_function = FPGATransFunc<1>(), .temporal_block = 0});
+    REQUIRE_THROWS_AS(failed_job.get(), std::invalid_argument);
+
+    // The worker recovers and computes the following jobs.
+    Submission submission = submit_job(service, 16, 16, 0, 2);
+    check_result(submission);
+    service.wait();
+    REQUIRE(service.get_n_completed_jobs() == 2);
+    REQUIRE(service.get_n_processed_cells() == 16 * 16 * 2);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "TransFuncs.hpp"
+#include "constants.hpp"
+#include <StencilStream/Snapshots.hpp>
+#include <StencilStream/cpu/StencilUpdate.hpp>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace sycl;
+using namespace stencil;
+
+using TestUpdate = cpu::StencilUpdate<FPGATransFunc<1>>;
+using TestGrid = TestUpdate::GridImpl;
+
+TestGrid make_snapshot_input(uindex_t iteration_offset) {
+    TestGrid grid(tile_width, tile_height);
+    TestGrid::GridAccessor<access::mode::read_write> ac(grid);
+    for (uindex_t c = 0; c < tile_width; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            ac[c][r] = Cell{index_t(c), index_t(r), index_t(iteration_offset), 0,
+                            CellStatus::Normal};
+        }
+    }
+    return grid;
+}
+
+bool has_iteration(TestGrid &grid, uindex_t i_iteration) {
+    TestGrid::GridAccessor<access::mode::read> ac(grid);
+    bool is_valid = true;
+    for (uindex_t c = 0; c < tile_width; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            is_valid &= ac[c][r].c == c && ac[c][r].r == r;
+            is_valid &= ac[c][r].i_iteration == i_iteration && ac[c][r].i_subiteration == 0;
+            is_valid &= ac[c][r].status == CellStatus::Normal;
+        }
+    }
+    return is_valid;
+}
+
+TEST_CASE("run_with_snapshots", "[run_with_snapshots]") {
+    uindex_t iteration_offset = 3;
+    TestUpdate update({.transition_function = FPGATransFunc<1>(),
+                       .halo_value = Cell::halo(),
+                       .iteration_offset = iteration_offset,
+                       .n_iterations = 1,
+                       .blocking = true});
+    TestGrid source_grid = make_snapshot_input(iteration_offset);
+
+    for (uindex_t max_pending_snapshots : {1, 2, 3}) {
+        std::vector<uindex_t> snapshot_iterations;
+        std::vector<bool> snapshots_valid;
+        auto callback = [&](TestGrid &grid, uindex_t i_iteration) {
+            // A slow callback must not see grids that have been overwritten by later intervals.
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            snapshot_iterations.push_back(i_iteration);
+            snapshots_valid.push_back(has_iteration(grid, i_iteration));
+        };
+
+        TestGrid output_grid =
+            run_with_snapshots(update, source_grid, 10, 3, callback, max_pending_snapshots);
+
+        REQUIRE(snapshot_iterations == std::vector<uindex_t>{6, 9, 12, 13});
+        REQUIRE(snapshots_valid == std::vector<bool>{true, true, true, true});
+        REQUIRE(has_iteration(output_grid, iteration_offset + 10));
+        REQUIRE(has_iteration(source_grid, iteration_offset));
+
+        // The parameters are restored.
+        REQUIRE(update.get_params().iteration_offset == iteration_offset);
+        REQUIRE(update.get_params().n_iterations == 1);
+        REQUIRE(update.get_params().blocking);
+    }
+}
+
+TEST_CASE("run_with_snapshots (errors)", "[run_with_snapshots]") {
+    TestUpdate update({.transition_function = FPGATransFunc<1>(), .halo_value = Cell::halo()});
+    TestGrid source_grid = make_snapshot_input(0);
+    auto noop = [](TestGrid &, uindex_t) {};
+
+    REQUIRE_THROWS_AS(run_with_snapshots(update, source_grid, 4, 0, noop), std::invalid_argument);
+    REQUIRE_THROWS_AS(run_with_snapshots(update, source_grid, 4, 1, noop, 0),
+                      std::invalid_argument);
+
+    // Exceptions of the callback stop the computation and are passed on.
+    uindex_t n_snapshots = 0;
+    auto failing_callback = [&](TestGrid &, uindex_t) {
+        n_snapshots++;
+        throw std::runtime_error("Disk full");
+    };
+    REQUIRE_THROWS_AS(run_with_snapshots(update, source_grid, 100, 1, failing_callback, 1),
+                      std::runtime_error);
+    REQUIRE(n_snapshots == 1);
+    REQUIRE(update.get_params().n_iterations == 1);
+}
@@ -22,14 +22,23 @@
  */
 #pragma once
 #include "TransFuncs.hpp"
+#include "constants.hpp"
+#include <StencilStream/BoundaryCondition.hpp>
 #include <StencilStream/Concepts.hpp>
+#include <StencilStream/HistoryTransitionFunction.hpp>
+#include <StencilStream/KernelCounters.hpp>
+#include <StencilStream/Timeline.hpp>
+#include <sstream>
+#include <type_traits>
+#include <vector>
 
 using namespace sycl;
 using namespace stencil;
 
 template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
-void test_stencil_update(stencil::uindex_t grid_width, uindex_t grid_height,
-                         uindex_t iteration_offset, uindex_t n_iterations) {
+void test_stencil_update(stencil::uindex_t grid_width, uindex_t grid_height, SU &update) {
+    uindex_t iteration_offset = update.get_params().iteration_offset;
+    uindex_t n_iterations = update.get_params().n_iterations;
 
     using Accessor = Grid::template GridAccessor<access::mode::read_write>;
 
@@ -44,21 +53,821 @@ void test_stencil_update(stencil::uindex_t grid_width, uindex_t grid_height,
         }
     }
 
+    Grid output_grid = update(input_grid);
+
+    Accessor ac(output_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r].c == c);
+            REQUIRE(ac[c][r].r == r);
+            REQUIRE(ac[c][r].i_iteration == iteration_offset + n_iterations);
+            REQUIRE(ac[c][r].i_subiteration == 0);
+            REQUIRE(ac[c][r].status == CellStatus::Normal);
+        }
+    }
+}
+
+template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
+void test_stencil_update(stencil::uindex_t grid_width, uindex_t grid_height,
+                         typename SU::Params params) {
+    SU update(params);
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+}
+
+template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
+void test_stencil_update(stencil::uindex_t grid_width, uindex_t grid_height,
+                         uindex_t iteration_offset, uindex_t n_iterations) {
+    test_stencil_update<Grid, SU>(grid_width, grid_height,
+                                  {.transition_function = FPGATransFunc<1>(),
+                                   .halo_value = Cell::halo(),
+                                   .iteration_offset = iteration_offset,
+                                   .n_iterations = n_iterations});
+}
+
+template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
+void test_warm_up(stencil::uindex_t grid_width, uindex_t grid_height, uindex_t n_iterations) {
+    SU update({.transition_function = FPGATransFunc<1>(),
+               .halo_value = Cell::halo(),
+               .iteration_offset = 0,
+               .n_iterations = n_iterations});
+
+    update.warm_up();
+    REQUIRE(update.get_n_processed_cells() == 0);
+    REQUIRE(update.get_walltime() == 0.0);
+    REQUIRE(update.get_params().n_iterations == n_iterations);
+
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    REQUIRE(update.get_n_processed_cells() == n_iterations * grid_width * grid_height);
+
+    // The queues are kept, so a second update with the same updater also works.
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+}
+
+template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
+void test_grid_pool(stencil::uindex_t grid_width, uindex_t grid_height, uindex_t n_iterations) {
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+
+    SU update({.transition_function = FPGATransFunc<1>(),
+               .halo_value = Cell::halo(),
+               .iteration_offset = 0,
+               .n_iterations = n_iterations});
+
+    // The output grids are released after every call, so both swap grids are reused.
+    for (uindex_t i = 0; i < 3; i++) {
+        test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+        REQUIRE(update.get_grid_pool()->get_n_grids() == 2);
+    }
+
+    // When the output of the previous call is used as the input of the next call, one additional
+    // grid is needed, but no more.
+    Grid grid(grid_width, grid_height);
+    {
+        Accessor ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = Cell{index_t(c), index_t(r), 0, 0, CellStatus::Normal};
+            }
+        }
+    }
+    for (uindex_t i = 0; i < 4; i++) {
+        update.get_params().iteration_offset = i * n_iterations;
+        grid = update(grid);
+    }
+    REQUIRE(update.get_grid_pool()->get_n_grids() == 3);
+
+    Accessor ac(grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r].i_iteration == 4 * n_iterations);
+            REQUIRE(ac[c][r].status == CellStatus::Normal);
+        }
+    }
+
+    // Updaters may share their pools.
+    SU other_update(update.get_params());
+    other_update.set_grid_pool(update.get_grid_pool());
+    REQUIRE(other_update.get_grid_pool() == update.get_grid_pool());
+}
+
+template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
+void test_overwrite_source(stencil::uindex_t grid_width, uindex_t grid_height,
+                           uindex_t n_iterations) {
+    SU update({.transition_function = FPGATransFunc<1>(),
+               .halo_value = Cell::halo(),
+               .iteration_offset = 0,
+               .n_iterations = n_iterations,
+               .overwrite_source = true});
+
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    REQUIRE(update.get_grid_pool()->get_n_grids() == 1);
+}
+
+template <concepts::Grid<Cell> Grid, concepts::StencilUpdate<FPGATransFunc<1>, Grid> SU>
+void test_timeline(stencil::uindex_t grid_width, uindex_t grid_height, uindex_t n_iterations,
+                   uindex_t n_kernels_per_pass) {
+    SU update({.transition_function = FPGATransFunc<1>(),
+               .halo_value = Cell::halo(),
+               .iteration_offset = 0,
+               .n_iterations = n_iterations,
+               .profiling = true});
+
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    std::vector<TimelineEvent> events = update.get_timeline().get_events();
+    REQUIRE(events.size() == update.get_timeline().size());
+
+    uindex_t n_passes = n_cells_to_n_words(n_iterations, iters_per_pass);
+    std::vector<uindex_t> n_reads(n_passes, 0), n_computes(n_passes, 0), n_writes(n_passes, 0),
+        n_submits(n_passes, 0);
+    uindex_t n_allocations = 0;
+    for (uindex_t i_event = 0; i_event < events.size(); i_event++) {
+        TimelineEvent const &event = events[i_event];
+        REQUIRE(event.start <= event.end);
+        if (i_event > 0) {
+            REQUIRE(events[i_event - 1].start <= event.start);
+        }
+        if (event.name == "allocate") {
+            REQUIRE(!event.on_device);
+            n_allocations++;
+            continue;
+        }
+
+        REQUIRE(event.pass < n_passes);
+        REQUIRE(event.iteration_begin == event.pass * iters_per_pass);
+        REQUIRE(event.iteration_end == std::min((event.pass + 1) * iters_per_pass, n_iterations));
+        if (event.name == "submit") {
+            REQUIRE(!event.on_device);
+            n_submits[event.pass]++;
+        } else {
+            REQUIRE(event.on_device);
+            if (event.name == "read") {
+                n_reads[event.pass]++;
+            } else if (event.name == "compute") {
+                n_computes[event.pass]++;
+            } else if (event.name == "write") {
+                n_writes[event.pass]++;
+            }
+        }
+    }
+    REQUIRE(n_allocations == 1);
+    for (uindex_t i_pass = 0; i_pass < n_passes; i_pass++) {
+        REQUIRE(n_reads[i_pass] == n_kernels_per_pass);
+        REQUIRE(n_computes[i_pass] == n_kernels_per_pass);
+        REQUIRE(n_writes[i_pass] == n_kernels_per_pass);
+        REQUIRE(n_submits[i_pass] == 1);
+    }
+
+    std::ostringstream trace;
+    update.get_timeline().write_chrome_trace(trace);
+    REQUIRE(trace.str().starts_with("{\"traceEvents\":["));
+    REQUIRE(trace.str().find("\"name\":\"compute\"") != std::string::npos);
+
+    // Without profiling, nothing is recorded.
+    update.get_timeline().clear();
+    update.get_params().profiling = false;
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    REQUIRE(update.get_timeline().size() == 0);
+}
+
+template <typename Grid, typename SU>
+    requires concepts::StencilUpdate<SU, FPGATransFunc<1>, Grid>
+void test_kernel_counters(stencil::uindex_t grid_width, uindex_t grid_height,
+                          uindex_t n_iterations, bool on_chip_loopback = false) {
     SU update({.transition_function = FPGATransFunc<1>(),
                .halo_value = Cell::halo(),
-               .iteration_offset = iteration_offset,
+               .iteration_offset = 0,
                .n_iterations = n_iterations});
 
+    // Before the first call, all counters are zero.
+    StencilUpdateCounters counters = update.get_kernel_counters();
+    REQUIRE(counters.read.n_cells == 0);
+    REQUIRE(counters.compute.n_active_cycles == 0);
+    REQUIRE(counters.write.n_cells == 0);
+
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+
+    // With an on-chip loopback, the grid only streams through the pipes once per call.
+    uint64_t n_transfers =
+        on_chip_loopback ? 1 : n_cells_to_n_words(n_iterations, iters_per_pass);
+    uint64_t n_cells = grid_width * grid_height * n_transfers;
+    counters = update.get_kernel_counters();
+    for (KernelCounters const &kernel_counters :
+         {counters.read, counters.compute, counters.write}) {
+        REQUIRE(kernel_counters.n_active_cycles > 0);
+    }
+    // The input kernels may also send halo cells.
+    REQUIRE(counters.read.n_cells >= n_cells);
+    REQUIRE(counters.compute.n_cells == n_cells);
+    REQUIRE(counters.write.n_cells == n_cells);
+
+    // The counters are reset with every call.
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    REQUIRE(update.get_kernel_counters().write.n_cells == n_cells);
+}
+
+template <typename Grid, typename SU>
+    requires concepts::StencilUpdate<SU, FPGATransFunc<1>, Grid>
+void test_efficiency(stencil::uindex_t grid_width, uindex_t grid_height, uindex_t n_iterations) {
+    SU update({.transition_function = FPGATransFunc<1>(),
+               .halo_value = Cell::halo(),
+               .iteration_offset = 0,
+               .n_iterations = n_iterations,
+               .profiling = true,
+               .clock_frequency = 1e9});
+    REQUIRE(!update.get_efficiency().has_value());
+
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    std::optional<double> efficiency = update.get_efficiency();
+    REQUIRE(efficiency.has_value());
+    REQUIRE(*efficiency > 0.0);
+
+    // Warming up doesn't replace the efficiency of the last call.
+    update.warm_up();
+    REQUIRE(update.get_efficiency() == efficiency);
+
+    // Without profiling or a clock frequency, there's no measured or modeled runtime.
+    update.get_params().profiling = false;
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    REQUIRE(!update.get_efficiency().has_value());
+
+    update.get_params().profiling = true;
+    update.get_params().clock_frequency = std::nullopt;
+    test_stencil_update<Grid, SU>(grid_width, grid_height, update);
+    REQUIRE(!update.get_efficiency().has_value());
+
+    // The queues of an updater that starts without profiling are rebuilt once it's enabled.
+    SU late_update({.transition_function = FPGATransFunc<1>(),
+                    .halo_value = Cell::halo(),
+                    .iteration_offset = 0,
+                    .n_iterations = n_iterations,
+                    .profiling = false,
+                    .clock_frequency = 1e9});
+    test_stencil_update<Grid, SU>(grid_width, grid_height, late_update);
+    late_update.get_params().profiling = true;
+    test_stencil_update<Grid, SU>(grid_width, grid_height, late_update);
+    REQUIRE(late_update.get_efficiency().has_value());
+}
+
+template <typename SU>
+    requires concepts::StencilUpdate<SU, StaticValueTransFunc, typename SU::GridImpl>
+void test_static_values(stencil::uindex_t grid_width, uindex_t grid_height,
+                        typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using StaticGrid = typename SU::StaticGridImpl;
+
+    auto static_value = [grid_height](uindex_t c, uindex_t r) {
+        return index_t(c * grid_height + r + 1);
+    };
+
+    Grid input_grid(grid_width, grid_height);
+    StaticGrid static_grid(grid_width, grid_height);
+    {
+        typename Grid::template GridAccessor<access::mode::read_write> ac(input_grid);
+        typename StaticGrid::template GridAccessor<access::mode::read_write> static_ac(
+            static_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = 0;
+                static_ac[c][r] = static_value(c, r);
+            }
+        }
+    }
+
+    SU update(params);
+
+    // The static grid is mandatory if the transition function uses static values.
+    REQUIRE_THROWS_AS(update(input_grid), std::invalid_argument);
+    update.set_static_grid(StaticGrid(grid_width + 1, grid_height));
+    REQUIRE_THROWS_AS(update(input_grid), std::range_error);
+
+    update.set_static_grid(static_grid);
+    update.warm_up();
+    Grid output_grid = update(input_grid);
+
+    typename Grid::template GridAccessor<access::mode::read_write> ac(output_grid);
+    typename StaticGrid::template GridAccessor<access::mode::read_write> static_ac(static_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r] == index_t(params.n_iterations) * static_value(c, r));
+            REQUIRE(static_ac[c][r] == static_value(c, r));
+        }
+    }
+}
+
+template <uindex_t n_subiterations, typename SU>
+void test_history(uindex_t grid_width, uindex_t grid_height, typename SU::Params params) {
+    using TransFunc = HistoryTransitionFunction<HistoryTransFunc<n_subiterations>>;
+    using Grid = typename SU::GridImpl;
+
+    // Compute the expected values on the host. All past levels start with the initial value.
+    std::vector<index_t> expected(grid_width * grid_height);
+    Grid input_grid(grid_width, grid_height);
+    {
+        typename Grid::template GridAccessor<access::mode::read_write> ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                index_t value = index_t(c * grid_height + r) % 7;
+                ac[c][r] = TransFunc::with_history(value);
+
+                index_t previous = value, before_previous = value;
+                for (uindex_t i = 0; i < params.n_iterations; i++) {
+                    index_t next = value;
+                    for (uindex_t s = 0; s < n_subiterations; s++) {
+                        next += 2 * previous + 2 * before_previous;
+                    }
+                    before_previous = previous;
+                    previous = value;
+                    value = next;
+                }
+                expected[c * grid_height + r] = value;
+            }
+        }
+    }
+
+    SU update(params);
+    Grid output_grid = update(input_grid);
+
+    typename Grid::template GridAccessor<access::mode::read> ac(output_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r].cell == expected[c * grid_height + r]);
+        }
+    }
+}
+
+template <typename SU>
+    requires concepts::StencilUpdate<SU, ConstantTableTransFunc, typename SU::GridImpl>
+void test_constant_table(stencil::uindex_t grid_width, uindex_t grid_height,
+                         typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = typename Grid::template GridAccessor<access::mode::read_write>;
+
+    Grid input_grid(grid_width, grid_height);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = 0;
+            }
+        }
+    }
+
+    SU update(params);
+    for (index_t factor : {index_t(1), index_t(-3)}) {
+        for (uindex_t i = 0; i < ConstantTableTransFunc::ConstantTable::size; i++) {
+            update.get_params().constant_table[i] = factor * index_t(i + 1);
+        }
+        Grid output_grid = update(input_grid);
+
+        // The table is read from the parameters of every update.
+        Accessor ac(output_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                index_t entry = factor * index_t((c + r) % 4 + 1);
+                REQUIRE(ac[c][r] == index_t(params.n_iterations) * entry);
+            }
+        }
+    }
+}
+
+template <StencilShape shape, typename SU>
+    requires concepts::StencilUpdate<SU, ShapedTransFunc<shape>, typename SU::GridImpl>
+void test_stencil_shape(stencil::uindex_t grid_width, uindex_t grid_height,
+                        typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+    using TransFunc = ShapedTransFunc<shape>;
+
+    // Compute the expected result on the host, with a halo of two cells around the grid.
+    std::vector<index_t> expected((grid_width + 4) * (grid_height + 4), params.halo_value);
+    auto cell = [&](index_t c, index_t r) -> index_t & {
+        return expected[(c + 2) * (grid_height + 4) + (r + 2)];
+    };
+
+    Grid input_grid(grid_width, grid_height);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = index_t((7 * c + 3 * r) % TransFunc::modulus);
+                cell(c, r) = ac[c][r];
+            }
+        }
+    }
+
+    for (uindex_t i = 0; i < params.n_iterations; i++) {
+        std::vector<index_t> previous = expected;
+        for (index_t c = 0; c < index_t(grid_width); c++) {
+            for (index_t r = 0; r < index_t(grid_height); r++) {
+                index_t new_cell = 0;
+                for (index_t stencil_c = -2; stencil_c <= 2; stencil_c++) {
+                    for (index_t stencil_r = -2; stencil_r <= 2; stencil_r++) {
+                        if (shape.contains(stencil_c, stencil_r)) {
+                            index_t value = previous[(c + stencil_c + 2) * (grid_height + 4) +
+                                                     (r + stencil_r + 2)];
+                            new_cell += value * (5 * (stencil_c + 2) + (stencil_r + 2) + 1);
+                        }
+                    }
+                }
+                cell(c, r) = new_cell % TransFunc::modulus;
+            }
+        }
+    }
+
+    SU update(params);
+    Grid output_grid = update(input_grid);
+
+    Accessor ac(output_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r] == cell(c, r));
+        }
+    }
+}
+
+/**
+ * \brief The transition function of \ref test_boundary_condition.
+ *
+ * With a history, the transition function is wrapped in a \ref HistoryTransitionFunction, which
+ * has to pass the boundary condition on to the updaters.
+ */
+template <StencilShape shape, BoundaryCondition boundary_condition, bool with_history>
+using BoundaryTransFunc =
+    std::conditional_t<with_history,
+                       HistoryTransitionFunction<ShapedHistoryTransFunc<shape, boundary_condition>>,
+                       ShapedTransFunc<shape, boundary_condition>>;
+
+template <StencilShape shape, BoundaryCondition boundary_condition, typename SU,
+          bool with_history = false>
+    requires concepts::StencilUpdate<SU, BoundaryTransFunc<shape, boundary_condition, with_history>,
+                                     typename SU::GridImpl>
+void test_boundary_condition(stencil::uindex_t grid_width, uindex_t grid_height,
+                             typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+    using TransFunc = BoundaryTransFunc<shape, boundary_condition, with_history>;
+    constexpr index_t modulus = ShapedTransFunc<shape, boundary_condition>::modulus;
+
+    std::vector<index_t> expected(grid_width * grid_height);
+    Grid input_grid(grid_width, grid_height);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                index_t value = index_t((7 * c + 3 * r) % modulus);
+                if constexpr (with_history) {
+                    ac[c][r] = TransFunc::with_history(value);
+                } else {
+                    ac[c][r] = value;
+                }
+                expected[c * grid_height + r] = value;
+            }
+        }
+    }
+
+    // Compute the expected result on the host, with every read outside of the grid mapped back
+    // into it. The past level of the first iteration is the initial value.
+    std::vector<index_t> before_previous = expected;
+    for (uindex_t i = 0; i < params.n_iterations; i++) {
+        std::vector<index_t> previous = expected;
+        for (index_t c = 0; c < index_t(grid_width); c++) {
+            for (index_t r = 0; r < index_t(grid_height); r++) {
+                index_t new_cell = with_history ? before_previous[c * grid_height + r] : 0;
+                for (index_t stencil_c = -2; stencil_c <= 2; stencil_c++) {
+                    for (index_t stencil_r = -2; stencil_r <= 2; stencil_r++) {
+                        if (shape.contains(stencil_c, stencil_r)) {
+                            index_t source_c = apply_boundary_condition(boundary_condition,
+                                                                        c + stencil_c, grid_width);
+                            index_t source_r = apply_boundary_condition(boundary_condition,
+                                                                        r + stencil_r, grid_height);
+                            index_t value = previous[source_c * grid_height + source_r];
+                            new_cell += value * (5 * (stencil_c + 2) + (stencil_r + 2) + 1);
+                        }
+                    }
+                }
+                expected[c * grid_height + r] = new_cell % modulus;
+            }
+        }
+        before_previous = previous;
+    }
+
+    SU update(params);
     Grid output_grid = update(input_grid);
 
+    Accessor ac(output_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            if constexpr (with_history) {
+                REQUIRE(ac[c][r].cell == expected[c * grid_height + r]);
+            } else {
+                REQUIRE(ac[c][r] == expected[c * grid_height + r]);
+            }
+        }
+    }
+}
+
+/**
+ * \brief Apply one sub-iteration of a transition function to cells with a halo of two cells.
+ */
+template <typename F>
+void apply_on_host(F const &trans_func, std::vector<index_t> &cells, uindex_t grid_width,
+                   uindex_t grid_height, uindex_t iteration, uindex_t subiteration) {
+    using HostStencil = Stencil<index_t, F::stencil_radius, typename F::TimeDependentValue>;
+    constexpr index_t offset = 2 - index_t(F::stencil_radius);
+    std::vector<index_t> previous = cells;
+    for (index_t c = 0; c < index_t(grid_width); c++) {
+        for (index_t r = 0; r < index_t(grid_height); r++) {
+            HostStencil stencil(ID(c, r), UID(grid_width, grid_height), iteration, subiteration,
+                                trans_func.get_time_dependent_value(iteration));
+            for (uindex_t stencil_c = 0; stencil_c < HostStencil::diameter; stencil_c++) {
+                for (uindex_t stencil_r = 0; stencil_r < HostStencil::diameter; stencil_r++) {
+                    stencil[UID(stencil_c, stencil_r)] =
+                        previous[(c + stencil_c + offset) * (grid_height + 4) +
+                                 (r + stencil_r + offset)];
+                }
+            }
+            cells[(c + 2) * (grid_height + 4) + (r + 2)] = trans_func(stencil);
+        }
+    }
+}
+
+template <typename SU>
+    requires concepts::StencilUpdate<SU, ChainedTransFunc, typename SU::GridImpl>
+void test_chained_trans_func(stencil::uindex_t grid_width, uindex_t grid_height,
+                             typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+    using FirstTransFunc = ShapedTransFunc<StencilShape::star(2)>;
+    static_assert(ChainedTransFunc::stencil_radius == 2);
+    static_assert(ChainedTransFunc::stencil_shape == StencilShape::star(2));
+    static_assert(ChainedTransFunc::n_subiterations == 5);
+
+    // Compute the expected result by applying the stages one after another, with a halo of two
+    // cells around the grid.
+    std::vector<index_t> expected((grid_width + 4) * (grid_height + 4), params.halo_value);
+    Grid input_grid(grid_width, grid_height);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = index_t((7 * c + 3 * r) % FirstTransFunc::modulus);
+                expected[(c + 2) * (grid_height + 4) + (r + 2)] = ac[c][r];
+            }
+        }
+    }
+
+    for (uindex_t i = params.iteration_offset; i < params.iteration_offset + params.n_iterations;
+         i++) {
+        apply_on_host(FirstTransFunc(), expected, grid_width, grid_height, i, 0);
+        for (uindex_t i_repetition = 0; i_repetition < 2; i_repetition++) {
+            for (uindex_t i_subiteration = 0; i_subiteration < 2; i_subiteration++) {
+                apply_on_host(TimedTransFunc(), expected, grid_width, grid_height,
+                              2 * i + i_repetition, i_subiteration);
+            }
+        }
+    }
+
+    SU update(params);
+    Grid output_grid = update(input_grid);
+
+    Accessor ac(output_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r] == expected[(c + 2) * (grid_height + 4) + (r + 2)]);
+        }
+    }
+}
+
+template <typename SU>
+    requires concepts::StencilUpdate<SU, ReducingTransFunc<1>, typename SU::GridImpl>
+void test_reduction(stencil::uindex_t grid_width, uindex_t grid_height,
+                    typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+
+    Grid input_grid(grid_width, grid_height);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = Cell{index_t(c), index_t(r), index_t(params.iteration_offset), 0,
+                                CellStatus::Normal};
+            }
+        }
+    }
+
+    // Nothing is reduced unless a reduction is requested.
+    params.reduction = std::nullopt;
+    SU update(params);
+    update(input_grid);
+    REQUIRE(!update.get_reduction_result().has_value());
+
+    update.get_params().reduction = CellSummaryReduction();
+    update.warm_up();
+    Grid output_grid = update(input_grid);
+    std::optional<CellSummary> summary = update.get_reduction_result();
+    REQUIRE(summary.has_value());
+    REQUIRE(summary->n_normal_cells == index_t(grid_width * grid_height));
+    REQUIRE(summary->c_sum == index_t(grid_height * grid_width * (grid_width - 1) / 2));
+    REQUIRE(summary->r_sum == index_t(grid_width * grid_height * (grid_height - 1) / 2));
+    REQUIRE(summary->max_iteration == index_t(params.iteration_offset + params.n_iterations));
+
     Accessor ac(output_grid);
     for (uindex_t c = 0; c < grid_width; c++) {
         for (uindex_t r = 0; r < grid_height; r++) {
             REQUIRE(ac[c][r].c == c);
             REQUIRE(ac[c][r].r == r);
-            REQUIRE(ac[c][r].i_iteration == iteration_offset + n_iterations);
-            REQUIRE(ac[c][r].i_subiteration == 0);
+            REQUIRE(ac[c][r].i_iteration == params.iteration_offset + params.n_iterations);
             REQUIRE(ac[c][r].status == CellStatus::Normal);
         }
     }
+
+    // Without iterations, there's no last pass to reduce.
+    update.get_params().n_iterations = 0;
+    update(input_grid);
+    REQUIRE(!update.get_reduction_result().has_value());
+}
+
+template <typename SU>
+    requires concepts::StencilUpdate<SU, ReducingTransFunc<1>, typename SU::GridImpl>
+void test_run_until(stencil::uindex_t grid_width, uindex_t grid_height,
+                    typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+
+    Grid input_grid(grid_width, grid_height);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = Cell{index_t(c), index_t(r), index_t(params.iteration_offset), 0,
+                                CellStatus::Normal};
+            }
+        }
+    }
+    auto check_grid = [&](Grid &grid, uindex_t n_iterations) {
+        Accessor ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac[c][r].c == c);
+                REQUIRE(ac[c][r].r == r);
+                REQUIRE(ac[c][r].i_iteration == params.iteration_offset + n_iterations);
+                REQUIRE(ac[c][r].status == CellStatus::Normal);
+            }
+        }
+    };
+    index_t target_iteration = index_t(params.iteration_offset + 7);
+    auto predicate = [=](CellSummary const &summary) {
+        return summary.max_iteration >= target_iteration;
+    };
+
+    params.reduction = std::nullopt;
+    SU update(params);
+    REQUIRE_THROWS_AS(run_until(update, input_grid, predicate, 3, 20), std::invalid_argument);
+
+    update.get_params().reduction = CellSummaryReduction();
+    REQUIRE_THROWS_AS(run_until(update, input_grid, predicate, 0, 20), std::invalid_argument);
+    REQUIRE_THROWS_AS(run_until(update, input_grid, predicate, 3, 0), std::invalid_argument);
+
+    // The predicate is checked after 3, 6 and 9 iterations.
+    auto result = run_until(update, input_grid, predicate, 3, 20);
+    REQUIRE(result.converged);
+    REQUIRE(result.n_iterations == 9);
+    REQUIRE(result.reduction_value.max_iteration == index_t(params.iteration_offset + 9));
+    REQUIRE(result.reduction_value.n_normal_cells == index_t(grid_width * grid_height));
+    REQUIRE(update.get_reduction_result()->max_iteration == result.reduction_value.max_iteration);
+    REQUIRE(update.get_params().n_iterations == params.n_iterations);
+    REQUIRE(update.get_params().iteration_offset == params.iteration_offset);
+    check_grid(result.grid, 9);
+
+    // The last interval is shortened to the maximal number of iterations.
+    result = run_until(update, input_grid, predicate, 3, 5);
+    REQUIRE(!result.converged);
+    REQUIRE(result.n_iterations == 5);
+    REQUIRE(result.reduction_value.max_iteration == index_t(params.iteration_offset + 5));
+    check_grid(result.grid, 5);
+    check_grid(input_grid, 0);
+
+    // The parameters are also restored if the predicate throws.
+    auto throwing_predicate = [](CellSummary const &) -> bool {
+        throw std::runtime_error("predicate failed");
+    };
+    REQUIRE_THROWS_AS(run_until(update, input_grid, throwing_predicate, 3, 20),
+                      std::runtime_error);
+    REQUIRE(update.get_params().n_iterations == params.n_iterations);
+    REQUIRE(update.get_params().iteration_offset == params.iteration_offset);
+    REQUIRE(update.get_params().blocking == params.blocking);
+}
+
+template <typename SU, typename TF>
+    requires concepts::StencilUpdate3D<SU, TF, typename SU::GridImpl>
+void test_stencil_update_3d(uindex_t grid_width, uindex_t grid_height, uindex_t grid_depth,
+                            typename SU::Params params) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+    index_t radius = TF::stencil_radius;
+
+    std::vector<index_t> expected(grid_width * grid_height * grid_depth);
+    auto index = [&](index_t c, index_t r, index_t l) {
+        return (c * grid_height + r) * grid_depth + l;
+    };
+
+    Grid input_grid(grid_width, grid_height, grid_depth);
+    {
+        Accessor ac(input_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                for (uindex_t l = 0; l < grid_depth; l++) {
+                    ac[c][r][l] = index_t((7 * c + 5 * r + 3 * l) % TF::modulus);
+                    expected[index(c, r, l)] = ac[c][r][l];
+                }
+            }
+        }
+    }
+
+    // Compute the expected result on the host.
+    for (uindex_t i_step = 0; i_step < params.n_iterations * TF::n_subiterations; i_step++) {
+        std::vector<index_t> previous = expected;
+        uindex_t iteration = params.iteration_offset + i_step / TF::n_subiterations;
+        uindex_t subiteration = i_step % TF::n_subiterations;
+        for (index_t c = 0; c < index_t(grid_width); c++) {
+            for (index_t r = 0; r < index_t(grid_height); r++) {
+                for (index_t l = 0; l < index_t(grid_depth); l++) {
+                    index_t new_cell = iteration + subiteration;
+                    for (index_t sc = -radius; sc <= radius; sc++) {
+                        for (index_t sr = -radius; sr <= radius; sr++) {
+                            for (index_t sl = -radius; sl <= radius; sl++) {
+                                bool within_grid =
+                                    c + sc >= 0 && c + sc < index_t(grid_width) && r + sr >= 0 &&
+                                    r + sr < index_t(grid_height) && l + sl >= 0 &&
+                                    l + sl < index_t(grid_depth);
+                                index_t value = within_grid
+                                                    ? previous[index(c + sc, r + sr, l + sl)]
+                                                    : params.halo_value;
+                                new_cell += value * TF::weight(sc, sr, sl);
+                            }
+                        }
+                    }
+                    expected[index(c, r, l)] = new_cell % TF::modulus;
+                }
+            }
+        }
+    }
+
+    SU update(params);
+    Grid output_grid = update(input_grid);
+    REQUIRE(update.get_n_processed_cells() ==
+            params.n_iterations * grid_width * grid_height * grid_depth);
+
+    Accessor output_ac(output_grid);
+    Accessor input_ac(input_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            for (uindex_t l = 0; l < grid_depth; l++) {
+                REQUIRE(output_ac[c][r][l] == expected[index(c, r, l)]);
+                REQUIRE(input_ac[c][r][l] == index_t((7 * c + 5 * r + 3 * l) % TF::modulus));
+            }
+        }
+    }
+}
+
+template <typename SU, typename TF>
+    requires concepts::StencilUpdate3D<SU, TF, typename SU::GridImpl>
+void test_grid_pool_3d(uindex_t grid_width, uindex_t grid_height, uindex_t grid_depth) {
+    using Grid = typename SU::GridImpl;
+    using Accessor = Grid::template GridAccessor<access::mode::read_write>;
+
+    Grid grid(grid_width, grid_height, grid_depth);
+    {
+        Accessor ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                for (uindex_t l = 0; l < grid_depth; l++) {
+                    ac[c][r][l] = index_t(c + r + l);
+                }
+            }
+        }
+    }
+
+    SU update({.transition_function = TF(), .n_iterations = 0});
+    {
+        // Without iterations, the result is a copy and not an alias of the source grid.
+        Grid copy = update(grid);
+        REQUIRE(copy.get_buffer() != grid.get_buffer());
+        Accessor copy_ac(copy);
+        Accessor ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                for (uindex_t l = 0; l < grid_depth; l++) {
+                    REQUIRE(copy_ac[c][r][l] == ac[c][r][l]);
+                }
+            }
+        }
+    }
+
+    // Feeding the result back into the updater reuses the swap grids of the pool.
+    update.get_params().n_iterations = 2;
+    for (uindex_t i = 0; i < 4; i++) {
+        grid = update(grid);
+    }
+    REQUIRE(update.get_grid_pool()->get_n_grids() <= 3);
 }
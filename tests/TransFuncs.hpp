@@ -22,9 +22,16 @@
  */
 #pragma once
 #include <CL/sycl.hpp>
+#include <StencilStream/BoundaryCondition.hpp>
+#include <StencilStream/ChainTransitionFunction.hpp>
+#include <StencilStream/ConstantTable.hpp>
 #include <StencilStream/GenericID.hpp>
 #include <StencilStream/Index.hpp>
 #include <StencilStream/Stencil.hpp>
+#include <StencilStream/Stencil3D.hpp>
+#include <StencilStream/StencilShape.hpp>
+#include <algorithm>
+#include <array>
 #include <catch2/catch_all.hpp>
 
 enum class CellStatus {
@@ -161,4 +168,279 @@ template <stencil::uindex_t radius> class HostTransFunc {
 
         return new_cell;
     }
-};
\ No newline at end of file
+};
+
+class StaticValueTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = std::monostate;
+    using StaticValue = stencil::index_t;
+
+    static constexpr stencil::uindex_t stencil_radius = 1;
+    static constexpr stencil::uindex_t n_subiterations = 1;
+
+    std::monostate get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return std::monostate();
+    }
+
+    Cell operator()(
+        stencil::Stencil<Cell, 1, TimeDependentValue, StaticValue> const &stencil) const {
+        return stencil[stencil::ID(0, 0)] + stencil.static_value;
+    }
+};
+
+class ConstantTableTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = std::monostate;
+    using ConstantTable = stencil::ConstantTable<stencil::index_t, 4>;
+
+    static constexpr stencil::uindex_t stencil_radius = 1;
+    static constexpr stencil::uindex_t n_subiterations = 1;
+
+    std::monostate get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return std::monostate();
+    }
+
+    Cell operator()(stencil::Stencil<Cell, 1, TimeDependentValue, std::monostate,
+                                     ConstantTable> const &stencil) const {
+        return stencil[stencil::ID(0, 0)] +
+               stencil.constant_table()[(stencil.id.c + stencil.id.r) % ConstantTable::size];
+    }
+};
+
+/**
+ * A multistep scheme that adds the doubled values of the two previous iterations to the central
+ * cell in every sub-iteration.
+ */
+template <stencil::uindex_t n_subiters> class HistoryTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = std::monostate;
+    using HistoryValue = stencil::index_t;
+
+    static constexpr stencil::uindex_t stencil_radius = 1;
+    static constexpr stencil::uindex_t n_subiterations = n_subiters;
+    static constexpr stencil::uindex_t history_length = 2;
+
+    static HistoryValue history_value(Cell const &cell) { return 2 * cell; }
+
+    std::monostate get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return std::monostate();
+    }
+
+    Cell operator()(stencil::Stencil<Cell, 1, TimeDependentValue, std::monostate, std::monostate,
+                                     std::array<HistoryValue, 2>> const &stencil) const {
+        return stencil[stencil::ID(0, 0)] + stencil.previous(1) + stencil.previous(2);
+    }
+};
+
+struct CellSummary {
+    stencil::index_t n_normal_cells;
+    stencil::index_t c_sum;
+    stencil::index_t r_sum;
+    stencil::index_t max_iteration;
+};
+
+struct CellSummaryReduction {
+    using Value = CellSummary;
+
+    Value identity() const { return CellSummary{0, 0, 0, 0}; }
+
+    Value map(Cell const &cell) const {
+        return CellSummary{cell.status == CellStatus::Normal ? 1 : 0, cell.c, cell.r,
+                           cell.i_iteration};
+    }
+
+    Value combine(Value const &a, Value const &b) const {
+        return CellSummary{a.n_normal_cells + b.n_normal_cells, a.c_sum + b.c_sum,
+                           a.r_sum + b.r_sum, std::max(a.max_iteration, b.max_iteration)};
+    }
+};
+
+template <stencil::uindex_t radius> class ReducingTransFunc : public FPGATransFunc<radius> {
+  public:
+    using Reduction = CellSummaryReduction;
+};
+
+class MaxSpreadTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = std::monostate;
+
+    static constexpr stencil::uindex_t stencil_radius = 1;
+    static constexpr stencil::uindex_t n_subiterations = 1;
+
+    std::monostate get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return std::monostate();
+    }
+
+    Cell operator()(stencil::Stencil<Cell, 1, TimeDependentValue> const &stencil) const {
+        Cell new_cell = stencil[stencil::ID(0, 0)];
+        for (stencil::index_t c = -1; c <= 1; c++) {
+            for (stencil::index_t r = -1; r <= 1; r++) {
+                new_cell = std::max(new_cell, stencil[stencil::ID(c, r)]);
+            }
+        }
+        return new_cell;
+    }
+};
+
+/**
+ * \brief A transition function with a radius of two that only reads the cells in the given shape.
+ *
+ * Every cell in the shape is multiplied with a weight that depends on its position, so that a
+ * wrongly placed cell changes the result. The result is kept small with a modulo. Cells outside of
+ * the grid are presented according to the given boundary condition.
+ */
+template <stencil::StencilShape shape,
+          stencil::BoundaryCondition bc = stencil::BoundaryCondition::Constant>
+class ShapedTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = std::monostate;
+
+    static constexpr stencil::uindex_t stencil_radius = 2;
+    static constexpr stencil::uindex_t n_subiterations = 1;
+    static constexpr stencil::StencilShape stencil_shape = shape;
+    static constexpr stencil::BoundaryCondition boundary_condition = bc;
+
+    static constexpr Cell modulus = 1009;
+
+    std::monostate get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return std::monostate();
+    }
+
+    Cell operator()(stencil::Stencil<Cell, 2, TimeDependentValue> const &stencil) const {
+        Cell new_cell = 0;
+        for (stencil::index_t c = -2; c <= 2; c++) {
+            for (stencil::index_t r = -2; r <= 2; r++) {
+                if (shape.contains(c, r)) {
+                    new_cell += stencil[stencil::ID(c, r)] * (5 * (c + 2) + (r + 2) + 1);
+                }
+            }
+        }
+        return new_cell % modulus;
+    }
+};
+
+/**
+ * \brief A multistep variant of \ref ShapedTransFunc that also adds the value of the central cell
+ * in the previous iteration.
+ */
+template <stencil::StencilShape shape,
+          stencil::BoundaryCondition bc = stencil::BoundaryCondition::Constant>
+class ShapedHistoryTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = std::monostate;
+    using HistoryValue = stencil::index_t;
+
+    static constexpr stencil::uindex_t stencil_radius = 2;
+    static constexpr stencil::uindex_t n_subiterations = 1;
+    static constexpr stencil::uindex_t history_length = 1;
+    static constexpr stencil::StencilShape stencil_shape = shape;
+    static constexpr stencil::BoundaryCondition boundary_condition = bc;
+
+    static constexpr Cell modulus = ShapedTransFunc<shape, bc>::modulus;
+
+    static HistoryValue history_value(Cell const &cell) { return cell; }
+
+    std::monostate get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return std::monostate();
+    }
+
+    Cell operator()(stencil::Stencil<Cell, 2, TimeDependentValue, std::monostate, std::monostate,
+                                     std::array<HistoryValue, 1>> const &stencil) const {
+        Cell new_cell = stencil.previous(1);
+        for (stencil::index_t c = -2; c <= 2; c++) {
+            for (stencil::index_t r = -2; r <= 2; r++) {
+                if (shape.contains(c, r)) {
+                    new_cell += stencil[stencil::ID(c, r)] * (5 * (c + 2) + (r + 2) + 1);
+                }
+            }
+        }
+        return new_cell % modulus;
+    }
+};
+
+/**
+ * \brief A transition function with two sub-iterations that reads a star with a radius of one.
+ *
+ * The iteration index, the sub-iteration index and the time-dependent value are added to a
+ * weighted sum of some of these cells, so that a wrong index changes the result. The result is
+ * kept small with a modulo.
+ */
+class TimedTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = stencil::index_t;
+
+    static constexpr stencil::uindex_t stencil_radius = 1;
+    static constexpr stencil::uindex_t n_subiterations = 2;
+    static constexpr stencil::StencilShape stencil_shape = stencil::StencilShape::star(1);
+
+    static constexpr Cell modulus = 1009;
+
+    TimeDependentValue get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return 10 * stencil::index_t(i_iteration);
+    }
+
+    Cell operator()(stencil::Stencil<Cell, 1, TimeDependentValue> const &stencil) const {
+        Cell new_cell = 3 * stencil[stencil::ID(0, 0)] + stencil[stencil::ID(1, 0)] +
+                        stencil[stencil::ID(0, -1)] + stencil.time_dependent_value +
+                        7 * stencil::index_t(stencil.iteration) +
+                        stencil::index_t(stencil.subiteration);
+        return new_cell % modulus;
+    }
+};
+
+/**
+ * \brief A chain of a transition function with a radius of two and two iterations of \ref
+ * TimedTransFunc.
+ */
+using ChainedTransFunc = stencil::ChainTransitionFunction<
+    stencil::ChainStage<ShapedTransFunc<stencil::StencilShape::star(2)>>,
+    stencil::ChainStage<TimedTransFunc, 2>>;
+
+/**
+ * \brief A three-dimensional transition function that computes a weighted sum of its stencil.
+ *
+ * Every cell of the stencil is multiplied with a weight that depends on its position, so that a
+ * wrongly placed cell changes the result. The iteration index as the time-dependent value and the
+ * sub-iteration index are added to the sum, which is kept small with a modulo.
+ */
+template <stencil::uindex_t radius, stencil::uindex_t subiterations = 1>
+class WeightedSum3DTransFunc {
+  public:
+    using Cell = stencil::index_t;
+    using TimeDependentValue = stencil::index_t;
+
+    static constexpr stencil::uindex_t stencil_radius = radius;
+    static constexpr stencil::uindex_t n_subiterations = subiterations;
+
+    static constexpr Cell modulus = 1009;
+    static constexpr stencil::index_t diameter = 2 * radius + 1;
+
+    static constexpr Cell weight(stencil::index_t c, stencil::index_t r, stencil::index_t l) {
+        return (c + radius) * diameter * diameter + (r + radius) * diameter + (l + radius) + 1;
+    }
+
+    TimeDependentValue get_time_dependent_value(stencil::uindex_t i_iteration) const {
+        return i_iteration;
+    }
+
+    Cell operator()(stencil::Stencil3D<Cell, radius, TimeDependentValue> const &stencil) const {
+        Cell new_cell = stencil.time_dependent_value + stencil.subiteration;
+        for (stencil::index_t c = -stencil::index_t(radius); c <= stencil::index_t(radius); c++) {
+            for (stencil::index_t r = -stencil::index_t(radius); r <= stencil::index_t(radius);
+                 r++) {
+                for (stencil::index_t l = -stencil::index_t(radius);
+                     l <= stencil::index_t(radius); l++) {
+                    new_cell += stencil[stencil::ID3D(c, r, l)] * weight(c, r, l);
+                }
+            }
+        }
+        return new_cell % modulus;
+    }
+};
@@ -20,6 +20,7 @@
 #include "../GridTest.hpp"
 #include "../constants.hpp"
 #include <StencilStream/cpu/Grid.hpp>
+#include <vector>
 
 using namespace stencil;
 using namespace stencil::cpu;
@@ -40,6 +41,34 @@ TEST_CASE("cpu::Grid::copy_to_buffer", "[cpu::Grid]") {
     grid_test::test_copy_to_buffer<TestGrid>(tile_width, tile_height);
 }
 
+TEST_CASE("cpu::Grid::generate", "[cpu::Grid]") {
+    grid_test::test_generate<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::Grid::GridAccessor (cell views)", "[cpu::Grid]") {
+    grid_test::test_cell_views<TestGrid>(tile_width, tile_height);
+}
+
 TEST_CASE("cpu::Grid::make_similar", "[cpu::Grid]") {
     grid_test::test_make_similar<TestGrid>(tile_width, tile_height);
 }
+
+TEST_CASE("cpu::Grid::get_n_references", "[cpu::Grid]") {
+    grid_test::test_n_references<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::Grid::project", "[cpu::Grid]") {
+    grid_test::test_project<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::Grid::adopt", "[cpu::Grid]") {
+    grid_test::test_adopt<TestGrid>(tile_width, tile_height);
+
+    std::vector<ID> cells(tile_width * tile_height, ID(0, 0));
+    {
+        TestGrid grid = TestGrid::adopt(cells.data(), sycl::range<2>(tile_width, tile_height));
+        TestGrid::GridAccessor<sycl::access::mode::read_write> ac(grid);
+        ac[3][5] = ID(3, 5);
+    }
+    REQUIRE(cells[3 * tile_height + 5] == ID(3, 5));
+}
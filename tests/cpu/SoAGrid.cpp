@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "../GridTest.hpp"
+#include "../constants.hpp"
+#include <StencilStream/cpu/SoAGrid.hpp>
+
+using namespace stencil;
+using namespace stencil::cpu;
+
+using TestGrid = SoAGrid<ID, &ID::c, &ID::r>;
+
+static_assert(concepts::Grid<TestGrid, ID>);
+
+TEST_CASE("cpu::SoAGrid::SoAGrid", "[cpu::SoAGrid]") {
+    grid_test::test_constructors<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::SoAGrid::copy_from_buffer", "[cpu::SoAGrid]") {
+    grid_test::test_copy_from_buffer<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::SoAGrid::copy_to_buffer", "[cpu::SoAGrid]") {
+    grid_test::test_copy_to_buffer<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::SoAGrid::make_similar", "[cpu::SoAGrid]") {
+    grid_test::test_make_similar<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::SoAGrid::get_n_references", "[cpu::SoAGrid]") {
+    grid_test::test_n_references<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::SoAGrid::FieldAccessor", "[cpu::SoAGrid]") {
+    TestGrid grid(tile_width, tile_height);
+    {
+        TestGrid::GridAccessor<sycl::access::mode::discard_write> ac(grid);
+        for (index_t c = 0; c < tile_width; c++) {
+            for (index_t r = 0; r < tile_height; r++) {
+                ac[c][r] = ID(c, r);
+            }
+        }
+    }
+
+    {
+        TestGrid::FieldAccessor<&ID::c, sycl::access::mode::read> c_ac(grid);
+        TestGrid::FieldAccessor<&ID::r, sycl::access::mode::read_write> r_ac(grid);
+        std::span<index_t const> c_span = c_ac.get_span();
+        std::span<index_t> r_span = r_ac.get_span();
+        REQUIRE(c_span.size() == tile_width * tile_height);
+        REQUIRE(r_span.size() == tile_width * tile_height);
+
+        for (index_t c = 0; c < tile_width; c++) {
+            for (index_t r = 0; r < tile_height; r++) {
+                REQUIRE(c_ac[c][r] == c);
+                REQUIRE(c_span[c * tile_height + r] == c);
+                REQUIRE(r_span[c * tile_height + r] == r);
+                r_span[c * tile_height + r] = 2 * r;
+            }
+        }
+    }
+
+    TestGrid::GridAccessor<sycl::access::mode::read> ac(grid);
+    for (index_t c = 0; c < tile_width; c++) {
+        for (index_t r = 0; r < tile_height; r++) {
+            REQUIRE(ac[c][r] == ID(c, 2 * r));
+        }
+    }
+}
@@ -23,6 +23,8 @@
 #include "../StencilUpdateTest.hpp"
 #include "../constants.hpp"
 #include <StencilStream/cpu/StencilUpdate.hpp>
+#include <filesystem>
+#include <fstream>
 
 using namespace sycl;
 using namespace stencil;
@@ -37,4 +39,307 @@ TEST_CASE("cpu::StencilUpdate", "[cpu::StencilUpdate]") {
     test_stencil_update<GridImpl, StencilUpdateImpl>(64, 64, 0, 1);
     test_stencil_update<GridImpl, StencilUpdateImpl>(64, 64, 0, 1);
     test_stencil_update<GridImpl, StencilUpdateImpl>(64, 64, 32, 64);
-}
\ No newline at end of file
+}
+
+TEST_CASE("cpu::StencilUpdate (partial tiles)", "[cpu::StencilUpdate]") {
+    test_stencil_update<GridImpl, StencilUpdateImpl>(63, 65, 0, 1);
+    test_stencil_update<GridImpl, StencilUpdateImpl>(17, 3, 0, 4);
+}
+
+TEST_CASE("cpu::StencilUpdate (custom tile shape)", "[cpu::StencilUpdate]") {
+    using CustomStencilUpdateImpl = StencilUpdate<FPGATransFunc<1>, 8, 4>;
+    static_assert(concepts::StencilUpdate<CustomStencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    test_stencil_update<GridImpl, CustomStencilUpdateImpl>(64, 32, 0, 2);
+    test_stencil_update<GridImpl, CustomStencilUpdateImpl>(33, 7, 3, 5);
+}
+
+TEST_CASE("cpu::StencilUpdate (temporal blocking)", "[cpu::StencilUpdate]") {
+    for (uindex_t temporal_block : {2, 3, 8}) {
+        for (uindex_t n_iterations : {1, 7, 16}) {
+            test_stencil_update<GridImpl, StencilUpdateImpl>(
+                63, 65,
+                {.transition_function = FPGATransFunc<1>(),
+                 .halo_value = Cell::halo(),
+                 .iteration_offset = 5,
+                 .n_iterations = n_iterations,
+                 .temporal_block = temporal_block});
+        }
+    }
+
+    GridImpl grid(8, 8);
+    StencilUpdateImpl update({.temporal_block = 0});
+    REQUIRE_THROWS_AS(update(grid), std::invalid_argument);
+}
+
+TEST_CASE("cpu::StencilUpdate (runtime tile range)", "[cpu::StencilUpdate]") {
+    for (sycl::range<2> tile_range : {sycl::range<2>(8, 4), sycl::range<2>(1, 32)}) {
+        test_stencil_update<GridImpl, StencilUpdateImpl>(33, 7,
+                                                         {.transition_function = FPGATransFunc<1>(),
+                                                          .halo_value = Cell::halo(),
+                                                          .iteration_offset = 3,
+                                                          .n_iterations = 5,
+                                                          .temporal_block = 2,
+                                                          .tile_range = tile_range});
+    }
+
+    GridImpl grid(8, 8);
+    StencilUpdateImpl update({.tile_range = sycl::range<2>(0, 8)});
+    REQUIRE_THROWS_AS(update(grid), std::invalid_argument);
+}
+
+TEST_CASE("cpu::StencilUpdate (auto-tuning)", "[cpu::StencilUpdate]") {
+    std::string path =
+        (std::filesystem::temp_directory_path() / "stencilstream_test_tuning_cache").string();
+    std::filesystem::remove(path);
+
+    StencilUpdateImpl update({.transition_function = FPGATransFunc<1>(),
+                              .halo_value = Cell::halo(),
+                              .n_iterations = 7,
+                              .auto_tune = true,
+                              .tuning_cache_path = path});
+    std::string key = StencilUpdateImpl::get_tuning_key(update.get_params().device, 63, 65);
+    REQUIRE(key.find(' ') == std::string::npos);
+    REQUIRE(key != StencilUpdateImpl::get_tuning_key(update.get_params().device, 65, 63));
+    std::vector<StencilUpdateImpl::TuningConfiguration> candidates =
+        update.get_tuning_candidates();
+    REQUIRE(candidates.size() > 1);
+    test_stencil_update<GridImpl, StencilUpdateImpl>(63, 65, update);
+    REQUIRE(update.get_n_processed_cells() == 63 * 65 * 7);
+
+    // The fastest candidate is used and recorded.
+    REQUIRE(update.get_tuned_configurations().size() == 1);
+    StencilUpdateImpl::TuningConfiguration tuned = update.get_tuned_configurations().at(key);
+    REQUIRE(std::any_of(candidates.begin(), candidates.end(), [&](auto const &candidate) {
+        return candidate.tile_range == tuned.tile_range &&
+               candidate.temporal_block == tuned.temporal_block;
+    }));
+    REQUIRE(update.get_params().tile_range == tuned.tile_range);
+    REQUIRE(update.get_params().temporal_block == tuned.temporal_block);
+    {
+        std::ifstream in(path);
+        std::string cached_key;
+        uindex_t tile_c, tile_r, temporal_block;
+        in >> cached_key >> tile_c >> tile_r >> temporal_block;
+        REQUIRE(cached_key == key);
+        REQUIRE(sycl::range<2>(tile_c, tile_r) == tuned.tile_range);
+        REQUIRE(temporal_block == tuned.temporal_block);
+    }
+
+    // Configurations of other devices are ignored.
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "other_device" << key.substr(key.find('/')) << " 4 8 3\n";
+    }
+    StencilUpdateImpl other_device_update({.transition_function = FPGATransFunc<1>(),
+                                           .halo_value = Cell::halo(),
+                                           .n_iterations = 7,
+                                           .auto_tune = true,
+                                           .tuning_cache_path = path});
+    test_stencil_update<GridImpl, StencilUpdateImpl>(63, 65, other_device_update);
+    REQUIRE(other_device_update.get_params().temporal_block != 3);
+
+    // Other updaters pick up the cached configuration without benchmarking it again.
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "unrelated_key 16 16 1\n" << key << " 4 8 3\n";
+    }
+    StencilUpdateImpl cached_update({.transition_function = FPGATransFunc<1>(),
+                                     .halo_value = Cell::halo(),
+                                     .n_iterations = 7,
+                                     .auto_tune = true,
+                                     .tuning_cache_path = path});
+    test_stencil_update<GridImpl, StencilUpdateImpl>(63, 65, cached_update);
+    REQUIRE(cached_update.get_params().tile_range == sycl::range<2>(4, 8));
+    REQUIRE(cached_update.get_params().temporal_block == 3);
+
+    // A new grid shape is added to the cache and the other entries are kept.
+    test_stencil_update<GridImpl, StencilUpdateImpl>(17, 3, cached_update);
+    REQUIRE(cached_update.get_tuned_configurations().size() == 2);
+    {
+        std::ifstream in(path);
+        std::string line;
+        uindex_t n_lines = 0;
+        while (std::getline(in, line)) {
+            n_lines++;
+        }
+        REQUIRE(n_lines == 3);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("cpu::StencilUpdate (interior and border tiles)", "[cpu::StencilUpdate]") {
+    // With these grid sizes, there are interior tiles as well as border strips of different
+    // widths. The last case has no interior tiles at all.
+    test_stencil_update<GridImpl, StencilUpdateImpl>(128, 96, 0, 4);
+    test_stencil_update<GridImpl, StencilUpdateImpl>(
+        130, 100,
+        {.transition_function = FPGATransFunc<1>(),
+         .halo_value = Cell::halo(),
+         .iteration_offset = 0,
+         .n_iterations = 6,
+         .temporal_block = 3});
+    test_stencil_update<GridImpl, StencilUpdateImpl>(
+        40, 40,
+        {.transition_function = FPGATransFunc<1>(),
+         .halo_value = Cell::halo(),
+         .iteration_offset = 0,
+         .n_iterations = 8,
+         .temporal_block = 8});
+}
+
+TEST_CASE("cpu::StencilUpdate (warm-up)", "[cpu::StencilUpdate]") {
+    test_warm_up<GridImpl, StencilUpdateImpl>(40, 40, 3);
+}
+
+TEST_CASE("cpu::StencilUpdate (grid pool)", "[cpu::StencilUpdate]") {
+    test_grid_pool<GridImpl, StencilUpdateImpl>(40, 24, 3);
+}
+
+TEST_CASE("cpu::StencilUpdate (overwrite source)", "[cpu::StencilUpdate]") {
+    for (uindex_t n_iterations : {1, 2, 3}) {
+        test_overwrite_source<GridImpl, StencilUpdateImpl>(40, 24, n_iterations);
+    }
+}
+
+TEST_CASE("cpu::StencilUpdate (SoA grid)", "[cpu::StencilUpdate]") {
+    using SoAGridImpl = SoAGrid<Cell, &Cell::c, &Cell::r, &Cell::i_iteration, &Cell::i_subiteration,
+                                &Cell::status>;
+    using SoAStencilUpdateImpl = StencilUpdate<FPGATransFunc<1>, 16, 16, SoAGridImpl>;
+    static_assert(concepts::StencilUpdate<SoAStencilUpdateImpl, FPGATransFunc<1>, SoAGridImpl>);
+
+    test_stencil_update<SoAGridImpl, SoAStencilUpdateImpl>(63, 65, 0, 3);
+    test_stencil_update<SoAGridImpl, SoAStencilUpdateImpl>(
+        40, 24,
+        {.transition_function = FPGATransFunc<1>(),
+         .halo_value = Cell::halo(),
+         .iteration_offset = 2,
+         .n_iterations = 5,
+         .temporal_block = 2});
+}
+
+TEST_CASE("cpu::StencilUpdate (USM grid)", "[cpu::StencilUpdate]") {
+    using USMGridImpl = USMGrid<Cell>;
+    using USMStencilUpdateImpl = StencilUpdate<FPGATransFunc<1>, 16, 16, USMGridImpl>;
+    static_assert(concepts::StencilUpdate<USMStencilUpdateImpl, FPGATransFunc<1>, USMGridImpl>);
+
+    test_stencil_update<USMGridImpl, USMStencilUpdateImpl>(63, 65, 0, 3);
+    test_stencil_update<USMGridImpl, USMStencilUpdateImpl>(
+        40, 24,
+        {.transition_function = FPGATransFunc<1>(),
+         .halo_value = Cell::halo(),
+         .iteration_offset = 2,
+         .n_iterations = 5,
+         .temporal_block = 2});
+}
+
+TEST_CASE("cpu::StencilUpdate (static values)", "[cpu::StencilUpdate]") {
+    using StaticStencilUpdateImpl = StencilUpdate<StaticValueTransFunc, 8, 8>;
+    test_static_values<StaticStencilUpdateImpl>(
+        20, 20, {.transition_function = StaticValueTransFunc(), .n_iterations = 3});
+    test_static_values<StaticStencilUpdateImpl>(
+        20, 20,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = 3, .temporal_block = 2});
+}
+
+TEST_CASE("cpu::StencilUpdate (history)", "[cpu::StencilUpdate]") {
+    using TransFunc = HistoryTransitionFunction<HistoryTransFunc<1>>;
+    using HistoryStencilUpdate = StencilUpdate<TransFunc, 8, 8>;
+    test_history<1, HistoryStencilUpdate>(
+        20, 20, {.transition_function = TransFunc({}), .n_iterations = 5});
+    test_history<1, HistoryStencilUpdate>(
+        20, 20, {.transition_function = TransFunc({}), .n_iterations = 5, .temporal_block = 2});
+
+    using SubiterationTransFunc = HistoryTransitionFunction<HistoryTransFunc<2>>;
+    test_history<2, StencilUpdate<SubiterationTransFunc, 8, 8>>(
+        20, 20, {.transition_function = SubiterationTransFunc({}), .n_iterations = 3});
+}
+
+TEST_CASE("cpu::StencilUpdate (constant table)", "[cpu::StencilUpdate]") {
+    using ConstantTableStencilUpdate = StencilUpdate<ConstantTableTransFunc, 8, 8>;
+    test_constant_table<ConstantTableStencilUpdate>(
+        20, 20, {.transition_function = ConstantTableTransFunc(), .n_iterations = 3});
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition = BoundaryCondition::Constant>
+using ShapedStencilUpdate = StencilUpdate<ShapedTransFunc<shape, boundary_condition>, 8, 8>;
+
+TEST_CASE("cpu::StencilUpdate (stencil shape)", "[cpu::StencilUpdate]") {
+    constexpr StencilShape star = StencilShape::star(2);
+    constexpr StencilShape box = StencilShape::asymmetric_box(0, 2, 1, 0);
+    constexpr StencilShape asymmetric_star = StencilShape::asymmetric_star(1, 0, 2, 1);
+
+    test_stencil_shape<star, ShapedStencilUpdate<star>>(
+        20, 20,
+        {.transition_function = ShapedTransFunc<star>(),
+         .halo_value = 1,
+         .n_iterations = 3});
+    test_stencil_shape<box, ShapedStencilUpdate<box>>(
+        20, 20,
+        {.transition_function = ShapedTransFunc<box>(),
+         .halo_value = 1,
+         .n_iterations = 3});
+    test_stencil_shape<asymmetric_star, ShapedStencilUpdate<asymmetric_star>>(
+        20, 20,
+        {.transition_function = ShapedTransFunc<asymmetric_star>(),
+         .halo_value = 1,
+         .n_iterations = 3});
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition, bool with_history = false>
+void test_shaped_boundary_condition() {
+    using TransFunc = BoundaryTransFunc<shape, boundary_condition, with_history>;
+    for (uindex_t temporal_block : {1, 2}) {
+        test_boundary_condition<shape, boundary_condition, StencilUpdate<TransFunc, 8, 8>,
+                                with_history>(
+            20, 19,
+            {.transition_function = TransFunc({}),
+             .n_iterations = 3,
+             .temporal_block = temporal_block});
+    }
+}
+
+TEST_CASE("cpu::StencilUpdate (boundary conditions)", "[cpu::StencilUpdate]") {
+    constexpr StencilShape box = StencilShape::box(2);
+    constexpr StencilShape south_east = StencilShape::asymmetric_box(0, 2, 0, 2);
+
+    test_shaped_boundary_condition<box, BoundaryCondition::Clamp>();
+    test_shaped_boundary_condition<box, BoundaryCondition::Reflect>();
+    test_shaped_boundary_condition<box, BoundaryCondition::Periodic>();
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Reflect>();
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Periodic>();
+
+    // Multistep schemes keep the boundary condition of the wrapped transition function.
+    test_shaped_boundary_condition<box, BoundaryCondition::Reflect, true>();
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Periodic, true>();
+}
+
+TEST_CASE("cpu::StencilUpdate (chained transition functions)", "[cpu::StencilUpdate]") {
+    using ChainedStencilUpdate = StencilUpdate<ChainedTransFunc>;
+    test_chained_trans_func<ChainedStencilUpdate>(
+        20, 20,
+        {.transition_function = ChainedTransFunc(), .halo_value = 1, .n_iterations = 3});
+    test_chained_trans_func<ChainedStencilUpdate>(
+        20, 20,
+        {.transition_function = ChainedTransFunc(),
+         .halo_value = 2,
+         .iteration_offset = 2,
+         .n_iterations = 1});
+}
+
+TEST_CASE("cpu::StencilUpdate (reduction)", "[cpu::StencilUpdate]") {
+    using ReducingStencilUpdateImpl = StencilUpdate<ReducingTransFunc<1>>;
+    test_reduction<ReducingStencilUpdateImpl>(
+        63, 65, {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo(),
+                 .n_iterations = 3});
+    test_reduction<ReducingStencilUpdateImpl>(
+        17, 3, {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo(),
+                .iteration_offset = 5, .n_iterations = 1, .temporal_block = 2});
+}
+
+TEST_CASE("cpu::StencilUpdate (run until)", "[cpu::StencilUpdate]") {
+    test_run_until<StencilUpdate<ReducingTransFunc<1>>>(
+        33, 7, {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo(),
+                .iteration_offset = 2, .temporal_block = 2});
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "../StencilUpdateTest.hpp"
+#include <StencilStream/cpu/StencilUpdate3D.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace stencil;
+using namespace stencil::cpu;
+
+TEST_CASE("cpu::StencilUpdate3D", "[cpu::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<1>;
+    test_stencil_update_3d<StencilUpdate3D<TransFunc>, TransFunc>(
+        7, 6, 5, {.transition_function = TransFunc(), .halo_value = 1, .n_iterations = 3});
+    test_stencil_update_3d<StencilUpdate3D<TransFunc>, TransFunc>(
+        3, 2, 9,
+        {.transition_function = TransFunc(),
+         .halo_value = 2,
+         .iteration_offset = 4,
+         .n_iterations = 2});
+}
+
+TEST_CASE("cpu::StencilUpdate3D (radius 2, sub-iterations)", "[cpu::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<2, 2>;
+    test_stencil_update_3d<StencilUpdate3D<TransFunc>, TransFunc>(
+        6, 5, 7, {.transition_function = TransFunc(), .halo_value = 1, .n_iterations = 2});
+}
+
+TEST_CASE("cpu::StencilUpdate3D (grid pool)", "[cpu::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<1>;
+    test_grid_pool_3d<StencilUpdate3D<TransFunc>, TransFunc>(5, 4, 3);
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "../GridTest.hpp"
+#include "../constants.hpp"
+#include <StencilStream/cpu/USMGrid.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace stencil;
+using namespace stencil::cpu;
+
+using TestGrid = USMGrid<ID>;
+
+static_assert(concepts::Grid<TestGrid, ID>);
+
+TEST_CASE("cpu::USMGrid::USMGrid", "[cpu::USMGrid]") {
+    grid_test::test_constructors<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::USMGrid::copy_from_buffer", "[cpu::USMGrid]") {
+    grid_test::test_copy_from_buffer<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::USMGrid::copy_to_buffer", "[cpu::USMGrid]") {
+    grid_test::test_copy_to_buffer<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::USMGrid::GridAccessor (cell views)", "[cpu::USMGrid]") {
+    grid_test::test_cell_views<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::USMGrid::make_similar", "[cpu::USMGrid]") {
+    grid_test::test_make_similar<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::USMGrid::get_n_references", "[cpu::USMGrid]") {
+    grid_test::test_n_references<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("cpu::USMGrid::upload_async", "[cpu::USMGrid]") {
+    TestGrid grid(tile_width, tile_height);
+    std::span<ID> cells = grid.get_host_span();
+    REQUIRE(cells.size() == tile_width * tile_height);
+    for (index_t c = 0; c < tile_width; c++) {
+        for (index_t r = 0; r < tile_height; r++) {
+            cells[c * tile_height + r] = ID(c, r);
+        }
+    }
+    grid.upload_async();
+
+    // Overwrite the staging area once the upload is done; The device copy must be unaffected.
+    grid.wait();
+    std::fill(cells.begin(), cells.end(), ID(-1, -1));
+
+    sycl::buffer<ID, 2> buffer(sycl::range<2>(tile_width, tile_height));
+    grid.copy_to_buffer(buffer);
+    sycl::host_accessor ac(buffer, sycl::read_only);
+    for (index_t c = 0; c < tile_width; c++) {
+        for (index_t r = 0; r < tile_height; r++) {
+            REQUIRE(ac[c][r] == ID(c, r));
+        }
+    }
+}
+
+TEST_CASE("cpu::USMGrid::download_async", "[cpu::USMGrid]") {
+    TestGrid grid(tile_width, tile_height);
+    {
+        TestGrid::GridAccessor<sycl::access::mode::discard_write> ac(grid);
+        for (index_t c = 0; c < tile_width; c++) {
+            for (index_t r = 0; r < tile_height; r++) {
+                ac[c][r] = ID(c, r);
+            }
+        }
+    }
+
+    std::span<ID> cells = grid.get_host_span();
+    std::fill(cells.begin(), cells.end(), ID(-1, -1));
+    grid.download_async().wait();
+    for (index_t c = 0; c < tile_width; c++) {
+        for (index_t r = 0; r < tile_height; r++) {
+            REQUIRE(cells[c * tile_height + r] == ID(c, r));
+        }
+    }
+}
+
+TEST_CASE("cpu::USMGrid::adopt", "[cpu::USMGrid]") {
+    sycl::queue queue;
+    ID *device_data = sycl::malloc_device<ID>(tile_width * tile_height, queue);
+    ID *host_data = sycl::malloc_host<ID>(tile_width * tile_height, queue);
+    {
+        TestGrid grid =
+            TestGrid::adopt(device_data, host_data, sycl::range<2>(tile_width, tile_height), queue);
+        REQUIRE(grid.get_device_data() == device_data);
+        REQUIRE(grid.get_host_span().data() == host_data);
+        {
+            TestGrid::GridAccessor<sycl::access::mode::discard_write> ac(grid);
+            for (index_t c = 0; c < tile_width; c++) {
+                for (index_t r = 0; r < tile_height; r++) {
+                    ac[c][r] = ID(c, r);
+                }
+            }
+        }
+        grid.wait();
+    }
+
+    // The grid must not have freed the allocations.
+    std::vector<ID> cells(tile_width * tile_height);
+    queue.memcpy(cells.data(), device_data, cells.size() * sizeof(ID)).wait();
+    for (index_t c = 0; c < tile_width; c++) {
+        for (index_t r = 0; r < tile_height; r++) {
+            REQUIRE(cells[c * tile_height + r] == ID(c, r));
+        }
+    }
+    REQUIRE_THROWS_AS(TestGrid::adopt(nullptr, host_data, sycl::range<2>(1, 1), queue),
+                      std::invalid_argument);
+    sycl::free(device_data, queue);
+    sycl::free(host_data, queue);
+}
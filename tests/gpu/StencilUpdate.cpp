@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "../StencilUpdateTest.hpp"
+#include "../constants.hpp"
+#include <StencilStream/gpu/StencilUpdate.hpp>
+
+using namespace sycl;
+using namespace stencil;
+using namespace stencil::gpu;
+
+using StencilUpdateImpl = StencilUpdate<FPGATransFunc<1>>;
+using GridImpl = Grid<Cell>;
+
+static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+// A smaller configuration with more work-groups and sub-groups per tile column.
+using SmallStencilUpdateImpl = StencilUpdate<FPGATransFunc<1>, 4, 16, GridImpl, 8>;
+
+TEST_CASE("gpu::StencilUpdate", "[gpu::StencilUpdate]") {
+    test_stencil_update<GridImpl, StencilUpdateImpl>(64, 64, 0, 1);
+    test_stencil_update<GridImpl, StencilUpdateImpl>(63, 65, 32, 4);
+    test_stencil_update<GridImpl, SmallStencilUpdateImpl>(17, 3, 0, 4);
+    test_stencil_update<GridImpl, SmallStencilUpdateImpl>(33, 50, 3, 5);
+}
+
+TEST_CASE("gpu::StencilUpdate (temporal blocking)", "[gpu::StencilUpdate]") {
+    for (uindex_t temporal_block : {2, 3}) {
+        test_stencil_update<GridImpl, SmallStencilUpdateImpl>(
+            33, 50,
+            {.transition_function = FPGATransFunc<1>(),
+             .halo_value = Cell::halo(),
+             .iteration_offset = 5,
+             .n_iterations = 7,
+             .temporal_block = temporal_block});
+    }
+}
+
+TEST_CASE("gpu::StencilUpdate (tile range)", "[gpu::StencilUpdate]") {
+    test_stencil_update<GridImpl, SmallStencilUpdateImpl>(
+        33, 50,
+        {.transition_function = FPGATransFunc<1>(),
+         .halo_value = Cell::halo(),
+         .n_iterations = 3,
+         .tile_range = sycl::range<2>(2, 24)});
+
+    // Sub-groups may not span multiple columns of a tile.
+    GridImpl grid(8, 8);
+    SmallStencilUpdateImpl update({.tile_range = sycl::range<2>(4, 12)});
+    REQUIRE_THROWS_AS(update(grid), std::invalid_argument);
+    for (auto const &candidate : update.get_tuning_candidates()) {
+        REQUIRE(candidate.tile_range[1] % 8 == 0);
+    }
+}
+
+TEST_CASE("gpu::StencilUpdate (SoA grid)", "[gpu::StencilUpdate]") {
+    using SoAGridImpl = Grid<Cell, &Cell::c, &Cell::r, &Cell::i_iteration, &Cell::i_subiteration,
+                             &Cell::status>;
+    using SoAStencilUpdateImpl = StencilUpdate<FPGATransFunc<1>, 4, 16, SoAGridImpl, 8>;
+    static_assert(concepts::StencilUpdate<SoAStencilUpdateImpl, FPGATransFunc<1>, SoAGridImpl>);
+
+    test_stencil_update<SoAGridImpl, SoAStencilUpdateImpl>(
+        40, 24,
+        {.transition_function = FPGATransFunc<1>(),
+         .halo_value = Cell::halo(),
+         .iteration_offset = 2,
+         .n_iterations = 5,
+         .temporal_block = 2});
+}
+
+TEST_CASE("gpu::StencilUpdate (static values)", "[gpu::StencilUpdate]") {
+    using StaticGridImpl = Grid<StaticValueTransFunc::Cell>;
+    using StaticStencilUpdateImpl = StencilUpdate<StaticValueTransFunc, 4, 8, StaticGridImpl, 8>;
+    test_static_values<StaticStencilUpdateImpl>(
+        20, 20,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = 3, .temporal_block = 2});
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition = BoundaryCondition::Constant>
+using ShapedStencilUpdate =
+    StencilUpdate<ShapedTransFunc<shape, boundary_condition>, 4, 8, Grid<index_t>, 8>;
+
+TEST_CASE("gpu::StencilUpdate (stencil shape)", "[gpu::StencilUpdate]") {
+    // A radius of two makes two work-items at each edge of a sub-group load from local memory.
+    constexpr StencilShape star = StencilShape::star(2);
+    constexpr StencilShape asymmetric_star = StencilShape::asymmetric_star(1, 0, 2, 1);
+
+    test_stencil_shape<star, ShapedStencilUpdate<star>>(
+        20, 20,
+        {.transition_function = ShapedTransFunc<star>(),
+         .halo_value = 1,
+         .n_iterations = 3});
+    test_stencil_shape<asymmetric_star, ShapedStencilUpdate<asymmetric_star>>(
+        20, 20,
+        {.transition_function = ShapedTransFunc<asymmetric_star>(),
+         .halo_value = 1,
+         .n_iterations = 3});
+}
+
+TEST_CASE("gpu::StencilUpdate (boundary conditions)", "[gpu::StencilUpdate]") {
+    constexpr StencilShape star = StencilShape::star(2);
+
+    auto test = [&]<BoundaryCondition boundary_condition>() {
+        test_boundary_condition<star, boundary_condition,
+                                ShapedStencilUpdate<star, boundary_condition>>(
+            20, 19,
+            {.transition_function = ShapedTransFunc<star, boundary_condition>(),
+             .n_iterations = 3,
+             .temporal_block = 2});
+    };
+    test.template operator()<BoundaryCondition::Clamp>();
+    test.template operator()<BoundaryCondition::Reflect>();
+    test.template operator()<BoundaryCondition::Periodic>();
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "../TransFuncs.hpp"
+#include "../constants.hpp"
+#include <StencilStream/BaseTransitionFunction.hpp>
+#include <StencilStream/monotile/BatchStencilUpdate.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace sycl;
+using namespace stencil;
+using namespace stencil::monotile;
+
+constexpr uindex_t max_batch_size = 4;
+
+template <typename TDVStrategy> void test_batch_update() {
+    using BatchStencilUpdateImpl =
+        BatchStencilUpdate<FPGATransFunc<1>, max_batch_size, n_processing_elements,
+                           max_batch_size * tile_width, tile_height, TDVStrategy>;
+    using GridImpl = BatchStencilUpdateImpl::GridImpl;
+    using Accessor = GridImpl::template GridAccessor<access::mode::read_write>;
+
+    uindex_t grid_width = tile_width / 2;
+    uindex_t grid_height = tile_height - 1;
+    uindex_t iteration_offset = 1;
+
+    for (uindex_t batch_size : {uindex_t(1), max_batch_size - 1, max_batch_size}) {
+        for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass + 1}) {
+            std::vector<GridImpl> input_grids;
+            for (uindex_t i = 0; i < batch_size; i++) {
+                GridImpl grid(grid_width, grid_height);
+                Accessor ac(grid);
+                for (uindex_t c = 0; c < grid_width; c++) {
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        ac[c][r] = Cell{index_t(c), index_t(r), index_t(iteration_offset), 0,
+                                        CellStatus::Normal};
+                    }
+                }
+                input_grids.push_back(grid);
+            }
+
+            BatchStencilUpdateImpl update({.transition_functions = {FPGATransFunc<1>()},
+                                           .halo_value = Cell::halo(),
+                                           .iteration_offset = iteration_offset,
+                                           .n_iterations = n_iterations});
+            std::vector<GridImpl> output_grids = update(input_grids);
+            REQUIRE(output_grids.size() == batch_size);
+            REQUIRE(update.get_n_processed_cells() ==
+                    batch_size * n_iterations * grid_width * grid_height);
+
+            for (GridImpl &grid : output_grids) {
+                Accessor ac(grid);
+                for (uindex_t c = 0; c < grid_width; c++) {
+                    for (uindex_t r = 0; r < grid_height; r++) {
+                        REQUIRE(ac[c][r].c == c);
+                        REQUIRE(ac[c][r].r == r);
+                        REQUIRE(ac[c][r].i_iteration == iteration_offset + n_iterations);
+                        REQUIRE(ac[c][r].i_subiteration == 0);
+                        REQUIRE(ac[c][r].status == CellStatus::Normal);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("monotile::BatchStencilUpdate", "[monotile::BatchStencilUpdate]") {
+    test_batch_update<tdv::single_pass::InlineStrategy>();
+    test_batch_update<tdv::single_pass::PrecomputeOnDeviceStrategy>();
+    test_batch_update<tdv::single_pass::PrecomputeOnHostStrategy>();
+    test_batch_update<
+        tdv::single_pass::ChunkedPrecomputeOnHostStrategy<n_processing_elements, 2>>();
+}
+
+struct ScaledSumKernel : public BaseTransitionFunction {
+    using Cell = index_t;
+    using TimeDependentValue = index_t;
+
+    index_t factor = 1;
+
+    index_t operator()(Stencil<index_t, 1, index_t> const &stencil) const {
+        index_t sum = 0;
+        for (uindex_t c = 0; c < 3; c++) {
+            for (uindex_t r = 0; r < 3; r++) {
+                sum += stencil[UID(c, r)];
+            }
+        }
+        return sum + stencil.time_dependent_value;
+    }
+
+    index_t get_time_dependent_value(uindex_t i_iteration) const {
+        return factor * index_t(i_iteration);
+    }
+};
+
+TEST_CASE("monotile::BatchStencilUpdate (individual transition functions)",
+          "[monotile::BatchStencilUpdate]") {
+    using BatchStencilUpdateImpl =
+        BatchStencilUpdate<ScaledSumKernel, max_batch_size, n_processing_elements,
+                           max_batch_size * tile_width, tile_height>;
+    using GridImpl = BatchStencilUpdateImpl::GridImpl;
+    using Accessor = GridImpl::GridAccessor<access::mode::read_write>;
+
+    uindex_t grid_width = 5;
+    uindex_t grid_height = 7;
+    uindex_t batch_size = 3;
+    uindex_t n_iterations = 2 * n_processing_elements + 1;
+
+    std::vector<ScaledSumKernel> transition_functions;
+    std::vector<GridImpl> input_grids;
+    for (uindex_t i = 0; i < batch_size; i++) {
+        transition_functions.push_back(ScaledSumKernel{.factor = index_t(i + 1)});
+
+        GridImpl grid(grid_width, grid_height);
+        Accessor ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = index_t(i * 100 + c * grid_height + r);
+            }
+        }
+        input_grids.push_back(grid);
+    }
+
+    BatchStencilUpdateImpl update({.transition_functions = transition_functions,
+                                   .halo_value = 0,
+                                   .n_iterations = n_iterations});
+    std::vector<GridImpl> output_grids = update(input_grids);
+
+    for (uindex_t i = 0; i < batch_size; i++) {
+        // Compute the reference on the host, with every grid on its own.
+        std::vector<index_t> reference(grid_width * grid_height);
+        Accessor input_ac(input_grids[i]);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                reference[c * grid_height + r] = input_ac[c][r];
+            }
+        }
+        for (uindex_t i_iteration = 0; i_iteration < n_iterations; i_iteration++) {
+            std::vector<index_t> next(grid_width * grid_height);
+            for (index_t c = 0; c < index_t(grid_width); c++) {
+                for (index_t r = 0; r < index_t(grid_height); r++) {
+                    index_t sum = transition_functions[i].get_time_dependent_value(i_iteration);
+                    for (index_t dc = -1; dc <= 1; dc++) {
+                        for (index_t dr = -1; dr <= 1; dr++) {
+                            if (c + dc >= 0 && c + dc < index_t(grid_width) && r + dr >= 0 &&
+                                r + dr < index_t(grid_height)) {
+                                sum += reference[(c + dc) * grid_height + r + dr];
+                            }
+                        }
+                    }
+                    next[c * grid_height + r] = sum;
+                }
+            }
+            reference = next;
+        }
+
+        Accessor output_ac(output_grids[i]);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(output_ac[c][r] == reference[c * grid_height + r]);
+            }
+        }
+    }
+}
+
+TEST_CASE("monotile::BatchStencilUpdate (invalid batches)", "[monotile::BatchStencilUpdate]") {
+    using BatchStencilUpdateImpl =
+        BatchStencilUpdate<FPGATransFunc<1>, max_batch_size, n_processing_elements, tile_width,
+                           tile_height>;
+    using GridImpl = BatchStencilUpdateImpl::GridImpl;
+
+    BatchStencilUpdateImpl update({.transition_functions = {FPGATransFunc<1>()},
+                                   .halo_value = Cell::halo()});
+
+    std::vector<GridImpl> empty_batch;
+    REQUIRE(update(empty_batch).empty());
+
+    std::vector<GridImpl> too_many_grids(max_batch_size + 1, GridImpl(1, 1));
+    REQUIRE_THROWS_AS(update(too_many_grids), std::invalid_argument);
+
+    std::vector<GridImpl> different_sizes = {GridImpl(4, 4), GridImpl(4, 5)};
+    REQUIRE_THROWS_AS(update(different_sizes), std::range_error);
+
+    std::vector<GridImpl> too_wide(max_batch_size, GridImpl(tile_width / 2 + 1, 4));
+    REQUIRE_THROWS_AS(update(too_wide), std::range_error);
+
+    update.get_params().transition_functions = {FPGATransFunc<1>(), FPGATransFunc<1>()};
+    std::vector<GridImpl> three_grids(3, GridImpl(4, 4));
+    REQUIRE_THROWS_AS(update(three_grids), std::invalid_argument);
+}
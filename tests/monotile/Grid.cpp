@@ -43,10 +43,45 @@ TEST_CASE("monotile::Grid::copy_to_buffer", "[monotile::Grid]") {
     grid_test::test_copy_to_buffer<TestGrid>(tile_width, tile_height);
 }
 
+TEST_CASE("monotile::Grid (parallel copy)", "[monotile::Grid]") {
+    // Large enough to be copied by multiple threads, with a partially filled last word.
+    grid_test::test_copy_from_buffer<TestGrid>(601, 299);
+    grid_test::test_copy_to_buffer<TestGrid>(601, 299);
+    grid_test::test_copy_from_buffer<Grid<ID, 64, true>>(601, 299);
+    grid_test::test_copy_to_buffer<Grid<ID, 64, true>>(601, 299);
+}
+
+TEST_CASE("monotile::Grid::adopt", "[monotile::Grid]") {
+    grid_test::test_adopt<TestGrid>(tile_width, tile_height);
+
+    // The adopted cells have to fill whole memory words.
+    sycl::buffer<ID, 2> buffer(sycl::range<2>(3, 3));
+    REQUIRE_THROWS_AS(TestGrid::adopt(buffer), std::invalid_argument);
+}
+
+TEST_CASE("monotile::Grid::generate", "[monotile::Grid]") {
+    grid_test::test_generate<TestGrid>(tile_width, tile_height);
+    grid_test::test_generate<TestGrid>(tile_width - 1, tile_height - 3);
+}
+
+TEST_CASE("monotile::Grid::GridAccessor (cell views)", "[monotile::Grid]") {
+    grid_test::test_cell_views<TestGrid>(tile_width, tile_height);
+    grid_test::test_cell_views<TestGrid>(tile_width - 1, tile_height - 3);
+}
+
 TEST_CASE("monotile::Grid::make_similar", "[monotile::Grid]") {
     grid_test::test_make_similar<TestGrid>(tile_width, tile_height);
 }
 
+TEST_CASE("monotile::Grid::get_n_references", "[monotile::Grid]") {
+    grid_test::test_n_references<TestGrid>(tile_width, tile_height);
+}
+
+TEST_CASE("monotile::Grid::project", "[monotile::Grid]") {
+    grid_test::test_project<TestGrid>(tile_width, tile_height);
+    grid_test::test_project<TestGrid>(tile_width - 1, tile_height - 3);
+}
+
 TEST_CASE("monotile::Grid::submit_read", "[monotile::Grid]") {
     TestGrid in_grid(tile_width, tile_height);
     {
@@ -107,4 +142,217 @@ TEST_CASE("monotile::Grid::submit_write", "[monotile::Grid]") {
             REQUIRE(out_ac[c][r] == ID(c, r));
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("monotile::Grid (column ranges)", "[monotile::Grid]") {
+    uindex_t grid_width = 13;
+    uindex_t grid_height = 7;
+    TestGrid grid(grid_width, grid_height);
+    REQUIRE(grid.get_column_alignment() == 8);
+    {
+        TestGrid::GridAccessor<access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = ID(c, r);
+            }
+        }
+    }
+
+    sycl::queue queue;
+    using pipe = sycl::pipe<class monotile_grid_column_range_test_pipe, ID>;
+
+    // Read a range that starts and ends within memory words.
+    grid.template submit_read<pipe>(queue, 3, 9);
+    buffer<ID, 2> out_buffer = range<2>(6, grid_height);
+    queue.submit([&](handler &cgh) {
+        accessor out_ac(out_buffer, cgh, sycl::write_only);
+        cgh.single_task<class monotile_grid_column_range_test_read_kernel>([=]() {
+            for (uindex_t c = 0; c < 6; c++) {
+                for (uindex_t r = 0; r < grid_height; r++) {
+                    out_ac[c][r] = pipe::read();
+                }
+            }
+        });
+    });
+    {
+        host_accessor out_ac(out_buffer, sycl::read_only);
+        for (uindex_t c = 0; c < 6; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(out_ac[c][r] == ID(c + 3, r));
+            }
+        }
+    }
+
+    // Overwrite the aligned range at the end of the grid.
+    queue.submit([&](handler &cgh) {
+        cgh.single_task<class monotile_grid_column_range_test_write_kernel>([=]() {
+            for (uindex_t c = 8; c < grid_width; c++) {
+                for (uindex_t r = 0; r < grid_height; r++) {
+                    pipe::write(ID(c + 100, r));
+                }
+            }
+        });
+    });
+    grid.template submit_write<pipe>(queue, 8, grid_width);
+    {
+        TestGrid::GridAccessor<access::mode::read> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac[c][r] == ID(c < 8 ? c : c + 100, r));
+            }
+        }
+    }
+
+    REQUIRE_THROWS_AS(grid.template submit_read<pipe>(queue, 5, grid_width + 1), std::range_error);
+    REQUIRE_THROWS_AS(grid.template submit_write<pipe>(queue, 3, 8), std::invalid_argument);
+}
+
+TEST_CASE("monotile::Grid (dense storage)", "[monotile::Grid]") {
+    struct DenseCell {
+        int32_t a, b, c;
+    };
+    static_assert(sizeof(CellStorage<DenseCell, true>) == 12);
+    static_assert(sizeof(CellStorage<DenseCell, false>) == 16);
+
+    using DenseGrid = Grid<DenseCell, 64, true>;
+    static_assert(concepts::Grid<DenseGrid, DenseCell>);
+
+    DenseGrid grid(tile_width, tile_height);
+    {
+        DenseGrid::GridAccessor<access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < tile_width; c++) {
+            for (uindex_t r = 0; r < tile_height; r++) {
+                ac[c][r] = DenseCell{int32_t(c), int32_t(r), int32_t(c * r)};
+            }
+        }
+    }
+
+    buffer<DenseCell, 2> out_buffer(range<2>(tile_width, tile_height));
+    grid.copy_to_buffer(out_buffer);
+    host_accessor out_ac(out_buffer, read_only);
+    for (uindex_t c = 0; c < tile_width; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            REQUIRE(out_ac[c][r].a == int32_t(c));
+            REQUIRE(out_ac[c][r].b == int32_t(r));
+            REQUIRE(out_ac[c][r].c == int32_t(c * r));
+        }
+    }
+}
+
+enum class QuadState : uint8_t { A, B, C, D };
+
+template <> struct stencil::CellBits<QuadState> : std::integral_constant<uindex_t, 2> {};
+
+template <typename Cell> void test_bit_packed_grid(auto cell_value) {
+    static_assert(is_bit_packable<Cell>);
+    using PackedGrid = Grid<Cell, 64>;
+    static_assert(concepts::Grid<PackedGrid, Cell>);
+
+    // A grid that doesn't fill its last word.
+    uindex_t grid_width = 37;
+    uindex_t grid_height = 29;
+
+    PackedGrid grid(grid_width, grid_height);
+    {
+        typename PackedGrid::template GridAccessor<access::mode::discard_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = cell_value(c, r);
+            }
+        }
+    }
+
+    {
+        typename PackedGrid::template GridAccessor<access::mode::read> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac[c][r] == cell_value(c, r));
+            }
+        }
+    }
+
+    using pipe = sycl::pipe<class monotile_bit_packed_grid_test_pipe, Cell>;
+    sycl::queue queue;
+    grid.template submit_read<pipe>(queue);
+    PackedGrid copy = grid.make_similar();
+    copy.template submit_write<pipe>(queue);
+
+    buffer<Cell, 2> out_buffer(range<2>(grid_width, grid_height));
+    copy.copy_to_buffer(out_buffer);
+    host_accessor out_ac(out_buffer, read_only);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(out_ac[c][r] == cell_value(c, r));
+        }
+    }
+
+    {
+        typename PackedGrid::template GridAccessor<access::mode::read> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            REQUIRE(ac.get_column(c).size() == grid_height);
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac.get_column(c)[r] == cell_value(c, r));
+            }
+        }
+    }
+
+    PackedGrid generated = grid.make_similar();
+    generated.generate(queue, cell_value).wait();
+    typename PackedGrid::template GridAccessor<access::mode::read> generated_ac(generated);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(generated_ac[c][r] == cell_value(c, r));
+        }
+    }
+}
+
+TEST_CASE("monotile::Grid (bit-packed)", "[monotile::Grid]") {
+    test_bit_packed_grid<bool>([](uindex_t c, uindex_t r) { return (c * 7 + r * 3) % 5 < 2; });
+    test_bit_packed_grid<QuadState>(
+        [](uindex_t c, uindex_t r) { return QuadState((c + 3 * r) % 4); });
+}
+
+TEST_CASE("monotile::Grid (cell codec)", "[monotile::Grid]") {
+    using grid_test::CodedCell;
+    using CodedGrid = Grid<CodedCell, 64>;
+    static_assert(concepts::Grid<CodedGrid, CodedCell>);
+
+    // A grid that doesn't fill its last word.
+    uindex_t grid_width = 37;
+    uindex_t grid_height = 29;
+    grid_test::test_cell_codec<CodedGrid>(grid_width, grid_height);
+
+    CodedGrid grid(grid_width, grid_height);
+    {
+        CodedGrid::GridAccessor<access::mode::discard_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = CodedCell{grid_test::coded_value(c, r)};
+            }
+        }
+    }
+
+    // Full-precision cells are sent through the pipes.
+    using in_pipe = sycl::pipe<class monotile_coded_grid_test_in_pipe, CodedCell>;
+    using out_pipe = sycl::pipe<class monotile_coded_grid_test_out_pipe, CodedCell>;
+    sycl::queue queue;
+    grid.template submit_read<in_pipe>(queue);
+    queue.submit([&](sycl::handler &cgh) {
+        uindex_t n_cells = grid_width * grid_height;
+        cgh.single_task([=]() {
+            for (uindex_t i = 0; i < n_cells; i++) {
+                out_pipe::write(CodedCell{in_pipe::read().value + 1.0 / 3.0});
+            }
+        });
+    });
+    CodedGrid copy = grid.make_similar();
+    copy.template submit_write<out_pipe>(queue);
+
+    CodedGrid::GridAccessor<access::mode::read> ac(copy);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            double value = grid_test::stored_value(grid_test::coded_value(c, r)) + 1.0 / 3.0;
+            REQUIRE(ac[c][r].value == grid_test::stored_value(value));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "../StencilUpdateTest.hpp"
+#include "../TransFuncs.hpp"
+#include "../constants.hpp"
+#include <StencilStream/monotile/PipelinedStencilUpdate.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace sycl;
+using namespace stencil;
+using namespace stencil::monotile;
+
+template <typename TDVStrategy> void test_pipelined_update() {
+    using StencilUpdateImpl = PipelinedStencilUpdate<FPGATransFunc<1>, n_processing_elements,
+                                                     tile_width, tile_height, TDVStrategy>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    sycl::device device;
+    for (uindex_t n_downstream_devices : {0, 1, 2}) {
+        // Chunks narrower than the halo are collected from multiple chunks of the previous stage.
+        for (uindex_t chunk_width : {uindex_t(1), uindex_t(16), tile_width}) {
+            for (uindex_t n_iterations : {iters_per_pass, 3 * iters_per_pass + 1}) {
+                test_stencil_update<GridImpl, StencilUpdateImpl>(
+                    tile_width - 3, tile_height - 1,
+                    {.transition_function = FPGATransFunc<1>(),
+                     .halo_value = Cell::halo(),
+                     .iteration_offset = 1,
+                     .n_iterations = n_iterations,
+                     .downstream_devices =
+                         std::vector<sycl::device>(n_downstream_devices, device),
+                     .chunk_width = chunk_width});
+            }
+        }
+    }
+}
+
+TEST_CASE("monotile::PipelinedStencilUpdate", "[monotile::PipelinedStencilUpdate]") {
+    test_pipelined_update<tdv::single_pass::InlineStrategy>();
+    test_pipelined_update<tdv::single_pass::PrecomputeOnDeviceStrategy>();
+    test_pipelined_update<tdv::single_pass::PrecomputeOnHostStrategy>();
+    test_pipelined_update<
+        tdv::single_pass::ChunkedPrecomputeOnHostStrategy<n_processing_elements, 2>>();
+}
+
+TEST_CASE("monotile::PipelinedStencilUpdate (parameters)", "[monotile::PipelinedStencilUpdate]") {
+    using StencilUpdateImpl =
+        PipelinedStencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+
+    StencilUpdateImpl update({.transition_function = FPGATransFunc<1>(),
+                              .halo_value = Cell::halo(),
+                              .n_iterations = iters_per_pass,
+                              .downstream_devices = {sycl::device()},
+                              .chunk_width = 0});
+    REQUIRE(update.get_n_devices() == 2);
+
+    GridImpl grid(tile_width, tile_height);
+    REQUIRE_THROWS_AS(update(grid), std::invalid_argument);
+
+    update.get_params().chunk_width = 16;
+    GridImpl too_wide_grid(tile_width + 1, tile_height);
+    REQUIRE_THROWS_AS(update(too_wide_grid), std::range_error);
+
+    update.get_params().n_iterations = 0;
+    update(grid);
+    REQUIRE(update.get_n_processed_cells() == 0);
+}
@@ -24,8 +24,11 @@
 #include "../StencilUpdateTest.hpp"
 #include "../TransFuncs.hpp"
 #include "../constants.hpp"
+#include <StencilStream/BaseTransitionFunction.hpp>
+#include <StencilStream/HostStream.hpp>
 #include <StencilStream/monotile/StencilUpdate.hpp>
 #include <catch2/catch_all.hpp>
+#include <map>
 
 using namespace sycl;
 using namespace stencil;
@@ -135,4 +138,592 @@ TEST_CASE("monotile::StencilUpdate", "[monotile::StencilUpdate]") {
     test_monotile_update<tdv::single_pass::InlineStrategy>();
     test_monotile_update<tdv::single_pass::PrecomputeOnDeviceStrategy>();
     test_monotile_update<tdv::single_pass::PrecomputeOnHostStrategy>();
-}
\ No newline at end of file
+    test_monotile_update<
+        tdv::single_pass::ChunkedPrecomputeOnHostStrategy<n_processing_elements, 2>>();
+}
+
+TEST_CASE("monotile::StencilUpdate (chunked host TDVs)", "[monotile::StencilUpdate]") {
+    // Many more iterations than the ring of chunks can hold, so that the slots are refilled.
+    using GridImpl = Grid<Cell>;
+    constexpr uindex_t chunk_length = 2 * n_processing_elements;
+    using RingUpdate =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::ChunkedPrecomputeOnHostStrategy<chunk_length, 2>>;
+    using SingleSlotUpdate =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::ChunkedPrecomputeOnHostStrategy<n_processing_elements, 1>>;
+
+    uindex_t n_long_iterations = 16 * n_processing_elements;
+    for (uindex_t n_iterations : {uindex_t(1), n_long_iterations, n_long_iterations + 1}) {
+        test_stencil_update<GridImpl, RingUpdate>(tile_width, tile_height, 3, n_iterations);
+        test_stencil_update<GridImpl, SingleSlotUpdate>(tile_width, tile_height, 3, n_iterations);
+    }
+}
+
+TEST_CASE("monotile::StencilUpdate (warm-up)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    test_warm_up<Grid<Cell>, StencilUpdateImpl>(tile_width / 2, tile_height - 1,
+                                                iters_per_pass + 1);
+}
+
+TEST_CASE("monotile::StencilUpdate (grid pool)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    test_grid_pool<Grid<Cell>, StencilUpdateImpl>(tile_width / 2, tile_height / 2,
+                                                  iters_per_pass + 1);
+}
+
+TEST_CASE("monotile::StencilUpdate (overwrite source)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass, 2 * iters_per_pass + 1}) {
+        test_overwrite_source<Grid<Cell>, StencilUpdateImpl>(tile_width / 2, tile_height / 2,
+                                                             n_iterations);
+    }
+}
+
+TEST_CASE("monotile::StencilUpdate (timeline)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    test_timeline<Grid<Cell>, StencilUpdateImpl>(tile_width / 2, tile_height / 2,
+                                                 2 * iters_per_pass + 1, 1);
+}
+
+TEST_CASE("monotile::StencilUpdate (performance model)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+
+    // Every pass streams the grid through the pipeline, which is filled with one column plus one
+    // cell per processing element.
+    constexpr uindex_t width = tile_width / 2, height = tile_height / 2;
+    constexpr double n_cycles_per_pass = width * height + n_processing_elements * (height + 1);
+    static_assert(StencilUpdateImpl::model_runtime(width, height, 0, 1.0) == 0.0);
+    REQUIRE(StencilUpdateImpl::model_runtime(width, height, iters_per_pass, 1.0) ==
+            n_cycles_per_pass);
+    // The last pass only computes one iteration, so its pipeline contains half of the processing
+    // elements.
+    constexpr double n_cycles_per_partial_pass =
+        width * height + (n_processing_elements / 2) * (height + 1);
+    REQUIRE(StencilUpdateImpl::model_runtime(width, height, 2 * iters_per_pass + 1, 2.0) ==
+            (2 * n_cycles_per_pass + n_cycles_per_partial_pass) / 2.0);
+    REQUIRE(StencilUpdateImpl::model_runtime(width, height, iters_per_pass, 1.0, 100) ==
+            n_cycles_per_pass + 100);
+
+    // With two compute units, the pass takes as long as the wider strip.
+    using MultiCUStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, 2>;
+    uindex_t alignment = GridImpl::calc_column_alignment(height);
+    uindex_t split = (width / 2) / alignment * alignment;
+    uindex_t strip_width =
+        std::max(split + n_processing_elements, width - split + n_processing_elements);
+    REQUIRE(MultiCUStencilUpdateImpl::model_runtime(width, height, iters_per_pass, 1.0) ==
+            strip_width * height + n_processing_elements * (height + 1));
+
+    test_efficiency<GridImpl, StencilUpdateImpl>(width, height, 2 * iters_per_pass + 1);
+}
+
+TEST_CASE("monotile::StencilUpdate (kernel counters)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, 1, true>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    test_kernel_counters<GridImpl, StencilUpdateImpl>(tile_width / 2, tile_height / 2,
+                                                      2 * iters_per_pass + 1);
+
+    using VectorStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 4, 1, true>;
+    test_kernel_counters<GridImpl, VectorStencilUpdateImpl>(tile_width / 2, tile_height - 1,
+                                                            2 * iters_per_pass + 1);
+
+    using LoopbackStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, true, 1, 1, true>;
+    test_kernel_counters<GridImpl, LoopbackStencilUpdateImpl>(tile_width / 2, tile_height / 2,
+                                                              2 * iters_per_pass + 1, true);
+}
+
+TEST_CASE("monotile::StencilUpdate (dense storage)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, true>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    test_stencil_update<GridImpl, StencilUpdateImpl>(tile_width / 2, tile_height - 1, 0,
+                                                     iters_per_pass + 1);
+}
+
+TEST_CASE("monotile::StencilUpdate (fixed grid range)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, 1, false, true>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+    static_assert(StencilUpdateImpl::supports_grid_range(tile_width, tile_height));
+    static_assert(!StencilUpdateImpl::supports_grid_range(tile_width / 2, tile_height));
+
+    test_stencil_update<GridImpl, StencilUpdateImpl>(tile_width, tile_height, 0,
+                                                     2 * iters_per_pass + 1);
+
+    using LoopbackStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, true, 4, 1, false, true>;
+    test_stencil_update<GridImpl, LoopbackStencilUpdateImpl>(tile_width, tile_height, 0,
+                                                             2 * iters_per_pass + 1);
+
+    StencilUpdateImpl update({.transition_function = FPGATransFunc<1>()});
+    GridImpl grid(tile_width, tile_height - 1);
+    REQUIRE_THROWS_AS(update(grid), std::range_error);
+}
+
+TEST_CASE("monotile::StencilUpdate (static values)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<StaticValueTransFunc, n_processing_elements, tile_width, tile_height>;
+    test_static_values<StencilUpdateImpl>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = n_processing_elements + 1});
+}
+
+TEST_CASE("monotile::StencilUpdate (history)", "[monotile::StencilUpdate]") {
+    using TransFunc = HistoryTransitionFunction<HistoryTransFunc<1>>;
+    test_history<1, StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = TransFunc({}), .n_iterations = n_processing_elements + 1});
+
+    using SubiterationTransFunc = HistoryTransitionFunction<HistoryTransFunc<2>>;
+    test_history<2,
+                 StencilUpdate<SubiterationTransFunc, n_processing_elements, tile_width,
+                               tile_height>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = SubiterationTransFunc({}), .n_iterations = 3});
+
+    // The past levels of vectors and of grids in the on-chip buffer.
+    test_history<1, StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height,
+                                  tdv::single_pass::InlineStrategy, 64, false, false, 3>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = TransFunc({}), .n_iterations = n_processing_elements + 1});
+    test_history<1, StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height,
+                                  tdv::single_pass::InlineStrategy, 64, false, true>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = TransFunc({}), .n_iterations = 2 * n_processing_elements + 1});
+}
+
+TEST_CASE("monotile::StencilUpdate (constant table)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<ConstantTableTransFunc, n_processing_elements, tile_width, tile_height>;
+    test_constant_table<StencilUpdateImpl>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = ConstantTableTransFunc(),
+         .n_iterations = n_processing_elements + 1});
+}
+
+struct NegationKernel : public BaseTransitionFunction {
+    using Cell = bool;
+
+    bool operator()(Stencil<bool, 1> const &stencil) const { return !stencil[ID(0, 0)]; }
+};
+
+TEST_CASE("monotile::StencilUpdate (bit-packed grid)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<NegationKernel, n_processing_elements, tile_width, tile_height>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, NegationKernel, GridImpl>);
+
+    uindex_t grid_width = tile_width / 2;
+    uindex_t grid_height = tile_height - 1;
+    auto initial_value = [](uindex_t c, uindex_t r) { return (c + r) % 3 == 0; };
+
+    GridImpl grid(grid_width, grid_height);
+    {
+        GridImpl::GridAccessor<access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = initial_value(c, r);
+            }
+        }
+    }
+
+    for (uindex_t n_iterations : {n_processing_elements, n_processing_elements + 1}) {
+        StencilUpdateImpl update({.transition_function = NegationKernel(),
+                                  .halo_value = false,
+                                  .n_iterations = n_iterations});
+        GridImpl output_grid = update(grid);
+
+        GridImpl::GridAccessor<access::mode::read> ac(output_grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                REQUIRE(ac[c][r] == (initial_value(c, r) != (n_iterations % 2 == 1)));
+            }
+        }
+    }
+}
+
+template <typename TDVStrategy> void test_on_chip_loopback() {
+    using StencilUpdateImpl = StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width,
+                                            tile_height, TDVStrategy, 64, false, true>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    for (uindex_t n_iterations :
+         {uindex_t(1), iters_per_pass, 3 * iters_per_pass, 3 * iters_per_pass + 1}) {
+        StencilUpdateImpl update({.transition_function = FPGATransFunc<1>(),
+                                  .halo_value = Cell::halo(),
+                                  .iteration_offset = 3,
+                                  .n_iterations = n_iterations});
+        test_stencil_update<GridImpl, StencilUpdateImpl>(tile_width / 2, tile_height - 1, update);
+
+        // Only the target grid is needed.
+        REQUIRE(update.get_grid_pool()->get_n_grids() == 1);
+    }
+}
+
+TEST_CASE("monotile::StencilUpdate (on-chip loopback)", "[monotile::StencilUpdate]") {
+    test_on_chip_loopback<tdv::single_pass::InlineStrategy>();
+    test_on_chip_loopback<tdv::single_pass::PrecomputeOnDeviceStrategy>();
+    test_on_chip_loopback<tdv::single_pass::PrecomputeOnHostStrategy>();
+}
+
+template <uindex_t vector_width> void test_vector_width() {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, vector_width>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    // Grid heights that are and aren't multiples of the vector width.
+    for (uindex_t grid_height : {uindex_t(1), 2 * vector_width, tile_height - 1}) {
+        test_stencil_update<GridImpl, StencilUpdateImpl>(tile_width / 2, grid_height, 1,
+                                                         iters_per_pass + 1);
+    }
+}
+
+TEST_CASE("monotile::StencilUpdate (vector width)", "[monotile::StencilUpdate]") {
+    test_vector_width<2>();
+    test_vector_width<3>();
+    test_vector_width<4>();
+}
+
+TEST_CASE("monotile::StencilUpdate (vector width, on-chip loopback and static values)",
+          "[monotile::StencilUpdate]") {
+    using LoopbackStencilUpdate =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::PrecomputeOnDeviceStrategy, 64, false, true, 4>;
+    test_stencil_update<LoopbackStencilUpdate::GridImpl, LoopbackStencilUpdate>(
+        tile_width / 2, tile_height - 1, 0, 3 * iters_per_pass + 1);
+
+    using StaticValueStencilUpdate =
+        StencilUpdate<StaticValueTransFunc, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 4>;
+    test_static_values<StaticValueStencilUpdate>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = n_processing_elements + 1});
+}
+
+TEST_CASE("monotile::StencilUpdate (vector width, bit-packed grid)", "[monotile::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<NegationKernel, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 3>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+
+    uindex_t grid_width = tile_width / 2;
+    uindex_t grid_height = tile_height - 1;
+    auto initial_value = [](uindex_t c, uindex_t r) { return (c + r) % 3 == 0; };
+
+    GridImpl grid(grid_width, grid_height);
+    {
+        GridImpl::GridAccessor<access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = initial_value(c, r);
+            }
+        }
+    }
+
+    StencilUpdateImpl update({.transition_function = NegationKernel(),
+                              .halo_value = false,
+                              .n_iterations = n_processing_elements + 1});
+    GridImpl output_grid = update(grid);
+
+    GridImpl::GridAccessor<access::mode::read> ac(output_grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r] == !initial_value(c, r));
+        }
+    }
+}
+
+template <uindex_t n_compute_units> void test_compute_units() {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, n_compute_units>;
+    using GridImpl = StencilUpdateImpl::GridImpl;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    // Narrow grids leave some compute units without columns.
+    for (uindex_t grid_width : {uindex_t(3), tile_width / 2, tile_width - 1}) {
+        for (uindex_t n_iterations : {uindex_t(1), iters_per_pass, 3 * iters_per_pass + 1}) {
+            StencilUpdateImpl update({.transition_function = FPGATransFunc<1>(),
+                                      .halo_value = Cell::halo(),
+                                      .iteration_offset = 1,
+                                      .n_iterations = n_iterations});
+            test_stencil_update<GridImpl, StencilUpdateImpl>(grid_width, tile_height - 1, update);
+
+            // Only the target grid is taken from the pool.
+            REQUIRE(update.get_grid_pool()->get_n_grids() == 1);
+        }
+    }
+
+    // Without iterations, the source grid is returned and no grid is taken from the pool.
+    StencilUpdateImpl idle_update({.transition_function = FPGATransFunc<1>(),
+                                   .halo_value = Cell::halo(),
+                                   .iteration_offset = 1,
+                                   .n_iterations = 0});
+    test_stencil_update<GridImpl, StencilUpdateImpl>(tile_width - 1, tile_height - 1, idle_update);
+    REQUIRE(idle_update.get_grid_pool()->get_n_grids() == 0);
+}
+
+TEST_CASE("monotile::StencilUpdate (compute units)", "[monotile::StencilUpdate]") {
+    test_compute_units<2>();
+    test_compute_units<3>();
+}
+
+TEST_CASE("monotile::StencilUpdate (compute units with vectors and static values)",
+          "[monotile::StencilUpdate]") {
+    using VectorStencilUpdate =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::PrecomputeOnHostStrategy, 64, false, false, 3, 2>;
+    test_stencil_update<VectorStencilUpdate::GridImpl, VectorStencilUpdate>(
+        tile_width - 1, tile_height - 1, 0, 2 * iters_per_pass + 1);
+
+    using StaticValueStencilUpdate =
+        StencilUpdate<StaticValueTransFunc, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, 2>;
+    test_static_values<StaticValueStencilUpdate>(
+        tile_width - 1, tile_height - 1,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = n_processing_elements + 1});
+}
+
+template <typename SU> void test_reduction_iterations() {
+    for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass + 1}) {
+        test_reduction<SU>(tile_width - 1, tile_height - 1,
+                           {.transition_function = ReducingTransFunc<1>(),
+                            .halo_value = Cell::halo(),
+                            .n_iterations = n_iterations});
+    }
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition = BoundaryCondition::Constant>
+using ShapedStencilUpdate = StencilUpdate<ShapedTransFunc<shape, boundary_condition>,
+                                          n_processing_elements, tile_width, tile_height>;
+
+TEST_CASE("monotile::StencilUpdate (stencil shape)", "[monotile::StencilUpdate]") {
+    constexpr StencilShape star = StencilShape::star(2);
+    constexpr StencilShape box = StencilShape::asymmetric_box(0, 2, 1, 0);
+    constexpr StencilShape asymmetric_star = StencilShape::asymmetric_star(1, 0, 2, 1);
+
+    test_stencil_shape<star, ShapedStencilUpdate<star>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = ShapedTransFunc<star>(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements + 1});
+    test_stencil_shape<box, ShapedStencilUpdate<box>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = ShapedTransFunc<box>(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements + 1});
+    test_stencil_shape<asymmetric_star, ShapedStencilUpdate<asymmetric_star>>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = ShapedTransFunc<asymmetric_star>(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements + 1});
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition, bool with_history = false>
+void test_shaped_boundary_condition() {
+    using TransFunc = BoundaryTransFunc<shape, boundary_condition, with_history>;
+    using StencilUpdateImpl =
+        StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height>;
+    test_boundary_condition<shape, boundary_condition, StencilUpdateImpl, with_history>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = TransFunc({}), .n_iterations = n_processing_elements + 1});
+}
+
+template <BoundaryCondition boundary_condition>
+concept supports_boundary_condition = requires {
+    typename ShapedStencilUpdate<StencilShape::box(2), boundary_condition>::Params;
+};
+
+TEST_CASE("monotile::StencilUpdate (boundary conditions)", "[monotile::StencilUpdate]") {
+    constexpr StencilShape box = StencilShape::box(2);
+    // Reflected cells of asymmetric shapes lie on the other side of the central cell and therefore
+    // outside of the shape.
+    constexpr StencilShape south_east = StencilShape::asymmetric_box(0, 2, 0, 2);
+    constexpr StencilShape north_west = StencilShape::asymmetric_star(2, 0, 2, 0);
+
+    test_shaped_boundary_condition<box, BoundaryCondition::Clamp>();
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Clamp>();
+    test_shaped_boundary_condition<north_west, BoundaryCondition::Clamp>();
+    test_shaped_boundary_condition<box, BoundaryCondition::Reflect>();
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Reflect>();
+    test_shaped_boundary_condition<north_west, BoundaryCondition::Reflect>();
+
+    // Multistep schemes keep the boundary condition of the wrapped transition function.
+    test_shaped_boundary_condition<box, BoundaryCondition::Clamp, true>();
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Reflect, true>();
+
+    // Cells can only be reflected once.
+    using ReflectingStencilUpdate = ShapedStencilUpdate<box, BoundaryCondition::Reflect>;
+    ReflectingStencilUpdate update(
+        {.transition_function = ShapedTransFunc<box, BoundaryCondition::Reflect>()});
+    typename ReflectingStencilUpdate::GridImpl grid(1, tile_height - 1);
+    REQUIRE_THROWS_AS(update(grid), std::invalid_argument);
+
+    // Periodic boundaries would need the cells of the opposite border, which the streaming
+    // pipeline doesn't hold.
+    static_assert(supports_boundary_condition<BoundaryCondition::Reflect>);
+    static_assert(!supports_boundary_condition<BoundaryCondition::Periodic>);
+}
+
+TEST_CASE("monotile::StencilUpdate (chained transition functions)",
+          "[monotile::StencilUpdate]") {
+    // Two iterations of the chain per pass.
+    using ChainedStencilUpdate =
+        StencilUpdate<ChainedTransFunc, 2 * ChainedTransFunc::n_subiterations, tile_width,
+                      tile_height>;
+    test_chained_trans_func<ChainedStencilUpdate>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = ChainedTransFunc(), .halo_value = 1, .n_iterations = 3});
+    test_chained_trans_func<ChainedStencilUpdate>(
+        tile_width / 2, tile_height - 1,
+        {.transition_function = ChainedTransFunc(),
+         .halo_value = 2,
+         .iteration_offset = 2,
+         .n_iterations = 1});
+}
+
+TEST_CASE("monotile::StencilUpdate (reduction)", "[monotile::StencilUpdate]") {
+    test_reduction_iterations<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height>>();
+
+    // Padding cells of vectors must not be reduced.
+    test_reduction_iterations<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 4>>();
+
+    test_reduction_iterations<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, true>>();
+
+    // Every compute unit reduces its own core.
+    test_reduction_iterations<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, 2>>();
+}
+
+/**
+ * \brief A transition function that streams one column of every pass and one row of the last
+ * pass to the host.
+ */
+struct StreamingTransFunc : public FPGATransFunc<1> {
+    struct HostStream {
+        using pipe = HostPipe<class MonotileHostStreamPipeID, StreamedCell<Cell>>;
+
+        uindex_t column;
+        uindex_t row;
+        uindex_t last_iteration;
+
+        bool selects(ID id, uindex_t i_iteration) const {
+            return id.c == index_t(column) ||
+                   (id.r == index_t(row) && i_iteration == last_iteration);
+        }
+    };
+};
+
+template <uindex_t n_compute_units>
+concept streams_with_compute_units = requires {
+    typename StencilUpdate<StreamingTransFunc, n_processing_elements, tile_width, tile_height,
+                           tdv::single_pass::InlineStrategy, 64, false, false, 1,
+                           n_compute_units>::Params;
+};
+
+template <typename SU> void test_host_stream(bool on_chip_loopback = false) {
+    using Pipe = StreamingTransFunc::HostStream::pipe;
+    uindex_t grid_width = tile_width - 1;
+    uindex_t grid_height = tile_height - 1;
+    uindex_t n_iterations = 2 * iters_per_pass + 1;
+    StreamingTransFunc::HostStream stream{.column = 40, .row = 5, .last_iteration = n_iterations};
+
+    typename SU::GridImpl grid(grid_width, grid_height);
+    {
+        typename SU::GridImpl::template GridAccessor<access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = Cell{index_t(c), index_t(r), 0, 0, CellStatus::Normal};
+            }
+        }
+    }
+
+    SU update({.transition_function = StreamingTransFunc(),
+               .halo_value = Cell::halo(),
+               .n_iterations = n_iterations,
+               .blocking = true,
+               .host_stream = stream});
+    update(grid);
+
+    std::map<uindex_t, uindex_t> n_cells_per_iteration;
+    while (!Pipe::empty()) {
+        StreamedCell<Cell> streamed_cell = Pipe::read();
+        REQUIRE(stream.selects(streamed_cell.id, streamed_cell.i_iteration));
+        REQUIRE(streamed_cell.cell.c == streamed_cell.id.c);
+        REQUIRE(streamed_cell.cell.r == streamed_cell.id.r);
+        REQUIRE(streamed_cell.cell.i_iteration == index_t(streamed_cell.i_iteration));
+        REQUIRE(streamed_cell.cell.status == CellStatus::Normal);
+        n_cells_per_iteration[streamed_cell.i_iteration]++;
+    }
+
+    // The column is streamed after every pass and the row only after the last one.
+    std::map<uindex_t, uindex_t> expected;
+    if (!on_chip_loopback) {
+        expected[iters_per_pass] = grid_height;
+        expected[2 * iters_per_pass] = grid_height;
+    }
+    expected[n_iterations] = grid_height + grid_width - 1;
+    REQUIRE(n_cells_per_iteration == expected);
+}
+
+TEST_CASE("monotile::StencilUpdate (host stream)", "[monotile::StencilUpdate]") {
+    test_host_stream<
+        StencilUpdate<StreamingTransFunc, n_processing_elements, tile_width, tile_height>>();
+
+    // Padding cells of vectors must not be streamed.
+    test_host_stream<
+        StencilUpdate<StreamingTransFunc, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 4>>();
+
+    test_host_stream<
+        StencilUpdate<StreamingTransFunc, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, true>>(true);
+
+    // Host pipes only allow a single writing kernel, so only one compute unit may stream.
+    static_assert(streams_with_compute_units<1>);
+    static_assert(!streams_with_compute_units<2>);
+}
+
+TEST_CASE("monotile::StencilUpdate (run until)", "[monotile::StencilUpdate]") {
+    test_run_until<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height>>(
+        tile_width - 1, tile_height - 1,
+        {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo()});
+
+    test_run_until<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, 64, false, false, 1, 2>>(
+        tile_width - 1, tile_height - 1,
+        {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo()});
+}
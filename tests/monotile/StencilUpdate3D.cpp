@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "../StencilUpdateTest.hpp"
+#include "../constants.hpp"
+#include <StencilStream/monotile/StencilUpdate3D.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace stencil;
+using namespace stencil::monotile;
+
+constexpr uindex_t max_grid_height = 8;
+constexpr uindex_t max_grid_depth = 8;
+
+TEST_CASE("monotile::StencilUpdate3D", "[monotile::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<1>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, max_grid_height, max_grid_depth>;
+
+    for (uindex_t n_iterations :
+         {uindex_t(1), n_processing_elements, 2 * n_processing_elements + 1}) {
+        test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+            7, max_grid_height, 5,
+            {.transition_function = TransFunc(),
+             .halo_value = 1,
+             .iteration_offset = 3,
+             .n_iterations = n_iterations});
+    }
+    test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+        3, 2, max_grid_depth,
+        {.transition_function = TransFunc(), .halo_value = 2, .n_iterations = 5});
+}
+
+TEST_CASE("monotile::StencilUpdate3D (radius 2, sub-iterations)", "[monotile::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<2, 2>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, max_grid_height, max_grid_depth>;
+
+    test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+        6, 5, 7,
+        {.transition_function = TransFunc(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements / 2 + 1});
+}
+
+TEST_CASE("monotile::StencilUpdate3D (grid size checks)", "[monotile::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<2>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, max_grid_height, max_grid_depth>;
+    using Grid = StencilUpdateImpl::GridImpl;
+
+    StencilUpdateImpl update({.transition_function = TransFunc()});
+    Grid too_tall(4, max_grid_height + 1, 4);
+    REQUIRE_THROWS_AS(update(too_tall), std::range_error);
+    Grid too_deep(4, 4, max_grid_depth + 1);
+    REQUIRE_THROWS_AS(update(too_deep), std::range_error);
+    Grid too_flat(4, 2, 4);
+    REQUIRE_THROWS_AS(update(too_flat), std::range_error);
+}
+
+TEST_CASE("monotile::StencilUpdate3D (grid pool)", "[monotile::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<1>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, max_grid_height, max_grid_depth>;
+    test_grid_pool_3d<StencilUpdateImpl, TransFunc>(5, 4, 3);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "../TransFuncs.hpp"
+#include "../constants.hpp"
+#include <StencilStream/tiling/DistributedStencilUpdate.hpp>
+#include <catch2/catch_all.hpp>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace sycl;
+using namespace stencil;
+using namespace stencil::tiling;
+
+struct Mailbox {
+    std::mutex mutex;
+    std::condition_variable message_posted;
+    std::map<std::pair<uindex_t, uindex_t>, std::deque<std::vector<Cell>>> messages;
+    // Catch's assertions are not thread-safe, so the ranks only count the failed receives.
+    uindex_t n_size_mismatches = 0;
+
+    void post(uindex_t from, uindex_t to, std::vector<Cell> const &message) {
+        {
+            std::lock_guard lock(mutex);
+            messages[{from, to}].push_back(message);
+        }
+        message_posted.notify_all();
+    }
+
+    void receive(uindex_t from, uindex_t to, std::vector<Cell> &message) {
+        std::unique_lock lock(mutex);
+        auto &queue = messages[{from, to}];
+        message_posted.wait(lock, [&]() { return !queue.empty(); });
+        if (queue.front().size() == message.size()) {
+            message = queue.front();
+        } else {
+            n_size_mismatches++;
+        }
+        queue.pop_front();
+    }
+};
+
+// Every rank has its own communicator type, which gives every rank its own kernels and pipes.
+template <uindex_t i_rank> class ThreadCommunicator {
+  public:
+    ThreadCommunicator(Mailbox &mailbox, uindex_t n_ranks) : mailbox(&mailbox), n_ranks(n_ranks) {}
+
+    uindex_t get_rank() const { return i_rank; }
+
+    uindex_t get_n_ranks() const { return n_ranks; }
+
+    void exchange(std::vector<Cell> const &send_left, std::vector<Cell> const &send_right,
+                  std::vector<Cell> &receive_left, std::vector<Cell> &receive_right) {
+        if (i_rank > 0) {
+            mailbox->post(i_rank, i_rank - 1, send_left);
+        }
+        if (i_rank + 1 < n_ranks) {
+            mailbox->post(i_rank, i_rank + 1, send_right);
+        }
+        if (i_rank > 0) {
+            mailbox->receive(i_rank - 1, i_rank, receive_left);
+        }
+        if (i_rank + 1 < n_ranks) {
+            mailbox->receive(i_rank + 1, i_rank, receive_right);
+        }
+    }
+
+  private:
+    Mailbox *mailbox;
+    uindex_t n_ranks;
+};
+
+using TransFunc = FPGATransFunc<stencil_radius>;
+
+template <uindex_t i_rank>
+using TestUpdate = DistributedStencilUpdate<TransFunc, ThreadCommunicator<i_rank>,
+                                            n_processing_elements, tile_width, tile_height>;
+
+using LocalGrid = TestUpdate<0>::GridImpl;
+
+template <uindex_t i_rank>
+void run_rank(Mailbox &mailbox, uindex_t n_ranks, uindex_t grid_width, uindex_t grid_height,
+              uindex_t iteration_offset, uindex_t n_iterations, uindex_t n_calls,
+              std::vector<Cell> &output, uindex_t &n_pool_grids) {
+    TestUpdate<i_rank> update({.transition_function = TransFunc(),
+                               .halo_value = Cell::halo(),
+                               .iteration_offset = iteration_offset,
+                               .n_iterations = n_iterations},
+                              ThreadCommunicator<i_rank>(mailbox, n_ranks), grid_width);
+    uindex_t column_begin = update.get_column_begin();
+    uindex_t n_columns = update.get_column_end() - column_begin;
+
+    LocalGrid input_grid(n_columns, grid_height);
+    {
+        LocalGrid::GridAccessor<access::mode::read_write> ac(input_grid);
+        for (uindex_t c = 0; c < n_columns; c++) {
+            for (uindex_t r = 0; r < grid_height; r++) {
+                ac[c][r] = Cell{index_t(column_begin + c), index_t(r), index_t(iteration_offset),
+                                0, CellStatus::Normal};
+            }
+        }
+    }
+
+    LocalGrid output_grid = input_grid;
+    for (uindex_t i_call = 0; i_call < n_calls; i_call++) {
+        output_grid = update(output_grid);
+        update.get_params().iteration_offset += n_iterations;
+    }
+    n_pool_grids = update.get_grid_pool()->get_n_grids();
+
+    LocalGrid::GridAccessor<access::mode::read_write> ac(output_grid);
+    for (uindex_t c = 0; c < n_columns; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            output.push_back(ac[c][r]);
+        }
+    }
+}
+
+template <uindex_t... i_ranks>
+void test_distributed_update(std::integer_sequence<uindex_t, i_ranks...>, uindex_t grid_width,
+                             uindex_t grid_height, uindex_t iteration_offset,
+                             uindex_t n_iterations, uindex_t n_calls = 1) {
+    constexpr uindex_t n_ranks = sizeof...(i_ranks);
+    Mailbox mailbox;
+    std::array<std::vector<Cell>, n_ranks> outputs;
+    std::array<uindex_t, n_ranks> n_pool_grids;
+
+    // The assertions are evaluated on the main thread, after all ranks have finished.
+    std::array<std::thread, n_ranks> threads = {std::thread([&]() {
+        run_rank<i_ranks>(mailbox, n_ranks, grid_width, grid_height, iteration_offset,
+                          n_iterations, n_calls, outputs[i_ranks], n_pool_grids[i_ranks]);
+    })...};
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    REQUIRE(mailbox.n_size_mismatches == 0);
+    // In a loop like `grid = update(grid)`, the output grids of two calls alternate.
+    for (uindex_t n_grids : n_pool_grids) {
+        REQUIRE(n_grids <= 2);
+    }
+
+    // Concatenated, the outputs of the ranks form the global grid.
+    uindex_t column_begin = 0;
+    for (std::vector<Cell> const &output : outputs) {
+        REQUIRE(output.size() % grid_height == 0);
+        for (uindex_t i = 0; i < output.size(); i++) {
+            Cell cell = output[i];
+            REQUIRE(cell.c == column_begin + i / grid_height);
+            REQUIRE(cell.r == i % grid_height);
+            REQUIRE(cell.i_iteration == iteration_offset + n_calls * n_iterations);
+            REQUIRE(cell.i_subiteration == 0);
+            REQUIRE(cell.status == CellStatus::Normal);
+        }
+        column_begin += output.size() / grid_height;
+    }
+    REQUIRE(column_begin == grid_width);
+}
+
+TEST_CASE("tiling::DistributedStencilUpdate", "[tiling::DistributedStencilUpdate]") {
+    for (uindex_t n_iterations : {uindex_t(0), uindex_t(1), iters_per_pass,
+                                   3 * iters_per_pass + 1}) {
+        test_distributed_update(std::integer_sequence<uindex_t, 0>(), grid_width, grid_height, 0,
+                                n_iterations);
+        test_distributed_update(std::make_integer_sequence<uindex_t, 2>(), grid_width,
+                                grid_height, 0, n_iterations);
+        test_distributed_update(std::make_integer_sequence<uindex_t, 3>(), grid_width + 5,
+                                grid_height + 3, 7, n_iterations);
+    }
+}
+
+TEST_CASE("tiling::DistributedStencilUpdate (repeated calls)",
+          "[tiling::DistributedStencilUpdate]") {
+    test_distributed_update(std::make_integer_sequence<uindex_t, 3>(), grid_width + 5,
+                            grid_height, 0, iters_per_pass + 1, 4);
+}
+
+TEST_CASE("tiling::DistributedStencilUpdate (narrow strips)",
+          "[tiling::DistributedStencilUpdate]") {
+    Mailbox mailbox;
+    TestUpdate<1>::Params params = {.transition_function = TransFunc()};
+
+    // Every strip needs to cover the columns that are sent to the neighbors.
+    REQUIRE_THROWS_AS(TestUpdate<1>(params, ThreadCommunicator<1>(mailbox, 3), 3 * halo_radius - 1),
+                      std::invalid_argument);
+    TestUpdate<1> update(params, ThreadCommunicator<1>(mailbox, 3), 3 * halo_radius);
+    REQUIRE(update.get_column_begin() == halo_radius);
+    REQUIRE(update.get_column_end() == 2 * halo_radius);
+
+    LocalGrid grid(halo_radius + 1, grid_height);
+    REQUIRE_THROWS_AS(update(grid), std::range_error);
+}
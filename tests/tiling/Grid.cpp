@@ -49,10 +49,57 @@ TEST_CASE("tiling::Grid::copy_to_buffer", "[tiling::Grid]") {
     grid_test::test_copy_to_buffer<TestGrid>(add_grid_width, add_grid_height);
 }
 
+TEST_CASE("tiling::Grid (parallel copy)", "[tiling::Grid]") {
+    // Large enough to be copied by multiple threads, with partial tiles at the edges.
+    grid_test::test_copy_from_buffer<TestGrid>(601, 299);
+    grid_test::test_copy_to_buffer<TestGrid>(601, 299);
+}
+
+TEST_CASE("tiling::Grid::generate", "[tiling::Grid]") {
+    grid_test::test_generate<TestGrid>(add_grid_width, add_grid_height);
+    grid_test::test_generate<Grid<ID, 13, 11, 3>>(30, 25);
+}
+
+TEST_CASE("tiling::Grid::GridAccessor (column segments)", "[tiling::Grid]") {
+    using SegmentGrid = Grid<ID, 13, 11, 3>;
+    uindex_t grid_width = 30, grid_height = 25;
+    SegmentGrid grid(grid_width, grid_height);
+    uindex_t tile_range_r = grid.get_tile_range().r;
+    {
+        SegmentGrid::GridAccessor<access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < grid_width; c++) {
+            uindex_t r = 0;
+            for (uindex_t tile_r = 0; tile_r < tile_range_r; tile_r++) {
+                for (ID &cell : ac.get_column_segment(c, tile_r)) {
+                    cell = ID(c, r);
+                    r++;
+                }
+            }
+            REQUIRE(r == grid_height);
+        }
+    }
+
+    SegmentGrid::GridAccessor<access::mode::read> ac(grid);
+    for (uindex_t c = 0; c < grid_width; c++) {
+        for (uindex_t r = 0; r < grid_height; r++) {
+            REQUIRE(ac[c][r] == ID(c, r));
+        }
+    }
+}
+
 TEST_CASE("tiling::Grid::make_similar", "[tiling::Grid]") {
     grid_test::test_make_similar<TestGrid>(add_grid_width, add_grid_height);
 }
 
+TEST_CASE("tiling::Grid::get_n_references", "[tiling::Grid]") {
+    grid_test::test_n_references<TestGrid>(add_grid_width, add_grid_height);
+}
+
+TEST_CASE("tiling::Grid::project", "[tiling::Grid]") {
+    grid_test::test_project<TestGrid>(add_grid_width, add_grid_height);
+    grid_test::test_project<Grid<ID, 13, 11, 3>>(30, 25);
+}
+
 TEST_CASE("tiling::Grid::submit_read", "[tiling::Grid]") {
     TestGrid grid(3 * tile_width, 3 * tile_height);
     {
@@ -142,3 +189,253 @@ TEST_CASE("tiling::Grid::submit_write", "[tiling::Grid]") {
         }
     }
 }
+
+template <typename G> class SubmitReadTilesPipeID;
+
+template <typename G>
+void test_submit_read_tiles(uindex_t width, uindex_t height, uindex_t g_tile_width,
+                            uindex_t g_tile_height, uindex_t g_halo_radius) {
+    G grid(width, height);
+    {
+        using GridAccessor = typename G::template GridAccessor<access::mode::read_write>;
+        GridAccessor ac(grid);
+        for (uindex_t c = 0; c < width; c++) {
+            for (uindex_t r = 0; r < height; r++) {
+                ac[c][r] = ID(c, r);
+            }
+        }
+    }
+
+    using in_pipe = sycl::pipe<SubmitReadTilesPipeID<G>, ID>;
+    sycl::queue input_kernel_queue =
+        sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+    sycl::queue working_queue = sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+
+    grid.template submit_read_tiles<in_pipe>(input_kernel_queue, ID(-1, -1));
+
+    sycl::buffer<bool, 1> result_buffer = sycl::range<1>(1);
+    working_queue.submit([&](sycl::handler &cgh) {
+        accessor result_ac(result_buffer, cgh, write_only);
+        index_t w = width, h = height;
+        index_t tw = g_tile_width, th = g_tile_height, hr = g_halo_radius;
+        index_t n_tile_columns = grid.get_tile_range().c;
+        index_t n_tile_rows = grid.get_tile_range().r;
+
+        cgh.single_task([=]() {
+            bool correct_input = true;
+            for (index_t tile_c = 0; tile_c < n_tile_columns; tile_c++) {
+                for (index_t tile_r = 0; tile_r < n_tile_rows; tile_r++) {
+                    index_t c_end = std::min(w, (tile_c + 1) * tw) + hr;
+                    index_t r_end = std::min(h, (tile_r + 1) * th) + hr;
+                    for (index_t c = tile_c * tw - hr; c < c_end; c++) {
+                        for (index_t r = tile_r * th - hr; r < r_end; r++) {
+                            ID read_value = in_pipe::read();
+                            if (c >= 0 && r >= 0 && c < w && r < h) {
+                                correct_input &= read_value == ID(c, r);
+                            } else {
+                                correct_input &= read_value == ID(-1, -1);
+                            }
+                        }
+                    }
+                }
+            }
+            result_ac[0] = correct_input;
+        });
+    });
+
+    CHECK(host_accessor(result_buffer)[0]);
+}
+
+TEST_CASE("tiling::Grid::submit_read_tiles", "[tiling::Grid]") {
+    test_submit_read_tiles<TestGrid>(2 * tile_width + 1, tile_height + 1, tile_width, tile_height,
+                                     halo_radius);
+    // Tile columns that aren't multiples of the word length.
+    test_submit_read_tiles<Grid<ID, 13, 11, 3>>(30, 25, 13, 11, 3);
+}
+
+template <typename G> class SubmitWriteTilesPipeID;
+
+template <typename G>
+void test_submit_write_tiles(uindex_t width, uindex_t height, uindex_t g_tile_width,
+                             uindex_t g_tile_height) {
+    using out_pipe = sycl::pipe<SubmitWriteTilesPipeID<G>, ID>;
+
+    sycl::queue output_kernel_queue =
+        sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+    sycl::queue working_queue = sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+
+    G grid(width, height);
+
+    working_queue.submit([&](sycl::handler &cgh) {
+        index_t w = width, h = height;
+        index_t tw = g_tile_width, th = g_tile_height;
+        index_t n_tile_columns = grid.get_tile_range().c;
+        index_t n_tile_rows = grid.get_tile_range().r;
+
+        cgh.single_task([=]() {
+            for (index_t tile_c = 0; tile_c < n_tile_columns; tile_c++) {
+                for (index_t tile_r = 0; tile_r < n_tile_rows; tile_r++) {
+                    index_t c_end = std::min(w, (tile_c + 1) * tw);
+                    index_t r_end = std::min(h, (tile_r + 1) * th);
+                    for (index_t c = tile_c * tw; c < c_end; c++) {
+                        for (index_t r = tile_r * th; r < r_end; r++) {
+                            out_pipe::write(ID(c, r));
+                        }
+                    }
+                }
+            }
+        });
+    });
+
+    grid.template submit_write_tiles<out_pipe>(output_kernel_queue);
+
+    using GridAccessor = typename G::template GridAccessor<access::mode::read_write>;
+    GridAccessor out_ac(grid);
+    for (uindex_t c = 0; c < width; c++) {
+        for (uindex_t r = 0; r < height; r++) {
+            CHECK(out_ac[c][r].c == c);
+            CHECK(out_ac[c][r].r == r);
+        }
+    }
+}
+
+TEST_CASE("tiling::Grid::submit_write_tiles", "[tiling::Grid]") {
+    test_submit_write_tiles<TestGrid>(2 * tile_width + 1, tile_height + 1, tile_width,
+                                      tile_height);
+    test_submit_write_tiles<Grid<ID, 13, 11, 3>>(30, 25, 13, 11);
+}
+
+TEST_CASE("tiling::Grid::submit_tracked_write", "[tiling::Grid]") {
+    using out_pipe = sycl::pipe<class tiled_grid_submit_tracked_write_test_id, ID>;
+
+    sycl::queue output_kernel_queue =
+        sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+    sycl::queue working_queue = sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+
+    TestGrid reference(2 * tile_width, tile_height);
+    {
+        using GridAccessor = TestGrid::template GridAccessor<access::mode::read_write>;
+        GridAccessor ac(reference);
+        for (uindex_t c = 0; c < 2 * tile_width; c++) {
+            for (uindex_t r = 0; r < tile_height; r++) {
+                ac[c][r] = ID(c, r);
+            }
+        }
+    }
+    TestGrid grid = reference.make_similar();
+    sycl::buffer<bool, 1> changed_flags = sycl::range<1>(2);
+
+    for (uindex_t tile_c = 0; tile_c < 2; tile_c++) {
+        working_queue.submit([&](sycl::handler &cgh) {
+            index_t c_start = tile_c * tile_width;
+            index_t c_end = (tile_c + 1) * tile_width;
+            bool change = tile_c == 1;
+
+            cgh.single_task<class tiled_grid_submit_tracked_write_test_kernel>([=]() {
+                for (index_t c = c_start; c < c_end; c++) {
+                    for (index_t r = 0; r < index_t(tile_height); r++) {
+                        bool changed_cell = change && c == c_end - 1 && r == 3;
+                        out_pipe::write(changed_cell ? ID(-1, -1) : ID(c, r));
+                    }
+                }
+            });
+        });
+
+        grid.template submit_tracked_write<out_pipe>(output_kernel_queue, tile_c, 0, reference,
+                                                     changed_flags);
+    }
+
+    sycl::host_accessor changed_ac(changed_flags, sycl::read_only);
+    CHECK(!changed_ac[0]);
+    CHECK(changed_ac[1]);
+
+    using GridAccessor = TestGrid::template GridAccessor<access::mode::read>;
+    GridAccessor out_ac(grid);
+    CHECK(out_ac[0][3] == ID(0, 3));
+    CHECK(out_ac[2 * tile_width - 1][3] == ID(-1, -1));
+}
+
+TEST_CASE("tiling::Grid::submit_copy_tile", "[tiling::Grid]") {
+    TestGrid source(2 * tile_width + 1, tile_height);
+    {
+        using GridAccessor = TestGrid::template GridAccessor<access::mode::read_write>;
+        GridAccessor ac(source);
+        for (uindex_t c = 0; c < 2 * tile_width + 1; c++) {
+            for (uindex_t r = 0; r < tile_height; r++) {
+                ac[c][r] = ID(c, r);
+            }
+        }
+    }
+    TestGrid grid = source.make_similar();
+
+    sycl::queue queue = sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+    for (uindex_t tile_c = 0; tile_c < 3; tile_c++) {
+        grid.submit_copy_tile(queue, source, tile_c, 0);
+    }
+    REQUIRE_THROWS_AS(grid.submit_copy_tile(queue, source, 3, 0), std::out_of_range);
+
+    using GridAccessor = TestGrid::template GridAccessor<access::mode::read>;
+    GridAccessor out_ac(grid);
+    for (uindex_t c = 0; c < 2 * tile_width + 1; c++) {
+        for (uindex_t r = 0; r < tile_height; r++) {
+            CHECK(out_ac[c][r] == ID(c, r));
+        }
+    }
+}
+
+TEST_CASE("tiling::Grid (cell codec)", "[tiling::Grid]") {
+    using grid_test::CodedCell;
+    using CodedGrid = Grid<CodedCell, 13, 11, 3>;
+    static_assert(concepts::Grid<CodedGrid, CodedCell>);
+
+    uindex_t width = 30, height = 25;
+    grid_test::test_cell_codec<CodedGrid>(width, height);
+
+    CodedGrid grid(width, height);
+    {
+        CodedGrid::GridAccessor<access::mode::discard_write> ac(grid);
+        for (uindex_t c = 0; c < width; c++) {
+            for (uindex_t r = 0; r < height; r++) {
+                ac[c][r] = CodedCell{grid_test::coded_value(c, r)};
+            }
+        }
+    }
+
+    // Full-precision cells are sent through the pipes.
+    using in_pipe = sycl::pipe<class tiled_coded_grid_test_in_pipe, CodedCell>;
+    using out_pipe = sycl::pipe<class tiled_coded_grid_test_out_pipe, CodedCell>;
+    sycl::queue queue = sycl::queue(sycl::device(), {sycl::property::queue::in_order{}});
+    grid.template submit_read_tiles<in_pipe>(queue, CodedCell{-1.0});
+    queue.submit([&](sycl::handler &cgh) {
+        index_t w = width, h = height, tw = 13, th = 11, hr = 3;
+        index_t n_tile_columns = grid.get_tile_range().c;
+        index_t n_tile_rows = grid.get_tile_range().r;
+
+        cgh.single_task([=]() {
+            for (index_t tile_c = 0; tile_c < n_tile_columns; tile_c++) {
+                for (index_t tile_r = 0; tile_r < n_tile_rows; tile_r++) {
+                    index_t c_end = std::min(w, (tile_c + 1) * tw);
+                    index_t r_end = std::min(h, (tile_r + 1) * th);
+                    for (index_t c = tile_c * tw - hr; c < c_end + hr; c++) {
+                        for (index_t r = tile_r * th - hr; r < r_end + hr; r++) {
+                            CodedCell cell = in_pipe::read();
+                            if (c >= tile_c * tw && c < c_end && r >= tile_r * th && r < r_end) {
+                                out_pipe::write(CodedCell{cell.value + 1.0 / 3.0});
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    });
+    CodedGrid copy = grid.make_similar();
+    copy.template submit_write_tiles<out_pipe>(queue);
+
+    CodedGrid::GridAccessor<access::mode::read> ac(copy);
+    for (uindex_t c = 0; c < width; c++) {
+        for (uindex_t r = 0; r < height; r++) {
+            double value = grid_test::stored_value(grid_test::coded_value(c, r)) + 1.0 / 3.0;
+            REQUIRE(ac[c][r].value == grid_test::stored_value(value));
+        }
+    }
+}
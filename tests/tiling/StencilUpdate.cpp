@@ -226,4 +226,380 @@ TEST_CASE("tiling::StencilUpdate", "[tiling::StencilUpdate]") {
                                                              iters_per_pass + 1);
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("tiling::StencilUpdate (warm-up)", "[tiling::StencilUpdate]") {
+    test_warm_up<GridImpl, StencilUpdateImpl>(tile_width + 1, tile_height / 2, iters_per_pass + 1);
+}
+
+TEST_CASE("tiling::StencilUpdate (grid pool)", "[tiling::StencilUpdate]") {
+    test_grid_pool<GridImpl, StencilUpdateImpl>(tile_width + 1, tile_height / 2,
+                                               iters_per_pass + 1);
+}
+
+TEST_CASE("tiling::StencilUpdate (overwrite source)", "[tiling::StencilUpdate]") {
+    for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass, 2 * iters_per_pass + 1}) {
+        test_overwrite_source<GridImpl, StencilUpdateImpl>(tile_width + 1, tile_height / 2,
+                                                           n_iterations);
+    }
+}
+
+TEST_CASE("tiling::StencilUpdate (timeline)", "[tiling::StencilUpdate]") {
+    // The grid consists of two tiles, so every pass has two read, compute and write kernels.
+    test_timeline<GridImpl, StencilUpdateImpl>(tile_width + 1, tile_height / 2,
+                                               2 * iters_per_pass + 1, 2);
+}
+
+TEST_CASE("tiling::StencilUpdate (performance model)", "[tiling::StencilUpdate]") {
+    // Every tile is streamed together with its halo, and the second tile is only one column wide.
+    constexpr uindex_t halo = StencilUpdateImpl::halo_radius;
+    constexpr double n_cycles_per_pass = (tile_width + 2 * halo) * (tile_height / 2 + 2 * halo) +
+                                         (1 + 2 * halo) * (tile_height / 2 + 2 * halo);
+    static_assert(StencilUpdateImpl::model_runtime(tile_width + 1, tile_height / 2, 0, 1.0) ==
+                  0.0);
+    REQUIRE(StencilUpdateImpl::model_runtime(tile_width + 1, tile_height / 2, iters_per_pass,
+                                             1.0) == n_cycles_per_pass);
+    REQUIRE(StencilUpdateImpl::model_runtime(tile_width + 1, tile_height / 2,
+                                             2 * iters_per_pass + 1, 2.0) ==
+            3 * n_cycles_per_pass / 2.0);
+
+    // The loop latency is added once per tile, or once per pass with a persistent kernel.
+    using PersistentStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, true>;
+    REQUIRE(StencilUpdateImpl::model_runtime(tile_width + 1, tile_height / 2, iters_per_pass, 1.0,
+                                             100) == n_cycles_per_pass + 200);
+    REQUIRE(PersistentStencilUpdateImpl::model_runtime(tile_width + 1, tile_height / 2,
+                                                       iters_per_pass, 1.0,
+                                                       100) == n_cycles_per_pass + 100);
+
+    test_efficiency<GridImpl, StencilUpdateImpl>(tile_width + 1, tile_height / 2,
+                                                 2 * iters_per_pass + 1);
+}
+
+TEST_CASE("tiling::StencilUpdate (kernel counters)", "[tiling::StencilUpdate]") {
+    using InstrumentedStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, false, true>;
+    test_kernel_counters<GridImpl, InstrumentedStencilUpdateImpl>(tile_width + 1, tile_height / 2,
+                                                                  2 * iters_per_pass + 1);
+
+    using PersistentStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, true, true>;
+    test_kernel_counters<GridImpl, PersistentStencilUpdateImpl>(tile_width + 1, tile_height / 2,
+                                                                2 * iters_per_pass + 1);
+}
+
+TEST_CASE("tiling::StencilUpdate (dense storage)", "[tiling::StencilUpdate]") {
+    using DenseStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, true>;
+    static_assert(concepts::StencilUpdate<DenseStencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    test_stencil_update<GridImpl, DenseStencilUpdateImpl>(tile_width + 1, tile_height / 2, 0,
+                                                          iters_per_pass + 1);
+}
+
+TEST_CASE("tiling::StencilUpdate (static values)", "[tiling::StencilUpdate]") {
+    using StaticStencilUpdateImpl =
+        StencilUpdate<StaticValueTransFunc, n_processing_elements, tile_width, tile_height>;
+    test_static_values<StaticStencilUpdateImpl>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = n_processing_elements + 1});
+}
+
+TEST_CASE("tiling::StencilUpdate (history)", "[tiling::StencilUpdate]") {
+    using TransFunc = HistoryTransitionFunction<HistoryTransFunc<1>>;
+    test_history<1, StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height>>(
+        tile_width + tile_width / 2, tile_height - 1,
+        {.transition_function = TransFunc({}), .n_iterations = n_processing_elements + 1});
+
+    // The delay lines of a persistent kernel restart with tiles of a different height.
+    test_history<1, StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height,
+                                  tdv::single_pass::InlineStrategy, false, true>>(
+        tile_width + 1, tile_height + tile_height / 2,
+        {.transition_function = TransFunc({}), .n_iterations = n_processing_elements + 1});
+
+    using SubiterationTransFunc = HistoryTransitionFunction<HistoryTransFunc<2>>;
+    test_history<2,
+                 StencilUpdate<SubiterationTransFunc, n_processing_elements, tile_width,
+                               tile_height>>(
+        tile_width + 1, tile_height + tile_height / 2,
+        {.transition_function = SubiterationTransFunc({}), .n_iterations = 3});
+}
+
+TEST_CASE("tiling::StencilUpdate (constant table)", "[tiling::StencilUpdate]") {
+    using StencilUpdateImpl =
+        StencilUpdate<ConstantTableTransFunc, n_processing_elements, tile_width, tile_height>;
+    test_constant_table<StencilUpdateImpl>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ConstantTableTransFunc(),
+         .n_iterations = n_processing_elements + 1});
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition = BoundaryCondition::Constant,
+          uindex_t n_compute_units = 1>
+using ShapedStencilUpdate =
+    StencilUpdate<ShapedTransFunc<shape, boundary_condition>, n_processing_elements, tile_width,
+                  tile_height, tdv::single_pass::InlineStrategy, false, false, false,
+                  n_compute_units>;
+
+TEST_CASE("tiling::StencilUpdate (stencil shape)", "[tiling::StencilUpdate]") {
+    constexpr StencilShape star = StencilShape::star(2);
+    constexpr StencilShape box = StencilShape::asymmetric_box(0, 2, 1, 0);
+    constexpr StencilShape asymmetric_star = StencilShape::asymmetric_star(1, 0, 2, 1);
+
+    test_stencil_shape<star, ShapedStencilUpdate<star>>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ShapedTransFunc<star>(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements + 1});
+    test_stencil_shape<box, ShapedStencilUpdate<box>>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ShapedTransFunc<box>(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements + 1});
+    test_stencil_shape<asymmetric_star, ShapedStencilUpdate<asymmetric_star>>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ShapedTransFunc<asymmetric_star>(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements + 1});
+}
+
+template <StencilShape shape, BoundaryCondition boundary_condition, uindex_t n_compute_units = 1,
+          bool with_history = false>
+void test_shaped_boundary_condition(uindex_t grid_width) {
+    using TransFunc = BoundaryTransFunc<shape, boundary_condition, with_history>;
+    using StencilUpdateImpl =
+        StencilUpdate<TransFunc, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, false, false, n_compute_units>;
+    test_boundary_condition<shape, boundary_condition, StencilUpdateImpl, with_history>(
+        grid_width, tile_height / 2,
+        {.transition_function = TransFunc({}), .n_iterations = n_processing_elements + 1});
+}
+
+template <BoundaryCondition boundary_condition>
+concept supports_boundary_condition = requires {
+    typename ShapedStencilUpdate<StencilShape::box(2), boundary_condition>::Params;
+};
+
+TEST_CASE("tiling::StencilUpdate (boundary conditions)", "[tiling::StencilUpdate]") {
+    constexpr StencilShape box = StencilShape::box(2);
+    // Reflected cells of asymmetric shapes lie on the other side of the central cell and therefore
+    // outside of the shape.
+    constexpr StencilShape south_east = StencilShape::asymmetric_box(0, 2, 0, 2);
+    constexpr StencilShape north_west = StencilShape::asymmetric_star(2, 0, 2, 0);
+
+    test_shaped_boundary_condition<box, BoundaryCondition::Clamp>(tile_width + 1);
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Clamp>(tile_width + 1);
+    test_shaped_boundary_condition<north_west, BoundaryCondition::Clamp>(tile_width + 1);
+    test_shaped_boundary_condition<box, BoundaryCondition::Reflect>(tile_width + 1);
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Reflect>(tile_width + 1);
+    test_shaped_boundary_condition<north_west, BoundaryCondition::Reflect>(tile_width + 1);
+
+    // The borders between the strips of the compute units are no grid borders.
+    test_shaped_boundary_condition<box, BoundaryCondition::Clamp, 2>(3 * tile_width + 1);
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Reflect, 2>(3 * tile_width + 1);
+
+    // Multistep schemes keep the boundary condition of the wrapped transition function.
+    test_shaped_boundary_condition<box, BoundaryCondition::Clamp, 1, true>(tile_width + 1);
+    test_shaped_boundary_condition<south_east, BoundaryCondition::Reflect, 1, true>(tile_width + 1);
+
+    // Cells can only be reflected once.
+    using ReflectingStencilUpdate = ShapedStencilUpdate<box, BoundaryCondition::Reflect>;
+    ReflectingStencilUpdate update(
+        {.transition_function = ShapedTransFunc<box, BoundaryCondition::Reflect>()});
+    typename ReflectingStencilUpdate::GridImpl grid(tile_width + 1, 1);
+    REQUIRE_THROWS_AS(update(grid), std::invalid_argument);
+
+    // Periodic boundaries would need halos that are read from the opposite border, which the
+    // tile read kernel doesn't support.
+    static_assert(supports_boundary_condition<BoundaryCondition::Reflect>);
+    static_assert(!supports_boundary_condition<BoundaryCondition::Periodic>);
+}
+
+TEST_CASE("tiling::StencilUpdate (chained transition functions)", "[tiling::StencilUpdate]") {
+    using ChainedStencilUpdate =
+        StencilUpdate<ChainedTransFunc, ChainedTransFunc::n_subiterations, tile_width, tile_height>;
+    test_chained_trans_func<ChainedStencilUpdate>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ChainedTransFunc(), .halo_value = 1, .n_iterations = 3});
+    test_chained_trans_func<ChainedStencilUpdate>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ChainedTransFunc(),
+         .halo_value = 2,
+         .iteration_offset = 2,
+         .n_iterations = 1});
+}
+
+TEST_CASE("tiling::StencilUpdate (reduction)", "[tiling::StencilUpdate]") {
+    using ReducingStencilUpdateImpl =
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height>;
+    for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass + 1}) {
+        test_reduction<ReducingStencilUpdateImpl>(
+            2 * tile_width + 1, tile_height / 2,
+            {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo(),
+             .n_iterations = n_iterations});
+    }
+}
+
+TEST_CASE("tiling::StencilUpdate (run until)", "[tiling::StencilUpdate]") {
+    test_run_until<
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height>>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo()});
+}
+
+TEST_CASE("tiling::StencilUpdate (persistent kernel)", "[tiling::StencilUpdate]") {
+    using PersistentStencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, true>;
+    static_assert(
+        concepts::StencilUpdate<PersistentStencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass + 1}) {
+        test_stencil_update<GridImpl, PersistentStencilUpdateImpl>(
+            2 * tile_width + 1, tile_height + tile_height / 2, 0, n_iterations);
+        test_stencil_update<GridImpl, PersistentStencilUpdateImpl>(
+            tile_width / 2, tile_height / 2, 1, n_iterations);
+    }
+
+    test_static_values<StencilUpdate<StaticValueTransFunc, n_processing_elements, tile_width,
+                                     tile_height, tdv::single_pass::InlineStrategy, false, true>>(
+        tile_width + 1, tile_height / 2,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = n_processing_elements + 1});
+
+    test_reduction<StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width,
+                                 tile_height, tdv::single_pass::InlineStrategy, false, true>>(
+        2 * tile_width + 1, tile_height + 1,
+        {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo(),
+         .n_iterations = 2 * iters_per_pass + 1});
+}
+
+TEST_CASE("tiling::StencilUpdate (skip inactive tiles)", "[tiling::StencilUpdate]") {
+    using SkippingStencilUpdateImpl =
+        StencilUpdate<MaxSpreadTransFunc, n_processing_elements, tile_width, tile_height>;
+    using SkippingGridImpl = typename SkippingStencilUpdateImpl::GridImpl;
+    using MaxCell = MaxSpreadTransFunc::Cell;
+
+    uindex_t width = 4 * tile_width, height = 3 * tile_height - 1;
+    uindex_t n_iterations = 6 * n_processing_elements + 1;
+    std::vector<MaxCell> expected(width * height, 0);
+    expected[1 * height + 1] = 1;
+
+    SkippingGridImpl grid(width, height);
+    {
+        typename SkippingGridImpl::template GridAccessor<sycl::access::mode::read_write> ac(grid);
+        for (uindex_t c = 0; c < width; c++) {
+            for (uindex_t r = 0; r < height; r++) {
+                ac[c][r] = expected[c * height + r];
+            }
+        }
+    }
+    for (uindex_t i = 0; i < n_iterations; i++) {
+        std::vector<MaxCell> next(width * height);
+        for (index_t c = 0; c < index_t(width); c++) {
+            for (index_t r = 0; r < index_t(height); r++) {
+                MaxCell value = 0;
+                for (index_t n_c = std::max(c - 1, index_t(0));
+                     n_c <= std::min(c + 1, index_t(width) - 1); n_c++) {
+                    for (index_t n_r = std::max(r - 1, index_t(0));
+                         n_r <= std::min(r + 1, index_t(height) - 1); n_r++) {
+                        value = std::max(value, expected[n_c * height + n_r]);
+                    }
+                }
+                next[c * height + r] = value;
+            }
+        }
+        expected = next;
+    }
+
+    SkippingStencilUpdateImpl update({.transition_function = MaxSpreadTransFunc(),
+                                      .n_iterations = n_iterations,
+                                      .skip_inactive_tiles = true});
+    SkippingGridImpl result = update(grid);
+    REQUIRE(update.get_n_skipped_tiles() > 0);
+
+    typename SkippingGridImpl::template GridAccessor<sycl::access::mode::read> ac(result);
+    for (uindex_t c = 0; c < width; c++) {
+        for (uindex_t r = 0; r < height; r++) {
+            REQUIRE(ac[c][r] == expected[c * height + r]);
+        }
+    }
+
+    using PersistentStencilUpdateImpl =
+        StencilUpdate<MaxSpreadTransFunc, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, true>;
+    PersistentStencilUpdateImpl persistent_update(
+        {.transition_function = MaxSpreadTransFunc(), .skip_inactive_tiles = true});
+    REQUIRE_THROWS_AS(persistent_update(grid), std::invalid_argument);
+}
+
+template <uindex_t n_compute_units> void test_compute_units() {
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, false, false, n_compute_units>;
+    static_assert(concepts::StencilUpdate<StencilUpdateImpl, FPGATransFunc<1>, GridImpl>);
+
+    // The grids have less tile columns than compute units, a ragged tile column that is narrower
+    // than the halo, and tile columns that can't be distributed evenly.
+    for (uindex_t grid_width :
+         {tile_width / 2, 3 * tile_width + 1, 5 * tile_width - tile_width / 2}) {
+        for (uindex_t n_iterations : {uindex_t(1), iters_per_pass, 3 * iters_per_pass + 1}) {
+            StencilUpdateImpl update({.transition_function = FPGATransFunc<1>(),
+                                      .halo_value = Cell::halo(),
+                                      .iteration_offset = 1,
+                                      .n_iterations = n_iterations});
+            test_stencil_update<GridImpl, StencilUpdateImpl>(grid_width, tile_height + 1, update);
+
+            // Only the target grid is taken from the pool.
+            REQUIRE(update.get_grid_pool()->get_n_grids() == 1);
+        }
+    }
+}
+
+TEST_CASE("tiling::StencilUpdate (compute units)", "[tiling::StencilUpdate]") {
+    test_compute_units<2>();
+    test_compute_units<3>();
+
+    using StencilUpdateImpl =
+        StencilUpdate<FPGATransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, false, false, 2>;
+    StencilUpdateImpl update({.transition_function = FPGATransFunc<1>(),
+                              .halo_value = Cell::halo(),
+                              .n_iterations = 2 * iters_per_pass + 1});
+    for (uindex_t grid_width : {2 * tile_width + 1, tile_width + 1, 2 * tile_width + 1}) {
+        test_stencil_update<GridImpl, StencilUpdateImpl>(grid_width, tile_height / 2, update);
+    }
+
+    // The unit with the full tile column takes longer than the one with the ragged tile column.
+    constexpr uindex_t halo = StencilUpdateImpl::halo_radius;
+    REQUIRE(StencilUpdateImpl::model_runtime(tile_width + 1, tile_height / 2, iters_per_pass, 1.0,
+                                             100) ==
+            (tile_width + 2 * halo) * (tile_height / 2 + 2 * halo) + 100);
+
+    StencilUpdateImpl skipping_update(
+        {.transition_function = FPGATransFunc<1>(), .skip_inactive_tiles = true});
+    GridImpl grid(tile_width + 1, tile_height / 2);
+    REQUIRE_THROWS_AS(skipping_update(grid), std::invalid_argument);
+}
+
+TEST_CASE("tiling::StencilUpdate (compute units with static values and reductions)",
+          "[tiling::StencilUpdate]") {
+    test_static_values<StencilUpdate<StaticValueTransFunc, n_processing_elements, tile_width,
+                                     tile_height, tdv::single_pass::InlineStrategy, false, false,
+                                     false, 2>>(
+        2 * tile_width + 1, tile_height / 2,
+        {.transition_function = StaticValueTransFunc(), .n_iterations = n_processing_elements + 1});
+
+    using ReducingStencilUpdateImpl =
+        StencilUpdate<ReducingTransFunc<1>, n_processing_elements, tile_width, tile_height,
+                      tdv::single_pass::InlineStrategy, false, false, false, 3>;
+    for (uindex_t n_iterations : {iters_per_pass, 2 * iters_per_pass + 1}) {
+        test_reduction<ReducingStencilUpdateImpl>(
+            3 * tile_width + 1, tile_height + 1,
+            {.transition_function = ReducingTransFunc<1>(), .halo_value = Cell::halo(),
+             .n_iterations = n_iterations});
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2020-2024 Jan-Oliver Opdenhövel, Paderborn Center for Parallel Computing, Paderborn
+ * University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+ * associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+ * NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "../StencilUpdateTest.hpp"
+#include "../constants.hpp"
+#include <StencilStream/tiling/StencilUpdate3D.hpp>
+#include <catch2/catch_all.hpp>
+
+using namespace stencil;
+using namespace stencil::tiling;
+
+constexpr uindex_t tile_height_3d = 4;
+constexpr uindex_t tile_depth_3d = 3;
+
+TEST_CASE("tiling::StencilUpdate3D", "[tiling::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<1>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, tile_height_3d, tile_depth_3d>;
+
+    // Grids with one tile, with multiple complete tiles and with incomplete tiles at the borders.
+    for (uindex_t n_iterations :
+         {uindex_t(1), n_processing_elements, 2 * n_processing_elements + 1}) {
+        test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+            7, 2 * tile_height_3d + 1, 3 * tile_depth_3d - 1,
+            {.transition_function = TransFunc(),
+             .halo_value = 1,
+             .iteration_offset = 3,
+             .n_iterations = n_iterations});
+    }
+    test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+        3, 1, tile_depth_3d,
+        {.transition_function = TransFunc(), .halo_value = 2, .n_iterations = 5});
+    test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+        2, 2 * tile_height_3d, 2 * tile_depth_3d,
+        {.transition_function = TransFunc(), .halo_value = 2, .n_iterations = 3});
+}
+
+TEST_CASE("tiling::StencilUpdate3D (radius 2, sub-iterations)", "[tiling::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<2, 2>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, tile_height_3d, tile_depth_3d>;
+
+    test_stencil_update_3d<StencilUpdateImpl, TransFunc>(
+        6, 2 * tile_height_3d + 1, 2 * tile_depth_3d + 2,
+        {.transition_function = TransFunc(),
+         .halo_value = 1,
+         .n_iterations = n_processing_elements / 2 + 1});
+}
+
+TEST_CASE("tiling::StencilUpdate3D (grid pool)", "[tiling::StencilUpdate3D]") {
+    using TransFunc = WeightedSum3DTransFunc<1>;
+    using StencilUpdateImpl =
+        StencilUpdate3D<TransFunc, n_processing_elements, tile_height_3d, tile_depth_3d>;
+    test_grid_pool_3d<StencilUpdateImpl, TransFunc>(5, tile_height_3d + 1, tile_depth_3d + 1);
+}